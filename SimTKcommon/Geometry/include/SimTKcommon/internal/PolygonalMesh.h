@@ -127,7 +127,8 @@ public:
     void loadObjFile(std::istream& file);
     /**
      * Load a VTK PolyData (.vtp) file, adding the vertices and faces it 
-     * contains to this mesh.
+     * contains to this mesh. DataArrays may be in the "ascii", "binary", or
+     * "appended" (raw or base64) formats; compressed data is not supported.
      *
      * @param pathname    the name of a .vtp file
      */
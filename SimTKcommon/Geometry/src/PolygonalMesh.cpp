@@ -24,8 +24,12 @@
 #include "PolygonalMeshImpl.h"
 #include "SimTKcommon/internal/Xml.h"
 
+#include <algorithm>
 #include <cassert>
-#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <string>
 
 namespace SimTK {
@@ -106,56 +110,312 @@ void PolygonalMesh::transformMesh(const Transform& transform) {
         vertices[i] = transform*vertices[i];
 }
 
+//------------------------------------------------------------------------------
+// The OBJ and VTP readers below work on the whole file contents in memory,
+// parsing numbers in place rather than through a stream for each line or
+// value, and append straight to the mesh's arrays.
+//------------------------------------------------------------------------------
+namespace {
+
+inline bool isBlank(char c) {return c == ' ' || c == '\t' || c == '\r';}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p != end && isBlank(*p)) ++p;
+    return p;
+}
+
+inline const char* skipToken(const char* p, const char* end) {
+    while (p != end && !isBlank(*p)) ++p;
+    return p;
+}
+
+// Return the end of the line beginning at p, not counting any carriage 
+// return that precedes the newline.
+inline const char* trimLine(const char* line, const char* end) {
+    while (end != line && end[-1] == '\r') --end;
+    return end;
+}
+
+}
+
 void PolygonalMesh::loadObjFile(std::istream& file) {
     const char* methodName = "PolygonalMesh::loadObjFile()";
     SimTK_ERRCHK_ALWAYS(file.good(), methodName,
         "The supplied std::istream object was not in good condition"
         " on entrance -- did you check whether it opened successfully?");
 
-    std::string line;
-    Array_<int> indices;
-    int initialVertices = getNumVertices();
-    while (!file.eof()) {
-        SimTK_ERRCHK_ALWAYS(file.good(), methodName,
-            "An error occurred while reading the input file.");
-
-        std::getline(file, line);
-        while (line.size() > 0 && line[line.size()-1] == '\\') {
-            line[line.size()-1] = ' ';
-            std::string continuation;
-            std::getline(file, continuation);
-            line += continuation;
+    const std::string contents((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    SimTK_ERRCHK_ALWAYS(!file.bad(), methodName,
+        "An error occurred while reading the input file.");
+
+    initializeHandleIfEmpty();
+    PolygonalMeshImpl& impl = updImpl();
+    const int initialVertices = impl.vertices.size();
+    const char* const eof = contents.c_str() + contents.size();
+    const char* next = contents.c_str();
+    std::string joined; // only used for lines continued with a backslash
+    while (next != eof) {
+        const char* line = next;
+        const char* end = std::find(line, eof, '\n');
+        next = (end == eof ? eof : end+1);
+        end = trimLine(line, end);
+        if (end != line && end[-1] == '\\') {
+            joined.assign(line, end-1);
+            joined += ' ';
+            while (next != eof) {
+                const char* more = next;
+                const char* moreEnd = std::find(more, eof, '\n');
+                next = (moreEnd == eof ? eof : moreEnd+1);
+                moreEnd = trimLine(more, moreEnd);
+                if (moreEnd == more || moreEnd[-1] != '\\') {
+                    joined.append(more, moreEnd);
+                    break;
+                }
+                joined.append(more, moreEnd-1);
+                joined += ' ';
+            }
+            line = joined.c_str();
+            end = line + joined.size();
         }
-        std::stringstream s(line);
-        std::string command;
-        s >> command;
-        if (command == "v") {
+
+        const char* p = skipBlanks(line, end);
+        const char* command = p;
+        p = skipToken(p, end);
+        if (p-command != 1)
+            continue;
+        if (*command == 'v') {
             // A vertex
             
-            Real x, y, z;
-            s >> x;
-            s >> y;
-            s >> z;
-            SimTK_ERRCHK1_ALWAYS(!s.fail(), methodName,
-                "Found invalid vertex description: %s", line.c_str());
-            addVertex(Vec3(x, y, z));
+            Vec3 position;
+            for (int i = 0; i < 3; i++) {
+                p = skipBlanks(p, end);
+                char* stop = const_cast<char*>(p);
+                if (p != end)
+                    position[i] = (Real)std::strtod(p, &stop);
+                SimTK_ERRCHK1_ALWAYS(stop != p, methodName,
+                    "Found invalid vertex description: %s", 
+                    std::string(line, end).c_str());
+                p = stop;
+            }
+            impl.vertices.push_back(position);
         }
-        else if (command == "f") {
-            // A face
+        else if (*command == 'f') {
+            // A face. Only the vertex index is used from each v/vt/vn group.
             
-            indices.clear();
-            int index;
-            while (s >> index) {
-                s.ignore(line.size(), ' ');
+            const int numVertices = impl.vertices.size();
+            while ((p = skipBlanks(p, end)) != end) {
+                char* stop;
+                long index = std::strtol(p, &stop, 10);
+                if (stop == p)
+                    break;
                 if (index < 0)
-                    index += getNumVertices()-initialVertices;
+                    index += numVertices-initialVertices;
                 else
                     index--;
-                indices.push_back(index);
+                impl.faceVertexIndex.push_back((int)index);
+                p = skipToken(stop, end);
+            }
+            impl.faceVertexStart.push_back(impl.faceVertexIndex.size());
+        }
+    }
+}
+
+// Helpers for the binary and appended DataArray formats of a .vtp file.
+namespace {
+
+// How the binary DataArray elements of a .vtp file are stored, from the 
+// attributes of its VTKFile element, along with the contents of its 
+// AppendedData element if it has one.
+struct VtpEncoding {
+    VtpEncoding() : headerSize(4), swapBytes(false), appendedBase64(false),
+                    appended(0), appendedEnd(0) {}
+    int         headerSize;     // 4 for header_type="UInt32", 8 for "UInt64"
+    bool        swapBytes;      // byte_order is not this machine's order
+    bool        appendedBase64; // AppendedData encoding="base64" vs. "raw"
+    const char* appended;       // the byte just after the '_' marker
+    const char* appendedEnd;
+};
+
+bool isLittleEndian() {
+    const int one = 1;
+    return *reinterpret_cast<const char*>(&one) == 1;
+}
+
+// Return the number of bytes in one value of a DataArray type, or 0 if the 
+// type isn't recognized.
+int getVtpTypeSize(const String& type) {
+    if (type == "Int8"  || type == "UInt8")                       return 1;
+    if (type == "Int16" || type == "UInt16")                      return 2;
+    if (type == "Int32" || type == "UInt32" || type == "Float32") return 4;
+    if (type == "Int64" || type == "UInt64" || type == "Float64") return 8;
+    return 0;
+}
+
+// Decodes base64 text a few bytes at a time. VTK may encode a DataArray's 
+// header and data as one stream or as two separately padded ones, so padding
+// is allowed in the middle, and whitespace is skipped.
+class Base64Reader {
+public:
+    Base64Reader(const char* begin, const char* end) 
+    :   p(begin), end(end), bits(0), numBits(0) {}
+
+    // Append the next n decoded bytes to out. Returns false if the text ran
+    // out first.
+    bool read(size_t n, std::string& out) {
+        const size_t size = out.size() + n;
+        while (out.size() < size && p != end) {
+            const char c = *p++;
+            unsigned value;
+            if      (c >= 'A' && c <= 'Z') value = c-'A';
+            else if (c >= 'a' && c <= 'z') value = c-'a'+26;
+            else if (c >= '0' && c <= '9') value = c-'0'+52;
+            else if (c == '+')             value = 62;
+            else if (c == '/')             value = 63;
+            else {
+                if (c == '=')
+                    numBits = 0; // discard the bits that padded a group
+                continue;
             }
-            addFace(indices);
+            bits = (bits << 6) | value;
+            numBits += 6;
+            if (numBits >= 8) {
+                numBits -= 8;
+                out += char((bits >> numBits) & 0xff);
+            }
+        }
+        return out.size() == size;
+    }
+private:
+    const char* p;
+    const char* end;
+    unsigned    bits;
+    int         numBits;
+};
+
+// Put the bytes of each n-byte value in data in the opposite order.
+void swapBytes(char* data, size_t size, int n) {
+    if (n > 1)
+        for (size_t i = 0; i+n <= size; i += n)
+            std::reverse(data+i, data+i+n);
+}
+
+// Interpret the header that precedes a block of binary data, which gives the
+// number of bytes in the block.
+unsigned long long getVtpBlockSize(std::string header, bool swap) {
+    if (swap)
+        swapBytes(&header[0], header.size(), (int)header.size());
+    if (header.size() == 8) {
+        unsigned long long size;
+        std::memcpy(&size, header.data(), 8);
+        return size;
+    }
+    unsigned int size;
+    std::memcpy(&size, header.data(), 4);
+    return size;
+}
+
+template <class S, class T>
+void appendVtpValues(const std::string& bytes, Array_<T>& values) {
+    const int n = int(bytes.size()/sizeof(S));
+    values.reserve(values.size() + n);
+    for (int i = 0; i < n; i++) {
+        S value;
+        std::memcpy(&value, bytes.data() + i*sizeof(S), sizeof(S));
+        values.push_back(T(value));
+    }
+}
+
+// Read the values of a DataArray element, in any of the uncompressed formats,
+// converting them to type T.
+template <class T>
+void readVtpDataArray(const Xml::Element& e, const VtpEncoding& encoding,
+                      Array_<T>& values) {
+    const char* method = "PolygonalMesh::loadVtpFile()";
+    const String& format = e.getRequiredAttributeValue("format");
+    values.clear();
+    if (format == "ascii") {
+        const String text = e.getValue();
+        const char* p = text.c_str();
+        char* stop;
+        for (double value = std::strtod(p, &stop); stop != p; 
+             value = std::strtod(p, &stop)) {
+            values.push_back(T(value));
+            p = stop;
+        }
+        return;
+    }
+
+    const String& type = e.getRequiredAttributeValue("type");
+    const int typeSize = getVtpTypeSize(type);
+    SimTK_ERRCHK1_ALWAYS(typeSize > 0, method,
+        "Unsupported DataArray type \"%s\".", type.c_str());
+
+    std::string header, bytes;
+    if (format == "binary" || (format == "appended" && encoding.appendedBase64))
+    {   String text;
+        const char* begin = encoding.appended;
+        const char* end = encoding.appendedEnd;
+        if (format == "binary") {
+            text = e.getValue();
+            begin = text.c_str();
+            end = begin + text.size();
+        } else {
+            SimTK_ERRCHK_ALWAYS(begin, method,
+                "A DataArray has format=\"appended\" but there is no"
+                " AppendedData element.");
+            const long long offset = 
+                e.getRequiredAttributeValueAs<long long>("offset");
+            SimTK_ERRCHK1_ALWAYS(offset >= 0 && offset < end-begin, method,
+                "DataArray offset %lld is outside the AppendedData.", offset);
+            begin += offset;
         }
+        Base64Reader reader(begin, end);
+        bool ok = reader.read(encoding.headerSize, header);
+        ok = ok && reader.read((size_t)getVtpBlockSize(header, 
+                               encoding.swapBytes), bytes);
+        SimTK_ERRCHK_ALWAYS(ok, method,
+            "A binary DataArray ended before all of its data was read.");
+    } else if (format == "appended") {
+        SimTK_ERRCHK_ALWAYS(encoding.appended, method,
+            "A DataArray has format=\"appended\" but there is no"
+            " AppendedData element.");
+        const long long available = encoding.appendedEnd - encoding.appended;
+        const long long offset = 
+            e.getRequiredAttributeValueAs<long long>("offset");
+        SimTK_ERRCHK1_ALWAYS(offset >= 0 
+                             && offset + encoding.headerSize <= available,
+            method, "DataArray offset %lld is outside the AppendedData.", 
+            offset);
+        const char* p = encoding.appended + offset;
+        header.assign(p, encoding.headerSize);
+        const unsigned long long size = 
+            getVtpBlockSize(header, encoding.swapBytes);
+        SimTK_ERRCHK_ALWAYS(
+            size <= (unsigned long long)(available-offset-encoding.headerSize),
+            method, "An appended DataArray extends past the end of the file.");
+        bytes.assign(p + encoding.headerSize, (size_t)size);
+    } else {
+        SimTK_ERRCHK1_ALWAYS(false, method,
+            "Unrecognized DataArray format=\"%s\"; expected \"ascii\","
+            " \"binary\", or \"appended\".", format.c_str());
     }
+
+    if (encoding.swapBytes)
+        swapBytes(&bytes[0], bytes.size(), typeSize);
+    if      (type == "Int8")    appendVtpValues<signed char>(bytes, values);
+    else if (type == "UInt8")   appendVtpValues<unsigned char>(bytes, values);
+    else if (type == "Int16")   appendVtpValues<short>(bytes, values);
+    else if (type == "UInt16")  appendVtpValues<unsigned short>(bytes, values);
+    else if (type == "Int32")   appendVtpValues<int>(bytes, values);
+    else if (type == "UInt32")  appendVtpValues<unsigned int>(bytes, values);
+    else if (type == "Int64")   appendVtpValues<long long>(bytes, values);
+    else if (type == "UInt64")  appendVtpValues<unsigned long long>(bytes, 
+                                                                    values);
+    else if (type == "Float32") appendVtpValues<float>(bytes, values);
+    else                        appendVtpValues<double>(bytes, values);
+}
+
 }
 
 /* Use our XML reader to parse VTK's PolyData file format and add the polygons
@@ -232,9 +492,7 @@ DataArray -- All of the data and geometry specifications use DataArray elements
 to describe their actual content as follows:
 
 The DataArray element stores a sequence of values of one type. There may be 
-one or more components per value. [SimTK Note: there are also "binary" and
-"appended" formats which we do not support -- be sure to check that the
-format attribute for every DataArray is "ascii".]
+one or more components per value.
     <DataArray type="Int32" Name="offsets" format="ascii">
     10 20 30 ... </DataArray>
 
@@ -247,15 +505,57 @@ The attributes of the DataArray elements are described as follows:
         DataArray Name attribute to figure out what's being provided.]
     NumberOfComponents -- The number of components per value in the array.
     format -- The means by which the data values themselves are stored in the
-        file. This is "ascii", "binary", or "appended". [SimTK only supports
-        "ascii".]
+        file. This is "ascii", "binary", or "appended".
     format="ascii" -- The data are listed in ASCII directly inside the 
         DataArray element. Whitespace is used for separation.
+    format="binary" -- The data are encoded in base64 and listed directly
+        inside the DataArray element. The data are preceded by a header
+        giving the number of bytes of data that follow.
+    format="appended" -- The data are stored in the AppendedData element,
+        starting "offset" bytes after the '_' that begins its contents. The
+        header and data are the same as for "binary", but are raw bytes when
+        the AppendedData element has encoding="raw".
+
+The header is a UInt32 unless the VTKFile element has header_type="UInt64", 
+and all binary values are in the VTKFile element's byte_order, "LittleEndian"
+or "BigEndian". [SimTK Note: we do not support compressed data -- files whose
+VTKFile element has a "compressor" attribute.]
+
+The XML parser sees only the part of the file that precedes the AppendedData
+element, since the raw appended data need not be valid XML. All the numbers
+are converted directly from the file contents rather than through streams.
 */
 void PolygonalMesh::loadVtpFile(const String& pathname) {
   try
   { const char* method = "PolygonalMesh::loadVtpFile()";
-    Xml vtp(pathname);
+    std::ifstream file(pathname.c_str(), std::ios::in | std::ios::binary);
+    SimTK_ERRCHK_ALWAYS(file.good(), method, "Failed to open the file.");
+    const std::string contents((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+
+    // Everything up to the start tag of the AppendedData element, if there is
+    // one, is parsed by the Xml system; the appended data itself may be raw 
+    // bytes so is left where it is and read directly.
+    VtpEncoding encoding;
+    Xml vtp;
+    const std::string::size_type appendedTag = contents.find("<AppendedData");
+    if (appendedTag == std::string::npos)
+        vtp.readFromString(contents.c_str());
+    else {
+        const std::string::size_type tagEnd = contents.find('>', appendedTag);
+        const std::string::size_type marker = 
+            tagEnd == std::string::npos ? tagEnd : contents.find('_', tagEnd);
+        SimTK_ERRCHK_ALWAYS(marker != std::string::npos, method,
+            "Expected the contents of the AppendedData element to begin"
+            " with '_'.");
+        encoding.appended = contents.c_str() + marker + 1;
+        encoding.appendedEnd = contents.c_str() + contents.size();
+        vtp.readFromString(contents.substr(0, tagEnd+1) 
+                           + "</AppendedData></VTKFile>");
+        encoding.appendedBase64 = vtp.getRootElement()
+            .getRequiredElement("AppendedData")
+            .getRequiredAttributeValue("encoding") == "base64";
+    }
     // The file has been read in and parsed into memory by the Xml system.
 
     SimTK_ERRCHK1_ALWAYS(vtp.getRootTag() == "VTKFile", method,
@@ -269,6 +569,18 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
         root.getRequiredAttributeValue("type").c_str());
     // This is a VTK PolyData document.
 
+    SimTK_ERRCHK_ALWAYS(!root.hasAttribute("compressor"), method,
+        "Compressed .vtp files are not supported.");
+    const String byteOrder = 
+        root.getOptionalAttributeValue("byte_order", "LittleEndian");
+    encoding.swapBytes = ((byteOrder == "LittleEndian") != isLittleEndian());
+    const String headerType = 
+        root.getOptionalAttributeValue("header_type", "UInt32");
+    SimTK_ERRCHK1_ALWAYS(headerType == "UInt32" || headerType == "UInt64",
+        method, "Expected header_type 'UInt32' or 'UInt64' but got '%s'.",
+        headerType.c_str());
+    encoding.headerSize = (headerType == "UInt64" ? 8 : 4);
+
     Xml::Element polydata = root.getRequiredElement("PolyData");
     Xml::Element piece    = polydata.getRequiredElement("Piece");
     Xml::Element points   = piece.getRequiredElement("Points");
@@ -277,31 +589,22 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
     const int numPolys  = 
         piece.getRequiredAttributeValueAs<int>("NumberOfPolys");
 
-    // Remember this because we'll have to use it to adjust the indices we use 
-    // when referencing the vertices we're about to read in. This number is
-    // the index that our first vertex will be assigned.
-    const int firstVertex = getNumVertices();
-
     // The lone DataArray element in the Points element contains the points'
-    // coordinates. Read it in as a Vector of Vec3s.
-    Xml::Element pointData = points.getRequiredElement("DataArray");
-    SimTK_ERRCHK1_ALWAYS(pointData.getRequiredAttributeValue("format")
-                         == "ascii", method, 
-        "Only format=\"ascii\" is supported for .vtp file DataArray elements,"
-        " got format=\"%s\" for Points DataArray.",
-        pointData.getRequiredAttributeValue("format").c_str());
-
-    Vector_<Vec3> coords = 
-        points.getRequiredElementValueAs< Vector_<Vec3> >("DataArray");
-
-    SimTK_ERRCHK2_ALWAYS(coords.size() == numPoints, method,
+    // coordinates, three per point.
+    Array_<Real> coords;
+    readVtpDataArray(points.getRequiredElement("DataArray"), encoding, coords);
+
+    SimTK_ERRCHK2_ALWAYS(coords.size() == 3*numPoints, method,
         "Expected coordinates for %d points but got %d.",
-        numPoints, coords.size());
+        numPoints, coords.size()/3);
 
     // Now that we have the point coordinates, use them to create the vertices
     // in our mesh.
+    initializeHandleIfEmpty();
+    Array_<Vec3>& vertices = updImpl().vertices;
+    vertices.reserve(vertices.size() + numPoints);
     for (int i=0; i < numPoints; ++i)
-        addVertex(coords[i]);
+        vertices.push_back(Vec3(coords[3*i], coords[3*i+1], coords[3*i+2]));
 
     // Polys are given by a connectivity array which lists the points forming
     // each polygon in a long unstructured list, then an offsets array, one per
@@ -315,12 +618,6 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
          p != polys.element_end(); ++p) 
     {       
         const String& name = p->getRequiredAttributeValue("Name");
-        SimTK_ERRCHK2_ALWAYS(p->getRequiredAttributeValue("format")
-                             == "ascii", method, 
-            "Only format=\"ascii\" is supported for .vtp file DataArray"
-            " elements, but format=\"%s\" for DataArray '%s'.",
-            p->getRequiredAttributeValue("format").c_str(), name.c_str());
-
         if (name == "connectivity") econnectivity = *p;
         else if (name == "offsets") eoffsets = *p; 
     }
@@ -331,7 +628,8 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
         " least one of them was missing.");
 
     // Read in the arrays.
-    Array_<int> offsets = eoffsets.getValueAs< Array_<int> >();
+    Array_<int> offsets;
+    readVtpDataArray(eoffsets, encoding, offsets);
     // Size may have changed if file is bad.
     SimTK_ERRCHK2_ALWAYS(offsets.size() == numPolys, method,
         "The number of offsets (%d) should have matched the stated "
@@ -341,19 +639,29 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
     // end of the last polygon described in the connectivity array and hence
     // is the size of the connectivity array.
     const int expectedSize = numPolys ? offsets.back() : 0;
-    Array_<int> connectivity = econnectivity.getValueAs< Array_<int> >();
+    Array_<int> connectivity;
+    readVtpDataArray(econnectivity, encoding, connectivity);
 
     SimTK_ERRCHK2_ALWAYS(connectivity.size()==expectedSize, method,
         "The connectivity array was the wrong size (%d). It should"
         " match the last entry in the offsets array which was %d.",
         connectivity.size(), expectedSize);
 
+    // Append all the polygons at once: the connectivity array is exactly the
+    // list of face vertices, and each offset marks where a face ends.
+    PolygonalMeshImpl& impl = updImpl();
+    const int firstIndex = impl.faceVertexIndex.size();
     int startPoly = 0;
     for (int i=0; i < numPolys; ++i) {
-        // Now read in the face in [startOffs,endOffs]
-        addFace(connectivity(startPoly, offsets[i]-startPoly));
-        startPoly = offsets[i]; // move to the next poly
+        SimTK_ERRCHK1_ALWAYS(offsets[i] >= startPoly, method,
+            "The offsets array is not in increasing order at entry %d.", i);
+        startPoly = offsets[i];
     }
+    impl.faceVertexIndex.insert(impl.faceVertexIndex.end(), 
+                                connectivity.begin(), connectivity.end());
+    impl.faceVertexStart.reserve(impl.faceVertexStart.size() + numPolys);
+    for (int i=0; i < numPolys; ++i)
+        impl.faceVertexStart.push_back(firstIndex + offsets[i]);
 
   } catch (const std::exception& e) {
       // This will throw a new exception with an enhanced message that
@@ -34,6 +34,7 @@
 
 #include "SimTKcommon/internal/SpatialAlgebra.h"
 #include "SimTKcommon/internal/MassProperties.h"
+#include "SimTKcommon/internal/SpatialKernels.h"
 
 
 #endif // SimTK_SIMMATRIX_MECHANICS_H_
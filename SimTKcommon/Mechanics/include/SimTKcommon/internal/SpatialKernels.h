@@ -0,0 +1,163 @@
+#ifndef SimTK_SimTKCOMMON_SPATIAL_KERNELS_H_
+#define SimTK_SimTKCOMMON_SPATIAL_KERNELS_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+Padded, aligned storage for spatial vectors and matrices, and vectorized
+versions of the spatial algebra operations that dominate the articulated body
+passes: the PhiMatrix shift, the articulated body inertia shift, and 6x6
+matrix times 6-vector products. The instruction set used is chosen at run
+time from those the library was built with (see BUILD_DISPATCH_INST_SET) and
+those the CPU supports. **/
+
+#include "SimTKcommon/SmallMatrix.h"
+#include "SimTKcommon/Orientation.h"
+#include "SimTKcommon/internal/SpatialAlgebra.h"
+#include "SimTKcommon/internal/MassProperties.h"
+
+// The padded types are aligned so that each column starts a cache line.
+// Note that operator new does not honor this alignment for heap objects; the
+// kernels work on unaligned data too, just a little slower.
+#if defined(_MSC_VER)
+    #define SimTK_SPATIAL_KERNELS_ALIGN __declspec(align(64))
+#else
+    #define SimTK_SPATIAL_KERNELS_ALIGN __attribute__((aligned(64)))
+#endif
+
+namespace SimTK {
+
+/** A SpatialVec padded from 6 to 8 elements, for use with SpatialKernels.
+Elements 0-2 are the rotational part and 3-5 the translational part; the last
+two are padding and must be zero. **/
+class SimTK_SPATIAL_KERNELS_ALIGN PaddedSpatialVec {
+public:
+    /// Default construction produces a zero vector.
+    PaddedSpatialVec() {setToZero();}
+    /// Copy the elements of a SpatialVec.
+    PaddedSpatialVec(const SpatialVec& sv) {
+        for (int i=0; i < 6; ++i) v[i] = sv[i/3][i%3];
+        v[6] = v[7] = 0;
+    }
+
+    void setToZero() {for (int i=0; i < 8; ++i) v[i] = 0;}
+
+    SpatialVec toSpatialVec() const
+    {   return SpatialVec(Vec3(v[0],v[1],v[2]), Vec3(v[3],v[4],v[5])); }
+
+    Real v[8];
+};
+
+/** A SpatialMat stored by columns, each column padded from 6 to 8 elements,
+for use with SpatialKernels. c[j][i] is element (i,j); c[j][6] and c[j][7]
+are padding and must be zero. **/
+class SimTK_SPATIAL_KERNELS_ALIGN PaddedSpatialMat {
+public:
+    /// Default construction produces a zero matrix.
+    PaddedSpatialMat() {setToZero();}
+    /// Copy the elements of a SpatialMat.
+    PaddedSpatialMat(const SpatialMat& m) {assign(m);}
+    /// Copy the full 6x6 matrix represented by an ArticulatedInertia.
+    explicit PaddedSpatialMat(const ArticulatedInertia& P)
+    {   assign(P.toSpatialMat()); }
+
+    void setToZero()
+    {   for (int j=0; j < 6; ++j) for (int i=0; i < 8; ++i) c[j][i] = 0; }
+
+    const Real& operator()(int i, int j) const {return c[j][i];}
+    Real&       operator()(int i, int j)       {return c[j][i];}
+
+    SpatialMat toSpatialMat() const {
+        SpatialMat m;
+        for (int j=0; j < 6; ++j) for (int i=0; i < 6; ++i)
+            m(i/3,j/3)(i%3,j%3) = c[j][i];
+        return m;
+    }
+
+    /// Interpret this matrix as an articulated body inertia; only the lower
+    /// triangles of the diagonal blocks and the upper right block are used.
+    ArticulatedInertia toArticulatedInertia() const {
+        const PaddedSpatialMat& P = *this;
+        return ArticulatedInertia(
+            SymMat33(P(3,3), P(4,3), P(4,4), P(5,3), P(5,4), P(5,5)), // M
+            Mat33(P(0,3), P(0,4), P(0,5),                               // F
+                  P(1,3), P(1,4), P(1,5),
+                  P(2,3), P(2,4), P(2,5)),
+            SymMat33(P(0,0), P(1,0), P(1,1), P(2,0), P(2,1), P(2,2))); // J
+    }
+
+    Real c[6][8];
+private:
+    void assign(const SpatialMat& m) {
+        for (int j=0; j < 6; ++j) {
+            for (int i=0; i < 6; ++i) c[j][i] = m(i/3,j/3)(i%3,j%3);
+            c[j][6] = c[j][7] = 0;
+        }
+    }
+};
+
+/** Vectorized spatial algebra kernels, operating on arrays of padded spatial
+vectors and matrices. Each kernel gives the same result as the corresponding
+SpatialAlgebra.h or MassProperties.h operator to within roundoff; they differ
+only in the use of fused multiply-adds and the order of the additions.
+
+The kernels are built for the baseline instruction set (SSE2) and for any
+wider ones selected with the BUILD_DISPATCH_INST_SET CMake option. The widest
+of those that the CPU supports is chosen the first time a kernel is called;
+it can be changed with setInstructionSet(), which is meant for testing and
+benchmarking and is not thread safe. In single precision builds only the
+scalar kernels are available. **/
+class SimTK_SimTKCOMMON_EXPORT SpatialKernels {
+public:
+    enum InstructionSet {Scalar=0, SSE2=1, AVX2=2, AVX512=3};
+
+    /// Return true if the kernels were built for \a set and this CPU
+    /// supports it.
+    static bool isInstructionSetAvailable(InstructionSet set);
+    /// Return the widest available instruction set; this is the default.
+    static InstructionSet getBestInstructionSet();
+    /// Return the instruction set the kernels are currently using.
+    static InstructionSet getInstructionSet();
+    /// Use a different instruction set; it must be available.
+    static void setInstructionSet(InstructionSet set);
+    static const char* getInstructionSetName(InstructionSet set);
+
+    /// Calculate mv[k] = m*v[k] for k=0..n-1. The arrays \a v and \a mv may
+    /// be the same.
+    static void multiply(const PaddedSpatialMat& m, int n,
+                         const PaddedSpatialVec* v, PaddedSpatialVec* mv);
+    /// Calculate v[k] = phi[k]*v[k] for k=0..n-1.
+    static void shift(int n, const PhiMatrix* phi, PaddedSpatialVec* v);
+    /// Calculate m[k] = phi[k]*m[k] for k=0..n-1.
+    static void shift(int n, const PhiMatrix* phi, PaddedSpatialMat* m);
+    /// Calculate P[k] = phi[k]*P[k]*~phi[k] for k=0..n-1. This is the same
+    /// as ArticulatedInertia::shiftInPlace(phi[k].l()) when P[k] holds an
+    /// articulated body inertia.
+    static void shiftArticulated(int n, const PhiMatrix* phi,
+                                 PaddedSpatialMat* P);
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_SPATIAL_KERNELS_H_
@@ -0,0 +1,526 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ * Implementations of the SpatialKernels, one set per instruction set, and the
+ * run time choice between them.
+ */
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/internal/SpatialKernels.h"
+
+// The vector kernels are for double precision on x86 only. SSE2 is the
+// baseline instruction set so it is always there; the wider ones are compiled
+// for their own targets and only called if the CPU supports them.
+#if (SimTK_DEFAULT_PRECISION == 2) && (defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SimTK_SPATIAL_KERNELS_SSE2
+    #include <emmintrin.h>
+    #if defined(SimTK_DISPATCH_AVX2) || defined(SimTK_DISPATCH_AVX512)
+        #include <immintrin.h>
+        #if defined(_MSC_VER)
+            #include <intrin.h>
+        #endif
+    #endif
+    #if defined(SimTK_DISPATCH_AVX2)
+        #define SimTK_SPATIAL_KERNELS_AVX2
+    #endif
+    #if defined(SimTK_DISPATCH_AVX512)
+        #define SimTK_SPATIAL_KERNELS_AVX512
+    #endif
+#endif
+
+// gcc and clang need to be told which functions may use the wider
+// instructions; Visual Studio allows their intrinsics anywhere.
+#if defined(__GNUC__)
+    #define SimTK_TARGET_AVX2   __attribute__((target("avx2,fma")))
+    #define SimTK_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+    #define SimTK_TARGET_AVX2
+    #define SimTK_TARGET_AVX512
+#endif
+
+namespace SimTK {
+
+// Kernel signatures, in the same order as the SpatialKernels methods.
+typedef void (*MultiplyKernel)(const PaddedSpatialMat&, int,
+                               const PaddedSpatialVec*, PaddedSpatialVec*);
+typedef void (*ShiftVecKernel)(int, const PhiMatrix*, PaddedSpatialVec*);
+typedef void (*ShiftMatKernel)(int, const PhiMatrix*, PaddedSpatialMat*);
+
+struct KernelTable {
+    MultiplyKernel multiply;
+    ShiftVecKernel shiftVec;
+    ShiftMatKernel shiftMat;
+    ShiftMatKernel shiftArticulated;
+};
+
+// All the kernels work column by column. Shifting a column by phi adds
+// l X (lower half) to the upper half; that is done as the sum of the columns
+// of crossMat(l) scaled by the lower half's elements:
+//      crossMat(l) = [  0   -l2   l1 ]
+//                    [  l2   0   -l0 ]
+//                    [ -l1   l0   0  ]
+// Multiplying by ~phi on the right adds to each of the first three columns
+// the last three combined by the columns of crossMat(-l).
+
+    //////////////////////
+    //  SCALAR KERNELS  //
+    //////////////////////
+
+static void multiplyScalar(const PaddedSpatialMat& m, int n,
+                           const PaddedSpatialVec* v, PaddedSpatialVec* mv) {
+    for (int k=0; k < n; ++k) {
+        Real y[6] = {0,0,0,0,0,0};
+        for (int j=0; j < 6; ++j) {
+            const Real x = v[k].v[j];
+            for (int i=0; i < 6; ++i) y[i] += m.c[j][i]*x;
+        }
+        for (int i=0; i < 6; ++i) mv[k].v[i] = y[i];
+        mv[k].v[6] = mv[k].v[7] = 0;
+    }
+}
+
+// top += l X bottom, for one 6-element column.
+static inline void shiftColumnScalar(const Vec3& l, Real* col) {
+    const Real b0=col[3], b1=col[4], b2=col[5];
+    col[0] += l[1]*b2 - l[2]*b1;
+    col[1] += l[2]*b0 - l[0]*b2;
+    col[2] += l[0]*b1 - l[1]*b0;
+}
+
+static void shiftVecScalar(int n, const PhiMatrix* phi, PaddedSpatialVec* v) {
+    for (int k=0; k < n; ++k)
+        shiftColumnScalar(phi[k].l(), v[k].v);
+}
+
+static void shiftMatScalar(int n, const PhiMatrix* phi, PaddedSpatialMat* m) {
+    for (int k=0; k < n; ++k)
+        for (int j=0; j < 6; ++j)
+            shiftColumnScalar(phi[k].l(), m[k].c[j]);
+}
+
+static void shiftArticulatedScalar(int n, const PhiMatrix* phi,
+                                   PaddedSpatialMat* P) {
+    for (int k=0; k < n; ++k) {
+        const Vec3& s = phi[k].l();
+        Real (*c)[8] = P[k].c;
+        for (int i=0; i < 6; ++i) { // P*~phi
+            c[0][i] += s[1]*c[5][i] - s[2]*c[4][i];
+            c[1][i] += s[2]*c[3][i] - s[0]*c[5][i];
+            c[2][i] += s[0]*c[4][i] - s[1]*c[3][i];
+        }
+        for (int j=0; j < 6; ++j) // phi*(P*~phi)
+            shiftColumnScalar(s, c[j]);
+    }
+}
+
+static const KernelTable scalarKernels =
+{   multiplyScalar, shiftVecScalar, shiftMatScalar, shiftArticulatedScalar };
+
+#ifdef SimTK_SPATIAL_KERNELS_SSE2
+    ////////////////////
+    //  SSE2 KERNELS  //
+    ////////////////////
+
+// A column is held in three registers: rows 0-1, 2-3 and 4-5.
+
+static void multiplySSE2(const PaddedSpatialMat& m, int n,
+                         const PaddedSpatialVec* v, PaddedSpatialVec* mv) {
+    for (int k=0; k < n; ++k) {
+        __m128d y0 = _mm_setzero_pd(), y1 = y0, y2 = y0;
+        for (int j=0; j < 6; ++j) {
+            const __m128d x = _mm_set1_pd(v[k].v[j]);
+            const double* col = m.c[j];
+            y0 = _mm_add_pd(y0, _mm_mul_pd(_mm_loadu_pd(col),   x));
+            y1 = _mm_add_pd(y1, _mm_mul_pd(_mm_loadu_pd(col+2), x));
+            y2 = _mm_add_pd(y2, _mm_mul_pd(_mm_loadu_pd(col+4), x));
+        }
+        double* out = mv[k].v;
+        _mm_storeu_pd(out, y0); _mm_storeu_pd(out+2, y1);
+        _mm_storeu_pd(out+4, y2); _mm_storeu_pd(out+6, _mm_setzero_pd());
+    }
+}
+
+// The columns of crossMat(l), split to match a column's first two registers
+// and with a zero where row 3 would be.
+struct CrossColumnsSSE2 {
+    explicit CrossColumnsSSE2(const Vec3& l) {
+        x01[0] = _mm_set_pd( l[2], 0);    x23[0] = _mm_set_pd(0, -l[1]);
+        x01[1] = _mm_set_pd( 0, -l[2]);   x23[1] = _mm_set_pd(0,  l[0]);
+        x01[2] = _mm_set_pd(-l[0], l[1]); x23[2] = _mm_set_pd(0,  0);
+    }
+    __m128d x01[3], x23[3];
+};
+
+static inline void shiftColumnSSE2(const CrossColumnsSSE2& x, double* col) {
+    __m128d c01 = _mm_loadu_pd(col), c23 = _mm_loadu_pd(col+2);
+    for (int r=0; r < 3; ++r) {
+        const __m128d b = _mm_set1_pd(col[3+r]);
+        c01 = _mm_add_pd(c01, _mm_mul_pd(x.x01[r], b));
+        c23 = _mm_add_pd(c23, _mm_mul_pd(x.x23[r], b));
+    }
+    _mm_storeu_pd(col, c01); _mm_storeu_pd(col+2, c23);
+}
+
+static void shiftVecSSE2(int n, const PhiMatrix* phi, PaddedSpatialVec* v) {
+    for (int k=0; k < n; ++k)
+        shiftColumnSSE2(CrossColumnsSSE2(phi[k].l()), v[k].v);
+}
+
+static void shiftMatSSE2(int n, const PhiMatrix* phi, PaddedSpatialMat* m) {
+    for (int k=0; k < n; ++k) {
+        const CrossColumnsSSE2 x(phi[k].l());
+        for (int j=0; j < 6; ++j)
+            shiftColumnSSE2(x, m[k].c[j]);
+    }
+}
+
+// col += a*ca + b*cb, all six rows.
+static inline void addColumnsSSE2(double* col, const double* ca, double a,
+                                  const double* cb, double b) {
+    const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
+    for (int r=0; r < 6; r += 2)
+        _mm_storeu_pd(col+r, _mm_add_pd(_mm_loadu_pd(col+r), _mm_add_pd(
+            _mm_mul_pd(_mm_loadu_pd(ca+r), va),
+            _mm_mul_pd(_mm_loadu_pd(cb+r), vb))));
+}
+
+static void shiftArticulatedSSE2(int n, const PhiMatrix* phi,
+                                 PaddedSpatialMat* P) {
+    for (int k=0; k < n; ++k) {
+        const Vec3& s = phi[k].l();
+        double (*c)[8] = P[k].c;
+        addColumnsSSE2(c[0], c[5],  s[1], c[4], -s[2]); // P*~phi
+        addColumnsSSE2(c[1], c[3],  s[2], c[5], -s[0]);
+        addColumnsSSE2(c[2], c[4],  s[0], c[3], -s[1]);
+        const CrossColumnsSSE2 x(s);
+        for (int j=0; j < 6; ++j) // phi*(P*~phi)
+            shiftColumnSSE2(x, c[j]);
+    }
+}
+
+static const KernelTable sse2Kernels =
+{   multiplySSE2, shiftVecSSE2, shiftMatSSE2, shiftArticulatedSSE2 };
+#endif
+
+#ifdef SimTK_SPATIAL_KERNELS_AVX2
+    ////////////////////
+    //  AVX2 KERNELS  //
+    ////////////////////
+
+// A column is held in two registers: rows 0-3 and rows 4-7 (6,7 padding).
+
+SimTK_TARGET_AVX2 static void
+multiplyAVX2(const PaddedSpatialMat& m, int n,
+             const PaddedSpatialVec* v, PaddedSpatialVec* mv) {
+    __m256d lo[6], hi[6];
+    for (int j=0; j < 6; ++j) {
+        lo[j] = _mm256_loadu_pd(m.c[j]); hi[j] = _mm256_loadu_pd(m.c[j]+4);
+    }
+    for (int k=0; k < n; ++k) {
+        __m256d ylo = _mm256_setzero_pd(), yhi = ylo;
+        for (int j=0; j < 6; ++j) {
+            const __m256d x = _mm256_broadcast_sd(&v[k].v[j]);
+            ylo = _mm256_fmadd_pd(lo[j], x, ylo);
+            yhi = _mm256_fmadd_pd(hi[j], x, yhi);
+        }
+        _mm256_storeu_pd(mv[k].v, ylo); _mm256_storeu_pd(mv[k].v+4, yhi);
+    }
+}
+
+// The columns of crossMat(l), with a zero where row 3 would be.
+struct CrossColumnsAVX2 {
+    SimTK_TARGET_AVX2 explicit CrossColumnsAVX2(const Vec3& l) {
+        x[0] = _mm256_set_pd(0, -l[1],  l[2],  0);
+        x[1] = _mm256_set_pd(0,  l[0],  0,    -l[2]);
+        x[2] = _mm256_set_pd(0,  0,    -l[0],  l[1]);
+    }
+    __m256d x[3];
+};
+
+SimTK_TARGET_AVX2 static inline void
+shiftColumnAVX2(const CrossColumnsAVX2& x, double* col) {
+    __m256d top = _mm256_loadu_pd(col);
+    top = _mm256_fmadd_pd(x.x[0], _mm256_broadcast_sd(col+3), top);
+    top = _mm256_fmadd_pd(x.x[1], _mm256_broadcast_sd(col+4), top);
+    top = _mm256_fmadd_pd(x.x[2], _mm256_broadcast_sd(col+5), top);
+    _mm256_storeu_pd(col, top);
+}
+
+SimTK_TARGET_AVX2 static void
+shiftVecAVX2(int n, const PhiMatrix* phi, PaddedSpatialVec* v) {
+    for (int k=0; k < n; ++k)
+        shiftColumnAVX2(CrossColumnsAVX2(phi[k].l()), v[k].v);
+}
+
+SimTK_TARGET_AVX2 static void
+shiftMatAVX2(int n, const PhiMatrix* phi, PaddedSpatialMat* m) {
+    for (int k=0; k < n; ++k) {
+        const CrossColumnsAVX2 x(phi[k].l());
+        for (int j=0; j < 6; ++j)
+            shiftColumnAVX2(x, m[k].c[j]);
+    }
+}
+
+// col += a*ca + b*cb, all eight rows.
+SimTK_TARGET_AVX2 static inline void
+addColumnsAVX2(double* col, const double* ca, double a,
+               const double* cb, double b) {
+    const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+    for (int r=0; r < 8; r += 4)
+        _mm256_storeu_pd(col+r, _mm256_fmadd_pd(_mm256_loadu_pd(cb+r), vb,
+            _mm256_fmadd_pd(_mm256_loadu_pd(ca+r), va,
+                            _mm256_loadu_pd(col+r))));
+}
+
+SimTK_TARGET_AVX2 static void
+shiftArticulatedAVX2(int n, const PhiMatrix* phi, PaddedSpatialMat* P) {
+    for (int k=0; k < n; ++k) {
+        const Vec3& s = phi[k].l();
+        double (*c)[8] = P[k].c;
+        addColumnsAVX2(c[0], c[5],  s[1], c[4], -s[2]); // P*~phi
+        addColumnsAVX2(c[1], c[3],  s[2], c[5], -s[0]);
+        addColumnsAVX2(c[2], c[4],  s[0], c[3], -s[1]);
+        const CrossColumnsAVX2 x(s);
+        for (int j=0; j < 6; ++j) // phi*(P*~phi)
+            shiftColumnAVX2(x, c[j]);
+    }
+}
+
+static const KernelTable avx2Kernels =
+{   multiplyAVX2, shiftVecAVX2, shiftMatAVX2, shiftArticulatedAVX2 };
+#endif
+
+#ifdef SimTK_SPATIAL_KERNELS_AVX512
+    //////////////////////
+    //  AVX512 KERNELS  //
+    //////////////////////
+
+// A whole padded column fits in one register.
+
+SimTK_TARGET_AVX512 static void
+multiplyAVX512(const PaddedSpatialMat& m, int n,
+               const PaddedSpatialVec* v, PaddedSpatialVec* mv) {
+    __m512d col[6];
+    for (int j=0; j < 6; ++j)
+        col[j] = _mm512_loadu_pd(m.c[j]);
+    for (int k=0; k < n; ++k) {
+        __m512d y = _mm512_setzero_pd();
+        for (int j=0; j < 6; ++j)
+            y = _mm512_fmadd_pd(col[j], _mm512_set1_pd(v[k].v[j]), y);
+        _mm512_storeu_pd(mv[k].v, y);
+    }
+}
+
+// The columns of crossMat(l), zero below row 2.
+struct CrossColumnsAVX512 {
+    SimTK_TARGET_AVX512 explicit CrossColumnsAVX512(const Vec3& l) {
+        x[0] = _mm512_set_pd(0,0,0,0,0, -l[1],  l[2],  0);
+        x[1] = _mm512_set_pd(0,0,0,0,0,  l[0],  0,    -l[2]);
+        x[2] = _mm512_set_pd(0,0,0,0,0,  0,    -l[0],  l[1]);
+    }
+    __m512d x[3];
+};
+
+SimTK_TARGET_AVX512 static inline __m512d
+shiftColumnAVX512(const CrossColumnsAVX512& x, __m512d col, const double* c) {
+    col = _mm512_fmadd_pd(x.x[0], _mm512_set1_pd(c[3]), col);
+    col = _mm512_fmadd_pd(x.x[1], _mm512_set1_pd(c[4]), col);
+    return _mm512_fmadd_pd(x.x[2], _mm512_set1_pd(c[5]), col);
+}
+
+SimTK_TARGET_AVX512 static void
+shiftVecAVX512(int n, const PhiMatrix* phi, PaddedSpatialVec* v) {
+    for (int k=0; k < n; ++k) {
+        double* c = v[k].v;
+        _mm512_storeu_pd(c, shiftColumnAVX512(CrossColumnsAVX512(phi[k].l()),
+                                              _mm512_loadu_pd(c), c));
+    }
+}
+
+SimTK_TARGET_AVX512 static void
+shiftMatAVX512(int n, const PhiMatrix* phi, PaddedSpatialMat* m) {
+    for (int k=0; k < n; ++k) {
+        const CrossColumnsAVX512 x(phi[k].l());
+        for (int j=0; j < 6; ++j) {
+            double* c = m[k].c[j];
+            _mm512_storeu_pd(c, shiftColumnAVX512(x, _mm512_loadu_pd(c), c));
+        }
+    }
+}
+
+SimTK_TARGET_AVX512 static void
+shiftArticulatedAVX512(int n, const PhiMatrix* phi, PaddedSpatialMat* P) {
+    for (int k=0; k < n; ++k) {
+        const Vec3& s = phi[k].l();
+        double (*c)[8] = P[k].c;
+        __m512d col[6];
+        for (int j=0; j < 6; ++j)
+            col[j] = _mm512_loadu_pd(c[j]);
+        // P*~phi
+        col[0] = _mm512_fmadd_pd(col[5], _mm512_set1_pd( s[1]), col[0]);
+        col[0] = _mm512_fmadd_pd(col[4], _mm512_set1_pd(-s[2]), col[0]);
+        col[1] = _mm512_fmadd_pd(col[3], _mm512_set1_pd( s[2]), col[1]);
+        col[1] = _mm512_fmadd_pd(col[5], _mm512_set1_pd(-s[0]), col[1]);
+        col[2] = _mm512_fmadd_pd(col[4], _mm512_set1_pd( s[0]), col[2]);
+        col[2] = _mm512_fmadd_pd(col[3], _mm512_set1_pd(-s[1]), col[2]);
+        // phi*(P*~phi); the lower halves of the first three columns have
+        // changed so they are stored before being used.
+        const CrossColumnsAVX512 x(s);
+        for (int j=0; j < 6; ++j) {
+            _mm512_storeu_pd(c[j], col[j]);
+            _mm512_storeu_pd(c[j], shiftColumnAVX512(x, col[j], c[j]));
+        }
+    }
+}
+
+static const KernelTable avx512Kernels =
+{   multiplyAVX512, shiftVecAVX512, shiftMatAVX512, shiftArticulatedAVX512 };
+#endif
+
+    //////////////////////////
+    //  RUN TIME DISPATCH   //
+    //////////////////////////
+
+#ifdef SimTK_SPATIAL_KERNELS_AVX2
+static bool cpuSupportsAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const int fma = 1<<12, osxsave = 1<<27, avx = 1<<28;
+    if ((info[2] & (fma|osxsave|avx)) != (fma|osxsave|avx)) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves xmm and ymm
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1<<5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+#ifdef SimTK_SPATIAL_KERNELS_AVX512
+static bool cpuSupportsAVX512() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    if ((info[2] & (1<<27)) == 0) return false; // osxsave
+    if ((_xgetbv(0) & 0xe6) != 0xe6) return false; // OS saves zmm too
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1<<16)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") != 0;
+#endif
+}
+#endif
+
+static const KernelTable* getKernelTable(SpatialKernels::InstructionSet set) {
+    switch (set) {
+    #ifdef SimTK_SPATIAL_KERNELS_SSE2
+    case SpatialKernels::SSE2:   return &sse2Kernels;
+    #endif
+    #ifdef SimTK_SPATIAL_KERNELS_AVX2
+    case SpatialKernels::AVX2:   return &avx2Kernels;
+    #endif
+    #ifdef SimTK_SPATIAL_KERNELS_AVX512
+    case SpatialKernels::AVX512: return &avx512Kernels;
+    #endif
+    case SpatialKernels::Scalar: return &scalarKernels;
+    default:                     return 0;
+    }
+}
+
+static SpatialKernels::InstructionSet& updInstructionSet() {
+    static SpatialKernels::InstructionSet current =
+        SpatialKernels::getBestInstructionSet();
+    return current;
+}
+
+static const KernelTable& getKernels()
+{   return *getKernelTable(updInstructionSet()); }
+
+bool SpatialKernels::isInstructionSetAvailable(InstructionSet set) {
+    switch (set) {
+    case Scalar: return true;
+    #ifdef SimTK_SPATIAL_KERNELS_SSE2
+    case SSE2:   return true;
+    #endif
+    #ifdef SimTK_SPATIAL_KERNELS_AVX2
+    case AVX2:   {static const bool ok = cpuSupportsAVX2(); return ok;}
+    #endif
+    #ifdef SimTK_SPATIAL_KERNELS_AVX512
+    case AVX512: {static const bool ok = cpuSupportsAVX512(); return ok;}
+    #endif
+    default:     return false;
+    }
+}
+
+SpatialKernels::InstructionSet SpatialKernels::getBestInstructionSet() {
+    for (int set=AVX512; set > Scalar; --set)
+        if (isInstructionSetAvailable(InstructionSet(set)))
+            return InstructionSet(set);
+    return Scalar;
+}
+
+SpatialKernels::InstructionSet SpatialKernels::getInstructionSet()
+{   return updInstructionSet(); }
+
+void SpatialKernels::setInstructionSet(InstructionSet set) {
+    SimTK_APIARGCHECK1_ALWAYS(isInstructionSetAvailable(set),
+        "SpatialKernels", "setInstructionSet",
+        "Instruction set %s is not available in this build or on this CPU.",
+        getInstructionSetName(set));
+    updInstructionSet() = set;
+}
+
+const char* SpatialKernels::getInstructionSetName(InstructionSet set) {
+    switch (set) {
+    case Scalar: return "Scalar";
+    case SSE2:   return "SSE2";
+    case AVX2:   return "AVX2";
+    case AVX512: return "AVX512";
+    default:     return "Unknown";
+    }
+}
+
+void SpatialKernels::multiply(const PaddedSpatialMat& m, int n,
+                              const PaddedSpatialVec* v, PaddedSpatialVec* mv)
+{   getKernels().multiply(m, n, v, mv); }
+
+void SpatialKernels::shift(int n, const PhiMatrix* phi, PaddedSpatialVec* v)
+{   getKernels().shiftVec(n, phi, v); }
+
+void SpatialKernels::shift(int n, const PhiMatrix* phi, PaddedSpatialMat* m)
+{   getKernels().shiftMat(n, phi, m); }
+
+void SpatialKernels::shiftArticulated(int n, const PhiMatrix* phi,
+                                      PaddedSpatialMat* P)
+{   getKernels().shiftArticulated(n, phi, P); }
+
+} // namespace SimTK
@@ -42,6 +42,10 @@ namespace SimTK {
  * You can invoke setSeed(int seed) on a Random object to explicitly specify the seed to use.  Each seed
  * value corresponds to a different sequence of numbers that is uncorrelated with all others.
  * 
+ * When a computation is divided among several threads, each needing its own Random object, use
+ * setSeed(int seed, int stream) with a single seed and a different stream number for each thread.  The
+ * results are then reproducible from the one seed regardless of how the threads are scheduled.
+ * 
  * This class is implemented using the SIMD-oriented Fast Mersenne Twister (SFMT) library.  It provides
  * good performance, excellent statistical properties, and a very long period.
  * 
@@ -61,12 +65,23 @@ public:
      * Reinitialize this random number generator with a new seed value.
      */
     void setSeed(int seed);
+    /**
+     * Reinitialize this random number generator to produce one of many separate streams of numbers
+     * derived from a single seed.  The seed and stream number together form the key from which the
+     * generator's state is initialized, so each (seed, stream) pair gives a different sequence.  The
+     * streams are not guaranteed to be non-overlapping, since they are not produced by jumping ahead in
+     * the period of 2^19937-1; they are only as unrelated as sequences from different seeds.  The stream
+     * number must be nonnegative.  The sequence for (seed, 0) is not the same as the one produced by
+     * setSeed(seed).
+     */
+    void setSeed(int seed, int stream);
     /**
      * Get the next value in the pseudo-random sequence.
      */
     Real getValue() const;
     /**
-     * Fill an array with values from the pseudo-random sequence.
+     * Fill an array with values from the pseudo-random sequence.  The values are the same as would be
+     * returned by \a length calls to getValue(), but for Random::Gaussian this is considerably faster.
      */
     void fillArray(Real array[], int length) const;
 protected:
@@ -135,7 +150,9 @@ private:
 
 /**
  * This is a subclass of Random that generates numbers according to a Gaussian distribution with a
- * specified mean and standard deviation.
+ * specified mean and standard deviation.  Values are generated with the ziggurat method, which for
+ * most values needs only a single table lookup and comparison; use fillArray() when you need many
+ * values at once.
  */
 
 class SimTK_SimTKCOMMON_EXPORT Random::Gaussian : public Random {
@@ -41,7 +41,10 @@ class Random::RandomImpl {
 private:
     mutable SimTK_SFMT::SFMTData* sfmt;
     static const int bufferSize = 1024;
-    mutable uint64_t buffer[bufferSize];
+    // SFMT's SSE2 block generator requires a 16 byte aligned buffer, which
+    // the default alignment of a uint64_t member does not guarantee.
+    mutable uint64_t bufferStorage[bufferSize+1];
+    uint64_t* buffer;
     mutable int nextIndex;
     static AtomicInteger nextSeed;
 public:
@@ -50,6 +53,7 @@ public:
     
     RandomImpl() {
         sfmt = createSFMTData();
+        buffer = bufferStorage + ((size_t)bufferStorage % 16 != 0);
         nextIndex = bufferSize;
         init_gen_rand(++nextSeed, *sfmt);
     }
@@ -62,24 +66,39 @@ public:
         nextIndex = bufferSize;
         init_gen_rand(seed, *sfmt);
     }
+
+    // Initializing the SFMT state from the key (seed, stream) rather than 
+    // from the seed alone gives each stream its own starting point, chosen
+    // as though at random in the generator's period of 2^19937-1.
+    void setSeed(int seed, int stream) {
+        uint32_t key[2] = {(uint32_t)seed, (uint32_t)stream};
+        nextIndex = bufferSize;
+        init_by_array(key, 2, *sfmt);
+    }
     
     virtual Real getValue() const = 0;
 
-    Real getNextRandom() const {
+    // Return the next 64 random bits, refilling the buffer from SFMT's
+    // block generator when necessary.
+    uint64_t getNextRandomBits() const {
         if (nextIndex >= bufferSize) {
             // There are no remaining values in the buffer, so we need to refill it.
             
             fill_array64(buffer, bufferSize, *sfmt);
             nextIndex = 0;
         }
-        return to_res53(buffer[nextIndex++]);
+        return buffer[nextIndex++];
+    }
+
+    Real getNextRandom() const {
+        return to_res53(getNextRandomBits());
     }
 
     int getInt(int max) {
         return (int) floor(getValue()*max);
     }
 
-    void fillArray(Real array[], int length) const {
+    virtual void fillArray(Real array[], int length) const {
         for (int i = 0; i < length; ++i)
             array[i] = getValue();
     }
@@ -121,6 +140,45 @@ public:
     }
 };
 
+/**
+ * These are the tables for the ziggurat method of generating normally 
+ * distributed numbers, in the form given by J.A. Doornik, "An Improved 
+ * Ziggurat Method to Generate Normal Random Samples" (2005). The area under
+ * the density is covered by 128 horizontal layers of equal area; layer 0 is
+ * the base layer and includes the tail beyond R.
+ */
+
+namespace {
+class ZigguratTables {
+public:
+    static const int NumLayers = 128;
+    ZigguratTables() {
+        const double R = tailStart(), V = 9.91256303526217e-3; // layer area
+        double f = std::exp(-0.5*R*R);
+        x[0] = V/f;
+        x[1] = R;
+        x[NumLayers] = 0;
+        for (int i = 2; i < NumLayers; ++i) {
+            x[i] = std::sqrt(-2*std::log(V/x[i-1] + f));
+            f = std::exp(-0.5*x[i]*x[i]);
+        }
+        for (int i = 0; i < NumLayers; ++i)
+            ratio[i] = x[i+1]/x[i];
+    }
+    static double tailStart() {return 3.442619855899;}
+
+    double x[NumLayers+1];  // right edge of each layer
+    double ratio[NumLayers];// x[i+1]/x[i]; inside that, no test is needed
+};
+
+// The tables are built on first use rather than during static initialization,
+// so that a Random::Gaussian created by another static initializer works.
+const ZigguratTables& getZigguratTables() {
+    static const ZigguratTables tables;
+    return tables;
+}
+}
+
 /**
  * This is the private implementation class for Gaussian random numbers.
  */
@@ -128,36 +186,54 @@ public:
 class Random::Gaussian::GaussianImpl : public Random::RandomImpl {
 private:
     Real mean, stddev;
-    mutable Real nextGaussian;
-    mutable bool nextGaussianIsValid;
+    const ZigguratTables& zig;
 public:
-    GaussianImpl(Real mean, Real stddev) : mean(mean), stddev(stddev) {
-        nextGaussianIsValid = false;
+    GaussianImpl(Real mean, Real stddev) 
+    :   mean(mean), stddev(stddev), zig(getZigguratTables()) {
     }
     
     Real getValue() const {
-        if (nextGaussianIsValid) {
-            nextGaussianIsValid = false;
-            return mean+stddev*nextGaussian;
+        return mean+stddev*getNormal();
+    }
+
+    // Calling getNormal() directly avoids a virtual function call for each
+    // value, and produces exactly the same sequence as getValue().
+    void fillArray(Real array[], int length) const {
+        for (int i = 0; i < length; ++i)
+            array[i] = mean+stddev*getNormal();
+    }
+
+    // Use the ziggurat method to generate a number from the standard normal
+    // distribution. About 99% of the time this takes just one set of 64 
+    // random bits, of which the low 7 select the layer and the high 53 give a
+    // uniform value in [-1,1), and involves no transcendental functions.
+    Real getNormal() const {
+        for (;;) {
+            const uint64_t bits = getNextRandomBits();
+            const int      i    = (int)(bits & (ZigguratTables::NumLayers-1));
+            const double   u    = 2*to_res53(bits) - 1;
+            if (std::abs(u) < zig.ratio[i])
+                return (Real)(u*zig.x[i]);
+            if (i == 0)
+                return (Real)getTail(u < 0);
+            // In the part of layer i that sticks out past the density curve.
+            const double x  = u*zig.x[i];
+            const double f0 = std::exp(-0.5*(zig.x[i]*zig.x[i] - x*x));
+            const double f1 = std::exp(-0.5*(zig.x[i+1]*zig.x[i+1] - x*x));
+            if (f1 + getNextRandom()*(f0-f1) < 1)
+                return (Real)x;
         }
-        
-        // Use the polar form of the Box-Muller transformation to generate two Gaussian random numbers.
-        
-        Real x, y, r2;
-        do {
-            x = 2.0*getNextRandom()-1.0;
-            y = 2.0*getNextRandom()-1.0;
-            r2 = x*x + y*y;
-        } while (r2 >= 1.0 || r2 == 0.0);
-        Real multiplier = sqrt((-2.0*log(r2))/r2);
-        nextGaussian = y*multiplier;
-        nextGaussianIsValid = true;
-        return mean+stddev*x*multiplier;
     }
-    
-    void setSeed(int seed) {
-        RandomImpl::setSeed(seed);
-        nextGaussianIsValid = false;
+
+    // Generate a value from the tail beyond R, using Marsaglia's method.
+    double getTail(bool negative) const {
+        const double R = ZigguratTables::tailStart();
+        double x, y;
+        do {
+            x = std::log(1-getNextRandom())/R; // 1-u is in (0,1]
+            y = std::log(1-getNextRandom());
+        } while (-2*y < x*x);
+        return negative ? x-R : R-x;
     }
     
     Real getMean() const {
@@ -198,6 +274,12 @@ void Random::setSeed(int seed) {
     getImpl().setSeed(seed);
 }
 
+void Random::setSeed(int seed, int stream) {
+    SimTK_APIARGCHECK1_ALWAYS(stream >= 0, "Random", "setSeed",
+        "The stream number %d must not be negative.", stream);
+    getImpl().setSeed(seed, stream);
+}
+
 Real Random::getValue() const {
     return getConstImpl().getValue();
 }
@@ -28,6 +28,12 @@
   #endif
 #undef ONLY64
 #endif
+/* Use the SSE2 recursion on any target where the compiler provides SSE2. */
+#if !defined(HAVE_ALTIVEC) && !defined(HAVE_SSE2) \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAVE_SSE2 1
+#endif
 /*------------------------------------------------------
   128-bit SIMD data type for Altivec, SSE2 or standard C
   ------------------------------------------------------*/
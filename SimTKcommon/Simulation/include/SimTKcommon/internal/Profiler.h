@@ -0,0 +1,175 @@
+#ifndef SimTK_SimTKCOMMON_PROFILER_H_
+#define SimTK_SimTKCOMMON_PROFILER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/internal/Stage.h"
+#include "SimTKcommon/internal/Timing.h"
+
+#include <iosfwd>
+
+namespace SimTK {
+
+/** This class accumulates wall clock and CPU time spent in named sections of
+code, such as the realization of a particular Stage of a System, Subsystem, or
+Force element. Every System owns one, accessed with System::getProfiler() and
+System::updProfiler(); it is disabled by default. When disabled, the cost of a
+Profiler::Sample is a single test of a bool and no clocks are read.
+
+Each entry is identified by a category (for example "System", "Subsystem", or
+"Force"), a name within that category, and a Stage. For each entry we keep the
+number of calls, the total wall clock and CPU time, and the shortest and
+longest wall clock time of any single call. Times include the time spent in
+nested sections, so for example the time for the "System" entry at
+Stage::Dynamics includes the time for each "Subsystem" entry at that Stage.
+
+Recording is thread safe, so a section may be timed on a worker thread. CPU
+time is measured with threadCpuTime() on the thread that executed the section,
+so the sum of CPU times may exceed the wall clock time when sections run
+concurrently.
+
+@code
+    system.updProfiler().setEnabled(true);
+    integ.stepTo(finalTime);
+    system.getProfiler().writeTable(std::cout);
+@endcode **/
+class SimTK_SimTKCOMMON_EXPORT Profiler {
+public:
+    /** This is the accumulated timing information for one profiled section.
+    Times are in seconds. **/
+    struct Entry {
+        Entry() : stage(Stage::Empty), numCalls(0), wallTime(0), cpuTime(0),
+                  minWallTime(0), maxWallTime(0) {}
+        String      category;
+        String      name;
+        Stage       stage;
+        long long   numCalls;
+        double      wallTime, cpuTime;
+        double      minWallTime, maxWallTime;
+
+        /** Return the average wall clock time per call. **/
+        double getMeanWallTime() const
+        {   return numCalls ? wallTime/numCalls : 0.; }
+    };
+
+    /** Create an empty, disabled Profiler. **/
+    Profiler();
+    /** Copying a Profiler copies its enabled setting and its entries. **/
+    Profiler(const Profiler& src);
+    /** Copy assignment replaces this Profiler's entries with those of
+    \a src. **/
+    Profiler& operator=(const Profiler& src);
+    ~Profiler();
+
+    /** Turn profiling on or off. Entries recorded so far are retained; use
+    clear() to discard them. **/
+    void setEnabled(bool enable) {enabled = enable;}
+    /** Return true if this Profiler is currently recording samples. **/
+    bool isEnabled() const {return enabled;}
+
+    /** Discard all entries, without changing the enabled setting. **/
+    void clear();
+
+    /** Add one call of the indicated duration to the entry identified by
+    \a category, \a name, and \a stage, creating the entry if necessary. This
+    is normally invoked by a Sample object rather than called directly. The
+    Profiler's contents are mutable; recording a sample is not considered
+    a change to the Profiler. This method may be called from several threads
+    at once. **/
+    void record(const char* category, const String& name, Stage stage,
+                long long wallTimeInNs, double cpuTime) const;
+
+    /** Return the number of distinct entries recorded. **/
+    int getNumEntries() const;
+    /** Return the entry with index \a i, 0 <= i < getNumEntries(). Entries
+    are kept in the order in which they were first recorded. The returned
+    reference may be invalidated if new entries are recorded, so don't hold
+    on to it while the System is being realized on another thread. **/
+    const Entry& getEntry(int i) const;
+    /** Return the index of the entry identified by \a category, \a name,
+    and \a stage, or -1 if no such entry has been recorded. **/
+    int findEntry(const String& category, const String& name,
+                  Stage stage) const;
+
+    /** Write all the entries as a text table, one line per entry, sorted
+    with the most total wall clock time first. **/
+    void writeTable(std::ostream& o) const;
+    /** Write all the entries as a JSON array of objects, in the same order
+    as writeTable(). **/
+    void writeJSON(std::ostream& o) const;
+
+    /** Create a Sample on the stack to time the enclosing block. If the
+    Profiler is disabled when the Sample is constructed, nothing is
+    recorded. The name may be given either as a String or, to avoid
+    formatting one when profiling is disabled, as an index that is converted
+    to a String only when the sample is recorded. **/
+    class Sample {
+    public:
+        Sample(const Profiler& profiler, const char* category,
+               const String& name, Stage stage)
+        :   profiler(profiler.isEnabled() ? &profiler : 0),
+            category(category), name(&name), index(-1), stage(stage)
+        {   if (this->profiler) start(); }
+
+        Sample(const Profiler& profiler, const char* category,
+               int index, Stage stage)
+        :   profiler(profiler.isEnabled() ? &profiler : 0),
+            category(category), name(0), index(index), stage(stage)
+        {   if (this->profiler) start(); }
+
+        ~Sample() {if (profiler) stop();}
+    private:
+        void start() {
+            cpuStart  = threadCpuTime();
+            wallStart = realTimeInNs();
+        }
+        void stop() {
+            const long long wall = realTimeInNs() - wallStart;
+            const double    cpu  = threadCpuTime() - cpuStart;
+            profiler->record(category, name ? *name : String(index),
+                             stage, wall, cpu);
+        }
+
+        const Profiler* profiler;
+        const char*     category;
+        const String*   name;
+        int             index;
+        Stage           stage;
+        long long       wallStart;
+        double          cpuStart;
+
+        Sample(const Sample&);              // suppress
+        Sample& operator=(const Sample&);   // suppress
+    };
+
+private:
+    class ProfilerRep;
+    bool            enabled;
+    ProfilerRep*    rep;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_PROFILER_H_
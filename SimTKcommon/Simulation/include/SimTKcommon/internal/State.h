@@ -153,6 +153,8 @@ SimTK_DEFINE_UNIQUE_INDEX_TYPE(MultiplierIndex);
 /// but is allowed as a cache value which is guaranteed never to look valid. 
 typedef int StageVersion;
 
+class StateCheckpoint;
+
 
 /** This is the handle class for the hidden State implementation.
 
@@ -1044,6 +1046,41 @@ then the first unrealized stage is returned if all the lower versions match.
 Stage getLowestSystemStageDifference
    (const Array_<StageVersion>& prevVersions) const;
 
+/** (Advanced) Save the time, the continuous state variables y, and all the
+discrete variables of this %State into \a checkpoint so that this %State can
+later be put back exactly as it is now with restoreCheckpoint(). If
+\a includeCache is true and this %State has been realized to at least
+Stage::Instance, the cache entries and shared cache arrays that depend on
+Stage::Time or later are saved too, along with the current stage, so that
+a restore does not require re-realization. The %State must have been
+realized to at least Stage::Model.
+
+Space for the saved values is allocated the first time a checkpoint is saved
+from a %State of a particular layout; after that, saving into the same
+checkpoint reuses that space. This is intended for Monte Carlo loops that
+repeatedly save a %State, run a trial, and then either accept the result or
+go back to the saved %State.
+@see restoreCheckpoint(), StateCheckpoint **/
+void saveCheckpoint(StateCheckpoint& checkpoint, bool includeCache=true) const;
+
+/** (Advanced) Put back the time, continuous state variables, and discrete
+variables that were saved in \a checkpoint by saveCheckpoint(). Values are
+written in place; nothing is reallocated. The checkpoint must have been saved
+from this %State, or a copy of it, and nothing at Stage::Model or below may
+have been changed since then; otherwise an exception is thrown.
+
+If nothing at Stage::Instance or below has changed since the checkpoint was
+saved, Instance stage and lower cache entries are left alone. In that case,
+if the checkpoint also includes the cache, all the later cache entries and
+the stage this %State had reached are restored too, so the %State is
+realized exactly as far as it was when it was saved; the versions of the
+restored stages are advanced rather than set back to their saved values, so
+anything recorded since the save is seen as out of date. Otherwise Stage::Time
+is invalidated. If something at Stage::Instance changed, Stage::Instance is
+invalidated instead and the saved cache, if any, is not used.
+@see saveCheckpoint(), StateCheckpoint **/
+void restoreCheckpoint(const StateCheckpoint& checkpoint);
+
 /** (Advanced) This explicitly modifies the Topology stage version; don't
 use this method unless you know what you're doing! This can be used to force
 compatibility with a System that has had Topology changes since this %State
@@ -1067,7 +1104,44 @@ const StateImpl& getImpl() const {assert(impl); return *impl;}
 StateImpl&       updImpl()       {assert(impl); return *impl;}
 };
 
-SimTK_SimTKCOMMON_EXPORT std::ostream& 
+/** This is a reusable buffer that holds a snapshot of a State as saved by
+State::saveCheckpoint(), for later use by State::restoreCheckpoint(). It is
+much cheaper than copying the State because the space for the saved values
+is retained between uses, and because the snapshot can include the realized
+cache so that restoring does not require re-realization. A default-
+constructed checkpoint is empty. **/
+class SimTK_SimTKCOMMON_EXPORT StateCheckpoint {
+public:
+/// Create an empty checkpoint.
+StateCheckpoint();
+~StateCheckpoint();
+
+/// Discard any saved contents and free the space they used.
+void clear();
+
+/// Return true if nothing has been saved into this checkpoint.
+bool isEmpty() const;
+
+/// Return true if the realized cache was saved along with the variables.
+bool hasCache() const;
+
+/// Return the time of the saved State. This is NaN if the checkpoint is
+/// empty.
+Real getTime() const;
+
+//------------------------------------------------------------------------------
+                                private:
+// Suppress copying; a checkpoint is a buffer tied to a particular State.
+StateCheckpoint(const StateCheckpoint&);
+StateCheckpoint& operator=(const StateCheckpoint&);
+
+friend class State;
+class StateCheckpointImpl* impl;
+const StateCheckpointImpl& getImpl() const {assert(impl); return *impl;}
+StateCheckpointImpl&       updImpl()       {assert(impl); return *impl;}
+};
+
+SimTK_SimTKCOMMON_EXPORT std::ostream&
 operator<<(std::ostream& o, const State& s);
 
 } // namespace SimTK
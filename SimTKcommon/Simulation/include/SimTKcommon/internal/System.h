@@ -28,6 +28,7 @@
 #include "SimTKcommon/Simmatrix.h"
 #include "SimTKcommon/internal/State.h"
 #include "SimTKcommon/internal/Subsystem.h"
+#include "SimTKcommon/internal/Profiler.h"
 
 #include <cassert>
 
@@ -92,7 +93,20 @@ be implemented by %System Developers in the concrete %System are defined there,
 along with other utilities of use to the concrete %System Developer but not to 
 the end user or numerical integrator. The System::Guts class is declared 
 in a separate header file, and only people who are writing their own %System
-classes need look there. **/
+classes need look there. 
+
+<h3>Thread safety</h3>
+Once realizeTopology() has been called, the const methods of a %System 
+(realize(), project(), prescribeQ(), handleEvents() and so on) may be called
+concurrently from different threads provided that each thread is working on
+its own State; everything they compute is stored in that State's cache. This
+is how EnsembleStepper advances many replicas of one %System at once. The 
+%System must not be modified while that is going on, and the statistics 
+counters are not synchronized so their values are unreliable afterwards. Note
+also that the event handlers, event reporters, force elements and Function
+objects owned by the %System are shared by all the threads, so any that are 
+written to modify their own data when called are not safe to use this 
+way. **/
 class SimTK_SimTKCOMMON_EXPORT System {
 public:
 class Guts; // local; name is System::Guts
@@ -666,11 +680,41 @@ void multiplyByNPInvTranspose(const State& state, const Vector& fu,
                               Vector& fq) const;
 /**@}**/
 
+//------------------------------------------------------------------------------
+/**@name                  Jacobian-vector products
+
+These methods are for use by implicit numerical integration methods.
+
+The Newton iterations of an implicit integrator need the Jacobian J=d ydot/d y
+of the system of ordinary differential equations ydot=f(t,y). A Krylov 
+(iterative) linear solver needs only products J*v, never J itself. A %System 
+that knows the structure of its equations may be able to form those products
+more cheaply or more accurately than a difference quotient of complete 
+realizations, which is what an integrator has to do otherwise. **/
+/**@{**/
+/** Calculate Jv=J*v, where J is the Jacobian of the %System's differential
+equations at the given \a state, which must have been realized through 
+Stage::Position. \a ydot must be the time derivative of y already calculated
+for \a state, and \a v must be the same size as y. Any part of the product 
+that has to be obtained numerically uses a perturbation of \a increment*v 
+from the current y. On return the state variables are as they were on entry,
+but \a state may have been realized only through Stage::Time.
+
+Returns false, leaving \a state and \a Jv unchanged, if the %System has no 
+better way to calculate Jv than the caller's own difference quotient of ydot;
+that is the default behavior. **/
+bool calcYDotJacobianTimesVector(State& state, const Vector& ydot,
+                                 const Vector& v, Real increment,
+                                 Vector& Jv) const;
+/**@}**/
+
 //------------------------------------------------------------------------------
 /**@name                         Statistics
 
 The %System keeps mutable statistics internally, initialized to zero at 
-construction. These <em>must not</em> affect results in any way. **/
+construction. These <em>must not</em> affect results in any way. They are not
+protected against concurrent updates, so they may undercount when the %System
+is being realized from several threads at once. **/
 /**@{**/
 
 /** Zero out the statistics for this System. Although the statistics are 
@@ -739,6 +783,26 @@ of the outcome. **/
 int getNumReportEventCalls() const;
 /**@}**/
 
+//------------------------------------------------------------------------------
+/**@name                         Profiling
+
+The %System owns a Profiler that can record where the time goes during 
+realization. It is disabled by default and costs almost nothing in that case.
+When enabled, it accumulates wall clock and CPU time for each realize() Stage 
+of the %System as a whole (category "System"), of each Subsystem (category
+"Subsystem", named by Subsystem::getName()), and of each Force element in a 
+GeneralForceSubsystem (category "Force", named by its ForceIndex). As with the
+statistics above, profiling <em>must not</em> affect results in any way. **/
+/**@{**/
+/** Get read-only access to this %System's Profiler, for example to query
+its entries or write them out with Profiler::writeTable() or 
+Profiler::writeJSON() at the end of a run. **/
+const Profiler& getProfiler() const;
+/** Get writable access to this %System's Profiler, so that you can enable,
+disable, or clear it. **/
+Profiler& updProfiler();
+/**@}**/
+
 //------------------------------------------------------------------------------
 /**@name                Construction and bookkeeping
 
@@ -151,6 +151,10 @@ public:
     bool prescribeQ(State&) const;
     bool prescribeU(State&) const;
 
+    bool calcYDotJacobianTimesVector(State&, const Vector& ydot, 
+                                     const Vector& v, Real increment,
+                                     Vector& Jv) const;
+
     void projectQ(State&, Vector& qErrEst, 
                   const ProjectOptions& options, ProjectResults& results) const;
     void projectU(State&, Vector& uErrEst, 
@@ -208,6 +212,12 @@ protected:
     virtual bool prescribeQImpl(State&) const {return false;}
     virtual bool prescribeUImpl(State&) const {return false;}
 
+    // Default says there is no Jacobian-vector product available, so the
+    // caller must use a difference quotient of the system derivatives.
+    virtual bool calcYDotJacobianTimesVectorImpl
+       (State&, const Vector& ydot, const Vector& v, Real increment,
+        Vector& Jv) const {return false;}
+
     // Defaults assume no constraints and return success meaning "all 
     // constraints satisfied".
     virtual void projectQImpl(State&, Vector& qErrEst, 
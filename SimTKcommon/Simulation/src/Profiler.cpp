@@ -0,0 +1,226 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,         *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/Profiler.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace SimTK {
+
+//==============================================================================
+//                              PROFILER REP
+//==============================================================================
+// Entries are kept in an array in the order first recorded, with a map from
+// (category, name, stage) to the array index so that recording a sample does
+// not require a linear search. The lock protects both.
+class Profiler::ProfilerRep {
+public:
+    ProfilerRep() {pthread_mutex_init(&lock, NULL);}
+    ProfilerRep(const ProfilerRep& src)
+    :   entries(src.entries), index(src.index)
+    {   pthread_mutex_init(&lock, NULL); }
+    ~ProfilerRep() {pthread_mutex_destroy(&lock);}
+
+    struct Key {
+        Key(const String& category, const String& name, Stage stage)
+        :   category(category), name(name), stage(stage) {}
+        bool operator<(const Key& other) const {
+            if (stage != other.stage) return stage < other.stage;
+            if (category != other.category) return category < other.category;
+            return name < other.name;
+        }
+        std::string category, name;
+        int         stage;
+    };
+
+    Array_<Entry>       entries;
+    std::map<Key,int>   index;
+    pthread_mutex_t     lock;
+private:
+    ProfilerRep& operator=(const ProfilerRep&); // suppress
+};
+
+Profiler::Profiler() : enabled(false), rep(new ProfilerRep()) {}
+
+Profiler::Profiler(const Profiler& src)
+:   enabled(src.enabled), rep(new ProfilerRep(*src.rep)) {}
+
+Profiler& Profiler::operator=(const Profiler& src) {
+    if (&src != this) {
+        ProfilerRep* copy = new ProfilerRep(*src.rep);
+        delete rep;
+        rep = copy;
+        enabled = src.enabled;
+    }
+    return *this;
+}
+
+Profiler::~Profiler() {delete rep;}
+
+void Profiler::clear() {
+    pthread_mutex_lock(&rep->lock);
+    rep->entries.clear();
+    rep->index.clear();
+    pthread_mutex_unlock(&rep->lock);
+}
+
+void Profiler::record(const char* category, const String& name, Stage stage,
+                      long long wallTimeInNs, double cpuTime) const {
+    const double wallTime = nsToSec(wallTimeInNs);
+    const ProfilerRep::Key key(category, name, stage);
+
+    pthread_mutex_lock(&rep->lock);
+    std::map<ProfilerRep::Key,int>::const_iterator p = rep->index.find(key);
+    int i;
+    if (p == rep->index.end()) {
+        i = (int)rep->entries.size();
+        rep->index.insert(std::make_pair(key, i));
+        rep->entries.push_back(Entry());
+        Entry& e = rep->entries.back();
+        e.category = category; e.name = name; e.stage = stage;
+        e.minWallTime = wallTime;
+    } else i = p->second;
+
+    Entry& e = rep->entries[i];
+    ++e.numCalls;
+    e.wallTime += wallTime;
+    e.cpuTime  += cpuTime;
+    e.minWallTime = std::min(e.minWallTime, wallTime);
+    e.maxWallTime = std::max(e.maxWallTime, wallTime);
+    pthread_mutex_unlock(&rep->lock);
+}
+
+int Profiler::getNumEntries() const {return (int)rep->entries.size();}
+
+const Profiler::Entry& Profiler::getEntry(int i) const {
+    SimTK_INDEXCHECK_ALWAYS(i, getNumEntries(), "Profiler::getEntry()");
+    return rep->entries[i];
+}
+
+int Profiler::findEntry(const String& category, const String& name,
+                        Stage stage) const {
+    pthread_mutex_lock(&rep->lock);
+    std::map<ProfilerRep::Key,int>::const_iterator p =
+        rep->index.find(ProfilerRep::Key(category, name, stage));
+    const int i = p == rep->index.end() ? -1 : p->second;
+    pthread_mutex_unlock(&rep->lock);
+    return i;
+}
+
+namespace {
+// Order entry indices by decreasing total wall time; ties keep the order in
+// which the entries were first recorded.
+class MoreWallTime {
+public:
+    explicit MoreWallTime(const Array_<Profiler::Entry>& entries)
+    :   entries(entries) {}
+    bool operator()(int a, int b) const {
+        if (entries[a].wallTime != entries[b].wallTime)
+            return entries[a].wallTime > entries[b].wallTime;
+        return a < b;
+    }
+private:
+    const Array_<Profiler::Entry>& entries;
+};
+
+Array_<int> sortByWallTime(const Array_<Profiler::Entry>& entries) {
+    Array_<int> order((int)entries.size());
+    for (int i=0; i < (int)order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), MoreWallTime(entries));
+    return order;
+}
+
+void writeJSONString(std::ostream& o, const String& s) {
+    o << '"';
+    for (int i=0; i < (int)s.size(); ++i) {
+        const char c = s[i];
+        switch (c) {
+        case '"':  o << "\\\""; break;
+        case '\\': o << "\\\\"; break;
+        case '\n': o << "\\n";  break;
+        case '\t': o << "\\t";  break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                std::sprintf(buf, "\\u%04x", (unsigned)(unsigned char)c);
+                o << buf;
+            } else o << c;
+        }
+    }
+    o << '"';
+}
+}
+
+void Profiler::writeTable(std::ostream& o) const {
+    pthread_mutex_lock(&rep->lock);
+    const Array_<Entry> entries = rep->entries;
+    pthread_mutex_unlock(&rep->lock);
+
+    const Array_<int> order = sortByWallTime(entries);
+    char buf[256];
+    std::sprintf(buf, "%10s %12s %12s %12s %12s %12s\n", "calls", "wall(s)",
+                 "cpu(s)", "mean(us)", "min(us)", "max(us)");
+    o << std::left << std::setw(10) << "category" << " " << std::setw(24)
+      << "name" << " " << std::setw(12) << "stage" << " " << buf;
+    for (int k=0; k < (int)order.size(); ++k) {
+        const Entry& e = entries[order[k]];
+        std::sprintf(buf, "%10lld %12.6f %12.6f %12.3f %12.3f %12.3f\n",
+                     e.numCalls, e.wallTime, e.cpuTime, 1e6*e.getMeanWallTime(),
+                     1e6*e.minWallTime, 1e6*e.maxWallTime);
+        o << std::setw(10) << e.category << " " << std::setw(24) << e.name
+          << " " << std::setw(12) << e.stage.getName() << " " << buf;
+    }
+    o << std::right;
+}
+
+void Profiler::writeJSON(std::ostream& o) const {
+    pthread_mutex_lock(&rep->lock);
+    const Array_<Entry> entries = rep->entries;
+    pthread_mutex_unlock(&rep->lock);
+
+    const Array_<int> order = sortByWallTime(entries);
+    o << "[";
+    for (int k=0; k < (int)order.size(); ++k) {
+        const Entry& e = entries[order[k]];
+        o << (k ? ",\n " : "\n ") << "{\"category\": ";
+        writeJSONString(o, e.category);
+        o << ", \"name\": ";
+        writeJSONString(o, e.name);
+        o << ", \"stage\": ";
+        writeJSONString(o, e.stage.getName());
+        o << ", \"calls\": " << e.numCalls
+          << ", \"wallTime\": " << String(e.wallTime)
+          << ", \"cpuTime\": " << String(e.cpuTime)
+          << ", \"minWallTime\": " << String(e.minWallTime)
+          << ", \"maxWallTime\": " << String(e.maxWallTime) << "}";
+    }
+    o << "\n]\n";
+}
+
+} // namespace SimTK
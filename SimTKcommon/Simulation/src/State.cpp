@@ -89,6 +89,16 @@ static void copyAllocationStackThroughStage
         stack[i].deepAssign(src[i]);
 }
 
+// Make this stack entry contain a copy of the source entry's value, reusing
+// the value object it already has if that is of the same type. This is for
+// buffers that are refilled over and over from the same State.
+template <class T>
+static void reuseOrDeepAssign(T& dest, const T& src) {
+    if (dest.hasValue() && !dest.getValue().isCompatible(src.getValue()))
+        dest.deepDestruct();
+    dest.deepAssign(src);
+}
+
 // These local classes
 //      DiscreteVarInfo
 //      CacheVarInfo
@@ -145,6 +155,7 @@ public:
     // For use in the containing class's destructor.
     void deepDestruct() {delete value; value=0;}
     const Stage& getAllocationStage()  const {return allocationStage;}
+    bool hasValue() const {return value != 0;}
 
     // Exchange value pointers (should be from this dv's update cache entry).
     void swapValue(Real updTime, AbstractValue*& other) 
@@ -224,6 +235,7 @@ public:
     // For use in the containing class's destructor.
     void deepDestruct() {delete value; value=0;}
     const Stage& getAllocationStage() const {return allocationStage;}
+    bool hasValue() const {return value != 0;}
 
     // Exchange values with a discrete variable (presumably this
     // cache entry has been determined to be that variable's update
@@ -773,6 +785,70 @@ private:
 };
 
 
+
+//==============================================================================
+//                            STATE CHECKPOINT IMPL
+//==============================================================================
+// This holds the values saved by StateImpl::saveCheckpoint(). The discrete
+// variable and cache entry values are owned here, as they are in a
+// PerSubsystemInfo, and are reused by deepAssign() on subsequent saves from
+// a State with the same layout.
+class StateCheckpointImpl {
+public:
+    class SavedSubsystem {
+    public:
+        SavedSubsystem() : currentStage(Stage::Empty) {}
+
+        // Default copy constructor, copy assignment, destructor are shallow;
+        // call deepDestruct() before discarding one of these.
+        void deepDestruct() {
+            clearAllocationStack(discreteInfo);
+            clearAllocationStack(cacheInfo);
+            cacheIndex.clear();
+        }
+
+        Stage                   currentStage;
+        StageVersion            stageVersions[Stage::NValid];
+        Array_<DiscreteVarInfo> discreteInfo;
+
+        // Only the cache entries that depend on stages later than Instance
+        // are saved; cacheIndex says where each one came from.
+        Array_<CacheEntryIndex> cacheIndex;
+        Array_<CacheEntryInfo>  cacheInfo;
+    };
+
+    StateCheckpointImpl()
+    :   t(NaN), systemStage(Stage::Empty), cacheSaved(false) {}
+
+    ~StateCheckpointImpl() {clear();}
+
+    void clear() {
+        for (unsigned i=0; i < subsystems.size(); ++i)
+            subsystems[i].deepDestruct();
+        subsystems.clear();
+        t = NaN; y.clear();
+        ydot.clear(); qdotdot.clear(); yerr.clear();
+        udoterr.clear(); multipliers.clear(); allTriggers.clear();
+        systemStage = Stage::Empty;
+        cacheSaved = false;
+    }
+
+    bool isEmpty() const {return subsystems.empty();}
+
+    Real                    t;
+    Vector                  y;
+    Stage                   systemStage;
+    StageVersion            systemStageVersions[Stage::NValid];
+
+    // These are saved only if cacheSaved is true.
+    bool                    cacheSaved;
+    Vector                  ydot, qdotdot, yerr, udoterr, multipliers;
+    Vector                  allTriggers;
+
+    Array_<SavedSubsystem>  subsystems;
+};
+
+
 //==============================================================================
 //                                 STATE IMPL
 //==============================================================================
@@ -2153,6 +2229,162 @@ public:
                                                : g; // 1st unrealized stage
     }
 
+    // Save the variables, and optionally the cache entries that depend on
+    // stages after Instance, into the checkpoint. Space already in the
+    // checkpoint is reused whenever the layout permits.
+    void saveCheckpoint(StateCheckpointImpl& ck, bool includeCache) const {
+        SimTK_STAGECHECK_GE_ALWAYS(currentSystemStage, Stage::Model,
+            "State::saveCheckpoint()");
+
+        if (ck.subsystems.size() != subsystems.size()) {
+            ck.clear();
+            ck.subsystems.resize(subsystems.size());
+        }
+
+        ck.t = t;
+        ck.y = y;
+        ck.systemStage = currentSystemStage;
+        for (int i=0; i < Stage::NValid; ++i)
+            ck.systemStageVersions[i] = systemStageVersions[i];
+
+        ck.cacheSaved = includeCache && currentSystemStage >= Stage::Instance;
+
+        for (SubsystemIndex sx(0); sx < (int)subsystems.size(); ++sx) {
+            const PerSubsystemInfo& ss = subsystems[sx];
+            StateCheckpointImpl::SavedSubsystem& saved = ck.subsystems[sx];
+
+            saved.currentStage = ss.currentStage;
+            for (int i=0; i < Stage::NValid; ++i)
+                saved.stageVersions[i] = ss.stageVersions[i];
+
+            if (saved.discreteInfo.size() != ss.discreteInfo.size())
+                resizeAllocationStack(saved.discreteInfo, 0);
+            saved.discreteInfo.resize(ss.discreteInfo.size());
+            for (unsigned j=0; j < ss.discreteInfo.size(); ++j)
+                reuseOrDeepAssign(saved.discreteInfo[j], ss.discreteInfo[j]);
+
+            if (!ck.cacheSaved)
+                continue;
+
+            // Cache entries that depend only on Instance or earlier stages
+            // stay valid across a restore so there is no need to save them.
+            int nSaved = 0;
+            for (unsigned j=0; j < ss.cacheInfo.size(); ++j)
+                if (ss.cacheInfo[j].getDependsOnStage() > Stage::Instance)
+                    ++nSaved;
+            if ((int)saved.cacheInfo.size() != nSaved) {
+                resizeAllocationStack(saved.cacheInfo, 0);
+                saved.cacheInfo.resize(nSaved);
+                saved.cacheIndex.resize(nSaved);
+            }
+            int k = 0;
+            for (CacheEntryIndex cx(0); cx < (int)ss.cacheInfo.size(); ++cx) {
+                const CacheEntryInfo& ce = ss.cacheInfo[cx];
+                if (ce.getDependsOnStage() <= Stage::Instance)
+                    continue;
+                saved.cacheIndex[k] = cx;
+                reuseOrDeepAssign(saved.cacheInfo[k], ce);
+                ++k;
+            }
+        }
+
+        if (ck.cacheSaved) {
+            ck.ydot = ydot; ck.qdotdot = qdotdot;
+            ck.yerr = yerr; ck.udoterr = udoterr; ck.multipliers = multipliers;
+            ck.allTriggers = allTriggers;
+        }
+    }
+
+    // Write the saved values back in place. See State::restoreCheckpoint()
+    // for the rules about what gets invalidated.
+    void restoreCheckpoint(const StateCheckpointImpl& ck) {
+        SimTK_ERRCHK_ALWAYS(!ck.isEmpty(), "State::restoreCheckpoint()",
+            "The checkpoint is empty.");
+        SimTK_STAGECHECK_GE_ALWAYS(currentSystemStage, Stage::Model,
+            "State::restoreCheckpoint()");
+
+        bool sameModel = 
+               ck.subsystems.size() == subsystems.size()
+            && ck.y.size() == y.size()
+            && ck.systemStageVersions[Stage::Topology] 
+                            == systemStageVersions[Stage::Topology]
+            && ck.systemStageVersions[Stage::Model] 
+                            == systemStageVersions[Stage::Model];
+        bool sameInstance = sameModel
+            && ck.systemStage >= Stage::Instance 
+            && currentSystemStage >= Stage::Instance
+            && ck.systemStageVersions[Stage::Instance] 
+                            == systemStageVersions[Stage::Instance];
+        for (SubsystemIndex sx(0); sameModel && sx < subsystems.size(); ++sx){
+            const PerSubsystemInfo& ss = subsystems[sx];
+            const StateCheckpointImpl::SavedSubsystem& saved = 
+                ck.subsystems[sx];
+            sameModel = saved.discreteInfo.size() == ss.discreteInfo.size()
+                && saved.stageVersions[Stage::Model] 
+                                == ss.stageVersions[Stage::Model];
+            sameInstance = sameInstance && sameModel
+                && saved.stageVersions[Stage::Instance]
+                                == ss.stageVersions[Stage::Instance];
+        }
+        SimTK_ERRCHK_ALWAYS(sameModel, "State::restoreCheckpoint()",
+            "The checkpoint was not saved from this State, or the State has "
+            "been modified at Model stage or below since it was saved.");
+
+        const bool restoreCache = sameInstance && ck.cacheSaved;
+        if (!restoreCache)
+            invalidateAll(sameInstance ? Stage::Time : Stage::Instance);
+
+        t = ck.t;
+        y = ck.y; // same size; no reallocation
+        for (SubsystemIndex sx(0); sx < subsystems.size(); ++sx) {
+            PerSubsystemInfo& ss = subsystems[sx];
+            const StateCheckpointImpl::SavedSubsystem& saved = 
+                ck.subsystems[sx];
+            for (unsigned j=0; j < ss.discreteInfo.size(); ++j)
+                ss.discreteInfo[j].deepAssign(saved.discreteInfo[j]);
+        }
+
+        if (!restoreCache)
+            return;
+
+        // Nothing at Instance stage or below changed, so the cache layout is
+        // the same as when we saved it. Put back every later cache entry,
+        // leaving this State realized exactly as far as it was then. Stage
+        // versions never go backwards, though: each later stage gets a version
+        // newer than both the current and the saved one, and a restored entry
+        // that was current with the saved versions is re-stamped with the new
+        // ones. Otherwise an entry computed after the save could later match
+        // a reused version number.
+        for (SubsystemIndex sx(0); sx < subsystems.size(); ++sx) {
+            PerSubsystemInfo& ss = subsystems[sx];
+            const StateCheckpointImpl::SavedSubsystem& saved = 
+                ck.subsystems[sx];
+            for (int i=Stage::Instance+1; i < Stage::NValid; ++i)
+                ss.stageVersions[i] = 
+                    std::max(ss.stageVersions[i], saved.stageVersions[i]) + 1;
+            for (unsigned k=0; k < saved.cacheInfo.size(); ++k) {
+                const CacheEntryInfo& src = saved.cacheInfo[k];
+                CacheEntryInfo& ce = ss.cacheInfo[saved.cacheIndex[k]];
+                ce.deepAssign(src);
+                if (src.getVersionWhenLastComputed() 
+                        == saved.stageVersions[src.getDependsOnStage()])
+                    ce.markAsComputed(ss.stageVersions);
+                else
+                    ce.invalidate();
+            }
+            ss.currentStage = saved.currentStage;
+        }
+        for (int i=Stage::Instance+1; i < Stage::NValid; ++i)
+            systemStageVersions[i] = 
+                std::max(systemStageVersions[i], ck.systemStageVersions[i]) + 1;
+        currentSystemStage = ck.systemStage;
+
+        // These are all locked to the sizes they had when saved.
+        ydot = ck.ydot; qdotdot = ck.qdotdot;
+        yerr = ck.yerr; udoterr = ck.udoterr; multipliers = ck.multipliers;
+        allTriggers = ck.allTriggers;
+    }
+
     void autoUpdateDiscreteVariables() {
         // TODO: make this more efficient
         for (SubsystemIndex subx(0); subx < subsystems.size(); ++subx) {
@@ -2928,6 +3160,13 @@ void State::getSystemStageVersions(Array_<StageVersion>& versions) const {
 Stage State::getLowestSystemStageDifference(const Array_<StageVersion>& prev) const {
     return getImpl().getLowestSystemStageDifference(prev); 
 }
+void State::saveCheckpoint(StateCheckpoint& checkpoint, 
+                           bool includeCache) const {
+    getImpl().saveCheckpoint(checkpoint.updImpl(), includeCache);
+}
+void State::restoreCheckpoint(const StateCheckpoint& checkpoint) {
+    updImpl().restoreCheckpoint(checkpoint.getImpl());
+}
 void State::autoUpdateDiscreteVariables() {
     updImpl().autoUpdateDiscreteVariables(); 
 }
@@ -2947,5 +3186,30 @@ operator<<(std::ostream& o, const State& s) {
     return o << s.cacheToString() << std::endl;
 }
 
+
+
+//==============================================================================
+//                              STATE CHECKPOINT
+//==============================================================================
+
+StateCheckpoint::StateCheckpoint() {
+    impl = new StateCheckpointImpl();
+}
+StateCheckpoint::~StateCheckpoint() {
+    delete impl; impl=0;
+}
+void StateCheckpoint::clear() {
+    updImpl().clear();
+}
+bool StateCheckpoint::isEmpty() const {
+    return getImpl().isEmpty();
+}
+bool StateCheckpoint::hasCache() const {
+    return getImpl().cacheSaved;
+}
+Real StateCheckpoint::getTime() const {
+    return getImpl().t;
+}
+
 } // namespace SimTK
 
@@ -457,6 +457,8 @@ Subsystem::Guts* Subsystem::Guts::clone() const {
 void Subsystem::Guts::realizeSubsystemTopology(State& s) const {
     SimTK_STAGECHECK_EQ_ALWAYS(getStage(s), Stage::Empty, 
         "Subsystem::Guts::realizeSubsystemTopology()");
+    const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                  getName(), Stage::Topology);
     realizeSubsystemTopologyImpl(s);
 
     // Realize this Subsystem's Measures.
@@ -473,6 +475,8 @@ void Subsystem::Guts::realizeSubsystemModel(State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage::Topology, 
         "Subsystem::Guts::realizeSubsystemModel()");
     if (getStage(s) < Stage::Model) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Model);
         realizeSubsystemModelImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -486,6 +490,8 @@ void Subsystem::Guts::realizeSubsystemInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Instance).prev(), 
         "Subsystem::Guts::realizeSubsystemInstance()");
     if (getStage(s) < Stage::Instance) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Instance);
         realizeSubsystemInstanceImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -499,6 +505,8 @@ void Subsystem::Guts::realizeSubsystemTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Time).prev(), 
         "Subsystem::Guts::realizeTime()");
     if (getStage(s) < Stage::Time) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Time);
         realizeSubsystemTimeImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -512,6 +520,8 @@ void Subsystem::Guts::realizeSubsystemPosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Position).prev(), 
         "Subsystem::Guts::realizeSubsystemPosition()");
     if (getStage(s) < Stage::Position) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Position);
         realizeSubsystemPositionImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -525,6 +535,8 @@ void Subsystem::Guts::realizeSubsystemVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Velocity).prev(), 
         "Subsystem::Guts::realizeSubsystemVelocity()");
     if (getStage(s) < Stage::Velocity) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Velocity);
         realizeSubsystemVelocityImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -538,6 +550,8 @@ void Subsystem::Guts::realizeSubsystemDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Dynamics).prev(), 
         "Subsystem::Guts::realizeSubsystemDynamics()");
     if (getStage(s) < Stage::Dynamics) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Dynamics);
         realizeSubsystemDynamicsImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -551,6 +565,8 @@ void Subsystem::Guts::realizeSubsystemAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Acceleration).prev(), 
         "Subsystem::Guts::realizeSubsystemAcceleration()");
     if (getStage(s) < Stage::Acceleration) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Acceleration);
         realizeSubsystemAccelerationImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -564,6 +580,8 @@ void Subsystem::Guts::realizeSubsystemReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage(Stage::Report).prev(), 
         "Subsystem::Guts::realizeSubsystemReport()");
     if (getStage(s) < Stage::Report) {
+        const Profiler::Sample sample(getSystem().getProfiler(), "Subsystem",
+                                      getName(), Stage::Report);
         realizeSubsystemReportImpl(s);
 
         // Realize this Subsystem's Measures.
@@ -115,6 +115,9 @@ void System::resetAllCountersToZero() {updSystemGuts().updRep().resetAllCounters
 int System::getNumRealizationsOfThisStage(Stage g) const {return getSystemGuts().getRep().nRealizationsOfStage[g];}
 int System::getNumRealizeCalls() const {return getSystemGuts().getRep().nRealizeCalls;}
 
+const Profiler& System::getProfiler() const {return getSystemGuts().getRep().profiler;}
+Profiler& System::updProfiler() {return updSystemGuts().updRep().profiler;}
+
 int System::getNumPrescribeQCalls() const {return getSystemGuts().getRep().nPrescribeQCalls;}
 int System::getNumPrescribeUCalls() const {return getSystemGuts().getRep().nPrescribeUCalls;}
 
@@ -181,6 +184,11 @@ void System::multiplyByNPInv(const State& s, const Vector& dq, Vector& u) const
 void System::multiplyByNPInvTranspose(const State& s, const Vector& fu, Vector& fq) const
 {   getSystemGuts().multiplyByNPInvTranspose(s,fu,fq); }
 
+bool System::calcYDotJacobianTimesVector
+   (State& s, const Vector& ydot, const Vector& v, Real increment, 
+    Vector& Jv) const
+{   return getSystemGuts().calcYDotJacobianTimesVector(s,ydot,v,increment,Jv); }
+
 bool System::prescribeQ(State& s) const
 {   return getSystemGuts().prescribeQ(s); }
 bool System::prescribeU(State& s) const
@@ -337,6 +345,9 @@ const State& System::Guts::realizeTopology() const {
     if (getRep().systemTopologyHasBeenRealized())
         return defaultState;
 
+    // Note that this time includes realizing the default State's Model stage.
+    const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                  Stage::Topology);
     defaultState.clear();
     defaultState.setNumSubsystems(getNumSubsystems());
     for (SubsystemIndex i(0); i<getNumSubsystems(); ++i) 
@@ -377,6 +388,8 @@ void System::Guts::realizeModel(State& s) const {
         getSystemTopologyCacheVersion(), s.getSystemTopologyStageVersion(),
         "System", getName(), "System::Guts::realizeModel()");
     if (s.getSystemStage() < Stage::Model) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Model);
         // Allow the subclass to do its processing.
         realizeModelImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -394,6 +407,8 @@ void System::Guts::realizeInstance(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Instance).prev(), 
         "System::Guts::realizeInstance()");
     if (s.getSystemStage() < Stage::Instance) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Instance);
         realizeInstanceImpl(s);    // take care of the Subsystems
         // Realize any subsystems that the subclass didn't already take care of.
         for (SubsystemIndex i(0); i<getNumSubsystems(); ++i)
@@ -410,6 +425,8 @@ void System::Guts::realizeTime(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Time).prev(), 
         "System::Guts::realizeTime()");
     if (s.getSystemStage() < Stage::Time) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Time);
         // Allow the subclass to do processing.
         realizeTimeImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -426,6 +443,8 @@ void System::Guts::realizePosition(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Position).prev(), 
         "System::Guts::realizePosition()");
     if (s.getSystemStage() < Stage::Position) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Position);
         // Allow the subclass to do processing.
         realizePositionImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -442,6 +461,8 @@ void System::Guts::realizeVelocity(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Velocity).prev(), 
         "System::Guts::realizeVelocity()");
     if (s.getSystemStage() < Stage::Velocity) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Velocity);
         // Allow the subclass to do processing.
         realizeVelocityImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -459,6 +480,8 @@ void System::Guts::realizeDynamics(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Dynamics).prev(), 
         "System::Guts::realizeDynamics()");
     if (s.getSystemStage() < Stage::Dynamics) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Dynamics);
         // Allow the subclass to do processing.
         realizeDynamicsImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -476,6 +499,8 @@ void System::Guts::realizeAcceleration(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Acceleration).prev(), 
         "System::Guts::realizeAcceleration()");
     if (s.getSystemStage() < Stage::Acceleration) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Acceleration);
         // Allow the subclass to do processing.
         realizeAccelerationImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -493,6 +518,8 @@ void System::Guts::realizeReport(const State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage(Stage::Report).prev(), 
         "System::Guts::realizeReport()");
     if (s.getSystemStage() < Stage::Report) {
+        const Profiler::Sample sample(getRep().profiler, "System", getName(),
+                                      Stage::Report);
         // Allow the subclass to do processing.
         realizeReportImpl(s);
         // Realize any subsystems that the subclass didn't already take care of.
@@ -530,6 +557,20 @@ void System::Guts::multiplyByNPInvTranspose(const State& s, const Vector& fu,
     return multiplyByNPInvTransposeImpl(s,fu,fq);
 }
 
+bool System::Guts::calcYDotJacobianTimesVector
+   (State& s, const Vector& ydot, const Vector& v, Real increment, 
+    Vector& Jv) const {
+    SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage::Position,
+        "System::Guts::calcYDotJacobianTimesVector()");
+    SimTK_APIARGCHECK2_ALWAYS(ydot.size()==s.getNY(),
+        "System::Guts", "calcYDotJacobianTimesVector",
+        "ydot must have size ny=%d but had size %d.", s.getNY(), ydot.size());
+    SimTK_APIARGCHECK2_ALWAYS(v.size()==s.getNY(),
+        "System::Guts", "calcYDotJacobianTimesVector",
+        "v must have size ny=%d but had size %d.", s.getNY(), v.size());
+    return calcYDotJacobianTimesVectorImpl(s,ydot,v,increment,Jv);
+}
+
 bool System::Guts::prescribeQ(State& s) const {
     SimTK_STAGECHECK_GE_ALWAYS(s.getSystemStage(), Stage::Time,
                                "System::Guts::prescribeQ()");
@@ -220,6 +220,11 @@ private:
     mutable int nHandleEventsCalls;
     mutable int nReportEventsCalls;
 
+        // PROFILING //
+    // Recording into the Profiler is a const operation. It is not copied
+    // along with the System.
+    Profiler profiler;
+
     void resetAllCounters() {
         for (int i=0; i<Stage::NValid; ++i)
             nRealizationsOfStage[i] = nHandlerCallsThatChangedStage[i] = 0;
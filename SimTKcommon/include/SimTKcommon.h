@@ -61,11 +61,14 @@ applications that use Simbody.
 #include "SimTKcommon/internal/ParallelExecutor.h"
 #include "SimTKcommon/internal/Parallel2DExecutor.h"
 #include "SimTKcommon/internal/ParallelWorkQueue.h"
+#include "SimTKcommon/internal/WorkStealingExecutor.h"
+#include "SimTKcommon/internal/GuardedParallelTask.h"
 #include "SimTKcommon/internal/ThreadLocal.h"
 #include "SimTKcommon/internal/AtomicInteger.h"
 #include "SimTKcommon/internal/Pathname.h"
 #include "SimTKcommon/internal/Plugin.h"
 #include "SimTKcommon/internal/Timing.h"
+#include "SimTKcommon/internal/Profiler.h"
 #include "SimTKcommon/internal/Xml.h"
 #include "SimTKcommon/Testing.h"
 #endif
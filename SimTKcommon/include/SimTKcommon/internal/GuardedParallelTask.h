@@ -0,0 +1,116 @@
+#ifndef SimTK_SimTKCOMMON_GUARDED_PARALLEL_TASK_H_
+#define SimTK_SimTKCOMMON_GUARDED_PARALLEL_TASK_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ParallelExecutor.h"
+#include "AtomicInteger.h"
+
+#include <exception>
+#include <string>
+
+namespace SimTK {
+
+/**
+ * This is a ParallelExecutor::Task that keeps exceptions from escaping from the worker threads.
+ * An exception must not propagate out of a worker thread, so a subclass implements
+ * executeGuarded() instead of execute(), and execute() catches anything executeGuarded() throws.
+ * The message of the first exception is kept; after the executor returns, the calling thread
+ * checks hasFailed() and reports getErrorMessage() in whatever way suits it:
+ *
+ * <pre>
+ * executor.execute(myTask, times);
+ * SimTK_ERRCHK1_ALWAYS(!myTask.hasFailed(), "MyClass::calc()",
+ *     "A parallel calculation failed: %s", myTask.getErrorMessage().c_str());
+ * </pre>
+ *
+ * Once one invocation has failed the others still run. A task can be used with either a
+ * ParallelExecutor or a WorkStealingExecutor.
+ *
+ * When the work is done on the calling thread instead, use executeSerially(). It does not catch
+ * anything, so the original exception reaches the caller unchanged.
+ */
+
+class GuardedParallelTask : public ParallelExecutor::Task {
+public:
+    GuardedParallelTask() : numFailures(0) {
+    }
+    /**
+     * Invoke executeGuarded(), recording the message of any exception it throws.
+     */
+    void execute(int index) {
+        try {
+            executeGuarded(index);
+        } catch (const std::exception& e) {
+            recordFailure(e.what());
+        } catch (...) {
+            recordFailure("unknown exception");
+        }
+    }
+    /**
+     * This method defines the task to be performed.  It is called in the same way as
+     * ParallelExecutor::Task::execute(), and may throw.
+     */
+    virtual void executeGuarded(int index) = 0;
+    /**
+     * Invoke executeGuarded() for each index from 0 to times-1 in order on the calling thread.
+     * Exceptions are not caught.
+     */
+    void executeSerially(int times) {
+        for (int i = 0; i < times; ++i)
+            executeGuarded(i);
+    }
+    /**
+     * Return true if any invocation of execute() caught an exception.
+     */
+    bool hasFailed() const {
+        return numFailures != 0;
+    }
+    /**
+     * Get the message of the first exception caught by execute().
+     */
+    const std::string& getErrorMessage() const {
+        return errorMessage;
+    }
+    /**
+     * When n items are divided into numBlocks consecutive blocks of nearly equal size, get the
+     * index of the first item in the given block.  Block b holds the items from
+     * getBlockStart(n, b, numBlocks) up to but not including getBlockStart(n, b+1, numBlocks).
+     */
+    static int getBlockStart(int n, int block, int numBlocks) {
+        return (int) ((long long) n*block/numBlocks);
+    }
+private:
+    void recordFailure(const char* message) {
+        // Only the thread that records the first failure writes the message.
+        if (++numFailures == 1)
+            errorMessage = message;
+    }
+    AtomicInteger numFailures;
+    std::string errorMessage;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_GUARDED_PARALLEL_TASK_H_
@@ -0,0 +1,108 @@
+#ifndef SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_H_
+#define SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "PrivateImplementation.h"
+#include "ParallelExecutor.h"
+
+namespace SimTK {
+
+class WorkStealingExecutor;
+class WorkStealingExecutorImpl;
+
+// We only want the template instantiation to occur once. This symbol is defined in the SimTK core
+// compilation unit that defines the WorkStealingExecutor class but should not be defined any other time.
+#ifndef SimTK_SIMTKCOMMON_DEFINING_WORK_STEALING_EXECUTOR
+    extern template class PIMPLHandle<WorkStealingExecutor, WorkStealingExecutorImpl>;
+#endif
+
+/**
+ * This is a drop-in alternative to ParallelExecutor that is designed for low dispatch latency and
+ * for tasks whose invocations take very different amounts of time.  It executes the same
+ * ParallelExecutor::Task objects with the same semantics:
+ *
+ * <pre>
+ * WorkStealingExecutor executor;
+ * executor.execute(myTask, times);
+ * </pre>
+ *
+ * The Task's execute() method will be called the specified number of times, with each invocation
+ * being given a different index value from 0 to times-1, and initialize() and finish() are called
+ * once by each worker thread that takes part.
+ *
+ * The differences are in how the work is scheduled.  The index range is initially divided evenly
+ * among the worker threads, each of which keeps its share in its own deque.  A thread takes
+ * small chunks of indices from the front of its own deque; when that is empty it steals half of
+ * the remaining indices from the back of another thread's deque, so threads that finish early
+ * help out ones that got the more expensive invocations.  Between calls to execute(), worker
+ * threads spin for a short while waiting for the next task before going to sleep, so a sequence
+ * of closely spaced calls does not pay the cost of waking sleeping threads each time.  The spin
+ * time can be set with setSpinCount(); set it to zero if the executor will be idle for long
+ * periods and you don't want the worker threads consuming processor time.
+ *
+ * As with ParallelExecutor, the threads are created in the constructor and remain active until the
+ * executor is deleted, and ParallelExecutor::isWorkerThread() returns true when called from one of
+ * them.
+ *
+ * execute() may be called from several threads at once; the calls are run one after another.  A
+ * Task must not call execute() on the executor that is running it, since the worker making the
+ * call would have to wait for itself.  Such a call throws an exception unless it would have been
+ * run serially anyway (because times is 1 or less, or there is only one thread).
+ */
+
+class SimTK_SimTKCOMMON_EXPORT WorkStealingExecutor : public PIMPLHandle<WorkStealingExecutor, WorkStealingExecutorImpl> {
+public:
+    /**
+     * Construct a WorkStealingExecutor.
+     *
+     * @param numThreads the number of threads to create.  By default, this is set equal to the number
+     * of processors.
+     */
+    explicit WorkStealingExecutor(int numThreads = ParallelExecutor::getNumProcessors());
+    /**
+     * Execute a parallel task.
+     *
+     * @param task    the Task to execute
+     * @param times   the number of times the Task should be executed
+     */
+    void execute(ParallelExecutor::Task& task, int times);
+    /**
+     * Get the number of worker threads used by this executor.
+     */
+    int getNumThreads() const;
+    /**
+     * Set the number of times an idle worker thread (or the thread waiting in execute()) polls
+     * for a state change before blocking.  The default is 20000.
+     */
+    void setSpinCount(int spins);
+    /**
+     * Get the number of polls an idle thread makes before blocking.
+     */
+    int getSpinCount() const;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,270 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "WorkStealingExecutorImpl.h"
+#include "ParallelExecutorImpl.h"
+#include "SimTKcommon/internal/WorkStealingExecutor.h"
+#include <pthread.h>
+#include <algorithm>
+#include <iostream>
+
+namespace SimTK {
+
+// How many chunks each thread's initial share of the indices is divided into.
+// Smaller chunks balance better but cost more deque operations.
+static const int ChunksPerThread = 8;
+
+static const int DefaultSpinCount = 20000;
+
+/**
+ * This is passed to each new worker thread to tell it who it is.
+ */
+
+struct WorkerStartInfo {
+    WorkerStartInfo(WorkStealingExecutorImpl* executor, int index) : executor(executor), index(index) {
+    }
+    WorkStealingExecutorImpl* executor;
+    int index;
+};
+
+static void* workerBody(void* args) {
+    WorkerStartInfo* info = reinterpret_cast<WorkerStartInfo*>(args);
+    WorkStealingExecutorImpl& executor = *info->executor;
+    const int index = info->index;
+    delete info;
+    ParallelExecutorImpl::isWorker.upd() = true;
+    executor.runWorker(index);
+    return 0;
+}
+
+WorkStealingExecutorImpl::WorkStealingExecutorImpl(int numThreads)
+:   spinCount(DefaultSpinCount), currentTask(0), chunkSize(1), finished(false) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "WorkStealingExecutorImpl", "WorkStealingExecutorImpl", "Number of threads must be positive.");
+    gmx_atomic_set(&generation, 0);
+    gmx_atomic_set(&activeWorkers, 0);
+    gmx_atomic_set(&sleepingWorkers, 0);
+    gmx_atomic_set(&callerSleeping, 0);
+    pthread_mutex_init(&lock, NULL);
+    pthread_mutex_init(&finishLock, NULL);
+    pthread_mutex_init(&executeLock, NULL);
+    pthread_cond_init(&workCondition, NULL);
+    pthread_cond_init(&doneCondition, NULL);
+    deques.resize(numThreads);
+    threads.resize(numThreads);
+    for (int i = 0; i < numThreads; ++i)
+        pthread_create(&threads[i], NULL, workerBody, new WorkerStartInfo(this, i));
+}
+
+WorkStealingExecutorImpl::~WorkStealingExecutorImpl() {
+
+    // Post a final "generation" telling the threads to exit.
+
+    finished = true;
+    pthread_mutex_lock(&lock);
+    gmx_atomic_fetch_add(&generation, 1);
+    pthread_cond_broadcast(&workCondition);
+    pthread_mutex_unlock(&lock);
+    for (int i = 0; i < (int) threads.size(); ++i)
+        pthread_join(threads[i], NULL);
+
+    // Clean up threading related objects.
+
+    pthread_mutex_destroy(&lock);
+    pthread_mutex_destroy(&finishLock);
+    pthread_mutex_destroy(&executeLock);
+    pthread_cond_destroy(&workCondition);
+    pthread_cond_destroy(&doneCondition);
+}
+
+WorkStealingExecutorImpl* WorkStealingExecutorImpl::clone() const {
+    WorkStealingExecutorImpl* copy = new WorkStealingExecutorImpl(threads.size());
+    copy->setSpinCount(spinCount);
+    return copy;
+}
+
+void WorkStealingExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
+    if (times <= 1 || threads.size() == 1) {
+        // Nothing is actually going to get done in parallel, so we might as well
+        // just execute the task directly and save the threading overhead.
+
+        task.initialize();
+        for (int i = 0; i < times; ++i)
+            task.execute(i);
+        task.finish();
+        return;
+    }
+
+    // A worker can't wait for the other workers to run a task while it is 
+    // itself in the middle of running one; that would deadlock.
+
+    SimTK_ERRCHK_ALWAYS(!isOwnWorkerThread(), "WorkStealingExecutor::execute()",
+        "execute() was called from a Task being run by the same executor.");
+    pthread_mutex_lock(&executeLock);
+
+    // Divide the indices evenly among the threads' deques.
+
+    const int numThreads = threads.size();
+    currentTask = &task;
+    chunkSize = std::max(1, times/(ChunksPerThread*numThreads));
+    for (int i = 0; i < numThreads; ++i)
+        deques[i].reset((int) ((long long) times*i/numThreads), (int) ((long long) times*(i+1)/numThreads));
+    gmx_atomic_set(&activeWorkers, numThreads);
+
+    // Publish the task.  The atomic increment is a full memory barrier, so everything written
+    // above is visible to any worker that sees the new generation.  A worker increments
+    // sleepingWorkers before it makes its final check of the generation, so if we see zero
+    // here every worker is guaranteed to notice the new generation without being signaled.
+
+    gmx_atomic_fetch_add(&generation, 1);
+    if (gmx_atomic_read(&sleepingWorkers) > 0) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_broadcast(&workCondition);
+        pthread_mutex_unlock(&lock);
+    }
+
+    // Wait for the workers to finish: spin first, then block.
+
+    for (int i = 0; i < spinCount && gmx_atomic_read(&activeWorkers) != 0; ++i)
+        ;
+    if (gmx_atomic_read(&activeWorkers) != 0) {
+        pthread_mutex_lock(&lock);
+        gmx_atomic_fetch_add(&callerSleeping, 1);
+        while (gmx_atomic_read(&activeWorkers) != 0)
+            pthread_cond_wait(&doneCondition, &lock);
+        gmx_atomic_fetch_add(&callerSleeping, -1);
+        pthread_mutex_unlock(&lock);
+    }
+    currentTask = 0;
+    pthread_mutex_unlock(&executeLock);
+}
+
+bool WorkStealingExecutorImpl::isOwnWorkerThread() const {
+    if (!ParallelExecutor::isWorkerThread())
+        return false;
+    const pthread_t self = pthread_self();
+    for (int i = 0; i < (int) threads.size(); ++i)
+        if (pthread_equal(self, threads[i]))
+            return true;
+    return false;
+}
+
+void WorkStealingExecutorImpl::runWorker(int index) {
+    int lastGeneration = 0;
+    while (true) {
+        waitForWork(lastGeneration);
+        if (finished)
+            break;
+        doWork(index);
+    }
+}
+
+void WorkStealingExecutorImpl::waitForWork(int& lastGeneration) {
+    for (int i = 0; i < spinCount; ++i) {
+        const int current = gmx_atomic_read(&generation);
+        if (current != lastGeneration) {
+            lastGeneration = current;
+            return;
+        }
+    }
+    pthread_mutex_lock(&lock);
+    gmx_atomic_fetch_add(&sleepingWorkers, 1);
+    while (gmx_atomic_read(&generation) == lastGeneration)
+        pthread_cond_wait(&workCondition, &lock);
+    gmx_atomic_fetch_add(&sleepingWorkers, -1);
+    lastGeneration = gmx_atomic_read(&generation);
+    pthread_mutex_unlock(&lock);
+}
+
+void WorkStealingExecutorImpl::doWork(int index) {
+    ParallelExecutor::Task& task = *currentTask;
+    task.initialize();
+    try {
+        int first, last;
+        while (getNextChunk(index, first, last))
+            for (int i = first; i < last; ++i)
+                task.execute(i);
+    }
+    catch (const std::exception& ex) {
+        std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
+        std::cerr <<ex.what()<< std::endl;
+    }
+    catch (...) {
+        std::cerr <<"The parallel task threw an error."<< std::endl;
+    }
+    pthread_mutex_lock(&finishLock);
+    task.finish();
+    pthread_mutex_unlock(&finishLock);
+    markWorkerDone();
+}
+
+bool WorkStealingExecutorImpl::getNextChunk(int index, int& first, int& last) {
+    if (deques[index].popFront(chunkSize, first, last))
+        return true;
+
+    // Our own deque is empty, so look for another thread with work left, starting with our
+    // neighbor so that the thieves spread out over the victims.  We take half of what the
+    // victim has left, put it in our own deque (where others can steal it back from us), and
+    // start on the first chunk.
+
+    const int numThreads = deques.size();
+    for (int k = 1; k < numThreads; ++k) {
+        const int victim = (index+k)%numThreads;
+        int stolenFirst, stolenLast;
+        if (deques[victim].stealBack(stolenFirst, stolenLast)) {
+            deques[index].reset(stolenFirst, stolenLast);
+            if (deques[index].popFront(chunkSize, first, last))
+                return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingExecutorImpl::markWorkerDone() {
+    if (gmx_atomic_add_return(&activeWorkers, -1) == 0 && gmx_atomic_read(&callerSleeping) > 0) {
+        pthread_mutex_lock(&lock);
+        pthread_cond_signal(&doneCondition);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+WorkStealingExecutor::WorkStealingExecutor(int numThreads) : HandleBase(new WorkStealingExecutorImpl(numThreads)) {
+}
+
+void WorkStealingExecutor::execute(ParallelExecutor::Task& task, int times) {
+    updImpl().execute(task, times);
+}
+
+int WorkStealingExecutor::getNumThreads() const {
+    return getImpl().getThreadCount();
+}
+
+void WorkStealingExecutor::setSpinCount(int spins) {
+    SimTK_APIARGCHECK_ALWAYS(spins >= 0, "WorkStealingExecutor", "setSpinCount", "Spin count can't be negative.");
+    updImpl().setSpinCount(spins);
+}
+
+int WorkStealingExecutor::getSpinCount() const {
+    return getImpl().getSpinCount();
+}
+
+} // namespace SimTK
@@ -0,0 +1,152 @@
+#ifndef SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_IMPL_H_
+#define SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_IMPL_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/WorkStealingExecutor.h"
+#include "SimTKcommon/internal/Array.h"
+#include "gmx_atomic.h"
+#include <pthread.h>
+
+namespace SimTK {
+
+class WorkStealingExecutorImpl;
+
+/**
+ * This is the deque of task indices owned by one worker thread.  Because the indices for a task
+ * are a contiguous range, the deque is just the half-open interval [begin, end).  The owner takes
+ * chunks from the front and thieves take from the back.  Both ends are protected by one spinlock;
+ * it is almost never contended since stealing only happens once a thread has run out of work.
+ * The deques are padded to separate cache lines so that threads working on their own deques
+ * don't interfere with each other.
+ */
+
+class WorkDeque {
+public:
+    WorkDeque() : begin(0), end(0) {
+        gmx_spinlock_init(&lock);
+    }
+    void reset(int first, int last) {
+        gmx_spinlock_lock(&lock);
+        begin = first;
+        end = last;
+        gmx_spinlock_unlock(&lock);
+    }
+    /**
+     * Remove up to maxCount indices from the front.  Returns false if the deque was empty.
+     */
+    bool popFront(int maxCount, int& first, int& last) {
+        gmx_spinlock_lock(&lock);
+        const bool found = (begin < end);
+        if (found) {
+            first = begin;
+            last = (end-begin > maxCount ? begin+maxCount : end);
+            begin = last;
+        }
+        gmx_spinlock_unlock(&lock);
+        return found;
+    }
+    /**
+     * Remove the back half (rounded up) of the remaining indices.  Returns false if the deque
+     * was empty.
+     */
+    bool stealBack(int& first, int& last) {
+        if (begin >= end) // cheap check without the lock; rechecked below
+            return false;
+        gmx_spinlock_lock(&lock);
+        const bool found = (begin < end);
+        if (found) {
+            last = end;
+            first = end - (end-begin+1)/2;
+            end = first;
+        }
+        gmx_spinlock_unlock(&lock);
+        return found;
+    }
+private:
+    gmx_spinlock_t lock;
+    volatile int begin, end;
+    char padding[64];
+};
+
+/**
+ * This is the internal implementation class for WorkStealingExecutor.
+ */
+
+class WorkStealingExecutorImpl : public PIMPLImplementation<WorkStealingExecutor, WorkStealingExecutorImpl> {
+public:
+    WorkStealingExecutorImpl(int numThreads);
+    ~WorkStealingExecutorImpl();
+    WorkStealingExecutorImpl* clone() const;
+    void execute(ParallelExecutor::Task& task, int times);
+    int getThreadCount() const {
+        return threads.size();
+    }
+    int getSpinCount() const {
+        return spinCount;
+    }
+    void setSpinCount(int spins) {
+        spinCount = spins;
+    }
+    /**
+     * This is the main loop run by each worker thread.
+     */
+    void runWorker(int index);
+private:
+    void waitForWork(int& lastGeneration);
+    void doWork(int index);
+    bool getNextChunk(int index, int& first, int& last);
+    void markWorkerDone();
+    bool isOwnWorkerThread() const;
+
+    Array_<pthread_t> threads;
+    Array_<WorkDeque> deques;
+    int spinCount;
+
+    // The current task.  These are written by execute() before the generation counter is
+    // advanced, and only read by the workers after they see the new generation.
+    ParallelExecutor::Task* currentTask;
+    int chunkSize;
+    volatile bool finished;
+
+    // Incremented each time a new task is posted.  Idle workers watch this.
+    gmx_atomic_t generation;
+    // The number of workers that have not yet finished the current task.
+    gmx_atomic_t activeWorkers;
+    // The number of workers (and callers) currently blocked on a condition.
+    gmx_atomic_t sleepingWorkers;
+    gmx_atomic_t callerSleeping;
+
+    pthread_mutex_t lock;
+    pthread_cond_t workCondition, doneCondition;
+    // Serializes calls to Task::finish(), as ParallelExecutor does.
+    pthread_mutex_t finishLock;
+    // Held by execute() while the workers are running a task, so that calls
+    // from different threads run one after another.
+    pthread_mutex_t executeLock;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_WORK_STEALING_EXECUTOR_IMPL_H_
@@ -220,10 +220,79 @@ void testGaussian() {
     ASSERT(value2[2000] = 567.8)
 }
 
+/**
+ * Generate enough Gaussian values to exercise the rarely used parts of the generator, and check the
+ * moments and the frequency of values far out in the tails.
+ */
+
+void testGaussianTails() {
+    const int length = 1000000;
+    Real* value = new Real[length];
+    Random::Gaussian rand;
+    rand.setSeed(5);
+    rand.fillArray(value, length);
+    Real sum = 0, sum2 = 0, sum4 = 0;
+    int beyond3 = 0, beyond4 = 0;
+    for (int i = 0; i < length; ++i) {
+        const Real x = value[i], x2 = x*x;
+        sum += x; sum2 += x2; sum4 += x2*x2;
+        if (std::abs(x) > 3) beyond3++;
+        if (std::abs(x) > 4) beyond4++;
+    }
+    const Real mean = sum/length, var = sum2/length, kurtosis = sum4/length;
+    ASSERT(std::abs(mean) < 5/sqrt((Real) length))
+    ASSERT(std::abs(var-1) < 5*sqrt(2/(Real) length))
+    ASSERT(std::abs(kurtosis-3) < 5*sqrt(96/(Real) length))
+
+    // P(|x|>3) = 2.700e-3 and P(|x|>4) = 6.334e-5.
+    int expected[2] = {(int) (2.700e-3*length), (int) (6.334e-5*length)};
+    int found[2] = {beyond3, beyond4};
+    verifyDistribution(expected, found, 2);
+    delete[] value;
+}
+
+/**
+ * Verify that streams derived from the same seed are reproducible and distinct.
+ */
+
+void testStreams() {
+    Real value[3][1000], value2[1000];
+    Random::Gaussian rand;
+    for (int stream = 0; stream < 3; ++stream) {
+        rand.setSeed(7, stream);
+        rand.fillArray(value[stream], 1000);
+        verifyGaussianDistribution(0.0, 1.0, value[stream], 1000);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT(value[0][i] != value[1][i])
+        ASSERT(value[1][i] != value[2][i])
+    }
+
+    // A separate object given the same seed and stream reproduces it.
+    Random::Gaussian other;
+    other.setSeed(7, 1);
+    for (int i = 0; i < 1000; ++i)
+        ASSERT(other.getValue() == value[1][i])
+
+    // Stream 0 is not the same as the plain seed.
+    rand.setSeed(7);
+    rand.fillArray(value2, 1000);
+    for (int i = 0; i < 1000; ++i)
+        ASSERT(value2[i] != value[0][i])
+
+    // Uniform generators support streams too.
+    Random::Uniform uniform;
+    uniform.setSeed(7, 2);
+    uniform.fillArray(value2, 1000);
+    verifyUniformDistribution(0.0, 1.0, value2, 1000);
+}
+
 int main() {
     try {
         testUniform();
         testGaussian();
+        testGaussianTails();
+        testStreams();
     } catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
         return 1;
@@ -235,6 +235,131 @@ void testMisc() {
     //cout << "after clear(), State s=" << s;
 }
 
+// Advance all the subsystems and then the system, one stage at a time, from
+// wherever the State is now up to Stage g.
+static void realizeTo(const State& s, Stage g) {
+    while (s.getSystemStage() < g) {
+        const Stage next = s.getSystemStage().next();
+        for (SubsystemIndex sx(0); sx < s.getNumSubsystems(); ++sx)
+            if (s.getSubsystemStage(sx) < next)
+                s.advanceSubsystemToStage(sx, next);
+        s.advanceSystemToStage(next);
+    }
+}
+
+void testCheckpoint() {
+    const SubsystemIndex Sub0(0), Sub1(1);
+    State s;
+    s.setNumSubsystems(2);
+
+    Vector q0(2); q0[0] = 1; q0[1] = 2;
+    s.allocateQ(Sub0, q0);
+    const DiscreteVariableIndex dvxInstance = 
+        s.allocateDiscreteVariable(Sub1, Stage::Instance, new Value<int>(3));
+    const DiscreteVariableIndex dvxDynamics = 
+        s.allocateDiscreteVariable(Sub0, Stage::Dynamics, new Value<Real>(5));
+    const CacheEntryIndex cxInstance = 
+        s.allocateCacheEntry(Sub1, Stage::Instance, new Value<int>(0));
+    const CacheEntryIndex cxPosition = 
+        s.allocateCacheEntry(Sub0, Stage::Position, new Value<Real>(0));
+
+    realizeTo(s, Stage::Model);
+    StateCheckpoint ck;
+    SimTK_TEST(ck.isEmpty() && !ck.hasCache());
+    SimTK_TEST_MUST_THROW(s.restoreCheckpoint(ck));
+
+    realizeTo(s, Stage::Instance);
+    Value<int>::updDowncast(s.updCacheEntry(Sub1, cxInstance)) = 7;
+    s.setTime(0.5);
+    realizeTo(s, Stage::Time);
+    Value<Real>::updDowncast(s.updCacheEntry(Sub0, cxPosition)) = 10;
+    realizeTo(s, Stage::Position);
+
+    s.saveCheckpoint(ck);
+    SimTK_TEST(!ck.isEmpty() && ck.hasCache());
+    SimTK_TEST(ck.getTime() == 0.5);
+
+    // Take a "trial step" that changes everything above Instance stage.
+    s.setTime(1);
+    s.updQ() = 9;
+    Value<Real>::updDowncast(s.updDiscreteVariable(Sub0, dvxDynamics)) = -1;
+    realizeTo(s, Stage::Time);
+    Value<Real>::updDowncast(s.updCacheEntry(Sub0, cxPosition)) = 99;
+    realizeTo(s, Stage::Dynamics);
+    Array_<StageVersion> trialVersions;
+    s.getSystemStageVersions(trialVersions);
+
+    // Restoring with the cache puts the State back exactly as it was,
+    // including its realization level, without re-realizing anything.
+    s.restoreCheckpoint(ck);
+    SimTK_TEST(s.getSystemStage() == Stage::Position);
+    SimTK_TEST(s.getTime() == 0.5);
+    SimTK_TEST(s.getQ()[0] == 1 && s.getQ()[1] == 2);
+    SimTK_TEST(Value<Real>::downcast(s.getDiscreteVariable(Sub0, dvxDynamics))
+               == 5);
+    SimTK_TEST(Value<Real>::downcast(s.getCacheEntry(Sub0, cxPosition)) == 10);
+    SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub1, cxInstance)) == 7);
+
+    // Stage versions never go backwards, so nothing recorded during the trial
+    // can be mistaken for current.
+    Array_<StageVersion> restoredVersions;
+    s.getSystemStageVersions(restoredVersions);
+    for (int i=Stage::Time; i < (int)restoredVersions.size(); ++i)
+        SimTK_TEST(restoredVersions[i] > trialVersions[i]);
+    SimTK_TEST(s.getLowestSystemStageDifference(trialVersions) == Stage::Time);
+
+    // The restored cache entry must still be invalidated by later changes.
+    s.updQ() = 3;
+    SimTK_TEST(!s.isCacheValueRealized(Sub0, cxPosition));
+    SimTK_TEST_MUST_THROW(s.getCacheEntry(Sub0, cxPosition));
+    realizeTo(s, Stage::Time);
+    Value<Real>::updDowncast(s.updCacheEntry(Sub0, cxPosition)) = 33;
+    realizeTo(s, Stage::Position);
+
+    // Without the cache, only Time stage and above is invalidated.
+    StateCheckpoint noCache;
+    s.saveCheckpoint(noCache, false);
+    SimTK_TEST(!noCache.hasCache());
+    s.updQ() = 4;
+    realizeTo(s, Stage::Position);
+    s.restoreCheckpoint(noCache);
+    SimTK_TEST(s.getSystemStage() == Stage::Instance);
+    SimTK_TEST(s.getQ()[0] == 3 && s.getQ()[1] == 3);
+    SimTK_TEST(Value<int>::downcast(s.getCacheEntry(Sub1, cxInstance)) == 7);
+
+    // Saving into a used checkpoint reuses it.
+    realizeTo(s, Stage::Position);
+    s.saveCheckpoint(ck);
+    SimTK_TEST(ck.getTime() == 0.5);
+
+    // A change at Instance stage means the saved cache can't be used, and
+    // Instance stage must be invalidated by the restore.
+    Value<int>::updDowncast(s.updDiscreteVariable(Sub1, dvxInstance)) = 8;
+    realizeTo(s, Stage::Position);
+    s.restoreCheckpoint(ck);
+    SimTK_TEST(s.getSystemStage() == Stage::Model);
+    SimTK_TEST(Value<int>::downcast(s.getDiscreteVariable(Sub1, dvxInstance))
+               == 3);
+    SimTK_TEST(s.getQ()[0] == 3);
+
+    // A copy of the State can be restored from the same checkpoint.
+    realizeTo(s, Stage::Position);
+    s.saveCheckpoint(ck);
+    State copy(s);
+    realizeTo(copy, Stage::Position);
+    copy.updQ() = 0;
+    copy.restoreCheckpoint(ck);
+    SimTK_TEST(copy.getQ()[0] == 3);
+
+    // But not after the State has been changed at Model stage.
+    s.invalidateAll(Stage::Model);
+    realizeTo(s, Stage::Model);
+    SimTK_TEST_MUST_THROW(s.restoreCheckpoint(ck));
+
+    ck.clear();
+    SimTK_TEST(ck.isEmpty());
+}
+
 int main() {
     int major,minor,build;
     char out[100];
@@ -253,5 +378,6 @@ int main() {
         //SimTK_SUBTEST(testLowestModified);
         SimTK_SUBTEST(testCacheValidity);
         SimTK_SUBTEST(testMisc);
+        SimTK_SUBTEST(testCheckpoint);
     SimTK_END_TEST();
 }
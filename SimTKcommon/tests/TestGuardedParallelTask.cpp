@@ -0,0 +1,128 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+
+#include <iostream>
+#include <string>
+
+#define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
+
+using std::cout;
+using std::endl;
+using namespace SimTK;
+using namespace std;
+
+// Each invocation fills in one block of the results; the invocations listed
+// in failAt throw instead.
+class BlockTask : public GuardedParallelTask {
+public:
+    BlockTask(Array_<int>& results, int numBlocks, const Array_<int>& failAt) 
+    :   results(results), numBlocks(numBlocks), failAt(failAt) {
+    }
+    void executeGuarded(int block) {
+        for (int i = 0; i < (int) failAt.size(); ++i)
+            if (failAt[i] == block)
+                SimTK_THROW1(Exception::Cant, "block failed");
+        const int n = (int) results.size();
+        const int first = getBlockStart(n, block, numBlocks);
+        const int last = getBlockStart(n, block+1, numBlocks);
+        for (int i = first; i < last; ++i)
+            results[i]++;
+    }
+private:
+    Array_<int>& results;
+    const int numBlocks;
+    const Array_<int>& failAt;
+};
+
+void testBlocks() {
+    ASSERT(GuardedParallelTask::getBlockStart(10, 0, 3) == 0);
+    ASSERT(GuardedParallelTask::getBlockStart(10, 1, 3) == 3);
+    ASSERT(GuardedParallelTask::getBlockStart(10, 2, 3) == 6);
+    ASSERT(GuardedParallelTask::getBlockStart(10, 3, 3) == 10);
+    // Doesn't overflow for large n.
+    ASSERT(GuardedParallelTask::getBlockStart(2000000000, 3, 4) == 1500000000);
+}
+
+// Every item is done exactly once whichever executor runs the task.
+void testSuccess() {
+    const int n = 1000, numBlocks = 7;
+    Array_<int> results(n, 0), failAt;
+    BlockTask task1(results, numBlocks, failAt);
+    ParallelExecutor executor1(4);
+    executor1.execute(task1, numBlocks);
+    ASSERT(!task1.hasFailed());
+    BlockTask task2(results, numBlocks, failAt);
+    WorkStealingExecutor executor2(4);
+    executor2.execute(task2, numBlocks);
+    ASSERT(!task2.hasFailed());
+    BlockTask task3(results, numBlocks, failAt);
+    task3.executeSerially(numBlocks);
+    for (int i = 0; i < n; ++i)
+        ASSERT(results[i] == 3);
+}
+
+// Exceptions are caught on the worker threads and the other blocks still run.
+void testFailure() {
+    const int n = 100, numBlocks = 10;
+    Array_<int> results(n, 0), failAt;
+    failAt.push_back(2);
+    failAt.push_back(7);
+    BlockTask task(results, numBlocks, failAt);
+    WorkStealingExecutor executor(4);
+    executor.execute(task, numBlocks);
+    ASSERT(task.hasFailed());
+    ASSERT(task.getErrorMessage().find("block failed") != string::npos);
+    for (int i = 0; i < n; ++i)
+        ASSERT(results[i] == (i/10 == 2 || i/10 == 7 ? 0 : 1));
+}
+
+// executeSerially() lets the original exception through.
+void testSerialFailure() {
+    Array_<int> results(10, 0), failAt(1, 1);
+    BlockTask task(results, 5, failAt);
+    bool caught = false;
+    try {
+        task.executeSerially(5);
+    } catch (const Exception::Cant& e) {
+        caught = string(e.getMessage()).find("block failed") != string::npos;
+    }
+    ASSERT(caught);
+    ASSERT(!task.hasFailed());
+    ASSERT(results[0] == 1 && results[1] == 1 && results[2] == 0);
+}
+
+int main() {
+    try {
+        testBlocks();
+        testSuccess();
+        testFailure();
+        testSerialFailure();
+    } catch(const std::exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -22,7 +22,12 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 #define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
@@ -109,10 +114,148 @@ void testLoadObjFile() {
     ASSERT(mesh.getFaceVertex(3, 3) == 1);
 }
 
+void testLoadObjFileWithCRLF() {
+    string file;
+    file += "v 0 0 0\r\n";
+    file += "v 1 0 \\\r\n";
+    file += "0\r\n";
+    file += "vn 0 0 1\r\n";
+    file += "v 0 1 0\r\n";
+    file += "f 1/1/1 2/2/1\t3/3/1\r\n";
+    PolygonalMesh mesh;
+    stringstream stream(file);
+    mesh.loadObjFile(stream);
+    ASSERT(mesh.getNumVertices() == 3);
+    ASSERT(mesh.getNumFaces() == 1);
+    ASSERT(mesh.getVertexPosition(1) == Vec3(1, 0, 0));
+    ASSERT(mesh.getNumVerticesForFace(0) == 3);
+    for (int i = 0; i < 3; i++)
+        ASSERT(mesh.getFaceVertex(0, i) == i);
+
+    stringstream bad("v 1 2\nf 1 2 3\n");
+    PolygonalMesh badMesh;
+    SimTK_TEST_MUST_THROW(badMesh.loadObjFile(bad));
+}
+
+// Append the bytes of some values to a string, reversing the bytes of each
+// value if "swap" is set.
+template <class T>
+void appendBytes(const T* values, int n, bool swap, string& out) {
+    for (int i = 0; i < n; i++) {
+        char bytes[sizeof(T)];
+        memcpy(bytes, &values[i], sizeof(T));
+        if (swap)
+            reverse(bytes, bytes+sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+}
+
+string encodeBase64(const string& bytes) {
+    const char* digits = 
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string out;
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        unsigned group = (unsigned char)bytes[i] << 16;
+        if (i+1 < bytes.size()) group |= (unsigned char)bytes[i+1] << 8;
+        if (i+2 < bytes.size()) group |= (unsigned char)bytes[i+2];
+        out += digits[(group >> 18) & 63];
+        out += digits[(group >> 12) & 63];
+        out += (i+1 < bytes.size() ? digits[(group >> 6) & 63] : '=');
+        out += (i+2 < bytes.size() ? digits[group & 63] : '=');
+    }
+    return out;
+}
+
+// Write a .vtp file containing a triangle and a quad, with its DataArrays in
+// the given format: "ascii", "binary", or "appended" with the given encoding.
+// Binary data is in the opposite of this machine's byte order if "swap" is
+// set, and the block headers are UInt64 if "header64" is set, in which case
+// base64 headers are also encoded separately from their data.
+void writeVtpFile(const string& filename, const string& format, 
+                  const string& encoding, bool swap, bool header64) {
+    const double coords[12] = {0,0,0, 1,0,0, 1,1,0, 0,1,0};
+    const long long connectivity[7] = {0, 1, 2, 0, 2, 3, 1};
+    const int offsets[2] = {3, 7};
+    string data[3], headers[3], blocks[3], encoded[3];
+    appendBytes(coords, 12, swap, data[0]);
+    appendBytes(connectivity, 7, swap, data[1]);
+    appendBytes(offsets, 2, swap, data[2]);
+    for (int i = 0; i < 3; i++) {
+        if (header64) {
+            const unsigned long long size = data[i].size();
+            appendBytes(&size, 1, swap, headers[i]);
+        } else {
+            const unsigned int size = (unsigned int)data[i].size();
+            appendBytes(&size, 1, swap, headers[i]);
+        }
+        blocks[i] = headers[i] + data[i];
+        encoded[i] = header64 ? encodeBase64(headers[i])+encodeBase64(data[i])
+                              : encodeBase64(blocks[i]);
+    }
+
+    const int one = 1;
+    const bool little = (*(const char*)&one == 1) != swap;
+    string attributes[3], contents[3], appended;
+    const char* ascii[3] = {"0 0 0 1 0 0 1 1 0 0 1 0", "0 1 2 0 2 3 1", "3 7"};
+    for (int i = 0; i < 3; i++) {
+        attributes[i] = " format=\"" + format + "\"";
+        if (format == "ascii")
+            contents[i] = ascii[i];
+        else if (format == "binary")
+            contents[i] = encoded[i];
+        else {
+            attributes[i] += " offset=\"" + String(appended.size()) + "\"";
+            appended += (encoding == "raw" ? blocks[i] : encoded[i]);
+        }
+    }
+
+    ofstream out(filename.c_str(), ios::binary);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\""
+        << (little ? "LittleEndian" : "BigEndian") << "\" header_type=\""
+        << (header64 ? "UInt64" : "UInt32") << "\">\n"
+        << "<PolyData>\n<Piece NumberOfPoints=\"4\" NumberOfPolys=\"2\">\n"
+        << "<Points><DataArray type=\"Float64\" NumberOfComponents=\"3\"" 
+        << attributes[0] << ">" << contents[0] << "</DataArray></Points>\n"
+        << "<Polys><DataArray type=\"Int64\" Name=\"connectivity\""
+        << attributes[1] << ">" << contents[1] << "</DataArray>\n"
+        << "<DataArray type=\"Int32\" Name=\"offsets\""
+        << attributes[2] << ">" << contents[2] << "</DataArray></Polys>\n"
+        << "</Piece>\n</PolyData>\n";
+    if (format == "appended")
+        out << "<AppendedData encoding=\"" << encoding << "\">\n_" 
+            << appended << "\n</AppendedData>\n";
+    out << "</VTKFile>\n";
+}
+
+void testLoadVtpFile() {
+    const char* formats[4][2] = {{"ascii", ""}, {"binary", ""},
+                                 {"appended", "raw"}, {"appended", "base64"}};
+    const string filename = "TestPolygonalMesh.vtp";
+    for (int f = 0; f < 4; f++)
+        for (int variant = 0; variant < 2; variant++) {
+            writeVtpFile(filename, formats[f][0], formats[f][1], 
+                         variant == 1, variant == 1);
+            PolygonalMesh mesh;
+            mesh.loadVtpFile(filename);
+            ASSERT(mesh.getNumVertices() == 4);
+            ASSERT(mesh.getNumFaces() == 2);
+            ASSERT(mesh.getVertexPosition(2) == Vec3(1, 1, 0));
+            ASSERT(mesh.getNumVerticesForFace(0) == 3);
+            ASSERT(mesh.getNumVerticesForFace(1) == 4);
+            ASSERT(mesh.getFaceVertex(0, 2) == 2);
+            ASSERT(mesh.getFaceVertex(1, 0) == 0);
+            ASSERT(mesh.getFaceVertex(1, 3) == 1);
+        }
+    remove(filename.c_str());
+}
+
 int main() {
     try {
         testCreateMesh();
         testLoadObjFile();
+        testLoadObjFileWithCRLF();
+        testLoadVtpFile();
     } catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
         return 1;
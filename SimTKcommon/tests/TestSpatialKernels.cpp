@@ -0,0 +1,169 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check each available set of SpatialKernels against the scalar spatial
+// algebra operators in SpatialAlgebra.h and MassProperties.h.
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+using namespace SimTK;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+// An odd number, so that any kernel that handles two at a time has one left.
+static const int N = 7;
+
+static ArticulatedInertia randArticulatedInertia() {
+    return ArticulatedInertia(Test::randSymMat33(), Test::randMat33(),
+                              Test::randSymMat33());
+}
+
+static bool isPaddingZero(const PaddedSpatialVec& v)
+{   return v.v[6] == 0 && v.v[7] == 0; }
+
+static bool isPaddingZero(const PaddedSpatialMat& m) {
+    for (int j=0; j < 6; ++j)
+        if (m.c[j][6] != 0 || m.c[j][7] != 0) return false;
+    return true;
+}
+
+void testConversions() {
+    const SpatialVec v = Test::randSpatialVec();
+    const SpatialMat m = Test::randSpatialMat();
+    const ArticulatedInertia P = randArticulatedInertia();
+    PaddedSpatialVec pv(v);
+    PaddedSpatialMat pm(m), pP(P);
+
+    SimTK_TEST(pv.toSpatialVec() == v);
+    SimTK_TEST(pm.toSpatialMat() == m);
+    SimTK_TEST(pP.toSpatialMat() == P.toSpatialMat());
+    SimTK_TEST(pP.toArticulatedInertia().toSpatialMat() == P.toSpatialMat());
+    SimTK_TEST(isPaddingZero(pv) && isPaddingZero(pm));
+    for (int i=0; i < 6; ++i) for (int j=0; j < 6; ++j)
+        SimTK_TEST(pm(i,j) == m(i/3,j/3)(i%3,j%3));
+
+    // Automatic objects get the declared alignment.
+    SimTK_TEST((size_t)&pv % 64 == 0);
+    SimTK_TEST((size_t)&pm % 64 == 0);
+    SimTK_TEST(sizeof(PaddedSpatialMat) == 48*sizeof(Real));
+}
+
+void testInstructionSets() {
+    const SpatialKernels::InstructionSet best =
+        SpatialKernels::getBestInstructionSet();
+    SimTK_TEST(SpatialKernels::getInstructionSet() == best);
+    SimTK_TEST(SpatialKernels::isInstructionSetAvailable(best));
+    SimTK_TEST(SpatialKernels::isInstructionSetAvailable(SpatialKernels::Scalar));
+    for (int set=best+1; set <= SpatialKernels::AVX512; ++set) {
+        const SpatialKernels::InstructionSet s =
+            SpatialKernels::InstructionSet(set);
+        SimTK_TEST(!SpatialKernels::isInstructionSetAvailable(s));
+        SimTK_TEST_MUST_THROW(SpatialKernels::setInstructionSet(s));
+    }
+    SimTK_TEST(SpatialKernels::getInstructionSet() == best);
+}
+
+// Run the kernels of the current instruction set on random data and compare
+// with the operators.
+void testCurrentKernels() {
+    PhiMatrix phi[N];
+    for (int k=0; k < N; ++k) phi[k] = PhiMatrix(Test::randVec3());
+
+    // 6x6 times 6-vectors, both into another array and in place.
+    const SpatialMat m = Test::randSpatialMat();
+    SpatialVec v[N];
+    PaddedSpatialVec pv[N], pmv[N];
+    for (int k=0; k < N; ++k) pv[k] = v[k] = Test::randSpatialVec();
+    SpatialKernels::multiply(PaddedSpatialMat(m), N, pv, pmv);
+    for (int k=0; k < N; ++k) {
+        SimTK_TEST_EQ(pmv[k].toSpatialVec(), m*v[k]);
+        SimTK_TEST(isPaddingZero(pmv[k]));
+    }
+    SpatialKernels::multiply(PaddedSpatialMat(m), N, pv, pv);
+    for (int k=0; k < N; ++k)
+        SimTK_TEST_EQ(pv[k].toSpatialVec(), m*v[k]);
+
+    // Phi times spatial vectors.
+    for (int k=0; k < N; ++k) pv[k] = v[k];
+    SpatialKernels::shift(N, phi, pv);
+    for (int k=0; k < N; ++k) {
+        SimTK_TEST_EQ(pv[k].toSpatialVec(), phi[k]*v[k]);
+        SimTK_TEST(isPaddingZero(pv[k]));
+    }
+
+    // Phi times spatial matrices.
+    SpatialMat ms[N];
+    PaddedSpatialMat pms[N];
+    for (int k=0; k < N; ++k) pms[k] = ms[k] = Test::randSpatialMat();
+    SpatialKernels::shift(N, phi, pms);
+    for (int k=0; k < N; ++k) {
+        SimTK_TEST_EQ(pms[k].toSpatialMat(), phi[k]*ms[k]);
+        SimTK_TEST(isPaddingZero(pms[k]));
+    }
+
+    // Articulated body inertia shift.
+    ArticulatedInertia P[N];
+    PaddedSpatialMat pP[N];
+    for (int k=0; k < N; ++k) pP[k] = PaddedSpatialMat(P[k] = randArticulatedInertia());
+    SpatialKernels::shiftArticulated(N, phi, pP);
+    for (int k=0; k < N; ++k) {
+        const ArticulatedInertia shifted = P[k].shift(phi[k].l());
+        const ArticulatedInertia result = pP[k].toArticulatedInertia();
+        SimTK_TEST_EQ(result.getMass(), shifted.getMass());
+        SimTK_TEST_EQ(result.getMassMoment(), shifted.getMassMoment());
+        SimTK_TEST_EQ(result.getInertia(), shifted.getInertia());
+        SimTK_TEST_EQ(pP[k].toSpatialMat(), shifted.toSpatialMat());
+        SimTK_TEST(isPaddingZero(pP[k]));
+    }
+
+    // An empty batch does nothing.
+    SpatialKernels::shiftArticulated(0, phi, pP);
+}
+
+void testAllKernels() {
+    const SpatialKernels::InstructionSet best =
+        SpatialKernels::getBestInstructionSet();
+    for (int set=SpatialKernels::Scalar; set <= best; ++set) {
+        const SpatialKernels::InstructionSet s =
+            SpatialKernels::InstructionSet(set);
+        if (!SpatialKernels::isInstructionSetAvailable(s))
+            continue;
+        cout << "Testing " << SpatialKernels::getInstructionSetName(s)
+             << " kernels." << endl;
+        SpatialKernels::setInstructionSet(s);
+        SimTK_TEST(SpatialKernels::getInstructionSet() == s);
+        testCurrentKernels();
+    }
+    SpatialKernels::setInstructionSet(best);
+}
+
+int main() {
+    SimTK_START_TEST("TestSpatialKernels");
+        SimTK_SUBTEST(testConversions);
+        SimTK_SUBTEST(testInstructionSets);
+        SimTK_SUBTEST(testAllKernels);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,215 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+
+#include <cmath>
+#include <iostream>
+
+#define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
+
+using std::cout;
+using std::endl;
+using namespace SimTK;
+using namespace std;
+
+bool isParallel;
+
+class SetFlagTask : public ParallelExecutor::Task {
+public:
+    SetFlagTask(Array_<int>& flags, int& count) : flags(flags), count(count) {
+    }
+    void execute(int index) {
+        flags[index]++;
+        localCount.upd()++;
+        ASSERT(ParallelExecutor::isWorkerThread() == isParallel);
+    }
+    void initialize() {
+        localCount.upd() = 0;
+        ASSERT(ParallelExecutor::isWorkerThread() == isParallel);
+    }
+    void finish() {
+        count += localCount.get();
+        ASSERT(ParallelExecutor::isWorkerThread() == isParallel);
+    }
+private:
+    Array_<int>& flags;
+    int& count;
+    ThreadLocal<int> localCount;
+};
+
+// A task whose cost depends strongly on the index, so that the threads which
+// get the cheap indices run out of work early and have to steal.
+class UnevenTask : public ParallelExecutor::Task {
+public:
+    UnevenTask(Array_<double>& results) : results(results) {
+    }
+    void execute(int index) {
+        double sum = 0;
+        const int n = (index < 8 ? 20000 : 10);
+        for (int i = 0; i < n; ++i)
+            sum += std::sqrt((double) (i+index));
+        results[index] = sum;
+    }
+private:
+    Array_<double>& results;
+};
+
+void testParallelExecution(int numThreads, int spinCount) {
+    const int numFlags = 100;
+    Array_<int> flags(numFlags);
+    isParallel = (numThreads > 1);
+    WorkStealingExecutor executor(numThreads);
+    executor.setSpinCount(spinCount);
+    ASSERT(executor.getNumThreads() == numThreads);
+    ASSERT(executor.getSpinCount() == spinCount);
+    ASSERT(!ParallelExecutor::isWorkerThread());
+    for (int i = 0; i < 100; ++i) {
+        int count = 0;
+        SetFlagTask task(flags, count);
+        for (int j = 0; j < numFlags; ++j)
+            flags[j] = 0;
+        const int times = numFlags-(i%20);
+        executor.execute(task, times);
+        ASSERT(count == times);
+        for (int j = 0; j < numFlags; ++j)
+            ASSERT(flags[j] == (j < times ? 1 : 0));
+    }
+    ASSERT(!ParallelExecutor::isWorkerThread());
+}
+
+void testUnevenWork() {
+    const int n = 1000;
+    Array_<double> serial(n), parallel(n);
+    UnevenTask serialTask(serial), parallelTask(parallel);
+    for (int i = 0; i < n; ++i)
+        serialTask.execute(i);
+    WorkStealingExecutor executor(4);
+    for (int rep = 0; rep < 10; ++rep) {
+        for (int i = 0; i < n; ++i)
+            parallel[i] = -1;
+        executor.execute(parallelTask, n);
+        for (int i = 0; i < n; ++i)
+            ASSERT(parallel[i] == serial[i]);
+    }
+}
+
+// Each invocation runs a complete SetFlagTask on a shared executor, so that
+// several threads call execute() on it at the same time.
+class ConcurrentCallerTask : public ParallelExecutor::Task {
+public:
+    ConcurrentCallerTask(WorkStealingExecutor& executor, Array_<int>& counts) 
+    :   executor(executor), counts(counts) {
+    }
+    void execute(int index) {
+        const int numFlags = 50;
+        Array_<int> flags(numFlags, 0);
+        int count = 0;
+        SetFlagTask task(flags, count);
+        executor.execute(task, numFlags);
+        for (int j = 0; j < numFlags; ++j)
+            ASSERT(flags[j] == 1);
+        counts[index] = count;
+    }
+private:
+    WorkStealingExecutor& executor;
+    Array_<int>& counts;
+};
+
+void testConcurrentCallers() {
+    isParallel = true;
+    WorkStealingExecutor executor(4);
+    ParallelExecutor callers(4);
+    const int numCalls = 40;
+    Array_<int> counts(numCalls, 0);
+    ConcurrentCallerTask task(executor, counts);
+    callers.execute(task, numCalls);
+    for (int i = 0; i < numCalls; ++i)
+        ASSERT(counts[i] == 50);
+}
+
+// A task that tries to use the executor that is running it. Only a call that
+// would be run serially is allowed.
+class NestedCallTask : public ParallelExecutor::Task {
+public:
+    NestedCallTask(WorkStealingExecutor& executor, Array_<int>& results) 
+    :   executor(executor), results(results) {
+    }
+    void execute(int index) {
+        Array_<int> flags(10, 0);
+        int count = 0;
+        SetFlagTask inner(flags, count);
+        executor.execute(inner, 1);
+        bool threw = false;
+        try {
+            executor.execute(inner, 10);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        results[index] = (count == 1 && threw ? 1 : 0);
+    }
+private:
+    WorkStealingExecutor& executor;
+    Array_<int>& results;
+};
+
+void testNestedCall() {
+    isParallel = true;
+    WorkStealingExecutor executor(4);
+    Array_<int> results(20, 0);
+    NestedCallTask task(executor, results);
+    executor.execute(task, results.size());
+    for (int i = 0; i < (int) results.size(); ++i)
+        ASSERT(results[i] == 1);
+}
+
+void testSingleThreadedExecution() {
+    const int numFlags = 100;
+    Array_<int> flags(numFlags);
+    isParallel = false;
+    WorkStealingExecutor executor(1); // Specify only a single thread.
+    int count = 0;
+    SetFlagTask task(flags, count);
+    for (int j = 0; j < numFlags; ++j)
+        flags[j] = 0;
+    executor.execute(task, numFlags-10);
+    ASSERT(count == numFlags-10);
+    for (int j = 0; j < numFlags; ++j)
+        ASSERT(flags[j] == (j < numFlags-10 ? 1 : 0));
+}
+
+int main() {
+    try {
+        testParallelExecution(4, 20000);
+        testParallelExecution(3, 0); // always sleep between tasks
+        testUnevenWork();
+        testConcurrentCallers();
+        testNestedCall();
+        testSingleThreadedExecution();
+    } catch(const std::exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Measure the per-dispatch overhead of ParallelExecutor and 
+// WorkStealingExecutor, that is, how long it takes to hand a task to the 
+// worker threads and get control back when there is almost no work to do. 
+// We also time a task with very uneven work per index, which is where 
+// work stealing should help. This is a benchmark, not a regression test; 
+// it just reports the times.
+
+#include "SimTKcommon.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using namespace SimTK;
+
+// Almost no work per index.
+class TrivialTask : public ParallelExecutor::Task {
+public:
+    explicit TrivialTask(Array_<int>& out) : out(out) {}
+    void execute(int index) {out[index] = index;}
+private:
+    Array_<int>& out;
+};
+
+// The first few indices are far more expensive than the rest.
+class UnevenTask : public ParallelExecutor::Task {
+public:
+    explicit UnevenTask(Array_<double>& out) : out(out) {}
+    void execute(int index) {
+        const int n = (index % 64 == 0 ? 20000 : 50);
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += std::sqrt((double) (i+index));
+        out[index] = sum;
+    }
+private:
+    Array_<double>& out;
+};
+
+template <class Executor>
+static double timeDispatches(Executor& executor, ParallelExecutor::Task& task,
+                             int times, int nDispatches) 
+{
+    executor.execute(task, times); // warm up
+    const double start = realTime();
+    for (int i=0; i < nDispatches; ++i)
+        executor.execute(task, times);
+    return (realTime() - start) / nDispatches;
+}
+
+int main(int argc, char** argv) {
+    const int nThreads = (argc > 1 ? atoi(argv[1]) 
+                                   : std::max(2, ParallelExecutor::getNumProcessors()));
+    const int nDispatches = (argc > 2 ? atoi(argv[2]) : 20000);
+    cout << "Threads: " << nThreads << ", dispatches: " << nDispatches << endl;
+
+    ParallelExecutor     condvar(nThreads);
+    WorkStealingExecutor stealing(nThreads);
+
+    Array_<int> ints(4096);
+    TrivialTask trivial(ints);
+    Array_<double> doubles(4096);
+    UnevenTask uneven(doubles);
+
+    printf("%-28s %14s %14s %8s\n", "task", "ParallelExec", "WorkStealing", "ratio");
+    const int sizes[] = {8, 64, 1024, 4096};
+    for (int k=0; k < 4; ++k) {
+        const int n = sizes[k];
+        const double tc = timeDispatches(condvar,  trivial, n, nDispatches);
+        const double ts = timeDispatches(stealing, trivial, n, nDispatches);
+        char label[64]; sprintf(label, "trivial x %d", n);
+        printf("%-28s %12.2fus %12.2fus %8.2f\n", label, 1e6*tc, 1e6*ts, tc/ts);
+    }
+    for (int k=1; k < 4; ++k) {
+        const int n = sizes[k];
+        const int reps = std::max(1, nDispatches/20);
+        const double tc = timeDispatches(condvar,  uneven, n, reps);
+        const double ts = timeDispatches(stealing, uneven, n, reps);
+        char label[64]; sprintf(label, "uneven x %d", n);
+        printf("%-28s %12.2fus %12.2fus %8.2f\n", label, 1e6*tc, 1e6*ts, tc/ts);
+    }
+    return 0;
+}
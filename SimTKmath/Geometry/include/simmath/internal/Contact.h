@@ -59,6 +59,7 @@ SimTK_DEFINE_UNIQUE_INDEX_TYPE(ContactTypeId);
 class ContactImpl;
 class UntrackedContactImpl;
 class BrokenContactImpl;
+class AnticipatedContactImpl;
 class CircularPointContactImpl;
 class EllipticalPointContactImpl;
 class TriangleMeshContactImpl;
@@ -238,6 +239,52 @@ private:
 
 
 
+//==============================================================================
+//                          ANTICIPATED CONTACT
+//==============================================================================
+/** This subclass of Contact represents a pair of contact surfaces that are
+not in contact now but which, if their current velocities and accelerations
+were to persist, could come into contact within the interval of interest that
+was given to the ContactTracker. The predicted time is a conservative (early)
+estimate, measured from the time at which the prediction was made; the 
+surfaces cannot touch before then under the assumed motion. A time integrator
+can use this to avoid stepping over the onset of contact. **/
+class SimTK_SIMMATH_EXPORT AnticipatedContact : public Contact {
+public:
+    /** Create an AnticipatedContact object.
+    @param surf1        The index of the first surface involved in the contact.
+    @param surf2        The index of the second surface involved in the contact.
+    @param X_S1S2       The surface-to-surface relative transform now.
+    @param separation   The minimum distance between the surfaces now, with
+                        separation > 0.
+    @param timeToContact The time from now at which contact may begin, with
+                        0 <= timeToContact <= interval of interest. **/
+    AnticipatedContact(ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
+                       const Transform& X_S1S2, Real separation, 
+                       Real timeToContact); 
+
+    /** Get the separation (> 0) between the two surfaces at the time the
+    prediction was made. **/
+    Real getSeparation() const;
+    /** Get the time remaining, from the time the prediction was made, until
+    these surfaces may come into contact. **/
+    Real getTimeToContact() const;
+
+    /** Determine whether a Contact object is an AnticipatedContact. **/
+    static bool isInstance(const Contact& contact);
+    /** Obtain the unique small-integer id for the AnticipatedContact
+    class. **/ 
+    static ContactTypeId classTypeId();
+
+private:
+    const AnticipatedContactImpl& getImpl() const 
+    {   assert(isInstance(*this)); 
+        return reinterpret_cast<const AnticipatedContactImpl&>
+                    (Contact::getImpl()); }
+};
+
+
+
 //==============================================================================
 //                           CIRCULAR POINT CONTACT
 //==============================================================================
@@ -411,7 +458,9 @@ private:
 //==============================================================================
 /** This subclass of Contact is used when one or both of the ContactGeometry 
 objects is a TriangleMesh. It stores a list of every face on each object 
-that is partly or completely inside the other one. **/
+that is partly or completely inside the other one. The lists are kept as
+sorted arrays of face indices, which are much cheaper to build, copy, and
+walk than node-based sets. **/
 class SimTK_SIMMATH_EXPORT TriangleMeshContact : public Contact {
 public:
     /** Create a TriangleMeshContact object.
@@ -431,15 +480,36 @@ public:
                         const std::set<int>&    faces1, 
                         const std::set<int>&    faces2);
 
+    /** Create a TriangleMeshContact object from arrays of face indices. The
+    arguments are as for the other constructor except that the face lists
+    may be in any order and may contain duplicates; they will be sorted and
+    duplicates removed. **/
+    TriangleMeshContact(ContactSurfaceIndex     surf1, 
+                        ContactSurfaceIndex     surf2,
+                        const Transform&        X_S1S2,
+                        const Array_<int>&      faces1, 
+                        const Array_<int>&      faces2);
+
     /** Get the indices of all faces of surface1 that are partly or completely 
     inside surface2. If surface1 is not a TriangleMesh, this will return an 
-    empty set. **/
+    empty set. The set is built from getSurface1FaceIndices() the first time
+    this is called; use that method instead where performance matters. **/
     const std::set<int>& getSurface1Faces() const;
     /** Get the indices of all faces of surface2 that are partly or completely
     inside surface1. If surface2 is not a TriangleMesh, this will return an 
-    empty set. **/
+    empty set. The set is built from getSurface2FaceIndices() the first time
+    this is called; use that method instead where performance matters. **/
     const std::set<int>& getSurface2Faces() const;
 
+    /** Get the same faces as getSurface1Faces(), as an array in ascending 
+    order with no duplicates. If surface1 is not a TriangleMesh, this will 
+    return an empty array. **/
+    const Array_<int>& getSurface1FaceIndices() const;
+    /** Get the same faces as getSurface2Faces(), as an array in ascending 
+    order with no duplicates. If surface2 is not a TriangleMesh, this will 
+    return an empty array. **/
+    const Array_<int>& getSurface2FaceIndices() const;
+
     /** Determine whether a Contact object is a TriangleMeshContact. **/
     static bool isInstance(const Contact& contact);
     /** Recast a triangle mesh given as a generic Contact object to a 
@@ -42,7 +42,7 @@ contact geometry for fast lookup purposes. **/
 SimTK_DEFINE_UNIQUE_INDEX_TYPE(ContactGeometryTypeId);
 
 class ContactGeometryImpl;
-class OBBTreeNodeImpl;
+class OBBTreeImpl;
 class OBBTree;
 
 
@@ -133,6 +133,20 @@ may return any of them.
 specified point. **/
 Vec3 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const;
 
+/** Find the nearest surface point for each of a block of \a n points at
+once. The result for each point is the same as findNearestPoint() would return
+for it, but there is one virtual call per block rather than one per point.
+This is intended for algorithms like elastic foundation contact that evaluate
+many points against the same surface.
+@param[in]  n               The number of points.
+@param[in]  positions       The \a n points in question.
+@param[out] nearestPoints   On exit, the \a n nearest points.
+@param[out] inside          On exit, whether each point was inside.
+@param[out] normals         On exit, the surface normal at each nearest point.
+All arrays must have room for at least \a n elements. **/
+void findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[],
+                       bool inside[], UnitVec3 normals[]) const;
+
 /** Determine whether this object intersects a ray, and if so, find the 
 intersection point.
 @param[in]  origin      The position at which the ray begins.
@@ -779,6 +793,24 @@ OBBTreeNode getOBBTreeNode() const;
 because you can create a DecorativeMesh from this and then look at it. **/
 PolygonalMesh createPolygonalMesh() const;
 
+/** Write this mesh to a binary cache file, including everything that is 
+otherwise calculated when a mesh is created: its edges, face and vertex 
+normals, and OBB tree. Use readCacheFile() to load it again, which is much 
+faster than building a large mesh from its vertices and faces. The file 
+records its format version and the layout of the data it contains, and can be
+read only by a build of Simbody that uses the same layout (for example, the 
+same precision for Real); it is a cache, not an interchange format.
+@param pathname    The name of the file to create or overwrite. **/
+void writeCacheFile(const String& pathname) const;
+/** Create a TriangleMesh from a cache file written by writeCacheFile(). Where
+the platform supports it the file is memory-mapped and the mesh, and any 
+copies of it, refer to its contents directly rather than copying them. An 
+exception is thrown if the file isn't a mesh cache file, is incomplete, or was
+written with a different format version or data layout; in that case the mesh
+should be built from its vertices and faces and the cache file rewritten.
+@param pathname    The name of the cache file. **/
+static TriangleMesh readCacheFile(const String& pathname);
+
 /** Return true if the supplied ContactGeometry object is a triangle mesh. **/
 static bool isInstance(const ContactGeometry& geo)
 {   return geo.getTypeId()==classTypeId(); }
@@ -795,6 +827,9 @@ static ContactGeometryTypeId classTypeId();
 class Impl; /**< Internal use only. **/
 const Impl& getImpl() const; /**< Internal use only. **/
 Impl& updImpl(); /**< Internal use only. **/
+
+private:
+explicit TriangleMesh(Impl* impl);
 };
 
 
@@ -805,10 +840,15 @@ Impl& updImpl(); /**< Internal use only. **/
 /** This class represents a node in the Oriented Bounding Box Tree for a 
 TriangleMesh. Each node has an OrientedBoundingBox that fully encloses all 
 triangles contained within it or its  children. This is a binary tree: each 
-non-leaf node has two children. Triangles are stored only in the leaf nodes. **/
+non-leaf node has two children. Triangles are stored only in the leaf nodes. 
+
+The tree is stored in a single contiguous array of nodes in depth-first order,
+so an OBBTreeNode is just a lightweight reference to one entry of that array 
+and is cheap to copy. It remains valid only as long as the TriangleMesh that
+it came from. **/
 class SimTK_SIMMATH_EXPORT ContactGeometry::TriangleMesh::OBBTreeNode {
 public:
-OBBTreeNode(const OBBTreeNodeImpl& impl);
+OBBTreeNode(const OBBTreeImpl& tree, int index); /**< Internal use only. **/
 /** Get the OrientedBoundingBox which encloses all triangles in this node or 
 its children. **/
 const OrientedBoundingBox& getBounds() const;
@@ -821,15 +861,17 @@ const OBBTreeNode getFirstChildNode() const;
 exception. **/
 const OBBTreeNode getSecondChildNode() const;
 /** Get the indices of all triangles contained in this node. Calling this on a
-non-leaf node will produce an exception. **/
-const Array_<int>& getTriangles() const;
+non-leaf node will produce an exception. The returned view refers to storage
+owned by the TriangleMesh. **/
+ArrayViewConst_<int> getTriangles() const;
 /** Get the number of triangles inside this node. If this is not a leaf node,
 this is the total number of triangles contained by all children of this
 node. **/
 int getNumTriangles() const;
 
 private:
-const OBBTreeNodeImpl* impl;
+const OBBTreeImpl*  tree;
+int                 index;
 };
 
 } // namespace SimTK
@@ -103,7 +103,14 @@ contact surfaces that is still not in contact after trackContact() looked at
 it, or any untracked pair for which the dynamic broad phase indicated that 
 they might be in contact within the interval of interest. Position, velocity, 
 and acceleration information may be used. Ordering must be correct as 
-discussed for trackContact(). **/
+discussed for trackContact(). 
+
+If the surfaces might come within \a cutoff of each other within 
+\a intervalOfInterest time units, \a predictedStatus is set to an 
+AnticipatedContact giving a conservative (never late) estimate of the time 
+until that happens; otherwise it is cleared. The built-in trackers assume 
+that each surface frame's spatial acceleration stays constant over the 
+interval. **/
 virtual bool predictContact
    (const Contact&         priorStatus,
     const Transform& X_GS1, const SpatialVec& V_GS1, const SpatialVec& A_GS1,
@@ -118,7 +125,13 @@ virtual bool predictContact
 help disambiguate tricky contact situations. This method may use current
 position and velocity information in heuristics for guessing the contact
 status between the indicated pair of surfaces. Ordering must be correct as 
-discussed for trackContact(). **/
+discussed for trackContact(). 
+
+The built-in trackers track the pair as though the contact were new and, if
+the surfaces are not touching, predict contact with the current velocities 
+held constant, so \a contactStatus is returned empty, as a contact, or as an
+AnticipatedContact. If \a contactStatus is not empty on entry its surface
+indices are used in the result. **/
 virtual bool initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
     const ContactGeometry& surface1,
@@ -365,10 +378,10 @@ virtual bool initializeContact
 
 private:
 void processBox(const ContactGeometry::TriangleMesh&              mesh, 
-                const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+                const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
                 const Transform& X_HM, const UnitVec3& hsNormal_M, 
                 Real hsFaceHeight_M, std::set<int>& insideFaces) const;
-void addAllTriangles(const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+void addAllTriangles(const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
                      std::set<int>& insideFaces) const; 
 };
 
@@ -419,7 +432,7 @@ virtual bool initializeContact
 private:
 void processBox
    (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+    const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
     const Vec3& center_M, Real radius2,   
     std::set<int>& insideFaces) const ;
 };
@@ -467,27 +480,6 @@ virtual bool initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const;
-
-private:
-void findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      insideFaces1, 
-    std::set<int>&                                      insideFaces2) const; 
-void findBuriedFaces
-   (const ContactGeometry::TriangleMesh&    mesh,
-    const ContactGeometry::TriangleMesh&    otherMesh,
-    const Transform&                        X_OM, 
-    std::set<int>&                          insideFaces) const;
-void tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
-              Array_<int>&                           faceType,
-              std::set<int>&                         triangles, 
-              int                                    index,
-              int                                    depth) const;
 };
 
 
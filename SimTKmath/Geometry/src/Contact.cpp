@@ -28,6 +28,8 @@
 #include "ContactImpl.h"
 
 #include <set>
+#include <algorithm>
+#include <pthread.h>
 
 using namespace SimTK;
 using std::set;
@@ -138,6 +140,31 @@ Real BrokenContact::getSeparation() const
 
 
 
+//==============================================================================
+//                          ANTICIPATED CONTACT
+//==============================================================================
+AnticipatedContact::AnticipatedContact
+   (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2, 
+    const Transform& X_S1S2, Real separation, Real timeToContact) 
+:   Contact(new AnticipatedContactImpl(surf1, surf2, X_S1S2, separation,
+                                       timeToContact)) {}
+
+/*static*/ bool AnticipatedContact::isInstance(const Contact& contact) {
+    return (dynamic_cast<const AnticipatedContactImpl*>(&contact.getImpl()) 
+            != 0);
+}
+
+/*static*/ ContactTypeId AnticipatedContact::classTypeId() 
+{   return AnticipatedContactImpl::classTypeId(); }
+
+Real AnticipatedContact::getSeparation() const 
+{   return getImpl().separation; }
+
+Real AnticipatedContact::getTimeToContact() const 
+{   return getImpl().timeToContact; }
+
+
+
 //==============================================================================
 //                          CIRCULAR POINT CONTACT
 //==============================================================================
@@ -208,9 +235,21 @@ TriangleMeshContact::TriangleMeshContact
 :   Contact(new TriangleMeshContactImpl(surf1, surf2, X_S1S2, 
                                         faces1, faces2)) {}
 
+TriangleMeshContact::TriangleMeshContact
+   (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
+    const Transform& X_S1S2,
+    const Array_<int>& faces1, const Array_<int>& faces2) 
+:   Contact(new TriangleMeshContactImpl(surf1, surf2, X_S1S2, 
+                                        faces1, faces2)) {}
+
 const set<int>& TriangleMeshContact::getSurface1Faces() const 
-{   return getImpl().faces1; }
+{   getImpl().ensureFaceSetsBuilt(); return getImpl().faceSet1; }
 const set<int>& TriangleMeshContact::getSurface2Faces() const 
+{   getImpl().ensureFaceSetsBuilt(); return getImpl().faceSet2; }
+
+const Array_<int>& TriangleMeshContact::getSurface1FaceIndices() const 
+{   return getImpl().faces1; }
+const Array_<int>& TriangleMeshContact::getSurface2FaceIndices() const 
 {   return getImpl().faces2; }
 
 /*static*/ bool TriangleMeshContact::isInstance(const Contact& contact) 
@@ -224,7 +263,39 @@ TriangleMeshContactImpl::TriangleMeshContactImpl
    (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
     const Transform& X_S1S2,
     const set<int>& faces1, const set<int>& faces2) 
-:   ContactImpl(surf1, surf2, X_S1S2), faces1(faces1), faces2(faces2) {}
+:   ContactImpl(surf1, surf2, X_S1S2), nearMargin(0),
+    faces1(faces1.begin(), faces1.end()), // already sorted
+    faces2(faces2.begin(), faces2.end()), faceSetsBuilt(false) {}
+
+// Sort the face list and squeeze out duplicates.
+static void sortUniqueFaces(Array_<int>& faces) {
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+}
+
+TriangleMeshContactImpl::TriangleMeshContactImpl
+   (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2,
+    const Transform& X_S1S2,
+    const Array_<int>& faces1, const Array_<int>& faces2) 
+:   ContactImpl(surf1, surf2, X_S1S2), nearMargin(0), 
+    faces1(faces1), faces2(faces2), faceSetsBuilt(false) {
+    sortUniqueFaces(this->faces1);
+    sortUniqueFaces(this->faces2);
+}
+
+// A Contact may be looked at from several threads, so the lazily built sets
+// are filled in under a lock. This is only used by the std::set accessors.
+static pthread_mutex_t faceSetLock = PTHREAD_MUTEX_INITIALIZER;
+
+void TriangleMeshContactImpl::ensureFaceSetsBuilt() const {
+    pthread_mutex_lock(&faceSetLock);
+    if (!faceSetsBuilt) {
+        faceSet1.insert(faces1.begin(), faces1.end());
+        faceSet2.insert(faces2.begin(), faces2.end());
+        faceSetsBuilt = true;
+    }
+    pthread_mutex_unlock(&faceSetLock);
+}
 
 
 
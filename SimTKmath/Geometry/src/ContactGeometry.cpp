@@ -32,14 +32,19 @@
 
 #include "ContactGeometryImpl.h"
 
+#include <algorithm>
 #include <cmath>
-#include <map>
-#include <set>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 using namespace SimTK;
-using std::map;
-using std::pair;
-using std::set;
 using std::string;
 
 //==============================================================================
@@ -96,6 +101,11 @@ Vec3 ContactGeometry::findNearestPoint(const Vec3& position, bool& inside, UnitV
     return getImpl().findNearestPoint(position, inside, normal);
 }
 
+void ContactGeometry::findNearestPoints(int n, const Vec3 positions[], 
+    Vec3 nearestPoints[], bool inside[], UnitVec3 normals[]) const {
+    getImpl().findNearestPoints(n, positions, nearestPoints, inside, normals);
+}
+
 void ContactGeometry::getBoundingSphere(Vec3& center, Real& radius) const {
     getImpl().getBoundingSphere(center, radius);
 }
@@ -296,6 +306,18 @@ Vec3 ContactGeometry::HalfSpace::Impl::findNearestPoint
     return Vec3(0, position[1], position[2]);
 }
 
+void ContactGeometry::HalfSpace::Impl::findNearestPoints
+   (int n, const Vec3 positions[], Vec3 nearestPoints[], bool inside[], 
+    UnitVec3 normals[]) const {
+    const UnitVec3 normal = -UnitVec3(XAxis);
+    for (int i=0; i < n; ++i) {
+        const Vec3& p = positions[i];
+        inside[i] = (p[0] >= 0);
+        normals[i] = normal;
+        nearestPoints[i] = Vec3(0, p[1], p[2]);
+    }
+}
+
 bool ContactGeometry::HalfSpace::Impl::intersectsRay
    (const Vec3& origin, const UnitVec3& direction, 
     Real& distance, UnitVec3& normal) const 
@@ -365,6 +387,20 @@ Vec3 ContactGeometry::Sphere::Impl::findNearestPoint(const Vec3& position, bool&
     return normal*radius;
 }
 
+// Same as findNearestPoint(), with everything inlined into one loop.
+void ContactGeometry::Sphere::Impl::findNearestPoints
+   (int n, const Vec3 positions[], Vec3 nearestPoints[], bool inside[], 
+    UnitVec3 normals[]) const {
+    const Real r2 = radius*radius;
+    for (int i=0; i < n; ++i) {
+        const Vec3& p = positions[i];
+        const Real d2 = p.normSqr();
+        inside[i] = (d2 <= r2);
+        normals[i] = UnitVec3(p);
+        nearestPoints[i] = normals[i]*radius;
+    }
+}
+
 bool ContactGeometry::Sphere::Impl::intersectsRay
    (const Vec3& origin, const UnitVec3& direction, 
     Real& distance, UnitVec3& normal) const 
@@ -640,6 +676,10 @@ findParaboloidAtPointWithNormal(const Vec3& Q, const UnitVec3& nn,
 }
 
 
+// Ellipsoid::findNearestPoint() treats a point as near the symmetry plane of
+// the shortest axis when it is closer to it than this fraction of that radius.
+static const Real NearPlaneTol = Real(1e-4);
+
 // Peter E. says he implemented this from David Eberly's web site
 // http://www.geometrictools.com/Documentation/DistancePointToEllipsoid.pdf
 // Eberly says he got it from John Hart's article in Graphics Gems 4, page
@@ -658,8 +698,29 @@ findParaboloidAtPointWithNormal(const Vec3& Q, const UnitVec3& nn,
 // this implementation. -- Sherm 20110203.
 //
 // TODO: use faster method?
+//
+// The polynomial root is not usable when the point is on or very near the
+// symmetry plane perpendicular to the shortest axis. The root we want then
+// approaches -r^2 (r the shortest radius), where the polynomial's roots
+// cluster, and when the point is on the plane the nearest point may leave the
+// plane altogether so that there is no such root at all. That case is handled
+// separately by findNearestPointNearPlane().
 Vec3 ContactGeometry::Ellipsoid::Impl::
 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
+    int k = 0; // the shortest axis
+    for (int i = 1; i < 3; i++)
+        if (radii[i] < radii[k])
+            k = i;
+    if (std::abs(position[k]) < NearPlaneTol*radii[k]) {
+        const Vec3 result = findNearestPointNearPlane(position, k);
+        const Vec3 ri2(1/square(radii[0]), 1/square(radii[1]),
+                       1/square(radii[2]));
+        inside = (square(position[0])*ri2[0] + square(position[1])*ri2[1]
+                  + square(position[2])*ri2[2] < 1.0);
+        normal = UnitVec3(result[0]*ri2[0], result[1]*ri2[1], result[2]*ri2[2]);
+        return result;
+    }
+
     Real a2 = radii[0]*radii[0];
     Real b2 = radii[1]*radii[1];
     Real c2 = radii[2]*radii[2];
@@ -687,6 +748,28 @@ findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
     for (int i = 0; i < 6; i++)
         if (fabs(roots[i].imag()) < 1e-10 && (roots[i].real()) > (root))
             root = roots[i].real();
+    // The polynomial root loses accuracy when the point is close to one of
+    // the symmetry planes, so polish it with Newton iterations on Eberly's
+    // function F(t) = sum(r_i^2 p_i^2 / (t+r_i^2)^2) - 1, keeping a step only
+    // if it reduces |F|.
+    const Vec3 r2(a2, b2, c2), p2(px2, py2, pz2);
+    const Real tMin = -std::min(a2, std::min(b2, c2));
+    Real t = root, bestF = NTraits<Real>::getInfinity();
+    for (int iter = 0; iter < 4 && t > tMin; ++iter) {
+        Real F = -1, dF = 0;
+        for (int i = 0; i < 3; i++) {
+            const Real s = 1/(t+r2[i]);
+            const Real term = r2[i]*p2[i]*s*s;
+            F  += term;
+            dF -= 2*term*s;
+        }
+        if (!(fabs(F) < bestF))
+            break;
+        root = t; bestF = fabs(F);
+        if (dF == 0)
+            break;
+        t -= F/dF;
+    }
     Vec3 result(position[0]*a2/(root+a2), position[1]*b2/(root+b2), position[2]*c2/(root+c2));
     Vec3 ri2(1/a2, 1/b2, 1/c2);
     inside = (position[0]*position[0]*ri2[0] + position[1]*position[1]*ri2[1] + position[2]*position[2]*ri2[2] < 1.0);
@@ -694,6 +777,76 @@ findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const {
     return result;
 }
 
+// With r_k the shortest radius, write Eberly's function in terms of
+// s = t + r_k^2 and d_i = r_i^2 - r_k^2 >= 0:
+//      F(s) = sum(r_i^2 p_i^2 / (s+d_i)^2) - 1.
+// F decreases for s > 0, and the root we want is the only one there. Let
+// rho = |p_k|, or the root sum of squares of the p_i over all the axes with
+// radius r_k if there are several. Then F(r_k*rho) >= 0 and 
+// F(sqrt(sum(r_i^2 p_i^2))) <= 0, so the root can be bracketed and bisected 
+// to full precision no matter how close p is to the plane. The coordinates of
+// the nearest point are then r_i^2 p_i / (s+d_i), computed without 
+// cancellation.
+//
+// If p is exactly on the plane (rho=0), F has no pole at s=0. If F(0) <= 0
+// there is no root with s > 0 and the nearest point is off the plane: 
+// x_i = r_i^2 p_i / d_i for the other axes, and x_k is then given by the 
+// ellipsoid's equation. Its two mirror images are equally near; we return the
+// one with x_k >= 0.
+Vec3 ContactGeometry::Ellipsoid::Impl::
+findNearestPointNearPlane(const Vec3& position, int k) const {
+    const Real rk2 = square(radii[k]);
+    Vec3 d, w;
+    Real rho2 = 0, wsum = 0;
+    for (int i = 0; i < 3; i++) {
+        d[i] = square(radii[i]) - rk2;
+        w[i] = square(radii[i])*square(position[i]);
+        wsum += w[i];
+        if (d[i] == 0)
+            rho2 += square(position[i]);
+    }
+
+    Vec3 result;
+    if (rho2 == 0) {
+        Real G = 0;
+        for (int i = 0; i < 3; i++)
+            if (d[i] != 0)
+                G += w[i]/square(d[i]);
+        if (G <= 1) {
+            for (int i = 0; i < 3; i++)
+                result[i] = d[i] != 0 ? square(radii[i])*position[i]/d[i] : 0;
+            result[k] = radii[k]*std::sqrt(1-G);
+            return result;
+        }
+    }
+
+    Real lo = radii[k]*std::sqrt(rho2), hi = std::sqrt(wsum);
+    for (;;) {
+        const Real s = (lo+hi)/2;
+        if (!(lo < s && s < hi))
+            break;
+        Real F = -1;
+        for (int i = 0; i < 3; i++)
+            F += w[i]/square(s+d[i]);
+        if (F > 0) lo = s;
+        else       hi = s;
+    }
+    const Real s = (lo+hi)/2;
+    for (int i = 0; i < 3; i++)
+        result[i] = square(radii[i])*position[i]/(s+d[i]);
+    return result;
+}
+
+// Each point requires a polynomial root solve; we just avoid the virtual
+// call.
+void ContactGeometry::Ellipsoid::Impl::findNearestPoints
+   (int n, const Vec3 positions[], Vec3 nearestPoints[], bool inside[], 
+    UnitVec3 normals[]) const {
+    for (int i=0; i < n; ++i)
+        nearestPoints[i] = Ellipsoid::Impl::findNearestPoint
+                                (positions[i], inside[i], normals[i]);
+}
+
 // Peter says he took this algorithm from Art of Illusion but can't remember
 // where it came from. It is similar to an algorithm presented in this thread:
 // http://www.ogre3d.org/forums/viewtopic.php?f=2&t=26442&start=0
@@ -992,6 +1145,19 @@ ContactGeometry::TriangleMesh::TriangleMesh
    (const PolygonalMesh& mesh, bool smooth) 
 :   ContactGeometry(new TriangleMesh::Impl(mesh, smooth)) {}
 
+ContactGeometry::TriangleMesh::TriangleMesh(Impl* impl) 
+:   ContactGeometry(impl) {}
+
+void ContactGeometry::TriangleMesh::writeCacheFile
+   (const String& pathname) const {
+    getImpl().writeCacheFile(pathname);
+}
+
+/*static*/ ContactGeometry::TriangleMesh 
+ContactGeometry::TriangleMesh::readCacheFile(const String& pathname) {
+    return TriangleMesh(Impl::readCacheFile(pathname));
+}
+
 /*static*/ ContactGeometryTypeId ContactGeometry::TriangleMesh::classTypeId() 
 {   return ContactGeometry::TriangleMesh::Impl::classTypeId(); }
 
@@ -1122,7 +1288,7 @@ bool ContactGeometry::TriangleMesh::intersectsRay
 
 ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::getOBBTreeNode() const {
-    return OBBTreeNode(getImpl().obb);
+    return OBBTreeNode(getImpl().obb, 0);
 }
 
 PolygonalMesh ContactGeometry::TriangleMesh::createPolygonalMesh() const {
@@ -1194,6 +1360,17 @@ findNearestPoint(const Vec3& position, bool& inside, int& face, Vec2& uv) const
     return nearestPoint;
 }
 
+void ContactGeometry::TriangleMesh::Impl::
+findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[], 
+                  bool inside[], UnitVec3 normals[]) const {
+    for (int i=0; i < n; ++i) {
+        int face; Vec2 uv;
+        nearestPoints[i] = TriangleMesh::Impl::findNearestPoint
+                                (positions[i], inside[i], face, uv);
+        normals[i] = findNormalAtPoint(face, uv);
+    }
+}
+
 bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               UnitVec3& normal) const {
@@ -1209,7 +1386,7 @@ bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
     Real boundsDistance;
-    if (!obb.bounds.intersectsRay(origin, direction, boundsDistance))
+    if (!obb.getRoot().bounds.intersectsRay(origin, direction, boundsDistance))
         return false;
     return obb.intersectsRay(*this, origin, direction, distance, face, uv);
 }
@@ -1234,13 +1411,13 @@ createPolygonalMesh(PolygonalMesh& mesh) const {
 ContactGeometry::TriangleMesh::Impl::Impl
    (const ArrayViewConst_<Vec3>& vertexPositions, 
     const ArrayViewConst_<int>& faceIndices, bool smooth) 
-:   ContactGeometryImpl(), smooth(smooth) {
+:   ContactGeometryImpl(), smooth(smooth), cacheData(0) {
     init(vertexPositions, faceIndices);
 }
 
 ContactGeometry::TriangleMesh::Impl::Impl
    (const PolygonalMesh& mesh, bool smooth) 
-:   ContactGeometryImpl(), smooth(smooth) 
+:   ContactGeometryImpl(), smooth(smooth), cacheData(0) 
 {   // Create the mesh, triangulating faces as necessary.
     Array_<Vec3>    vertexPositions;
     Array_<int>     faceIndices;
@@ -1300,7 +1477,7 @@ ContactGeometry::TriangleMesh::Impl::Impl
     // face's normal will be pointing back at us. If it is wrong, the face 
     // normal will also be pointing inwards, in roughly the same direction as 
     // the ray.
-    origin -= max(obb.bounds.getSize())*direction;
+    origin -= max(obb.getRoot().bounds.getSize())*direction;
     Real distance;
     int face;
     Vec2 uv;
@@ -1335,13 +1512,21 @@ void ContactGeometry::TriangleMesh::Impl::init
     
     // Create the vertices.
     
+    vertices.reserve(vertexPositions.size());
     for (int i = 0; i < (int) vertexPositions.size(); i++)
         vertices.push_back(Vertex(vertexPositions[i]));
     
-    // Create the faces and build lists of all the edges.
+    // Create the faces, and each edge the first time it is seen. Edges are
+    // found by their pair of vertices in a hash table of edge indices with
+    // open addressing; it is kept at most half full. An edge's first face is
+    // the one that goes from its lower numbered vertex to its higher one.
     
-    map<pair<int, int>, int> forwardEdges;
-    map<pair<int, int>, int> backwardEdges;
+    faces.reserve(numFaces);
+    edges.reserve(3*numFaces/2);
+    unsigned tableSize = 1;
+    while (tableSize < 3*(unsigned)numFaces)
+        tableSize *= 2;
+    Array_<int> edgeTable(tableSize, -1);
     for (int i = 0; i < numFaces; i++) {
         int start = i*3;
         int v1 = faceIndices[start], v2 = faceIndices[start+1], 
@@ -1359,73 +1544,43 @@ void ContactGeometry::TriangleMesh::Impl::init
         SimTK_APIARGCHECK1_ALWAYS(norm > 0, 
             "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
             "Face %d is degenerate.", i);
-        faces.push_back(Face(v1, v2, v3, cross, 0.5*norm));
-        int edges[3][2] = {{v1, v2}, {v2, v3}, {v3, v1}};
+        Face face(v1, v2, v3, cross, 0.5*norm);
         for (int j = 0; j < 3; j++) {
-            SimTK_APIARGCHECK1_ALWAYS(edges[j][0] != edges[j][1], 
+            // Face edge j goes from face vertex j to the next one.
+            const int from = face.vertices[j], to = face.vertices[(j+1)%3];
+            SimTK_APIARGCHECK1_ALWAYS(from != to, 
                 "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                "Vertices %d appears twice in a single face.", edges[j][0]);
-            if (edges[j][0] < edges[j][1]) {
-                SimTK_APIARGCHECK2_ALWAYS
-                   (forwardEdges.find(pair<int, int>(edges[j][0], edges[j][1])) 
-                    == forwardEdges.end(),
-                    "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                    "Multiple faces have an edge between vertices %d and %d"
-                    " in the same order.", edges[j][0], edges[j][1]);
-                forwardEdges[pair<int, int>(edges[j][0], edges[j][1])] = i;
-            }
-            else {
-                SimTK_APIARGCHECK2_ALWAYS
-                   (backwardEdges.find(pair<int, int>(edges[j][1], edges[j][0]))
-                    == backwardEdges.end(),
-                    "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-                    "Multiple faces have an edge between vertices %d and %d"
-                    " in the same order.", edges[j][1], edges[j][0]);
-                backwardEdges[pair<int, int>(edges[j][1], edges[j][0])] = i;
+                "Vertices %d appears twice in a single face.", from);
+            const bool forward = (from < to);
+            const int lo = forward ? from : to, hi = forward ? to : from;
+            unsigned hash = (unsigned)lo*0x9E3779B1u + (unsigned)hi;
+            hash ^= hash >> 15;
+            hash *= 0x85EBCA6Bu;
+            hash ^= hash >> 13;
+            unsigned slot = hash & (tableSize-1);
+            while (edgeTable[slot] >= 0 
+                   && (   edges[edgeTable[slot]].vertices[0] != lo 
+                       || edges[edgeTable[slot]].vertices[1] != hi))
+                slot = (slot+1) & (tableSize-1);
+            if (edgeTable[slot] < 0) {
+                edgeTable[slot] = edges.size();
+                edges.push_back(Edge(lo, hi, -1, -1));
             }
+            int& edgeFace = edges[edgeTable[slot]].faces[forward ? 0 : 1];
+            SimTK_APIARGCHECK2_ALWAYS(edgeFace < 0,
+                "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
+                "Multiple faces have an edge between vertices %d and %d"
+                " in the same order.", lo, hi);
+            edgeFace = i;
+            face.edges[j] = edgeTable[slot];
         }
+        faces.push_back(face);
     }
-    
-    // Create the edges.
-    
-    SimTK_APIARGCHECK_ALWAYS(forwardEdges.size() == backwardEdges.size(), 
-        "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
-        "Each edge must be shared by exactly two faces.");
-    for (map<pair<int, int>, int>::iterator iter = forwardEdges.begin(); 
-         iter != forwardEdges.end(); ++iter) {
-        int vert1 = iter->first.first;
-        int vert2 = iter->first.second;
-        int face1 = iter->second;
-        map<pair<int, int>, int>::iterator iter2 = 
-            backwardEdges.find(pair<int, int>(vert1, vert2));
-        SimTK_APIARGCHECK_ALWAYS(iter2 != backwardEdges.end(), 
+    for (int i = 0; i < (int) edges.size(); i++)
+        SimTK_APIARGCHECK_ALWAYS(
+            edges[i].faces[0] >= 0 && edges[i].faces[1] >= 0,
             "ContactGeometry::TriangleMesh::Impl", "TriangleMesh::Impl",
             "Each edge must be shared by exactly two faces.");
-        int face2 = iter2->second;
-        edges.push_back(Edge(vert1, vert2, face1, face2));
-    }
-    
-    // Record the edges for each face.
-    
-    for (int i = 0; i < (int) edges.size(); i++) {
-        Edge& edge = edges[i];
-        int f[2] = {edge.faces[0], edge.faces[1]};
-        for (int j = 0; j < 2; j++) {
-            Face& face = faces[f[j]];
-            if ((edge.vertices[0] == face.vertices[0] || edge.vertices[0] == face.vertices[1]) &&
-                    (edge.vertices[1] == face.vertices[0] || edge.vertices[1] == face.vertices[1]))
-                face.edges[0] = i;
-            else if ((edge.vertices[0] == face.vertices[1] || edge.vertices[0] == face.vertices[2]) &&
-                    (edge.vertices[1] == face.vertices[1] || edge.vertices[1] == face.vertices[2]))
-                face.edges[1] = i;
-            else if ((edge.vertices[0] == face.vertices[2] || edge.vertices[0] == face.vertices[0]) &&
-                    (edge.vertices[1] == face.vertices[2] || edge.vertices[1] == face.vertices[0]))
-                face.edges[2] = i;
-            else
-                SimTK_ASSERT_ALWAYS(false, 
-                    "Face and edge vertices are inconsistent.");
-        }
-    }
     
     // Record a single edge for each vertex.
     
@@ -1461,7 +1616,7 @@ void ContactGeometry::TriangleMesh::Impl::init
     Array_<int> allFaces(faces.size());
     for (int i = 0; i < (int) allFaces.size(); i++)
         allFaces[i] = i;
-    createObbTree(obb, allFaces);
+    createObbTree(allFaces);
     
     // Find the bounding sphere.
     Array_<const Vec3*> points(vertices.size());
@@ -1472,93 +1627,550 @@ void ContactGeometry::TriangleMesh::Impl::init
     boundingSphereRadius = bnd.getRadius();
 }
 
+
+//------------------------------------------------------------------------------
+//                          TRIANGLE MESH CACHE FILE
+//------------------------------------------------------------------------------
+// A cache file begins with a TriangleMeshCacheHeader, which is followed by the
+// arrays of vertices, faces, edges, OBB tree nodes, and OBB leaf triangles,
+// each stored exactly as it is laid out in memory and beginning at a multiple
+// of CacheAlignment bytes from the start of the file. That lets a mesh refer 
+// directly to the contents of a memory-mapped file. The element sizes recorded
+// in the header allow a file written by a build with a different precision or
+// structure layout to be rejected rather than misread.
+namespace {
+const char TriangleMeshCacheMagic[8] = {'S','i','m','T','K','M','s','h'};
+const int  TriangleMeshCacheVersion = 1;
+const int  TriangleMeshCacheByteOrder = 0x01020304;
+const int  CacheAlignment = 64;
+
+struct TriangleMeshCacheHeader {
+    char    magic[8];
+    int     version;
+    int     byteOrder;
+    int     realSize, vertexSize, faceSize, edgeSize, nodeSize;
+    int     numVertices, numFaces, numEdges, numNodes, numTriangles;
+    int     maxDepth;
+    int     smooth;
+    Real    boundingSphereCenter[3];
+    Real    boundingSphereRadius;
+};
+
+// Fill in "offsets" with where each of the five arrays starts, followed by
+// the total size of the file.
+void calcCacheOffsets(const TriangleMeshCacheHeader& header, 
+                      long long offsets[6]) {
+    const long long sizes[5] = 
+       {(long long)header.numVertices*header.vertexSize,
+        (long long)header.numFaces*header.faceSize,
+        (long long)header.numEdges*header.edgeSize,
+        (long long)header.numNodes*header.nodeSize,
+        (long long)header.numTriangles*(long long)sizeof(int)};
+    long long offset = sizeof(TriangleMeshCacheHeader);
+    for (int i = 0; i < 5; i++) {
+        offset = (offset+CacheAlignment-1)/CacheAlignment*CacheAlignment;
+        offsets[i] = offset;
+        offset += sizes[i];
+    }
+    offsets[5] = offset;
+}
+
+template <class T>
+void shareCachedArray(Array_<T>& array, const char* data, long long offset,
+                      int size) {
+    array.shareData(reinterpret_cast<T*>(const_cast<char*>(data)+offset), 
+                    size);
+}
+
+template <class T>
+void shareArray(Array_<T>& array, const Array_<T>& source) {
+    array.shareData(const_cast<T*>(source.cbegin()), source.size());
+}
+
+bool inRange(int index, int size) {return 0 <= index && index < size;}
+}
+
+// The contents of a cache file. Where possible this is a private, 
+// copy-on-write mapping of the file so that pages are read only as they are
+// touched; otherwise the file is read into a heap block. Every Impl that 
+// refers to it holds a reference, and the last one to be destroyed frees it.
+class ContactGeometry::TriangleMesh::Impl::CacheData {
+public:
+    explicit CacheData(const String& pathname);
+    ~CacheData();
+
+    const char*     data;
+    long long       size;
+    AtomicInteger   refCount;
+private:
+    CacheData(const CacheData&); // suppress
+    CacheData& operator=(const CacheData&); // suppress
+};
+
+ContactGeometry::TriangleMesh::Impl::CacheData::CacheData
+   (const String& pathname) : data(0), size(0), refCount(1) {
+    const char* method = "ContactGeometry::TriangleMesh::readCacheFile()";
+#ifdef _WIN32
+    std::FILE* file = std::fopen(pathname.c_str(), "rb");
+    SimTK_ERRCHK1_ALWAYS(file, method, 
+        "Couldn't open mesh cache file '%s'.", pathname.c_str());
+    std::fseek(file, 0, SEEK_END);
+    size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    char* buffer = new char[size > 0 ? (size_t)size : 1];
+    const bool ok = std::fread(buffer, 1, (size_t)size, file) == (size_t)size;
+    std::fclose(file);
+    if (ok) 
+        data = buffer;
+    else
+        delete[] buffer;
+    SimTK_ERRCHK1_ALWAYS(ok, method, 
+        "Couldn't read mesh cache file '%s'.", pathname.c_str());
+#else
+    const int fd = open(pathname.c_str(), O_RDONLY);
+    SimTK_ERRCHK1_ALWAYS(fd >= 0, method, 
+        "Couldn't open mesh cache file '%s'.", pathname.c_str());
+    struct stat status;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        size = status.st_size;
+        mapped = mmap(0, (size_t)size, PROT_READ|PROT_WRITE, MAP_PRIVATE, 
+                      fd, 0);
+    }
+    close(fd);
+    SimTK_ERRCHK1_ALWAYS(mapped != MAP_FAILED, method, 
+        "Couldn't map mesh cache file '%s'.", pathname.c_str());
+    data = static_cast<const char*>(mapped);
+#endif
+}
+
+ContactGeometry::TriangleMesh::Impl::Impl(CacheData* cacheData)
+:   ContactGeometryImpl(), boundingSphereRadius(0), smooth(false), 
+    cacheData(cacheData) {}
+
+ContactGeometry::TriangleMesh::Impl::Impl(const Impl& source)
+:   ContactGeometryImpl(source), 
+    boundingSphereCenter(source.boundingSphereCenter),
+    boundingSphereRadius(source.boundingSphereRadius), smooth(source.smooth),
+    cacheData(source.cacheData) {
+    if (!cacheData) {
+        edges = source.edges;
+        faces = source.faces;
+        vertices = source.vertices;
+        obb = source.obb;
+        return;
+    }
+    ++cacheData->refCount;
+    shareArray(edges, source.edges);
+    shareArray(faces, source.faces);
+    shareArray(vertices, source.vertices);
+    shareArray(obb.nodes, source.obb.nodes);
+    shareArray(obb.triangles, source.obb.triangles);
+    obb.maxDepth = source.obb.maxDepth;
+}
+
+ContactGeometry::TriangleMesh::Impl::~Impl() {
+    if (cacheData && --cacheData->refCount == 0)
+        delete cacheData;
+}
+
+ContactGeometry::TriangleMesh::Impl::CacheData::~CacheData() {
+#ifdef _WIN32
+    delete[] data;
+#else
+    munmap(const_cast<char*>(data), (size_t)size);
+#endif
+}
+
+void ContactGeometry::TriangleMesh::Impl::writeCacheFile
+   (const String& pathname) const {
+    const char* method = "ContactGeometry::TriangleMesh::writeCacheFile()";
+    TriangleMeshCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TriangleMeshCacheMagic, sizeof(header.magic));
+    header.version      = TriangleMeshCacheVersion;
+    header.byteOrder    = TriangleMeshCacheByteOrder;
+    header.realSize     = sizeof(Real);
+    header.vertexSize   = sizeof(Vertex);
+    header.faceSize     = sizeof(Face);
+    header.edgeSize     = sizeof(Edge);
+    header.nodeSize     = sizeof(OBBTreeNodeImpl);
+    header.numVertices  = vertices.size();
+    header.numFaces     = faces.size();
+    header.numEdges     = edges.size();
+    header.numNodes     = obb.nodes.size();
+    header.numTriangles = obb.triangles.size();
+    header.maxDepth     = obb.maxDepth;
+    header.smooth       = smooth;
+    for (int i = 0; i < 3; i++)
+        header.boundingSphereCenter[i] = boundingSphereCenter[i];
+    header.boundingSphereRadius = boundingSphereRadius;
+
+    long long offsets[6];
+    calcCacheOffsets(header, offsets);
+    const void* arrays[5] = {vertices.cbegin(), faces.cbegin(), edges.cbegin(),
+                             obb.nodes.cbegin(), obb.triangles.cbegin()};
+    const size_t sizes[5] = {vertices.size()*sizeof(Vertex), 
+                             faces.size()*sizeof(Face), 
+                             edges.size()*sizeof(Edge),
+                             obb.nodes.size()*sizeof(OBBTreeNodeImpl),
+                             obb.triangles.size()*sizeof(int)};
+
+    std::FILE* file = std::fopen(pathname.c_str(), "wb");
+    SimTK_ERRCHK1_ALWAYS(file, method, 
+        "Couldn't create mesh cache file '%s'.", pathname.c_str());
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    long long offset = sizeof(header);
+    const char padding[CacheAlignment] = {0};
+    for (int i = 0; i < 5 && ok; i++) {
+        const size_t padSize = (size_t)(offsets[i]-offset);
+        ok =    std::fwrite(padding, 1, padSize, file) == padSize
+             && std::fwrite(arrays[i], 1, sizes[i], file) == sizes[i];
+        offset = offsets[i] + sizes[i];
+    }
+    ok = (std::fclose(file) == 0) && ok;
+    SimTK_ERRCHK1_ALWAYS(ok, method, 
+        "An error occurred while writing mesh cache file '%s'.", 
+        pathname.c_str());
+}
+
+ContactGeometry::TriangleMesh::Impl* 
+ContactGeometry::TriangleMesh::Impl::readCacheFile(const String& pathname) {
+    const char* method = "ContactGeometry::TriangleMesh::readCacheFile()";
+    Impl* impl = new Impl(new CacheData(pathname));
+    try {
+        const CacheData& cache = *impl->cacheData;
+        TriangleMeshCacheHeader header;
+        SimTK_ERRCHK1_ALWAYS(cache.size >= (long long)sizeof(header) 
+            && std::memcmp(cache.data, TriangleMeshCacheMagic, 
+                           sizeof(header.magic)) == 0, method,
+            "'%s' is not a mesh cache file.", pathname.c_str());
+        std::memcpy(&header, cache.data, sizeof(header));
+        SimTK_ERRCHK3_ALWAYS(header.version == TriangleMeshCacheVersion, 
+            method, "Mesh cache file '%s' has format version %d but version"
+            " %d is required.", pathname.c_str(), header.version, 
+            TriangleMeshCacheVersion);
+        SimTK_ERRCHK1_ALWAYS(   header.byteOrder  == TriangleMeshCacheByteOrder
+                             && header.realSize   == (int)sizeof(Real)
+                             && header.vertexSize == (int)sizeof(Vertex)
+                             && header.faceSize   == (int)sizeof(Face)
+                             && header.edgeSize   == (int)sizeof(Edge)
+                             && header.nodeSize   == (int)sizeof(OBBTreeNodeImpl),
+            method, "Mesh cache file '%s' was written by a build with a"
+            " different data layout.", pathname.c_str());
+        long long offsets[6];
+        calcCacheOffsets(header, offsets);
+        SimTK_ERRCHK1_ALWAYS(   header.numVertices >= 0 && header.numFaces >= 0
+                             && header.numEdges >= 0 && header.numNodes > 0
+                             && header.numTriangles >= 0
+                             && offsets[5] <= cache.size, method,
+            "Mesh cache file '%s' is truncated or damaged.", pathname.c_str());
+
+        shareCachedArray(impl->vertices, cache.data, offsets[0], 
+                         header.numVertices);
+        shareCachedArray(impl->faces, cache.data, offsets[1], header.numFaces);
+        shareCachedArray(impl->edges, cache.data, offsets[2], header.numEdges);
+        shareCachedArray(impl->obb.nodes, cache.data, offsets[3], 
+                         header.numNodes);
+        shareCachedArray(impl->obb.triangles, cache.data, offsets[4], 
+                         header.numTriangles);
+        SimTK_ERRCHK1_ALWAYS(impl->hasValidCachedIndices(header.maxDepth), 
+            method, "Mesh cache file '%s' contains an invalid index.", 
+            pathname.c_str());
+        impl->obb.maxDepth = header.maxDepth;
+        impl->smooth = (header.smooth != 0);
+        impl->boundingSphereCenter = Vec3(header.boundingSphereCenter[0], 
+                                          header.boundingSphereCenter[1], 
+                                          header.boundingSphereCenter[2]);
+        impl->boundingSphereRadius = header.boundingSphereRadius;
+    } catch (...) {
+        delete impl;
+        throw;
+    }
+    return impl;
+}
+
+// Check that every index stored in the arrays read from a cache file refers
+// to an element that exists, so that a damaged file can't make later queries
+// read outside the arrays. The OBB tree nodes must be in depth-first order 
+// (a node's first child follows it and its second child comes later), and the
+// tree must be no deeper than maxDepth since that sizes the query stacks.
+bool ContactGeometry::TriangleMesh::Impl::hasValidCachedIndices
+   (int maxDepth) const {
+    const int nV = vertices.size(), nF = faces.size(), nE = edges.size();
+    for (int i = 0; i < nF; i++)
+        for (int j = 0; j < 3; j++)
+            if (   !inRange(faces[i].vertices[j], nV) 
+                || !inRange(faces[i].edges[j], nE))
+                return false;
+    for (int i = 0; i < nE; i++)
+        for (int j = 0; j < 2; j++)
+            if (   !inRange(edges[i].vertices[j], nV) 
+                || !inRange(edges[i].faces[j], nF))
+                return false;
+    for (int i = 0; i < nV; i++)
+        if (!inRange(vertices[i].firstEdge, nE))
+            return false;
+
+    const int nNodes = obb.nodes.size(), nTriangles = obb.triangles.size();
+    for (int i = 0; i < nTriangles; i++)
+        if (!inRange(obb.triangles[i], nF))
+            return false;
+    if (maxDepth < 1)
+        return false;
+    Array_<int> depth(nNodes, 0); // 0 for a node that isn't reachable
+    depth[0] = 1;
+    for (int i = 0; i < nNodes; i++) {
+        const OBBTreeNodeImpl& node = obb.nodes[i];
+        if (node.firstTriangle < 0 || node.numTriangles < 0)
+            return false;
+        if (node.isLeaf()) {
+            if (   node.secondChild != -1 
+                || node.numTriangles > nTriangles - node.firstTriangle)
+                return false;
+            continue;
+        }
+        if (node.secondChild <= i+1 || node.secondChild >= nNodes)
+            return false;
+        if (depth[i] == 0)
+            continue;
+        if (depth[i] == maxDepth)
+            return false;
+        depth[i+1] = std::max(depth[i+1], depth[i]+1);
+        depth[node.secondChild] = std::max(depth[node.secondChild], depth[i]+1);
+    }
+    return true;
+}
+
+// Meshes with at least this many faces have the top levels of their OBB tree
+// built first, after which the remaining subtrees are built concurrently.
+static const int ParallelObbTreeFaces = 4096;
+
+// Build one of the independent subtrees of a large mesh's OBB tree.
+class ContactGeometry::TriangleMesh::Impl::ObbSubtreeTask 
+:   public ParallelExecutor::Task {
+public:
+    ObbSubtreeTask(const Impl& mesh, const Array_<Array_<int> >& faces,
+                   const Array_<int>& depths, Array_<OBBTreeImpl>& subtrees)
+    :   mesh(mesh), faces(faces), depths(depths), subtrees(subtrees) {}
+    void execute(int index) {
+        mesh.createObbSubtree(faces[index], depths[index], subtrees[index]);
+    }
+private:
+    const Impl&                 mesh;
+    const Array_<Array_<int> >& faces;
+    const Array_<int>&          depths;
+    Array_<OBBTreeImpl>&        subtrees;
+};
+
 void ContactGeometry::TriangleMesh::Impl::createObbTree
-   (OBBTreeNodeImpl& node, const Array_<int>& faceIndices) 
-{   // Find all vertices in the node and build the OrientedBoundingBox.
-    node.numTriangles = faceIndices.size();
-    set<int> vertexIndices;
+   (const Array_<int>& faceIndices) 
+{   obb = OBBTreeImpl();
+    const int nProc = ParallelExecutor::getNumProcessors();
+    if (   (int)faceIndices.size() < ParallelObbTreeFaces
+        || ParallelExecutor::isWorkerThread()) {
+        createObbSubtree(faceIndices, 1, obb);
+        return;
+    }
+
+    // Build the top of the tree here, stopping at nodes that are small 
+    // enough to give a few subtrees per processor. Each of those is left as a
+    // placeholder in "top" which is replaced by the corresponding subtree 
+    // once that has been built.
+    Array_<OBBTreeImpl> subtrees;
+    Array_<OBBTreeNodeImpl> top;
+    Array_<int> topSubtree; // subtree index for a placeholder, else -1
+    Array_<Array_<int> > subtreeFaces;
+    Array_<int> subtreeDepths;
+    createObbTreeTop(faceIndices, 1, (int)faceIndices.size()/(4*nProc),
+                     top, topSubtree, subtreeFaces, subtreeDepths);
+
+    subtrees.resize(subtreeFaces.size());
+    ObbSubtreeTask task(*this, subtreeFaces, subtreeDepths, subtrees);
+    ParallelExecutor executor(nProc);
+    executor.execute(task, (int)subtrees.size());
+
+    // Now lay out the final tree in depth-first order. Node indices within
+    // each subtree, and the second child indices of the top nodes, have to be
+    // adjusted for where they end up.
+    Array_<int> topIndex(top.size());
+    int numNodes = 0;
+    for (int i = 0; i < (int) top.size(); i++) {
+        topIndex[i] = numNodes;
+        numNodes += topSubtree[i] < 0 ? 1 : subtrees[topSubtree[i]].nodes.size();
+    }
+    obb.nodes.reserve(numNodes);
+    obb.triangles.reserve(faceIndices.size());
+    for (int i = 0; i < (int) top.size(); i++) {
+        if (topSubtree[i] < 0) {
+            obb.nodes.push_back(top[i]);
+            obb.nodes.back().secondChild = topIndex[top[i].secondChild];
+            obb.nodes.back().firstTriangle = obb.triangles.size();
+            continue;
+        }
+        const OBBTreeImpl& subtree = subtrees[topSubtree[i]];
+        const int nodeOffset = obb.nodes.size();
+        const int triangleOffset = obb.triangles.size();
+        for (int j = 0; j < (int) subtree.nodes.size(); j++) {
+            obb.nodes.push_back(subtree.nodes[j]);
+            OBBTreeNodeImpl& node = obb.nodes.back();
+            if (!node.isLeaf())
+                node.secondChild += nodeOffset;
+            node.firstTriangle += triangleOffset;
+        }
+        obb.triangles.insert(obb.triangles.end(), subtree.triangles.begin(), 
+                             subtree.triangles.end());
+        obb.maxDepth = std::max(obb.maxDepth, subtree.maxDepth);
+    }
+}
+
+// Append the nodes for the top levels of a large mesh's OBB tree to "top" in
+// depth-first order. A node with no more than subtreeSize faces, or that can't
+// be split, gets a placeholder that records which of the subtrees will 
+// replace it; those subtrees are built later, by createObbSubtree(). The
+// second child index of a node refers to a position in "top".
+void ContactGeometry::TriangleMesh::Impl::createObbTreeTop
+   (const Array_<int>& faceIndices, int depth, int subtreeSize, 
+    Array_<OBBTreeNodeImpl>& top, Array_<int>& topSubtree,
+    Array_<Array_<int> >& subtreeFaces, Array_<int>& subtreeDepths) const
+{
+    if ((int)faceIndices.size() > subtreeSize) {
+        const OrientedBoundingBox bounds = createObbBounds(faceIndices);
+        Array_<int> child1Indices, child2Indices;
+        if (splitObbNode(faceIndices, bounds, child1Indices, child2Indices)) {
+            const int index = top.size();
+            top.push_back(OBBTreeNodeImpl());
+            topSubtree.push_back(-1);
+            top[index].bounds = bounds;
+            top[index].numTriangles = faceIndices.size();
+            createObbTreeTop(child1Indices, depth+1, subtreeSize, top, 
+                             topSubtree, subtreeFaces, subtreeDepths);
+            top[index].secondChild = top.size();
+            createObbTreeTop(child2Indices, depth+1, subtreeSize, top, 
+                             topSubtree, subtreeFaces, subtreeDepths);
+            return;
+        }
+    }
+    top.push_back(OBBTreeNodeImpl());
+    topSubtree.push_back(subtreeFaces.size());
+    subtreeFaces.push_back(faceIndices);
+    subtreeDepths.push_back(depth);
+}
+
+// Append the subtree containing the given faces to the tree in depth-first 
+// order. The subtree's root is at the given depth in the full tree.
+void ContactGeometry::TriangleMesh::Impl::createObbSubtree
+   (const Array_<int>& faceIndices, int depth, OBBTreeImpl& tree) const
+{   // Don't hold a reference to the node; the recursive calls below can
+    // reallocate the node array.
+    const int index = tree.nodes.size();
+    tree.nodes.push_back(OBBTreeNodeImpl());
+    tree.nodes[index].bounds = createObbBounds(faceIndices);
+    tree.nodes[index].firstTriangle = tree.triangles.size();
+    tree.nodes[index].numTriangles = faceIndices.size();
+    tree.maxDepth = std::max(tree.maxDepth, depth);
+
+    Array_<int> child1Indices, child2Indices;
+    if (splitObbNode(faceIndices, tree.nodes[index].bounds, 
+                     child1Indices, child2Indices)) {
+        createObbSubtree(child1Indices, depth+1, tree);
+        tree.nodes[index].secondChild = tree.nodes.size();
+        createObbSubtree(child2Indices, depth+1, tree);
+        return;
+    }
+
+    // This is a leaf node.
+    
+    tree.triangles.insert(tree.triangles.end(), faceIndices.begin(), 
+                          faceIndices.end());
+}
+
+// Find all vertices of the given faces and build the OrientedBoundingBox.
+OrientedBoundingBox ContactGeometry::TriangleMesh::Impl::createObbBounds
+   (const Array_<int>& faceIndices) const
+{
+    Array_<int> vertexIndices;
+    vertexIndices.reserve(3*faceIndices.size());
     for (int i = 0; i < (int) faceIndices.size(); i++) 
         for (int j = 0; j < 3; j++)
-            vertexIndices.insert(faces[faceIndices[i]].vertices[j]);
+            vertexIndices.push_back(faces[faceIndices[i]].vertices[j]);
+    std::sort(vertexIndices.begin(), vertexIndices.end());
+    vertexIndices.erase(std::unique(vertexIndices.begin(), vertexIndices.end()),
+                        vertexIndices.end());
     Vector_<Vec3> points((int)vertexIndices.size());
-    int index = 0;
-    for (set<int>::iterator iter = vertexIndices.begin(); 
-                            iter != vertexIndices.end(); ++iter)
-        points[index++] = vertices[*iter].pos;
-    node.bounds = OrientedBoundingBox(points);
-    if (faceIndices.size() > 3) {
-
-        // Order the axes by size.
-
-        int axisOrder[3];
-        const Vec3& size = node.bounds.getSize();
-        if (size[0] > size[1]) {
-            if (size[0] > size[2]) {
-                axisOrder[0] = 0;
-                if (size[1] > size[2]) {
-                    axisOrder[1] = 1;
-                    axisOrder[2] = 2;
-                }
-                else {
-                    axisOrder[1] = 2;
-                    axisOrder[2] = 1;
-                }
+    for (int i = 0; i < (int) vertexIndices.size(); i++)
+        points[i] = vertices[vertexIndices[i]].pos;
+    return OrientedBoundingBox(points);
+}
+
+// Try to divide the faces in a node between two children. Returns false if 
+// the node should be a leaf.
+bool ContactGeometry::TriangleMesh::Impl::splitObbNode
+   (const Array_<int>& faceIndices, const OrientedBoundingBox& bounds,
+    Array_<int>& child1Indices, Array_<int>& child2Indices) const
+{
+    if (faceIndices.size() <= 3)
+        return false;
+
+    // Order the axes by size.
+
+    int axisOrder[3];
+    const Vec3& size = bounds.getSize();
+    if (size[0] > size[1]) {
+        if (size[0] > size[2]) {
+            axisOrder[0] = 0;
+            if (size[1] > size[2]) {
+                axisOrder[1] = 1;
+                axisOrder[2] = 2;
             }
             else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 0;
+                axisOrder[1] = 2;
                 axisOrder[2] = 1;
             }
         }
-        else if (size[0] > size[2]) {
-            axisOrder[0] = 1;
+        else {
+            axisOrder[0] = 2;
             axisOrder[1] = 0;
-            axisOrder[2] = 2;
+            axisOrder[2] = 1;
+        }
+    }
+    else if (size[0] > size[2]) {
+        axisOrder[0] = 1;
+        axisOrder[1] = 0;
+        axisOrder[2] = 2;
+    }
+    else {
+        if (size[1] > size[2]) {
+            axisOrder[0] = 1;
+            axisOrder[1] = 2;
         }
         else {
-            if (size[1] > size[2]) {
-                axisOrder[0] = 1;
-                axisOrder[1] = 2;
-            }
-            else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 1;
-            }
-            axisOrder[2] = 0;
+            axisOrder[0] = 2;
+            axisOrder[1] = 1;
         }
+        axisOrder[2] = 0;
+    }
 
-        // Try splitting along each axis.
+    // Try splitting along each axis.
 
-        for (int i = 0; i < 3; i++) {
-            Array_<int> child1Indices, child2Indices;
-            splitObbAxis(faceIndices, child1Indices, child2Indices, 
-                         axisOrder[i]);
-            if (child1Indices.size() > 0 && child2Indices.size() > 0) {
-                // It was successfully split, so create the child nodes.
-
-                node.child1 = new OBBTreeNodeImpl();
-                node.child2 = new OBBTreeNodeImpl();
-                createObbTree(*node.child1, child1Indices);
-                createObbTree(*node.child2, child2Indices);
-                return;
-            }
-        }
+    for (int i = 0; i < 3; i++) {
+        child1Indices.clear();
+        child2Indices.clear();
+        splitObbAxis(faceIndices, child1Indices, child2Indices, axisOrder[i]);
+        if (child1Indices.size() > 0 && child2Indices.size() > 0)
+            return true;
     }
-    
-    // This is a leaf node.
-    
-    node.triangles.insert(node.triangles.begin(), faceIndices.begin(), 
-                          faceIndices.end());
+    return false;
 }
 
 void ContactGeometry::TriangleMesh::Impl::splitObbAxis
    (const Array_<int>& parentIndices, Array_<int>& child1Indices, 
-    Array_<int>& child2Indices, int axis) 
+    Array_<int>& child2Indices, int axis) const
 {   // For each face, find its minimum and maximum extent along the axis.
     Vector minExtent(parentIndices.size());
     Vector maxExtent(parentIndices.size());
     for (int i = 0; i < (int) parentIndices.size(); i++) {
-        int* vertexIndices = faces[parentIndices[i]].vertices;
+        const int* vertexIndices = faces[parentIndices[i]].vertices;
         Real minVal = vertices[vertexIndices[0]].pos[axis];
         Real maxVal = vertices[vertexIndices[0]].pos[axis];
         minVal = std::min(minVal, vertices[vertexIndices[1]].pos[axis]);
@@ -1695,220 +2307,215 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
 
 
 //==============================================================================
-//                            OBB TREE NODE IMPL
+//                              OBB TREE IMPL
 //==============================================================================
 
-OBBTreeNodeImpl::OBBTreeNodeImpl(const OBBTreeNodeImpl& copy) 
-:   bounds(copy.bounds), triangles(copy.triangles), 
-    numTriangles(copy.numTriangles) {
-    if (copy.child1 == NULL) {
-        child1 = NULL;
-        child2 = NULL;
+namespace {
+// A node that a query of an OBBTreeImpl still has to visit, along with the 
+// (possibly squared) distance from the query to the node's bounding box.
+struct PendingObbNode {
+    int  node;
+    Real distance;
+};
+
+// The stack of pending nodes for a depth-first query of an OBBTreeImpl. A 
+// query pushes both children of each node it expands, so it can't have more
+// nodes pending than the tree has levels; nearly every tree fits in the local
+// buffer, and a deeper one gets heap storage once per query.
+class PendingObbNodeStack {
+public:
+    explicit PendingObbNodeStack(int maxDepth) : data(local), size(0) {
+        if (maxDepth > LocalSize) {
+            heap.resize(maxDepth);
+            data = heap.begin();
+        }
     }
-    else {
-        child1 = new OBBTreeNodeImpl(*copy.child1);
-        child2 = new OBBTreeNodeImpl(*copy.child2);
+    bool empty() const {return size == 0;}
+    void push(int node, Real distance) {
+        data[size].node = node;
+        data[size].distance = distance;
+        ++size;
     }
+    PendingObbNode pop() {return data[--size];}
+private:
+    enum {LocalSize = 64};
+    PendingObbNode          local[LocalSize];
+    Array_<PendingObbNode>  heap;
+    PendingObbNode*         data;
+    int                     size;
+};
 }
 
-OBBTreeNodeImpl::~OBBTreeNodeImpl() {
-    if (child1 != NULL)
-        delete child1;
-    if (child2 != NULL)
-        delete child2;
-}
-
-Vec3 OBBTreeNodeImpl::findNearestPoint
+Vec3 OBBTreeImpl::findNearestPoint
    (const ContactGeometry::TriangleMesh::Impl& mesh, 
     const Vec3& position, Real cutoff2, 
     Real& distance2, int& face, Vec2& uv) const 
 {
-    Real tol = 100*Eps;
-    if (child1 != NULL) {
-        // Recursively check the child nodes.
-        
-        Real child1distance2 = MostPositiveReal, 
-             child2distance2 = MostPositiveReal;
-        int child1face, child2face;
-        Vec2 child1uv, child2uv;
-        Vec3 child1point, child2point;
-        Real child1BoundsDist2 = 
-            (child1->bounds.findNearestPoint(position)-position).normSqr();
-        Real child2BoundsDist2 = 
-            (child2->bounds.findNearestPoint(position)-position).normSqr();
-        if (child1BoundsDist2 < child2BoundsDist2) {
-            if (child1BoundsDist2 < cutoff2) {
-                child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
-                if (child2BoundsDist2 < child1distance2 && child2BoundsDist2 < cutoff2)
-                    child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
+    const Real tol = 100*Eps;
+    distance2 = MostPositiveReal;
+    Vec3 nearestPoint;
+    PendingObbNodeStack stack(maxDepth);
+    stack.push(0, 0);
+    while (!stack.empty()) {
+        const PendingObbNode pending = stack.pop();
+        // Skip any box that can't hold a point as close as the best so far.
+        // Points that are nearly as close are still considered since they
+        // may win the angle test below.
+        if (pending.distance > distance2*(1+tol))
+            continue;
+        const OBBTreeNodeImpl& node = nodes[pending.node];
+        if (!node.isLeaf()) {
+            // Push the nearer child last so that it is searched first.
+            const int child1 = pending.node+1, child2 = node.secondChild;
+            const Real child1BoundsDist2 = 
+              (nodes[child1].bounds.findNearestPoint(position)-position).normSqr();
+            const Real child2BoundsDist2 = 
+              (nodes[child2].bounds.findNearestPoint(position)-position).normSqr();
+            if (child1BoundsDist2 < child2BoundsDist2) {
+                if (child2BoundsDist2 < cutoff2)
+                    stack.push(child2, child2BoundsDist2);
+                if (child1BoundsDist2 < cutoff2)
+                    stack.push(child1, child1BoundsDist2);
             }
-        }
-        else {
-            if (child2BoundsDist2 < cutoff2) {
-                child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
-                if (child1BoundsDist2 < child2distance2 && child1BoundsDist2 < cutoff2)
-                    child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
+            else {
+                if (child1BoundsDist2 < cutoff2)
+                    stack.push(child1, child1BoundsDist2);
+                if (child2BoundsDist2 < cutoff2)
+                    stack.push(child2, child2BoundsDist2);
             }
+            continue;
         }
-        if (   child1distance2 <= child2distance2*(1+tol) 
-            && child2distance2 <= child1distance2*(1+tol)) {
-            // Decide based on angle which one to use.
-            
-            if (  std::abs(~(child1point-position)*mesh.faces[child1face].normal) 
-                > std::abs(~(child2point-position)*mesh.faces[child2face].normal))
-                child2distance2 = MostPositiveReal;
+
+        // This is a leaf node, so check each triangle for its distance to the
+        // point. If two are equally close, decide based on angle which one to
+        // use.
+        for (int i = 0; i < node.numTriangles; i++) {
+            const int triangle = triangles[node.firstTriangle+i];
+            Vec2 triangleUV;
+            Vec3 p = mesh.findNearestPointToFace(position, triangle, triangleUV);
+            Vec3 offset = p-position;
+            // TODO: volatile to work around compiler bug
+            volatile Real d2 = offset.normSqr(); 
+            bool better;
+            if (d2 <= distance2*(1+tol) && distance2 <= d2*(1+tol))
+                better = 
+                     std::abs(~offset*mesh.faces[triangle].normal)
+                   > std::abs(~(nearestPoint-position)*mesh.faces[face].normal);
             else
-                child1distance2 = MostPositiveReal;
-        }
-        if (child1distance2 < child2distance2) {
-            distance2 = child1distance2;
-            face = child1face;
-            uv = child1uv;
-            return child1point;
-        }
-        else {
-            distance2 = child2distance2;
-            face = child2face;
-            uv = child2uv;
-            return child2point;
-        }
-    }    
-    // This is a leaf node, so check each triangle for its distance to the point.
-    
-    distance2 = MostPositiveReal;
-    Vec3 nearestPoint;
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        Vec2 triangleUV;
-        Vec3 p = mesh.findNearestPointToFace(position, triangles[i], triangleUV);
-        Vec3 offset = p-position;
-        // TODO: volatile to work around compiler bug
-        volatile Real d2 = offset.normSqr(); 
-        if (d2 < distance2 || (d2 < distance2*(1+tol) && std::abs(~offset*mesh.faces[triangles[i]].normal) > std::abs(~offset*mesh.faces[face].normal))) {
-            nearestPoint = p;
-            distance2 = d2;
-            face = triangles[i];
-            uv = triangleUV;
+                better = (d2 < distance2);
+            if (better) {
+                nearestPoint = p;
+                distance2 = d2;
+                face = triangle;
+                uv = triangleUV;
+            }
         }
     }
     return nearestPoint;
 }
 
-bool OBBTreeNodeImpl::
+bool OBBTreeImpl::
 intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
               const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
-    if (child1 != NULL) {
-        // Recursively check the child nodes.
-        
-        Real child1distance, child2distance;
-        int child1face, child2face;
-        Vec2 child1uv, child2uv;
-        bool child1intersects = child1->bounds.intersectsRay(origin, direction, child1distance);
-        bool child2intersects = child2->bounds.intersectsRay(origin, direction, child2distance);
-        if (child1intersects) {
-            if (child2intersects) {
-                // The ray intersects both child nodes.  First check the closer one.
-                
-                if (child1distance < child2distance) {
-                    child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
-                    if (!child1intersects || child2distance < child1distance)
-                        child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
-                }
-                else {
-                    child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
-                    if (!child2intersects || child1distance < child2distance)
-                        child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
-                }
-            }
-            else
-                child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
-        }
-        else if (child2intersects)
-            child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
-        
-        // If either one had an intersection, return the closer one.
-        
-        if (child1intersects && (!child2intersects || child1distance < child2distance)) {
-            distance = child1distance;
-            face = child1face;
-            uv = child1uv;
-            return true;
-        }
-        if (child2intersects) {
-            distance = child2distance;
-            face = child2face;
-            uv = child2uv;
-            return true;
-        }
-        return false;
-    }
-    
-    // This is a leaf node, so check each triangle for an intersection with the 
-    // ray.
-    
     bool foundIntersection = false;
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        const UnitVec3& faceNormal = mesh.faces[triangles[i]].normal;
-        double vd = ~faceNormal*direction;
-        if (vd == 0.0)
-            continue; // The ray is parallel to the plane.
-        const Vec3& vert1 = mesh.vertices[mesh.faces[triangles[i]].vertices[0]].pos;
-        double v0 = ~faceNormal*(vert1-origin);
-        double t = v0/vd;
-        if (t < 0.0)
-            continue; // Ray points away from plane of triangle.
-        if (foundIntersection && t >= distance)
+    PendingObbNodeStack stack(maxDepth);
+    stack.push(0, 0);
+    while (!stack.empty()) {
+        const PendingObbNode pending = stack.pop();
+        if (foundIntersection && pending.distance >= distance)
             continue; // We already have a closer intersection.
-
-        // Determine whether the intersection point is inside the triangle by projecting onto
-        // a plane and computing the barycentric coordinates.
-
-        Vec3 ri = origin+direction*t;
-        const Vec3& vert2 = mesh.vertices[mesh.faces[triangles[i]].vertices[1]].pos;
-        const Vec3& vert3 = mesh.vertices[mesh.faces[triangles[i]].vertices[2]].pos;
-        int axis1, axis2;
-        if (std::abs(faceNormal[1]) > std::abs(faceNormal[0])) {
-            if (std::abs(faceNormal[2]) > std::abs(faceNormal[1])) {
-                axis1 = 0;
-                axis2 = 1;
+        const OBBTreeNodeImpl& node = nodes[pending.node];
+        if (!node.isLeaf()) {
+            // Push the closer child last so that it is checked first.
+            const int child1 = pending.node+1, child2 = node.secondChild;
+            Real child1distance, child2distance;
+            const bool child1intersects = 
+                nodes[child1].bounds.intersectsRay(origin, direction, child1distance);
+            const bool child2intersects = 
+                nodes[child2].bounds.intersectsRay(origin, direction, child2distance);
+            if (child1intersects && child2intersects 
+                && child2distance < child1distance) {
+                stack.push(child1, child1distance);
+                stack.push(child2, child2distance);
             }
             else {
-                axis1 = 0;
-                axis2 = 2;
+                if (child2intersects)
+                    stack.push(child2, child2distance);
+                if (child1intersects)
+                    stack.push(child1, child1distance);
             }
+            continue;
         }
-        else {
-            if (std::abs(faceNormal[2]) > std::abs(faceNormal[0])) {
-                axis1 = 0;
-                axis2 = 1;
+    
+        // This is a leaf node, so check each triangle for an intersection with
+        // the ray.
+
+        for (int i = 0; i < node.numTriangles; i++) {
+            const int triangle = triangles[node.firstTriangle+i];
+            const UnitVec3& faceNormal = mesh.faces[triangle].normal;
+            double vd = ~faceNormal*direction;
+            if (vd == 0.0)
+                continue; // The ray is parallel to the plane.
+            const Vec3& vert1 = mesh.vertices[mesh.faces[triangle].vertices[0]].pos;
+            double v0 = ~faceNormal*(vert1-origin);
+            double t = v0/vd;
+            if (t < 0.0)
+                continue; // Ray points away from plane of triangle.
+            if (foundIntersection && t >= distance)
+                continue; // We already have a closer intersection.
+
+            // Determine whether the intersection point is inside the triangle
+            // by projecting onto a plane and computing the barycentric 
+            // coordinates.
+
+            Vec3 ri = origin+direction*t;
+            const Vec3& vert2 = mesh.vertices[mesh.faces[triangle].vertices[1]].pos;
+            const Vec3& vert3 = mesh.vertices[mesh.faces[triangle].vertices[2]].pos;
+            int axis1, axis2;
+            if (std::abs(faceNormal[1]) > std::abs(faceNormal[0])) {
+                if (std::abs(faceNormal[2]) > std::abs(faceNormal[1])) {
+                    axis1 = 0;
+                    axis2 = 1;
+                }
+                else {
+                    axis1 = 0;
+                    axis2 = 2;
+                }
             }
             else {
-                axis1 = 1;
-                axis2 = 2;
+                if (std::abs(faceNormal[2]) > std::abs(faceNormal[0])) {
+                    axis1 = 0;
+                    axis2 = 1;
+                }
+                else {
+                    axis1 = 1;
+                    axis2 = 2;
+                }
             }
-        }
-        Vec2 pos(ri[axis1]-vert1[axis1], ri[axis2]-vert1[axis2]);
-        Vec2 edge1(vert1[axis1]-vert2[axis1], vert1[axis2]-vert2[axis2]);
-        Vec2 edge2(vert1[axis1]-vert3[axis1], vert1[axis2]-vert3[axis2]);
-        double denom = 1.0/(edge1%edge2);
-        edge2 *= denom;
-        double v = edge2%pos;
-        if (v < 0.0 || v > 1.0)
-            continue;
-        edge1 *= denom;
-        double w = pos%edge1;
-        if (w < 0.0 || w > 1.0)
-            continue;
-        double u = 1.0-v-w;
-        if (u < 0.0 || u > 1.0)
-            continue;
-        
-        // It intersects.
+            Vec2 pos(ri[axis1]-vert1[axis1], ri[axis2]-vert1[axis2]);
+            Vec2 edge1(vert1[axis1]-vert2[axis1], vert1[axis2]-vert2[axis2]);
+            Vec2 edge2(vert1[axis1]-vert3[axis1], vert1[axis2]-vert3[axis2]);
+            double denom = 1.0/(edge1%edge2);
+            edge2 *= denom;
+            double v = edge2%pos;
+            if (v < 0.0 || v > 1.0)
+                continue;
+            edge1 *= denom;
+            double w = pos%edge1;
+            if (w < 0.0 || w > 1.0)
+                continue;
+            double u = 1.0-v-w;
+            if (u < 0.0 || u > 1.0)
+                continue;
         
-        distance = t;
-        face = triangles[i];
-        uv = Vec2(u, v);
-        foundIntersection = true;
+            // It intersects.
+            
+            distance = t;
+            face = triangle;
+            uv = Vec2(u, v);
+            foundIntersection = true;
+        }
     }
     return foundIntersection;
 }
@@ -1921,38 +2528,40 @@ intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
 //==============================================================================
 
 ContactGeometry::TriangleMesh::OBBTreeNode::
-OBBTreeNode(const OBBTreeNodeImpl& impl) : impl(&impl) {}
+OBBTreeNode(const OBBTreeImpl& tree, int index) : tree(&tree), index(index) {}
 
 const OrientedBoundingBox& 
 ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
-    return impl->bounds;
+    return tree->nodes[index].bounds;
 }
 
 bool ContactGeometry::TriangleMesh::OBBTreeNode::isLeafNode() const {
-    return (impl->child1 == NULL);
+    return tree->nodes[index].isLeaf();
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getFirstChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child1, 
+    SimTK_ASSERT_ALWAYS(!isLeafNode(), 
         "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child1);
+    return OBBTreeNode(*tree, index+1);
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getSecondChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child2, 
-        "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child2);
+    SimTK_ASSERT_ALWAYS(!isLeafNode(), 
+        "Called getSecondChildNode() on a leaf node");
+    return OBBTreeNode(*tree, tree->nodes[index].secondChild);
 }
 
-const Array_<int>& ContactGeometry::TriangleMesh::OBBTreeNode::
+ArrayViewConst_<int> ContactGeometry::TriangleMesh::OBBTreeNode::
 getTriangles() const {
-    SimTK_ASSERT_ALWAYS(impl->child2 == NULL, 
+    SimTK_ASSERT_ALWAYS(isLeafNode(), 
         "Called getTriangles() on a non-leaf node");
-    return impl->triangles;
+    const OBBTreeNodeImpl& node = tree->nodes[index];
+    const int* first = tree->triangles.begin() + node.firstTriangle;
+    return ArrayViewConst_<int>(first, first + node.numTriangles);
 }
 
 int ContactGeometry::TriangleMesh::OBBTreeNode::getNumTriangles() const {
-    return impl->numTriangles;
+    return tree->nodes[index].numTriangles;
 }
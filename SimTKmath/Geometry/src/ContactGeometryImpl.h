@@ -56,6 +56,15 @@ public:
 
     virtual Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                                   UnitVec3& normal) const = 0;
+    // Batched form of findNearestPoint() for n points. The default just calls
+    // findNearestPoint() for each one; concrete classes should override this
+    // with a loop that avoids the virtual call per point.
+    virtual void findNearestPoints(int n, const Vec3 positions[], 
+                                   Vec3 nearestPoints[], bool inside[],
+                                   UnitVec3 normals[]) const
+    {   for (int i=0; i < n; ++i)
+            nearestPoints[i] = findNearestPoint(positions[i], inside[i], 
+                                                normals[i]); }
     virtual bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                                Real& distance, UnitVec3& normal) const = 0;
 
@@ -134,6 +143,8 @@ public:
 
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const;
+    void findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[],
+                           bool inside[], UnitVec3 normals[]) const;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const;
     void getBoundingSphere(Vec3& center, Real& radius) const;
@@ -205,6 +216,8 @@ public:
 
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const;
+    void findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[],
+                           bool inside[], UnitVec3 normals[]) const;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const;
     void getBoundingSphere(Vec3& center, Real& radius) const;
@@ -287,6 +300,8 @@ public:
 
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const;
+    void findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[],
+                           bool inside[], UnitVec3 normals[]) const;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const;
     void getBoundingSphere(Vec3& center, Real& radius) const;
@@ -314,6 +329,10 @@ public:
 private:
     void createOBBTree();
 
+    // Nearest point to a position that is on or very close to the symmetry
+    // plane normal to axis k, the shortest axis; see findNearestPoint().
+    Vec3 findNearestPointNearPlane(const Vec3& position, int k) const;
+
 
     Vec3 radii;
     // The curvatures are calculated whenever the radii are set.
@@ -482,23 +501,48 @@ private:
 //==============================================================================
 //                            OBB TREE NODE IMPL
 //==============================================================================
+// One node of a TriangleMesh's OBB tree. Nodes are stored in an OBBTreeImpl in
+// depth-first order, so the first child of a non-leaf node is always the next
+// node in the array and only the index of the second child needs to be kept.
+// That same ordering means the triangles contained in a node, including those
+// of all its descendants, are a contiguous range of the tree's packed
+// triangle array.
 class OBBTreeNodeImpl {
 public:
-    OBBTreeNodeImpl() : child1(NULL), child2(NULL) {
-    }
-    OBBTreeNodeImpl(const OBBTreeNodeImpl& copy);
-    ~OBBTreeNodeImpl();
+    OBBTreeNodeImpl() : secondChild(-1), firstTriangle(0), numTriangles(0) {}
+    bool isLeaf() const {return secondChild < 0;}
+
     OrientedBoundingBox bounds;
-    OBBTreeNodeImpl* child1;
-    OBBTreeNodeImpl* child2;
-    Array_<int> triangles;
+    int secondChild;    // node index, or -1 if this is a leaf
+    int firstTriangle;  // index into OBBTreeImpl::triangles
     int numTriangles;
+};
+
+
+
+//==============================================================================
+//                              OBB TREE IMPL
+//==============================================================================
+// The complete OBB tree for a TriangleMesh: all the nodes in one contiguous 
+// array with the root first, and the triangle indices of all the leaf nodes
+// packed into a second array. The queries here walk the tree with an explicit
+// stack rather than by recursion.
+class OBBTreeImpl {
+public:
+    OBBTreeImpl() : maxDepth(0) {}
+
+    const OBBTreeNodeImpl& getRoot() const {return nodes[0];}
+
     Vec3 findNearestPoint(const ContactGeometry::TriangleMesh::Impl& mesh, 
                           const Vec3& position, Real cutoff2, Real& distance2, 
                           int& face, Vec2& uv) const;
     bool intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh, 
                        const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, int& face, Vec2& uv) const;
+
+    Array_<OBBTreeNodeImpl> nodes;
+    Array_<int>             triangles;
+    int                     maxDepth; // number of nodes on the longest path
 };
 
 
@@ -511,14 +555,22 @@ public:
     class Edge;
     class Face;
     class Vertex;
+    class CacheData;
 
     Impl(const ArrayViewConst_<Vec3>& vertexPositions, 
          const ArrayViewConst_<int>& faceIndices, bool smooth);
     Impl(const PolygonalMesh& mesh, bool smooth);
+    // A copy of a mesh that was read from a cache file shares the cached data
+    // rather than copying it.
+    Impl(const Impl& source);
+    ~Impl();
     ContactGeometryImpl* clone() const {
         return new Impl(*this);
     }
 
+    void writeCacheFile(const String& pathname) const;
+    static Impl* readCacheFile(const String& pathname);
+
     ContactGeometryTypeId getTypeId() const {return classTypeId();}
 
     Vec3     findPoint(int face, const Vec2& uv) const;
@@ -528,6 +580,8 @@ public:
                           UnitVec3& normal) const;
     Vec3 findNearestPoint(const Vec3& position, bool& inside, int& face, 
                           Vec2& uv) const;
+    void findNearestPoints(int n, const Vec3 positions[], Vec3 nearestPoints[],
+                           bool inside[], UnitVec3 normals[]) const;
     Vec3 findNearestPointToFace(const Vec3& position, int face, Vec2& uv) const;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const;
@@ -541,29 +595,52 @@ public:
 
     void createPolygonalMesh(PolygonalMesh& mesh) const;
 
+    const OBBTreeImpl& getOBBTree() const {return obb;}
+
     static ContactGeometryTypeId classTypeId() {
         static const ContactGeometryTypeId id = 
             createNewContactGeometryTypeId();
         return id;
     }
 private:
+    explicit Impl(CacheData* cacheData);
+    Impl& operator=(const Impl&); // suppress
+    bool hasValidCachedIndices(int maxDepth) const;
+
     void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices);
-    void createObbTree(OBBTreeNodeImpl& node, const Array_<int>& faceIndices);
+    class ObbSubtreeTask;
+    void createObbTree(const Array_<int>& faceIndices);
+    void createObbTreeTop(const Array_<int>& faceIndices, int depth, 
+                          int subtreeSize, Array_<OBBTreeNodeImpl>& top, 
+                          Array_<int>& topSubtree, 
+                          Array_<Array_<int> >& subtreeFaces, 
+                          Array_<int>& subtreeDepths) const;
+    void createObbSubtree(const Array_<int>& faceIndices, int depth, 
+                          OBBTreeImpl& tree) const;
+    OrientedBoundingBox 
+         createObbBounds(const Array_<int>& faceIndices) const;
+    bool splitObbNode(const Array_<int>& parentIndices, 
+                      const OrientedBoundingBox& bounds,
+                      Array_<int>& child1Indices, 
+                      Array_<int>& child2Indices) const;
     void splitObbAxis(const Array_<int>& parentIndices, 
                       Array_<int>& child1Indices, 
-                      Array_<int>& child2Indices, int axis);
+                      Array_<int>& child2Indices, int axis) const;
     void findBoundingSphere(Vec3* point[], int p, int b, 
                             Vec3& center, Real& radius);
     friend class ContactGeometry::TriangleMesh;
-    friend class OBBTreeNodeImpl;
+    friend class OBBTreeImpl;
 
     Array_<Edge>    edges;
     Array_<Face>    faces;
     Array_<Vertex>  vertices;
     Vec3            boundingSphereCenter;
     Real            boundingSphereRadius;
-    OBBTreeNodeImpl obb;
+    OBBTreeImpl     obb;
     bool            smooth;
+    // If the mesh was read from a cache file, the arrays above are views of
+    // this rather than owning their data; otherwise null.
+    CacheData*      cacheData;
 };
 
 
@@ -143,6 +143,33 @@ friend class BrokenContact;
 
 
 
+//==============================================================================
+//                        ANTICIPATED CONTACT IMPL
+//==============================================================================
+class AnticipatedContactImpl : public ContactImpl {
+public:
+    AnticipatedContactImpl
+       (ContactSurfaceIndex surf1, ContactSurfaceIndex surf2, 
+        const Transform& X_S1S2, Real separation, Real timeToContact) 
+    :   ContactImpl(surf1, surf2, X_S1S2, Contact::Anticipated), 
+        separation(separation), timeToContact(timeToContact)
+    {
+    }
+
+    ContactTypeId getTypeId() const {return classTypeId();}
+    static ContactTypeId classTypeId() {
+        static const ContactTypeId tid = createNewContactTypeId();
+        return tid;
+    }
+
+private:
+friend class AnticipatedContact;
+    Real        separation;
+    Real        timeToContact;
+};
+
+
+
 //==============================================================================
 //                        CIRCULAR POINT CONTACT IMPL
 //==============================================================================
@@ -212,6 +239,11 @@ public:
                             const Transform&        X_S1S2,
                             const std::set<int>&    faces1, 
                             const std::set<int>&    faces2);
+    TriangleMeshContactImpl(ContactSurfaceIndex     surf1, 
+                            ContactSurfaceIndex     surf2,
+                            const Transform&        X_S1S2,
+                            const Array_<int>&      faces1, 
+                            const Array_<int>&      faces2);
 
     ContactTypeId getTypeId() const {return classTypeId();}
     static ContactTypeId classTypeId() {
@@ -219,11 +251,27 @@ public:
         return tid;
     }
 
+    // These are left here by the TriangleMesh-TriangleMesh tracker for its
+    // own use the next time it sees this contact: the pairs of leaf nodes 
+    // (surface1 OBB tree node, surface2 OBB tree node) whose boxes were 
+    // within nearMargin of each other when surface2 was at X_S1S2Near. They
+    // are empty, with nearMargin zero, if there aren't any.
+    Array_< std::pair<int,int> >    nearLeafPairs;
+    Transform                       X_S1S2Near;
+    Real                            nearMargin;
+
 private:
 friend class TriangleMeshContact;
 
-    const std::set<int> faces1;
-    const std::set<int> faces2;
+    // Fill in faceSet1 and faceSet2 if that hasn't been done yet.
+    void ensureFaceSetsBuilt() const;
+
+    // Sorted, no duplicates.
+    Array_<int> faces1;
+    Array_<int> faces2;
+    // The same faces, for the std::set accessors; built on first use.
+    mutable std::set<int>   faceSet1, faceSet2;
+    mutable bool            faceSetsBuilt;
 };
 
 
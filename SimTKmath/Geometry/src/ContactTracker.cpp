@@ -22,6 +22,8 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKmath.h"
+#include "ContactGeometryImpl.h"
+#include "ContactImpl.h"
 
 #include <algorithm>
 using std::pair; using std::make_pair;
@@ -314,6 +316,423 @@ findImplicitPairError
 
 
 
+//==============================================================================
+//                            CONTACT PREDICTION
+//==============================================================================
+// Contact prediction assumes that each surface frame moves with constant 
+// spatial acceleration over the interval of interest and uses conservative
+// advancement: if the surfaces are separated by distance d now and no point
+// of one can approach the other faster than speed s, they cannot touch before
+// d/s from now. Advancing to that time and repeating approaches the time of 
+// first contact from below, so the predicted time is never late. Each tracker
+// supplies a function object that returns the separation of its pair of 
+// surfaces (or a lower bound on it) given their poses in Ground.
+namespace {
+
+const int  MaxAdvancementSteps = 50;
+// Stop advancing when the remaining gap is this fraction of the initial one.
+const Real AdvancementTol = Real(1e-3);
+// Limits for refining the separating direction of a convex pair; the bound is
+// valid at any iteration, these only control how tight it gets.
+const int  MaxSeparationIters = 32;
+const Real SeparationTol = Real(1e-4);
+
+// Return the pose at time t from now of a frame F whose current pose, 
+// velocity, and acceleration in Ground are given, assuming constant 
+// acceleration. The orientation is advanced by the rotation vector
+// w t + b t^2/2 (w, b are angular velocity and acceleration), which is exact
+// for rotation about a fixed axis, and whose angular speed never exceeds 
+// |w + b t| so it is covered by calcMaxSpeed() below.
+Transform extrapolatePose(const Transform& X_GF, const SpatialVec& V_GF, 
+                          const SpatialVec& A_GF, Real t) {
+    const Real t2 = t*t/2;
+    const Vec3 p_GF = X_GF.p() + t*V_GF[1] + t2*A_GF[1];
+    const Vec3 theta = t*V_GF[0] + t2*A_GF[0];
+    const Real angle = theta.norm();
+    if (angle == 0)
+        return Transform(X_GF.R(), p_GF);
+    return Transform(Rotation(angle, UnitVec3(theta/angle, true))*X_GF.R(), 
+                     p_GF);
+}
+
+// Return an upper bound on the speed, over the next T time units, of any 
+// point within distance reach of the origin of a frame moving as above.
+Real calcMaxSpeed(const SpatialVec& V_GF, const SpatialVec& A_GF, 
+                  Real reach, Real T) {
+    const Real linear  = V_GF[1].norm() + T*A_GF[1].norm();
+    const Real angular = V_GF[0].norm() + T*A_GF[0].norm();
+    return angular == 0 ? linear : linear + reach*angular;
+}
+
+// Return the distance from a surface's frame origin to its furthest point.
+Real calcReach(const ContactGeometry& geom) {
+    Vec3 center; Real radius;
+    geom.getBoundingSphere(center, radius);
+    return center.norm() + radius;
+}
+
+// A half space has unlimited reach but only the part of it near the other 
+// surface matters. Over the next T time units the other surface can't be
+// further from the half space origin than this.
+Real calcHalfSpaceReach
+   (const Transform& X_GH, const SpatialVec& V_GH, const SpatialVec& A_GH,
+    const Transform& X_GS, const SpatialVec& V_GS, const SpatialVec& A_GS,
+    Real reachS, Real T) {
+    return (X_GS.p()-X_GH.p()).norm() + reachS
+           + T*(calcMaxSpeed(V_GH,A_GH,0,T) + calcMaxSpeed(V_GS,A_GS,reachS,T));
+}
+
+// Given a function object calcSeparation(X_GS1,X_GS2) that returns a lower 
+// bound on the distance between surfaces S1 and S2 in the given poses, find
+// the earliest time within the interval of interest at which they might come
+// within cutoff of one another. If they can't, predictedStatus is cleared, 
+// otherwise it is set to an AnticipatedContact. Each advancement aims to
+// leave half the tolerance uncovered so that the predicted time is strictly
+// before the surfaces meet, even when the speed bound is exact. If the bound
+// can't show that the surfaces are apart now, we make no prediction rather
+// than report an onset at t=0; the contact will be picked up by tracking.
+template <class Separation>
+bool predictContactOnset
+   (const Separation& calcSeparation, const Contact& priorStatus,
+    const Transform& X_GS1, const SpatialVec& V_GS1, const SpatialVec& A_GS1,
+    Real reach1,
+    const Transform& X_GS2, const SpatialVec& V_GS2, const SpatialVec& A_GS2,
+    Real reach2,
+    Real cutoff, Real intervalOfInterest, Contact& predictedStatus)
+{
+    const Real T = intervalOfInterest;
+    const Real maxSpeed =   calcMaxSpeed(V_GS1, A_GS1, reach1, T)
+                          + calcMaxSpeed(V_GS2, A_GS2, reach2, T);
+    const Real separation = calcSeparation(X_GS1, X_GS2);
+    Real gap = separation - cutoff;
+    if (!(separation > 0) || gap > maxSpeed*T || !(maxSpeed > 0)) {
+        predictedStatus.clear(); // can't get there in time, or no bound
+        return true;
+    }
+
+    const Real tol = AdvancementTol*gap;
+    Real t = 0;
+    for (int i=0; i < MaxAdvancementSteps && gap > tol; ++i) {
+        t += (gap - tol/2)/maxSpeed;
+        if (t > T) {
+            predictedStatus.clear();
+            return true;
+        }
+        gap = calcSeparation(extrapolatePose(X_GS1, V_GS1, A_GS1, t),
+                             extrapolatePose(X_GS2, V_GS2, A_GS2, t)) - cutoff;
+    }
+
+    predictedStatus = AnticipatedContact(priorStatus.getSurface1(),
+                                         priorStatus.getSurface2(),
+                                         ~X_GS1*X_GS2, separation, t);
+    return true;
+}
+
+// With no history to go on, we initialize a contact by tracking it as though
+// it were new and, if that shows the surfaces aren't touching, predicting
+// when they will with the current velocities held constant. If contactStatus
+// already identifies the surfaces on entry, they are carried through.
+bool initializeByTrackingThenPredicting
+   (const ContactTracker& tracker,
+    const Transform& X_GS1, const SpatialVec& V_GS1,
+    const ContactGeometry& surface1,
+    const Transform& X_GS2, const SpatialVec& V_GS2,
+    const ContactGeometry& surface2,
+    Real cutoff, Real intervalOfInterest, Contact& contactStatus)
+{
+    ContactSurfaceIndex surf1, surf2;
+    if (!contactStatus.isEmpty())
+        surf1 = contactStatus.getSurface1(), surf2 = contactStatus.getSurface2();
+    const UntrackedContact untracked(surf1, surf2);
+    if (!tracker.trackContact(untracked, X_GS1, surface1, X_GS2, surface2, 
+                              cutoff, contactStatus))
+        return false;
+    if (!contactStatus.isEmpty())
+        return true; // touching now
+
+    const SpatialVec A0(Vec3(0), Vec3(0));
+    return tracker.predictContact(untracked, X_GS1, V_GS1, A0, surface1,
+                                  X_GS2, V_GS2, A0, surface2,
+                                  cutoff, intervalOfInterest, contactStatus);
+}
+
+// Squared distance between line segments p1q1 and p2q2. This is the usual
+// closest-point calculation (see Ericson, Real-Time Collision Detection, 
+// 5.1.9) with the parameters clamped to the segments.
+Real calcSegmentDistanceSqr(const Vec3& p1, const Vec3& q1, 
+                            const Vec3& p2, const Vec3& q2) {
+    const Vec3 d1 = q1-p1, d2 = q2-p2, r = p1-p2;
+    const Real a = d1.normSqr(), e = d2.normSqr(), f = dot(d2, r);
+    Real s, t;
+    if (a <= SignificantReal && e <= SignificantReal)
+        return r.normSqr();
+    if (a <= SignificantReal) {
+        s = 0; t = clamp(Real(0), f/e, Real(1));
+    } else {
+        const Real c = dot(d1, r);
+        if (e <= SignificantReal) {
+            t = 0; s = clamp(Real(0), -c/a, Real(1));
+        } else {
+            const Real b = dot(d1, d2), denom = a*e - b*b;
+            s = denom > 0 ? clamp(Real(0), (b*f - c*e)/denom, Real(1)) : 0;
+            t = (b*s + f)/e;
+            if (t < 0)      {t = 0; s = clamp(Real(0), -c/a, Real(1));}
+            else if (t > 1) {t = 1; s = clamp(Real(0), (b-c)/a, Real(1));}
+        }
+    }
+    return ((p1 + s*d1) - (p2 + t*d2)).normSqr();
+}
+
+// Return a sphere (center in M, radius) containing an OBB tree node.
+void getNodeSphere(const ContactGeometry::TriangleMesh::OBBTreeNode& node,
+                   Vec3& center_M, Real& radius) {
+    const OrientedBoundingBox& box = node.getBounds();
+    center_M = box.getTransform()*(box.getSize()/2);
+    radius   = box.getSize().norm()/2;
+}
+
+// Separation of a half space H (occupying x>0) and a sphere.
+class HalfSpaceSphereSeparation {
+public:
+    explicit HalfSpaceSphereSeparation(Real radius) : radius(radius) {}
+    Real operator()(const Transform& X_GH, const Transform& X_GS) const 
+    {   return -(~X_GH.R()*(X_GS.p() - X_GH.p()))[0] - radius; }
+private:
+    Real radius;
+};
+
+// Separation of a half space H and an ellipsoid E: the height above the half
+// space of the ellipsoid point whose normal opposes the half space normal.
+class HalfSpaceEllipsoidSeparation {
+public:
+    explicit HalfSpaceEllipsoidSeparation
+       (const ContactGeometry::Ellipsoid& ellipsoid) : ellipsoid(ellipsoid) {}
+    Real operator()(const Transform& X_GH, const Transform& X_GE) const {
+        const Transform X_HE = ~X_GH*X_GE;
+        const UnitVec3& n_E = (~X_HE.R()).x();
+        return -(X_HE*ellipsoid.findPointWithThisUnitNormal(n_E))[0];
+    }
+private:
+    const ContactGeometry::Ellipsoid& ellipsoid;
+};
+
+class SphereSphereSeparation {
+public:
+    SphereSphereSeparation(Real r1, Real r2) : radii(r1+r2) {}
+    Real operator()(const Transform& X_GS1, const Transform& X_GS2) const 
+    {   return (X_GS2.p()-X_GS1.p()).norm() - radii; }
+private:
+    Real radii;
+};
+
+// Separation of a half space H and a mesh M: the height of the lowest mesh
+// vertex above the half space surface, found by descending the OBB tree 
+// and skipping any box whose lowest corner is no lower than the best vertex
+// found so far.
+class HalfSpaceMeshSeparation {
+public:
+    explicit HalfSpaceMeshSeparation
+       (const ContactGeometry::TriangleMesh& mesh) : mesh(mesh) {}
+    Real operator()(const Transform& X_GH, const Transform& X_GM) const {
+        const Transform X_HM = ~X_GH*X_GM;
+        const UnitVec3 hsNormal_M = -(~X_HM.R()).x();
+        const Real hsFaceHeight_M = dot((~X_HM).p(), hsNormal_M);
+        Real lowest = Infinity;
+        Array_<ContactGeometry::TriangleMesh::OBBTreeNode> pending;
+        pending.push_back(mesh.getOBBTreeNode());
+        while (!pending.empty()) {
+            const ContactGeometry::TriangleMesh::OBBTreeNode node = 
+                pending.back();
+            pending.pop_back();
+            const OrientedBoundingBox& bounds = node.getBounds();
+            const Transform& X_MB = bounds.getTransform();
+            const Vec3 p_BC = bounds.getSize()/2;
+            const Real extent = dot(p_BC, (~X_MB.R()*hsNormal_M).abs());
+            const Real boxBottom = 
+                dot(X_MB*p_BC, hsNormal_M) - hsFaceHeight_M - extent;
+            if (boxBottom >= lowest)
+                continue;
+            if (!node.isLeafNode()) {
+                pending.push_back(node.getSecondChildNode());
+                pending.push_back(node.getFirstChildNode());
+                continue;
+            }
+            const ArrayViewConst_<int> triangles = node.getTriangles();
+            for (int i=0; i < (int)triangles.size(); ++i)
+                for (int vx=0; vx < 3; ++vx) {
+                    const Vec3& v_M = mesh.getVertexPosition
+                                        (mesh.getFaceVertex(triangles[i], vx));
+                    lowest = std::min(lowest, 
+                                      dot(v_M, hsNormal_M) - hsFaceHeight_M);
+                }
+        }
+        return lowest;
+    }
+private:
+    const ContactGeometry::TriangleMesh& mesh;
+};
+
+// Separation of a sphere S and a mesh M: distance from the sphere center to
+// the nearest mesh point, less the radius (negative if the center is inside).
+class SphereMeshSeparation {
+public:
+    SphereMeshSeparation(Real radius, const ContactGeometry::TriangleMesh& mesh)
+    :   radius(radius), mesh(mesh) {}
+    Real operator()(const Transform& X_GS, const Transform& X_GM) const {
+        const Vec3 p_MC = ~X_GM*X_GS.p();
+        bool inside; UnitVec3 normal;
+        const Real dist = (mesh.findNearestPoint(p_MC, inside, normal) 
+                           - p_MC).norm();
+        return (inside ? -dist : dist) - radius;
+    }
+private:
+    Real                                    radius;
+    const ContactGeometry::TriangleMesh&    mesh;
+};
+
+// Separation of two meshes, by branch and bound over pairs of OBB tree nodes
+// using each node's bounding sphere, then the exact distance between the 
+// triangles of leaf node pairs. Meshes that interpenetrate may report a 
+// positive separation but we are only asked about meshes that aren't 
+// touching.
+class MeshMeshSeparation {
+public:
+    MeshMeshSeparation(const ContactGeometry::TriangleMesh& mesh1,
+                       const ContactGeometry::TriangleMesh& mesh2)
+    :   mesh1(mesh1), mesh2(mesh2) {}
+    Real operator()(const Transform& X_GM1, const Transform& X_GM2) const {
+        typedef ContactGeometry::TriangleMesh::OBBTreeNode Node;
+        const Transform X_12 = ~X_GM1*X_GM2;
+        const Transform X_21 = ~X_12;
+        Real best = Infinity;
+        Array_< pair<Node,Node> > pending;
+        pending.push_back(make_pair(mesh1.getOBBTreeNode(),
+                                    mesh2.getOBBTreeNode()));
+        while (!pending.empty()) {
+            const pair<Node,Node> nodes = pending.back();
+            pending.pop_back();
+            Vec3 c1, c2; Real r1, r2;
+            getNodeSphere(nodes.first,  c1, r1);
+            getNodeSphere(nodes.second, c2, r2);
+            if ((c1 - X_12*c2).norm() - r1 - r2 >= best)
+                continue;
+            const bool leaf1 = nodes.first.isLeafNode(), 
+                       leaf2 = nodes.second.isLeafNode();
+            if (!leaf1 && (leaf2 || r1 >= r2)) {
+                pending.push_back(make_pair(nodes.first.getSecondChildNode(),
+                                            nodes.second));
+                pending.push_back(make_pair(nodes.first.getFirstChildNode(),
+                                            nodes.second));
+            } else if (!leaf2) {
+                pending.push_back(make_pair(nodes.first,
+                                            nodes.second.getSecondChildNode()));
+                pending.push_back(make_pair(nodes.first,
+                                            nodes.second.getFirstChildNode()));
+            } else {
+                const ArrayViewConst_<int> faces1 = nodes.first.getTriangles();
+                const ArrayViewConst_<int> faces2 = nodes.second.getTriangles();
+                for (int i=0; i < (int)faces1.size(); ++i)
+                    for (int j=0; j < (int)faces2.size(); ++j)
+                        best = std::min(best, calcFaceDistance
+                                        (faces1[i], faces2[j], X_12, X_21));
+            }
+        }
+        return best;
+    }
+private:
+    // The triangle-triangle distance for triangles that don't intersect is
+    // the least of the vertex-face and edge-edge distances.
+    Real calcFaceDistance(int face1, int face2, 
+                          const Transform& X_12, const Transform& X_21) const {
+        Vec3 a_1[3], b_1[3]; // vertices of face1 and face2 in M1
+        for (int k=0; k < 3; ++k) {
+            a_1[k] = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, k));
+            b_1[k] = X_12*mesh2.getVertexPosition(mesh2.getFaceVertex(face2,k));
+        }
+        Real dist2 = Infinity;
+        Vec2 uv;
+        for (int k=0; k < 3; ++k) {
+            dist2 = std::min(dist2, 
+                (mesh1.findNearestPointToFace(b_1[k], face1, uv) - b_1[k])
+                    .normSqr());
+            const Vec3 a_2 = X_21*a_1[k];
+            dist2 = std::min(dist2, 
+                (mesh2.findNearestPointToFace(a_2, face2, uv) - a_2)
+                    .normSqr());
+        }
+        for (int i=0; i < 3; ++i)
+            for (int j=0; j < 3; ++j)
+                dist2 = std::min(dist2, calcSegmentDistanceSqr
+                    (a_1[i], a_1[(i+1)%3], b_1[j], b_1[(j+1)%3]));
+        return std::sqrt(dist2);
+    }
+
+    const ContactGeometry::TriangleMesh& mesh1;
+    const ContactGeometry::TriangleMesh& mesh2;
+};
+
+// For a pair of convex shapes A and B, any unit direction d gives a lower 
+// bound on their separation: the gap between A's extent along d and B's 
+// extent along -d. The direction from A's origin to B's can give a poor (even
+// negative) bound for elongated shapes, so starting from there we refine it
+// with Gilbert's iteration on the Minkowski difference A-B: x is a point of
+// A-B that moves toward the origin, and -x/|x| converges to the separating
+// direction. Every iterate's bound is valid; we return the best one.
+class ConvexPairSeparation {
+public:
+    ConvexPairSeparation(const ContactGeometry& shapeA, 
+                         const ContactGeometry& shapeB)
+    :   shapeA(shapeA), shapeB(shapeB) {}
+    Real operator()(const Transform& X_GA, const Transform& X_GB) const {
+        const Transform X_AB = ~X_GA*X_GB;
+        const Real dist = X_AB.p().norm();
+        if (dist == 0)
+            return 0;
+        UnitVec3 d_A(X_AB.p()/dist, true);
+        Vec3 x = computeSupport(shapeA, shapeB, X_AB, d_A);
+        Real best = -dot(d_A, x);
+        for (int i=0; i < MaxSeparationIters; ++i) {
+            const Real xNorm = x.norm();
+            if (xNorm <= SignificantReal*dist)
+                break; // shapes overlap or touch
+            d_A = UnitVec3(-x/xNorm, true);
+            const Vec3 s = computeSupport(shapeA, shapeB, X_AB, d_A);
+            best = std::max(best, -dot(d_A, s));
+            if (xNorm - best <= SeparationTol*xNorm)
+                break; // x is nearly the closest point; bound is tight
+            // Move x to the point on segment xs that is closest to the origin.
+            const Vec3 xs = s - x;
+            const Real xs2 = xs.normSqr();
+            if (xs2 == 0)
+                break;
+            x += clamp(Real(0), -dot(x, xs)/xs2, Real(1))*xs;
+        }
+        return best;
+    }
+private:
+    const ContactGeometry& shapeA;
+    const ContactGeometry& shapeB;
+};
+
+// For anything else we can only use the bounding spheres.
+class BoundingSphereSeparation {
+public:
+    BoundingSphereSeparation(const ContactGeometry& geom1, 
+                             const ContactGeometry& geom2) {
+        geom1.getBoundingSphere(center1, radius1);
+        geom2.getBoundingSphere(center2, radius2);
+    }
+    Real operator()(const Transform& X_G1, const Transform& X_G2) const 
+    {   return (X_G2*center2 - X_G1*center1).norm() - radius1 - radius2; }
+private:
+    Vec3 center1, center2;
+    Real radius1, radius2;
+};
+
+}
+
+
+
 //==============================================================================
 //                     HALFSPACE-SPHERE CONTACT TRACKER
 //==============================================================================
@@ -372,9 +791,20 @@ bool ContactTracker::HalfSpaceSphere::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceSphere::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::HalfSpace::isInstance(surface1)
+        && ContactGeometry::Sphere::isInstance(surface2),
+       "ContactTracker::HalfSpaceSphere::predictContact()");
+
+    const Real r = ContactGeometry::Sphere::getAs(surface2).getRadius();
+    return predictContactOnset
+       (HalfSpaceSphereSeparation(r), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcHalfSpaceReach(X_GS1, V_GS1, A_GS1, 
+                           X_GS2, V_GS2, A_GS2, r, intervalOfInterest),
+        X_GS2, V_GS2, A_GS2, r,
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::HalfSpaceSphere::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -384,9 +814,9 @@ bool ContactTracker::HalfSpaceSphere::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceSphere::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -468,9 +898,22 @@ bool ContactTracker::HalfSpaceEllipsoid::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceEllipsoid::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::HalfSpace::isInstance(surface1)
+        && ContactGeometry::Ellipsoid::isInstance(surface2),
+       "ContactTracker::HalfSpaceEllipsoid::predictContact()");
+
+    const ContactGeometry::Ellipsoid& ellipsoid = 
+        ContactGeometry::Ellipsoid::getAs(surface2);
+    const Real reach = max(ellipsoid.getRadii());
+    return predictContactOnset
+       (HalfSpaceEllipsoidSeparation(ellipsoid), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcHalfSpaceReach(X_GS1, V_GS1, A_GS1, 
+                           X_GS2, V_GS2, A_GS2, reach, intervalOfInterest),
+        X_GS2, V_GS2, A_GS2, reach,
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::HalfSpaceEllipsoid::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -480,9 +923,9 @@ bool ContactTracker::HalfSpaceEllipsoid::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceEllipsoid::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -569,9 +1012,20 @@ bool ContactTracker::SphereSphere::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::SphereSphere::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::Sphere::isInstance(surface1)
+        && ContactGeometry::Sphere::isInstance(surface2),
+       "ContactTracker::SphereSphere::predictContact()");
+
+    const Real r1 = ContactGeometry::Sphere::getAs(surface1).getRadius();
+    const Real r2 = ContactGeometry::Sphere::getAs(surface2).getRadius();
+    return predictContactOnset
+       (SphereSphereSeparation(r1,r2), priorStatus,
+        X_GS1, V_GS1, A_GS1, r1,
+        X_GS2, V_GS2, A_GS2, r2,
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::SphereSphere::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -581,9 +1035,9 @@ bool ContactTracker::SphereSphere::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::SphereSphere::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -651,9 +1105,21 @@ bool ContactTracker::HalfSpaceTriangleMesh::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceTriangleMesh::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::HalfSpace::isInstance(surface1)
+        && ContactGeometry::TriangleMesh::isInstance(surface2),
+       "ContactTracker::HalfSpaceTriangleMesh::predictContact()");
+
+    const Real reach = calcReach(surface2);
+    return predictContactOnset
+       (HalfSpaceMeshSeparation
+            (ContactGeometry::TriangleMesh::getAs(surface2)), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcHalfSpaceReach(X_GS1, V_GS1, A_GS1, 
+                           X_GS2, V_GS2, A_GS2, reach, intervalOfInterest),
+        X_GS2, V_GS2, A_GS2, reach,
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::HalfSpaceTriangleMesh::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -663,84 +1129,96 @@ bool ContactTracker::HalfSpaceTriangleMesh::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::HalfSpaceTriangleMesh::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
-// Check a single OBB and its contents (recursively) against the halfspace,
-// appending any penetrating faces to the insideFaces list.
+// Check the OBB tree below the given node against the halfspace, appending any
+// penetrating faces to the insideFaces list. The tree is walked with an 
+// explicit stack of the nodes still to be checked rather than by recursion.
 void ContactTracker::HalfSpaceTriangleMesh::processBox
    (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+    const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
     const Transform& X_HM, const UnitVec3& hsNormal_M, Real hsFaceHeight_M, 
     std::set<int>& insideFaces) const 
-{   // First check against the node's bounding box.
-    
-    const OrientedBoundingBox& bounds = node.getBounds();
-    const Transform& X_MB = bounds.getTransform(); // box frame in mesh
-    const Vec3 p_BC = bounds.getSize()/2; // from box origin corner to center
-    // Express the half space normal in the box frame, then reflect it into
-    // the first (+,+,+) quadrant where it is the normal of a different 
-    // but symmetric and more convenient half space.
-    const UnitVec3 octant1hsNormal_B = (~X_MB.R()*hsNormal_M).abs();
-    // Dot our octant1 radius p_BC with our octant1 normal to get
-    // the extent of the box from its center in the direction of the octant1
-    // reflection of the halfspace.
-    const Real extent = dot(p_BC, octant1hsNormal_B);
-    // Compute the height of the box center over the mesh origin,
-    // measured along the real halfspace normal.
-    const Vec3 boxCenter_M       = X_MB*p_BC;
-    const Real boxCenterHeight_M = dot(boxCenter_M, hsNormal_M);
-    // Subtract the halfspace surface position to get the height of the 
-    // box center over the halfspace.
-    const Real boxCenterHeight = boxCenterHeight_M - hsFaceHeight_M;
-    if (boxCenterHeight >= extent)
-        return;                             // no penetration
-    if (boxCenterHeight <= -extent) {
-        addAllTriangles(node, insideFaces); // box is entirely in halfspace
-        return;
-    }
-    
-    // Box is partially penetrated into halfspace. If it is not a leaf node, 
-    // check its children.
-    if (!node.isLeafNode()) {
-        processBox(mesh, node.getFirstChildNode(), X_HM, hsNormal_M, 
-                   hsFaceHeight_M, insideFaces);
-        processBox(mesh, node.getSecondChildNode(), X_HM, hsNormal_M, 
-                   hsFaceHeight_M, insideFaces);
-        return;
-    }
-    
-    // This is a leaf OBB node that is penetrating, so some of its triangles
-    // may be penetrating.
-    const Array_<int>& triangles = node.getTriangles();
-    for (int i = 0; i < (int) triangles.size(); i++) {
-        for (int vx=0; vx < 3; ++vx) {
-            const int   vertex         = mesh.getFaceVertex(triangles[i], vx);
-            const Vec3& vertexPos      = mesh.getVertexPosition(vertex);
-            const Real  vertexHeight_M = dot(vertexPos, hsNormal_M);
-            if (vertexHeight_M < hsFaceHeight_M) {
-                insideFaces.insert(triangles[i]);
-                break; // done with this face
+{   
+    Array_<ContactGeometry::TriangleMesh::OBBTreeNode> pending;
+    pending.push_back(root);
+    while (!pending.empty()) {
+        const ContactGeometry::TriangleMesh::OBBTreeNode node = pending.back();
+        pending.pop_back();
+
+        // First check against the node's bounding box.
+        
+        const OrientedBoundingBox& bounds = node.getBounds();
+        const Transform& X_MB = bounds.getTransform(); // box frame in mesh
+        const Vec3 p_BC = bounds.getSize()/2; // from box origin corner to center
+        // Express the half space normal in the box frame, then reflect it into
+        // the first (+,+,+) quadrant where it is the normal of a different 
+        // but symmetric and more convenient half space.
+        const UnitVec3 octant1hsNormal_B = (~X_MB.R()*hsNormal_M).abs();
+        // Dot our octant1 radius p_BC with our octant1 normal to get
+        // the extent of the box from its center in the direction of the 
+        // octant1 reflection of the halfspace.
+        const Real extent = dot(p_BC, octant1hsNormal_B);
+        // Compute the height of the box center over the mesh origin,
+        // measured along the real halfspace normal.
+        const Vec3 boxCenter_M       = X_MB*p_BC;
+        const Real boxCenterHeight_M = dot(boxCenter_M, hsNormal_M);
+        // Subtract the halfspace surface position to get the height of the 
+        // box center over the halfspace.
+        const Real boxCenterHeight = boxCenterHeight_M - hsFaceHeight_M;
+        if (boxCenterHeight >= extent)
+            continue;                           // no penetration
+        if (boxCenterHeight <= -extent) {
+            addAllTriangles(node, insideFaces); // box is entirely in halfspace
+            continue;
+        }
+        
+        // Box is partially penetrated into halfspace. If it is not a leaf 
+        // node, check its children.
+        if (!node.isLeafNode()) {
+            pending.push_back(node.getSecondChildNode());
+            pending.push_back(node.getFirstChildNode());
+            continue;
+        }
+        
+        // This is a leaf OBB node that is penetrating, so some of its 
+        // triangles may be penetrating.
+        const ArrayViewConst_<int> triangles = node.getTriangles();
+        for (int i = 0; i < (int) triangles.size(); i++) {
+            for (int vx=0; vx < 3; ++vx) {
+                const int   vertex         = mesh.getFaceVertex(triangles[i], vx);
+                const Vec3& vertexPos      = mesh.getVertexPosition(vertex);
+                const Real  vertexHeight_M = dot(vertexPos, hsNormal_M);
+                if (vertexHeight_M < hsFaceHeight_M) {
+                    insideFaces.insert(triangles[i]);
+                    break; // done with this face
+                }
             }
         }
     }
 }
 
 void ContactTracker::HalfSpaceTriangleMesh::addAllTriangles
-   (const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+   (const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
     std::set<int>& insideFaces) const 
 {
-    if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
-        for (int i = 0; i < (int) triangles.size(); i++)
-            insideFaces.insert(triangles[i]);
-    }
-    else {
-        addAllTriangles(node.getFirstChildNode(), insideFaces);
-        addAllTriangles(node.getSecondChildNode(), insideFaces);
+    Array_<ContactGeometry::TriangleMesh::OBBTreeNode> pending;
+    pending.push_back(root);
+    while (!pending.empty()) {
+        const ContactGeometry::TriangleMesh::OBBTreeNode node = pending.back();
+        pending.pop_back();
+        if (node.isLeafNode()) {
+            const ArrayViewConst_<int> triangles = node.getTriangles();
+            insideFaces.insert(triangles.begin(), triangles.end());
+        }
+        else {
+            pending.push_back(node.getSecondChildNode());
+            pending.push_back(node.getFirstChildNode());
+        }
     }
 }
 
@@ -797,37 +1275,43 @@ bool ContactTracker::SphereTriangleMesh::trackContact
     return true; // success
 }
 
-// Check a single OBB and its contents (recursively) against the sphere
-// whose center location in M and radius squared is given, appending any 
-// penetrating faces to the insideFaces list.
+// Check the OBB tree below the given node against the sphere whose center 
+// location in M and radius squared is given, appending any penetrating faces
+// to the insideFaces list. The tree is walked with an explicit stack.
 void ContactTracker::SphereTriangleMesh::processBox
    (const ContactGeometry::TriangleMesh&              mesh, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode& node, 
+    const ContactGeometry::TriangleMesh::OBBTreeNode& root, 
     const Vec3& center_M, Real radius2, 
     std::set<int>& insideFaces) const 
-{   // First check against the node's bounding box.
-
-    const Vec3 nearest_M = node.getBounds().findNearestPoint(center_M);
-    if ((nearest_M-center_M).normSqr() >= radius2)
-        return; // no intersection possible
-    
-    // Bounding box is penetrating. If it's not a leaf node, check its children.
-    if (!node.isLeafNode()) {
-        processBox(mesh, node.getFirstChildNode(), center_M, radius2,
-                   insideFaces);
-        processBox(mesh, node.getSecondChildNode(), center_M, radius2,
-                   insideFaces);
-        return;
-    }
-    
-    // This is a leaf node that may be penetrating; check the triangles.
-    const Array_<int>& triangles = node.getTriangles();
-    for (unsigned i = 0; i < triangles.size(); i++) {
-        Vec2 uv;
-        Vec3 nearest_M = mesh.findNearestPointToFace
-                                    (center_M, triangles[i], uv);
-        if ((nearest_M-center_M).normSqr() < radius2)
-            insideFaces.insert(triangles[i]);
+{   
+    Array_<ContactGeometry::TriangleMesh::OBBTreeNode> pending;
+    pending.push_back(root);
+    while (!pending.empty()) {
+        const ContactGeometry::TriangleMesh::OBBTreeNode node = pending.back();
+        pending.pop_back();
+
+        // First check against the node's bounding box.
+        const Vec3 nearest_M = node.getBounds().findNearestPoint(center_M);
+        if ((nearest_M-center_M).normSqr() >= radius2)
+            continue; // no intersection possible
+        
+        // Bounding box is penetrating. If it's not a leaf node, check its 
+        // children.
+        if (!node.isLeafNode()) {
+            pending.push_back(node.getSecondChildNode());
+            pending.push_back(node.getFirstChildNode());
+            continue;
+        }
+        
+        // This is a leaf node that may be penetrating; check the triangles.
+        const ArrayViewConst_<int> triangles = node.getTriangles();
+        for (unsigned i = 0; i < triangles.size(); i++) {
+            Vec2 uv;
+            Vec3 nearest_M = mesh.findNearestPointToFace
+                                        (center_M, triangles[i], uv);
+            if ((nearest_M-center_M).normSqr() < radius2)
+                insideFaces.insert(triangles[i]);
+        }
     }
 }
 
@@ -840,9 +1324,20 @@ bool ContactTracker::SphereTriangleMesh::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::SphereTriangleMesh::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::Sphere::isInstance(surface1)
+        && ContactGeometry::TriangleMesh::isInstance(surface2),
+       "ContactTracker::SphereTriangleMesh::predictContact()");
+
+    const Real r = ContactGeometry::Sphere::getAs(surface1).getRadius();
+    return predictContactOnset
+       (SphereMeshSeparation
+            (r, ContactGeometry::TriangleMesh::getAs(surface2)), priorStatus,
+        X_GS1, V_GS1, A_GS1, r,
+        X_GS2, V_GS2, A_GS2, calcReach(surface2),
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::SphereTriangleMesh::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -852,9 +1347,9 @@ bool ContactTracker::SphereTriangleMesh::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::SphereTriangleMesh::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -864,7 +1359,346 @@ bool ContactTracker::SphereTriangleMesh::initializeContact
 //==============================================================================
 //               TRIANGLE MESH - TRIANGLE MESH CONTACT TRACKER
 //==============================================================================
-// Cost is TODO
+namespace {
+// A pair of node indices, the first in mesh1's OBB tree and the second in
+// mesh2's.
+typedef std::pair<int,int> NodePair;
+
+static const int Outside  = -1;
+static const int Unknown  =  0;
+static const int Boundary =  1;
+static const int Inside   =  2;
+static const int Nearby   =  3; // near the contact but not yet classified
+
+// When reclassifying only the faces near the prior contact, this is how many
+// rings of neighbors around the prior and boundary faces are included. With
+// just one ring, faces that touch the boundary only at a vertex are left out
+// and the outside part of the region falls apart into many pieces, each of 
+// which would need its own ray test.
+static const int NumNearbyRings = 2;
+
+// Once the meshes are in contact we look for the leaf node pairs whose boxes 
+// are within this many contact face sizes of each other and keep them with
+// the contact. Until mesh2 has moved that far from where it was then, only 
+// those pairs need to be tested.
+static const Real NearPairMargin = 2;
+
+// Reusable workspace for classifying the faces of one mesh. faceType has an
+// entry for every face of the largest mesh seen so far and is left all 
+// Unknown between uses; "touched" lists the entries that have been changed so
+// that they can be put back without sweeping the whole array. "buried" 
+// collects the Inside faces found and "stack" is for the flood fill.
+struct MeshFaceWorkspace {
+    void prepare(int numFaces) {
+        if ((int)faceType.size() < numFaces)
+            faceType.resize(numFaces, Unknown);
+    }
+    void setType(int face, int type) {
+        if (faceType[face] == Unknown) touched.push_back(face);
+        faceType[face] = type;
+    }
+    void reset() {
+        for (unsigned i=0; i < touched.size(); ++i)
+            faceType[touched[i]] = Unknown;
+        touched.clear(); buried.clear(); stack.clear();
+    }
+
+    Array_<int> faceType;
+    Array_<int> touched;
+    Array_<int> buried;
+    Array_<int> stack;
+};
+
+// Everything trackContact() needs that can be reused from call to call. 
+// Trackers are shared by every State, so each thread gets its own.
+struct MeshMeshWorkspace {
+    Array_<NodePair>    stack;
+    Array_<NodePair>    nearPairs;
+    Array_<int>         faces1, faces2;
+    MeshFaceWorkspace   faceWork;
+};
+
+ThreadLocal<MeshMeshWorkspace> meshMeshWorkspace;
+
+// Return the same box with each side moved out by margin.
+OrientedBoundingBox growBox(const OrientedBoundingBox& box, Real margin) {
+    const Transform& X = box.getTransform();
+    return OrientedBoundingBox(Transform(X.R(), X.p() - X.R()*Vec3(margin)),
+                               box.getSize() + Vec3(2*margin));
+}
+
+// Find every pair of leaf nodes whose bounding boxes intersect once mesh2's
+// boxes have been grown by margin. The trees are walked together with an
+// explicit stack of the pairs of nodes still to be checked. Nodes are stored
+// depth first, so a node's first child is the next node.
+void findNearLeafPairs(const OBBTreeImpl&   tree1,
+                       const OBBTreeImpl&   tree2,
+                       const Transform&     X_M1M2,
+                       Real                 margin,
+                       Array_<NodePair>&    stack,
+                       Array_<NodePair>&    nearPairs)
+{
+    nearPairs.clear();
+    stack.clear();
+    stack.push_back(NodePair(0, 0));
+    while (!stack.empty()) {
+        const NodePair pair = stack.back();
+        stack.pop_back();
+        const int n1 = pair.first, n2 = pair.second;
+        const OBBTreeNodeImpl& node1 = tree1.nodes[n1];
+        const OBBTreeNodeImpl& node2 = tree2.nodes[n2];
+
+        // See if the bounding boxes intersect.
+        const OrientedBoundingBox node2Bounds_M1 = X_M1M2*node2.bounds;
+        if (!node1.bounds.intersectsBox(margin > 0 
+                ? growBox(node2Bounds_M1, margin) : node2Bounds_M1))
+            continue;
+
+        // If either node is not a leaf node, check the children. Pairs are
+        // pushed in reverse so that they are checked in the usual order.
+        if (!node2.isLeaf()) {
+            if (!node1.isLeaf()) {
+                stack.push_back(NodePair(node1.secondChild, node2.secondChild));
+                stack.push_back(NodePair(node1.secondChild, n2+1));
+                stack.push_back(NodePair(n1+1, node2.secondChild));
+                stack.push_back(NodePair(n1+1, n2+1));
+            } else {
+                stack.push_back(NodePair(n1, node2.secondChild));
+                stack.push_back(NodePair(n1, n2+1));
+            }
+        } else if (!node1.isLeaf()) {
+            stack.push_back(NodePair(node1.secondChild, n2));
+            stack.push_back(NodePair(n1+1, n2));
+        } else 
+            nearPairs.push_back(pair);
+    }
+}
+
+// Check the triangles of each of the given leaf node pairs whose boxes 
+// currently intersect, and append the faces that intersect a face of the 
+// other mesh to faces1 and faces2. A face may be appended more than once.
+void findIntersectingFaces(const ContactGeometry::TriangleMesh&  mesh1,
+                           const ContactGeometry::TriangleMesh&  mesh2,
+                           const Transform&                      X_M1M2,
+                           const Array_<NodePair>&               leafPairs,
+                           Array_<int>&                          faces1,
+                           Array_<int>&                          faces2)
+{
+    const OBBTreeImpl& tree1 = mesh1.getImpl().getOBBTree();
+    const OBBTreeImpl& tree2 = mesh2.getImpl().getOBBTree();
+    for (unsigned p = 0; p < leafPairs.size(); p++) {
+        const OBBTreeNodeImpl& node1 = tree1.nodes[leafPairs[p].first];
+        const OBBTreeNodeImpl& node2 = tree2.nodes[leafPairs[p].second];
+        if (!node1.bounds.intersectsBox(X_M1M2*node2.bounds))
+            continue;
+
+        const int* node1triangles = &tree1.triangles[node1.firstTriangle];
+        const int* node2triangles = &tree2.triangles[node2.firstTriangle];
+        for (int i = 0; i < node2.numTriangles; i++) {
+            const int face2 = node2triangles[i];
+            Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
+            Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
+            Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
+            const Geo::Triangle A(a1,a2,a3);
+            for (int j = 0; j < node1.numTriangles; j++) {
+                const int face1 = node1triangles[j];
+                const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
+                const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
+                const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
+                const Geo::Triangle B(b1,b2,b3);
+                if (A.overlapsTriangle(B)) 
+                {   // The triangles intersect.
+                    faces1.push_back(face1);
+                    faces2.push_back(face2);
+                }
+            }
+        }
+    }
+}
+
+// Trace a ray from the face's centroid along its normal; the face is inside
+// the other mesh if the ray first hits the back of one of its faces.
+int classifyFace(const ContactGeometry::TriangleMesh&   mesh,       // M
+                 const ContactGeometry::TriangleMesh&   otherMesh,  // O
+                 const Transform&                       X_OM,
+                 int                                    face)
+{
+    const Vec3     origin_O    = X_OM    * mesh.findCentroid(face);
+    const UnitVec3 direction_O = X_OM.R()* mesh.getFaceNormal(face);
+    Real distance;
+    int hitFace;
+    Vec2 uv;
+    if (   otherMesh.intersectsRay(origin_O, direction_O, distance, 
+                                   hitFace, uv) 
+        && ~direction_O*otherMesh.getFaceNormal(hitFace) > 0)
+        return Inside;
+    return Outside;
+}
+
+// Give the type of face "index" to every face connected to it through faces
+// whose type is "unclassified", adding Inside faces to the workspace's buried
+// list. This uses an explicit stack rather than recursion so that it can 
+// handle a mesh of any size. If we're classifying only the Nearby faces and 
+// an Inside region reaches a face that isn't one of them, we stop and return
+// false.
+bool tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
+              MeshFaceWorkspace&                     ws,
+              int                                    index,
+              int                                    unclassified)
+{
+    const int type = ws.faceType[index];
+    ws.stack.clear();
+    ws.stack.push_back(index);
+    while (!ws.stack.empty()) {
+        const int current = ws.stack.back();
+        ws.stack.pop_back();
+        for (int i = 0; i < 3; i++) {
+            const int edge = mesh.getFaceEdge(current, i);
+            const int face = (mesh.getEdgeFace(edge, 0) == current 
+                                ? mesh.getEdgeFace(edge, 1) 
+                                : mesh.getEdgeFace(edge, 0));
+            const int faceType = ws.faceType[face];
+            if (faceType == unclassified) {
+                ws.setType(face, type);
+                if (type == Inside) ws.buried.push_back(face);
+                ws.stack.push_back(face);
+            } else if (faceType == Unknown && type == Inside)
+                return false; // only possible when unclassified is Nearby
+        }
+    }
+    return true;
+}
+
+// Find which faces are inside. We're passed in the list of Boundary faces, 
+// that is, those faces of "mesh" that intersect faces of "otherMesh", and we
+// append the buried ones. Every other face is classified by tracing a ray 
+// from one face of each connected region of unclassified faces and then 
+// flood filling the region.
+void findBuriedFaces(const ContactGeometry::TriangleMesh&   mesh,       // M 
+                     const ContactGeometry::TriangleMesh&   otherMesh,  // O
+                     const Transform&                       X_OM, 
+                     MeshFaceWorkspace&                     ws,
+                     Array_<int>&                           insideFaces)
+{  
+    const int numFaces = mesh.getNumFaces();
+    ws.prepare(numFaces);
+    for (unsigned i=0; i < insideFaces.size(); ++i)
+        ws.setType(insideFaces[i], Boundary);
+
+    for (int i = 0; i < numFaces; i++) {
+        if (ws.faceType[i] == Unknown) {
+            const int type = classifyFace(mesh, otherMesh, X_OM, i);
+            ws.setType(i, type);
+            if (type == Inside) ws.buried.push_back(i);
+            tagFaces(mesh, ws, i, Unknown);
+        }
+    }
+
+    insideFaces.insert(insideFaces.end(), ws.buried.begin(), ws.buried.end());
+    ws.reset();
+}
+
+// This is the incremental version of findBuriedFaces(). Only the faces that
+// were in contact before (priorFaces), the current boundary faces, and the 
+// nearby rings of their neighbors are reclassified; every other face keeps 
+// its prior (outside) classification. That is valid as long as no inside 
+// region reaches past those faces. If one does, the contact has moved too 
+// far, nothing is changed, and we return false so that the caller can fall
+// back to findBuriedFaces().
+bool findBuriedFacesNear(const ContactGeometry::TriangleMesh&   mesh,      // M
+                         const ContactGeometry::TriangleMesh&   otherMesh, // O
+                         const Transform&                       X_OM, 
+                         const Array_<int>&                     priorFaces,
+                         MeshFaceWorkspace&                     ws,
+                         Array_<int>&                           insideFaces)
+{
+    ws.prepare(mesh.getNumFaces());
+    for (unsigned i=0; i < insideFaces.size(); ++i)
+        ws.setType(insideFaces[i], Boundary);
+    for (unsigned i=0; i < priorFaces.size(); ++i)
+        if (ws.faceType[priorFaces[i]] == Unknown)
+            ws.setType(priorFaces[i], Nearby);
+
+    // Add rings of neighbors around all those faces.
+    int ringBegin = 0;
+    for (int ring=0; ring < NumNearbyRings; ++ring) {
+        const int ringEnd = (int)ws.touched.size();
+        for (int k=ringBegin; k < ringEnd; ++k) {
+            const int index = ws.touched[k];
+            for (int i = 0; i < 3; i++) {
+                const int edge = mesh.getFaceEdge(index, i);
+                const int face = (mesh.getEdgeFace(edge, 0) == index 
+                                    ? mesh.getEdgeFace(edge, 1) 
+                                    : mesh.getEdgeFace(edge, 0));
+                if (ws.faceType[face] == Unknown)
+                    ws.setType(face, Nearby);
+            }
+        }
+        ringBegin = ringEnd;
+    }
+
+    // Flood filling only changes Nearby faces, which are already in the
+    // touched list, so the list doesn't grow here.
+    for (int k=0; k < (int)ws.touched.size(); ++k) {
+        const int i = ws.touched[k];
+        if (ws.faceType[i] != Nearby)
+            continue;
+        const int type = classifyFace(mesh, otherMesh, X_OM, i);
+        ws.faceType[i] = type;
+        if (type == Inside) ws.buried.push_back(i);
+        if (!tagFaces(mesh, ws, i, Nearby)) {
+            ws.reset();
+            return false;
+        }
+    }
+
+    insideFaces.insert(insideFaces.end(), ws.buried.begin(), ws.buried.end());
+    ws.reset();
+    return true;
+}
+
+// Return an upper bound on how far any point of mesh2 has moved relative to
+// mesh1 in going from pose X_M1M2_old to X_M1M2.
+Real calcMaxMotion(const Transform&                     X_M1M2_old,
+                   const Transform&                     X_M1M2,
+                   const ContactGeometry::TriangleMesh& mesh2)
+{
+    // Mesh2's motion as seen from its old pose, and the farthest a point of
+    // mesh2 can be from its origin.
+    const Transform X_delta = ~X_M1M2_old*X_M1M2;
+    const Real angle = std::abs(X_delta.R().convertRotationToAngleAxis()[0]);
+    const OrientedBoundingBox& box2 = mesh2.getOBBTreeNode().getBounds();
+    const Vec3 halfSize = box2.getSize()/2;
+    const Real reach = (box2.getTransform()*halfSize).norm() + halfSize.norm();
+    return X_delta.p().norm() + angle*reach;
+}
+
+// Return the typical size of the faces in a contact, or zero if it has no
+// faces. 
+Real calcContactFaceSize(const TriangleMeshContact&             contact,
+                         const ContactGeometry::TriangleMesh&   mesh1,
+                         const ContactGeometry::TriangleMesh&   mesh2)
+{
+    const Array_<int>& faces1 = contact.getSurface1FaceIndices();
+    const Array_<int>& faces2 = contact.getSurface2FaceIndices();
+    if (faces1.empty() || faces2.empty())
+        return 0;
+    Real area1 = 0, area2 = 0;
+    for (unsigned i=0; i < faces1.size(); ++i)
+        area1 += mesh1.getFaceArea(faces1[i]);
+    for (unsigned i=0; i < faces2.size(); ++i)
+        area2 += mesh2.getFaceArea(faces2[i]);
+    return std::sqrt(std::min(area1/faces1.size(), area2/faces2.size()));
+}
+}
+
+// The expensive parts are finding the intersecting faces, which requires 
+// descending both OBB trees, and classifying the rest of the faces of both
+// meshes as buried or not, which visits every face. When the meshes were
+// already in contact we use the prior contact to cut down both: the leaf 
+// node pairs that were near each other then are the only ones that can 
+// intersect now if the meshes haven't moved much since, and only faces near
+// the prior contact can have changed classification.
 bool ContactTracker::TriangleMeshTriangleMesh::trackContact
    (const Contact&         priorStatus,
     const Transform&       X_GM1, 
@@ -891,177 +1725,79 @@ bool ContactTracker::TriangleMeshTriangleMesh::trackContact
 
     // Transform giving mesh2 (M2) frame in the mesh1 (M1) frame.
     const Transform X_M1M2 = ~X_GM1*X_GM2; 
-    std::set<int> insideFaces1, insideFaces2;
 
-    // Get M2's bounding box in M1's frame.
-    const OrientedBoundingBox 
-        mesh2Bounds_M1 = X_M1M2*mesh2.getOBBTreeNode().getBounds();
+    MeshMeshWorkspace& ws = meshMeshWorkspace.upd();
+    ws.faces1.clear(); ws.faces2.clear();
+
+    const TriangleMeshContactImpl* prior = 
+        TriangleMeshContact::isInstance(priorStatus)
+        ? &static_cast<const TriangleMeshContactImpl&>(priorStatus.getImpl())
+        : 0;
+    const Real faceSize = prior ? calcContactFaceSize
+        (TriangleMeshContact::getAs(priorStatus), mesh1, mesh2) : Real(0);
+
+    // Choose the leaf node pairs to check. If the prior contact kept some 
+    // and mesh2 hasn't moved too far since they were found we use those; 
+    // otherwise walk the trees. Margins are only worth finding when we are
+    // already in contact.
+    const Array_<NodePair>* leafPairs = &ws.nearPairs;
+    Transform X_M1M2_near = X_M1M2;
+    Real margin = NearPairMargin*faceSize;
+    if (prior && prior->nearMargin > 0 
+        && calcMaxMotion(prior->X_S1S2Near, X_M1M2, mesh2) 
+           <= prior->nearMargin) {
+        leafPairs = &prior->nearLeafPairs;
+        X_M1M2_near = prior->X_S1S2Near;
+        margin = prior->nearMargin;
+    } else
+        findNearLeafPairs(mesh1.getImpl().getOBBTree(), 
+                          mesh2.getImpl().getOBBTree(), 
+                          X_M1M2, margin, ws.stack, ws.nearPairs);
 
     // Find the faces that are actually intersecting faces on the other
     // surface (this doesn't yet include faces that may be completely buried).
-    findIntersectingFaces(mesh1, mesh2, 
-                          mesh1.getOBBTreeNode(), mesh2.getOBBTreeNode(), 
-                          mesh2Bounds_M1, X_M1M2, insideFaces1, insideFaces2);
+    findIntersectingFaces(mesh1, mesh2, X_M1M2, 
+                          *leafPairs, ws.faces1, ws.faces2);
     
     // It should never be the case that one set of faces is empty and the
     // other isn't, however it is conceivable that roundoff error could cause
     // this to happen so we'll check both lists.
-    if (insideFaces1.empty() && insideFaces2.empty()) {
+    if (ws.faces1.empty() && ws.faces2.empty()) {
         currentStatus.clear(); // not touching
         return true; // successful return
     }
     
     // There was an intersection. We now need to identify every triangle and 
     // vertex of each mesh that is inside the other mesh. We found the border
-    // intersections above; now we have to fill in the buried faces.
-    findBuriedFaces(mesh1, mesh2, ~X_M1M2, insideFaces1);
-    findBuriedFaces(mesh2, mesh1,  X_M1M2, insideFaces2);
-
-    currentStatus = TriangleMeshContact(priorStatus.getSurface1(), 
-                                        priorStatus.getSurface2(), 
-                                        X_M1M2, 
-                                        insideFaces1, insideFaces2);
-    return true; // success
-}
-
-void ContactTracker::TriangleMeshTriangleMesh::
-findIntersectingFaces
-   (const ContactGeometry::TriangleMesh&                mesh1, 
-    const ContactGeometry::TriangleMesh&                mesh2,
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node1, 
-    const ContactGeometry::TriangleMesh::OBBTreeNode&   node2, 
-    const OrientedBoundingBox&                          node2Bounds_M1,
-    const Transform&                                    X_M1M2, 
-    std::set<int>&                                      triangles1, 
-    std::set<int>&                                      triangles2) const 
-{   // See if the bounding boxes intersect.
-    
-    if (!node1.getBounds().intersectsBox(node2Bounds_M1))
-        return;
-    
-    // If either node is not a leaf node, process the children recursively.
-    
-    if (!node1.isLeafNode()) {
-        if (!node2.isLeafNode()) {
-            const OrientedBoundingBox firstChildBounds = 
-                X_M1M2*node2.getFirstChildNode().getBounds();
-            const OrientedBoundingBox secondChildBounds = 
-                X_M1M2*node2.getSecondChildNode().getBounds();
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        }
-        else {
-            findIntersectingFaces(mesh1, mesh2, node1.getFirstChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-            findIntersectingFaces(mesh1, mesh2, node1.getSecondChildNode(), node2, node2Bounds_M1, X_M1M2, triangles1, triangles2);
-        }
-        return;
-    }
-    else if (!node2.isLeafNode()) {
-        const OrientedBoundingBox firstChildBounds = 
-            X_M1M2*node2.getFirstChildNode().getBounds();
-        const OrientedBoundingBox secondChildBounds = 
-            X_M1M2*node2.getSecondChildNode().getBounds();
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getFirstChildNode(), firstChildBounds, X_M1M2, triangles1, triangles2);
-        findIntersectingFaces(mesh1, mesh2, node1, node2.getSecondChildNode(), secondChildBounds, X_M1M2, triangles1, triangles2);
-        return;
-    }
-    
-    // These are both leaf nodes, so check triangles for intersections.
-    
-    const Array_<int>& node1triangles = node1.getTriangles();
-    const Array_<int>& node2triangles = node2.getTriangles();
-    for (unsigned i = 0; i < node2triangles.size(); i++) {
-        const int face2 = node2triangles[i];
-        Vec3 a1 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 0));
-        Vec3 a2 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 1));
-        Vec3 a3 = X_M1M2*mesh2.getVertexPosition(mesh2.getFaceVertex(face2, 2));
-        const Geo::Triangle A(a1,a2,a3);
-        for (unsigned j = 0; j < node1triangles.size(); j++) {
-            const int face1 = node1triangles[j];
-            const Vec3& b1 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 0));
-            const Vec3& b2 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 1));
-            const Vec3& b3 = mesh1.getVertexPosition(mesh1.getFaceVertex(face1, 2));
-            const Geo::Triangle B(b1,b2,b3);
-            if (A.overlapsTriangle(B)) 
-            {   // The triangles intersect.
-                triangles1.insert(face1);
-                triangles2.insert(face2);
-            }
-        }
-    }
-}
-
-static const int Outside  = -1;
-static const int Unknown  =  0;
-static const int Boundary =  1;
-static const int Inside   =  2;
-
-void ContactTracker::TriangleMeshTriangleMesh::
-findBuriedFaces(const ContactGeometry::TriangleMesh&    mesh,       // M 
-                const ContactGeometry::TriangleMesh&    otherMesh,  // O
-                const Transform&                        X_OM, 
-                std::set<int>&                          insideFaces) const 
-{  
-    // Find which faces are inside.
-    // We're passed in the list of Boundary faces, that is, those faces of
-    // "mesh" that intersect faces of "otherMesh".
-    Array_<int> faceType(mesh.getNumFaces(), Unknown);
-    for (std::set<int>::iterator iter = insideFaces.begin(); 
-                                 iter != insideFaces.end(); ++iter)
-        faceType[*iter] = Boundary;
-
-    for (int i = 0; i < (int) faceType.size(); i++) {
-        if (faceType[i] == Unknown) {
-            // Trace a ray from its center to determine whether it is inside.           
-            const Vec3     origin_O    = X_OM    * mesh.findCentroid(i);
-            const UnitVec3 direction_O = X_OM.R()* mesh.getFaceNormal(i);
-            Real distance;
-            int face;
-            Vec2 uv;
-            if (   otherMesh.intersectsRay(origin_O, direction_O, distance, 
-                                           face, uv) 
-                && ~direction_O*otherMesh.getFaceNormal(face) > 0) 
-            {
-                faceType[i] = Inside;
-                insideFaces.insert(i);
-            } else
-                faceType[i] = Outside;
-            
-            // Recursively mark adjacent inside or outside Faces.           
-            tagFaces(mesh, faceType, insideFaces, i, 0);
-        }
-    }
-}
-
-//TODO: the following method uses depth-first recursion to iterate through
-//unmarked faces. For a large mesh this was observed to produce a stack
-//overflow in OpenSim. Here we limit the recursion depth; after we get that
-//deep we'll pop back out and do another expensive intersectsRay() test in
-//the method above.
-static const int MaxRecursionDepth = 500;
-
-void ContactTracker::TriangleMeshTriangleMesh::
-tagFaces(const ContactGeometry::TriangleMesh&   mesh, 
-         Array_<int>&                           faceType,
-         std::set<int>&                         triangles, 
-         int                                    index,
-         int                                    depth) const 
-{
-    for (int i = 0; i < 3; i++) {
-        const int edge = mesh.getFaceEdge(index, i);
-        const int face = (mesh.getEdgeFace(edge, 0) == index 
-                            ? mesh.getEdgeFace(edge, 1) 
-                            : mesh.getEdgeFace(edge, 0));
-        if (faceType[face] == Unknown) {
-            faceType[face] = faceType[index];
-            if (faceType[index] > 0)
-                triangles.insert(face);
-            if (depth < MaxRecursionDepth)
-                tagFaces(mesh, faceType, triangles, face, depth+1);
-        }
+    // intersections above; now we have to fill in the buried faces. If the
+    // meshes haven't moved by more than about a face since the prior contact,
+    // we reclassify only the faces near it, falling back to classifying the
+    // whole mesh if the contact has moved too far after all.
+    const bool coherent = faceSize > 0 
+        && calcMaxMotion(prior->getTransform(), X_M1M2, mesh2) <= faceSize;
+    if (!(coherent && findBuriedFacesNear(mesh1, mesh2, ~X_M1M2, 
+            TriangleMeshContact::getAs(priorStatus).getSurface1FaceIndices(),
+            ws.faceWork, ws.faces1)))
+        findBuriedFaces(mesh1, mesh2, ~X_M1M2, ws.faceWork, ws.faces1);
+    if (!(coherent && findBuriedFacesNear(mesh2, mesh1, X_M1M2, 
+            TriangleMeshContact::getAs(priorStatus).getSurface2FaceIndices(),
+            ws.faceWork, ws.faces2)))
+        findBuriedFaces(mesh2, mesh1,  X_M1M2, ws.faceWork, ws.faces2);
+
+    // Copy the leaf pairs before replacing currentStatus, in case it is the
+    // same object as priorStatus.
+    TriangleMeshContact contact(priorStatus.getSurface1(), 
+                                priorStatus.getSurface2(), 
+                                X_M1M2, ws.faces1, ws.faces2);
+    if (margin > 0) {
+        TriangleMeshContactImpl& impl = 
+            static_cast<TriangleMeshContactImpl&>(contact.updImpl());
+        impl.nearLeafPairs = *leafPairs;
+        impl.X_S1S2Near    = X_M1M2_near;
+        impl.nearMargin    = margin;
     }
+    currentStatus = contact;
+    return true; // success
 }
 
 
@@ -1074,9 +1810,20 @@ bool ContactTracker::TriangleMeshTriangleMesh::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::TriangleMeshTriangleMesh::predictContact() not implemented yet."); 
-    return false; }
+{
+    SimTK_ASSERT
+       (   ContactGeometry::TriangleMesh::isInstance(surface1)
+        && ContactGeometry::TriangleMesh::isInstance(surface2),
+       "ContactTracker::TriangleMeshTriangleMesh::predictContact()");
+
+    return predictContactOnset
+       (MeshMeshSeparation
+            (ContactGeometry::TriangleMesh::getAs(surface1),
+             ContactGeometry::TriangleMesh::getAs(surface2)), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcReach(surface1),
+        X_GS2, V_GS2, A_GS2, calcReach(surface2),
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::TriangleMeshTriangleMesh::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -1086,9 +1833,9 @@ bool ContactTracker::TriangleMeshTriangleMesh::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::TriangleMeshTriangleMesh::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -1166,9 +1913,13 @@ bool ContactTracker::ConvexImplicitPair::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::ConvexImplicitPair::predictContact() not implemented yet."); 
-    return false; }
+{
+    return predictContactOnset
+       (ConvexPairSeparation(surface1, surface2), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcReach(surface1),
+        X_GS2, V_GS2, A_GS2, calcReach(surface2),
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::ConvexImplicitPair::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -1178,9 +1929,9 @@ bool ContactTracker::ConvexImplicitPair::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::ConvexImplicitPair::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
@@ -1260,9 +2011,13 @@ bool ContactTracker::GeneralImplicitPair::predictContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               predictedStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::GeneralImplicitPair::predictContact() not implemented yet."); 
-    return false; }
+{
+    return predictContactOnset
+       (BoundingSphereSeparation(surface1, surface2), priorStatus,
+        X_GS1, V_GS1, A_GS1, calcReach(surface1),
+        X_GS2, V_GS2, A_GS2, calcReach(surface2),
+        cutoff, intervalOfInterest, predictedStatus);
+}
 
 bool ContactTracker::GeneralImplicitPair::initializeContact
    (const Transform& X_GS1, const SpatialVec& V_GS1,
@@ -1272,9 +2027,9 @@ bool ContactTracker::GeneralImplicitPair::initializeContact
     Real                   cutoff,
     Real                   intervalOfInterest,
     Contact&               contactStatus) const
-{   SimTK_ASSERT_ALWAYS(!"implemented",
-    "ContactTracker::GeneralImplicitPair::initializeContact() not implemented yet."); 
-    return false; }
+{   return initializeByTrackingThenPredicting
+       (*this, X_GS1, V_GS1, surface1, X_GS2, V_GS2, surface2,
+        cutoff, intervalOfInterest, contactStatus); }
 
 
 
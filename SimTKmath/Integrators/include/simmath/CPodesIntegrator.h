@@ -74,6 +74,31 @@ public:
      * again with a larger value will fail.
      */
     void setOrderLimit(int order);
+    /**
+     * By default, each Newton iteration solves its linear system with a dense LU factorization of the
+     * iteration matrix, whose Jacobian CPODES forms by finite differences at a cost of one System
+     * realization per state variable.  Invoking this method tells the integrator instead to use the
+     * matrix-free GMRES solver that comes with CPODES (cpodes_spgmr), supplied with the
+     * Jacobian-vector products it needs by System::calcYDotJacobianTimesVector().  A MultibodySystem
+     * forms those from its N and M^-1 operators plus one Dynamics-stage realization, without solving
+     * the forward dynamics again; for Systems that can't, each product is a difference quotient of the
+     * System's derivatives.  No Jacobian is ever formed or factored, so for large stiff systems this replaces
+     * an O(n) realizations plus O(n^3) factorization per Jacobian update with a few realizations per
+     * Newton iteration.  That only pays off for large systems: on the stiff pin chain in SimbodyBenchmark
+     * the two solvers break even at about 100 mobilities, the dense solver is more than twice as fast at
+     * 10, and the Krylov solver is faster from about 200 on.  This is why the dense solver is the
+     * default.  The Krylov solver is also a poor choice for systems whose Jacobian is badly conditioned
+     * enough that GMRES needs many iterations without a preconditioner.
+     *
+     * This method must be invoked before the integrator is initialized, and has no effect when
+     * functional iteration is being used.  Invoking it after initialization will produce an exception.
+     */
+    void setUseKrylovLinearSolver(bool useKrylov=true);
+    /**
+     * Get the number of GMRES iterations performed since the last call to resetAllStatistics() or
+     * initialize().  This is always zero unless setUseKrylovLinearSolver() was used.
+     */
+    int getNumLinearSolverIterations() const;
 };
 
 } // namespace SimTK
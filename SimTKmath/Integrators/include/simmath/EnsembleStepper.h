@@ -0,0 +1,174 @@
+#ifndef SimTK_SIMMATH_ENSEMBLE_STEPPER_H_
+#define SimTK_SIMMATH_ENSEMBLE_STEPPER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+#include "simmath/TimeStepper.h"
+
+namespace SimTK {
+
+/**
+ * This class advances many independent replicas of the same System through time concurrently.
+ * Each replica has its own State, Integrator, and TimeStepper; the System itself is shared.
+ * For example:
+ *
+ * <pre>
+ * EnsembleStepper ensemble(system);
+ * for (int i = 0; i < numReplicas; ++i) {
+ *     RungeKuttaMersonIntegrator* integ = new RungeKuttaMersonIntegrator(system);
+ *     integ->setAccuracy(1e-4);
+ *     ensemble.addReplica(integ, initialStates[i]);
+ * }
+ * ensemble.setReporter(new MyReporter());
+ * ensemble.setReportInterval(0.1);
+ * ensemble.stepTo(finalTime);
+ * </pre>
+ *
+ * stepTo() divides the replicas among the threads of a WorkStealingExecutor, and each replica is
+ * advanced all the way to the requested time (stopping at each report time along the way) without
+ * waiting for the others, so replicas that take different amounts of work are balanced
+ * automatically.  Because replicas never share anything except the System, the trajectory of each
+ * replica is identical to what it would be if it were integrated by itself with a TimeStepper,
+ * regardless of the number of threads.
+ *
+ * This relies on the thread safety guarantees documented for System: once the System's topology
+ * has been realized, it may be realized concurrently for distinct States.  Since the System is
+ * shared, the event handlers and reporters attached to it, and any user-written force elements
+ * or Functions it uses, will be called concurrently for different replicas and must not modify
+ * any shared data.  The Reporter set with setReporter() is called the same way.
+ *
+ * If an exception is thrown while a replica is being advanced, that replica is marked as failed
+ * (see hasFailed() and getFailureMessage()) and is not advanced any further; the other replicas
+ * are not affected.
+ */
+class SimTK_SIMMATH_EXPORT EnsembleStepper {
+public:
+    class Reporter;
+    /**
+     * Create an EnsembleStepper with no replicas.
+     *
+     * @param system      the System whose replicas will be advanced.  Its topology must already
+     *                    have been realized, and it must not be modified while this object exists.
+     * @param numThreads  the number of threads to use.  By default, this is set equal to the
+     *                    number of processors.
+     */
+    explicit EnsembleStepper(const System& system, 
+                             int numThreads = ParallelExecutor::getNumProcessors());
+    ~EnsembleStepper();
+    /**
+     * Add a replica.  The EnsembleStepper takes over ownership of the Integrator, which must
+     * have been created for the same System and will be deleted when the EnsembleStepper is.
+     * A TimeStepper is created for it and initialized with a copy of the specified State.
+     *
+     * @return the index of the new replica
+     */
+    int addReplica(Integrator* integrator, const State& initState);
+    /**
+     * Get the number of replicas.
+     */
+    int getNumReplicas() const;
+    /**
+     * Get the number of threads used to advance the replicas.
+     */
+    int getNumThreads() const;
+    /**
+     * Get the current State of a replica.
+     */
+    const State& getState(int replica) const;
+    /**
+     * Get the Integrator being used to advance a replica.
+     */
+    const Integrator& getIntegrator(int replica) const;
+    /**
+     * Get a non-const reference to the Integrator being used to advance a replica.
+     */
+    Integrator& updIntegrator(int replica);
+    /**
+     * Get whether an exception was thrown while advancing a replica, so that it will not
+     * be advanced any further.
+     */
+    bool hasFailed(int replica) const;
+    /**
+     * Get the message from the exception that caused a replica to fail, or an empty string
+     * if it has not failed.
+     */
+    const String& getFailureMessage(int replica) const;
+    /**
+     * Get the number of replicas that have failed.
+     */
+    int getNumFailedReplicas() const;
+    /**
+     * Set the object to invoke whenever a replica reaches a report time.  The EnsembleStepper
+     * takes over ownership of it, and deletes any Reporter that was previously set.  Pass 0 to
+     * remove the current Reporter.
+     */
+    void setReporter(Reporter* reporter);
+    /**
+     * Set the interval between reports.  Each replica is stopped and reported at every multiple of
+     * this interval, and also when stepTo() returns.  If this is zero (the default), replicas are
+     * only reported when stepTo() returns.
+     */
+    void setReportInterval(Real interval);
+    /**
+     * Get the interval between reports.
+     */
+    Real getReportInterval() const;
+    /**
+     * Advance every replica that has not failed, and whose simulation is not over, up to the
+     * specified time.  This returns once all of them have reached it.
+     */
+    void stepTo(Real time);
+private:
+    class EnsembleStepperRep* rep;
+    friend class EnsembleStepperRep;
+
+    // suppress
+    EnsembleStepper(const EnsembleStepper&);
+    EnsembleStepper& operator=(const EnsembleStepper&);
+};
+
+/**
+ * An EnsembleStepper::Reporter is invoked for each replica at each report time.  handleReport()
+ * is called from worker threads, concurrently for different replicas, so it must be thread safe;
+ * it is never called concurrently for the same replica, and the calls for a single replica are
+ * always in order of increasing time.
+ */
+class SimTK_SIMMATH_EXPORT EnsembleStepper::Reporter {
+public:
+    virtual ~Reporter() {}
+    /**
+     * This is called when a replica reaches a report time.
+     *
+     * @param replica  the index of the replica
+     * @param state    the replica's current State, which has been realized through Stage::Report
+     */
+    virtual void handleReport(int replica, const State& state) = 0;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_ENSEMBLE_STEPPER_H_
@@ -69,7 +69,12 @@ public:
     virtual void errorHandler(int error_code, const char* module,
                               const char* function, char* msg) const;
 
-    //TODO: Jacobian functions
+    // Calculate Jv = J*v where J=df/dy is the Jacobian of the explicit ODE
+    // at (t,y), and fy=f(t,y) is supplied. This is used by the Krylov linear
+    // solvers; see spilsSetJacTimesVecFn().
+    virtual int  jacobianTimesVector(Real t, const Vector& y, 
+                                     const Vector& fy, const Vector& v,
+                                     Vector& Jv) const;
 };
 
 
@@ -111,6 +116,12 @@ static void errorHandler_static(const CPodesSystem& sys,
                                 const char* function, char* msg)
   { sys.errorHandler(error_code,module,function,msg); }
 
+static int jacobianTimesVector_static(const CPodesSystem& sys, 
+                                      Real t, const Vector& y, 
+                                      const Vector& fy, const Vector& v,
+                                      Vector& Jv)
+  { return sys.jacobianTimesVector(t,y,fy,v,Jv); }
+
 /**
  * This is a straightforward translation of the Sundials CPODES C 
  * interface into C++. The class CPodes represents a single instance
@@ -253,6 +264,11 @@ public:
     int dlsSetJacFn(void* jac, void* jac_data);
     int dlsProjSetJacFn(void* jacP, void* jacP_data);
 
+    // This tells CPodes to make use of the user's jacobianTimesVector()
+    // method from CPodesSystem when using a Krylov linear solver, instead
+    // of approximating J*v by a difference quotient.
+    int spilsSetJacTimesVecFn();
+
 
     int step(Real tout, Real* tret, 
              Vector& y_inout, Vector& yp_inout, StepMode=Normal);
@@ -342,6 +358,15 @@ public:
     int lapackBand(int N, int mupper, int mlower);
     int lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType);
 
+    // Use the scaled, preconditioned GMRES Krylov solver for the linear
+    // systems in the Newton iteration, without a preconditioner. maxl is
+    // the maximum Krylov subspace dimension; 0 means the CPODES default (5).
+    int spgmr(int maxl);
+    int spilsSetMaxl(int maxl);
+    int spilsGetNumLinIters(int* nliters);
+    int spilsGetNumConvFails(int* nlcfails);
+    int spilsGetNumJtimesEvals(int* njvevals);
+
 private:
     // This is how we get the client-side virtual functions to
     // be callable from library-side code while maintaining binary
@@ -366,6 +391,9 @@ private:
     typedef void (*ErrorHandlerFunc)(const CPodesSystem&, 
                                      int error_code, const char* module, 
                                      const char* function, char* msg);
+    typedef int (*JacTimesVecFunc)(const CPodesSystem&, 
+                                   Real t, const Vector& y, const Vector& fy,
+                                   const Vector& v, Vector& Jv);
 
     // Note that these routines do not tell CPodes to use the supplied
     // functions. They merely provide the client-side addresses of functions
@@ -383,6 +411,7 @@ private:
     void registerRootFunc(RootFunc);
     void registerWeightFunc(WeightFunc);
     void registerErrorHandlerFunc(ErrorHandlerFunc);
+    void registerJacTimesVecFunc(JacTimesVecFunc);
 
 
     // This is the library-side part of the CPodes constructor. This must
@@ -401,6 +430,7 @@ private:
         registerRootFunc(root_static);
         registerWeightFunc(weight_static);
         registerErrorHandlerFunc(errorHandler_static);
+        registerJacTimesVecFunc(jacobianTimesVector_static);
     }
 
     // FOR INTERNAL USE ONLY
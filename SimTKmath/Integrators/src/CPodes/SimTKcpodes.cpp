@@ -30,6 +30,7 @@
 #include "nvector_SimTK.h"
 #include "cpodes/cpodes.h"
 #include "cpodes/cpodes_dense.h"
+#include "cpodes/cpodes_spgmr.h"
 #include "cpodes/cpodes_lapack_exports.h"
 
 #include <limits>
@@ -66,6 +67,7 @@ public:
     CPodes::RootFunc            rootFunc;
     CPodes::WeightFunc          weightFunc;
     CPodes::ErrorHandlerFunc    errorHandlerFunc;
+    CPodes::JacTimesVecFunc     jacTimesVecFunc;
 
     void zeroFunctionPointers() {
         explicitODEFunc  = 0;
@@ -76,6 +78,7 @@ public:
         rootFunc         = 0;
         weightFunc       = 0;
         errorHandlerFunc = 0;
+        jacTimesVecFunc  = 0;
     }
 
     void setMyHandle(CPodes& cp) {myHandle = &cp;}
@@ -183,6 +186,18 @@ static void errorHandlerWrapper(int error_code,
     return rep.errorHandlerFunc(rep.getCPodesSystem(), error_code,module,function,msg);
 }
 
+static int jacTimesVecWrapper(realtype t, N_Vector nv_y, N_Vector nv_fy,
+                              N_Vector nv_v, N_Vector nv_Jv, void* jac_data,
+                              N_Vector)
+{
+    const Vector& y    = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy   = N_Vector_SimTK::getVector(nv_fy);
+    const Vector& v    = N_Vector_SimTK::getVector(nv_v);
+    Vector&       Jv   = N_Vector_SimTK::updVector(nv_Jv);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(jac_data);
+    return rep.jacTimesVecFunc(rep.getCPodesSystem(), t, y, fy, v, Jv);
+}
+
 ////////////////////////////////////////
 // CLASS SimTK::CPodes IMPLEMENTATION //
 ////////////////////////////////////////
@@ -681,6 +696,35 @@ int CPodes::lapackDenseProj(int Nc, int Ny, ProjectionFactorizationType fact_typ
         mapProjectionFactorizationType(fact_type));
 }
 
+int CPodes::spgmr(int maxl) {
+    return CPSpgmr(updRep().cpode_mem,PREC_NONE,maxl);
+}
+int CPodes::spilsSetMaxl(int maxl) {
+    return CPSpilsSetMaxl(updRep().cpode_mem,maxl);
+}
+int CPodes::spilsSetJacTimesVecFn() {
+    return CPSpilsSetJacTimesVecFn(updRep().cpode_mem, 
+                                   (void*)jacTimesVecWrapper, (void*)rep);
+}
+int CPodes::spilsGetNumLinIters(int* nliters) {
+    long lnliters;
+    int stat = CPSpilsGetNumLinIters(updRep().cpode_mem,&lnliters);
+    *nliters = (int)lnliters;
+    return stat;
+}
+int CPodes::spilsGetNumConvFails(int* nlcfails) {
+    long lnlcfails;
+    int stat = CPSpilsGetNumConvFails(updRep().cpode_mem,&lnlcfails);
+    *nlcfails = (int)lnlcfails;
+    return stat;
+}
+int CPodes::spilsGetNumJtimesEvals(int* njvevals) {
+    long lnjvevals;
+    int stat = CPSpilsGetNumJtimesEvals(updRep().cpode_mem,&lnjvevals);
+    *njvevals = (int)lnjvevals;
+    return stat;
+}
+
 
 
 // Client-side function registration
@@ -708,6 +752,9 @@ void CPodes::registerWeightFunc(CPodes::WeightFunc f) {
 void CPodes::registerErrorHandlerFunc(CPodes::ErrorHandlerFunc f) {
     updRep().errorHandlerFunc = f;
 }
+void CPodes::registerJacTimesVecFunc(CPodes::JacTimesVecFunc f) {
+    updRep().jacTimesVecFunc = f;
+}
 
 /////////////////////////////////
 // CPodesSystem IMPLEMENTATION //
@@ -757,6 +804,12 @@ void CPodesSystem::errorHandler(int, const char*, const char*, char*) const {
     SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "errorHandler"); 
 }
 
+int CPodesSystem::jacobianTimesVector(Real, const Vector&, const Vector&, 
+                                      const Vector&, Vector&) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "jacobianTimesVector"); 
+    return std::numeric_limits<int>::min();
+}
+
 } // namespace SimTK
 
 
@@ -55,6 +55,17 @@ void CPodesIntegrator::setOrderLimit(int order) {
     cprep.setOrderLimit(order);
 }
 
+void CPodesIntegrator::setUseKrylovLinearSolver(bool useKrylov) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setUseKrylovLinearSolver(useKrylov);
+}
+
+int CPodesIntegrator::getNumLinearSolverIterations() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getNumLinearSolverIterations();
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -128,9 +139,42 @@ public:
         gout = integ.getAdvancedState().getEventTriggers();
         return CPodes::Success;
     }
+
+    // Calculate Jv = (df/dy)*v for the Krylov linear solver, where fy=f(t,y)
+    // has already been calculated. We use the increment CPODES would use for 
+    // its own difference quotient: sig = 1/||v||_wrms so that the perturbation
+    // sig*v has unit weighted norm. The System calculates the product if it
+    // knows how; otherwise we take the difference quotient here.
+    int jacobianTimesVector(Real t, const Vector& y, const Vector& fy, 
+                            const Vector& v, Vector& Jv) const 
+    {
+        const int ny = y.size();
+        integ.cpodes->getErrWeights(ewt);
+        Real sumsq = 0;
+        for (int i=0; i < ny; ++i)
+            sumsq += square(v[i]*ewt[i]);
+        if (sumsq == 0) {
+            Jv.resize(ny); Jv = 0;
+            return CPodes::Success;
+        }
+        const Real sig = 1/std::sqrt(sumsq/ny);
+        try {
+            integ.setAdvancedStateAndRealizeKinematics(t,y);
+            if (system.calcYDotJacobianTimesVector
+                    (integ.updAdvancedState(), fy, v, sig, Jv))
+                return CPodes::Success;
+            ytmp = y + sig*v;
+            integ.setAdvancedStateAndRealizeDerivatives(t,ytmp);
+        }
+        catch(...) { return CPodes::RecoverableError; } // assume recoverable
+        Jv = (integ.getAdvancedState().getYDot() - fy) / sig;
+        return CPodes::Success;
+    }
 private:
     CPodesIntegratorRep& integ;
     const System& system;
+    // Workspace for jacobianTimesVector(), kept to avoid reallocation.
+    mutable Vector ewt, ytmp;
 };
 
 void CPodesIntegratorRep::init
@@ -141,6 +185,7 @@ void CPodesIntegratorRep::init
     cps = new CPodesSystemImpl(*this, getSystem());
     initialized = false;
     useCpodesProjection = false;
+    useKrylovLinearSolver = false;
 }
 
 CPodesIntegratorRep::CPodesIntegratorRep
@@ -167,10 +212,10 @@ void CPodesIntegratorRep::methodInitialize(const State& state) {
     if (state.getSystemStage() < Stage::Model)
         reconstructForNewModel();
     initializeIntegrationParameters();
+    resetMethodStatistics(); // before the linear solver has been attached
     initialized = true;
     pendingReturnCode = -1;
     previousStartTime = 0.0;
-    resetMethodStatistics();
     getSystem().realize(state, Stage::Velocity);
     const int ny = state.getY().size();
     const int nc = state.getNYErr();
@@ -193,7 +238,13 @@ void CPodesIntegratorRep::methodInitialize(const State& state) {
         printf("init() returned %d\n", retval);
         SimTK_THROW1(Integrator::InitializationFailed, "init() failed");
     }
-    cpodes->lapackDense(ny);
+    if (useKrylovLinearSolver) {
+        cpodes->spgmr(0); // default maximum Krylov subspace dimension
+        cpodes->spilsSetJacTimesVecFn();
+        statsLinIterBase = 0; // spgmr() started a new count
+    }
+    else
+        cpodes->lapackDense(ny);
     cpodes->setNonlinConvCoef(0.01); // TODO (default is 0.1)
     if (useCpodesProjection) {
         const int nqerr = state.getNQErr(), nuerr = state.getNUErr();
@@ -618,6 +669,11 @@ void CPodesIntegratorRep::resetMethodStatistics() {
     statsErrorTestFailures = 0;
     statsConvergenceTestFailures = 0;
     statsIterations = 0;
+    statsLinIterBase = 0;
+    int nliters;
+    if (initialized && useKrylovLinearSolver
+        && cpodes->spilsGetNumLinIters(&nliters) == CPodes::Success)
+        statsLinIterBase = nliters;
 }
 
 const char* CPodesIntegratorRep::getMethodName() const {
@@ -643,6 +699,22 @@ void CPodesIntegratorRep::setUseCPodesProjection() {
     useCpodesProjection = true;
 }
 
+void CPodesIntegratorRep::setUseKrylovLinearSolver(bool useKrylov) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setUseKrylovLinearSolver",
+        "This method may not be invoked after the integrator has been initialized.");
+    useKrylovLinearSolver = useKrylov;
+}
+
+int CPodesIntegratorRep::getNumLinearSolverIterations() const {
+    if (!initialized || !useKrylovLinearSolver)
+        return 0;
+    int nliters;
+    if (cpodes->spilsGetNumLinIters(&nliters) != CPodes::Success)
+        return 0;
+    return nliters - statsLinIterBase;
+}
+
 void CPodesIntegratorRep::setOrderLimit(int order) {
     cpodes->setMaxOrd(order);
 }
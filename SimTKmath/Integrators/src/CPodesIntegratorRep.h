@@ -64,14 +64,18 @@ public:
     bool methodHasErrorControl() const;
     void setUseCPodesProjection();
     void setOrderLimit(int order);
+    void setUseKrylovLinearSolver(bool useKrylov);
+    int getNumLinearSolverIterations() const;
     class CPodesSystemImpl;
     friend class CPodesSystemImpl;
 private:
     CPodes* cpodes;
     CPodesSystemImpl* cps;
-    bool initialized, useCpodesProjection;
+    bool initialized, useCpodesProjection, useKrylovLinearSolver;
     int statsStepsTaken, statsErrorTestFailures, statsConvergenceTestFailures;
     int statsIterations;
+    // CPodes' cumulative GMRES iteration count at the last statistics reset.
+    int statsLinIterBase;
     int pendingReturnCode;
     Real previousStartTime, previousTimeReturned;
     Vector savedY;
@@ -0,0 +1,235 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the Simmath
+ * EnsembleStepper class.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/EnsembleStepper.h"
+
+#include <cmath>
+#include <exception>
+
+namespace SimTK {
+
+    ////////////////////////////////
+    // CLASS ENSEMBLE STEPPER REP //
+    ////////////////////////////////
+
+class EnsembleStepperRep {
+public:
+    // Everything belonging to one replica. Only the thread that is advancing
+    // a replica touches its Replica object during stepTo().
+    struct Replica {
+        Replica(Integrator* integ, const System& system) 
+        :   integ(integ), stepper(system, *integ), failed(false), 
+            lastReportTime(-Infinity) {}
+        ~Replica() {delete integ;}
+
+        Integrator* integ;
+        TimeStepper stepper;
+        bool        failed;
+        String      failureMessage;
+        Real        lastReportTime;
+    };
+
+    EnsembleStepperRep(const System& system, int numThreads)
+    :   system(system), executor(numThreads), reporter(0), reportInterval(0) {}
+
+    ~EnsembleStepperRep() {
+        for (int i = 0; i < (int) replicas.size(); ++i)
+            delete replicas[i];
+        delete reporter;
+    }
+
+    const Replica& getReplica(int replica) const {
+        SimTK_INDEXCHECK_ALWAYS(replica, (int) replicas.size(), 
+                                "EnsembleStepper::getReplica()");
+        return *replicas[replica];
+    }
+    Replica& updReplica(int replica) {
+        return const_cast<Replica&>(getReplica(replica));
+    }
+
+    // Advance one replica to the given time, stopping at each report time.
+    // This is called concurrently for different replicas.
+    void advanceReplica(int index, Real finalTime);
+    // Invoke the Reporter unless this replica was already reported at its
+    // current time.
+    void reportReplica(int index);
+
+    class StepTask;
+
+    const System&           system;
+    Array_<Replica*>        replicas;
+    WorkStealingExecutor    executor;
+    EnsembleStepper::Reporter* reporter;
+    Real                    reportInterval;
+};
+
+class EnsembleStepperRep::StepTask : public ParallelExecutor::Task {
+public:
+    StepTask(EnsembleStepperRep& rep, Real finalTime) 
+    :   rep(rep), finalTime(finalTime) {}
+    void execute(int index) {
+        rep.advanceReplica(index, finalTime);
+    }
+private:
+    EnsembleStepperRep& rep;
+    const Real finalTime;
+};
+
+void EnsembleStepperRep::advanceReplica(int index, Real finalTime) {
+    Replica& replica = *replicas[index];
+    if (replica.failed)
+        return;
+    try {
+        while (!replica.integ->isSimulationOver() 
+               && replica.stepper.getTime() < finalTime) 
+        {
+            // Stop at the next multiple of the report interval, if any.
+            Real target = finalTime;
+            if (reportInterval > 0) {
+                const Real t = replica.stepper.getTime();
+                const Real next = reportInterval 
+                    * (std::floor(t/reportInterval + SignificantReal) + 1);
+                target = std::min(next, finalTime);
+            }
+            replica.stepper.stepTo(target);
+            reportReplica(index);
+        }
+    }
+    catch (const std::exception& e) {
+        replica.failed = true;
+        replica.failureMessage = e.what();
+    }
+    catch (...) {
+        replica.failed = true;
+        replica.failureMessage = "Unknown exception.";
+    }
+}
+
+void EnsembleStepperRep::reportReplica(int index) {
+    Replica& replica = *replicas[index];
+    const State& state = replica.stepper.getState();
+    if (state.getTime() <= replica.lastReportTime)
+        return;
+    if (reporter) {
+        system.realize(state, Stage::Report);
+        reporter->handleReport(index, state);
+    }
+    replica.lastReportTime = state.getTime();
+}
+
+    ////////////////////////////////////////
+    // IMPLEMENTATION OF ENSEMBLE STEPPER //
+    ////////////////////////////////////////
+
+EnsembleStepper::EnsembleStepper(const System& system, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads > 0, "EnsembleStepper", 
+        "EnsembleStepper", "The number of threads must be positive but was %d.",
+        numThreads);
+    rep = new EnsembleStepperRep(system, numThreads);
+}
+
+EnsembleStepper::~EnsembleStepper() {
+    delete rep;
+}
+
+int EnsembleStepper::addReplica(Integrator* integrator, const State& initState) {
+    SimTK_APIARGCHECK_ALWAYS(integrator != 0, "EnsembleStepper", "addReplica",
+        "The Integrator must not be null.");
+    EnsembleStepperRep::Replica* replica = 
+        new EnsembleStepperRep::Replica(integrator, rep->system);
+    try {
+        replica->stepper.initialize(initState);
+    }
+    catch (...) {
+        delete replica;
+        throw;
+    }
+    rep->replicas.push_back(replica);
+    return (int) rep->replicas.size()-1;
+}
+
+int EnsembleStepper::getNumReplicas() const {
+    return (int) rep->replicas.size();
+}
+
+int EnsembleStepper::getNumThreads() const {
+    return rep->executor.getNumThreads();
+}
+
+const State& EnsembleStepper::getState(int replica) const {
+    return rep->getReplica(replica).stepper.getState();
+}
+
+const Integrator& EnsembleStepper::getIntegrator(int replica) const {
+    return *rep->getReplica(replica).integ;
+}
+
+Integrator& EnsembleStepper::updIntegrator(int replica) {
+    return *rep->updReplica(replica).integ;
+}
+
+bool EnsembleStepper::hasFailed(int replica) const {
+    return rep->getReplica(replica).failed;
+}
+
+const String& EnsembleStepper::getFailureMessage(int replica) const {
+    return rep->getReplica(replica).failureMessage;
+}
+
+int EnsembleStepper::getNumFailedReplicas() const {
+    int count = 0;
+    for (int i = 0; i < (int) rep->replicas.size(); ++i)
+        if (rep->replicas[i]->failed)
+            ++count;
+    return count;
+}
+
+void EnsembleStepper::setReporter(Reporter* reporter) {
+    if (reporter != rep->reporter)
+        delete rep->reporter;
+    rep->reporter = reporter;
+}
+
+void EnsembleStepper::setReportInterval(Real interval) {
+    SimTK_APIARGCHECK1_ALWAYS(interval >= 0, "EnsembleStepper", 
+        "setReportInterval", "The interval can't be negative but was %g.",
+        interval);
+    rep->reportInterval = interval;
+}
+
+Real EnsembleStepper::getReportInterval() const {
+    return rep->reportInterval;
+}
+
+void EnsembleStepper::stepTo(Real time) {
+    EnsembleStepperRep::StepTask task(*rep, time);
+    rep->executor.execute(task, (int) rep->replicas.size());
+}
+
+} // namespace SimTK
@@ -79,21 +79,37 @@ template <typename ELT>
 void FactorQTZ::inverse( Matrix_<ELT>& inverse ) const {
     rep->inverse( inverse );
 }
+// If the existing rep was created for a matrix of the same dimensions and 
+// element type, refactor in place so that the rep and its factorization 
+// arrays are reused rather than reallocated. (The LAPACK workspace and the
+// rank estimation temporaries are still allocated on each factorization.)
+template < class ELT >
+static bool refactorInPlace( FactorQTZRepBase* rep, const Matrix_<ELT>& m,
+                             typename CNT<ELT>::TReal rcond ) {
+    typedef FactorQTZRep<typename CNT<ELT>::StdNumber> Rep;
+    Rep* typedRep = dynamic_cast<Rep*>(rep);
+    return typedRep && typedRep->refactor(m, rcond);
+}
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m ){
-    delete rep;
-  
     // if user does not supply rcond set it to max(nRow,nCol)*(eps)^7/8 (similar to matlab)
     int mnmax = (m.nrow() > m.ncol()) ? m.nrow() : m.ncol();
-    rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant());
+    const typename CNT<ELT>::TReal rcond = 
+        mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant();
+    if (refactorInPlace(rep, m, rcond)) return;
+
+    delete rep;
+    rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, rcond);
 }
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m, double rcond ){
+    if (refactorInPlace(rep, m, (typename CNT<ELT>::TReal)rcond)) return;
     delete rep;
     rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, rcond );
 }
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m, float rcond ){
+    if (refactorInPlace(rep, m, (typename CNT<ELT>::TReal)rcond)) return;
     delete rep;
     rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, rcond );
 }
@@ -172,6 +188,24 @@ FactorQTZRep<T>::FactorQTZRep( const Matrix_<ELT>& mat, typename CNT<T>::TReal r
     isFactored = true;
 }
 
+template <typename T >
+    template < typename ELT >
+bool FactorQTZRep<T>::refactor( const Matrix_<ELT>& mat, typename CNT<T>::TReal rc) {
+    if (mat.nrow() != nRow || mat.ncol() != nCol || mat.nelt() == 0)
+        return false;
+
+    isFactored = false;
+    scaleLinSys = false;
+    linSysScaleF = NTraits<typename CNT<T>::Precision>::getNaN();
+    anrm = NTraits<typename CNT<T>::Precision>::getNaN();
+    rcond = rc;
+    for(int i=0; i<nCol; ++i) 
+        pivots.data[i] = 0;
+    FactorQTZRep<T>::factor( mat );
+    isFactored = true;
+    return true;
+}
+
 template <typename T >
 FactorQTZRepBase* FactorQTZRep<T>::clone() const {
    return( new FactorQTZRep<T>(*this) );
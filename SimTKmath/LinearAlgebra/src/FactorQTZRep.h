@@ -123,6 +123,10 @@ public:
    ~FactorQTZRep();
 
    template < class ELT > void factor(const Matrix_<ELT>& ); 
+   // Factor a new matrix into the existing storage. Returns false without
+   // doing anything if the matrix isn't the same size as the one this was 
+   // created for; then a new rep is needed.
+   template < class ELT > bool refactor(const Matrix_<ELT>&, typename CNT<T>::TReal );
    void inverse( Matrix_<T>& ) const; 
    void solve( const Vector_<T>& b, Vector_<T>& x ) const;
    void solve( const Matrix_<T>& b, Matrix_<T>& x ) const;
@@ -50,6 +50,7 @@
 #include "simmath/Optimizer.h"
 #include "simmath/Integrator.h"
 #include "simmath/TimeStepper.h"
+#include "simmath/EnsembleStepper.h"
 #include "simmath/CPodesIntegrator.h"
 #include "simmath/RungeKuttaMersonIntegrator.h"
 #include "simmath/RungeKuttaFeldbergIntegrator.h"
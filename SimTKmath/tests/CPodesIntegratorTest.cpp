@@ -71,6 +71,19 @@ int main () {
         CPodesIntegrator projInteg(sys, CPodes::BDF);
         projInteg.setUseCPodesProjection();
         testIntegrator(projInteg, sys);
+        
+        // Use the matrix-free Krylov linear solver instead of dense LU.
+        
+        CPodesIntegrator krylovInteg(sys, CPodes::BDF);
+        krylovInteg.setUseKrylovLinearSolver();
+        testIntegrator(krylovInteg, sys);
+        assert(krylovInteg.getNumLinearSolverIterations() > 0);
+        try {
+            krylovInteg.setUseKrylovLinearSolver(false);
+            assert(false);
+        }
+        catch (...) {
+        }
     }
     cout << "Done" << endl;
     return 0;
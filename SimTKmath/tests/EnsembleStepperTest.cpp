@@ -0,0 +1,157 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "PendulumSystem.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const int NumReplicas = 12;
+const Real ReportInterval = 0.5;
+
+// Each replica starts from a different angle.
+static State makeInitialState(const PendulumSystem& sys, int replica) {
+    State state = sys.getDefaultState();
+    const Real angle = 0.2 + 0.1*replica;
+    state.updQ()[0] = std::sin(angle);
+    state.updQ()[1] = -std::cos(angle);
+    state.updU() = 0;
+    return state;
+}
+
+static Integrator* makeIntegrator(const PendulumSystem& sys) {
+    Integrator* integ = new RungeKuttaMersonIntegrator(sys);
+    integ->setAccuracy(1e-6);
+    integ->setConstraintTolerance(1e-6);
+    return integ;
+}
+
+// Records every report time. Each replica has its own slot, so no locking
+// is needed.
+class RecordingReporter : public EnsembleStepper::Reporter {
+public:
+    RecordingReporter(Array_< Array_<Real> >& times, int failingReplica=-1) 
+    :   times(times), failingReplica(failingReplica) {}
+    void handleReport(int replica, const State& state) {
+        SimTK_TEST(state.getSystemStage() >= Stage::Report);
+        times[replica].push_back(state.getTime());
+        if (replica == failingReplica && state.getTime() > 1)
+            throw std::runtime_error("Deliberate failure");
+    }
+private:
+    Array_< Array_<Real> >& times;
+    const int failingReplica;
+};
+
+// The replicas must follow exactly the trajectories they would if each were
+// integrated by itself.
+void testMatchesSerial() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    sys.setDefaultMass(10);
+    sys.setDefaultLength(1);
+
+    EnsembleStepper ensemble(sys, 4);
+    SimTK_TEST(ensemble.getNumThreads() == 4);
+    Array_< Array_<Real> > times(NumReplicas);
+    ensemble.setReporter(new RecordingReporter(times));
+    ensemble.setReportInterval(ReportInterval);
+    SimTK_TEST(ensemble.getReportInterval() == ReportInterval);
+    for (int i = 0; i < NumReplicas; ++i)
+        SimTK_TEST(ensemble.addReplica(makeIntegrator(sys), 
+                                       makeInitialState(sys, i)) == i);
+    SimTK_TEST(ensemble.getNumReplicas() == NumReplicas);
+    ensemble.stepTo(3.0);
+    ensemble.stepTo(3.2);
+
+    for (int i = 0; i < NumReplicas; ++i) {
+        SimTK_TEST(!ensemble.hasFailed(i));
+        SimTK_TEST(ensemble.getState(i).getTime() == 3.2);
+
+        SimTK_TEST(times[i].size() == 7);
+        for (int j = 0; j < 6; ++j)
+            SimTK_TEST_EQ(times[i][j], (j+1)*ReportInterval);
+        SimTK_TEST(times[i][6] == 3.2);
+
+        Integrator* integ = makeIntegrator(sys);
+        TimeStepper ts(sys, *integ);
+        ts.initialize(makeInitialState(sys, i));
+        for (int j = 0; j < 6; ++j)
+            ts.stepTo((j+1)*ReportInterval);
+        ts.stepTo(3.2);
+        const Vector& y = ensemble.getState(i).getY();
+        const Vector& yRef = ts.getState().getY();
+        for (int k = 0; k < y.size(); ++k)
+            SimTK_TEST(y[k] == yRef[k]);
+        SimTK_TEST(ensemble.getIntegrator(i).getNumStepsTaken() 
+                   == integ->getNumStepsTaken());
+        delete integ;
+    }
+    SimTK_TEST_MUST_THROW(ensemble.getState(NumReplicas));
+    SimTK_TEST_MUST_THROW(ensemble.setReportInterval(-1));
+}
+
+// An exception while advancing one replica must not affect the others.
+void testFailure() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    sys.setDefaultMass(10);
+    sys.setDefaultLength(1);
+
+    const int failing = 5;
+    EnsembleStepper ensemble(sys, 3);
+    Array_< Array_<Real> > times(NumReplicas);
+    ensemble.setReporter(new RecordingReporter(times, failing));
+    ensemble.setReportInterval(ReportInterval);
+    for (int i = 0; i < NumReplicas; ++i)
+        ensemble.addReplica(makeIntegrator(sys), makeInitialState(sys, i));
+    ensemble.stepTo(2.0);
+    SimTK_TEST(ensemble.getNumFailedReplicas() == 1);
+    SimTK_TEST(ensemble.hasFailed(failing));
+    SimTK_TEST(ensemble.getFailureMessage(failing) == "Deliberate failure");
+    SimTK_TEST(ensemble.getState(failing).getTime() == 1.5);
+
+    // The failed replica is left where it was.
+    ensemble.stepTo(3.0);
+    SimTK_TEST(ensemble.getState(failing).getTime() == 1.5);
+    for (int i = 0; i < NumReplicas; ++i) {
+        if (i == failing)
+            continue;
+        SimTK_TEST(!ensemble.hasFailed(i));
+        SimTK_TEST(ensemble.getFailureMessage(i).empty());
+        SimTK_TEST(ensemble.getState(i).getTime() == 3.0);
+        SimTK_TEST(times[i].size() == 6);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("EnsembleStepperTest");
+        SimTK_SUBTEST(testMatchesSerial);
+        SimTK_SUBTEST(testFailure);
+    SimTK_END_TEST();
+}
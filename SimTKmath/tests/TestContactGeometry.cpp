@@ -161,11 +161,109 @@ void testEllipsoid() {
     }
 }
 
+// A few points in a thousand, mostly close to a symmetry plane, get a
+// polynomial root that is slightly off. findNearestPoint() must refine it so
+// that every result lies on the surface.
+void testEllipsoidNearestPointAccuracy() {
+    Vec3 radii(1.5, 2.2, 3.1);
+    ContactGeometry::Ellipsoid ellipsoid(radii);
+    Random::Gaussian random(0, 2);
+    for (int i = 0; i < 10000; i++) {
+        Vec3 pos(random.getValue(), random.getValue(), random.getValue());
+        bool inside;
+        UnitVec3 normal;
+        Vec3 nearest = ellipsoid.findNearestPoint(pos, inside, normal);
+        assertEqual(nearest[0]*nearest[0]/(radii[0]*radii[0])+nearest[1]*nearest[1]/(radii[1]*radii[1])+nearest[2]*nearest[2]/(radii[2]*radii[2]), 1.0);
+        assertEqual(normal, UnitVec3(nearest[0]/(radii[0]*radii[0]), nearest[1]/(radii[1]*radii[1]), nearest[2]/(radii[2]*radii[2])));
+    }
+}
+
+// A point inside the ellipsoid on the symmetry plane of the shortest axis
+// whose nearest point is off that plane, and points very close to it.
+void testEllipsoidNearestPointNearPlane() {
+    Vec3 radii(3, 2, 1);
+    ContactGeometry::Ellipsoid ellipsoid(radii);
+    const Real x = 9*0.5/8, y = 4*0.3/3;
+    const Vec3 offPlane(x, y, std::sqrt(1-x*x/9-y*y/4));
+    const Real offsets[] = {0, 1e-14, 1e-10, 1e-8, 1e-7, 1e-6, 1e-5, 1e-3};
+    for (int i = 0; i < 8; i++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            const Vec3 pos(0.5, 0.3, sign*offsets[i]);
+            bool inside;
+            UnitVec3 normal;
+            Vec3 nearest = ellipsoid.findNearestPoint(pos, inside, normal);
+            ASSERT(inside);
+            assertEqual(nearest[0]*nearest[0]/9+nearest[1]*nearest[1]/4+nearest[2]*nearest[2], 1.0);
+            assertEqual(normal, UnitVec3(nearest[0]/9, nearest[1]/4, nearest[2]));
+            ASSERT(((pos-nearest)%normal).norm() < TOL);
+            Vec3 mirror = offPlane;
+            if (pos[2] < 0)
+                mirror[2] = -mirror[2];
+            ASSERT((pos-nearest).norm() <= (pos-mirror).norm() + TOL);
+            if (offsets[i] <= 1e-7)
+                ASSERT((nearest-mirror).norm() < 1e-6);
+        }
+    }
+}
+
+// The batched nearest point query must give exactly the same answers as
+// calling findNearestPoint() one point at a time.
+void testBatchedNearestPoint(const ContactGeometry& geom) {
+    const int n = 50;
+    Random::Uniform random(-2.0, 2.0);
+    Vec3 positions[n], nearest[n];
+    bool inside[n];
+    UnitVec3 normals[n];
+    for (int i = 0; i < n; i++)
+        positions[i] = Vec3(random.getValue(), random.getValue(), random.getValue());
+    geom.findNearestPoints(n, positions, nearest, inside, normals);
+    for (int i = 0; i < n; i++) {
+        bool expectedInside;
+        UnitVec3 expectedNormal;
+        Vec3 expected = geom.findNearestPoint(positions[i], expectedInside, expectedNormal);
+        ASSERT(nearest[i] == expected);
+        ASSERT(inside[i] == expectedInside);
+        ASSERT(normals[i] == expectedNormal);
+    }
+}
+
+// Build an octahedron with vertices on the coordinate axes.
+ContactGeometry::TriangleMesh createOctahedron() {
+    vector<Vec3> vertices;
+    for (int axis = 0; axis < 3; axis++)
+        for (int sign = 1; sign >= -1; sign -= 2) {
+            Vec3 v(0);
+            v[axis] = sign;
+            vertices.push_back(v);
+        }
+    // Vertex 2*axis is on the positive axis, 2*axis+1 on the negative one.
+    vector<int> faceIndices;
+    for (int sx = 0; sx < 2; sx++)
+        for (int sy = 0; sy < 2; sy++)
+            for (int sz = 0; sz < 2; sz++) {
+                int face[3] = {sx, 2+sy, 4+sz};
+                if ((sx+sy+sz)%2 == 1)
+                    std::swap(face[1], face[2]);
+                faceIndices.insert(faceIndices.end(), face, face+3);
+            }
+    return ContactGeometry::TriangleMesh(vertices, faceIndices);
+}
+
+void testBatchedNearestPoints() {
+    testBatchedNearestPoint(ContactGeometry::HalfSpace());
+    testBatchedNearestPoint(ContactGeometry::Sphere(1.5));
+    testBatchedNearestPoint(ContactGeometry::Ellipsoid(Vec3(1, 2, 3)));
+    testBatchedNearestPoint(createOctahedron());
+}
+
 int main() {
     try {
         testHalfSpace();
         testSphere();
         testEllipsoid();
+        testEllipsoidNearestPointAccuracy();
+        testEllipsoidNearestPointNearPlane();
+        testBatchedNearestPoints();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -22,8 +22,13 @@
  * -------------------------------------------------------------------------- */
 
 #include "SimTKmath.h"
+#include <cstdio>
 #include <vector>
 #include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
 
 using namespace SimTK;
 using namespace std;
@@ -156,7 +161,7 @@ void addOctohedron(vector<Vec3>& vertices, vector<int>& faceIndices, Vec3 offset
 
 void validateOBBTree(const ContactGeometry::TriangleMesh& mesh, ContactGeometry::TriangleMesh::OBBTreeNode node, ContactGeometry::TriangleMesh::OBBTreeNode parent, vector<int>& faceReferenceCount) {
     if (node.isLeafNode()) {
-        const Array_<int>& triangles = node.getTriangles();
+        const ArrayViewConst_<int> triangles = node.getTriangles();
         SimTK_TEST(triangles.size() > 0);
         SimTK_TEST(triangles.size() == node.getNumTriangles());
         for (int i = 0; i < (int) triangles.size(); i++) {
@@ -201,6 +206,82 @@ void testOBBTree() {
         SimTK_TEST(faceReferenceCount[i] == 1);
 }
 
+void compareOBBTrees(ContactGeometry::TriangleMesh::OBBTreeNode node1, 
+                     ContactGeometry::TriangleMesh::OBBTreeNode node2) {
+    SimTK_TEST(node1.isLeafNode() == node2.isLeafNode());
+    SimTK_TEST(node1.getNumTriangles() == node2.getNumTriangles());
+    SimTK_TEST(node1.getBounds().getSize() == node2.getBounds().getSize());
+    SimTK_TEST(node1.getBounds().getTransform().p() 
+               == node2.getBounds().getTransform().p());
+    if (node1.isLeafNode()) {
+        SimTK_TEST(node1.getTriangles() == node2.getTriangles());
+        return;
+    }
+    compareOBBTrees(node1.getFirstChildNode(), node2.getFirstChildNode());
+    compareOBBTrees(node1.getSecondChildNode(), node2.getSecondChildNode());
+}
+
+// A mesh this large has the subtrees of its OBBTree built concurrently. Check
+// the tree, and compare queries that use it against brute force searches.
+void testLargeOBBTree() {
+    vector<Vec3> vertices;
+    vector<int> faceIndices;
+    for (int i = 0; i < 9; i++)
+        for (int j = 0; j < 9; j++)
+            for (int k = 0; k < 9; k++)
+                addOctohedron(vertices, faceIndices, 2.5*Vec3(i, j, k));
+    ContactGeometry::TriangleMesh mesh(vertices, faceIndices);
+    SimTK_TEST(mesh.getNumFaces() > 4096);
+
+    vector<int> faceReferenceCount(mesh.getNumFaces(), 0);
+    validateOBBTree(mesh, mesh.getOBBTreeNode(), mesh.getOBBTreeNode(), faceReferenceCount);
+    for (int i = 0; i < (int) faceReferenceCount.size(); i++)
+        SimTK_TEST(faceReferenceCount[i] == 1);
+
+    // The tree built in parallel must pass the checks made when reading a 
+    // cache file.
+    const string filename = "TestLargeOBBTree.cache";
+    mesh.writeCacheFile(filename);
+    const ContactGeometry::TriangleMesh cached = 
+        ContactGeometry::TriangleMesh::readCacheFile(filename);
+    remove(filename.c_str());
+    compareOBBTrees(cached.getOBBTreeNode(), mesh.getOBBTreeNode());
+
+    Random::Uniform random(-2, 22);
+    for (int i = 0; i < 200; i++) {
+        Vec3 pos(random.getValue(), random.getValue(), random.getValue());
+        bool inside;
+        int face;
+        Vec2 uv;
+        Vec3 nearest = mesh.findNearestPoint(pos, inside, face, uv);
+        Real minDist2 = Infinity;
+        for (int f = 0; f < mesh.getNumFaces(); f++) {
+            Vec2 faceUV;
+            minDist2 = std::min(minDist2, (mesh.findNearestPointToFace(pos, f, faceUV)-pos).normSqr());
+        }
+        SimTK_TEST_EQ((nearest-pos).normSqr(), minDist2);
+
+        // A ray from below the mesh must stop at the first face in its way.
+        Vec3 origin(pos[0], pos[1], -5);
+        Real distance;
+        if (mesh.intersectsRay(origin, UnitVec3(0, 0, 1), distance, face, uv)) {
+            Real minDistance = Infinity;
+            for (int f = 0; f < mesh.getNumFaces(); f++) {
+                const Vec3 p0 = mesh.getVertexPosition(mesh.getFaceVertex(f, 0));
+                const UnitVec3& n = mesh.getFaceNormal(f);
+                if (n[2] == 0)
+                    continue;
+                const Real t = ~n*(p0-origin)/n[2];
+                const Vec3 hit = origin+Vec3(0, 0, t);
+                Vec2 faceUV;
+                if (t >= 0 && (mesh.findNearestPointToFace(hit, f, faceUV)-hit).norm() < 1e-10)
+                    minDistance = std::min(minDistance, t);
+            }
+            SimTK_TEST_EQ(distance, minDistance);
+        }
+    }
+}
+
 void testRayIntersection() {
     // Create an octrohedral mesh.
     
@@ -307,14 +388,182 @@ void testBoundingSphere() {
     }
 }
 
+// Make a closed triangle mesh approximating a sphere by repeatedly 
+// subdividing an octahedron.
+ContactGeometry::TriangleMesh makeSphereMesh(Real radius, int levels) {
+    vector<Vec3> vertices;
+    vector<int> faces;
+    addOctohedron(vertices, faces, Vec3(0));
+    for (int level = 0; level < levels; level++) {
+        map<pair<int,int>,int> midpoints;
+        vector<int> newFaces;
+        for (int f = 0; f < (int) faces.size()/3; f++) {
+            int mid[3];
+            for (int k = 0; k < 3; k++) {
+                int a = faces[3*f+k], b = faces[3*f+(k+1)%3];
+                if (a > b) swap(a, b);
+                map<pair<int,int>,int>::iterator p = 
+                    midpoints.find(make_pair(a, b));
+                if (p == midpoints.end()) {
+                    vertices.push_back(0.5*(vertices[a]+vertices[b]));
+                    p = midpoints.insert(make_pair(make_pair(a, b), 
+                                         (int) vertices.size()-1)).first;
+                }
+                mid[k] = p->second;
+            }
+            const int v0 = faces[3*f], v1 = faces[3*f+1], v2 = faces[3*f+2];
+            const int sub[4][3] = {{v0,mid[0],mid[2]}, {mid[0],v1,mid[1]},
+                                   {mid[2],mid[1],v2}, {mid[0],mid[1],mid[2]}};
+            for (int s = 0; s < 4; s++)
+                for (int k = 0; k < 3; k++)
+                    newFaces.push_back(sub[s][k]);
+        }
+        faces.swap(newFaces);
+    }
+    for (int i = 0; i < (int) vertices.size(); i++)
+        vertices[i] = radius*UnitVec3(vertices[i]);
+    return ContactGeometry::TriangleMesh(vertices, faces);
+}
+
+// Move one sphere mesh through another in small steps, tracking the contact
+// from one step to the next, and make sure the result always matches what
+// we get starting from scratch. Then make a jump too big to be tracked.
+void testMeshMeshTracking() {
+    ContactGeometry::TriangleMesh mesh1 = makeSphereMesh(1, 4);
+    ContactGeometry::TriangleMesh mesh2 = makeSphereMesh(0.7, 4);
+    ContactTracker::TriangleMeshTriangleMesh tracker;
+    const UntrackedContact untracked((ContactSurfaceIndex(0)), 
+                                     ContactSurfaceIndex(1));
+    const Transform X_GM1(Rotation(0.3, YAxis), Vec3(0.1, 0.2, 0));
+
+    Contact prior = untracked;
+    int numTracked = 0;
+    for (int step = 0; step <= 60; step++) {
+        const Transform X_GM2(Rotation(0.01*step, ZAxis), 
+                              Vec3(1.75-0.015*step, 0.2, 0.01*step));
+        Contact current, fresh;
+        SimTK_TEST(tracker.trackContact(prior, X_GM1, mesh1, X_GM2, mesh2, 
+                                        0, current));
+        SimTK_TEST(tracker.trackContact(untracked, X_GM1, mesh1, X_GM2, 
+                                        mesh2, 0, fresh));
+        SimTK_TEST(current.isEmpty() == fresh.isEmpty());
+        if (fresh.isEmpty()) {
+            prior = untracked;
+            continue;
+        }
+        const TriangleMeshContact& c = TriangleMeshContact::getAs(current);
+        const TriangleMeshContact& f = TriangleMeshContact::getAs(fresh);
+        SimTK_TEST(c.getSurface1FaceIndices() == f.getSurface1FaceIndices());
+        SimTK_TEST(c.getSurface2FaceIndices() == f.getSurface2FaceIndices());
+        if (TriangleMeshContact::isInstance(prior)) ++numTracked;
+        prior = current;
+    }
+    SimTK_TEST(numTracked > 40);
+
+    // By now some faces of mesh2 are completely buried; jump somewhere else.
+    // The std::set form of the face lists must hold the same faces.
+    const TriangleMeshContact& p = TriangleMeshContact::getAs(prior);
+    const Array_<int>& faces1 = p.getSurface1FaceIndices();
+    const Array_<int>& faces2 = p.getSurface2FaceIndices();
+    SimTK_TEST(faces2.size() > 100);
+    SimTK_TEST(p.getSurface1Faces() == set<int>(faces1.begin(), faces1.end()));
+    SimTK_TEST(p.getSurface2Faces() == set<int>(faces2.begin(), faces2.end()));
+    const Transform X_GM2(Rotation(0.4, ZAxis), Vec3(-1.2, 0.5, 0));
+    Contact current, fresh;
+    tracker.trackContact(prior, X_GM1, mesh1, X_GM2, mesh2, 0, current);
+    tracker.trackContact(untracked, X_GM1, mesh1, X_GM2, mesh2, 0, fresh);
+    SimTK_TEST(TriangleMeshContact::getAs(current).getSurface1FaceIndices() 
+               == TriangleMeshContact::getAs(fresh).getSurface1FaceIndices());
+    SimTK_TEST(TriangleMeshContact::getAs(current).getSurface2FaceIndices() 
+               == TriangleMeshContact::getAs(fresh).getSurface2FaceIndices());
+}
+
+// Write a mesh to a cache file and read it back. Everything must match the
+// original, including in a copy made from the mesh that was read, which 
+// shares its data and has to outlive it.
+void testCacheFile() {
+    const ContactGeometry::TriangleMesh 
+        mesh(makeSphereMesh(1, 4).createPolygonalMesh(), true);
+    const string filename = "TestTriangleMesh.cache";
+    mesh.writeCacheFile(filename);
+    ContactGeometry::TriangleMesh* cached = new ContactGeometry::TriangleMesh
+       (ContactGeometry::TriangleMesh::readCacheFile(filename));
+    const ContactGeometry::TriangleMesh copy(*cached);
+    delete cached;
+
+    SimTK_TEST(copy.getNumVertices() == mesh.getNumVertices());
+    SimTK_TEST(copy.getNumFaces() == mesh.getNumFaces());
+    SimTK_TEST(copy.getNumEdges() == mesh.getNumEdges());
+    for (int i = 0; i < mesh.getNumVertices(); i++)
+        SimTK_TEST(copy.getVertexPosition(i) == mesh.getVertexPosition(i));
+    for (int i = 0; i < mesh.getNumFaces(); i++) {
+        for (int j = 0; j < 3; j++) {
+            SimTK_TEST(copy.getFaceVertex(i, j) == mesh.getFaceVertex(i, j));
+            SimTK_TEST(copy.getFaceEdge(i, j) == mesh.getFaceEdge(i, j));
+        }
+        SimTK_TEST(copy.getFaceNormal(i) == mesh.getFaceNormal(i));
+        SimTK_TEST(copy.getFaceArea(i) == mesh.getFaceArea(i));
+        SimTK_TEST(copy.findNormalAtPoint(i, Vec2(0.2, 0.3)) 
+                   == mesh.findNormalAtPoint(i, Vec2(0.2, 0.3)));
+    }
+    for (int i = 0; i < mesh.getNumEdges(); i++)
+        for (int j = 0; j < 2; j++) {
+            SimTK_TEST(copy.getEdgeVertex(i, j) == mesh.getEdgeVertex(i, j));
+            SimTK_TEST(copy.getEdgeFace(i, j) == mesh.getEdgeFace(i, j));
+        }
+    compareOBBTrees(copy.getOBBTreeNode(), mesh.getOBBTreeNode());
+    Vec3 center1, center2;
+    Real radius1, radius2;
+    copy.getBoundingSphere(center1, radius1);
+    mesh.getBoundingSphere(center2, radius2);
+    SimTK_TEST(center1 == center2 && radius1 == radius2);
+
+    Random::Uniform random(-2, 2);
+    for (int i = 0; i < 50; i++) {
+        const Vec3 pos(random.getValue(), random.getValue(), random.getValue());
+        bool inside1, inside2;
+        UnitVec3 normal1, normal2;
+        SimTK_TEST(copy.findNearestPoint(pos, inside1, normal1)
+                   == mesh.findNearestPoint(pos, inside2, normal2));
+        SimTK_TEST(inside1 == inside2);
+        SimTK_TEST(normal1 == normal2);
+    }
+
+    // A file with an index that is out of range, a truncated file, or one
+    // that isn't a cache file at all, is rejected. The file ends with the
+    // face indices of the OBB tree leaves.
+    string contents;
+    {   ifstream in(filename.c_str(), ios::binary);
+        contents.assign(istreambuf_iterator<char>(in), 
+                        istreambuf_iterator<char>()); }
+    {   string damaged = contents;
+        const int badFace = mesh.getNumFaces();
+        damaged.replace(damaged.size()-sizeof(int), sizeof(int), 
+                        reinterpret_cast<const char*>(&badFace), sizeof(int));
+        ofstream out(filename.c_str(), ios::binary);
+        out << damaged; }
+    SimTK_TEST_MUST_THROW(ContactGeometry::TriangleMesh::readCacheFile(filename));
+    {   ofstream out(filename.c_str(), ios::binary);
+        out << contents.substr(0, contents.size()/2); }
+    SimTK_TEST_MUST_THROW(ContactGeometry::TriangleMesh::readCacheFile(filename));
+    {   ofstream out(filename.c_str(), ios::binary);
+        out << "This is not a mesh cache file." << endl; }
+    SimTK_TEST_MUST_THROW(ContactGeometry::TriangleMesh::readCacheFile(filename));
+    remove(filename.c_str());
+    SimTK_TEST_MUST_THROW(ContactGeometry::TriangleMesh::readCacheFile(filename));
+}
+
 int main() {
     SimTK_START_TEST("TestTriangleMesh");
         SimTK_SUBTEST(testTriangleMesh);
         SimTK_SUBTEST(testIncorrectMeshes);
         SimTK_SUBTEST(testOBBTree);
+        SimTK_SUBTEST(testLargeOBBTree);
         SimTK_SUBTEST(testRayIntersection);
         SimTK_SUBTEST(testSmoothMesh);
         SimTK_SUBTEST(testFindNearestPoint);
         SimTK_SUBTEST(testBoundingSphere);
+        SimTK_SUBTEST(testMeshMeshTracking);
+        SimTK_SUBTEST(testCacheFile);
     SimTK_END_TEST();
 }
@@ -0,0 +1,108 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#
+// Measure how EnsembleStepper scales with the number of threads. A fixed
+// ensemble of pendulum replicas is integrated with 1, 2, 4, ... threads up to
+// the number of processors, and the wall time, speedup, and parallel 
+// efficiency relative to one thread are printed. The final states are also
+// compared to the single threaded run, since they must be identical.
+//
+// Usage: EnsembleScaling [numReplicas [finalTime [maxThreads]]]
+
+#include "SimTKmath.h"
+#include "../PendulumSystem.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+static double runEnsemble(const PendulumSystem& sys, int numReplicas, 
+                          Real finalTime, int numThreads, 
+                          Array_<Vector>& finalY) 
+{
+    EnsembleStepper ensemble(sys, numThreads);
+    for (int i = 0; i < numReplicas; ++i) {
+        State state = sys.getDefaultState();
+        const Real angle = 0.1 + 2.0*i/numReplicas;
+        state.updQ()[0] = std::sin(angle);
+        state.updQ()[1] = -std::cos(angle);
+        state.updU() = 0;
+        Integrator* integ = new RungeKuttaMersonIntegrator(sys);
+        integ->setAccuracy(1e-8);
+        ensemble.addReplica(integ, state);
+    }
+    ensemble.setReportInterval(finalTime/10);
+
+    const double start = realTime();
+    ensemble.stepTo(finalTime);
+    const double elapsed = realTime()-start;
+
+    finalY.resize(numReplicas);
+    for (int i = 0; i < numReplicas; ++i)
+        finalY[i] = ensemble.getState(i).getY();
+    return elapsed;
+}
+
+int main(int argc, char** argv) {
+    const int numReplicas = argc > 1 ? std::atoi(argv[1]) : 256;
+    const Real finalTime  = argc > 2 ? std::atof(argv[2]) : 20;
+    const int maxThreads  = argc > 3 ? std::atoi(argv[3]) 
+                                     : ParallelExecutor::getNumProcessors();
+
+    PendulumSystem sys;
+    sys.realizeTopology();
+    sys.setDefaultMass(10);
+    sys.setDefaultLength(1);
+
+    std::printf("%d replicas to t=%g, up to %d threads on %d processors\n", 
+                numReplicas, finalTime, maxThreads, 
+                ParallelExecutor::getNumProcessors());
+    std::printf("%8s  %9s  %8s  %10s  %s\n", 
+                "threads", "time(s)", "speedup", "efficiency", "identical");
+
+    Array_<Vector> serialY, parallelY;
+    const double serialTime = 
+        runEnsemble(sys, numReplicas, finalTime, 1, serialY);
+    std::printf("%8d  %9.3f  %8.2f  %10.2f  %s\n", 1, serialTime, 1., 1., "-");
+
+    for (int threads = 2; ; threads *= 2) {
+        if (threads > maxThreads) {
+            if (threads/2 == maxThreads) break;
+            threads = maxThreads;
+        }
+        const double time = 
+            runEnsemble(sys, numReplicas, finalTime, threads, parallelY);
+        bool identical = true;
+        for (int i = 0; i < numReplicas; ++i)
+            for (int k = 0; k < serialY[i].size(); ++k)
+                if (serialY[i][k] != parallelY[i][k])
+                    identical = false;
+        std::printf("%8d  %9.3f  %8.2f  %10.2f  %s\n", threads, time,
+                    serialTime/time, serialTime/time/threads, 
+                    identical ? "yes" : "NO");
+        if (threads == maxThreads) break;
+    }
+    return 0;
+}
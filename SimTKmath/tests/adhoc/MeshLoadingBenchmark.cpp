@@ -0,0 +1,177 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Measure how long it takes to get a large triangle mesh ready for contact:
+// reading it from an OBJ file and from a .vtp file with raw appended data,
+// building the TriangleMesh (edges, normals, and OBB tree) from the 
+// PolygonalMesh, and writing and then reading a mesh cache file instead. The
+// mesh is a torus with about n*n triangles; the files are written to the 
+// current directory and removed afterwards.
+//
+// Usage: MeshLoadingBenchmark [n]
+
+#include "SimTKmath.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using namespace SimTK;
+
+static void makeTorus(int n, Array_<Vec3>& vertices, Array_<int>& faces) {
+    const int m = n/2;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < m; j++) {
+            const Real u = 2*Pi*i/n, v = 2*Pi*j/m;
+            const Real r = 1 + 0.3*std::cos(v);
+            vertices.push_back(Vec3(r*std::cos(u), r*std::sin(u), 
+                                    0.3*std::sin(v)));
+        }
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < m; j++) {
+            const int a = i*m+j, b = ((i+1)%n)*m+j, 
+                      c = ((i+1)%n)*m+(j+1)%m, d = i*m+(j+1)%m;
+            faces.push_back(a); faces.push_back(b); faces.push_back(c);
+            faces.push_back(a); faces.push_back(c); faces.push_back(d);
+        }
+}
+
+static void writeObj(const char* filename, const Array_<Vec3>& vertices,
+                     const Array_<int>& faces) {
+    std::FILE* file = std::fopen(filename, "w");
+    for (int i = 0; i < (int)vertices.size(); i++)
+        std::fprintf(file, "v %.17g %.17g %.17g\n", 
+                     vertices[i][0], vertices[i][1], vertices[i][2]);
+    for (int i = 0; i < (int)faces.size(); i += 3)
+        std::fprintf(file, "f %d %d %d\n", faces[i]+1, faces[i+1]+1, 
+                     faces[i+2]+1);
+    std::fclose(file);
+}
+
+// Append a block of raw appended data: a UInt32 byte count, then the data.
+template <class T>
+static void appendBlock(const Array_<T>& values, std::string& appended) {
+    const unsigned int size = values.size()*sizeof(T);
+    appended.append((const char*)&size, sizeof(size));
+    appended.append((const char*)values.cbegin(), size);
+}
+
+static void writeVtp(const char* filename, const Array_<Vec3>& vertices,
+                     const Array_<int>& faces) {
+    Array_<double> coords;
+    for (int i = 0; i < (int)vertices.size(); i++)
+        for (int j = 0; j < 3; j++)
+            coords.push_back(vertices[i][j]);
+    Array_<int> offsets;
+    for (int i = 3; i <= (int)faces.size(); i += 3)
+        offsets.push_back(i);
+    std::string appended;
+    appendBlock(coords, appended);
+    const int connectivityOffset = appended.size();
+    appendBlock(faces, appended);
+    const int offsetsOffset = appended.size();
+    appendBlock(offsets, appended);
+
+    const int one = 1;
+    std::ofstream out(filename, std::ios::binary);
+    out << "<?xml version=\"1.0\"?>\n<VTKFile type=\"PolyData\" byte_order=\""
+        << (*(const char*)&one ? "LittleEndian" : "BigEndian") << "\">\n"
+        << "<PolyData><Piece NumberOfPoints=\"" << vertices.size() 
+        << "\" NumberOfPolys=\"" << offsets.size() << "\">\n"
+        << "<Points><DataArray type=\"Float64\" NumberOfComponents=\"3\""
+        << " format=\"appended\" offset=\"0\"/></Points>\n"
+        << "<Polys><DataArray type=\"Int32\" Name=\"connectivity\""
+        << " format=\"appended\" offset=\"" << connectivityOffset << "\"/>\n"
+        << "<DataArray type=\"Int32\" Name=\"offsets\""
+        << " format=\"appended\" offset=\"" << offsetsOffset << "\"/></Polys>\n"
+        << "</Piece></PolyData>\n<AppendedData encoding=\"raw\">\n_" 
+        << appended << "\n</AppendedData>\n</VTKFile>\n";
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const char* objFile   = "MeshLoadingBenchmark.obj";
+    const char* vtpFile   = "MeshLoadingBenchmark.vtp";
+    const char* cacheFile = "MeshLoadingBenchmark.cache";
+    try {
+        Array_<Vec3> vertices;
+        Array_<int> faces;
+        makeTorus(n, vertices, faces);
+        writeObj(objFile, vertices, faces);
+        writeVtp(vtpFile, vertices, faces);
+        std::printf("%d vertices, %d triangles, %d processors\n", 
+            (int)vertices.size(), (int)faces.size()/3, 
+            ParallelExecutor::getNumProcessors());
+        std::printf("%-28s  %10s\n", "step", "seconds");
+
+        double start = realTime();
+        PolygonalMesh objMesh;
+        std::ifstream obj(objFile);
+        objMesh.loadObjFile(obj);
+        std::printf("%-28s  %10.3f\n", "PolygonalMesh::loadObjFile", 
+                    realTime()-start);
+
+        start = realTime();
+        PolygonalMesh vtpMesh;
+        vtpMesh.loadVtpFile(vtpFile);
+        std::printf("%-28s  %10.3f\n", "PolygonalMesh::loadVtpFile", 
+                    realTime()-start);
+
+        start = realTime();
+        const ContactGeometry::TriangleMesh mesh(objMesh);
+        std::printf("%-28s  %10.3f\n", "build TriangleMesh", realTime()-start);
+
+        start = realTime();
+        mesh.writeCacheFile(cacheFile);
+        std::printf("%-28s  %10.3f\n", "writeCacheFile", realTime()-start);
+
+        start = realTime();
+        const ContactGeometry::TriangleMesh cached = 
+            ContactGeometry::TriangleMesh::readCacheFile(cacheFile);
+        std::printf("%-28s  %10.3f\n", "readCacheFile", realTime()-start);
+
+        // Touch all of the cached data, as a first query of the mesh would.
+        start = realTime();
+        bool inside;
+        UnitVec3 normal;
+        Real cachedArea = 0;
+        for (int i = 0; i < cached.getNumFaces(); i++)
+            cachedArea += cached.getFaceArea(i);
+        cached.findNearestPoint(Vec3(2, 0, 0), inside, normal);
+        std::printf("%-28s  %10.3f\n", "first use of cached mesh", 
+                    realTime()-start);
+
+        Real area = 0;
+        for (int i = 0; i < mesh.getNumFaces(); i++)
+            area += mesh.getFaceArea(i);
+        std::printf("total area %g built, %g cached\n", area, cachedArea);
+    } catch (const std::exception& e) {
+        std::printf("EXCEPTION THROWN: %s\n", e.what());
+        return 1;
+    }
+    std::remove(objFile);
+    std::remove(vtpFile);
+    std::remove(cacheFile);
+    return 0;
+}
@@ -1937,25 +1937,88 @@ static void readData(unsigned char* buffer, int bytes) {
     readDataFromPipe(inPipe, buffer, bytes);
 }
 
-// We have just processed a StartOfScene command. Read in all the scene
-// elements until we see an EndOfScene command. We allocate a new Scene
-// object to hold the scene and return a pointer to it. Don't forget to
-// delete that object when you are done with it.
+// The simulator sends each scene as a single frame of known length. We read
+// the whole frame into this buffer, which is reused for every frame, and then
+// decode the scene elements from memory.
+static vector<unsigned char> frameBuffer;
+
+// This hands out successive pieces of a frame that has already been read.
+// Values within a frame aren't aligned so they must be copied out.
+class FrameReader {
+public:
+    FrameReader(const unsigned char* data, unsigned size) 
+    :   data(data), size(size), pos(0) {}
+    void read(void* dest, unsigned bytes) {
+        SimTK_ERRCHK_ALWAYS(pos+bytes <= size, "VisualizerGUI::FrameReader",
+            "Scene data ended unexpectedly; can't continue.");
+        memcpy(dest, data+pos, bytes);
+        pos += bytes;
+    }
+private:
+    const unsigned char* data;
+    unsigned             size, pos;
+};
+
+// Compute normal vectors for a mesh whose vertices and faces have just been
+// received, then queue it; a real mesh will be generated from it the next
+// time the scene is redrawn.
+static void addPendingMesh(PendingMesh* mesh) {
+    const int numVertices = (int)mesh->vertices.size()/3;
+    const int numFaces = (int)mesh->faces.size()/3;
+    vector<fVec3> normals(numVertices, fVec3(0));
+    for (int i = 0; i < numFaces; i++) {
+        int v1 = mesh->faces[3*i];
+        int v2 = mesh->faces[3*i+1];
+        int v3 = mesh->faces[3*i+2];
+        fVec3 vert1(mesh->vertices[3*v1], mesh->vertices[3*v1+1], mesh->vertices[3*v1+2]);
+        fVec3 vert2(mesh->vertices[3*v2], mesh->vertices[3*v2+1], mesh->vertices[3*v2+2]);
+        fVec3 vert3(mesh->vertices[3*v3], mesh->vertices[3*v3+1], mesh->vertices[3*v3+2]);
+        fVec3 norm = (vert2-vert1)%(vert3-vert1);
+        float length = norm.norm();
+        if (length > 0) {
+            norm /= length;
+            normals[v1] += norm;
+            normals[v2] += norm;
+            normals[v3] += norm;
+        }
+    }
+    for (int i = 0; i < numVertices; i++) {
+        normals[i] = normals[i].normalize();
+        mesh->normals[3*i] = normals[i][0];
+        mesh->normals[3*i+1] = normals[i][1];
+        mesh->normals[3*i+2] = normals[i][2];
+    }
+
+    pthread_mutex_lock(&sceneLock);     //------- LOCK SCENE --------
+    pendingCommands.insert(pendingCommands.begin(), mesh);
+    pthread_mutex_unlock(&sceneLock);   //------ UNLOCK SCENE --------
+}
+
+// We have just processed a StartOfScene command. Read in the rest of the
+// frame and decode all the scene elements up to the EndOfScene command. 
+// We allocate a new Scene object to hold the scene and return a pointer to
+// it. Don't forget to delete that object when you are done with it.
 static Scene* readNewScene() {
     unsigned char buffer[256];
     float*          floatBuffer = (float*)          buffer;
     int*            intBuffer   = (int*)            buffer;
     unsigned short* shortBuffer = (unsigned short*) buffer;
 
+    unsigned frameBytes;
+    readData((unsigned char*)&frameBytes, sizeof(unsigned));
+    frameBuffer.resize(std::max(frameBytes, 1U));
+    readData(&frameBuffer[0], frameBytes);
+    FrameReader frame(&frameBuffer[0], frameBytes);
+
     Scene* newScene = new Scene;
 
     // Simulated time for this frame comes first.
-    readData(buffer, sizeof(float));
+    frame.read(buffer, sizeof(float));
     newScene->simTime = floatBuffer[0];
 
     bool finished = false;
     while (!finished) {
-        readData(buffer, 1);
+        frame.read(buffer, 1);
         char command = buffer[0];
 
         switch (command) {
@@ -1968,15 +2031,17 @@ static Scene* readNewScene() {
         case AddPointMesh:
         case AddWireframeMesh:
         case AddSolidMesh: {
-            readData(buffer, 13*sizeof(float)+2*sizeof(short));
+            frame.read(buffer, 2*sizeof(short));
+            unsigned short meshIndex = shortBuffer[0];
+            unsigned short resolution = shortBuffer[1];
+            frame.read(buffer, 9*sizeof(float)+4);
             fTransform position;
             position.updR().setRotationToBodyFixedXYZ(fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]));
             position.updP() = fVec3(floatBuffer[3], floatBuffer[4], floatBuffer[5]);
             fVec3 scale = fVec3(floatBuffer[6], floatBuffer[7], floatBuffer[8]);
-            fVec4 color = fVec4(floatBuffer[9], floatBuffer[10], floatBuffer[11], floatBuffer[12]);
+            const unsigned char* rgba = &buffer[9*sizeof(float)];
+            fVec4 color = fVec4(rgba[0], rgba[1], rgba[2], rgba[3])/255.0f;
             short representation = (command == AddPointMesh ? DecorativeGeometry::DrawPoints : (command == AddWireframeMesh ? DecorativeGeometry::DrawWireframe : DecorativeGeometry::DrawSurface));
-            unsigned short meshIndex = shortBuffer[13*sizeof(float)/sizeof(short)];
-            unsigned short resolution = shortBuffer[13*sizeof(float)/sizeof(short)+1];
             RenderedMesh mesh(position, scale, color, representation, meshIndex, resolution);
             if (command != AddSolidMesh)
                 newScene->drawnMeshes.push_back(mesh);
@@ -1994,10 +2059,14 @@ static Scene* readNewScene() {
             break;
         }
 
-        case AddLine: {
-            readData(buffer, 10*sizeof(float));
-            fVec3 color = fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]);
-            float thickness = floatBuffer[3];
+        // A run of lines that all have the same color and thickness.
+        case AddLines: {
+            frame.read(buffer, 3);
+            fVec3 color = fVec3(buffer[0], buffer[1], buffer[2])/255.0f;
+            float thickness;
+            frame.read(&thickness, sizeof(float));
+            unsigned short numNewLines;
+            frame.read(&numNewLines, sizeof(short));
             int index;
             int numLines = (int)newScene->lines.size();
             for (index = 0; index < numLines && (color != newScene->lines[index].getColor() || thickness != newScene->lines[index].getThickness()); index++)
@@ -2005,24 +2074,21 @@ static Scene* readNewScene() {
             if (index == numLines)
                 newScene->lines.push_back(RenderedLine(color, thickness));
             vector<GLfloat>& line = newScene->lines[index].getLines();
-            line.push_back(floatBuffer[4]);
-            line.push_back(floatBuffer[5]);
-            line.push_back(floatBuffer[6]);
-            line.push_back(floatBuffer[7]);
-            line.push_back(floatBuffer[8]);
-            line.push_back(floatBuffer[9]);
+            const size_t start = line.size();
+            line.resize(start + 6*numNewLines);
+            frame.read(&line[start], 6*numNewLines*sizeof(float));
             break;
         }
 
         case AddText: {
-            readData(buffer, 9*sizeof(float)+2*sizeof(short));
+            frame.read(buffer, 9*sizeof(float)+2*sizeof(short));
             fVec3 position = fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]);
             fVec3 scale = fVec3(floatBuffer[3], floatBuffer[4], floatBuffer[5]);
             fVec3 color = fVec3(floatBuffer[6], floatBuffer[7], floatBuffer[8]);
             unsigned short* shortp = &shortBuffer[9*sizeof(float)/sizeof(short)];
             bool faceCamera = (shortp[0] != 0);
             short length = shortp[1];
-            readData(buffer, length);
+            frame.read(buffer, length);
             newScene->strings.push_back
                (RenderedText(position, scale, color, 
                              string((char*)buffer, length), faceCamera));
@@ -2030,7 +2096,7 @@ static Scene* readNewScene() {
         }
 
         case AddCoords: {
-            readData(buffer, 12*sizeof(float));
+            frame.read(buffer, 12*sizeof(float));
             fRotation rotation;
             rotation.setRotationToBodyFixedXYZ(fVec3(floatBuffer[0], 
                                                      floatBuffer[1], 
@@ -2082,47 +2148,16 @@ static Scene* readNewScene() {
         // index. It will be cached here and then can be referenced in this
         // scene and others by using it mesh index.
         case DefineMesh: {
-            readData(buffer, 2*sizeof(short));
+            frame.read(buffer, 2*sizeof(short));
             PendingMesh* mesh = new PendingMesh(); // assigns next mesh index
             int numVertices = shortBuffer[0];
             int numFaces = shortBuffer[1];
             mesh->vertices.resize(3*numVertices, 0);
             mesh->normals.resize(3*numVertices);
             mesh->faces.resize(3*numFaces);
-            readData((unsigned char*)&mesh->vertices[0], (int)(mesh->vertices.size()*sizeof(float)));
-            readData((unsigned char*)&mesh->faces[0], (int)(mesh->faces.size()*sizeof(short)));
-
-            // Compute normal vectors for the mesh.
-
-            vector<fVec3> normals(numVertices, fVec3(0));
-            for (int i = 0; i < numFaces; i++) {
-                int v1 = mesh->faces[3*i];
-                int v2 = mesh->faces[3*i+1];
-                int v3 = mesh->faces[3*i+2];
-                fVec3 vert1(mesh->vertices[3*v1], mesh->vertices[3*v1+1], mesh->vertices[3*v1+2]);
-                fVec3 vert2(mesh->vertices[3*v2], mesh->vertices[3*v2+1], mesh->vertices[3*v2+2]);
-                fVec3 vert3(mesh->vertices[3*v3], mesh->vertices[3*v3+1], mesh->vertices[3*v3+2]);
-                fVec3 norm = (vert2-vert1)%(vert3-vert1);
-                float length = norm.norm();
-                if (length > 0) {
-                    norm /= length;
-                    normals[v1] += norm;
-                    normals[v2] += norm;
-                    normals[v3] += norm;
-                }
-            }
-            for (int i = 0; i < numVertices; i++) {
-                normals[i] = normals[i].normalize();
-                mesh->normals[3*i] = normals[i][0];
-                mesh->normals[3*i+1] = normals[i][1];
-                mesh->normals[3*i+2] = normals[i][2];
-            }
-
-            // A real mesh will be generated from this the next
-            // time the scene is redrawn.
-            pthread_mutex_lock(&sceneLock);     //------- LOCK SCENE --------
-            pendingCommands.insert(pendingCommands.begin(), mesh);
-            pthread_mutex_unlock(&sceneLock);   //------ UNLOCK SCENE --------
+            frame.read((unsigned char*)&mesh->vertices[0], (int)(mesh->vertices.size()*sizeof(float)));
+            frame.read((unsigned char*)&mesh->faces[0], (int)(mesh->faces.size()*sizeof(short)));
+            addPendingMesh(mesh);
             break;
         }
 
@@ -2152,6 +2187,19 @@ void* listenForInput(void* args) {
         // Read commands from the simulator.
         readData(buffer, 1);
         switch (buffer[0]) {
+        // A mesh is normally defined inside the first scene that uses it, 
+        // but a recording being played back defines it ahead of that scene.
+        case DefineMesh: {
+            readData(buffer, 2*sizeof(short));
+            PendingMesh* mesh = new PendingMesh(); // assigns next mesh index
+            mesh->vertices.resize(3*shortBuffer[0], 0);
+            mesh->normals.resize(3*shortBuffer[0]);
+            mesh->faces.resize(3*shortBuffer[1]);
+            readData((unsigned char*)&mesh->vertices[0], (int)(mesh->vertices.size()*sizeof(float)));
+            readData((unsigned char*)&mesh->faces[0], (int)(mesh->faces.size()*sizeof(short)));
+            addPendingMesh(mesh);
+            break;
+        }
         case DefineMenu: {
             readData(buffer, sizeof(short));
             int titleLength = shortBuffer[0];
@@ -149,6 +149,7 @@ class FrameController; // defined below
 class InputListener;   // defined in Visualizer_InputListener.h
 class InputSilo;       //                 "
 class Reporter;        // defined in Visualizer_Reporter.h
+class Recording;       // defined in Visualizer_Recording.h
 
 
 /** Construct a new %Visualizer for the indicated System, and launch the
@@ -188,6 +189,47 @@ constructor's documentation for more information. **/
 Visualizer(const MultibodySystem& system,
            const Array_<String>&  searchPath);
 
+/** Create a %Visualizer that does not launch the VisualizerGUI, for use 
+where there is no display such as on a batch machine. Instead, everything 
+that would have been sent to the GUI is recorded in the named file so that
+it can be rendered later with playRecording(). The file is written by a 
+background thread, so report() and drawFrameNow() only have to generate the
+scene and copy it; they are never held up by the disk. Every reported frame 
+is recorded, regardless of the Mode and frame rate settings, so control the 
+recorded frame rate with the reporting interval. The exception is when the 
+disk falls far behind: then frames are dropped until it catches up; see 
+getNumDroppedFrames(). The recording is completed when the last reference to
+the %Visualizer is deleted.
+
+The file holds the same command stream as the VisualizerGUI protocol, 
+preceded by a short header and followed by an index giving the file offset
+and simulation time of each frame and the location of the setup commands 
+(mesh definitions, menus, camera settings, and so on) between frames. Each
+frame depends only on the setup commands before it, so playback can start at
+any frame. The file is replaced if it already exists. **/
+static Visualizer createRecorder(const MultibodySystem& system,
+                                 const String&          fileName);
+
+/** Return true if this %Visualizer was created with createRecorder() and is
+writing to a file rather than to the VisualizerGUI. **/
+bool isRecording() const;
+
+/** If this %Visualizer was created with createRecorder(), return the number of
+reported frames that were left out of the recording because the disk could not
+keep up; otherwise return zero. **/
+int getNumDroppedFrames() const;
+
+/** Show the frames of a recording made by a %Visualizer created with 
+createRecorder(), starting with frame \a firstFrame. The frames are shown at 
+the pace at which they were recorded, in simulation time, sped up by 
+\a playbackSpeed; this method returns after the last frame has been sent. If
+this %Visualizer is itself a recorder, the frames are copied to its file as 
+fast as possible instead. The recording brings its own meshes, menus, sliders,
+and camera settings, so this %Visualizer should not also be used to report 
+frames of its own. **/
+void playRecording(const Recording& recording, int firstFrame=0,
+                   Real playbackSpeed=1) const;
+
 /** Copy constructor has reference counted, shallow copy semantics;
 that is, the Visualizer copy is just another reference to the same
 Visualizer object. **/
@@ -0,0 +1,80 @@
+#ifndef SimTK_SIMBODY_VISUALIZER_RECORDING_H_
+#define SimTK_SIMBODY_VISUALIZER_RECORDING_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/common.h"
+#include "simbody/internal/Visualizer.h"
+
+namespace SimTK {
+
+class VisualizerRecordingReader;
+
+/** This is an open recording file made by a Visualizer that was created with
+Visualizer::createRecorder(). Use it to find out what frames the recording
+holds, and pass it to Visualizer::playRecording() to show them. Play back a 
+recording like this:
+@code
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Visualizer viz(system);
+    Visualizer::Recording recording("run.simviz");
+    viz.playRecording(recording);
+@endcode
+Only the recording's header and index are read when it is opened; frames are
+read from the file as they are played. **/
+class SimTK_SIMBODY_EXPORT Visualizer::Recording {
+public:
+    /** Open the named recording file. This throws an exception if the file
+    can't be read, wasn't closed properly when it was recorded, or was made
+    by a version of the Visualizer that used a different protocol. **/
+    explicit Recording(const String& fileName);
+    /** Close the file. **/
+    ~Recording();
+
+    /** Return the name of the recording file. **/
+    const String& getFileName() const;
+    /** Return the number of frames in the recording. **/
+    int getNumFrames() const;
+    /** Return the simulation time at which the given frame was recorded, 
+    for 0 <= \a frame < getNumFrames(). **/
+    Real getFrameTime(int frame) const;
+    /** Return the first frame recorded at or after simulation time \a time,
+    or getNumFrames() if there is none. This assumes that the frames were 
+    recorded in order of increasing time, as they are in a simulation. **/
+    int findFrame(Real time) const;
+
+private:
+    Recording(const Recording&);            // not copyable
+    Recording& operator=(const Recording&);
+
+    String                      fileName;
+    VisualizerRecordingReader*  reader;
+friend class Visualizer;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_VISUALIZER_RECORDING_H_
@@ -26,9 +26,11 @@
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/Visualizer.h"
 #include "simbody/internal/Visualizer_InputListener.h"
+#include "simbody/internal/Visualizer_Recording.h"
 
 #include "VisualizerGeometry.h"
 #include "VisualizerProtocol.h"
+#include "VisualizerRecorder.h"
 
 #include <cstdlib>
 #include <cstdio>
@@ -96,10 +98,12 @@ public:
 // Implementation of the Visualizer.
 class Visualizer::Impl {
 public:
-    // Create a Visualizer and put it in PassThrough mode.
+    // Create a Visualizer and put it in PassThrough mode. If a recording
+    // file name is given we record to that file instead of launching the GUI.
     Impl(Visualizer* owner, const MultibodySystem& system,
-         const Array_<String>& searchPath) 
-    :   m_system(system), m_protocol(*owner, searchPath),
+         const Array_<String>& searchPath,
+         const String& recordingFileName = String()) 
+    :   m_system(system), m_protocol(*owner, searchPath, recordingFileName),
         m_upDirection(YAxis), m_groundHeight(0),
         m_mode(PassThrough), m_frameRateFPS(DefaultFrameRateFPS), 
         m_simTimeUnitsPerSec(1), 
@@ -583,6 +587,9 @@ public:
         o << "  | | full buffer: " << numQueuedFramesThatHadToWait << endl;
         o << "  frames sent to renderer: " << numFramesSentToRenderer << endl;
         o << "  | delayed by renderer  : " << numFramesDelayedByRenderer << endl;
+        if (m_protocol.isRecording())
+            o << "  frames dropped from recording: " 
+              << m_protocol.getNumDroppedFrames() << endl;
         if (numReportedFramesThatWereQueued && numFramesSentToRenderer) {
             const double avg = sumOfQueueLengths/numFramesSentToRenderer;
             o << "  | average buffer length (frames): " << avg << endl;
@@ -779,6 +786,14 @@ Visualizer::Visualizer(const MultibodySystem& system,
     impl->incrRefCount();
 }
 
+Visualizer Visualizer::createRecorder(const MultibodySystem& system,
+                                      const String& fileName) {
+    Visualizer recorder((Impl*)0);
+    recorder.impl = new Impl(&recorder, system, Array_<String>(), fileName);
+    recorder.impl->incrRefCount();
+    return recorder;
+}
+
 Visualizer::Visualizer(const Visualizer& source) : impl(0) {
     if (source.impl) {
         impl = source.impl;
@@ -803,6 +818,47 @@ Visualizer::~Visualizer() {
 int Visualizer::getRefCount() const
 {   return impl ? impl->getRefCount() : 0; }
 
+bool Visualizer::isRecording() const
+{   return getImpl().m_protocol.isRecording(); }
+
+int Visualizer::getNumDroppedFrames() const
+{   return getImpl().m_protocol.getNumDroppedFrames(); }
+
+// Each frame is sent along with the setup commands recorded since the one 
+// before it. Frames are paced against the real time clock from the time the
+// first one was sent, so a slow frame doesn't delay the ones after it.
+void Visualizer::playRecording(const Recording& recording, int firstFrame, 
+                               Real playbackSpeed) const {
+    const VisualizerRecordingReader& reader = *recording.reader;
+    const int numFrames = reader.getNumFrames();
+    SimTK_APIARGCHECK2_ALWAYS(0 <= firstFrame && firstFrame <= numFrames,
+        "Visualizer", "playRecording",
+        "First frame %d is out of range; the recording has %d frames.",
+        firstFrame, numFrames);
+    SimTK_APIARGCHECK1_ALWAYS(playbackSpeed > 0,
+        "Visualizer", "playRecording",
+        "The playback speed must be positive but was %g.", playbackSpeed);
+
+    VisualizerProtocol& protocol = const_cast<Visualizer*>(this)
+                                        ->updImpl().m_protocol;
+    const bool paced = !protocol.isRecording();
+    const double startTime = firstFrame < numFrames 
+                             ? reader.getFrameTime(firstFrame) : 0;
+    const double startRealTime = realTime();
+    std::vector<char> setup, frameCommands;
+    for (int i = firstFrame; i < numFrames; ++i) {
+        reader.readFrame(i, i == firstFrame ? -1 : i-1, setup, frameCommands);
+        const double simTime = reader.getFrameTime(i);
+        if (paced) {
+            const double wait = startRealTime 
+                + (simTime-startTime)/playbackSpeed - realTime();
+            if (wait > 0)
+                sleepInSec(wait);
+        }
+        protocol.sendRecordedFrame(simTime, setup, frameCommands);
+    }
+}
+
        // Frame drawing methods
 
 void Visualizer::drawFrameNow(const State& state) const
@@ -817,6 +873,14 @@ void Visualizer::report(const State& state) const {
     Visualizer::Impl& rep = const_cast<Visualizer*>(this)->updImpl();
 
     ++rep.numFramesReportedBySimulation;
+
+    // A recording keeps every frame and there is no one watching in real
+    // time, so there is no reason to wait.
+    if (rep.m_protocol.isRecording()) {
+        drawFrameNow(state);
+        return;
+    }
+
     if (rep.m_mode == RealTime) {
         rep.reportRealtime(state);
         return;
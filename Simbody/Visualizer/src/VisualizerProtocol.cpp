@@ -25,6 +25,7 @@
 #include "simbody/internal/Visualizer.h"
 #include "simbody/internal/Visualizer_InputListener.h"
 #include "VisualizerProtocol.h"
+#include "VisualizerRecorder.h"
 
 #include <cstdlib>
 #include <cstdio>
@@ -55,6 +56,27 @@ using namespace std;
     "An attempt to write() %d bytes to pipe %d failed with errno=%d (%s).", \
     (len),(pipeno),errno,strerror(errno));}
 
+// Write a whole buffer to a pipe. A large frame may not fit in the pipe at
+// once, in which case write() can return after writing only part of it.
+static void writeAll(int pipeno, const char* buf, int len) {
+    while (len > 0) {
+        const int status = write(pipeno, buf, len);
+        if (status == -1 && errno == EINTR)
+            continue;
+        SimTK_ERRCHK4_ALWAYS(status!=-1, "VisualizerProtocol",
+            "An attempt to write() %d bytes to pipe %d failed with errno=%d (%s).",
+            len,pipeno,errno,strerror(errno));
+        buf += status;
+        len -= status;
+    }
+}
+
+// Convert a color component in [0,1] to the byte that represents it in a
+// frame.
+static unsigned char colorToByte(Real c) {
+    return (unsigned char)(clamp(Real(0), c, Real(1))*255 + Real(0.5));
+}
+
 static int inPipe;
 
 // Create a pipe, using the right call for this platform.
@@ -190,8 +212,19 @@ static void* listenForVisualizerEvents(void* arg) {
 }
 
 VisualizerProtocol::VisualizerProtocol
-   (Visualizer& visualizer, const Array_<String>& userSearchPath) 
+   (Visualizer& visualizer, const Array_<String>& userSearchPath,
+    const String& recordingFileName) 
+:   outPipe(-1), recorder(0), lineRunStart(-1)
 {
+    pthread_mutex_init(&sceneLock, NULL);
+
+    if (!recordingFileName.empty()) {
+        // Headless: everything that would go to the GUI goes to the file
+        // instead. There is no GUI to shake hands with or listen to.
+        recorder = new VisualizerRecorder(recordingFileName, ProtocolVersion);
+        return;
+    }
+
     // Launch the GUI application. We'll first look for one in the same directory
     // as the running executable; then if that doesn't work we'll look in the
     // bin subdirectory of the SimTK installation.
@@ -254,7 +287,6 @@ VisualizerProtocol::VisualizerProtocol
 
     // Spawn the thread to listen for events.
 
-    pthread_mutex_init(&sceneLock, NULL);
     pthread_t thread;
     pthread_create(&thread, NULL, listenForVisualizerEvents, &visualizer);
 }
@@ -310,21 +342,75 @@ void VisualizerProtocol::shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe) {
     // Handshake was successful.
 }
 
+VisualizerProtocol::~VisualizerProtocol() {
+    // This flushes the recording, if any.
+    delete recorder;
+    pthread_mutex_destroy(&sceneLock);
+}
+
+void VisualizerProtocol::sendCommand(const void* data, int bytes) const {
+    if (recorder)
+        recorder->appendCommand(data, bytes);
+    else
+        WRITE(outPipe, data, bytes);
+}
+
+
+void VisualizerProtocol::sendRecordedFrame
+   (Real simTime, const vector<char>& setup, const vector<char>& frameCommands)
+{
+    pthread_mutex_lock(&sceneLock);
+    if (recorder) {
+        if (!setup.empty())
+            recorder->appendCommand(&setup[0], (int)setup.size());
+        recorder->appendFrame(simTime, &frameCommands[0], 
+                              (int)frameCommands.size());
+    } else {
+        if (!setup.empty())
+            writeAll(outPipe, &setup[0], (int)setup.size());
+        writeAll(outPipe, &frameCommands[0], (int)frameCommands.size());
+    }
+    pthread_mutex_unlock(&sceneLock);
+}
+
+int VisualizerProtocol::getNumDroppedFrames() const 
+{   return recorder ? recorder->getNumDroppedFrames() : 0; }
 
 void VisualizerProtocol::beginScene(Real time) {
     pthread_mutex_lock(&sceneLock);
-    char command = StartOfScene;
-    WRITE(outPipe, &command, 1);
+    frame.clear();
+    lineRunStart = -1;
+    sceneTime = time;
+    frame.push_back(StartOfScene);
+    const unsigned frameBytes = 0; // filled in by finishScene()
+    appendToFrame(&frameBytes, sizeof(unsigned));
     float fTime = (float)time;
-    WRITE(outPipe, &fTime, sizeof(float));
+    appendToFrame(&fTime, sizeof(float));
 }
 
 void VisualizerProtocol::finishScene() {
-    char command = EndOfScene;
-    WRITE(outPipe, &command, 1);
+    beginRecord(EndOfScene);
+    const unsigned headerBytes = 1+sizeof(unsigned);
+    const unsigned frameBytes = (unsigned)frame.size() - headerBytes;
+    memcpy(&frame[1], &frameBytes, sizeof(unsigned));
+    if (recorder)
+        recorder->appendFrame(sceneTime, &frame[0], (int)frame.size());
+    else
+        writeAll(outPipe, &frame[0], (int)frame.size());
     pthread_mutex_unlock(&sceneLock);
 }
 
+void VisualizerProtocol::beginRecord(unsigned char command) {
+    lineRunStart = -1;
+    frame.push_back((char)command);
+}
+
+void VisualizerProtocol::appendToFrame(const void* data, int bytes) {
+    const size_t start = frame.size();
+    frame.resize(start + bytes);
+    memcpy(&frame[start], data, bytes);
+}
+
 void VisualizerProtocol::drawBox(const Transform& X_GB, const Vec3& scale, const Vec4& color, int representation) {
     drawMesh(X_GB, scale, color, (short) representation, MeshBox, 0);
 }
@@ -416,13 +502,28 @@ void VisualizerProtocol::drawPolygonalMesh(const PolygonalMesh& mesh, const Tran
         "Too many unique DecorativeMesh objects; max is 65535.");
     
     meshes[impl] = (unsigned short)index;    // insert new mesh
-    WRITE(outPipe, &DefineMesh, 1);
-    unsigned short numVertices = (unsigned)vertices.size()/3;
-    unsigned short numFaces = (unsigned)faces.size()/3;
-    WRITE(outPipe, &numVertices, sizeof(short));
-    WRITE(outPipe, &numFaces, sizeof(short));
-    WRITE(outPipe, &vertices[0], (unsigned)(vertices.size()*sizeof(float)));
-    WRITE(outPipe, &faces[0], (unsigned)(faces.size()*sizeof(short)));
+    const unsigned short numVertices = (unsigned)vertices.size()/3;
+    const unsigned short numFaces = (unsigned)faces.size()/3;
+    if (recorder) {
+        // In a recording the definition goes ahead of the frame rather than
+        // in it, so that every frame can be played back on its own.
+        const int vertexBytes = (int)(vertices.size()*sizeof(float));
+        const int faceBytes = (int)(faces.size()*sizeof(short));
+        vector<char> record(1 + 2*sizeof(short) + vertexBytes + faceBytes);
+        char* p = &record[0];
+        *p++ = (char)DefineMesh;
+        memcpy(p, &numVertices, sizeof(short)); p += sizeof(short);
+        memcpy(p, &numFaces, sizeof(short));    p += sizeof(short);
+        memcpy(p, &vertices[0], vertexBytes);   p += vertexBytes;
+        memcpy(p, &faces[0], faceBytes);
+        recorder->appendCommand(&record[0], (int)record.size());
+    } else {
+        beginRecord(DefineMesh);
+        appendToFrame(&numVertices, sizeof(short));
+        appendToFrame(&numFaces, sizeof(short));
+        appendToFrame(&vertices[0], (int)(vertices.size()*sizeof(float)));
+        appendToFrame(&faces[0], (int)(faces.size()*sizeof(short)));
+    }
 
     drawMesh(X_GM, scale, color, (short) representation, index, 0);
 }
@@ -431,12 +532,15 @@ void VisualizerProtocol::
 drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color, 
          short representation, unsigned short meshIndex, unsigned short resolution)
 {
-    char command = (representation == DecorativeGeometry::DrawPoints 
-                    ? AddPointMesh 
-                    : (representation == DecorativeGeometry::DrawWireframe 
-                        ? AddWireframeMesh : AddSolidMesh));
-    WRITE(outPipe, &command, 1);
-    float buffer[13];
+    beginRecord(representation == DecorativeGeometry::DrawPoints 
+                ? AddPointMesh 
+                : (representation == DecorativeGeometry::DrawWireframe 
+                    ? AddWireframeMesh : AddSolidMesh));
+    unsigned short indices[2];
+    indices[0] = meshIndex;
+    indices[1] = resolution;
+    appendToFrame(indices, 2*sizeof(unsigned short));
+    float buffer[9];
     Vec3 rot = X_GM.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
     buffer[1] = (float) rot[1];
@@ -447,33 +551,50 @@ drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color,
     buffer[6] = (float) scale[0];
     buffer[7] = (float) scale[1];
     buffer[8] = (float) scale[2];
-    buffer[9] = (float) color[0];
-    buffer[10] = (float) color[1];
-    buffer[11] = (float) color[2];
-    buffer[12] = (float) color[3];
-    WRITE(outPipe, buffer, 13*sizeof(float));
-    unsigned short buffer2[2];
-    buffer2[0] = meshIndex;
-    buffer2[1] = resolution;
-    WRITE(outPipe, buffer2, 2*sizeof(unsigned short));
+    appendToFrame(buffer, 9*sizeof(float));
+    unsigned char rgba[4];
+    for (int i = 0; i < 4; ++i)
+        rgba[i] = colorToByte(color[i]);
+    appendToFrame(rgba, 4);
 }
 
 void VisualizerProtocol::
 drawLine(const Vec3& end1, const Vec3& end2, const Vec4& color, Real thickness)
 {
-    WRITE(outPipe, &AddLine, 1);
-    float buffer[10];
-    buffer[0] = (float) color[0];
-    buffer[1] = (float) color[1];
-    buffer[2] = (float) color[2];
-    buffer[3] = (float) thickness;
-    buffer[4] = (float) end1[0];
-    buffer[5] = (float) end1[1];
-    buffer[6] = (float) end1[2];
-    buffer[7] = (float) end2[0];
-    buffer[8] = (float) end2[1];
-    buffer[9] = (float) end2[2];
-    WRITE(outPipe, buffer, 10*sizeof(float));
+    // The record header is the color and thickness followed by the count.
+    const int headerBytes = 3 + sizeof(float);
+    char header[headerBytes];
+    for (int i = 0; i < 3; ++i)
+        header[i] = (char)colorToByte(color[i]);
+    const float fThickness = (float) thickness;
+    memcpy(&header[3], &fThickness, sizeof(float));
+
+    unsigned short numLines = 0;
+    if (lineRunStart >= 0) {
+        memcpy(&numLines, &frame[lineRunStart+1+headerBytes], sizeof(short));
+        if (numLines == 65535
+            || memcmp(&frame[lineRunStart+1], header, headerBytes) != 0)
+            lineRunStart = -1;
+    }
+    if (lineRunStart < 0) {
+        // Start a new run.
+        beginRecord(AddLines);
+        lineRunStart = (int)frame.size() - 1;
+        appendToFrame(header, headerBytes);
+        numLines = 0;
+        appendToFrame(&numLines, sizeof(short));
+    }
+    ++numLines;
+    memcpy(&frame[lineRunStart+1+headerBytes], &numLines, sizeof(short));
+
+    float buffer[6];
+    buffer[0] = (float) end1[0];
+    buffer[1] = (float) end1[1];
+    buffer[2] = (float) end1[2];
+    buffer[3] = (float) end2[0];
+    buffer[4] = (float) end2[1];
+    buffer[5] = (float) end2[2];
+    appendToFrame(buffer, 6*sizeof(float));
 }
 
 void VisualizerProtocol::
@@ -483,7 +604,7 @@ drawText(const Vec3& position, const Vec3& scale, const Vec4& color,
         "VisualizerProtocol::drawText()",
         "Can't display DecorativeText longer than 256 characters;"
         " received text of length %u.", (unsigned)string.size());
-    WRITE(outPipe, &AddText, 1);
+    beginRecord(AddText);
     float buffer[9];
     buffer[0] = (float) position[0];
     buffer[1] = (float) position[1];
@@ -494,17 +615,17 @@ drawText(const Vec3& position, const Vec3& scale, const Vec4& color,
     buffer[6] = (float) color[0];
     buffer[7] = (float) color[1];
     buffer[8] = (float) color[2];
-    WRITE(outPipe, buffer, 9*sizeof(float));
+    appendToFrame(buffer, 9*sizeof(float));
     short face = (short)faceCamera;
-    WRITE(outPipe, &face, sizeof(short));
+    appendToFrame(&face, sizeof(short));
     short length = (short)string.size();
-    WRITE(outPipe, &length, sizeof(short));
-    WRITE(outPipe, &string[0], length);
+    appendToFrame(&length, sizeof(short));
+    appendToFrame(string.c_str(), length);
 }
 
 void VisualizerProtocol::
 drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
-    WRITE(outPipe, &AddCoords, 1);
+    beginRecord(AddCoords);
     float buffer[12];
     Vec3 rot = X_GF.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -519,23 +640,23 @@ drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
     buffer[9] = (float) color[0];
     buffer[10]= (float) color[1];
     buffer[11]= (float) color[2];
-    WRITE(outPipe, buffer, 12*sizeof(float));
+    appendToFrame(buffer, 12*sizeof(float));
 }
 
 void VisualizerProtocol::
 addMenu(const String& title, int id, const Array_<pair<String, int> >& items) {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &DefineMenu, 1);
+    sendCommand(&DefineMenu, 1);
     short titleLength = title.size();
-    WRITE(outPipe, &titleLength, sizeof(short));
-    WRITE(outPipe, title.c_str(), titleLength);
-    WRITE(outPipe, &id, sizeof(int));
+    sendCommand(&titleLength, sizeof(short));
+    sendCommand(title.c_str(), titleLength);
+    sendCommand(&id, sizeof(int));
     short numItems = items.size();
-    WRITE(outPipe, &numItems, sizeof(short));
+    sendCommand(&numItems, sizeof(short));
     for (int i = 0; i < numItems; i++) {
         int buffer[] = {items[i].second, items[i].first.size()};
-        WRITE(outPipe, buffer, 2*sizeof(int));
-        WRITE(outPipe, items[i].first.c_str(), items[i].first.size());
+        sendCommand(buffer, 2*sizeof(int));
+        sendCommand(items[i].first.c_str(), items[i].first.size());
     }
     pthread_mutex_unlock(&sceneLock);
 }
@@ -543,16 +664,16 @@ addMenu(const String& title, int id, const Array_<pair<String, int> >& items) {
 void VisualizerProtocol::
 addSlider(const String& title, int id, Real minVal, Real maxVal, Real value) {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &DefineSlider, 1);
+    sendCommand(&DefineSlider, 1);
     short titleLength = title.size();
-    WRITE(outPipe, &titleLength, sizeof(short));
-    WRITE(outPipe, title.c_str(), titleLength);
-    WRITE(outPipe, &id, sizeof(int));
+    sendCommand(&titleLength, sizeof(short));
+    sendCommand(title.c_str(), titleLength);
+    sendCommand(&id, sizeof(int));
     float buffer[3];
     buffer[0] = (float) minVal;
     buffer[1] = (float) maxVal;
     buffer[2] = (float) value;
-    WRITE(outPipe, buffer, 3*sizeof(float));
+    sendCommand(buffer, 3*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
@@ -560,9 +681,9 @@ addSlider(const String& title, int id, Real minVal, Real maxVal, Real value) {
 void VisualizerProtocol::setSliderValue(int id, Real newValue) const {
     const float value = (float)newValue;
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetSliderValue, 1);
-    WRITE(outPipe, &id, sizeof(int));
-    WRITE(outPipe, &value, sizeof(float));
+    sendCommand(&SetSliderValue, 1);
+    sendCommand(&id, sizeof(int));
+    sendCommand(&value, sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
@@ -570,26 +691,26 @@ void VisualizerProtocol::setSliderRange(int id, Real newMin, Real newMax) const
     float buffer[2];
     buffer[0] = (float)newMin; buffer[1] = (float)newMax;
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetSliderRange, 1);
-    WRITE(outPipe, &id, sizeof(int));
-    WRITE(outPipe, buffer, 2*sizeof(float));
+    sendCommand(&SetSliderRange, 1);
+    sendCommand(&id, sizeof(int));
+    sendCommand(buffer, 2*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setWindowTitle(const String& title) const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetWindowTitle, 1);
+    sendCommand(&SetWindowTitle, 1);
     short titleLength = title.size();
-    WRITE(outPipe, &titleLength, sizeof(short));
-    WRITE(outPipe, title.c_str(), titleLength);
+    sendCommand(&titleLength, sizeof(short));
+    sendCommand(title.c_str(), titleLength);
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setMaxFrameRate(Real rate) const {
     const float frameRate = (float)rate;
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetMaxFrameRate, 1);
-    WRITE(outPipe, &frameRate, sizeof(float));
+    sendCommand(&SetMaxFrameRate, 1);
+    sendCommand(&frameRate, sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
@@ -600,30 +721,30 @@ void VisualizerProtocol::setBackgroundColor(const Vec3& color) const {
     buffer[1] = (float)color[1]; 
     buffer[2] = (float)color[2];
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetBackgroundColor, 1);
-    WRITE(outPipe, buffer, 3*sizeof(float));
+    sendCommand(&SetBackgroundColor, 1);
+    sendCommand(buffer, 3*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setShowShadows(bool shouldShow) const {
     const short show = (short)shouldShow; // 0 or 1
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetShowShadows, 1);
-    WRITE(outPipe, &show, sizeof(short));
+    sendCommand(&SetShowShadows, 1);
+    sendCommand(&show, sizeof(short));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setBackgroundType(Visualizer::BackgroundType type) const {
     const short backgroundType = (short)type;
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetBackgroundType, 1);
-    WRITE(outPipe, &backgroundType, sizeof(short));
+    sendCommand(&SetBackgroundType, 1);
+    sendCommand(&backgroundType, sizeof(short));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setCameraTransform(const Transform& X_GC) const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetCamera, 1);
+    sendCommand(&SetCamera, 1);
     float buffer[6];
     Vec3 rot = X_GC.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -632,19 +753,19 @@ void VisualizerProtocol::setCameraTransform(const Transform& X_GC) const {
     buffer[3] = (float) X_GC.p()[0];
     buffer[4] = (float) X_GC.p()[1];
     buffer[5] = (float) X_GC.p()[2];
-    WRITE(outPipe, buffer, 6*sizeof(float));
+    sendCommand(buffer, 6*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::zoomCamera() const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &ZoomCamera, 1);
+    sendCommand(&ZoomCamera, 1);
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::lookAt(const Vec3& point, const Vec3& upDirection) const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &LookAt, 1);
+    sendCommand(&LookAt, 1);
     float buffer[6];
     buffer[0] = (float) point[0];
     buffer[1] = (float) point[1];
@@ -652,45 +773,45 @@ void VisualizerProtocol::lookAt(const Vec3& point, const Vec3& upDirection) cons
     buffer[3] = (float) upDirection[0];
     buffer[4] = (float) upDirection[1];
     buffer[5] = (float) upDirection[2];
-    WRITE(outPipe, buffer, 6*sizeof(float));
+    sendCommand(buffer, 6*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setFieldOfView(Real fov) const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetFieldOfView, 1);
+    sendCommand(&SetFieldOfView, 1);
     float buffer[1];
     buffer[0] = (float)fov;
-    WRITE(outPipe, buffer, sizeof(float));
+    sendCommand(buffer, sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setClippingPlanes(Real near, Real far) const {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetClipPlanes, 1);
+    sendCommand(&SetClipPlanes, 1);
     float buffer[2];
     buffer[0] = (float)near;
     buffer[1] = (float)far;
-    WRITE(outPipe, buffer, 2*sizeof(float));
+    sendCommand(buffer, 2*sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::
 setSystemUpDirection(const CoordinateDirection& upDir) {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetSystemUpDirection, 1);
+    sendCommand(&SetSystemUpDirection, 1);
     const unsigned char axis = (unsigned char)upDir.getAxis();
     const signed char   sign = (signed char)upDir.getDirection();
-    WRITE(outPipe, &axis, 1);
-    WRITE(outPipe, &sign, 1);
+    sendCommand(&axis, 1);
+    sendCommand(&sign, 1);
     pthread_mutex_unlock(&sceneLock);
 }
 
 void VisualizerProtocol::setGroundHeight(Real height) {
     pthread_mutex_lock(&sceneLock);
-    WRITE(outPipe, &SetGroundHeight, 1);
+    sendCommand(&SetGroundHeight, 1);
     float heightBuffer = (float) height;
-    WRITE(outPipe, &heightBuffer, sizeof(float));
+    sendCommand(&heightBuffer, sizeof(float));
     pthread_mutex_unlock(&sceneLock);
 }
 
@@ -28,6 +28,7 @@
 #include "simbody/internal/Visualizer.h"
 #include <pthread.h>
 #include <utility>
+#include <vector>
 
 using namespace SimTK;
 
@@ -38,7 +39,7 @@ using namespace SimTK;
 
 // Increment this every time you make *any* change to the protocol;
 // we insist on an exact match.
-static const unsigned ProtocolVersion   = 29;
+static const unsigned ProtocolVersion   = 31;
 
 // The VisualizerGUI has several predefined cached meshes for common
 // shapes so that we don't have to send them. These are the mesh 
@@ -53,6 +54,25 @@ static const unsigned short MeshCircle           = 3;
 static const unsigned short NumPredefinedMeshes  = 4;
 
 // Commands sent to the GUI.
+//
+// All the commands that make up a scene are sent as a single frame: the
+// StartOfScene command is followed by an unsigned int giving the number of
+// bytes in the rest of the frame, which starts with the (float) simulation
+// time and ends with EndOfScene. The GUI reads the whole frame at once and
+// decodes it from memory. Within a frame, the mesh and line records use a
+// compact layout with colors sent as unsigned bytes:
+//
+//   AddSolidMesh, AddPointMesh, AddWireframeMesh:
+//      unsigned short meshIndex, resolution
+//      float rotation[3] (body fixed XYZ), position[3], scale[3]
+//      unsigned char rgba[4]
+//   AddLines (a run of lines that share color and thickness):
+//      unsigned char rgb[3]
+//      float thickness
+//      unsigned short numLines
+//      float ends[6*numLines]
+//
+// Multi-byte values are not aligned within a frame.
 
 // This should always be command #1 so we can reliably check whether
 // we're talking to a compatible protocol.
@@ -63,7 +83,7 @@ static const unsigned char EndOfScene            = 3;
 static const unsigned char AddSolidMesh          = 4;
 static const unsigned char AddPointMesh          = 5;
 static const unsigned char AddWireframeMesh      = 6;
-static const unsigned char AddLine               = 7;
+static const unsigned char AddLines              = 7;
 static const unsigned char AddText               = 8;
 static const unsigned char AddCoords             = 9;
 static const unsigned char DefineMesh            = 10;
@@ -96,11 +116,21 @@ static const unsigned char KeyPressed            = 2;
 static const unsigned char MenuSelected          = 3;
 static const unsigned char SliderMoved           = 4;
 
+namespace SimTK {
+class VisualizerRecorder;
+}
+
 class VisualizerProtocol {
 public:
+    // Launch the VisualizerGUI and connect to it, unless a recording file
+    // name is given. In that case no GUI is launched and all the commands are
+    // written to that file instead; see VisualizerRecorder.
     VisualizerProtocol(Visualizer& visualizer,
-                       const Array_<String>& searchPath);
+                       const Array_<String>& searchPath,
+                       const String& recordingFileName = String());
+    ~VisualizerProtocol();
     void shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe);
+    bool isRecording() const {return recorder != 0;}
     void beginScene(Real simTime);
     void finishScene();
     void drawBox(const Transform& transform, const Vec3& scale, 
@@ -142,11 +172,45 @@ public:
     void lookAt(const Vec3& point, const Vec3& upDirection) const;
     void setFieldOfView(Real fov) const;
     void setClippingPlanes(Real near, Real far) const;
+
+    // Send one frame of a recording being played back, preceded by the 
+    // setup commands recorded ahead of it. If we are ourselves recording, the
+    // frame is indexed just like one drawn here.
+    void sendRecordedFrame(Real simTime, const std::vector<char>& setup, 
+                           const std::vector<char>& frameCommands);
+
+    // If recording, the number of frames dropped because the disk couldn't 
+    // keep up; otherwise zero.
+    int getNumDroppedFrames() const;
 private:
     void drawMesh(const Transform& transform, const Vec3& scale, 
                   const Vec4& color, short representation, 
                   unsigned short meshIndex, unsigned short resolution);
+    void beginRecord(unsigned char command);
+    void appendToFrame(const void* data, int bytes);
+    // Send a command that isn't part of a scene. The caller must hold the
+    // scene lock.
+    void sendCommand(const void* data, int bytes) const;
+
+    // Not copyable.
+    VisualizerProtocol(const VisualizerProtocol&);
+    VisualizerProtocol& operator=(const VisualizerProtocol&);
+
     int outPipe;
+    // If we're recording rather than talking to a GUI, this is where
+    // everything goes. Otherwise it is null.
+    VisualizerRecorder* recorder;
+
+    // The commands for the scene currently being drawn are accumulated here
+    // and sent to the GUI with a single write() in finishScene(). The buffer
+    // is reused from frame to frame, so it stops allocating memory once it
+    // has grown to fit the largest scene.
+    std::vector<char> frame;
+    // The offset within the frame of the most recent record if that was an
+    // AddLines record, otherwise -1. Consecutive lines of the same color and
+    // thickness are appended to that record rather than starting a new one.
+    int lineRunStart;
+    Real sceneTime;
 
     // For user-defined meshes, map their unique memory addresses to the 
     // assigned VisualizerGUI cache index.
@@ -0,0 +1,359 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "VisualizerRecorder.h"
+#include "VisualizerProtocol.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+using namespace SimTK;
+
+static void* writerBody(void* arg) {
+    reinterpret_cast<VisualizerRecorder*>(arg)->runWriter();
+    return 0;
+}
+
+// Recordings can be larger than 2GB, so use 64 bit file offsets.
+static int seekTo(FILE* file, long long offset, int origin) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, (off_t)offset, origin);
+#endif
+}
+
+static long long tellOffset(FILE* file) {
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return (long long)ftello(file);
+#endif
+}
+
+// Sizes of the fixed parts of a recording file.
+static const long long RecordingHeaderBytes = 
+    sizeof(RecordingMagic) + sizeof(unsigned);
+static const long long RecordingTrailerBytes = 
+    4*sizeof(long long) + sizeof(RecordingIndexMagic);
+static const long long RecordingEntryBytes = 
+    sizeof(long long) + sizeof(double);
+
+
+
+//==============================================================================
+//                           VISUALIZER RECORDER
+//==============================================================================
+
+VisualizerRecorder::VisualizerRecorder
+   (const String& fileName, unsigned protocolVersion)
+:   fileName(fileName), closing(false), writeError(0), bytesAppended(0),
+    inSetupRun(false), numDroppedFrames(0)
+{
+    file = fopen(fileName.c_str(), "wb");
+    SimTK_ERRCHK3_ALWAYS(file != 0, "VisualizerRecorder::ctor()",
+        "Unable to open recording file '%s' for writing; errno=%d (%s).",
+        fileName.c_str(), errno, strerror(errno));
+
+    // The header is written directly since the writer isn't running yet.
+    writeToFile(RecordingMagic, sizeof(RecordingMagic));
+    writeToFile(&protocolVersion, sizeof(unsigned));
+    SimTK_ERRCHK3_ALWAYS(writeError == 0, "VisualizerRecorder::ctor()",
+        "Unable to write to recording file '%s'; errno=%d (%s).",
+        fileName.c_str(), writeError, strerror(writeError));
+    bytesAppended = RecordingHeaderBytes;
+
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&dataAvailable, NULL);
+    pthread_create(&writerThread, NULL, writerBody, this);
+}
+
+VisualizerRecorder::~VisualizerRecorder() {
+    // Let the writer drain what's left, then wait for it to exit.
+    pthread_mutex_lock(&lock);
+    closing = true;
+    pthread_cond_signal(&dataAvailable);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writerThread, NULL);
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&dataAvailable);
+
+    // Now we own the file again; finish with the indexes and trailer.
+    const long long frameIndexOffset = bytesAppended;
+    const long long numFrames = (long long)frames.size();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        writeToFile(&frames[i].first, sizeof(long long));
+        writeToFile(&frames[i].second, sizeof(double));
+    }
+    const long long setupIndexOffset = 
+        frameIndexOffset + numFrames*RecordingEntryBytes;
+    const long long numSetupRuns = (long long)setupRuns.size();
+    for (size_t i = 0; i < setupRuns.size(); ++i) {
+        writeToFile(&setupRuns[i].first, sizeof(long long));
+        writeToFile(&setupRuns[i].second, sizeof(long long));
+    }
+    writeToFile(&frameIndexOffset, sizeof(long long));
+    writeToFile(&numFrames, sizeof(long long));
+    writeToFile(&setupIndexOffset, sizeof(long long));
+    writeToFile(&numSetupRuns, sizeof(long long));
+    writeToFile(RecordingIndexMagic, sizeof(RecordingIndexMagic));
+    if (fclose(file) != 0 && writeError == 0)
+        writeError = errno;
+
+    // Destructors can't throw.
+    if (writeError != 0)
+        std::cerr << "Visualizer: error writing recording file '" << fileName
+                  << "': " << strerror(writeError) << std::endl;
+}
+
+void VisualizerRecorder::appendCommand(const void* data, int bytes) {
+    if (!inSetupRun) {
+        setupRuns.push_back(RecordingSetupEntry(bytesAppended, 0));
+        inSetupRun = true;
+    }
+    append(data, bytes, false);
+    setupRuns.back().second += bytes;
+}
+
+// A dropped frame leaves nothing in the file, so any setup commands on either
+// side of it simply continue the same setup run.
+void VisualizerRecorder::appendFrame(Real simTime, const void* data, int bytes) {
+    const long long offset = bytesAppended;
+    if (!append(data, bytes, true)) {
+        ++numDroppedFrames;
+        return;
+    }
+    frames.push_back(RecordingFrameEntry(offset, (double)simTime));
+    inSetupRun = false;
+}
+
+bool VisualizerRecorder::append(const void* data, int bytes, bool droppable) {
+    const char* p = reinterpret_cast<const char*>(data);
+    pthread_mutex_lock(&lock);
+    // Don't let the pending buffer grow without limit if the disk can't keep
+    // up, but always accept at least one append into an empty buffer.
+    const int error = writeError;
+    const bool wasEmpty = pending.empty();
+    const bool drop = droppable && !wasEmpty 
+                      && pending.size() + bytes > MaxPendingBytes;
+    if (error == 0 && !drop)
+        pending.insert(pending.end(), p, p+bytes);
+    pthread_mutex_unlock(&lock);
+
+    SimTK_ERRCHK3_ALWAYS(error == 0, "VisualizerRecorder::append()",
+        "Unable to write to recording file '%s'; errno=%d (%s).",
+        fileName.c_str(), error, strerror(error));
+    if (drop)
+        return false;
+    bytesAppended += bytes;
+
+    // The writer only waits when it has found the pending buffer empty.
+    if (wasEmpty)
+        pthread_cond_signal(&dataAvailable);
+    return true;
+}
+
+void VisualizerRecorder::runWriter() {
+    pthread_mutex_lock(&lock);
+    while (true) {
+        while (pending.empty() && !closing)
+            pthread_cond_wait(&dataAvailable, &lock);
+        if (pending.empty())
+            break; // closing, and nothing left to write
+        // Take the full buffer and give back the empty one, which keeps its
+        // capacity so the simulation thread rarely needs to allocate.
+        pending.swap(writing);
+        const int error = writeError;
+        pthread_mutex_unlock(&lock);
+
+        // Once a write has failed we just discard data; the next append()
+        // will report the error.
+        int newError = 0;
+        if (error == 0 && fwrite(&writing[0], 1, writing.size(), file) 
+                          != writing.size())
+            newError = (errno != 0 ? errno : EIO);
+        writing.clear();
+
+        pthread_mutex_lock(&lock);
+        if (newError != 0)
+            writeError = newError;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+// This is used only while the writer thread isn't running.
+void VisualizerRecorder::writeToFile(const void* data, size_t bytes) {
+    if (writeError != 0 || bytes == 0)
+        return;
+    if (fwrite(data, 1, bytes, file) != bytes)
+        writeError = (errno != 0 ? errno : EIO);
+}
+
+
+
+//==============================================================================
+//                        VISUALIZER RECORDING READER
+//==============================================================================
+
+VisualizerRecordingReader::VisualizerRecordingReader(const String& fileName)
+:   fileName(fileName), bodyEnd(0)
+{
+    file = fopen(fileName.c_str(), "rb");
+    SimTK_ERRCHK3_ALWAYS(file != 0, "VisualizerRecordingReader::ctor()",
+        "Unable to open recording file '%s' for reading; errno=%d (%s).",
+        fileName.c_str(), errno, strerror(errno));
+    try {
+        char magic[8];
+        unsigned version;
+        readAt(0, magic, sizeof(magic));
+        readAt(sizeof(magic), &version, sizeof(unsigned));
+        SimTK_ERRCHK1_ALWAYS
+           (memcmp(magic, RecordingMagic, sizeof(magic)) == 0,
+            "VisualizerRecordingReader::ctor()",
+            "File '%s' is not a Visualizer recording.", fileName.c_str());
+        SimTK_ERRCHK3_ALWAYS(version == ProtocolVersion,
+            "VisualizerRecordingReader::ctor()",
+            "Recording '%s' uses protocol version %u but this is version %u.",
+            fileName.c_str(), version, ProtocolVersion);
+
+        SimTK_ERRCHK_ALWAYS(seekTo(file, 0, SEEK_END) == 0,
+            "VisualizerRecordingReader::ctor()", "Can't seek in the file.");
+        const long long size = tellOffset(file);
+        SimTK_ERRCHK1_ALWAYS
+           (size >= RecordingHeaderBytes + RecordingTrailerBytes,
+            "VisualizerRecordingReader::ctor()",
+            "Recording '%s' is incomplete.", fileName.c_str());
+        const long long trailer = size - RecordingTrailerBytes;
+        long long counts[4]; // frame index offset, frames, setup offset, runs
+        readAt(trailer, counts, sizeof(counts));
+        readAt(trailer + sizeof(counts), magic, sizeof(magic));
+        SimTK_ERRCHK1_ALWAYS
+           (memcmp(magic, RecordingIndexMagic, sizeof(magic)) == 0,
+            "VisualizerRecordingReader::ctor()",
+            "Recording '%s' is incomplete; it has no index.", 
+            fileName.c_str());
+
+        // The indexes must exactly fill the space between the body and the
+        // trailer.
+        bodyEnd = counts[0];
+        const long long numFrames = counts[1], numRuns = counts[3];
+        SimTK_ERRCHK1_ALWAYS(bodyEnd >= RecordingHeaderBytes 
+            && numFrames >= 0 && numRuns >= 0
+            && numFrames <= (trailer-bodyEnd)/RecordingEntryBytes
+            && counts[2] == bodyEnd + numFrames*RecordingEntryBytes
+            && counts[2] + numRuns*RecordingEntryBytes == trailer,
+            "VisualizerRecordingReader::ctor()",
+            "Recording '%s' has a corrupt index.", fileName.c_str());
+
+        frames.resize((size_t)numFrames);
+        for (long long i = 0; i < numFrames; ++i) {
+            readAt(bodyEnd + i*RecordingEntryBytes, &frames[i].first, 
+                   sizeof(long long));
+            readAt(bodyEnd + i*RecordingEntryBytes + sizeof(long long), 
+                   &frames[i].second, sizeof(double));
+        }
+        setupRuns.resize((size_t)numRuns);
+        for (long long i = 0; i < numRuns; ++i) {
+            readAt(counts[2] + i*RecordingEntryBytes, &setupRuns[i].first, 
+                   sizeof(long long));
+            readAt(counts[2] + i*RecordingEntryBytes + sizeof(long long), 
+                   &setupRuns[i].second, sizeof(long long));
+        }
+
+        // Everything indexed must be in order and lie within the body.
+        long long prevEnd = RecordingHeaderBytes;
+        for (size_t i = 0, j = 0; i < frames.size() || j < setupRuns.size();) {
+            const bool isFrame = j == setupRuns.size() 
+                || (i < frames.size() && frames[i].first < setupRuns[j].first);
+            const long long start = isFrame ? frames[i].first 
+                                            : setupRuns[j].first;
+            const long long bytes = isFrame ? 1 : setupRuns[j].second;
+            SimTK_ERRCHK1_ALWAYS(start >= prevEnd && bytes > 0 
+                                 && bytes <= bodyEnd - start,
+                "VisualizerRecordingReader::ctor()",
+                "Recording '%s' has a corrupt index.", fileName.c_str());
+            prevEnd = start + bytes;
+            if (isFrame) ++i; else ++j;
+        }
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+}
+
+VisualizerRecordingReader::~VisualizerRecordingReader() {
+    fclose(file);
+}
+
+double VisualizerRecordingReader::getFrameTime(int frame) const {
+    SimTK_INDEXCHECK_ALWAYS(frame, getNumFrames(), 
+        "VisualizerRecordingReader::getFrameTime()");
+    return frames[frame].second;
+}
+
+void VisualizerRecordingReader::
+readFrame(int frame, int previousFrame, std::vector<char>& setup,
+          std::vector<char>& frameCommands) const {
+    SimTK_INDEXCHECK_ALWAYS(frame, getNumFrames(), 
+        "VisualizerRecordingReader::readFrame()");
+    SimTK_ERRCHK2_ALWAYS(-1 <= previousFrame && previousFrame < frame,
+        "VisualizerRecordingReader::readFrame()",
+        "Previous frame %d must be -1 or come before frame %d.", 
+        previousFrame, frame);
+    setup.clear();
+
+    // The setup runs between the two frames.
+    const long long start = previousFrame < 0 ? 0 
+                                              : frames[previousFrame].first;
+    const long long offset = frames[frame].first;
+    std::vector<RecordingSetupEntry>::const_iterator run = std::lower_bound
+       (setupRuns.begin(), setupRuns.end(), RecordingSetupEntry(start, 0));
+    for (; run != setupRuns.end() && run->first < offset; ++run) {
+        const size_t size = setup.size();
+        setup.resize(size + (size_t)run->second);
+        readAt(run->first, &setup[size], (size_t)run->second);
+    }
+
+    // Then the frame itself, whose size is in its header.
+    unsigned char command;
+    unsigned frameBytes;
+    readAt(offset, &command, 1);
+    readAt(offset + 1, &frameBytes, sizeof(unsigned));
+    const long long totalBytes = 1 + sizeof(unsigned) + (long long)frameBytes;
+    SimTK_ERRCHK2_ALWAYS(command == StartOfScene 
+                         && totalBytes <= bodyEnd - offset,
+        "VisualizerRecordingReader::readFrame()",
+        "Frame %d of recording '%s' is corrupt.", frame, fileName.c_str());
+    frameCommands.resize((size_t)totalBytes);
+    readAt(offset, &frameCommands[0], (size_t)totalBytes);
+}
+
+void VisualizerRecordingReader::
+readAt(long long offset, void* data, size_t bytes) const {
+    SimTK_ERRCHK1_ALWAYS(seekTo(file, offset, SEEK_SET) == 0 
+                         && fread(data, 1, bytes, file) == bytes,
+        "VisualizerRecordingReader::readAt()",
+        "Unable to read from recording file '%s'.", fileName.c_str());
+}
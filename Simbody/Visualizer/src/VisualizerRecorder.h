@@ -0,0 +1,156 @@
+#ifndef SimTK_SIMBODY_VISUALIZER_RECORDER_H_
+#define SimTK_SIMBODY_VISUALIZER_RECORDER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include <cstdio>
+#include <pthread.h>
+#include <utility>
+#include <vector>
+
+/** @file
+ * This defines the classes that write and read a Visualizer recording file,
+ * used when the Visualizer is running without a VisualizerGUI.
+ */
+
+namespace SimTK {
+
+// A recording file consists of
+//
+//   Header:  char magic[8] = RecordingMagic
+//            unsigned ProtocolVersion
+//   Body:    the commands that would have been sent to the VisualizerGUI
+//            after the handshake, in the same format, except that a mesh
+//            definition is written ahead of the frame that first uses it
+//            rather than inside it
+//   Frames:  for each frame: long long offset of its StartOfScene command
+//            from the start of the file, double simulation time
+//   Setup:   for each run of commands between frames: long long offset, 
+//            long long number of bytes
+//   Trailer: long long offset of the frame index, long long number of 
+//            frames, long long offset of the setup index, long long number
+//            of setup runs, char magic[8] = RecordingIndexMagic
+//
+// Every frame is complete in itself; it depends only on the setup commands
+// (mesh definitions, menus, sliders, camera settings, and so on) that came
+// before it. The setup index lets a reader collect those without scanning
+// the frames, so playback can start at any frame. The indexes are written 
+// when the recording is closed; if that never happens the body can still be
+// read from the beginning since every command is self-delimiting.
+static const char RecordingMagic[8]      = {'S','i','m','T','K','V','i','z'};
+static const char RecordingIndexMagic[8] = {'S','i','m','T','K','I','d','x'};
+
+// Index entries: (offset, simulation time) for a frame, and (offset, bytes)
+// for a setup run.
+typedef std::pair<long long, double>    RecordingFrameEntry;
+typedef std::pair<long long, long long> RecordingSetupEntry;
+
+/* This receives commands and frames from VisualizerProtocol and writes them 
+to a recording file on a background thread. The simulation thread appends to
+one buffer while the writer thread empties the other; they trade buffers each
+time the writer is done. Appending only copies the data, so the simulation is
+never held up by the disk. If the writer falls more than MaxPendingBytes 
+behind, frames are dropped (and counted) until it catches up. Setup commands
+are never dropped since every later frame may depend on them. */
+class VisualizerRecorder {
+public:
+    static const size_t MaxPendingBytes = 64*1024*1024;
+
+    VisualizerRecorder(const String& fileName, unsigned protocolVersion);
+    // Finish writing everything that was appended, then add the indexes and
+    // close the file.
+    ~VisualizerRecorder();
+
+    // Append (part of) a command other than a scene. Consecutive commands
+    // are indexed together as one setup run.
+    void appendCommand(const void* data, int bytes);
+    // Append a complete frame, starting with its StartOfScene command, and
+    // add it to the index, unless the writer is too far behind.
+    void appendFrame(Real simTime, const void* data, int bytes);
+
+    const String& getFileName() const {return fileName;}
+    int getNumFrames() const {return (int)frames.size();}
+    int getNumDroppedFrames() const {return numDroppedFrames;}
+
+    // This is the main loop of the writer thread.
+    void runWriter();
+private:
+    // Returns false if the data was droppable and had to be dropped.
+    bool append(const void* data, int bytes, bool droppable);
+    void writeToFile(const void* data, size_t bytes);
+
+    String              fileName;
+    FILE*               file;
+    pthread_t           writerThread;
+
+    // Everything below is protected by lock, except that the writing buffer
+    // belongs to the writer thread while the lock is not held.
+    pthread_mutex_t     lock;
+    pthread_cond_t      dataAvailable;
+    std::vector<char>   pending;    // appended to by the simulation thread
+    std::vector<char>   writing;    // written to the file by the writer
+    bool                closing;
+    int                 writeError; // errno from a failed write, else 0
+
+    // These are only touched by the simulation thread.
+    long long                           bytesAppended;
+    std::vector<RecordingFrameEntry>    frames;
+    std::vector<RecordingSetupEntry>    setupRuns;
+    bool                                inSetupRun;
+    int                                 numDroppedFrames;
+};
+
+/* This reads a recording file written by VisualizerRecorder. Opening it reads
+only the header and the indexes; frames are read from the file on request. */
+class VisualizerRecordingReader {
+public:
+    // Throws if the file can't be read or isn't a complete recording made
+    // with the current protocol.
+    explicit VisualizerRecordingReader(const String& fileName);
+    ~VisualizerRecordingReader();
+
+    int getNumFrames() const {return (int)frames.size();}
+    double getFrameTime(int frame) const;
+
+    // Read what a VisualizerGUI that has already been sent everything 
+    // through previousFrame must be sent to show this frame: the setup 
+    // commands recorded after previousFrame and before this frame, and then
+    // the frame itself starting with its StartOfScene command. Use 
+    // previousFrame=-1 to start playback at this frame.
+    void readFrame(int frame, int previousFrame, std::vector<char>& setup,
+                   std::vector<char>& frameCommands) const;
+private:
+    void readAt(long long offset, void* data, size_t bytes) const;
+
+    String                              fileName;
+    FILE*                               file;
+    std::vector<RecordingFrameEntry>    frames;
+    std::vector<RecordingSetupEntry>    setupRuns;
+    long long                           bodyEnd; // where the indexes begin
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_VISUALIZER_RECORDER_H_
@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "simbody/internal/common.h"
+#include "simbody/internal/Visualizer_Recording.h"
+#include "VisualizerRecorder.h"
+
+using namespace SimTK;
+
+Visualizer::Recording::Recording(const String& fileName) 
+:   fileName(fileName), reader(new VisualizerRecordingReader(fileName)) {}
+
+Visualizer::Recording::~Recording() {delete reader;}
+
+const String& Visualizer::Recording::getFileName() const {return fileName;}
+
+int Visualizer::Recording::getNumFrames() const 
+{   return reader->getNumFrames(); }
+
+Real Visualizer::Recording::getFrameTime(int frame) const 
+{   return (Real)reader->getFrameTime(frame); }
+
+// Frames are recorded in the order they were reported, which is normally in
+// order of increasing time, so we can use a binary search.
+int Visualizer::Recording::findFrame(Real time) const {
+    int lo = 0, hi = getNumFrames();
+    while (lo < hi) {
+        const int mid = (lo+hi)/2;
+        if (getFrameTime(mid) < time)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
@@ -70,5 +70,6 @@ will include this one). **/
 #include "simbody/internal/Visualizer.h"
 #include "simbody/internal/Visualizer_InputListener.h"
 #include "simbody/internal/Visualizer_Reporter.h"
+#include "simbody/internal/Visualizer_Recording.h"
 
 #endif // SimTK_SIMBODY_SimTKSIMBODY_H_
@@ -70,6 +70,33 @@ void setTransitionVelocity(Real vt);
 /** Get a precalculated 1/vt to avoid expensive runtime divisions. **/
 Real getOOTransitionVelocity() const;
 
+/** Request that the forces for the active contacts be calculated 
+concurrently. This is off by default. When it is on, the active contacts are
+divided into blocks of consecutive contacts that are processed by a pool of 
+threads, each contact's force going into its own slot; the forces are then
+gathered in contact order. The results are identical to the serial results 
+and don't depend on the number of threads. Every ContactForceGenerator in use
+must be able to calculate forces for different contacts at the same time;
+the built-in ones can. Parallel calculation is used only when there are at 
+least getParallelForceThreshold() active contacts, and never when 
+realization is already running on a pool thread. **/
+void setUseParallelForceEvaluation(bool useParallel);
+/** Return whether parallel contact force calculation has been requested. **/
+bool getUseParallelForceEvaluation() const;
+
+/** Set the minimum number of active contacts that must be present before 
+the thread pool is used. The default is 16. **/
+void setParallelForceThreshold(int minContacts);
+/** Get the minimum number of active contacts for parallel calculation. **/
+int getParallelForceThreshold() const;
+
+/** Set the number of threads used for parallel contact force calculation.
+Zero (the default) means use one thread per processor. **/
+void setNumParallelForceThreads(int numThreads);
+/** Get the number of threads to be used for parallel contact force 
+calculation; this is the number of processors if none was set. **/
+int getNumParallelForceThreads() const;
+
 /** Determine how many of the active Contacts are currently generating
 contact forces. You can call this at Velocity stage or later; the contact
 forces will be realized first if necessary before we report how many there 
@@ -745,14 +772,14 @@ void calcContactForceAndDetails
 
 void calcWeightedPatchCentroid
    (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const;
                        
 void processOneMesh
    (const State&                            state,
     const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     const Transform&                        X_MO, 
     const SpatialVec&                       V_MO,
     const ContactGeometry&                  other,
@@ -162,6 +162,14 @@ const ContactSurface& getContactSurface(ContactSurfaceIndex surfIx) const;
 /** Get the transform X_BS that gives the pose of the indicated contact
 surface with respect to the body frame of the body to which it is attached. **/
 const Transform& getContactSurfaceTransform(ContactSurfaceIndex surfIx) const;
+/** Get the current pose X_GS of every contact surface in Ground, indexed by 
+ContactSurfaceIndex. These are calculated together the first time any of
+them is needed after the positions change, and contact tracking uses them, so
+a force subsystem responding to the active contacts can use these rather than
+recalculating them. 
+@pre \a state realized to Stage::Position **/
+const Array_<Transform,ContactSurfaceIndex>& 
+getContactSurfaceTransformsInGround(const State& state) const;
 
 /** Register the contact tracking algorithm to use for a particular pair of 
 ContactGeometry types, replacing the existing tracker if any. If the tracker 
@@ -185,6 +193,53 @@ const ContactTracker& getContactTracker(ContactGeometryTypeId surface1,
                                         ContactGeometryTypeId surface2,
                                         bool& reverseOrder) const;
 
+/** These are the available "broad phase" algorithms, which use a bounding
+sphere ("bubble") around each contact surface to find the pairs of surfaces
+that are close enough to need a look by a ContactTracker. Both methods find
+exactly the same pairs; they differ only in speed. **/
+enum BroadPhaseMethod {
+    /** Sort the bubbles along the one axis having the most spread in bubble
+    locations and sweep along it. This is rebuilt from scratch each time and
+    can approach O(n^2) when many bubbles overlap along that axis. **/
+    SingleAxisSweep             = 0,
+    /** Keep the bubble extents sorted along all three axes in the State's
+    cache, bring them up to date with an insertion sort (nearly linear time
+    when bodies have moved only a little since the last evaluation), and 
+    sweep along whichever axis has the fewest overlapping extents, checking
+    overlap on the other two axes before testing the spheres. This is the
+    default. **/
+    IncrementalSweepAndPrune    = 1
+};
+
+/** Select the broad phase algorithm this subsystem uses. This does not
+change any results so may be done at any time. 
+@see BroadPhaseMethod **/
+void setBroadPhaseMethod(BroadPhaseMethod method);
+/** Return the broad phase algorithm currently in use. **/
+BroadPhaseMethod getBroadPhaseMethod() const;
+
+/** Set how far ahead (in time) contacts should be predicted from the current
+surface velocities and accelerations. When this is positive, 
+getPredictedContacts() contains an AnticipatedContact for each pair of 
+surfaces that is not touching now but might touch within this interval, and
+this subsystem asks for a scheduled event at the earliest predicted onset so
+that a TimeStepper ends a step there rather than stepping through a thin
+object; a pair found already at its onset gets a short follow-up step so
+that the next step begins in contact. The default is zero, meaning that no
+prediction is done. Changing this invalidates the Topology stage. **/
+void setContactPredictionInterval(Real interval);
+/** Return the current contact prediction interval; zero means contact
+prediction is off. @see setContactPredictionInterval() **/
+Real getContactPredictionInterval() const;
+
+/** Run only the broad phase for the given State (which must be realized
+through Position stage) and return the pairs of surfaces whose bounding
+spheres overlap and that are not excluded by being on the same body or in
+a common clique. Each pair is returned once, lower surface index first, in
+ascending order. This is mostly useful for testing and benchmarking. **/
+void findBroadPhasePairs(const State& state, 
+    Array_<std::pair<ContactSurfaceIndex,ContactSurfaceIndex> >& pairs) const;
+
 /** Obtain the value of the ContactSnapshot state variable representing the 
 most recently known set of Contacts for this system. **/
 const ContactSnapshot& getPreviousActiveContacts(const State& state) const;
@@ -251,18 +306,20 @@ that are being tracked at a particular instant during a simulation. These are
 suitable for use as state variables for remembering past contact status and
 as calculated cache entries containing the current contact status. Each
 tracked surface pair has an integer ContactId that is persistent for as long
-as a particular interaction is being tracked. We maintain a map providing 
-very fast access to individual Contact entries by ContactId. There is also
-a map from ContactSurfaceIndex pairs to ContactId that can be used to see
+as a particular interaction is being tracked. We maintain a table providing 
+fast access to individual Contact entries by ContactId. There is also
+a table from ContactSurfaceIndex pairs to ContactId that can be used to see
 whether we are already tracking a Contact between those surfaces; there can
-be at most one Contact between a given surface pair at any given moment. **/
+be at most one Contact between a given surface pair at any given moment. 
+The tables are sorted arrays rather than maps so that clearing a snapshot 
+and refilling it, as is done for the cache entries on every evaluation, 
+reuses their heap space. **/
 class SimTK_SIMBODY_EXPORT ContactSnapshot {
-//TODO: replace with fast hash tables
-typedef std::map<ContactId,int>     ContactMap;
+typedef std::pair<ContactSurfaceIndex,ContactSurfaceIndex> SurfacePair;
 // Note: we always order the key so that the first surface index is less than
 // the second (they can't be equal!).
-typedef std::map<std::pair<ContactSurfaceIndex,ContactSurfaceIndex>, 
-                 ContactId>         SurfaceMap;
+typedef Array_<std::pair<ContactId,int> >           ContactMap;
+typedef Array_<std::pair<SurfacePair,ContactId> >   SurfaceMap;
 public:
 /** Default constructor sets timestamp to NaN. **/
 ContactSnapshot() : m_time(NaN) {}
@@ -299,19 +356,18 @@ void adoptContact(Contact& contact) {
 
     const int indx = m_contacts.size();
     m_contacts.push_back(contact); // shallow copy
-    m_id2contact[id] = indx;
-    m_surfPair2id[std::make_pair(surf1,surf2)] = id;
+    insertEntry(m_id2contact, id, indx);
+    insertEntry(m_surfPair2id, SurfacePair(surf1,surf2), id);
 }
 
 /** Does this snapshot contain a Contact object with the given ContactId? **/
 bool hasContact(ContactId id) const 
-{   return m_id2contact.find(id) != m_id2contact.end(); }
+{   return findEntry(m_id2contact, id) >= 0; }
 /** Does this snapshot contain a Contact object for the given surface pair
 (in either order)? **/
 bool hasContact(ContactSurfaceIndex surf1, ContactSurfaceIndex surf2) const
 {   if (surf1 > surf2) std::swap(surf1,surf2);
-    return m_surfPair2id.find(std::make_pair(surf1,surf2)) 
-        != m_surfPair2id.end(); }
+    return findEntry(m_surfPair2id, SurfacePair(surf1,surf2)) >= 0; }
 
 /** Find out how many Contacts are in this snapshot. **/
 int getNumContacts() const {return m_contacts.size();}
@@ -325,17 +381,16 @@ to it; otherwise, return a reference to an empty contact handle (you can check
 with isEmpty()). **/
 const Contact& getContactById(ContactId id) const
 {   static Contact empty;
-    ContactMap::const_iterator p = m_id2contact.find(id);
-    return p==m_id2contact.end() ? empty : m_contacts[p->second]; }
+    const int p = findEntry(m_id2contact, id);
+    return p < 0 ? empty : m_contacts[m_id2contact[p].second]; }
 /** If this snapshot contains a contact for the given pair of contact surfaces
 (order doesn't matter), return its ContactId; otherwise, return an invalid 
 ContactId (you can check with isValid()). **/
 ContactId getContactIdForSurfacePair(ContactSurfaceIndex surf1,
                                      ContactSurfaceIndex surf2) const
 {   if (surf1 > surf2) std::swap(surf1,surf2);
-    SurfaceMap::const_iterator p = 
-        m_surfPair2id.find(std::make_pair(surf1,surf2));
-    return p==m_surfPair2id.end() ? ContactId() : p->second; }
+    const int p = findEntry(m_surfPair2id, SurfacePair(surf1,surf2));
+    return p < 0 ? ContactId() : m_surfPair2id[p].second; }
 
 //--------------------------------------------------------------------------
                                 private:
@@ -352,14 +407,43 @@ void removeContact(int n) {
     // Move the last one to replace this one and update the map.
     m_contacts[n] = m_contacts.back();  // shallow copy
     m_contacts.pop_back();              // destruct
-    m_id2contact[m_contacts[n].getContactId()] = n;
+    const int p = findEntry(m_id2contact, m_contacts[n].getContactId());
+    m_id2contact[p].second = n;
+}
+
+// Return the position of the first entry in a sorted table whose key is not
+// less than the given one.
+template <class Table, class Key>
+static int lowerBound(const Table& table, const Key& key) {
+    int lo = 0, hi = table.size();
+    while (lo < hi) {
+        const int mid = (lo+hi)/2;
+        if (table[mid].first < key) lo = mid+1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Return the position of the entry with the given key, or -1 if none.
+template <class Table, class Key>
+static int findEntry(const Table& table, const Key& key) {
+    const int p = lowerBound(table, key);
+    return p < (int)table.size() && !(key < table[p].first) ? p : -1;
+}
+
+// Add an entry whose key isn't in the table yet. Entries usually arrive in
+// increasing order, so this is normally an append.
+template <class Table, class Key, class Value>
+static void insertEntry(Table& table, const Key& key, const Value& value) {
+    const int p = lowerBound(table, key);
+    table.insert(table.begin()+p, std::make_pair(key, value));
 }
 
 
 Real                m_time;         // when this snapshot was taken
 Array_<Contact,int> m_contacts;     // all the contact pairs
 ContactMap          m_id2contact;   // the contact pairs by contactId
-SurfaceMap          m_surfPair2id;  // surfacepair -> contactId map
+SurfaceMap          m_surfPair2id;  // surfacepair -> contactId table
 };
 
 // for debugging
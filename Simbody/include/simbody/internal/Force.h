@@ -629,6 +629,17 @@ public:
     virtual bool dependsOnlyOnPositions() const {
         return false;
     }
+    /**
+     * Get whether calcForce() may be called concurrently with the calcForce() methods of other force
+     * elements.  This only matters if parallel force evaluation has been turned on with
+     * GeneralForceSubsystem::setUseParallelForceEvaluation().  The default implementation returns false,
+     * so the force is always evaluated on the calling thread.  If your calcForce() modifies nothing but the
+     * arrays it is given and this force's own cache entries (in particular, no mutable members or other
+     * shared data), you may override this to return true so that it can run on a pool thread.
+     */
+    virtual bool shouldBeParallelized() const {
+        return false;
+    }
     /**
      * The following methods may optionally be overridden to do specialized realization for a Force.
      */
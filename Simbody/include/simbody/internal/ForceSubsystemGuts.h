@@ -58,6 +58,15 @@ public:
     /// be at Dynamics stage or later.
     virtual Real calcPotentialEnergy(const State& state) const = 0;
 
+    /// Add this subsystem's forces into the given arrays and its potential 
+    /// energy into \a pe without realizing Dynamics stage; the state must be
+    /// realized through Velocity stage. Return false if this subsystem can
+    /// only calculate its forces while being realized, which is the default.
+    virtual bool calcPotentialEnergyAndForces
+       (const State& state, Real& pe, Vector_<SpatialVec>& rigidBodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
+    {   return false; }
+
     SimTK_DOWNCAST(ForceSubsystem::Guts, Subsystem::Guts);
 };
 
@@ -86,6 +86,38 @@ public:
     void setForceIsDisabled
        (State& state, ForceIndex index, bool shouldBeDisabled) const;
 
+    /** Choose whether the force elements should be evaluated in parallel.
+    This is off by default. When it is on, the enabled force elements are 
+    divided into blocks that are evaluated concurrently by a pool of threads,
+    each block accumulating into its own private force arrays; those are then
+    added together in a fixed order so the results do not depend on thread 
+    scheduling. They may differ from the serial results in the last few bits
+    because the additions are done in a different order. A Force::Custom 
+    element is evaluated on the calling thread after the others unless its 
+    implementation says it can safely run concurrently with them (see 
+    Force::Custom::Implementation::shouldBeParallelized()). Parallel 
+    evaluation is used only when there are at least getParallelForceThreshold()
+    force elements to evaluate, and never when realization is already 
+    running on a pool thread. **/
+    void setUseParallelForceEvaluation(bool useParallel);
+    /** Return whether parallel force evaluation has been requested. **/
+    bool getUseParallelForceEvaluation() const;
+
+    /** Set the minimum number of force elements that must need evaluating 
+    before the thread pool is used. Fewer than that are evaluated serially 
+    since the work would not repay the cost of the dispatch. The default is 32.
+    **/
+    void setParallelForceThreshold(int minForces);
+    /** Get the minimum number of force elements for parallel evaluation. **/
+    int getParallelForceThreshold() const;
+
+    /** Set the number of threads used for parallel force evaluation. Zero 
+    (the default) means use one thread per processor. **/
+    void setNumParallelForceThreads(int numThreads);
+    /** Get the number of threads to be used for parallel force evaluation;
+    this is the number of processors if none was set. **/
+    int getNumParallelForceThreads() const;
+
     /** Every Subsystem is owned by a System; a GeneralForceSubsystem expects
     to be owned by a MultibodySystem. This method returns a const reference
     to the containing MultibodySystem and will throw an exception if there is
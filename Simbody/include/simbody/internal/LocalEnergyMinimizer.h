@@ -33,6 +33,11 @@ namespace SimTK {
 /**
  * This class performs local potential energy minimization of a MultibodySystem.
  * Only positions (generalized coordinates q) are changed; velocities are ignored.
+ *
+ * When every force subsystem can supply its forces from positions alone (see
+ * MultibodySystem::calcPotentialEnergyAndForces()), the energy and its gradient
+ * are evaluated without realizing the Dynamics stage. The position constraint
+ * Jacobian is calculated analytically.
  */
 
 class SimTK_SIMBODY_EXPORT LocalEnergyMinimizer {
@@ -48,6 +53,22 @@ public:
      *                     energy gradient is larger than this.
      */
     static void minimizeEnergy(const MultibodySystem& system, State& state, Real tolerance);
+    /**
+     * Find a local potential energy minimum for each of several States of the same
+     * MultibodySystem, as minimizeEnergy() does for a single State. The minimizations
+     * are independent of one another. Those of States with no position constraints
+     * are run concurrently; the others use an optimizer that is not thread safe and
+     * are run one after another on the calling thread.
+     *
+     * @param system       the system whose energy should be minimized
+     * @param states       on entry, the starting states; on exit, each is replaced by
+     *                     the corresponding local minimum
+     * @param tolerance    a tolerance for the energy minimization, as for minimizeEnergy()
+     * @param numThreads   the number of threads to use; the default of zero means one
+     *                     per processor
+     */
+    static void minimizeEnergy(const MultibodySystem& system, Array_<State>& states,
+                               Real tolerance, int numThreads = 0);
 private:
     class OptimizerFunction;
 };
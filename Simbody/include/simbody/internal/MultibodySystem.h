@@ -80,6 +80,19 @@ public:
     Real calcEnergy(const State& s) const {
         return calcPotentialEnergy(s)+calcKineticEnergy(s);
     }
+    /// Calculate the total potential energy and the applied forces without 
+    /// realizing Dynamics stage, which is much cheaper when only the forces
+    /// due to the current configuration are of interest, as in energy
+    /// minimization. The state must be at Velocity stage or later. The force
+    /// arrays are resized and zeroed first. Return false, leaving the outputs
+    /// meaningless, if some force subsystem can't do this (for example, one
+    /// with a Force::Custom element); then the state must be realized to 
+    /// Dynamics stage and the force cache entries used instead.
+    bool calcPotentialEnergyAndForces(const State&             state, 
+                                      Real&                    pe,
+                                      Vector_<SpatialVec>&     rigidBodyForces,
+                                      Vector_<Vec3>&           particleForces,
+                                      Vector&                  mobilityForces) const;
 
     // These methods are for use by our constituent subsystems to communicate 
     // with each other and with the MultibodySystem as a whole.
@@ -40,6 +40,17 @@ namespace SimTK {
  * - (optional) A weight for each station, giving its relative importance for fitting
  * 
  * The output is a State giving the set of internal coordinates that best fit the stations to the target locations.
+ *
+ * The static findBestFit() methods fit a single set of target locations. To fit many frames of target locations
+ * for the same stations, as from a motion capture stream, create an ObservedPointFitter instead. It builds the
+ * subproblems used to estimate each body's coordinates once, starts each frame from the previous frame's
+ * solution, and can fit independent runs of frames concurrently:
+ *
+ * <pre>
+ * ObservedPointFitter fitter(system, bodyIxs, stations);
+ * for (int k = 0; k < numFrames; ++k)
+ *     fitter.fitFrame(state, targetLocations[k]);
+ * </pre>
  */
 
 class SimTK_SIMBODY_EXPORT ObservedPointFitter {
@@ -115,8 +126,71 @@ public:
                     tolerance);
     }
 
+    /**
+     * Prepare to fit many frames of target locations for the same stations.
+     *
+     * @param system      the MultibodySystem being analyzed.  It must not be modified while this object exists.
+     * @param bodyIxs     a list of MobilizedBodyIndexs corresponding to the bodies for which stations are defined
+     * @param stations    the list of stations for each body, as for findBestFit()
+     * @param weights     weights[i][j] is the weight to use for stations[i][j] when performing the fitting
+     * @param tolerance   the distance tolerance within which the best fit should be found
+     */
+    ObservedPointFitter(const MultibodySystem&             system,
+                        const Array_<MobilizedBodyIndex>&  bodyIxs,
+                        const Array_<Array_<Vec3> >&       stations,
+                        const Array_<Array_<Real> >&       weights,
+                        Real                               tolerance=0.001);
+    /**
+     * Prepare to fit many frames of target locations for the same stations, giving every station a weight of 1.
+     */
+    ObservedPointFitter(const MultibodySystem&             system,
+                        const Array_<MobilizedBodyIndex>&  bodyIxs,
+                        const Array_<Array_<Vec3> >&       stations,
+                        Real                               tolerance=0.001);
+    ~ObservedPointFitter();
+
+    /**
+     * Fit one frame of target locations.  The first frame, and the first after resetWarmStart(), is fit just as
+     * findBestFit() would, starting from the Q vector in \a state.  Each later frame starts from the previous
+     * frame's solution and goes straight to fitting the whole system.
+     *
+     * @param state            on exit, this State's Q vector contains the values which provide a best fit
+     * @param targetLocations  targetLocations[i][j] is the target for stations[i][j], given relative to ground
+     * @return the RMS distance of points in the best fit conformation from their target locations
+     */
+    Real fitFrame(State& state, const Array_<Array_<Vec3> >& targetLocations);
+    /**
+     * Forget the previous frame's solution, so that the next frame is fit from scratch.
+     */
+    void resetWarmStart();
+    /**
+     * Fit many frames of target locations.  The frames are divided into contiguous runs, one per thread.  The first
+     * frame of each run is fit from the Q vector in \a initState and the others start from the previous frame's solution,
+     * as in fitFrame().  The runs are fit concurrently unless the system has position constraints, since those require an
+     * optimizer that is not thread safe; then all the frames form one run.  This does not affect fitFrame()'s warm start.
+     * Unlike fitFrame(), which prints a message and carries on when the initial estimate for a body fails, this throws
+     * an exception for such a failure, as it does for any other.
+     *
+     * @param initState   the State to start fitting from.  Each of \a states is a copy of this with its Q vector replaced.
+     * @param frames      frames[k][i][j] is the target for stations[i][j] in frame k
+     * @param states      on exit, states[k] contains the best fit for frame k
+     * @param errors      on exit, errors[k] is the RMS distance of points from their targets in frame k
+     * @param numThreads  the number of threads to use; the default of zero means one per processor
+     */
+    void fitFrames(const State&                               initState,
+                   const Array_<Array_<Array_<Vec3> > >&      frames,
+                   Array_<State>&                             states,
+                   Array_<Real>&                              errors,
+                   int                                        numThreads=0) const;
 
 private:
+    class ObservedPointFitterRep* rep;
+    friend class ObservedPointFitterRep;
+
+    // suppress
+    ObservedPointFitter(const ObservedPointFitter&);
+    ObservedPointFitter& operator=(const ObservedPointFitter&);
+
     static void createClonedSystem(const MultibodySystem& original, MultibodySystem& copy, const Array_<MobilizedBodyIndex>& originalBodyIxs, Array_<MobilizedBodyIndex>& copyBodyIxs, bool& hasArtificialBaseBody);
     static void findUpstreamBodies(MobilizedBodyIndex currentBodyIx, const Array_<int> numStations, const SimbodyMatterSubsystem& matter, Array_<MobilizedBodyIndex>& bodyIxs, int requiredStations);
     static void findDownstreamBodies(MobilizedBodyIndex currentBodyIx, const Array_<int> numStations, const Array_<Array_<MobilizedBodyIndex> > children, Array_<MobilizedBodyIndex>& bodyIxs, int& requiredStations);
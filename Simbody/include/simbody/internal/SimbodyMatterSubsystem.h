@@ -203,6 +203,43 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Request that the base-to-tip and tip-to-base sweeps through the multibody
+tree that are performed during realizePosition(), realizeVelocity(), 
+realizeDynamics() and realizeAcceleration() be executed in parallel. The tree
+is swept one level at a time (level 1 bodies are attached to Ground, level 2 
+bodies to level 1 bodies, and so on); bodies at the same level are independent
+so their computations are divided among a persistent pool of worker threads.
+The results are bit-identical to those of the serial sweep. This is off by 
+default and is only worthwhile for wide trees with many bodies per level; see
+setParallelTreeSweepThreshold(). The same thread pool is also used to compute
+the columns of the constraint matrix W = G M^-1 ~G concurrently. That is the
+matrix returned by calcProjectedMInv(), and realizeAcceleration() forms it the
+same way to calculate the constraint multipliers when there are Constraints.
+Any user-written mobilizers or constraints (see MobilizedBody::Custom and
+Constraint::Custom) must be safe to evaluate concurrently if this is enabled.
+Changing this setting does not invalidate any stage. **/
+void setUseParallelTreeSweeps(bool useParallel);
+/** Return the current setting of the parallel tree sweep flag. 
+@see setUseParallelTreeSweeps() **/
+bool getUseParallelTreeSweeps() const;
+
+/** When parallel tree sweeps are enabled, a level of the tree is processed
+in parallel only if it contains at least this many bodies; narrower levels are
+done serially because the thread synchronization would cost more than it
+saves. The default is 64. **/
+void setParallelTreeSweepThreshold(int minBodiesPerLevel);
+/** Return the minimum number of bodies a level must have to be processed in
+parallel. @see setParallelTreeSweepThreshold() **/
+int getParallelTreeSweepThreshold() const;
+
+/** Set the number of worker threads to be used for parallel tree sweeps. The
+default is zero, meaning one thread per available processor. **/
+void setNumParallelTreeSweepThreads(int numThreads);
+/** Return the number of worker threads that will be used for parallel tree
+sweeps; this is the number of processors unless it has been set explicitly.
+@see setNumParallelTreeSweepThreads() **/
+int getNumParallelTreeSweepThreads() const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the 0th mobilized body. (Note: if special particle handling were
 implmemented, the count here would \e not include particles.) Bodies and their
@@ -589,6 +626,10 @@ method takes 18*20+11*25=635 flops while the explicit matrix-vector multiply
 would take 12*20*25=6000 flops. So this method is already >9X faster for 
 that small system; for larger systems the difference grows rapidly. 
 
+@note This operator uses the State's operator workspace, so it must not be
+called concurrently on the same State; see "Thread safety" under System
+matrix manipulation.
+
 @see multiplyBySystemJacobian(), calcSystemJacobianTranspose() **/
 void multiplyBySystemJacobianTranspose( const State&                state,
                                         const Vector_<SpatialVec>&  F_G,
@@ -904,7 +945,22 @@ sometimes needed separately. Also, these matrices are all in mobility space
 qdot = N*u becomes important and operators for working with it efficiently
 are also provided here. In that case, the position constraint matrix 
 in generalized coordinate q space, Pq, can also be accessed. (In terms of
-the other matrices, Pq=P*N^-1.) **/
+the other matrices, Pq=P*N^-1.)
+
+<h3>Thread safety</h3>
+So that repeated calls don't allocate heap memory, the operators in this
+section take their temporaries from a workspace kept in the State's cache and
+reused from call to call; that includes multiplyByM(), multiplyByMInv(),
+multiplyBySqrtMInv(), calcM(), calcMInv(), calcDetM(), the multiplyByPVA()
+and multiplyByPVATranspose() family, multiplyByPq() and calcPq(). So although
+these methods take a const State, they write to it, and they must not be
+invoked concurrently from several threads on the same State, not even on one
+that is fully realized. Concurrent calls on different States are fine. To
+evaluate operators in parallel for a single configuration, give each thread
+its own copy of the State; a copy starts with an empty workspace of its own.
+The same restriction applies to calcResidualForceIgnoringConstraints(),
+calcTreeEquivalentMobilityForces() and multiplyBySystemJacobianTranspose(),
+which use the same workspace. **/
 /**@{**/
 
 /** This operator calculates in O(N) time the product M*v where M is the 
@@ -1024,6 +1080,48 @@ void calcDetM(const State& state,
     Vector&                     MinvV,
     Matrix&                     D0) const;
 
+/** Calculate the natural log of the determinant of the mass matrix, log|M|,
+in O(n) time. The articulated body inertia calculation factors M into a block
+diagonal matrix D and unit triangular factors, so |M| is the product of the 
+determinants of the small D blocks, one per mobilizer. This is the quantity
+needed for the Fixman correction in Monte Carlo sampling. Prescribed 
+mobilities are excluded, so this is actually log|Mrr| where Mrr is the 
+non-prescribed block of M.
+
+Articulated body inertias are realized if they haven't been already.
+
+@par Required stage
+  \c Stage::Position 
+
+@see calcM(), multiplyBySqrtMInv(), realizeArticulatedBodyInertias() **/
+Real calcLogDetM(const State& state) const;
+
+/** Multiply each column of a matrix by the square root of the inverse mass
+matrix, in a single O(k*n) sweep for k columns. This is equivalent to calling
+the Vector form of multiplyBySqrtMInv() once per column but the per-body 
+factorizations are done only once. If the columns of \a V are drawn 
+independently from a standard normal distribution, the columns of the result
+are independent generalized velocities u with covariance M^-1, so this draws
+k velocity sets for a Hamiltonian Monte Carlo trial at once (scale by 
+sqrt(kT) for temperature T). Entries corresponding to prescribed mobilities
+are set to zero.
+
+@param[in]      state
+    A State realized at least through Position stage. Articulated body 
+    inertias are realized if needed.
+@param[in]      V
+    An nu X k matrix, one column per vector to be multiplied.
+@param[out]     SqrtMInvV
+    The nu X k result. This is resized if necessary.
+
+@par Required stage
+  \c Stage::Position 
+
+@see calcLogDetM(), calcSqrtMInv() **/
+void multiplyBySqrtMInv(const State& state,
+    const Matrix&               V,
+    Matrix&                     SqrtMInvV) const;
+
 /** This operator explicitly calculates the n X n mass matrix M. Note that this
 is inherently an O(n^2) operation since the mass matrix has n^2 elements 
 (although only n(n+1)/2 are unique due to symmetry). <em>DO NOT USE THIS CALL 
@@ -1090,6 +1188,15 @@ O(n) operators:
 Even if G and M^-1 were already available, computing W by matrix multiplication
 would cost O(m^2*n + m*n^2) time and O(m*n) intermediate storage. Here we do 
 it in O(m*n) time with O(n) intermediate storage, which is a \e lot better.
+
+Usually it is better still: M is block diagonal with one block per branch of
+the multibody tree (a body attached to Ground and everything outboard of it),
+so constraints that act on disjoint sets of branches are uncoupled in W. 
+Columns for constraints that have no coupled constraint in common are 
+computed together by a single operator sequence, and the entries known to be
+zero are never computed. The operator sequences are independent and are 
+divided among worker threads if setUseParallelTreeSweeps() is enabled; the 
+result doesn't depend on that setting.
      
 @see multiplyByG(), calcG(), multiplyByGTranspose(), calcGTranspose()
 @see multiplyByMInv(), calcMInv() **/
@@ -1378,9 +1485,8 @@ do not consider those holonomic constraints.
 This method generates Pq columnwise using repeated calls to multiplyByPq(), 
 which makes use of the position constraint velocity-level error methods to 
 perrform a Pq*v product in O(m+n) time. See multiplyByPq() for a more 
-detailed explanation. If Pq's columns are in contiguous memory we'll work
-in place, otherwise columns are generated into a contiguous temporary and
-then copied into Pq.
+detailed explanation. Each column is generated into contiguous workspace 
+in the State and then copied into Pq.
 
 @see multiplyByPq() **/
 void calcPq(const State& state, Matrix& Pq) const;
@@ -1516,7 +1622,9 @@ void multiplyByNDot(const State& s, bool transpose,
 /** @name                  Miscellaneous Operators
 
 Operators make use of the State but do not write their results back
-into the State, not even into the State cache. **/
+into the State, not even into the State cache. Some of them do keep reusable
+temporaries in the cache, however, and those must not be invoked concurrently
+on the same State; see "Thread safety" under System matrix manipulation. **/
 /**@{**/
 
 /** This is the primary forward dynamics operator. It takes a state which
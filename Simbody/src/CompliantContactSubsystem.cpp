@@ -36,6 +36,12 @@ patch analysis methods.
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/MultibodySystem.h"
 
+#include "ElasticFoundationSprings.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <string>
+
 namespace SimTK {
 
 //==============================================================================
@@ -50,8 +56,27 @@ CompliantContactSubsystemImpl(const ContactTrackerSubsystem& tracker)
 :   ForceSubsystemRep("CompliantContactSubsystem", "0.0.1"),
     m_tracker(tracker), m_transitionVelocity(0.01), 
     m_ooTransitionVelocity(1/m_transitionVelocity), 
-    m_defaultGenerator(0) 
+    m_defaultGenerator(0), m_useParallelForceEvaluation(false),
+    m_parallelForceThreshold(16), m_numParallelForceThreads(0),
+    m_forceExecutor(0)
 {   
+    pthread_mutex_init(&m_forceExecutorLock, NULL);
+}
+
+// The copy gets its own thread pool when it needs one.
+CompliantContactSubsystemImpl(const CompliantContactSubsystemImpl& src)
+:   ForceSubsystemRep(src), m_tracker(src.m_tracker), 
+    m_transitionVelocity(src.m_transitionVelocity),
+    m_ooTransitionVelocity(src.m_ooTransitionVelocity),
+    m_generators(src.m_generators), m_defaultGenerator(src.m_defaultGenerator),
+    m_useParallelForceEvaluation(src.m_useParallelForceEvaluation),
+    m_parallelForceThreshold(src.m_parallelForceThreshold),
+    m_numParallelForceThreads(src.m_numParallelForceThreads),
+    m_forceExecutor(0), m_dissipatedEnergyIx(src.m_dissipatedEnergyIx),
+    m_potEnergyCacheIx(src.m_potEnergyCacheIx), 
+    m_forceCacheIx(src.m_forceCacheIx)
+{
+    pthread_mutex_init(&m_forceExecutorLock, NULL);
 }
 
 Real getTransitionVelocity() const  {return m_transitionVelocity;}
@@ -59,6 +84,29 @@ Real getOOTransitionVelocity() const  {return m_ooTransitionVelocity;}
 void setTransitionVelocity(Real vt) 
 {   m_transitionVelocity=vt; m_ooTransitionVelocity=1/vt;}
 
+void setUseParallelForceEvaluation(bool useParallel) 
+{   m_useParallelForceEvaluation = useParallel; }
+bool getUseParallelForceEvaluation() const 
+{   return m_useParallelForceEvaluation; }
+
+void setParallelForceThreshold(int minContacts) 
+{   m_parallelForceThreshold = minContacts; }
+int getParallelForceThreshold() const 
+{   return m_parallelForceThreshold; }
+
+void setNumParallelForceThreads(int numThreads) {
+    pthread_mutex_lock(&m_forceExecutorLock);
+    m_numParallelForceThreads = numThreads;
+    // The pool will be recreated with the new size on next use.
+    delete m_forceExecutor;
+    m_forceExecutor = 0;
+    pthread_mutex_unlock(&m_forceExecutorLock);
+}
+int getNumParallelForceThreads() const {
+    return m_numParallelForceThreads > 0 
+        ? m_numParallelForceThreads : ParallelExecutor::getNumProcessors();
+}
+
 
 int getNumContactForces(const State& s) const {
     ensureForceCacheValid(s);
@@ -105,16 +153,15 @@ bool calcContactPatchDetailsById(const State&   state,
         return false;
     }
 
-    const Transform& X_S1S2 = contact.getTransform();
     const ContactSurfaceIndex surf1(contact.getSurface1());
     const ContactSurfaceIndex surf2(contact.getSurface2());
     const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
     const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
 
-    const Transform X_GS1 = mobod1.findFrameTransformInGround
-        (state, m_tracker.getContactSurfaceTransform(surf1));
-    const Transform X_GS2 = mobod2.findFrameTransformInGround
-        (state, m_tracker.getContactSurfaceTransform(surf2));
+    const Array_<Transform,ContactSurfaceIndex>& X_GS = 
+        m_tracker.getContactSurfaceTransformsInGround(state);
+    const Transform& X_GS1 = X_GS[surf1];
+    const Transform& X_GS2 = X_GS[surf2];
 
     const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
         (state, m_tracker.getContactSurfaceTransform(surf1));
@@ -146,6 +193,8 @@ const ContactTrackerSubsystem& getContactTrackerSubsystem() const
 {   return m_tracker; }
 
 ~CompliantContactSubsystemImpl() {
+    delete m_forceExecutor;
+    pthread_mutex_destroy(&m_forceExecutorLock);
     delete m_defaultGenerator;
     for (GeneratorMap::iterator p  = m_generators.begin(); 
                                 p != m_generators.end(); ++p)
@@ -344,6 +393,16 @@ void markForceCacheValid(const State& s) const
 
 void ensurePotentialEnergyCacheValid(const State&) const;
 void ensureForceCacheValid(const State&) const;
+bool calcForcesInParallel(const State&, const ContactSnapshot&,
+                          const Array_<Transform,ContactSurfaceIndex>& X_GS,
+                          Array_<ContactForce>&) const;
+
+friend class ContactForceTask;
+void calcContactForceInGround(const State&                      state,
+                              const Contact&                    contact,
+                              const Transform&                  X_GS1,
+                              const Transform&                  X_GS2,
+                              ContactForce&                     force) const;
 
 
 
@@ -367,6 +426,17 @@ GeneratorMap                        m_generators;
 // this will either do nothing silently or throw an error.
 ContactForceGenerator*              m_defaultGenerator;
 
+// Forces for the active contacts may be calculated concurrently. These don't
+// affect results so can be changed at any time.
+bool                                m_useParallelForceEvaluation;
+int                                 m_parallelForceThreshold;
+int                                 m_numParallelForceThreads; // 0=#procs
+
+// The thread pool is created on first use; the lock keeps two States from
+// using it at once (the second just proceeds serially).
+mutable WorkStealingExecutor*       m_forceExecutor;
+mutable pthread_mutex_t             m_forceExecutorLock;
+
     // TOPOLOGY "CACHE"
 
 // These must be set during realizeTopology and treated as const thereafter.
@@ -414,6 +484,116 @@ ensurePotentialEnergyCacheValid(const State& state) const {
 }
 
 
+// Calculate the force for one active contact, measured and expressed in
+// Ground, or clear the force if the contact isn't producing one. This is
+// called concurrently for different contacts when forces are calculated in
+// parallel, so it must not write anywhere except to its force argument.
+void CompliantContactSubsystemImpl::
+calcContactForceInGround(const State&       state,
+                         const Contact&     contact,
+                         const Transform&   X_GS1,
+                         const Transform&   X_GS2,
+                         ContactForce&      force) const
+{
+    if (contact.getCondition() == Contact::Broken) {
+        // No need to generate forces; this will be gone next time.
+        force.clear();
+        return;
+    }
+    const ContactSurfaceIndex surf1(contact.getSurface1());
+    const ContactSurfaceIndex surf2(contact.getSurface2());
+    const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
+    const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
+
+    const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
+        (state, m_tracker.getContactSurfaceTransform(surf1));
+    const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
+        (state, m_tracker.getContactSurfaceTransform(surf2));
+
+    // Calculate the relative velocity of S2 in S1, expressed in S1.
+    const SpatialVec V_S1S2 =
+        findRelativeVelocity(X_GS1, V_GS1, X_GS2, V_GS2);   // 51 flops
+
+    const ContactForceGenerator& generator = 
+        getForceGenerator(contact.getTypeId());
+    // Calculate the contact force measured and expressed in S1.
+    force.clear();
+    generator.calcContactForce(state, contact, V_S1S2, force);
+    // Re-express the contact force in Ground for later use.
+    if (force.isValid())
+        force.changeFrameInPlace(X_GS1); // switch to Ground
+}
+
+// This is the task executed by the thread pool; each index is a block of
+// consecutive contacts whose forces go into the matching slots of the 
+// force cache.
+class ContactForceTask : public GuardedParallelTask {
+public:
+    ContactForceTask(const CompliantContactSubsystemImpl& subsys,
+                     const State& state, const ContactSnapshot& active,
+                     const Array_<Transform,ContactSurfaceIndex>& X_GS,
+                     Array_<ContactForce>& forces, int nBlocks)
+    :   subsys(subsys), state(state), active(active), X_GS(X_GS), 
+        forces(forces), nBlocks(nBlocks) {}
+
+    void executeGuarded(int block) {
+        const int nContacts = (int)forces.size();
+        const int first = getBlockStart(nContacts, block, nBlocks);
+        const int last  = getBlockStart(nContacts, block+1, nBlocks);
+        for (int i=first; i < last; ++i) {
+            const Contact& contact = active.getContact(i);
+            subsys.calcContactForceInGround(state, contact, 
+                X_GS[contact.getSurface1()], X_GS[contact.getSurface2()],
+                forces[i]);
+        }
+    }
+private:
+    const CompliantContactSubsystemImpl&            subsys;
+    const State&                                    state;
+    const ContactSnapshot&                          active;
+    const Array_<Transform,ContactSurfaceIndex>&    X_GS;
+    Array_<ContactForce>&                           forces;
+    const int                                       nBlocks;
+};
+
+// Fill in the force slots on the thread pool if that has been requested and
+// is worthwhile. Returns false without doing anything if the caller should
+// calculate the forces serially.
+bool CompliantContactSubsystemImpl::
+calcForcesInParallel(const State&                                   state,
+                     const ContactSnapshot&                         active,
+                     const Array_<Transform,ContactSurfaceIndex>&   X_GS,
+                     Array_<ContactForce>&                          forces) const
+{
+    const int nContacts = (int)forces.size();
+    if (!m_useParallelForceEvaluation 
+        || nContacts < m_parallelForceThreshold || nContacts < 2
+        || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&m_forceExecutorLock) != 0)
+        return false;
+
+    // A few blocks per thread lets the pool even out contacts of different
+    // cost; a mesh contact can take far longer than a sphere contact.
+    const int nThreads = getNumParallelForceThreads();
+    const int nBlocks = std::min(nContacts, 4*nThreads);
+    if (!m_forceExecutor)
+        m_forceExecutor = new WorkStealingExecutor(nThreads);
+    ContactForceTask task(*this, state, active, X_GS, forces, nBlocks);
+    m_forceExecutor->execute(task, nBlocks);
+    pthread_mutex_unlock(&m_forceExecutorLock);
+
+    SimTK_ERRCHK1_ALWAYS(!task.hasFailed(), 
+        "CompliantContactSubsystem::realizeDynamics()",
+        "A parallel contact force calculation failed: %s", 
+        task.getErrorMessage().c_str());
+    return true;
+}
+
+// There is one slot in the force cache for each active contact. The slots 
+// are filled in independently, possibly on several threads, and then the 
+// valid ones are squeezed together in contact order. Each force is computed
+// the same way regardless of which thread does it, so the results don't 
+// depend on the number of threads.
 void CompliantContactSubsystemImpl::
 ensureForceCacheValid(const State& state) const {
     if (isForceCacheValid(state)) return;
@@ -421,53 +601,33 @@ ensureForceCacheValid(const State& state) const {
     SimTK_STAGECHECK_GE_ALWAYS(getStage(state), Stage::Velocity,
         "CompliantContactSubystemImpl::ensureForceCacheValid()");
 
-    Array_<ContactForce>& forces = updForceCache(state);
-    forces.clear();
-
-
     const ContactSnapshot& active = m_tracker.getActiveContacts(state);
     const int nContacts = active.getNumContacts();
-    for (int i=0; i<nContacts; ++i) {
-        const Contact& contact = active.getContact(i);
-        if (contact.getCondition() == Contact::Broken) {
-            // No need to generate forces; this will be gone next time.
-            continue;
-        }
-        const Transform& X_S1S2 = contact.getTransform();
-        const ContactSurfaceIndex surf1(contact.getSurface1());
-        const ContactSurfaceIndex surf2(contact.getSurface2());
-        const MobilizedBody& mobod1 = m_tracker.getMobilizedBody(surf1);
-        const MobilizedBody& mobod2 = m_tracker.getMobilizedBody(surf2);
-
-        // TODO: These two are expensive (63 flops each) and shouldn't have 
-        // to be recalculated here since we must have used them in creating
-        // the Contact and X_S1S2.
-        const Transform X_GS1 = mobod1.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const Transform X_GS2 = mobod2.findFrameTransformInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        const SpatialVec V_GS1 = mobod1.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf1));
-        const SpatialVec V_GS2 = mobod2.findFrameVelocityInGround
-            (state, m_tracker.getContactSurfaceTransform(surf2));
-
-        // Calculate the relative velocity of S2 in S1, expressed in S1.
-        const SpatialVec V_S1S2 =
-            findRelativeVelocity(X_GS1, V_GS1, X_GS2, V_GS2);   // 51 flops
 
-        const ContactForceGenerator& generator = 
-            getForceGenerator(contact.getTypeId());
-        forces.push_back(); // allocate a new garbage ContactForce
-        // Calculate the contact force measured and expressed in S1.
-        generator.calcContactForce(state, contact, V_S1S2, forces.back());
-        // Re-express the contact force in Ground for later use.
-        if (forces.back().isValid())
-            forces.back().changeFrameInPlace(X_GS1); // switch to Ground
-        else
-            forces.pop_back(); // never mind ...
+    // The surface poses were calculated for tracking; don't recalculate them.
+    const Array_<Transform,ContactSurfaceIndex>& X_GS = 
+        m_tracker.getContactSurfaceTransformsInGround(state);
+
+    Array_<ContactForce>& forces = updForceCache(state);
+    forces.resize(nContacts);
+
+    if (!calcForcesInParallel(state, active, X_GS, forces)) {
+        for (int i=0; i<nContacts; ++i) {
+            const Contact& contact = active.getContact(i);
+            calcContactForceInGround(state, contact, 
+                X_GS[contact.getSurface1()], X_GS[contact.getSurface2()],
+                forces[i]);
+        }
     }
 
+    int nValid = 0;
+    for (int i=0; i<nContacts; ++i)
+        if (forces[i].isValid()) {
+            if (nValid != i) forces[nValid] = forces[i];
+            ++nValid;
+        }
+    forces.resize(nValid);
+
     markForceCacheValid(state);
 }
 
@@ -521,6 +681,29 @@ void CompliantContactSubsystem::setTransitionVelocity(Real vt) {
     updImpl().setTransitionVelocity(vt);
 }
 
+void CompliantContactSubsystem::setUseParallelForceEvaluation(bool useParallel)
+{   updImpl().setUseParallelForceEvaluation(useParallel); }
+bool CompliantContactSubsystem::getUseParallelForceEvaluation() const
+{   return getImpl().getUseParallelForceEvaluation(); }
+
+void CompliantContactSubsystem::setParallelForceThreshold(int minContacts) {
+    SimTK_ERRCHK1_ALWAYS(minContacts >= 1, 
+        "CompliantContactSubsystem::setParallelForceThreshold()",
+        "The threshold must be at least 1 but was %d.", minContacts);
+    updImpl().setParallelForceThreshold(minContacts);
+}
+int CompliantContactSubsystem::getParallelForceThreshold() const
+{   return getImpl().getParallelForceThreshold(); }
+
+void CompliantContactSubsystem::setNumParallelForceThreads(int numThreads) {
+    SimTK_ERRCHK1_ALWAYS(numThreads >= 0, 
+        "CompliantContactSubsystem::setNumParallelForceThreads()",
+        "The number of threads can't be negative but was %d.", numThreads);
+    updImpl().setNumParallelForceThreads(numThreads);
+}
+int CompliantContactSubsystem::getNumParallelForceThreads() const
+{   return getImpl().getNumParallelForceThreads(); }
+
 int CompliantContactSubsystem::getNumContactForces(const State& s) const
 {   return getImpl().getNumContactForces(s); }
 
@@ -1228,7 +1411,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
         const ContactGeometry::TriangleMesh& mesh1 = 
             ContactGeometry::TriangleMesh::getAs(shape1);
 
-        calcWeightedPatchCentroid(mesh1, contact.getSurface1Faces(),
+        calcWeightedPatchCentroid(mesh1, contact.getSurface1FaceIndices(),
                                   weightedPatchCentroid1_S1, patchArea1);
     }
     if (shape2.getTypeId() == ContactGeometry::TriangleMesh::classTypeId()) {
@@ -1236,7 +1419,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             ContactGeometry::TriangleMesh::getAs(shape2);
         Vec3 weightedPatchCentroid2_S2;
 
-        calcWeightedPatchCentroid(mesh2, contact.getSurface2Faces(),
+        calcWeightedPatchCentroid(mesh2, contact.getSurface2FaceIndices(),
                                   weightedPatchCentroid2_S2, patchArea2);
         // Remeasure patch2's weighted centroid from surface1's frame;
         // be sure to weight the new offset also.
@@ -1304,7 +1487,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             ContactGeometry::TriangleMesh::getAs(shape1);
 
         processOneMesh(state, 
-            mesh, contact.getSurface1Faces(),
+            mesh, contact.getSurface1FaceIndices(),
             X_S1S2, V_S1S2, shape2,
             s1, areaScale1,
             kh, c, us, ud, uv,
@@ -1334,7 +1517,7 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
             wantDetails ? contactDetails_S1->size() : 0;
 
         processOneMesh(state, 
-            mesh, contact.getSurface2Faces(),
+            mesh, contact.getSurface2FaceIndices(),
             X_S2S1, V_S2S1, shape1,
             s2, areaScale2,
             kh, c, us, ud, uv,
@@ -1399,14 +1582,13 @@ void ContactForceGenerator::ElasticFoundation::calcContactForceAndDetails
 void ContactForceGenerator::ElasticFoundation::
 calcWeightedPatchCentroid
    (const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
+    const Array_<int>&                      insideFaces,
     Vec3&                                   weightedPatchCentroid,
     Real&                                   patchArea) const
 {
     weightedPatchCentroid = Vec3(0); patchArea = 0;
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter)
-    {   const int  face = *iter;
+    for (unsigned i=0; i < insideFaces.size(); ++i)
+    {   const int  face = insideFaces[i];
         const Real area = mesh.getFaceArea(face);
         weightedPatchCentroid   += area*mesh.findCentroid(face); 
         patchArea               += area; 
@@ -1415,77 +1597,45 @@ calcWeightedPatchCentroid
 
 
 
-// Private method that calculates the net contact force produced by a single 
-// triangle mesh in contact with some other object (which might be another
-// mesh; we don't care). We are given the relative spatial pose and velocity of
-// the two surface frames, and for the mesh we are given a specific list of
-// the faces that are suspected of being at least partially inside the 
-// other surface (in the undeformed geometry overlap). Normally this just 
-// computes the resultant force but it can optionally append contact patch 
-// details (one entry per element) as well, if the contactDetails argument is 
-// non-null.
-// An area-scaling factor is used to scale the area represented by each face.
-// If there is only one mesh involved this should be 1. However, if this
-// is part of a pair of contact meshes each half of the pair should be scaled
-// so that both surfaces see the same overall patch area (so nominally the
-// area-scaling factor would be 0.5).
-void ContactForceGenerator::ElasticFoundation::
-processOneMesh
-   (const State&                            state,
-    const ContactGeometry::TriangleMesh&    mesh,
-    const std::set<int>&                    insideFaces,
-    const Transform&                        X_MO, 
-    const SpatialVec&                       V_MO,
-    const ContactGeometry&                  other,
-    Real                                    meshDeformationFraction, // 0..1
-    Real                                    areaScaleFactor,
-    Real kh, Real c, Real us, Real ud, Real uv, // composite material props
-    const Vec3&                 resultantPt_M, // where to apply forces
-    SpatialVec&                 resultantForceOnOther_M, // at resultant pt
-    Real&                       potentialEnergy,
-    Real&                       powerLoss,
-    Vec3&                       weightedCenterOfPressure_M,
-    Real&                       sumOfAllPressureMoments,   // COP weight
-    Array_<ContactDetail>*      contactDetails_M) const    // in/out if present 
-{
-    assert(!insideFaces.empty());
-    const bool wantDetails = (contactDetails_M != 0);
-
-    // Initialize all results to zero.
-    resultantForceOnOther_M = SpatialVec(Vec3(0),Vec3(0));
-    potentialEnergy = powerLoss = 0;
-    weightedCenterOfPressure_M = Vec3(0);
-    sumOfAllPressureMoments = 0;
-
-    // Don't initialize contact details; we're going to append them.
+// Everything the mesh spring kernels need to know that is the same for all the
+// springs of a mesh: the composite material properties, the friction model's
+// transition velocity, and the pose and spatial velocity of the other 
+// surface's frame O in the mesh frame M. All the vectors are in M.
+struct MeshSpringConstants {
+    Real kh, c, us, ud, uv;       // composite material properties
+    Real vtrans, ooVtrans;        // transition velocity and its reciprocal
+    Real meshDeformationFraction; // 0..1
+    Vec3 pMO, wMO, vMO;           // origin of O, and O's angular & linear vel.
+    Vec3 resultantPt;             // where the resultant force is applied
+};
 
-    // Abbreviations.
-    const Rotation& RMO = X_MO.R(); // orientation of O in M
-    const Vec3&     pMO = X_MO.p(); // position of OO (origin of O) in M
-    const Vec3&     wMO = V_MO[0];  // ang. vel. of O in M
-    const Vec3&     vMO = V_MO[1];  // vel. of OO in M
+// The results accumulated over the springs of a mesh: the force and moment
+// about the resultant point on the other surface, the stored energy, the power 
+// loss, and the center of pressure weighting.
+struct MeshSpringSums {
+    MeshSpringSums() : moment(0), force(0), pe(0), powerLoss(0),
+                       weightedCOP(0), sumOfPressureMoments(0) {}
+    Vec3 moment, force;
+    Real pe, powerLoss;
+    Vec3 weightedCOP;
+    Real sumOfPressureMoments;
+};
 
-    // Get friction model transition velocity vt and 1/vt.
-    const CompliantContactSubsystem& subsys = getCompliantContactSubsystem();
-    const Real vtrans   = subsys.getTransitionVelocity();
-    const Real ooVtrans = subsys.getOOTransitionVelocity(); // 1/vtrans
-
-    // Now loop over all the faces again, evaluate the force from each 
-    // spring, and apply it at the patch centroid.
-    // This costs roughly 300 flops per contacting face.
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) 
-    {   const int   face        = *iter;
-        const Vec3  springPos_M = mesh.findCentroid(face);
-        const Real  faceArea    = areaScaleFactor*mesh.getFaceArea(face);
-
-        bool        inside;
-        UnitVec3    normal_O; // not used
-        const Vec3  nearestPoint_O = // 18 flops + cost of findNearestPoint
-            other.findNearestPoint(~X_MO*springPos_M, inside, normal_O);
-        if (!inside)
+// Add the contributions of springs [begin,end) of a block, one at a time,
+// appending a contact detail for each spring that generates a force if 
+// details is non-null. The block's springs (s) are the face centroids and 
+// the nearest points (p) are on the undeformed other surface, both in M; a 
+// spring that is not inside the other surface has zero area.
+// This costs roughly 300 flops per contacting face.
+static void addMeshSpringForces
+   (const MeshSpringConstants& mc, const ElasticFoundationSprings::SpringBlock& b,
+    int begin, int end, MeshSpringSums& sums, Array_<ContactDetail>* details)
+{
+    for (int k=begin; k < end; ++k) {
+        const Real faceArea = b.area[k];
+        if (faceArea == 0)
             continue;
-        
+
         // Although the "spring" is associated with just one surface (the mesh M)
         // it is considered here to include the compression of both surfaces
         // together, using composite material properties for stiffness and 
@@ -1497,7 +1647,8 @@ processOneMesh
         // i.e., in the  direction that the force will be applied to the 
         // "other" body. This is the same convention we use for the patch 
         // normal for Hertz contact.
-        const Vec3 nearestPoint_M = X_MO*nearestPoint_O; // 18 flops
+        const Vec3 springPos_M(b.sx[k], b.sy[k], b.sz[k]);
+        const Vec3 nearestPoint_M(b.px[k], b.py[k], b.pz[k]);
         const Vec3 overlap_M      = springPos_M - nearestPoint_M; // 3 flops
         const Real overlap        = overlap_M.norm(); // ~40 flops
 
@@ -1515,7 +1666,7 @@ processOneMesh
         // contact point will be at the undeformed mesh face centroid; at 1 
         // (other body rigid) it will be at the (undeformed) nearest point on 
         // the other body.
-        const Real meshSquish = meshDeformationFraction*overlap; // mesh displacement
+        const Real meshSquish = mc.meshDeformationFraction*overlap; // mesh displacement
         // Remember that the normal points towards the exterior of this mesh.
         const Vec3 contactPt_M = springPos_M - meshSquish*normal_M; // 6 flops
         
@@ -1525,13 +1676,13 @@ processOneMesh
         // contact point.
 
         // O station, exp. in M
-        const Vec3 contactPtO_M = contactPt_M - pMO;    // 3 flops 
+        const Vec3 contactPtO_M = contactPt_M - mc.pMO; // 3 flops 
 
         // All vectors are in M; dropping the "_M" notation now.
 
         // Velocity of other at contact point is opposite direction of normal
         // when penetration is increasing.
-        const Vec3 vel = vMO + wMO % contactPtO_M;      // 12 flops
+        const Vec3 vel = mc.vMO + mc.wMO % contactPtO_M; // 12 flops
 
         // Want odot > 0 when overlap is increasing; normal points the 
         // other way. odot is signed penetration (overlap) rate.
@@ -1541,17 +1692,16 @@ processOneMesh
         
         // Calculate scalar normal force                  (5 flops)
         // Here kh has units of pressure/area/displacement
-        const Real fK = kh*faceArea*overlap; // normal elastic force (conservative)
-        const Real fC = fK*c*odot;           // normal dissipation force (loss)
-        const Real fNormal = fK + fC;        // normal force
+        const Real fK = mc.kh*faceArea*overlap; // normal elastic force (conservative)
+        const Real fC = fK*mc.c*odot;           // normal dissipation force (loss)
+        const Real fNormal = fK + fC;           // normal force
 
         // Total force can be negative under unusual circumstances ("yanking");
         // that means no force is generated and no stored PE will be recovered.
         // This will most often occur in to-be-rejected trial steps but can
         // occasionally be real.
         if (fNormal <= 0) {
-            SimTK_DEBUG1("YANKING!!! (face %d)\n", face);
-            //printf("YANKING!!! (face %d)\n", face);
+            SimTK_DEBUG1("YANKING!!! (spring %d of block)\n", k);
             continue;
         }
 
@@ -1564,10 +1714,10 @@ processOneMesh
 
         // This is the moment r X f about the resultant point produced by 
         // applying this pure force at the contact point. Cost ~60 flops.
-        const Vec3 r = contactPt_M - resultantPt_M;
+        const Vec3 r = contactPt_M - mc.resultantPt;
         const Real pressureMoment = (r % forceNormal).norm();
-        weightedCenterOfPressure_M += pressureMoment*r;
-        sumOfAllPressureMoments    += pressureMoment;
+        sums.weightedCOP          += pressureMoment*r;
+        sums.sumOfPressureMoments += pressureMoment;
         
         // Calculate the friction force. Cost is about 60 flops.
         Vec3 forceFriction(0);
@@ -1576,10 +1726,10 @@ processOneMesh
         if (vslipSq > square(SignificantReal)) {
             const Real vslip = std::sqrt(vslipSq); // expensive: ~25 flops
             // Express slip velocity as unitless multiple of transition velocity.
-            const Real v = vslip * ooVtrans;
+            const Real v = vslip * mc.ooVtrans;
             // Must scale viscous coefficient to match unitless velocity.
-            const Real mu=stribeck(us,ud,uv*vtrans,v); // ~10 flops
-            //const Real mu=hollars(us,ud,uv*vtrans,v);
+            const Real mu=stribeck(mc.us,mc.ud,mc.uv*mc.vtrans,v); // ~10 flops
+            //const Real mu=hollars(mc.us,mc.ud,mc.uv*mc.vtrans,v);
             const Real fFriction = fNormal * mu;
             // Force direction on O opposes O's velocity.
             forceFriction = (-fFriction/vslip)*velTangent; // ~20 flops
@@ -1592,10 +1742,11 @@ processOneMesh
         // Accumulate the moment and force on the *other* surface as though 
         // applied at the point of O that is coincident with the resultant
         // point; we'll move it later.                      (15 flops)
-        resultantForceOnOther_M += SpatialVec(r % forceTotal, forceTotal);
+        sums.moment += r % forceTotal;
+        sums.force  += forceTotal;
 
         // Accumulate potential energy stored in elastic displacement.
-        potentialEnergy += PE;                  // 1 flop
+        sums.pe += PE;                          // 1 flop
 
         // Don't include dot(forceK,velNormal) power due to conservative force
         // here. This way we don't double-count the energy on the way in as
@@ -1607,11 +1758,11 @@ processOneMesh
         // push back on us so the energy is lost to surface vibrations or some
         // other unmodeled effect.
         const Real powerLossThisElement = powerC + powerFriction; // 1 flop
-        powerLoss += powerLossThisElement;                        // 1 flop
+        sums.powerLoss += powerLossThisElement;                   // 1 flop
 
-        if (wantDetails) {
-            contactDetails_M->push_back();
-            ContactDetail& detail = contactDetails_M->back();
+        if (details) {
+            details->push_back();
+            ContactDetail& detail = details->back();
             detail.m_contactPt          = contactPt_M;
             detail.m_patchNormal        = normal_M;
             detail.m_slipVelocity       = velTangent;
@@ -1619,13 +1770,256 @@ processOneMesh
             detail.m_deformation        = overlap;
             detail.m_deformationRate    = odot;
             detail.m_patchArea          = faceArea;
-            detail.m_peakPressure       = (faceArea != 0 ? fNormal/faceArea 
-                                                         : Real(0));
+            detail.m_peakPressure       = fNormal/faceArea;
             detail.m_potentialEnergy    = PE;
             detail.m_powerLoss          = powerLossThisElement;
         }
     }
 }
 
-} // namespace SimTK
+#ifdef SimTK_ELASTIC_FOUNDATION_SSE2
+// step5() for two values at once; x must already be in 0..1.
+static inline __m128d step5SSE2(__m128d x) {
+    const __m128d x3 = _mm_mul_pd(_mm_mul_pd(x, x), x);
+    return _mm_mul_pd(x3, _mm_add_pd(_mm_set1_pd(10), _mm_mul_pd(x, 
+        _mm_sub_pd(_mm_mul_pd(_mm_set1_pd(6), x), _mm_set1_pd(15)))));
+}
+
+// stribeck() for two values at once, with the branches evaluated on both
+// lanes and then selected.
+static inline __m128d stribeckSSE2(__m128d us, __m128d ud, __m128d uv, 
+                                   __m128d v) {
+    using ElasticFoundationSprings::select;
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+    const __m128d stiction = _mm_mul_pd(us, step5SSE2(_mm_min_pd(v, one)));
+    const __m128d x = _mm_min_pd(one, _mm_max_pd(zero, 
+                          _mm_mul_pd(_mm_sub_pd(v, one), _mm_set1_pd(0.5))));
+    const __m128d stribeck = 
+        _mm_sub_pd(us, _mm_mul_pd(_mm_sub_pd(us, ud), step5SSE2(x)));
+    const __m128d mu_dry = 
+        select(_mm_cmpge_pd(v, _mm_set1_pd(3)), ud,
+               select(_mm_cmpge_pd(v, one), stribeck, stiction));
+    return _mm_add_pd(mu_dry, _mm_mul_pd(uv, v));
+}
+
+// The same calculation as addMeshSpringForces() without contact details, two
+// springs at a time. Branches become masks: a spring that is not inside, has 
+// no overlap, or is being yanked gets zero force, and one that isn't slipping
+// gets no friction.
+static void addMeshSpringForcesSSE2
+   (const MeshSpringConstants& mc, const ElasticFoundationSprings::SpringBlock& b,
+    int n, MeshSpringSums& sums)
+{
+    using ElasticFoundationSprings::select;
+    using ElasticFoundationSprings::dot;
+    using ElasticFoundationSprings::cross;
+    using ElasticFoundationSprings::sumLanes;
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+    const __m128d kh  = _mm_set1_pd(mc.kh), c = _mm_set1_pd(mc.c);
+    const __m128d us  = _mm_set1_pd(mc.us), ud = _mm_set1_pd(mc.ud);
+    const __m128d uv  = _mm_set1_pd(mc.uv*mc.vtrans);
+    const __m128d ooVtrans = _mm_set1_pd(mc.ooVtrans);
+    const __m128d mdf = _mm_set1_pd(mc.meshDeformationFraction);
+    const __m128d minSlipSq = _mm_set1_pd(square(SignificantReal));
+    __m128d fx = zero, fy = zero, fz = zero, mx = zero, my = zero, mz = zero;
+    __m128d wcx = zero, wcy = zero, wcz = zero, sumPM = zero;
+    __m128d pe = zero, powerLoss = zero;
+
+    int k = 0;
+    for (; k+2 <= n; k += 2) {
+        const __m128d area = _mm_loadu_pd(&b.area[k]);
+        const __m128d sx = _mm_loadu_pd(&b.sx[k]), sy = _mm_loadu_pd(&b.sy[k]),
+                      sz = _mm_loadu_pd(&b.sz[k]);
+
+        // Overlap and the normal, pointing towards the mesh exterior.
+        const __m128d ox = _mm_sub_pd(sx, _mm_loadu_pd(&b.px[k]));
+        const __m128d oy = _mm_sub_pd(sy, _mm_loadu_pd(&b.py[k]));
+        const __m128d oz = _mm_sub_pd(sz, _mm_loadu_pd(&b.pz[k]));
+        const __m128d overlap = _mm_sqrt_pd(dot(ox,oy,oz, ox,oy,oz));
+        const __m128d valid = _mm_and_pd(_mm_cmpneq_pd(area, zero),
+                                         _mm_cmpneq_pd(overlap, zero));
+        if (_mm_movemask_pd(valid) == 0)
+            continue;
+        const __m128d ooOverlap = _mm_div_pd(one, select(valid, overlap, one));
+        const __m128d nx = _mm_mul_pd(ox, ooOverlap), 
+                      ny = _mm_mul_pd(oy, ooOverlap),
+                      nz = _mm_mul_pd(oz, ooOverlap);
+
+        // Contact point, and the velocity of O's station there.
+        const __m128d squish = _mm_mul_pd(mdf, overlap);
+        const __m128d cpx = _mm_sub_pd(sx, _mm_mul_pd(squish, nx));
+        const __m128d cpy = _mm_sub_pd(sy, _mm_mul_pd(squish, ny));
+        const __m128d cpz = _mm_sub_pd(sz, _mm_mul_pd(squish, nz));
+        __m128d vx, vy, vz;
+        cross(mc.wMO, _mm_sub_pd(cpx, _mm_set1_pd(mc.pMO[0])),
+                      _mm_sub_pd(cpy, _mm_set1_pd(mc.pMO[1])),
+                      _mm_sub_pd(cpz, _mm_set1_pd(mc.pMO[2])), vx, vy, vz);
+        vx = _mm_add_pd(vx, _mm_set1_pd(mc.vMO[0]));
+        vy = _mm_add_pd(vy, _mm_set1_pd(mc.vMO[1]));
+        vz = _mm_add_pd(vz, _mm_set1_pd(mc.vMO[2]));
+        const __m128d odot = _mm_sub_pd(zero, dot(vx,vy,vz, nx,ny,nz));
+        const __m128d tx = _mm_add_pd(vx, _mm_mul_pd(odot, nx));
+        const __m128d ty = _mm_add_pd(vy, _mm_mul_pd(odot, ny));
+        const __m128d tz = _mm_add_pd(vz, _mm_mul_pd(odot, nz));
+
+        // Normal force; skip the pair if neither spring pushes.
+        const __m128d fK = _mm_mul_pd(_mm_mul_pd(kh, area), overlap);
+        const __m128d fC = _mm_mul_pd(_mm_mul_pd(fK, c), odot);
+        const __m128d fNormal = _mm_add_pd(fK, fC);
+        const __m128d push = _mm_and_pd(valid, _mm_cmpgt_pd(fNormal, zero));
+        if (_mm_movemask_pd(push) == 0)
+            continue;
+        const __m128d fN = _mm_and_pd(push, fNormal);
+        __m128d Fx = _mm_mul_pd(fN, nx), Fy = _mm_mul_pd(fN, ny), 
+                Fz = _mm_mul_pd(fN, nz);
+        pe = _mm_add_pd(pe, _mm_and_pd(push, 
+                 _mm_mul_pd(_mm_mul_pd(fK, overlap), _mm_set1_pd(0.5))));
+        powerLoss = _mm_add_pd(powerLoss, 
+                                _mm_and_pd(push, _mm_mul_pd(fC, odot)));
+
+        // Center of pressure weighting from the normal force's moment.
+        const __m128d rx = _mm_sub_pd(cpx, _mm_set1_pd(mc.resultantPt[0]));
+        const __m128d ry = _mm_sub_pd(cpy, _mm_set1_pd(mc.resultantPt[1]));
+        const __m128d rz = _mm_sub_pd(cpz, _mm_set1_pd(mc.resultantPt[2]));
+        __m128d pmx, pmy, pmz;
+        cross(rx,ry,rz, Fx,Fy,Fz, pmx,pmy,pmz);
+        const __m128d pm = _mm_sqrt_pd(dot(pmx,pmy,pmz, pmx,pmy,pmz));
+        wcx = _mm_add_pd(wcx, _mm_mul_pd(pm, rx));
+        wcy = _mm_add_pd(wcy, _mm_mul_pd(pm, ry));
+        wcz = _mm_add_pd(wcz, _mm_mul_pd(pm, rz));
+        sumPM = _mm_add_pd(sumPM, pm);
+
+        // Friction force, opposing the slip velocity.
+        const __m128d vslipSq = dot(tx,ty,tz, tx,ty,tz);
+        const __m128d slip = _mm_and_pd(push, _mm_cmpgt_pd(vslipSq, minSlipSq));
+        if (_mm_movemask_pd(slip)) {
+            const __m128d vslip = _mm_sqrt_pd(select(slip, vslipSq, one));
+            const __m128d mu = 
+                stribeckSSE2(us, ud, uv, _mm_mul_pd(vslip, ooVtrans));
+            const __m128d fFriction = _mm_mul_pd(fN, mu);
+            const __m128d scale = _mm_and_pd(slip, 
+                _mm_sub_pd(zero, _mm_div_pd(fFriction, vslip)));
+            Fx = _mm_add_pd(Fx, _mm_mul_pd(scale, tx));
+            Fy = _mm_add_pd(Fy, _mm_mul_pd(scale, ty));
+            Fz = _mm_add_pd(Fz, _mm_mul_pd(scale, tz));
+            powerLoss = _mm_add_pd(powerLoss, 
+                            _mm_and_pd(slip, _mm_mul_pd(fFriction, vslip)));
+        }
+
+        // Accumulate the force and its moment about the resultant point.
+        __m128d Mx, My, Mz;
+        cross(rx,ry,rz, Fx,Fy,Fz, Mx,My,Mz);
+        fx = _mm_add_pd(fx, Fx); fy = _mm_add_pd(fy, Fy); 
+        fz = _mm_add_pd(fz, Fz);
+        mx = _mm_add_pd(mx, Mx); my = _mm_add_pd(my, My); 
+        mz = _mm_add_pd(mz, Mz);
+    }
+
+    sums.force       += Vec3(sumLanes(fx), sumLanes(fy), sumLanes(fz));
+    sums.moment      += Vec3(sumLanes(mx), sumLanes(my), sumLanes(mz));
+    sums.weightedCOP += Vec3(sumLanes(wcx), sumLanes(wcy), sumLanes(wcz));
+    sums.sumOfPressureMoments += sumLanes(sumPM);
+    sums.pe          += sumLanes(pe);
+    sums.powerLoss   += sumLanes(powerLoss);
+    addMeshSpringForces(mc, b, k, n, sums, 0); // odd one out
+}
+#endif
+
+// Private method that calculates the net contact force produced by a single 
+// triangle mesh in contact with some other object (which might be another
+// mesh; we don't care). We are given the relative spatial pose and velocity of
+// the two surface frames, and for the mesh we are given a specific list of
+// the faces that are suspected of being at least partially inside the 
+// other surface (in the undeformed geometry overlap). Normally this just 
+// computes the resultant force but it can optionally append contact patch 
+// details (one entry per element) as well, if the contactDetails argument is 
+// non-null.
+// An area-scaling factor is used to scale the area represented by each face.
+// If there is only one mesh involved this should be 1. However, if this
+// is part of a pair of contact meshes each half of the pair should be scaled
+// so that both surfaces see the same overall patch area (so nominally the
+// area-scaling factor would be 0.5).
+void ContactForceGenerator::ElasticFoundation::
+processOneMesh
+   (const State&                            state,
+    const ContactGeometry::TriangleMesh&    mesh,
+    const Array_<int>&                      insideFaces,
+    const Transform&                        X_MO, 
+    const SpatialVec&                       V_MO,
+    const ContactGeometry&                  other,
+    Real                                    meshDeformationFraction, // 0..1
+    Real                                    areaScaleFactor,
+    Real kh, Real c, Real us, Real ud, Real uv, // composite material props
+    const Vec3&                 resultantPt_M, // where to apply forces
+    SpatialVec&                 resultantForceOnOther_M, // at resultant pt
+    Real&                       potentialEnergy,
+    Real&                       powerLoss,
+    Vec3&                       weightedCenterOfPressure_M,
+    Real&                       sumOfAllPressureMoments,   // COP weight
+    Array_<ContactDetail>*      contactDetails_M) const    // in/out if present 
+{
+    assert(!insideFaces.empty());
+    const bool wantDetails = (contactDetails_M != 0);
+
+    // Don't initialize contact details; we're going to append them.
 
+    // Abbreviations and the other constants the spring kernels need.
+    const CompliantContactSubsystem& subsys = getCompliantContactSubsystem();
+    MeshSpringConstants mc;
+    mc.kh = kh; mc.c = c; mc.us = us; mc.ud = ud; mc.uv = uv;
+    mc.vtrans   = subsys.getTransitionVelocity();
+    mc.ooVtrans = subsys.getOOTransitionVelocity(); // 1/vtrans
+    mc.meshDeformationFraction = meshDeformationFraction;
+    mc.pMO = X_MO.p();  // position of OO (origin of O) in M
+    mc.wMO = V_MO[0];   // ang. vel. of O in M
+    mc.vMO = V_MO[1];   // vel. of OO in M
+    mc.resultantPt = resultantPt_M;
+
+    // Nearest points on the other surface are found for a block of springs 
+    // at a time with a single call, rather than with a virtual call per 
+    // spring. The block is then handed to the spring kernel in 
+    // structure-of-arrays form, in M; springs that turn out not to be inside
+    // get zero area.
+    const int nSprings = (int)insideFaces.size();
+    Vec3     springPos_O[SpringBlockSize], nearest_O[SpringBlockSize];
+    bool     inside[SpringBlockSize];
+    UnitVec3 normal_O[SpringBlockSize]; // not used
+    ElasticFoundationSprings::SpringBlock block;
+    MeshSpringSums sums;
+
+    for (int first=0; first < nSprings; first += SpringBlockSize) {
+        const int n = std::min(SpringBlockSize, nSprings-first);
+        for (int j=0; j < n; ++j) { // 18 flops/spring
+            const Vec3 springPos_M = mesh.findCentroid(insideFaces[first+j]);
+            springPos_O[j] = ~X_MO*springPos_M;
+            block.sx[j] = springPos_M[0]; 
+            block.sy[j] = springPos_M[1]; 
+            block.sz[j] = springPos_M[2];
+        }
+        other.findNearestPoints(n, springPos_O, nearest_O, inside, normal_O);
+        for (int j=0; j < n; ++j) { // 18 flops/spring
+            const Vec3 nearestPoint_M = X_MO*nearest_O[j];
+            block.px[j] = nearestPoint_M[0]; 
+            block.py[j] = nearestPoint_M[1]; 
+            block.pz[j] = nearestPoint_M[2];
+            block.area[j] = inside[j] 
+                ? areaScaleFactor*mesh.getFaceArea(insideFaces[first+j]) : 0;
+        }
+
+        // Details are only collected by the one-at-a-time kernel.
+        #ifdef SimTK_ELASTIC_FOUNDATION_SSE2
+        if (!wantDetails)
+            addMeshSpringForcesSSE2(mc, block, n, sums);
+        else
+        #endif
+            addMeshSpringForces(mc, block, 0, n, sums, contactDetails_M);
+    }
+
+    resultantForceOnOther_M    = SpatialVec(sums.moment, sums.force);
+    potentialEnergy            = sums.pe;
+    powerLoss                  = sums.powerLoss;
+    weightedCenterOfPressure_M = sums.weightedCOP;
+    sumOfAllPressureMoments    = sums.sumOfPressureMoments;
+}
+
+} // namespace SimTK
@@ -2262,7 +2262,7 @@ Constraint::CoordinateCouplerImpl::CoordinateCouplerImpl
     const Array_<MobilizerQIndex>&      coordQIndex)
 :   Implementation(matter, 1, 0, 0), function(function), 
     coordBodies(coordMobod.size()), coordIndices(coordQIndex),
-    temp(coordBodies.size()), referenceCount(new int[1]) 
+    referenceCount(new int[1]) 
 {
     assert(coordBodies.size() == coordIndices.size());
     assert(coordIndices.size() == function->getArgumentSize());
@@ -2274,6 +2274,19 @@ Constraint::CoordinateCouplerImpl::CoordinateCouplerImpl
     }
 }
 
+// The Function arguments are gathered into a scratch Vector that lives in
+// the State, so that evaluating this constraint neither allocates nor writes 
+// to shared memory.
+void Constraint::CoordinateCouplerImpl::realizeTopology(State& state) const {
+    tempIx = getMatterSubsystem().allocateCacheEntry(state, Stage::Model,
+        Stage::Infinity, new Value<Vector>(Vector((int)coordBodies.size())));
+}
+
+Vector& Constraint::CoordinateCouplerImpl::updTemp(const State& state) const {
+    return Value<Vector>::updDowncast
+                            (getMatterSubsystem().updCacheEntry(state, tempIx));
+}
+
 void Constraint::CoordinateCouplerImpl::
 calcPositionErrors     
    (const State&                                    s,
@@ -2281,6 +2294,7 @@ calcPositionErrors
     const Array_<Real,     ConstrainedQIndex>&      constrainedQ,
     Array_<Real>&                                   perr) const
 {
+    Vector& temp = updTemp(s);
     for (int i = 0; i < temp.size(); ++i)
         temp[i] = getOneQ(s, constrainedQ, coordBodies[i], coordIndices[i]);
     perr[0] = function->calcValue(temp);
@@ -2293,6 +2307,7 @@ calcPositionDotErrors
     const Array_<Real,      ConstrainedQIndex>&     constrainedQDot,
     Array_<Real>&                                   pverr) const
 {
+    Vector& temp = updTemp(s);
     pverr[0] = 0;
     for (int i = 0; i < temp.size(); ++i)
         temp[i] = getOneQFromState(s, coordBodies[i], coordIndices[i]);
@@ -2312,6 +2327,7 @@ calcPositionDotDotErrors
     const Array_<Real,      ConstrainedQIndex>&     constrainedQDotDot,
     Array_<Real>&                                   paerr) const
 {
+    Vector& temp = updTemp(s);
     paerr[0] = 0.0;
     for (int i = 0; i < temp.size(); ++i)
         temp[i] = getOneQFromState(s, coordBodies[i], coordIndices[i]);
@@ -2345,6 +2361,7 @@ addInPositionConstraintForces
     Array_<SpatialVec,ConstrainedBodyIndex>&    bodyForces,
     Array_<Real,ConstrainedQIndex>&             qForces) const
 {
+    Vector& temp = updTemp(s);
     assert(multipliers.size() == 1);
     assert(bodyForces.size() == 0);
 
@@ -2395,11 +2412,12 @@ Constraint::SpeedCouplerImpl::SpeedCouplerImpl
 :   Implementation(matter, 0, 1, 0), function(function), 
     speedBodies(speedBody.size()), speedIndices(speedIndex), 
     coordBodies(coordBody), coordIndices(coordIndex),
-    temp(speedBody.size()+coordBody.size()), referenceCount(new int[1]) 
+    referenceCount(new int[1]) 
 {
     assert(speedBodies.size() == speedIndices.size());
     assert(coordBodies.size() == coordIndices.size());
-    assert(temp.size() == function->getArgumentSize());
+    assert((int)(speedBodies.size()+coordBodies.size()) 
+           == function->getArgumentSize());
     assert(function->getMaxDerivativeOrder() >= 2);
 
     referenceCount[0] = 1;
@@ -2409,6 +2427,17 @@ Constraint::SpeedCouplerImpl::SpeedCouplerImpl
     }
 }
 
+void Constraint::SpeedCouplerImpl::realizeTopology(State& state) const {
+    const int nargs = (int)(speedBodies.size()+coordBodies.size());
+    tempIx = getMatterSubsystem().allocateCacheEntry(state, Stage::Model,
+        Stage::Infinity, new Value<Vector>(Vector(nargs)));
+}
+
+Vector& Constraint::SpeedCouplerImpl::updTemp(const State& state) const {
+    return Value<Vector>::updDowncast
+                            (getMatterSubsystem().updCacheEntry(state, tempIx));
+}
+
 // Constraint is f(q,u)=0, i.e. verr=f(q,u).
 void Constraint::SpeedCouplerImpl::
 calcVelocityErrors     
@@ -2417,6 +2446,7 @@ calcVelocityErrors
     const Array_<Real,      ConstrainedUIndex>&     constrainedU,
     Array_<Real>&                                   verr) const
 {
+    Vector& temp = updTemp(s);
     for (int i = 0; i < (int) speedBodies.size(); ++i)
         temp[i] = getOneU(s, constrainedU, speedBodies[i], speedIndices[i]);
     for (int i = 0; i < (int) coordBodies.size(); ++i)
@@ -2434,6 +2464,7 @@ calcVelocityDotErrors
     const Array_<Real,      ConstrainedUIndex>&     constrainedUDot,
     Array_<Real>&                                   vaerr) const 
 {
+    Vector& temp = updTemp(s);
     for (int i = 0; i < (int)speedBodies.size(); ++i)
         temp[i] = getOneUFromState(s, speedBodies[i], speedIndices[i]);
     for (int i = 0; i < (int)coordBodies.size(); ++i) {
@@ -2468,6 +2499,7 @@ addInVelocityConstraintForces
     Array_<SpatialVec,ConstrainedBodyIndex>&    bodyForces,
     Array_<Real,ConstrainedUIndex>&             mobilityForces) const
 {
+    Vector& temp = updTemp(s);
     assert(multipliers.size() == 1);
     const Real lambda = multipliers[0];
 
@@ -2507,7 +2539,7 @@ Constraint::PrescribedMotionImpl::PrescribedMotionImpl
     MobilizedBodyIndex coordBody, 
     MobilizerQIndex coordIndex)
 :   Implementation(matter, 1, 0, 0), function(function), 
-    coordIndex(coordIndex), temp(1), referenceCount(new int[1]) 
+    coordIndex(coordIndex), referenceCount(new int[1]) 
 {
     assert(function->getArgumentSize() == 1);
     assert(function->getMaxDerivativeOrder() >= 2);
@@ -2517,6 +2549,16 @@ Constraint::PrescribedMotionImpl::PrescribedMotionImpl
     this->coordBody = addConstrainedMobilizer(mobod);
 }
 
+void Constraint::PrescribedMotionImpl::realizeTopology(State& state) const {
+    tempIx = getMatterSubsystem().allocateCacheEntry(state, Stage::Model,
+        Stage::Infinity, new Value<Vector>(Vector(1)));
+}
+
+Vector& Constraint::PrescribedMotionImpl::updTemp(const State& state) const {
+    return Value<Vector>::updDowncast
+                            (getMatterSubsystem().updCacheEntry(state, tempIx));
+}
+
 void Constraint::PrescribedMotionImpl::
 calcPositionErrors     
    (const State&                                    s,
@@ -2524,6 +2566,7 @@ calcPositionErrors
     const Array_<Real,     ConstrainedQIndex>&      constrainedQ,
     Array_<Real>&                                   perr) const
 {
+    Vector& temp = updTemp(s);
     temp[0] = s.getTime();
     perr[0] = getOneQ(s, constrainedQ, coordBody, coordIndex) 
               - function->calcValue(temp);
@@ -2536,6 +2579,7 @@ calcPositionDotErrors
     const Array_<Real,      ConstrainedQIndex>&     constrainedQDot,
     Array_<Real>&                                   pverr) const
 {
+    Vector& temp = updTemp(s);
     temp[0] = s.getTime();
     Array_<int> components(1, 0); // i.e., components={0}
     pverr[0] = getOneQDot(s, constrainedQDot, coordBody, coordIndex) 
@@ -2549,6 +2593,7 @@ calcPositionDotDotErrors
     const Array_<Real,      ConstrainedQIndex>&     constrainedQDotDot,
     Array_<Real>&                                   paerr) const
 {
+    Vector& temp = updTemp(s);
     temp[0] = s.getTime();
     Array_<int> components(2, 0); // i.e., components={0,0}
     paerr[0] = getOneQDotDot(s, constrainedQDotDot, coordBody, coordIndex)  
@@ -2983,6 +2983,8 @@ Implementation* clone() const {
     return newCoupler;
 }
 
+void realizeTopology(State& state) const;
+
 void calcPositionErrors     
    (const State&                                    state,
     const Array_<Transform,ConstrainedBodyIndex>&   X_AB, 
@@ -3017,16 +3019,15 @@ Array_<ConstrainedMobilizerIndex>   coordBodies;
 Array_<MobilizerQIndex>             coordIndices;
 
 //  TOPOLOGY CACHE
-//  None.
-
-//  A reusable temporary variable allocated to the correct size
-//  to hold all the Function arguments.
-mutable Vector                      temp;
+//  Index of a per-State scratch Vector sized to hold all the Function
+//  arguments; see updTemp().
+mutable CacheEntryIndex             tempIx;
 
 // This allows copies to be made of this constraint which share
 // the function object.
 int*                                referenceCount;
 
+Vector& updTemp(const State& state) const;
 };
 
 
@@ -3056,6 +3057,8 @@ Implementation* clone() const {
     return new SpeedCouplerImpl(*this);
 }
 
+void realizeTopology(State& state) const;
+
 void calcVelocityErrors     
    (const State&                                    state,
     const Array_<SpatialVec,ConstrainedBodyIndex>&  V_AB, 
@@ -3083,7 +3086,9 @@ Array_<ConstrainedMobilizerIndex>   speedBodies;
 Array_<MobilizedBodyIndex>          coordBodies;
 Array_<MobilizerUIndex>             speedIndices;
 Array_<MobilizerQIndex>             coordIndices;
-mutable Vector                      temp;
+mutable CacheEntryIndex             tempIx;
+
+Vector& updTemp(const State& state) const;
 };
 
 
@@ -3111,6 +3116,8 @@ Implementation* clone() const {
     return new PrescribedMotionImpl(*this);
 }
 
+void realizeTopology(State& state) const;
+
 void calcPositionErrors     
    (const State&                                    state,
     const Array_<Transform,ConstrainedBodyIndex>&   X_AB, 
@@ -3141,7 +3148,9 @@ const Function*             function;
 int*                        referenceCount;
 ConstrainedMobilizerIndex   coordBody;
 MobilizerQIndex             coordIndex;
-mutable Vector              temp;
+mutable CacheEntryIndex     tempIx;
+
+Vector& updTemp(const State& state) const;
 };
 
 
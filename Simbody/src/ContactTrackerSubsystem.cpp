@@ -82,38 +82,205 @@ static std::ostream& operator<<(std::ostream& o, const BubbleExtent& bx) {
     return o;
 }
 
-typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
-                  pair<ContactTracker*,bool> > TrackerMap;
+// One end of a bubble's extent along an axis, for the incremental sweep and
+// prune. Lower ends sort before upper ends at the same location so that 
+// touching extents are treated as overlapping.
+struct SweepEndpoint {
+    SweepEndpoint() {}
+    SweepEndpoint(Real value, BubbleIndex bubble, bool isUpper)
+    :   value(value), bubble(bubble), isUpper(isUpper) {}
+    bool operator<(const SweepEndpoint& e) const 
+    {   return value < e.value || (value == e.value && !isUpper && e.isUpper); }
+    Real        value;
+    BubbleIndex bubble;
+    bool        isUpper;
+};
+static std::ostream& operator<<(std::ostream& o, const SweepEndpoint& e) {
+    return o << e.bubble << (e.isUpper ? "+" : "-") << ":" << e.value;
+}
 
-// This type maps a contact surface onto a set of all the higher-numbered
-// contact surfaces it might be touching, and for each of those we keep
-// a pointer to that pair's Contact object if it is currently being tracked
-// (null if it is new). You must use the *lower* numbered surface as the key 
-// when inserting a pair so that any given pair of surfaces appears just once.
-// However, the surface order in the Contact object will be determined by
-// the order required by the corresponding tracker.
-// TODO: replace with a fast data structure
-typedef std::map<ContactSurfaceIndex,const Contact*> ContactSurfaceSet;
-typedef std::map<ContactSurfaceIndex,ContactSurfaceSet> PairMap;
-
-static std::ostream& operator<<(std::ostream& o, const ContactSurfaceSet& css) {
-    ContactSurfaceSet::const_iterator p = css.begin();
-    o << "{";
-    for (; p != css.end(); ++p) {
-        if (p!=css.begin()) o << ", ";
-        o << p->first << ":0x" << p->second;
+// Sort the endpoints of one axis. A list that was sorted last time is 
+// usually still nearly sorted, so an insertion sort brings it up to date in
+// close to linear time. But after a large jump (a fresh or copied State, or
+// a big step) that could take O(n^2), so once the insertion sort has moved 
+// about as many elements as std::sort would compare we finish with 
+// std::sort instead. Pass isNearlySorted=false when the list was just 
+// rebuilt, to go straight to std::sort.
+static void sortSweepEndpoints(Array_<SweepEndpoint>& ends, 
+                               bool isNearlySorted) 
+{
+    const int n = (int)ends.size();
+    if (isNearlySorted) {
+        long maxMoves = n;
+        for (int m=n; m > 1; m /= 2) maxMoves += n;  // ~ n log2 n
+        long moves = 0;
+        int  i = 1;
+        for (; i < n && moves <= maxMoves; ++i) {
+            const SweepEndpoint e = ends[i];
+            int j = i-1;
+            for (; j >= 0 && e < ends[j]; --j)
+                ends[j+1] = ends[j];
+            ends[j+1] = e;
+            moves += i-1-j;
+        }
+        if (i == n) 
+            return;
     }
-    return o << "}";
+    std::sort(ends.begin(), ends.end());
+}
+
+// A pair of contact surfaces that needs a narrow phase look, with a pointer
+// to that pair's Contact object if it is currently being tracked (null if it
+// is new). The lower numbered surface always comes first so that any given
+// pair of surfaces appears just once. However, the surface order in the 
+// Contact object will be determined by the order required by the 
+// corresponding tracker.
+struct SurfacePair {
+    SurfacePair() : contact(0) {}
+    SurfacePair(ContactSurfaceIndex low, ContactSurfaceIndex high, 
+                const Contact* contact)
+    :   low(low), high(high), contact(contact) {}
+    bool operator<(const SurfacePair& p) const 
+    {   return low < p.low || (low == p.low && high < p.high); }
+    ContactSurfaceIndex low, high;
+    const Contact*      contact;
+};
+static std::ostream& operator<<(std::ostream& o, const SurfacePair& sp) {
+    return o << "(" << sp.low << "," << sp.high << "):0x" << sp.contact;
 }
-static std::ostream& operator<<(std::ostream& o, const PairMap& pm) {
-    PairMap::const_iterator p = pm.begin();
-    for (; p != pm.end(); ++p) {
-        if (p != pm.begin()) o << endl;
-        o << p->first << "->" << p->second;
+
+// This is the set of surface pairs to be examined by the narrow phase. It is
+// rebuilt every time contacts are updated, so is designed to be cleared and 
+// refilled without touching the heap once it has grown to its working size.
+// Pairs are kept in a plain array in insertion order; an open-addressing 
+// (linear probing) hash table of pair keys, sized to a power of two at 
+// least twice the number of pairs, is used to reject duplicates. Call
+// sort() when done inserting to put the pairs in (low,high) order so that 
+// contacts are always processed in the same order regardless of how they
+// were found.
+class SurfacePairTable {
+public:
+    SurfacePairTable() : m_mask(0) {}
+
+    // Remove all the pairs but keep the heap space.
+    void clear() {
+        m_pairs.clear();
+        if (!m_slots.empty())
+            std::fill(m_slots.begin(), m_slots.end(), emptySlot());
+    }
+
+    // Add this pair unless it is already present. The surfaces must be
+    // given in (low,high) order. Returns true if the pair was added.
+    bool insert(ContactSurfaceIndex low, ContactSurfaceIndex high,
+                const Contact* contact) {
+        assert(low < high);
+        if (2*(m_pairs.size()+1) > m_slots.size())
+            grow();
+        const unsigned long long key = makeKey(low, high);
+        for (unsigned slot = hash(key); ; slot = (slot+1) & m_mask) {
+            if (m_slots[slot] == key) 
+                return false;
+            if (m_slots[slot] == emptySlot()) {
+                m_slots[slot] = key;
+                m_pairs.push_back(SurfacePair(low, high, contact));
+                return true;
+            }
+        }
+    }
+
+    // Put the pairs in ascending (low,high) order. This doesn't affect
+    // the hash table.
+    void sort() {std::sort(m_pairs.begin(), m_pairs.end());}
+
+    int size() const {return (int)m_pairs.size();}
+    const SurfacePair& operator[](int i) const {return m_pairs[i];}
+
+private:
+    static unsigned long long emptySlot() {return ~0ULL;}
+
+    static unsigned long long makeKey(ContactSurfaceIndex low, 
+                                      ContactSurfaceIndex high)
+    {   return ((unsigned long long)(unsigned)low << 32) | (unsigned)high; }
+
+    // Fibonacci hashing: multiply by 2^64/phi and keep the high bits,
+    // which spreads out the nearly consecutive keys we usually see.
+    unsigned hash(unsigned long long key) const {
+        return (unsigned)((key * 0x9E3779B97F4A7C15ULL) >> 32) & m_mask;
+    }
+
+    // Double the number of slots and rehash the pairs we already have.
+    void grow() {
+        const unsigned nSlots = std::max(64u, 2*(unsigned)m_slots.size());
+        m_slots.clear();
+        m_slots.resize(nSlots, emptySlot());
+        m_mask = nSlots-1;
+        for (unsigned i=0; i < m_pairs.size(); ++i) {
+            const unsigned long long key = 
+                makeKey(m_pairs[i].low, m_pairs[i].high);
+            unsigned slot = hash(key);
+            while (m_slots[slot] != emptySlot())
+                slot = (slot+1) & m_mask;
+            m_slots[slot] = key;
+        }
+    }
+
+    Array_<SurfacePair>         m_pairs;
+    Array_<unsigned long long>  m_slots;
+    unsigned                    m_mask;
+};
+static std::ostream& operator<<(std::ostream& o, const SurfacePairTable& pt) {
+    for (int i=0; i < pt.size(); ++i) {
+        if (i) o << endl;
+        o << pt[i];
     }
     return o;
 }
 
+// Stands in for the prior Contact of a surface pair that has none, so that a 
+// tracker can be given one without allocating a new UntrackedContact for every
+// such pair on every evaluation. It is modified in place, so a copy gets its 
+// own rather than sharing this one.
+class UntrackedContactWorkspace {
+public:
+    UntrackedContactWorkspace() {}
+    UntrackedContactWorkspace(const UntrackedContactWorkspace&) {}
+    UntrackedContactWorkspace& operator=(const UntrackedContactWorkspace&)
+    {   m_contact.clear(); return *this; }
+
+    const Contact& get(ContactSurfaceIndex surf1, ContactSurfaceIndex surf2) {
+        if (m_contact.isEmpty())
+            m_contact = UntrackedContact(surf1, surf2);
+        else
+            m_contact.setSurfaces(surf1, surf2);
+        return m_contact;
+    }
+private:
+    UntrackedContact m_contact;
+};
+
+// This is the persistent part of the incremental sweep and prune, kept in a
+// cache entry. Between evaluations the bodies usually move only a little so
+// last time's sorted endpoint lists are nearly sorted already and can be 
+// brought up to date in close to linear time; see sortSweepEndpoints(). The 
+// other members are just reusable workspace, including the table of pairs
+// that is filled in when the active contacts are updated.
+struct BroadPhaseCache {
+    Array_<SweepEndpoint>   endpoints[3];   // sorted, 2 per bubble per axis
+    Array_<Vec3,BubbleIndex> centers;       // bubble centers in Ground
+    Array_<BubbleIndex>     active;         // bubbles open during the sweep
+    Array_<int,BubbleIndex> activeSlot;     // where each is in active
+    SurfacePairTable        pairs;          // for the narrow phase
+    SurfacePairTable        predictionPairs;// for contact prediction
+    Array_<Real,BubbleIndex> margins;       // bubble growth for prediction
+    UntrackedContactWorkspace untracked;    // for pairs with no history
+};
+static std::ostream& operator<<(std::ostream& o, const BroadPhaseCache& bpc) {
+    return o << "BroadPhaseCache(" << bpc.centers.size() << " bubbles)";
+}
+
+typedef std::map< pair<ContactGeometryTypeId,ContactGeometryTypeId>,
+                  pair<ContactTracker*,bool> > TrackerMap;
+
 
 
 //==============================================================================
@@ -123,7 +290,10 @@ class ContactTrackerSubsystemImpl : public Subsystem::Guts {
 public:
 // Constructor registers a default set of Trackers to use with geometry
 // we know about. These can be overridden later.
-ContactTrackerSubsystemImpl() : m_defaultTracker(0) {
+ContactTrackerSubsystemImpl() 
+:   m_defaultTracker(0), 
+    m_broadPhaseMethod(ContactTrackerSubsystem::IncrementalSweepAndPrune),
+    m_predictionInterval(0) {
     adoptContactTracker(new ContactTracker::HalfSpaceSphere());
     adoptContactTracker(new ContactTracker::SphereSphere());
     adoptContactTracker(new ContactTracker::HalfSpaceEllipsoid());
@@ -205,6 +375,32 @@ ContactSnapshot& updNextPredictedContacts(const State& state) const {
     return contacts;
 }
 
+// The broad phase workspace is a Position stage cache entry, but everything
+// in it is recomputed whenever it is used so we can write to it at any stage.
+BroadPhaseCache& updBroadPhaseCache(const State& state) const {
+    return Value<BroadPhaseCache>::updDowncast
+        (updCacheEntry(state, m_broadPhaseCacheIx));
+}
+
+// The ground frame pose X_GS of every surface is calculated once, the first
+// time any of them is needed after positions change, and is then used both
+// for tracking and by the force subsystems that respond to the contacts.
+const Array_<Transform,ContactSurfaceIndex>& 
+getSurfaceTransformsInGround(const State& state) const {
+    if (!isCacheValueRealized(state, m_surfaceTransformsIx)) {
+        Array_<Transform,ContactSurfaceIndex>& X_GS = 
+            Value< Array_<Transform,ContactSurfaceIndex> >::updDowncast
+                (updCacheEntry(state, m_surfaceTransformsIx));
+        X_GS.resize(getNumSurfaces());
+        for (ContactSurfaceIndex surfx(0); surfx < getNumSurfaces(); ++surfx)
+            X_GS[surfx] = m_surfaces[surfx].mobod->getBodyTransform(state)
+                            * m_surfaces[surfx].X_BS;
+        markCacheValueRealized(state, m_surfaceTransformsIx);
+    }
+    return Value< Array_<Transform,ContactSurfaceIndex> >::downcast
+        (getCacheEntry(state, m_surfaceTransformsIx));
+}
+
 // Run through all the bodies to find the contact surfaces, assigning each
 // a unique ContactSurfaceIndex. Then for each surface, get its geometry
 // and create a Bubble from each of its bubble wrap spheres; each of those
@@ -220,6 +416,12 @@ int realizeSubsystemTopologyImpl(State& state) const {
     wThis->m_predictedContactsIx = allocateAutoUpdateDiscreteVariable
         (state, Stage::Dynamics, new Value<ContactSnapshot>(), 
          Stage::Acceleration);  // update depends on accelerations
+    wThis->m_broadPhaseCacheIx = allocateCacheEntry
+        (state, Stage::Position, new Value<BroadPhaseCache>());
+    wThis->m_surfaceTransformsIx = allocateLazyCacheEntry
+        (state, Stage::Position, 
+         new Value< Array_<Transform,ContactSurfaceIndex> >());
+    createScheduledEvent(state, wThis->m_predictedContactEventId);
 
     const SimbodyMatterSubsystem& matter = getMatterSubsystem();
 
@@ -259,14 +461,145 @@ int realizeSubsystemVelocityImpl(const State& state) const {
     return 0;
 }
 
-// Adds new pairs to the existing set, if not already present.
-void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
+// Adds new pairs to the existing set, if not already present, using the 
+// currently selected broad phase method. Either way we find exactly the 
+// pairs of surfaces whose bubbles overlap. If margins is given, each bubble
+// is inflated by the corresponding amount.
+void addInBroadPhasePairs(const State& state, SurfacePairTable& pairs,
+                          const Array_<Real,BubbleIndex>* margins=0) const {
+    if (m_broadPhaseMethod == ContactTrackerSubsystem::SingleAxisSweep)
+        addInSingleAxisSweepPairs(state, pairs, margins);
+    else
+        addInIncrementalSweepAndPrunePairs(state, pairs, margins);
+}
+
+// Given two bubbles that overlap along the sweep axis, see if they are 
+// actually touching and if so add their surfaces to the narrow phase list
+// unless there are relevant exclusions. A margin, if given, is added to the
+// sum of the bubble radii.
+void considerBubblePair(BubbleIndex bbx1, const Vec3& center1,
+                        BubbleIndex bbx2, const Vec3& center2,
+                        SurfacePairTable& pairs, Real margin=0) const
+{
+    const Bubble& bubb1 = m_bubbles[bbx1];
+    const Bubble& bubb2 = m_bubbles[bbx2];
+    if ((center1-center2).normSqr() 
+            > square(bubb1.getRadius()+bubb2.getRadius()+margin))
+        return; // nope
+
+    const Surface& surf1 = m_surfaces[bubb1.surface];
+    const Surface& surf2 = m_surfaces[bubb2.surface];
+    // Ignore if on the same body.
+    if (surf1.mobod == surf2.mobod) return;
+    assert(bubb1.surface != bubb2.surface); // duh!
+    // Ignore if surfaces are in a common clique.
+    if (surf1.surface->isInSameClique(*surf2.surface)) return;
+    // We'll need to do a narrow phase investigation of these two
+    // surfaces; put the lower-numbered one first to avoid duplicates.
+    ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
+    if (low > high) std::swap(low,high);
+    // Insert this pair with null Contact if the pair isn't already
+    // in the table.
+    pairs.insert(low, high, 0);
+}
+
+// Bring each axis's endpoint list up to date with the current bubble 
+// locations, then sweep along the axis that has the fewest overlapping
+// extents. Other-axis overlap is checked before the sphere test so the
+// result is a true 3-axis prune. If margins is given, each bubble is 
+// inflated by the corresponding amount.
+void addInIncrementalSweepAndPrunePairs
+   (const State& state, SurfacePairTable& pairs,
+    const Array_<Real,BubbleIndex>* margins=0) const 
+{
+    const int numBubbles = getNumBubbles();
+    BroadPhaseCache& bpc = updBroadPhaseCache(state);
+
+    bpc.centers.resize(numBubbles);
+    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
+        const Bubble&  bubb = m_bubbles[bbx];
+        const Surface& surf = m_surfaces[bubb.surface];
+        bpc.centers[bbx] = surf.mobod->getBodyTransform(state) 
+                            * bubb.getCenter();
+    }
+
+    int  bestAxis = 0;
+    long bestCost = -1;
+    for (int axis=0; axis < 3; ++axis) {
+        Array_<SweepEndpoint>& ends = bpc.endpoints[axis];
+        const bool rebuild = ((int)ends.size() != 2*numBubbles);
+        if (rebuild) { // first time, or the bubbles changed
+            ends.clear();
+            for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
+                ends.push_back(SweepEndpoint(0, bbx, false));
+                ends.push_back(SweepEndpoint(0, bbx, true));
+            }
+        }
+        for (int i=0; i < (int)ends.size(); ++i) {
+            SweepEndpoint& e = ends[i];
+            const Real r = m_bubbles[e.bubble].getRadius()
+                           + (margins ? (*margins)[e.bubble] : Real(0));
+            e.value = bpc.centers[e.bubble][axis] + (e.isUpper ? r : -r);
+        }
+
+        sortSweepEndpoints(ends, !rebuild);
+
+        // The sweep cost along this axis is the number of pairs of 
+        // overlapping extents, which we can count in O(n).
+        long cost = 0; int open = 0;
+        for (int i=0; i < (int)ends.size(); ++i)
+            if (ends[i].isUpper) --open;
+            else cost += open++;
+        if (bestCost < 0 || cost < bestCost) 
+        {   bestCost = cost; bestAxis = axis; }
+    }
+
+    const int axis1 = (bestAxis+1)%3, axis2 = (bestAxis+2)%3;
+    const Array_<SweepEndpoint>& ends = bpc.endpoints[bestAxis];
+    bpc.active.clear();
+    bpc.activeSlot.resize(numBubbles);
+    for (int i=0; i < (int)ends.size(); ++i) {
+        const BubbleIndex bbx = ends[i].bubble;
+        if (ends[i].isUpper) { // remove from active list
+            const int slot = bpc.activeSlot[bbx];
+            bpc.active[slot] = bpc.active.back();
+            bpc.activeSlot[bpc.active[slot]] = slot;
+            bpc.active.pop_back();
+            continue;
+        }
+        const Vec3& center = bpc.centers[bbx];
+        const Real  radius = m_bubbles[bbx].getRadius();
+        const Real  margin = margins ? (*margins)[bbx] : Real(0);
+        for (int k=0; k < (int)bpc.active.size(); ++k) {
+            const BubbleIndex other = bpc.active[k];
+            const Vec3& otherCenter = bpc.centers[other];
+            const Real  marginSum = 
+                margin + (margins ? (*margins)[other] : Real(0));
+            const Real  rsum = radius + m_bubbles[other].getRadius() 
+                               + marginSum;
+            if (   std::abs(center[axis1]-otherCenter[axis1]) > rsum
+                || std::abs(center[axis2]-otherCenter[axis2]) > rsum)
+                continue;
+            considerBubblePair(other, otherCenter, bbx, center, pairs,
+                               marginSum);
+        }
+        bpc.activeSlot[bbx] = bpc.active.size();
+        bpc.active.push_back(bbx);
+    }
+}
+
+// Perform a sweep-and-prune on a single axis to identify potential 
+// contacts. This is rebuilt from scratch each time.
+// If margins is given, each bubble is inflated by the corresponding amount.
+void addInSingleAxisSweepPairs
+   (const State& state, SurfacePairTable& pairs,
+    const Array_<Real,BubbleIndex>* margins=0) const {
     const int numBubbles = getNumBubbles();
     
-    // Perform a sweep-and-prune on a single axis to identify potential 
-    // contacts. First, find which axis has the most variation in body 
+    // First, find which axis has the most variation in body 
     // locations. That is the axis we will use.
-    // TODO: this one-axis method is not good enough in general
+    // Note that this one-axis method is not good enough in general; see 
+    // addInIncrementalSweepAndPrunePairs().
     
     Vector_<Vec3> centers(numBubbles);
     for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
@@ -287,7 +620,8 @@ void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
     // starting location.
     Array_<BubbleExtent,int> extents(numBubbles);
     for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
-        const Real radius = m_bubbles[bbx].getRadius();
+        const Real radius = m_bubbles[bbx].getRadius() 
+                            + (margins ? (*margins)[bbx] : Real(0));
         const Real center = centers[bbx][axis];
         extents[bbx] = BubbleExtent(center-radius, center+radius, bbx);
     }
@@ -300,8 +634,6 @@ void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
     
     for (int ex1=0; ex1 < numBubbles; ++ex1) {
         const BubbleExtent& extent1 = extents[ex1];
-        const Bubble&       bubb1   = m_bubbles[extent1.index];
-        const Real          radius1 = bubb1.getRadius();
         const Vec3&         center1 = centers[extent1.index];
 
         // Loop over just the overlapping bubbles.
@@ -312,34 +644,29 @@ void addInBroadPhasePairs(const State& state, PairMap& pairs) const {
 
             // These bubbles do overlap along this axis. See if they are
             // actually touching.
-            const Bubble& bubb2   = m_bubbles[extent2.index];
-            const Real    radius2 = bubb2.getRadius();
-            const Vec3&   center2 = centers[extent2.index];
-            if ((center1-center2).normSqr() > square(radius1+radius2))
-                continue; // nope
-
-            // The bubbles are touching. We'll add the corresponding surfaces
-            // to the narrow-phase list unless there are relevant exclusions.
-            const Surface& surf1 = m_surfaces[bubb1.surface];
-            const Surface& surf2 = m_surfaces[bubb2.surface];
-            // Ignore if on the same body.
-            if (surf1.mobod == surf2.mobod) continue;
-            assert(bubb1.surface != bubb2.surface); // duh!
-            // Ignore if surfaces are in a common clique.
-            if (surf1.surface->isInSameClique(*surf2.surface)) continue;
-            // We'll need to do a narrow phase investigation of these two
-            // surfaces; use the lower-numbered one as the index to avoid
-            // duplicates.
-            ContactSurfaceIndex low=bubb1.surface, high=bubb2.surface;
-            if (low > high) std::swap(low,high);
-            ContactSurfaceSet& surfSet = pairs[low];
-            // Insert this pair with null Contact if the pair isn't already
-            // in the PairMap.
-            surfSet.insert(make_pair(high,(Contact*)0));
+            considerBubblePair(extent1.index, center1, 
+                               extent2.index, centers[extent2.index], pairs,
+                               margins ? (*margins)[extent1.index]
+                                         + (*margins)[extent2.index] 
+                                       : Real(0));
         }
     }
 }
 
+// Find all the surface pairs that pass the broad phase test, using the
+// currently selected method. This is for the public findBroadPhasePairs().
+void findBroadPhasePairs(const State& state, 
+    Array_<pair<ContactSurfaceIndex,ContactSurfaceIndex> >& found) const 
+{
+    SurfacePairTable& pairs = updBroadPhaseCache(state).pairs;
+    pairs.clear();
+    addInBroadPhasePairs(state, pairs);
+    pairs.sort();
+    found.clear();
+    for (int i=0; i < pairs.size(); ++i)
+        found.push_back(make_pair(pairs[i].low, pairs[i].high));
+}
+
 // Call this any time after positions are known, to ensure that the active
 // contact set has been updated for those positions. We can use three
 // sources of information to compute the update:
@@ -366,95 +693,96 @@ void ensureActiveContactsUpdated(const State& state) const {
     const ContactSnapshot& predicted  = getPrevPredictedContacts(state);
     ContactSnapshot&       nextActive = updNextActiveContacts(state);
 
-    // TODO: Can we reuse heap space in this cache entry?
+    // Clearing the snapshot keeps its heap space for refilling. This cache 
+    // entry is swapped with the previous active contacts state variable at 
+    // the end of each step, so its space is recycled in turn too.
     nextActive.clear();
 
-    PairMap interesting;
+    // The pair table is reused from one update to the next.
+    BroadPhaseCache& bpc = updBroadPhaseCache(state);
+    SurfacePairTable& interesting = bpc.pairs;
+    interesting.clear();
     for (int i=0; i < active.getNumContacts(); ++i) {
         const Contact& contact = active.getContact(i);
         ContactSurfaceIndex low=contact.getSurface1(), 
                             high=contact.getSurface2();
         if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        interesting.insert(low, high, &contact); // can't be there already
     }
     for (int i=0; i < predicted.getNumContacts(); ++i) {
         const Contact& contact = predicted.getContact(i);
         ContactSurfaceIndex low=contact.getSurface1(), 
                             high=contact.getSurface2();
         if (low > high) std::swap(low,high);
-        ContactSurfaceSet& others = interesting[low];
-        assert(others.find(high)==others.end());
-        others[high] = &contact;
+        interesting.insert(low, high, &contact); // can't be there already
     }
     // This will ignore pairs that we already inserted above; new ones
     // will be inserted with null Contact object pointers.
     addInBroadPhasePairs(state, interesting);
+    interesting.sort();
     //cout << "Interesting pairs:\n" << interesting << "\n";
 
-    PairMap::const_iterator p = interesting.begin();
-    for (; p != interesting.end(); ++p) {
-        const ContactSurfaceIndex index1 = p->first;
-        const Transform transform1 = 
-            m_surfaces[index1].mobod->getBodyTransform(state)
-                * m_surfaces[index1].X_BS;
+    const Array_<Transform,ContactSurfaceIndex>& X_GS = 
+        getSurfaceTransformsInGround(state);
+    for (int p=0; p < interesting.size(); ++p) {
+        const ContactSurfaceIndex index1 = interesting[p].low;
+        const Transform& transform1 = X_GS[index1];
         const ContactGeometry& geom1 = m_surfaces[index1].surface->getShape();
         const ContactGeometryTypeId typeId1 = geom1.getTypeId();
 
-        const ContactSurfaceSet& others = p->second;
-        ContactSurfaceSet::const_iterator q = others.begin();
-        for (; q != others.end(); ++q) {
-            const ContactSurfaceIndex index2 = q->first;
-            const Transform transform2 = 
-                m_surfaces[index2].mobod->getBodyTransform(state)
-                    * m_surfaces[index2].X_BS;
-            const ContactGeometry& geom2 = 
-                m_surfaces[index2].surface->getShape();
-            const ContactGeometryTypeId typeId2 = geom2.getTypeId();
-            if (!hasContactTracker(typeId1,typeId2))
-                continue; // No algorithm available for detecting collisions between these two objects.
-            bool mustReverse;
-            const ContactTracker& tracker = 
-                getContactTracker(typeId1, typeId2, mustReverse);
-
-            // Put the surfaces in the order required by the tracker.
-            const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
-            const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
-
-            UntrackedContact untracked; // empty handle in case we need it
-            const Contact* prev = q->second;
-            if (prev && prev->getCondition() == Contact::Broken)
-                prev = 0; // that contact expired
-            if (!prev) { 
-                untracked = UntrackedContact(trackSurf1, trackSurf2);
-                prev = &untracked;
-            }
-            Contact next; // empty handle
-            if (mustReverse)
-                tracker.trackContact
-                   (*prev, transform2,geom2, transform1,geom1, 0/*TODO*/, next);
-            else
-                tracker.trackContact
-                   (*prev, transform1,geom1, transform2,geom2, 0/*TODO*/, next);
-
-            if (!next.isEmpty()) {
-                next.setSurfaces(trackSurf1,trackSurf2);
-                next.setContactId(prev->getCondition()==Contact::Untracked
-                                    ? Contact::createNewContactId()
-                                    : prev->getContactId()); // persistent
-                if (   prev->getCondition()==Contact::Untracked
-                    || prev->getCondition()==Contact::Anticipated)
-                    next.setCondition(Contact::NewContact);
-                else { // was NewContact or Ongoing; now Ongoing or Broken
-                    assert(prev->getCondition()==Contact::NewContact
-                           || prev->getCondition()==Contact::Ongoing);
-                    if (next.getTypeId() != BrokenContact::classTypeId())
-                        next.setCondition(Contact::Ongoing);
-                    // Condition will already by Broken for a BrokenContact
-                }
-                nextActive.adoptContact(next);
+        const ContactSurfaceIndex index2 = interesting[p].high;
+        const Transform& transform2 = X_GS[index2];
+        const ContactGeometry& geom2 = 
+            m_surfaces[index2].surface->getShape();
+        const ContactGeometryTypeId typeId2 = geom2.getTypeId();
+        if (!hasContactTracker(typeId1,typeId2))
+            continue; // No algorithm available for detecting collisions between these two objects.
+        bool mustReverse;
+        const ContactTracker& tracker = 
+            getContactTracker(typeId1, typeId2, mustReverse);
+
+        // Put the surfaces in the order required by the tracker.
+        const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
+        const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
+
+        const Contact* prev = interesting[p].contact;
+        if (prev && prev->getCondition() == Contact::Broken)
+            prev = 0; // that contact expired
+        // An anticipated contact has no tracking history so is tracked as 
+        // new, but keeps its ContactId if the surfaces are touching now.
+        ContactId anticipatedId;
+        if (prev && prev->getCondition() == Contact::Anticipated) {
+            anticipatedId = prev->getContactId();
+            prev = 0;
+        }
+        if (!prev)
+            prev = &bpc.untracked.get(trackSurf1, trackSurf2);
+        Contact next; // empty handle
+        if (mustReverse)
+            tracker.trackContact
+               (*prev, transform2,geom2, transform1,geom1, 0/*TODO*/, next);
+        else
+            tracker.trackContact
+               (*prev, transform1,geom1, transform2,geom2, 0/*TODO*/, next);
+
+        if (!next.isEmpty()) {
+            next.setSurfaces(trackSurf1,trackSurf2);
+            if (prev->getCondition() != Contact::Untracked)
+                next.setContactId(prev->getContactId()); // persistent
+            else if (anticipatedId.isValid())
+                next.setContactId(anticipatedId);
+            else 
+                next.setContactId(Contact::createNewContactId());
+            if (prev->getCondition()==Contact::Untracked)
+                next.setCondition(Contact::NewContact);
+            else { // was NewContact or Ongoing; now Ongoing or Broken
+                assert(prev->getCondition()==Contact::NewContact
+                       || prev->getCondition()==Contact::Ongoing);
+                if (next.getTypeId() != BrokenContact::classTypeId())
+                    next.setCondition(Contact::Ongoing);
+                // Condition will already by Broken for a BrokenContact
             }
+            nextActive.adoptContact(next);
         }
     }
 
@@ -474,23 +802,164 @@ void ensureActiveContactsUpdated(const State& state) const {
 // Algorithm:
 //   for all "interesting" surface pairs (surf1,surf2):
 //      prev = getPrevPredictedContact(surf1,surf2) (might be empty)
-//      predictContact(prev, projBoundsNow?, next)
-//      updNextImpendingContact(surf1,surf2) = next  (might be empty)
-//   "interesting" means not currently active and:
-//      - previously impending, or
-//      - fast(surf1)||fast(surf2) and 
-//           fast object broad phase projected bounds intersect
+//      predictContact(prev, V, A, interval, next)
+//      updNextPredictedContact(surf1,surf2) = next  (might be empty)
+//   "interesting" means not currently in contact and:
+//      - previously predicted, or
+//      - swept broad phase bounds intersect, where each bubble is grown by
+//        the distance it could move during the prediction interval
+// Nothing is predicted unless a prediction interval has been set.
 void ensurePredictedContactsUpdated(const State& state) const {
     if (isDiscreteVarUpdateValueRealized(state, m_predictedContactsIx))
         return; // already done
 
+    ensureActiveContactsUpdated(state);
     const ContactSnapshot& nextActive    = getNextActiveContacts(state);
     const ContactSnapshot& prevPredicted = getPrevPredictedContacts(state);
     ContactSnapshot& nextPredicted = updNextPredictedContacts(state);
-    // TODO
+
+    nextPredicted.clear();
+    const Real interval = m_predictionInterval;
+    if (interval == 0) {
+        markDiscreteVarUpdateValueRealized(state, m_predictedContactsIx);
+        return;
+    }
+    nextPredicted.setTimestamp(state.getTime());
+
+    // Bound how far each bubble can move during the interval, assuming the
+    // surface frame's spatial acceleration stays constant. This is the same
+    // bound the trackers use.
+    BroadPhaseCache& bpc = updBroadPhaseCache(state);
+    const int numBubbles = getNumBubbles();
+    Array_<Real,BubbleIndex>& sweep = bpc.margins;
+    sweep.resize(numBubbles);
+    for (BubbleIndex bbx(0); bbx < numBubbles; ++bbx) {
+        const Bubble&  bubb = m_bubbles[bbx];
+        const Surface& surf = m_surfaces[bubb.surface];
+        const SpatialVec V_GS = 
+            surf.mobod->findFrameVelocityInGround(state, surf.X_BS);
+        const SpatialVec A_GS = 
+            surf.mobod->findFrameAccelerationInGround(state, surf.X_BS);
+        const Real reach = (~surf.X_BS*bubb.getCenter()).norm();
+        sweep[bbx] = interval*(  V_GS[1].norm() + interval*A_GS[1].norm()
+                               + reach*(  V_GS[0].norm() 
+                                        + interval*A_GS[0].norm()));
+    }
+
+    // Pairs that are in contact now go in first so they will be recognized
+    // and skipped; then previous predictions so their ContactIds are kept.
+    SurfacePairTable& interesting = bpc.predictionPairs;
+    interesting.clear();
+    const ContactSnapshot* known[2] = {&nextActive, &prevPredicted};
+    for (int k=0; k < 2; ++k)
+        for (int i=0; i < known[k]->getNumContacts(); ++i) {
+            const Contact& contact = known[k]->getContact(i);
+            ContactSurfaceIndex low=contact.getSurface1(), 
+                                high=contact.getSurface2();
+            if (low > high) std::swap(low,high);
+            interesting.insert(low, high, &contact);
+        }
+    addInBroadPhasePairs(state, interesting, &sweep);
+    interesting.sort();
+
+    const Array_<Transform,ContactSurfaceIndex>& X_GS = 
+        getSurfaceTransformsInGround(state);
+    for (int p=0; p < interesting.size(); ++p) {
+        const Contact* prev = interesting[p].contact;
+        if (prev && (   prev->getCondition()==Contact::NewContact
+                     || prev->getCondition()==Contact::Ongoing))
+            continue; // already touching
+
+        const ContactSurfaceIndex index1 = interesting[p].low;
+        const ContactSurfaceIndex index2 = interesting[p].high;
+        const ContactGeometry& geom1 = m_surfaces[index1].surface->getShape();
+        const ContactGeometry& geom2 = m_surfaces[index2].surface->getShape();
+        if (!hasContactTracker(geom1.getTypeId(), geom2.getTypeId()))
+            continue;
+        bool mustReverse;
+        const ContactTracker& tracker = 
+            getContactTracker(geom1.getTypeId(), geom2.getTypeId(), 
+                              mustReverse);
+
+        // Put the surfaces in the order required by the tracker.
+        const ContactSurfaceIndex trackSurf1 = (mustReverse? index2:index1);
+        const ContactSurfaceIndex trackSurf2 = (mustReverse? index1:index2);
+        const Surface& surf1 = m_surfaces[trackSurf1];
+        const Surface& surf2 = m_surfaces[trackSurf2];
+
+        const Contact& untracked = bpc.untracked.get(trackSurf1, trackSurf2);
+        Contact next; // empty handle
+        tracker.predictContact(untracked,
+            X_GS[trackSurf1], 
+            surf1.mobod->findFrameVelocityInGround(state, surf1.X_BS),
+            surf1.mobod->findFrameAccelerationInGround(state, surf1.X_BS),
+            surf1.surface->getShape(),
+            X_GS[trackSurf2], 
+            surf2.mobod->findFrameVelocityInGround(state, surf2.X_BS),
+            surf2.mobod->findFrameAccelerationInGround(state, surf2.X_BS),
+            surf2.surface->getShape(),
+            0, interval, next);
+
+        if (!next.isEmpty()) {
+            next.setSurfaces(trackSurf1,trackSurf2);
+            next.setContactId(prev && prev->getCondition()==Contact::Anticipated
+                                ? prev->getContactId() // persistent
+                                : Contact::createNewContactId());
+            next.setCondition(Contact::Anticipated);
+            nextPredicted.adoptContact(next);
+        }
+    }
+
     markDiscreteVarUpdateValueRealized(state, m_predictedContactsIx);
 }
 
+// When prediction is enabled, ask for a step to end at the earliest predicted
+// contact onset so that an integrator taking large steps through free flight
+// can't step past the start of a contact. Onsets closer than a small fraction
+// of the prediction interval are moved out to that fraction; conservative
+// advancement approaches the onset from below, so otherwise we would request
+// ever shorter steps as a contact closes in. The snapshot's timestamp is the
+// time at which the prediction was made.
+void calcTimeOfNextScheduledEvent
+   (const State& state, Real& tNextEvent, Array_<EventId>& eventIds, 
+    bool includeCurrentTime) const 
+{
+    tNextEvent = Infinity;
+    eventIds.clear();
+    if (m_predictionInterval == 0)
+        return;
+    const ContactSnapshot& predicted = 
+        state.getSystemStage() >= Stage::Acceleration 
+            ? getNextPredictedContacts(state) 
+            : getPrevPredictedContacts(state);
+    const Real minTimeToContact = Real(1e-3)*m_predictionInterval;
+    for (int i=0; i < predicted.getNumContacts(); ++i) {
+        const Contact& contact = predicted.getContact(i);
+        if (!AnticipatedContact::isInstance(contact))
+            continue;
+        // A pair already at its onset gets a short follow-up step instead, so
+        // the next step begins with the surfaces in contact and the
+        // integrator's error control sees the contact force.
+        const Real timeToContact = std::max(minTimeToContact,
+            static_cast<const AnticipatedContact&>(contact).getTimeToContact());
+        const Real time = predicted.getTimestamp() + timeToContact;
+        if (time < tNextEvent && (time > state.getTime() 
+            || (includeCurrentTime && time == state.getTime())))
+            tNextEvent = time;
+    }
+    if (tNextEvent < Infinity)
+        eventIds.push_back(m_predictedContactEventId);
+}
+
+// The predicted contact event only marks the end of a step; nothing changes.
+void handleEvents(State&, Event::Cause, const Array_<EventId>&,
+                  const HandleEventsOptions&, 
+                  HandleEventsResults& results) const 
+{
+    results.setAnyChangeMade(false);
+    results.setExitStatus(HandleEventsResults::Succeeded);
+}
+
 int realizeSubsystemDynamicsImpl(const State& state) const {
     ensureActiveContactsUpdated(state);
     return 0;
@@ -548,11 +1017,19 @@ friend class ContactTrackerSubsystem;
 TrackerMap          m_contactTrackers;
 ContactTracker*     m_defaultTracker;
 
+// This doesn't affect results so can be changed at any time.
+ContactTrackerSubsystem::BroadPhaseMethod   m_broadPhaseMethod;
+// Contact prediction looks this far ahead; zero means no prediction.
+Real                                        m_predictionInterval;
+
     // TOPOLOGY CACHE
 Array_<Surface,ContactSurfaceIndex> m_surfaces;
 Array_<Bubble,BubbleIndex>          m_bubbles;
 DiscreteVariableIndex               m_activeContactsIx;
 DiscreteVariableIndex               m_predictedContactsIx;
+CacheEntryIndex                     m_broadPhaseCacheIx;
+CacheEntryIndex                     m_surfaceTransformsIx;
+EventId                             m_predictedContactEventId;
 };
 
 
@@ -609,6 +1086,10 @@ const Transform& ContactTrackerSubsystem::
 getContactSurfaceTransform(ContactSurfaceIndex surfIx) const
 {   return getImpl().m_surfaces[surfIx].X_BS; }
 
+const Array_<Transform,ContactSurfaceIndex>& ContactTrackerSubsystem::
+getContactSurfaceTransformsInGround(const State& state) const
+{   return getImpl().getSurfaceTransformsInGround(state); }
+
 void ContactTrackerSubsystem::
 adoptContactTracker(ContactTracker* tracker)
 {   updImpl().adoptContactTracker(tracker); }
@@ -646,6 +1127,32 @@ getPredictedContacts(const State& state) const {
     return getImpl().getNextPredictedContacts(state);
 }
 
+void ContactTrackerSubsystem::
+setBroadPhaseMethod(BroadPhaseMethod method)
+{   updImpl().m_broadPhaseMethod = method; }
+
+ContactTrackerSubsystem::BroadPhaseMethod ContactTrackerSubsystem::
+getBroadPhaseMethod() const
+{   return getImpl().m_broadPhaseMethod; }
+
+void ContactTrackerSubsystem::
+setContactPredictionInterval(Real interval) {
+    SimTK_ERRCHK1_ALWAYS(interval >= 0,
+        "ContactTrackerSubsystem::setContactPredictionInterval()",
+        "The prediction interval must be nonnegative but was %g.", 
+        (double)interval);
+    updImpl().m_predictionInterval = interval;
+    getImpl().invalidateSubsystemTopologyCache();
+}
+
+Real ContactTrackerSubsystem::getContactPredictionInterval() const
+{   return getImpl().m_predictionInterval; }
+
+void ContactTrackerSubsystem::
+findBroadPhasePairs(const State& state, 
+    Array_<std::pair<ContactSurfaceIndex,ContactSurfaceIndex> >& pairs) const
+{   getImpl().findBroadPhasePairs(state, pairs); }
+
 bool ContactTrackerSubsystem::
 realizeActiveContacts(const State& state, 
                       bool         lastTry,
@@ -27,11 +27,12 @@
 #include "simbody/internal/GeneralContactSubsystem.h"
 #include "simbody/internal/MobilizedBody.h"
 #include "ElasticFoundationForceImpl.h"
-#include <map>
-#include <set>
+#include "ElasticFoundationSprings.h"
 
 namespace SimTK {
 
+using namespace ElasticFoundationSprings;
+
 SimTK_INSERT_DERIVED_HANDLE_DEFINITIONS(ElasticFoundationForce, ElasticFoundationForceImpl, Force);
 
 ElasticFoundationForce::ElasticFoundationForce(GeneralForceSubsystem& forces, GeneralContactSubsystem& contacts, ContactSetIndex set) :
@@ -67,20 +68,28 @@ void ElasticFoundationForceImpl::setBodyParameters
                         == ContactGeometry::TriangleMesh::classTypeId(), 
         "ElasticFoundationForceImpl", "setBodyParameters",
         "Body %d is not a triangle mesh", (int)bodyIndex);
+    if (bodyIndex >= (int)parameters.size()) {
+        parameters.resize(bodyIndex+1);
+        hasParameters.resize(bodyIndex+1, false);
+    }
     parameters[bodyIndex] = 
         Parameters(stiffness, dissipation, staticFriction, dynamicFriction, 
                    viscousFriction);
+    hasParameters[bodyIndex] = true;
     const ContactGeometry::TriangleMesh& mesh = 
         ContactGeometry::TriangleMesh::getAs
                 (subsystem.getBodyGeometry(set, bodyIndex));
     Parameters& param = parameters[bodyIndex];
-    param.springPosition.resize(mesh.getNumFaces());
-    param.springNormal.resize(mesh.getNumFaces());
-    param.springArea.resize(mesh.getNumFaces());
-    Vec2 uv(1.0/3.0, 1.0/3.0);
-    for (int i = 0; i < (int) param.springPosition.size(); i++) {
-        param.springPosition[i] = (mesh.getVertexPosition(mesh.getFaceVertex(i, 0))+mesh.getVertexPosition(mesh.getFaceVertex(i, 1))+mesh.getVertexPosition(mesh.getFaceVertex(i, 2)))/3.0;
-        param.springNormal[i] = -mesh.findNormalAtPoint(i, uv);
+    const int nFaces = mesh.getNumFaces();
+    param.springPosX.resize(nFaces);
+    param.springPosY.resize(nFaces);
+    param.springPosZ.resize(nFaces);
+    param.springArea.resize(nFaces);
+    for (int i = 0; i < nFaces; i++) {
+        const Vec3 position = (mesh.getVertexPosition(mesh.getFaceVertex(i, 0))+mesh.getVertexPosition(mesh.getFaceVertex(i, 1))+mesh.getVertexPosition(mesh.getFaceVertex(i, 2)))/3.0;
+        param.springPosX[i] = position[0];
+        param.springPosY[i] = position[1];
+        param.springPosZ[i] = position[2];
         param.springArea[i] = mesh.getFaceArea(i);
     }
     subsystem.invalidateSubsystemTopologyCache();
@@ -95,29 +104,26 @@ void ElasticFoundationForceImpl::calcForce
                 (subsystem.updCacheEntry(state, energyCacheIndex));
     pe = 0.0;
     for (int i = 0; i < (int) contacts.size(); i++) {
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter1 = 
-            parameters.find(contacts[i].getSurface1());
-        std::map<ContactSurfaceIndex, Parameters>::const_iterator iter2 = 
-            parameters.find(contacts[i].getSurface2());
+        const Parameters* param1 = findParameters(contacts[i].getSurface1());
+        const Parameters* param2 = findParameters(contacts[i].getSurface2());
 
         // If there are two meshes, scale each one's contributions by 50%.
-        Real areaScale = (iter1==parameters.end() || iter2==parameters.end())
-                         ? Real(1) : Real(0.5);
+        Real areaScale = (param1==0 || param2==0) ? Real(1) : Real(0.5);
 
-        if (iter1 != parameters.end()) {
+        if (param1) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface1(), 
-                contact.getSurface2(), iter1->second, 
-                contact.getSurface1Faces(), areaScale, bodyForces, pe);
+                contact.getSurface2(), *param1, 
+                contact.getSurface1FaceIndices(), areaScale, bodyForces, pe);
         }
 
-        if (iter2 != parameters.end()) {
+        if (param2) {
             const TriangleMeshContact& contact = 
                 static_cast<const TriangleMeshContact&>(contacts[i]);
             processContact(state, contact.getSurface2(), 
-                contact.getSurface1(), iter2->second, 
-                contact.getSurface2Faces(), areaScale, bodyForces, pe);
+                contact.getSurface1(), *param2, 
+                contact.getSurface2FaceIndices(), areaScale, bodyForces, pe);
         }
     }
 }
@@ -125,7 +131,7 @@ void ElasticFoundationForceImpl::calcForce
 void ElasticFoundationForceImpl::processContact
    (const State& state, 
     ContactSurfaceIndex meshIndex, ContactSurfaceIndex otherBodyIndex, 
-    const Parameters& param, const std::set<int>& insideFaces,
+    const Parameters& param, const Array_<int>& insideFaces,
     Real areaScale, Vector_<SpatialVec>& bodyForces, Real& pe) const 
 {
     const ContactGeometry& otherObject = subsystem.getBodyGeometry(set, otherBodyIndex);
@@ -135,56 +141,68 @@ void ElasticFoundationForceImpl::processContact
     const Transform t2g = body2.getBodyTransform(state)*subsystem.getBodyTransform(set, otherBodyIndex); // other object to ground
     const Transform t12 = ~t2g*t1g; // mesh to other object
 
-    // Loop over all the springs, and evaluate the force from each one.
-
-    for (std::set<int>::const_iterator iter = insideFaces.begin(); 
-                                       iter != insideFaces.end(); ++iter) {
-        int face = *iter;
-        UnitVec3 normal;
-        bool inside;
-        Vec3 nearestPoint = otherObject.findNearestPoint(t12*param.springPosition[face], inside, normal);
-        if (!inside)
-            continue;
-        
-        // Find how much the spring is displaced.
-        
-        nearestPoint = t2g*nearestPoint;
-        const Vec3 springPosInGround = t1g*param.springPosition[face];
-        const Vec3 displacement = nearestPoint-springPosInGround;
-        const Real distance = displacement.norm();
-        if (distance == 0.0)
-            continue;
-        const Vec3 forceDir = displacement/distance;
-        
-        // Calculate the relative velocity of the two bodies at the contact point.
-        
-        const Vec3 station1 = body1.findStationAtGroundPoint(state, nearestPoint);
-        const Vec3 station2 = body2.findStationAtGroundPoint(state, nearestPoint);
-        const Vec3 v1 = body1.findStationVelocityInGround(state, station1);
-        const Vec3 v2 = body2.findStationVelocityInGround(state, station2);
-        const Vec3 v = v2-v1;
-        const Real vnormal = dot(v, forceDir);
-        const Vec3 vtangent = v-vnormal*forceDir;
-        
-        // Calculate the damping force.
-        
-        const Real area = areaScale * param.springArea[face];
-        const Real f = param.stiffness*area*distance*(1+param.dissipation*vnormal);
-        Vec3 force = (f > 0 ? f*forceDir : Vec3(0));
-        
-        // Calculate the friction force.
-        
-        const Real vslip = vtangent.norm();
-        if (f > 0 && vslip != 0) {
-            const Real vrel = vslip/transitionVelocity;
-            const Real ffriction = f*(std::min(vrel, 1.0)*(param.dynamicFriction+2*(param.staticFriction-param.dynamicFriction)/(1+vrel*vrel))+param.viscousFriction*vslip);
-            force += ffriction*vtangent/vslip;
+    // The body origin locations and spatial velocities in ground give the
+    // velocity of each body at a contact point.
+    SpringConstants c;
+    c.stiffness          = param.stiffness;
+    c.dissipation        = param.dissipation;
+    c.staticFriction     = param.staticFriction;
+    c.dynamicFriction    = param.dynamicFriction;
+    c.viscousFriction    = param.viscousFriction;
+    c.transitionVelocity = transitionVelocity;
+    c.o1 = body1.getBodyOriginLocation(state);
+    c.o2 = body2.getBodyOriginLocation(state);
+    const SpatialVec& V1 = body1.getBodyVelocity(state);
+    const SpatialVec& V2 = body2.getBodyVelocity(state);
+    c.w1 = V1[0]; c.v1 = V1[1];
+    c.w2 = V2[0]; c.v2 = V2[1];
+
+    // The force on body1 from all the springs, accumulated as a force and a
+    // moment about body1's origin (in ground). Body2 gets the equal and 
+    // opposite force at the same points.
+    SpringSums sums;
+
+    Vec3     positionInOther[SpringBlockSize], nearest[SpringBlockSize];
+    bool     inside[SpringBlockSize];
+    UnitVec3 normal[SpringBlockSize];
+    SpringBlock block;
+
+    const int nSprings = (int)insideFaces.size();
+    for (int first = 0; first < nSprings; first += SpringBlockSize) {
+        const int n = std::min(SpringBlockSize, nSprings-first);
+        for (int k = 0; k < n; ++k) {
+            const int  face = insideFaces[first+k];
+            const Vec3 position(param.springPosX[face], param.springPosY[face],
+                                param.springPosZ[face]);
+            positionInOther[k] = t12*position;
+            const Vec3 springPosInGround = t1g*position;
+            block.sx[k] = springPosInGround[0];
+            block.sy[k] = springPosInGround[1];
+            block.sz[k] = springPosInGround[2];
+        }
+        otherObject.findNearestPoints(n, positionInOther, nearest, inside, normal);
+        for (int k = 0; k < n; ++k) {
+            const Vec3 nearestPoint = t2g*nearest[k];
+            block.px[k] = nearestPoint[0];
+            block.py[k] = nearestPoint[1];
+            block.pz[k] = nearestPoint[2];
+            block.area[k] = inside[k] 
+                ? areaScale*param.springArea[insideFaces[first+k]] : Real(0);
         }
 
-        body1.applyForceToBodyPoint(state, station1, force, bodyForces);
-        body2.applyForceToBodyPoint(state, station2, -force, bodyForces);
-        pe += 0.5*param.stiffness*area*displacement.normSqr();
+        // Evaluate the force from each spring in the block.
+        #ifdef SimTK_ELASTIC_FOUNDATION_SSE2
+        addSpringForcesSSE2(c, block, n, sums);
+        #else
+        addSpringForces(c, block, 0, n, sums);
+        #endif
     }
+
+    // Shift the moment to body2's origin for the reaction force.
+    const Vec3 totalMoment2 = sums.moment + (c.o1-c.o2) % sums.force;
+    body1.applyBodyForce(state, SpatialVec(sums.moment, sums.force), bodyForces);
+    body2.applyBodyForce(state, SpatialVec(-totalMoment2, -sums.force), bodyForces);
+    pe += sums.pe;
 }
 
 Real ElasticFoundationForceImpl::calcPotentialEnergy(const State& state) const {
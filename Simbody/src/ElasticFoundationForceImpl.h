@@ -49,14 +49,19 @@ public:
     void processContact(const State& state, ContactSurfaceIndex meshIndex, 
                         ContactSurfaceIndex otherBodyIndex, 
                         const Parameters& param, 
-                        const std::set<int>& insideFaces,
+                        const Array_<int>& insideFaces,
                         Real areaScale,
                         Vector_<SpatialVec>& bodyForces, Real& pe) const;
 private:
     friend class ElasticFoundationForce;
+    // Return the Parameters for this surface, or null if it has none.
+    const Parameters* findParameters(ContactSurfaceIndex surf) const;
     const GeneralContactSubsystem& subsystem;
     const ContactSetIndex set;
-    std::map<ContactSurfaceIndex, Parameters> parameters;
+    // Indexed directly by surface; hasParameters tells which entries have
+    // been set.
+    Array_<Parameters,ContactSurfaceIndex> parameters;
+    Array_<bool,ContactSurfaceIndex>       hasParameters;
     Real transitionVelocity;
     mutable CacheEntryIndex energyCacheIndex;
 };
@@ -69,11 +74,19 @@ public:
             stiffness(stiffness), dissipation(dissipation), staticFriction(staticFriction), dynamicFriction(dynamicFriction), viscousFriction(viscousFriction) {
     }
     Real stiffness, dissipation, staticFriction, dynamicFriction, viscousFriction;
-    Array_<Vec3> springPosition;
-    Array_<UnitVec3> springNormal;
+    // One spring per face of the mesh, indexed by face. processContact() 
+    // gathers the springs that are inside the other object, in ground, into
+    // a SpringBlock; that is what the force kernel loads into SIMD lanes.
+    Array_<Real> springPosX, springPosY, springPosZ;
     Array_<Real> springArea;
 };
 
+inline const ElasticFoundationForceImpl::Parameters* 
+ElasticFoundationForceImpl::findParameters(ContactSurfaceIndex surf) const {
+    return surf < (int)parameters.size() && hasParameters[surf] 
+           ? &parameters[surf] : 0;
+}
+
 } // namespace SimTK
 
 #endif // SimTK_SIMBODY_HUNT_CROSSLEY_FORCE_IMPL_H_
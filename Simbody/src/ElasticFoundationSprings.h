@@ -0,0 +1,262 @@
+#ifndef SimTK_SIMBODY_ELASTIC_FOUNDATION_SPRINGS_H_
+#define SimTK_SIMBODY_ELASTIC_FOUNDATION_SPRINGS_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* The elastic foundation spring kernels shared by ElasticFoundationForce and
+CompliantContactSubsystem's ElasticFoundation contact force generator. The 
+springs of a mesh are evaluated in blocks held in structure-of-arrays form, 
+so that the arithmetic can be done two springs at a time with SSE2 where it
+is available. The force model here is ElasticFoundationForce's; the contact 
+force generator has its own, built on the same SpringBlock and SSE2 helpers. */
+
+#include "SimTKcommon.h"
+
+#include <algorithm>
+
+namespace SimTK {
+
+// Springs are processed in blocks of this many. All the springs in a block 
+// get their nearest points found with a single call.
+static const int SpringBlockSize = 64;
+
+// Use the SSE2 spring kernel on any target where the compiler provides SSE2.
+#if (SimTK_DEFAULT_PRECISION == 2) && (defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SimTK_ELASTIC_FOUNDATION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ElasticFoundationSprings {
+
+// Everything the force kernel needs to know that is the same for all springs
+// in a contact: the material, and the origin location and spatial velocity 
+// in ground of both bodies.
+struct SpringConstants {
+    Real stiffness, dissipation, staticFriction, dynamicFriction, 
+         viscousFriction, transitionVelocity;
+    Vec3 o1, o2;        // body origins
+    Vec3 w1, v1, w2, v2;// body angular and linear velocities
+};
+
+// A block of springs, in ground: the spring locations (s) and the nearest
+// points to them on the other object (p). A spring that is not inside the
+// other object has zero area so that it contributes nothing.
+struct SpringBlock {
+    Real sx[SpringBlockSize], sy[SpringBlockSize], sz[SpringBlockSize];
+    Real px[SpringBlockSize], py[SpringBlockSize], pz[SpringBlockSize];
+    Real area[SpringBlockSize];
+};
+
+// The force on body1 from a set of springs, as a force and a moment about 
+// body1's origin, and the potential energy stored in the springs.
+struct SpringSums {
+    SpringSums() : force(0), moment(0), pe(0) {}
+    Vec3 force, moment;
+    Real pe;
+};
+
+// Add the contributions of springs [begin,end) of a block, one at a time.
+inline void addSpringForces(const SpringConstants& c, const SpringBlock& b, 
+                            int begin, int end, SpringSums& sums) {
+    for (int k = begin; k < end; ++k) {
+        if (b.area[k] == 0)
+            continue;
+
+        // Find how much the spring is displaced.
+
+        const Vec3 nearestPoint(b.px[k], b.py[k], b.pz[k]);
+        const Vec3 displacement = 
+            nearestPoint - Vec3(b.sx[k], b.sy[k], b.sz[k]);
+        const Real distance = displacement.norm();
+        if (distance == 0.0)
+            continue;
+        const Vec3 forceDir = displacement/distance;
+
+        // Calculate the relative velocity of the two bodies at the contact point.
+
+        const Vec3 r1 = nearestPoint - c.o1;
+        const Vec3 v1 = c.v1 + c.w1 % r1;
+        const Vec3 v2 = c.v2 + c.w2 % (nearestPoint - c.o2);
+        const Vec3 v = v2-v1;
+        const Real vnormal = dot(v, forceDir);
+        const Vec3 vtangent = v-vnormal*forceDir;
+
+        // Calculate the damping force.
+
+        const Real f = c.stiffness*b.area[k]*distance*(1+c.dissipation*vnormal);
+        Vec3 force = (f > 0 ? f*forceDir : Vec3(0));
+
+        // Calculate the friction force.
+
+        const Real vslip = vtangent.norm();
+        if (f > 0 && vslip != 0) {
+            const Real vrel = vslip/c.transitionVelocity;
+            const Real ffriction = f*(std::min(vrel, Real(1))*(c.dynamicFriction+2*(c.staticFriction-c.dynamicFriction)/(1+vrel*vrel))+c.viscousFriction*vslip);
+            force += ffriction*vtangent/vslip;
+        }
+
+        sums.force  += force;
+        sums.moment += r1 % force;
+        sums.pe     += 0.5*c.stiffness*b.area[k]*displacement.normSqr();
+    }
+}
+
+#ifdef SimTK_ELASTIC_FOUNDATION_SSE2
+// Select a where mask is set and b elsewhere.
+inline __m128d select(__m128d mask, __m128d a, __m128d b)
+{   return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+
+inline __m128d dot(__m128d ax, __m128d ay, __m128d az, 
+                   __m128d bx, __m128d by, __m128d bz) {
+    return _mm_add_pd(_mm_add_pd(_mm_mul_pd(ax,bx), _mm_mul_pd(ay,by)),
+                      _mm_mul_pd(az,bz));
+}
+
+// c = a X b, where a is the same for both lanes.
+inline void cross(const Vec3& a, __m128d bx, __m128d by, __m128d bz,
+                  __m128d& cx, __m128d& cy, __m128d& cz) {
+    const __m128d ax = _mm_set1_pd(a[0]), ay = _mm_set1_pd(a[1]), 
+                  az = _mm_set1_pd(a[2]);
+    cx = _mm_sub_pd(_mm_mul_pd(ay,bz), _mm_mul_pd(az,by));
+    cy = _mm_sub_pd(_mm_mul_pd(az,bx), _mm_mul_pd(ax,bz));
+    cz = _mm_sub_pd(_mm_mul_pd(ax,by), _mm_mul_pd(ay,bx));
+}
+
+// c = a X b, lane by lane.
+inline void cross(__m128d ax, __m128d ay, __m128d az, 
+                  __m128d bx, __m128d by, __m128d bz,
+                  __m128d& cx, __m128d& cy, __m128d& cz) {
+    cx = _mm_sub_pd(_mm_mul_pd(ay,bz), _mm_mul_pd(az,by));
+    cy = _mm_sub_pd(_mm_mul_pd(az,bx), _mm_mul_pd(ax,bz));
+    cz = _mm_sub_pd(_mm_mul_pd(ax,by), _mm_mul_pd(ay,bx));
+}
+
+inline Real sumLanes(__m128d a)
+{   return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a))); }
+
+// The same calculation as the scalar addSpringForces(), two springs at a 
+// time. Branches become masks: a spring that is not inside, has zero 
+// displacement, or would pull rather than push gets zero force, and one with
+// no slip gets no friction.
+inline void addSpringForcesSSE2(const SpringConstants& c, const SpringBlock& b, 
+                                int n, SpringSums& sums) {
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+    const __m128d stiffness   = _mm_set1_pd(c.stiffness);
+    const __m128d dissipation = _mm_set1_pd(c.dissipation);
+    const __m128d us = _mm_set1_pd(c.staticFriction);
+    const __m128d ud = _mm_set1_pd(c.dynamicFriction);
+    const __m128d uv = _mm_set1_pd(c.viscousFriction);
+    const __m128d vt = _mm_set1_pd(c.transitionVelocity);
+    __m128d fx = zero, fy = zero, fz = zero;
+    __m128d mx = zero, my = zero, mz = zero, pe = zero;
+
+    int k = 0;
+    for (; k+2 <= n; k += 2) {
+        const __m128d area = _mm_loadu_pd(&b.area[k]);
+        const __m128d px = _mm_loadu_pd(&b.px[k]), py = _mm_loadu_pd(&b.py[k]),
+                      pz = _mm_loadu_pd(&b.pz[k]);
+
+        // Displacement and its length.
+        const __m128d dx = _mm_sub_pd(px, _mm_loadu_pd(&b.sx[k]));
+        const __m128d dy = _mm_sub_pd(py, _mm_loadu_pd(&b.sy[k]));
+        const __m128d dz = _mm_sub_pd(pz, _mm_loadu_pd(&b.sz[k]));
+        const __m128d dist2 = dot(dx,dy,dz, dx,dy,dz);
+        const __m128d dist  = _mm_sqrt_pd(dist2);
+        const __m128d valid = _mm_and_pd(_mm_cmpneq_pd(area, zero),
+                                         _mm_cmpneq_pd(dist, zero));
+        if (_mm_movemask_pd(valid) == 0)
+            continue;
+        const __m128d ooDist = _mm_div_pd(one, select(valid, dist, one));
+        const __m128d ux = _mm_mul_pd(dx, ooDist), uy = _mm_mul_pd(dy, ooDist),
+                      uz = _mm_mul_pd(dz, ooDist);
+
+        // Relative velocity at the contact point.
+        const __m128d r1x = _mm_sub_pd(px, _mm_set1_pd(c.o1[0]));
+        const __m128d r1y = _mm_sub_pd(py, _mm_set1_pd(c.o1[1]));
+        const __m128d r1z = _mm_sub_pd(pz, _mm_set1_pd(c.o1[2]));
+        __m128d w1x, w1y, w1z, w2x, w2y, w2z;
+        cross(c.w1, r1x, r1y, r1z, w1x, w1y, w1z);
+        cross(c.w2, _mm_sub_pd(px, _mm_set1_pd(c.o2[0])),
+                    _mm_sub_pd(py, _mm_set1_pd(c.o2[1])),
+                    _mm_sub_pd(pz, _mm_set1_pd(c.o2[2])), w2x, w2y, w2z);
+        const __m128d vx = _mm_add_pd(_mm_set1_pd(c.v2[0]-c.v1[0]), 
+                                      _mm_sub_pd(w2x, w1x));
+        const __m128d vy = _mm_add_pd(_mm_set1_pd(c.v2[1]-c.v1[1]), 
+                                      _mm_sub_pd(w2y, w1y));
+        const __m128d vz = _mm_add_pd(_mm_set1_pd(c.v2[2]-c.v1[2]), 
+                                      _mm_sub_pd(w2z, w1z));
+        const __m128d vnormal = dot(vx,vy,vz, ux,uy,uz);
+        const __m128d tx = _mm_sub_pd(vx, _mm_mul_pd(vnormal, ux));
+        const __m128d ty = _mm_sub_pd(vy, _mm_mul_pd(vnormal, uy));
+        const __m128d tz = _mm_sub_pd(vz, _mm_mul_pd(vnormal, uz));
+
+        // Normal (elastic and damping) force.
+        const __m128d kA = _mm_mul_pd(stiffness, area);
+        const __m128d f = _mm_mul_pd(_mm_mul_pd(kA, dist), 
+            _mm_add_pd(one, _mm_mul_pd(dissipation, vnormal)));
+        const __m128d push = _mm_and_pd(valid, _mm_cmpgt_pd(f, zero));
+        const __m128d fn = _mm_and_pd(push, f);
+        __m128d Fx = _mm_mul_pd(fn, ux), Fy = _mm_mul_pd(fn, uy), 
+                Fz = _mm_mul_pd(fn, uz);
+
+        // Friction force.
+        const __m128d vslip = _mm_sqrt_pd(dot(tx,ty,tz, tx,ty,tz));
+        const __m128d slip = _mm_and_pd(push, _mm_cmpneq_pd(vslip, zero));
+        if (_mm_movemask_pd(slip)) {
+            const __m128d vrel = _mm_div_pd(vslip, vt);
+            const __m128d stribeck = _mm_add_pd(ud, _mm_div_pd(
+                _mm_mul_pd(_mm_set1_pd(2), _mm_sub_pd(us, ud)),
+                _mm_add_pd(one, _mm_mul_pd(vrel, vrel))));
+            const __m128d ffriction = _mm_mul_pd(f, _mm_add_pd(
+                _mm_mul_pd(_mm_min_pd(vrel, one), stribeck),
+                _mm_mul_pd(uv, vslip)));
+            const __m128d scale = _mm_and_pd(slip, 
+                _mm_div_pd(ffriction, select(slip, vslip, one)));
+            Fx = _mm_add_pd(Fx, _mm_mul_pd(scale, tx));
+            Fy = _mm_add_pd(Fy, _mm_mul_pd(scale, ty));
+            Fz = _mm_add_pd(Fz, _mm_mul_pd(scale, tz));
+        }
+
+        // Accumulate force, moment r1 X F, and energy.
+        fx = _mm_add_pd(fx, Fx); fy = _mm_add_pd(fy, Fy); 
+        fz = _mm_add_pd(fz, Fz);
+        mx = _mm_add_pd(mx, _mm_sub_pd(_mm_mul_pd(r1y,Fz), _mm_mul_pd(r1z,Fy)));
+        my = _mm_add_pd(my, _mm_sub_pd(_mm_mul_pd(r1z,Fx), _mm_mul_pd(r1x,Fz)));
+        mz = _mm_add_pd(mz, _mm_sub_pd(_mm_mul_pd(r1x,Fy), _mm_mul_pd(r1y,Fx)));
+        pe = _mm_add_pd(pe, _mm_and_pd(valid, 
+                 _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(0.5), kA), dist2)));
+    }
+
+    sums.force  += Vec3(sumLanes(fx), sumLanes(fy), sumLanes(fz));
+    sums.moment += Vec3(sumLanes(mx), sumLanes(my), sumLanes(mz));
+    sums.pe     += sumLanes(pe);
+    addSpringForces(c, b, k, n, sums); // odd one out
+}
+#endif
+
+} // namespace ElasticFoundationSprings
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_ELASTIC_FOUNDATION_SPRINGS_H_
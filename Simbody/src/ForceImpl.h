@@ -48,6 +48,21 @@ public:
     virtual bool dependsOnlyOnPositions() const {
         return false;
     }
+    // Return false if calcForce() must not be called concurrently with the
+    // calcForce() methods of other force elements; see 
+    // GeneralForceSubsystem::setUseParallelForceEvaluation(). Built-in force
+    // elements write only into their own cache entries and are safe.
+    virtual bool shouldBeParallelized() const {
+        return true;
+    }
+    // Return false if calcForce() and calcPotentialEnergy() can't be called
+    // for a State realized only through Velocity stage, that is, before this
+    // force's realizeDynamics() has been called; see 
+    // MultibodySystem::calcPotentialEnergyAndForces(). Built-in force 
+    // elements that do nothing at Dynamics stage are fine.
+    virtual bool canCalcForceAtVelocityStage() const {
+        return true;
+    }
     ForceIndex getForceIndex() const {return index;}
     const GeneralForceSubsystem& getForceSubsystem() const 
     {   assert(forces); return *forces; }
@@ -335,6 +350,14 @@ public:
     bool dependsOnlyOnPositions() const {
         return implementation->dependsOnlyOnPositions();
     }
+    bool shouldBeParallelized() const {
+        return implementation->shouldBeParallelized();
+    }
+    // We can't tell what the implementation expects to have been realized
+    // or cached by the time it is asked for its force.
+    bool canCalcForceAtVelocityStage() const {
+        return false;
+    }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const;
     Real calcPotentialEnergy(const State& state) const;
     ~CustomImpl() {
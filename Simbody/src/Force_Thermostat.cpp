@@ -48,6 +48,9 @@ public:
 
     ThermostatImpl* clone() const {return new ThermostatImpl(*this);}
     bool dependsOnlyOnPositions() const {return false;}
+    // The chain derivatives are set in realizeDynamics(), so stay with the
+    // normal Dynamics-stage evaluation.
+    bool canCalcForceAtVelocityStage() const {return false;}
 
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const;
@@ -37,21 +37,126 @@
 
 #include "ForceImpl.h"
 
+#include <pthread.h>
+#include <algorithm>
+#include <string>
 
 namespace SimTK {
 
+//==============================================================================
+//                       PARALLEL FORCE EVALUATION
+//==============================================================================
+// When parallel force evaluation is on, the force elements to be evaluated are
+// divided into a fixed number of contiguous blocks (by force index). Each
+// block has its own set of force accumulators so the blocks can be done 
+// concurrently without any locking. Afterwards the block accumulators are 
+// added into the real force arrays in block order. The blocks depend only on
+// the number of forces and threads, not on which thread happens to execute 
+// them, so the results are the same every time.
+
+namespace {
+
+// Private force arrays for one block of force elements. There is one set for
+// the velocity-dependent forces and one for the position-only forces, since 
+// those are cached separately.
+struct ForceAccumulators {
+    Vector_<SpatialVec> rigidBodyForces,    rigidBodyForceCache;
+    Vector_<Vec3>       particleForces,     particleForceCache;
+    Vector              mobilityForces,     mobilityForceCache;
+};
+
+// This is the per-State workspace used for parallel force evaluation. It is
+// kept in a cache entry so that it is reused from one evaluation to the next,
+// and so that different States can be realized concurrently.
+struct ParallelForceWorkspace {
+    Array_<const Force*>        forceList;  // forces to be done in parallel
+    Array_<ForceAccumulators>   blocks;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const ForceAccumulators&)
+{   return o << "ForceAccumulators"; }
+inline std::ostream& operator<<(std::ostream& o, const ParallelForceWorkspace& w)
+{   return o << "ParallelForceWorkspace with " << w.blocks.size() << " blocks"; }
+
+// This is the task executed by the thread pool; each index is a block. Only 
+// the position-only forces are evaluated if the position cache is already 
+// valid.
+class ParallelForceTask : public GuardedParallelTask {
+public:
+    ParallelForceTask(const State& state, ParallelForceWorkspace& ws, 
+                      bool forceValid, const Profiler& profiler) 
+    :   state(state), ws(ws), forceValid(forceValid), profiler(profiler) {}
+
+    void executeGuarded(int block) {
+        const int nForces = (int)ws.forceList.size();
+        const int nBlocks = (int)ws.blocks.size();
+        const int first = getBlockStart(nForces, block, nBlocks);
+        const int last  = getBlockStart(nForces, block+1, nBlocks);
+        ForceAccumulators& acc = ws.blocks[block];
+        acc.rigidBodyForces = SpatialVec(Vec3(0), Vec3(0));
+        acc.particleForces  = Vec3(0);
+        acc.mobilityForces  = 0;
+        if (!forceValid) {
+            acc.rigidBodyForceCache = SpatialVec(Vec3(0), Vec3(0));
+            acc.particleForceCache  = Vec3(0);
+            acc.mobilityForceCache  = 0;
+        }
+        for (int i=first; i < last; ++i) {
+            const ForceImpl& f = ws.forceList[i]->getImpl();
+            const Profiler::Sample sample(profiler, "Force", 
+                                          f.getForceIndex(), Stage::Dynamics);
+            if (!f.dependsOnlyOnPositions())
+                f.calcForce(state, acc.rigidBodyForces, 
+                            acc.particleForces, acc.mobilityForces);
+            else // only on the list if the cache isn't valid
+                f.calcForce(state, acc.rigidBodyForceCache, 
+                            acc.particleForceCache, acc.mobilityForceCache);
+        }
+    }
+private:
+    const State&            state;
+    ParallelForceWorkspace& ws;
+    const bool              forceValid;
+    const Profiler&         profiler;
+};
+
+}
+
 
 class GeneralForceSubsystemRep : public ForceSubsystemRep {
 public:
     GeneralForceSubsystemRep()
-     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1")
+     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1"),
+       useParallelForceEvaluation(false), 
+       parallelForceThreshold(DefaultParallelForceThreshold),
+       numParallelForceThreads(0), forceExecutor(0)
+    {
+        pthread_mutex_init(&forceExecutorLock, NULL);
+    }
+
+    // The thread pool and its lock belong to this object and are not copied;
+    // the copy will create its own pool if it needs one.
+    GeneralForceSubsystemRep(const GeneralForceSubsystemRep& src)
+     : ForceSubsystemRep(src), forces(src.forces),
+       forceValidCacheIndex(src.forceValidCacheIndex),
+       rigidBodyForceCacheIndex(src.rigidBodyForceCacheIndex),
+       mobilityForceCacheIndex(src.mobilityForceCacheIndex),
+       particleForceCacheIndex(src.particleForceCacheIndex),
+       parallelWorkspaceCacheIndex(src.parallelWorkspaceCacheIndex),
+       forceEnabledIndex(src.forceEnabledIndex),
+       useParallelForceEvaluation(src.useParallelForceEvaluation),
+       parallelForceThreshold(src.parallelForceThreshold),
+       numParallelForceThreads(src.numParallelForceThreads), forceExecutor(0)
     {
+        pthread_mutex_init(&forceExecutorLock, NULL);
     }
     
     ~GeneralForceSubsystemRep() {
         // Delete in reverse order to be nice to heap system.
         for (int i = (int)forces.size()-1; i >= 0; --i)
             delete forces[i]; 
+        delete forceExecutor;
+        pthread_mutex_destroy(&forceExecutorLock);
     }
     
     ForceIndex adoptForce(Force& force) {
@@ -93,6 +198,36 @@ public:
         forceValid = false;
     }
 
+    void setUseParallelForceEvaluation(bool useParallel) 
+    {   useParallelForceEvaluation = useParallel; }
+    bool getUseParallelForceEvaluation() const 
+    {   return useParallelForceEvaluation; }
+
+    void setParallelForceThreshold(int minForces) {
+        SimTK_APIARGCHECK1_ALWAYS(minForces >= 1, "GeneralForceSubsystem",
+            "setParallelForceThreshold", 
+            "The threshold must be at least 1 but was %d.", minForces);
+        parallelForceThreshold = minForces;
+    }
+    int getParallelForceThreshold() const 
+    {   return parallelForceThreshold; }
+
+    void setNumParallelForceThreads(int numThreads) {
+        SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "GeneralForceSubsystem",
+            "setNumParallelForceThreads", 
+            "The number of threads can't be negative but was %d.", numThreads);
+        pthread_mutex_lock(&forceExecutorLock);
+        numParallelForceThreads = numThreads;
+        // The pool will be recreated with the new size on next use.
+        delete forceExecutor;
+        forceExecutor = 0;
+        pthread_mutex_unlock(&forceExecutorLock);
+    }
+    int getNumParallelForceThreads() const {
+        return numParallelForceThreads > 0 ? numParallelForceThreads
+                                           : ParallelExecutor::getNumProcessors();
+    }
+
     
     // These override default implementations of virtual methods in the Subsystem::Guts
     // class.
@@ -109,6 +244,8 @@ public:
             new Value<Vector>());
         particleForceCacheIndex = allocateCacheEntry(s, Stage::Dynamics, 
             new Value<Vector_<Vec3> >());
+        parallelWorkspaceCacheIndex = allocateCacheEntry(s, Stage::Dynamics, 
+            new Value<ParallelForceWorkspace>());
 
         // Some forces are disabled by default; initialize the enabled flags
         // accordingly.
@@ -206,13 +343,25 @@ public:
         Vector_<SpatialVec>&   rigidBodyForces = mbs.updRigidBodyForces(s, Stage::Dynamics);
         Vector_<Vec3>&         particleForces  = mbs.updParticleForces (s, Stage::Dynamics);
         Vector&                mobilityForces  = mbs.updMobilityForces (s, Stage::Dynamics);
-        for (int i = 0; i < (int) forces.size(); ++i) {
-            if (forceEnabled[i]) {
-                const Force& f = *forces[i];
-                if (!f.getImpl().dependsOnlyOnPositions())
-                    f.getImpl().calcForce(s, rigidBodyForces, particleForces, mobilityForces);
-                else if (!forceValid)
-                    f.getImpl().calcForce(s, rigidBodyForceCache, particleForceCache, mobilityForceCache);
+        if (!useParallelForceEvaluation
+            || !calcForcesInParallel(s, forceEnabled, forceValid,
+                                     rigidBodyForces, particleForces, mobilityForces,
+                                     rigidBodyForceCache, particleForceCache, 
+                                     mobilityForceCache))
+        {
+            for (int i = 0; i < (int) forces.size(); ++i) {
+                if (forceEnabled[i]) {
+                    const Force& f = *forces[i];
+                    if (!f.getImpl().dependsOnlyOnPositions()) {
+                        const Profiler::Sample sample(getSystem().getProfiler(),
+                            "Force", i, Stage::Dynamics);
+                        f.getImpl().calcForce(s, rigidBodyForces, particleForces, mobilityForces);
+                    } else if (!forceValid) {
+                        const Profiler::Sample sample(getSystem().getProfiler(),
+                            "Force", i, Stage::Dynamics);
+                        f.getImpl().calcForce(s, rigidBodyForceCache, particleForceCache, mobilityForceCache);
+                    }
+                }
             }
         }
 
@@ -243,6 +392,33 @@ public:
         return energy;
     }
 
+    // Force elements calculate their forces from a State realized through
+    // Velocity stage, except for those that use the contacts found by a
+    // GeneralContactSubsystem, which does that at Dynamics stage, and those
+    // that need their own realizeDynamics() first, including every
+    // Force::Custom. If any enabled force is of that kind we don't evaluate
+    // any of them.
+    bool calcPotentialEnergyAndForces
+       (const State& s, Real& pe, Vector_<SpatialVec>& rigidBodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
+        if (getMultibodySystem().hasContactSubsystem())
+            return false;
+        const Array_<bool>& forceEnabled = Value<Array_<bool> >::downcast
+           (getDiscreteVariable(s, forceEnabledIndex)).get();
+        for (int i = 0; i < (int) forces.size(); ++i)
+            if (forceEnabled[i] 
+                && !forces[i]->getImpl().canCalcForceAtVelocityStage())
+                return false;
+        for (int i = 0; i < (int) forces.size(); ++i) {
+            if (forceEnabled[i]) {
+                const ForceImpl& f = forces[i]->getImpl();
+                f.calcForce(s, rigidBodyForces, particleForces, mobilityForces);
+                pe += f.calcPotentialEnergy(s);
+            }
+        }
+        return true;
+    }
+
     int realizeSubsystemAccelerationImpl(const State& s) const {
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
@@ -260,6 +436,96 @@ public:
     }
 
 private:
+    // Evaluate the enabled forces using the thread pool, as described at the
+    // top of this file. Forces that opt out of parallel evaluation are done 
+    // afterwards on this thread, in order. Returns false without doing 
+    // anything if there aren't enough forces to make it worthwhile or if the
+    // pool is not available, in which case the caller should do the forces
+    // serially.
+    bool calcForcesInParallel(const State& s, const Array_<bool>& forceEnabled,
+                              bool forceValid,
+                              Vector_<SpatialVec>& rigidBodyForces,
+                              Vector_<Vec3>&       particleForces,
+                              Vector&              mobilityForces,
+                              Vector_<SpatialVec>& rigidBodyForceCache,
+                              Vector_<Vec3>&       particleForceCache,
+                              Vector&              mobilityForceCache) const
+    {
+        ParallelForceWorkspace& ws = Value<ParallelForceWorkspace>::updDowncast
+            (updCacheEntry(s, parallelWorkspaceCacheIndex));
+
+        ws.forceList.clear();
+        for (int i = 0; i < (int) forces.size(); ++i) {
+            if (!forceEnabled[i]) continue;
+            const ForceImpl& f = forces[i]->getImpl();
+            if (f.shouldBeParallelized() 
+                && (!forceValid || !f.dependsOnlyOnPositions()))
+                ws.forceList.push_back(forces[i]);
+        }
+
+        const int nForces = (int)ws.forceList.size();
+        if (nForces < parallelForceThreshold || nForces < 2
+            || ParallelExecutor::isWorkerThread()
+            || pthread_mutex_trylock(&forceExecutorLock) != 0)
+            return false;
+
+        // A few blocks per thread lets the pool even out forces of 
+        // different cost.
+        const int nThreads = getNumParallelForceThreads();
+        const int nBlocks = std::min(nForces, 4*nThreads);
+        ws.blocks.resize(nBlocks);
+        for (int b=0; b < nBlocks; ++b) {
+            ForceAccumulators& acc = ws.blocks[b];
+            acc.rigidBodyForces.resize(rigidBodyForces.size());
+            acc.particleForces.resize(particleForces.size());
+            acc.mobilityForces.resize(mobilityForces.size());
+            acc.rigidBodyForceCache.resize(rigidBodyForceCache.size());
+            acc.particleForceCache.resize(particleForceCache.size());
+            acc.mobilityForceCache.resize(mobilityForceCache.size());
+        }
+
+        if (!forceExecutor)
+            forceExecutor = new WorkStealingExecutor(nThreads);
+        ParallelForceTask task(s, ws, forceValid, getSystem().getProfiler());
+        forceExecutor->execute(task, nBlocks);
+        pthread_mutex_unlock(&forceExecutorLock);
+
+        SimTK_ERRCHK1_ALWAYS(!task.hasFailed(), 
+            "GeneralForceSubsystem::realizeDynamics()",
+            "A parallel force evaluation failed: %s", 
+            task.getErrorMessage().c_str());
+
+        // Reduce in block order.
+        for (int b=0; b < nBlocks; ++b) {
+            const ForceAccumulators& acc = ws.blocks[b];
+            rigidBodyForces += acc.rigidBodyForces;
+            particleForces  += acc.particleForces;
+            mobilityForces  += acc.mobilityForces;
+            if (!forceValid) {
+                rigidBodyForceCache += acc.rigidBodyForceCache;
+                particleForceCache  += acc.particleForceCache;
+                mobilityForceCache  += acc.mobilityForceCache;
+            }
+        }
+
+        // Now the ones that must be done on this thread.
+        for (int i = 0; i < (int) forces.size(); ++i) {
+            if (!forceEnabled[i]) continue;
+            const ForceImpl& f = forces[i]->getImpl();
+            if (f.shouldBeParallelized()) continue;
+            if (forceValid && f.dependsOnlyOnPositions()) continue;
+            const Profiler::Sample sample(getSystem().getProfiler(), "Force",
+                                          i, Stage::Dynamics);
+            if (!f.dependsOnlyOnPositions())
+                f.calcForce(s, rigidBodyForces, particleForces, mobilityForces);
+            else
+                f.calcForce(s, rigidBodyForceCache, particleForceCache, mobilityForceCache);
+        }
+        return true;
+    }
+
+    static const int DefaultParallelForceThreshold = 32;
+
     Array_<Force*>                  forces;
     
         // TOPOLOGY "CACHE"
@@ -269,7 +535,19 @@ private:
     mutable CacheEntryIndex         rigidBodyForceCacheIndex;
     mutable CacheEntryIndex         mobilityForceCacheIndex;
     mutable CacheEntryIndex         particleForceCacheIndex;
+    mutable CacheEntryIndex         parallelWorkspaceCacheIndex;
     mutable DiscreteVariableIndex   forceEnabledIndex;
+
+        // PARALLEL EVALUATION SETTINGS
+    // These don't affect the results (except for roundoff) so changing them
+    // doesn't invalidate anything.
+    bool                            useParallelForceEvaluation;
+    int                             parallelForceThreshold;
+    int                             numParallelForceThreads; // 0 -> #procs
+    // The pool is created on first use; the lock keeps two threads realizing
+    // different States from using it at the same time.
+    mutable WorkStealingExecutor*   forceExecutor;
+    mutable pthread_mutex_t         forceExecutorLock;
 };
 
     ///////////////////////////
@@ -332,6 +610,21 @@ void GeneralForceSubsystem::setForceIsDisabled
    (State& state, ForceIndex index, bool disabled) const 
 {   getRep().setForceIsDisabled(state, index, disabled); }
 
+void GeneralForceSubsystem::setUseParallelForceEvaluation(bool useParallel)
+{   updRep().setUseParallelForceEvaluation(useParallel); }
+bool GeneralForceSubsystem::getUseParallelForceEvaluation() const
+{   return getRep().getUseParallelForceEvaluation(); }
+
+void GeneralForceSubsystem::setParallelForceThreshold(int minForces)
+{   updRep().setParallelForceThreshold(minForces); }
+int GeneralForceSubsystem::getParallelForceThreshold() const
+{   return getRep().getParallelForceThreshold(); }
+
+void GeneralForceSubsystem::setNumParallelForceThreads(int numThreads)
+{   updRep().setNumParallelForceThreads(numThreads); }
+int GeneralForceSubsystem::getNumParallelForceThreads() const
+{   return getRep().getNumParallelForceThreads(); }
+
 const MultibodySystem& GeneralForceSubsystem::getMultibodySystem() const
 {   return MultibodySystem::downcast(getSystem()); }
 
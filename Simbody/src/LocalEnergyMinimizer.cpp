@@ -26,8 +26,6 @@
 #include "simbody/internal/MultibodySystem.h"
 #include "simbody/internal/LocalEnergyMinimizer.h"
 #include "simbody/internal/SimbodyMatterSubsystem.h"
-#include <vector>
-#include <map>
 
 using namespace SimTK;
 using namespace std;
@@ -40,46 +38,94 @@ class LocalEnergyMinimizer::OptimizerFunction : public OptimizerSystem {
 public:
     // stateIn must be realized to Model stage already.
     OptimizerFunction(const MultibodySystem& system, const State& stateIn)
-    :   OptimizerSystem(stateIn.getNQ()), system(system), state(stateIn) {
+    :   OptimizerSystem(stateIn.getNQ()), system(system), state(stateIn),
+        usePotentialForces(true), haveEnergy(false) {
         state.updU() = 0;   // no velocities
         system.realize(state, Stage::Time); // we'll only change Position stage and above
         setNumEqualityConstraints(state.getNQErr());
     }
     int objectiveFunc(const Vector& parameters, bool new_parameters, Real& f) const {
-        if (new_parameters)
-            state.updQ() = parameters;
-        system.realize(state, Stage::Dynamics);
-        f = system.calcPotentialEnergy(state);
+        setQ(parameters);
+        calcEnergyAndGradient();
+        f = energy;
         return 0;
     }
     int gradientFunc(const Vector& parameters, bool new_parameters, Vector& gradient) const  {
-        if (new_parameters)
-            state.updQ() = parameters;
-        system.realize(state, Stage::Dynamics);
-        Vector_<SpatialVec> dEdR = system.getRigidBodyForces(state, Stage::Dynamics);
-        const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
-        Vector dEdU;
-        // Convert spatial forces dEdR to generalized forces dEdU.
-        matter.multiplyBySystemJacobianTranspose(state, dEdR, dEdU);
-        dEdU -= system.getMobilityForces(state, Stage::Dynamics);
-        matter.multiplyByNInv(state, true, -1.0*dEdU, gradient);
+        setQ(parameters);
+        calcEnergyAndGradient();
+        gradient = energyGradient;
         return 0;
     }
     int constraintFunc(const Vector& parameters, bool new_parameters, Vector& constraints) const {
-        state.updQ() = parameters;
+        setQ(parameters);
         system.realize(state, Stage::Position);
         constraints = state.getQErr();
         return 0;
     }
+    // With Euler angles there are no quaternion normalization constraints, so
+    // the position errors are just the holonomic constraint errors and their
+    // Jacobian is Pq = P*N^-1.
+    int constraintJacobian(const Vector& parameters, bool new_parameters, Matrix& jac) const {
+        setQ(parameters);
+        system.realize(state, Stage::Position);
+        system.getMatterSubsystem().calcPq(state, jac);
+        return 0;
+    }
     void optimize(Vector& q, Real tolerance) {
         Optimizer opt(*this);
-        opt.useNumericalJacobian(true);
         opt.setConvergenceTolerance(tolerance);
         opt.optimize(q);
     }
 private:
+    // The optimizer often passes the same parameters to several of these
+    // methods in a row, and those may all be evaluated from one realization.
+    // Changing q invalidates the energy and gradient we have.
+    void setQ(const Vector& parameters) const {
+        const Vector& q = state.getQ();
+        for (int i=0; i < q.size(); ++i)
+            if (q[i] != parameters[i]) {
+                state.updQ() = parameters;
+                haveEnergy = false;
+                return;
+            }
+    }
+
+    // Calculate the potential energy and its gradient dE/dq = -N^-T f, where
+    // f is the generalized force produced by the applied forces. We only need
+    // the forces if every force subsystem can calculate them without 
+    // realizing Dynamics stage; otherwise we have to realize it.
+    void calcEnergyAndGradient() const {
+        if (haveEnergy)
+            return;
+        if (usePotentialForces) {
+            system.realize(state, Stage::Velocity);
+            usePotentialForces = system.calcPotentialEnergyAndForces
+               (state, energy, rigidBodyForces, particleForces, mobilityForces);
+        }
+        if (!usePotentialForces) {
+            system.realize(state, Stage::Dynamics);
+            energy = system.calcPotentialEnergy(state);
+            rigidBodyForces = system.getRigidBodyForces(state, Stage::Dynamics);
+            mobilityForces = system.getMobilityForces(state, Stage::Dynamics);
+        }
+        const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+        Vector f;
+        // Convert spatial forces to generalized forces.
+        matter.multiplyBySystemJacobianTranspose(state, rigidBodyForces, f);
+        f += mobilityForces;
+        matter.multiplyByNInv(state, true, -1.0*f, energyGradient);
+        haveEnergy = true;
+    }
+
     const MultibodySystem& system;
     mutable State state;
+    mutable bool usePotentialForces;
+    mutable bool haveEnergy;
+    mutable Real energy;
+    mutable Vector energyGradient;
+    mutable Vector_<SpatialVec> rigidBodyForces;
+    mutable Vector_<Vec3> particleForces;
+    mutable Vector mobilityForces;
 };
 
 void LocalEnergyMinimizer::minimizeEnergy(const MultibodySystem& system, State& state, Real tolerance) {
@@ -100,3 +146,60 @@ void LocalEnergyMinimizer::minimizeEnergy(const MultibodySystem& system, State&
     }
     system.realize(state, Stage::Dynamics);
 }
+
+namespace {
+// Minimizes each of the listed States on the thread pool.
+class MinimizeTask : public GuardedParallelTask {
+public:
+    MinimizeTask(const MultibodySystem& system, Array_<State>& states,
+                 const Array_<int>& which, Real tolerance)
+    :   system(system), states(states), which(which), tolerance(tolerance) {}
+
+    void executeGuarded(int k) {
+        LocalEnergyMinimizer::minimizeEnergy(system, states[which[k]], 
+                                             tolerance);
+    }
+private:
+    const MultibodySystem&  system;
+    Array_<State>&          states;
+    const Array_<int>&      which;
+    const Real              tolerance;
+};
+}
+
+void LocalEnergyMinimizer::minimizeEnergy(const MultibodySystem& system, Array_<State>& states,
+                                          Real tolerance, int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "LocalEnergyMinimizer",
+        "minimizeEnergy", 
+        "The number of threads can't be negative but was %d.", numThreads);
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+
+    // Position constraints require the interior point optimizer, which 
+    // isn't thread safe, so those States are minimized one at a time.
+    Array_<int> concurrent, sequential;
+    for (int i=0; i < (int)states.size(); ++i) {
+        system.realize(states[i], Stage::Instance);
+        if (states[i].getNQErr() > matter.getNumQuaternionsInUse(states[i]))
+            sequential.push_back(i);
+        else
+            concurrent.push_back(i);
+    }
+
+    if (!concurrent.empty()) {
+        MinimizeTask task(system, states, concurrent, tolerance);
+        const int nThreads = std::min((int)concurrent.size(), numThreads > 0 
+            ? numThreads : ParallelExecutor::getNumProcessors());
+        if (nThreads > 1 && !ParallelExecutor::isWorkerThread()) {
+            ParallelExecutor executor(nThreads);
+            executor.execute(task, (int)concurrent.size());
+            SimTK_ERRCHK1_ALWAYS(!task.hasFailed(), 
+                "LocalEnergyMinimizer::minimizeEnergy()",
+                "A parallel energy minimization failed: %s", 
+                task.getErrorMessage().c_str());
+        } else
+            task.executeSerially((int)concurrent.size());
+    }
+
+    for (int k=0; k < (int)sequential.size(); ++k)
+        minimizeEnergy(system, states[sequential[k]], tolerance);
+}
@@ -139,6 +139,12 @@ const Real
 MultibodySystem::calcPotentialEnergy(const State& s) const {
     return getRep().calcPotentialEnergy(s);
 }
+bool MultibodySystem::calcPotentialEnergyAndForces
+   (const State& s, Real& pe, Vector_<SpatialVec>& rigidBodyForces,
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const {
+    return getRep().calcPotentialEnergyAndForces(s, pe, rigidBodyForces,
+                                                 particleForces, mobilityForces);
+}
 const Real
 MultibodySystem::calcKineticEnergy(const State& s) const {
     return getMatterSubsystem().getRep().calcKineticEnergy(s);
@@ -280,6 +286,52 @@ int MultibodySystemRep::realizeAccelerationImpl(const State& s) const {
 
     return 0;
 }
+// Calculate Jv=J*v for the unconstrained multibody equations qdot=N(q)u,
+// udot=M(q)^-1 (f(q,u)-c(q,u)). The kinematic equations are linear in u so
+// their u columns are exactly N*vu; the q columns are a difference of N(q)*u.
+// For the dynamic equations we realize Dynamics at the perturbed state 
+// (q',u') and find the residual r'=M' udot + c' - f' of the unperturbed udot
+// there. Then udot'-udot = -M'^-1 r', using only O(n) operators rather than a
+// new forward dynamics solution. Constraints, prescribed motion, and 
+// auxiliary state variables aren't handled; for those we tell the caller to 
+// use its own difference quotient.
+bool MultibodySystemRep::calcYDotJacobianTimesVectorImpl
+   (State& s, const Vector& ydot, const Vector& v, Real increment, 
+    Vector& Jv) const 
+{
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    const SBInstanceCache& ic = matter.getRep().getInstanceCache(s);
+    if (s.getNZ() || s.getNMultipliers() || ic.getTotalNumPresQ() 
+        || ic.getTotalNumPresU() || ic.getTotalNumPresUDot())
+        return false;
+
+    const int nq = s.getNQ(), nu = s.getNU();
+    const Vector q = s.getQ(), u = s.getU(); // to restore on return
+    const Vector vq = v(0,nq), vu = v(nq,nu);
+    const Vector qdot = ydot(0,nq), udot = ydot(nq,nu);
+
+    Vector Nvu, Nu, residual, dudot;
+    multiplyByNImpl(s, vu, Nvu);
+
+    s.updQ() += increment*vq;
+    s.updU() += increment*vu;
+    realize(s, Stage::Dynamics);
+
+    multiplyByNImpl(s, u, Nu);
+    matter.calcResidualForceIgnoringConstraints(s, 
+        getMobilityForces(s, Stage::Dynamics), 
+        getRigidBodyForces(s, Stage::Dynamics), udot, residual);
+    matter.multiplyByMInv(s, residual, dudot);
+
+    Jv.resize(nq+nu);
+    Jv(0,nq)  = Nvu + (Nu-qdot)/increment;
+    Jv(nq,nu) = dudot/(-increment);
+
+    s.updQ() = q;
+    s.updU() = u;
+    return true;
+}
+
 int MultibodySystemRep::realizeReportImpl(const State& s) const {
     getGlobalSubsystem().getRep().realizeSubsystemReport(s);
     // note order: forces first (TODO: does that matter?)
@@ -394,6 +394,25 @@ public:
             pe += getForceSubsystem(forceSubs[i]).getRep().calcPotentialEnergy(s);
         return pe;
     }
+    bool calcPotentialEnergyAndForces(const State& s, Real& pe,
+                                      Vector_<SpatialVec>& rigidBodyForces,
+                                      Vector_<Vec3>& particleForces,
+                                      Vector& mobilityForces) const {
+        const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+        rigidBodyForces.resize(matter.getNumBodies());
+        rigidBodyForces = SpatialVec(Vec3(0), Vec3(0));
+        particleForces.resize(matter.getNumParticles());
+        particleForces = Vec3(0);
+        mobilityForces.resize(matter.getNumMobilities());
+        mobilityForces = 0;
+        pe = 0;
+        for (int i = 0; i < (int) forceSubs.size(); ++i)
+            if (!getForceSubsystem(forceSubs[i]).getRep()
+                    .calcPotentialEnergyAndForces(s, pe, rigidBodyForces,
+                                                  particleForces, mobilityForces))
+                return false;
+        return true;
+    }
 
     // These are the global subsystem cache entries at the indicated Stage.
     // This will reduce the stage of s to the previous stage.
@@ -466,6 +485,10 @@ public:
         mech.getRep().multiplyByNInv(s,true,fu,fq);
     }  
 
+    bool calcYDotJacobianTimesVectorImpl
+       (State& s, const Vector& ydot, const Vector& v, Real increment,
+        Vector& Jv) const;
+
     /* TODO: not yet
     virtual void handleEventsImpl
        (State&, EventCause, const Array<EventId>& eventIds,
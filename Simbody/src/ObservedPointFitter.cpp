@@ -39,7 +39,8 @@ static const Real MinimumShift = 1; // add to objective to get minimum away from
 
 class ObservedPointFitter::OptimizerFunction : public OptimizerSystem {
 public:
-    OptimizerFunction(const MultibodySystem& system, const State& state, Array_<MobilizedBodyIndex> bodyIxs, Array_<Array_<Vec3> > stations, Array_<Array_<Vec3> > targetLocations, Array_<Array_<Real> > weights) :
+    // The arrays are referenced, not copied, so must outlive this object.
+    OptimizerFunction(const MultibodySystem& system, const State& state, const Array_<MobilizedBodyIndex>& bodyIxs, const Array_<Array_<Vec3> >& stations, const Array_<Array_<Vec3> >& targetLocations, const Array_<Array_<Real> >& weights) :
         OptimizerSystem(state.getNQ()), system(system), state(state), bodyIxs(bodyIxs), stations(stations), targetLocations(targetLocations), weights(weights) {
         system.realize(state, Stage::Instance);
         setNumEqualityConstraints(state.getNQErr());
@@ -89,17 +90,24 @@ public:
     }
     int constraintFunc(const Vector& parameters, bool new_parameters, Vector& constraints) const {
         state.updQ() = parameters;
-        system.realize(state, Stage::Velocity);
+        system.realize(state, Stage::Position);
         constraints = state.getQErr();
         return 0;
     }
+    // We always fit in Euler angles, so there are no quaternion normalization
+    // constraints and the Jacobian of the position errors is Pq = P*N^-1.
+    int constraintJacobian(const Vector& parameters, bool new_parameters, Matrix& jac) const {
+        state.updQ() = parameters;
+        system.realize(state, Stage::Position);
+        system.getMatterSubsystem().calcPq(state, jac);
+        return 0;
+    }
     void optimize(Vector& q, Real tolerance) {
         Optimizer opt(*this
             //, LBFGSB // XXX
             //, InteriorPoint // XXX
             );
         //opt.useNumericalGradient(true); //XXX
-        opt.useNumericalJacobian(true);
         opt.setConvergenceTolerance(tolerance);
         opt.setMaxIterations(3000);
         opt.setLimitedMemoryHistory(40);
@@ -108,10 +116,10 @@ public:
     }
 private:
     const MultibodySystem& system;
-    const Array_<MobilizedBodyIndex> bodyIxs;
-    const Array_<Array_<Vec3> > stations;
-    const Array_<Array_<Vec3> > targetLocations;
-    const Array_<Array_<Real> > weights;
+    const Array_<MobilizedBodyIndex>& bodyIxs;
+    const Array_<Array_<Vec3> >& stations;
+    const Array_<Array_<Vec3> >& targetLocations;
+    const Array_<Array_<Real> >& weights;
     mutable State state;
 };
 
@@ -223,14 +231,84 @@ Real ObservedPointFitter::findBestFit
     const Array_<Array_<Real> >&       weights, 
     Real tolerance) 
 {    
+    ObservedPointFitter fitter(system, bodyIxs, stations, weights, tolerance);
+    return fitter.fitFrame(state, targetLocations);
+}
+
+//==============================================================================
+//                          OBSERVED POINT FITTER REP
+//==============================================================================
+// Everything about the fit that doesn't depend on the target locations is 
+// worked out once here, including a cloned system for each body's initial
+// estimation subproblem. The subproblems are only read while fitting, so
+// several frames may be fit concurrently.
+namespace SimTK {
+class ObservedPointFitterRep {
+public:
+    ObservedPointFitterRep(const MultibodySystem& system,
+                           const Array_<MobilizedBodyIndex>& bodyIxs,
+                           const Array_<Array_<Vec3> >& stations,
+                           const Array_<Array_<Real> >& weights,
+                           Real tolerance);
+    ~ObservedPointFitterRep() {
+        for (int i = 0; i < (int)subproblems.size(); ++i)
+            delete subproblems[i];
+    }
+
+    // Return a copy of state that uses Euler angles, realized through Position
+    // stage, and put the q's from such a copy back into state.
+    State makeFittingState(const State& state) const;
+    void storeFittedState(const State& tempState, State& state) const;
+
+    // Fit the target locations starting from tempState's q's, which are 
+    // replaced by the best fit. If estimate is true, the subproblems are used
+    // to improve the starting guess first. A subproblem that fails is reported
+    // on std::cout and skipped, unless throwSubproblemFailures is true; then
+    // it is thrown, so a worker thread can hand it back to its caller.
+    Real fit(State& tempState, const Array_<Array_<Vec3> >& targetLocations,
+             bool estimate, bool throwSubproblemFailures=false) const;
+
+    // True if the fit needs the interior point optimizer, which isn't thread
+    // safe.
+    bool hasPositionConstraints(const State& state) const;
+
+    struct Subproblem {
+        MobilizedBodyIndex          primaryBodyIx;
+        Array_<MobilizedBodyIndex>  originalBodyIxs;
+        Array_<MobilizedBodyIndex>  copyBodyIxs;
+        bool                        hasArtificialBaseBody;
+        MultibodySystem             copy;
+        Array_<int>                 stationSet; // -1 or index into stations
+        Array_<Array_<Vec3> >       copyStations;
+        Array_<Array_<Real> >       copyWeights;
+    };
+
+    const MultibodySystem&          system;
+    const Array_<MobilizedBodyIndex> bodyIxs;
+    const Array_<Array_<Vec3> >     stations;
+    const Array_<Array_<Real> >     weights;
+    const Real                      tolerance;
+    Array_<Subproblem*>             subproblems;
+
+    // The previous solution used by fitFrame() to warm start the next frame.
+    Vector                          previousQ;
+};
+
+ObservedPointFitterRep::ObservedPointFitterRep
+   (const MultibodySystem& system, const Array_<MobilizedBodyIndex>& bodyIxs,
+    const Array_<Array_<Vec3> >& stations, 
+    const Array_<Array_<Real> >& weights, Real tolerance)
+:   system(system), bodyIxs(bodyIxs), stations(stations), weights(weights),
+    tolerance(tolerance)
+{
     // Verify the inputs.
     
     const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
-    SimTK_APIARGCHECK(bodyIxs.size() == stations.size() && stations.size() == targetLocations.size(), "ObservedPointFitter", "findBestFit", "bodyIxs, stations, and targetLocations must all be the same length");
+    SimTK_APIARGCHECK(bodyIxs.size() == stations.size() && stations.size() == weights.size(), "ObservedPointFitter", "ObservedPointFitter", "bodyIxs, stations, and weights must all be the same length");
     int numBodies = matter.getNumBodies();
     for (int i = 0; i < (int)stations.size(); ++i) {
-        SimTK_APIARGCHECK(bodyIxs[i] >= 0 && bodyIxs[i] < numBodies, "ObservedPointFitter", "findBestFit", "Illegal body ID");
-        SimTK_APIARGCHECK(stations[i].size() == targetLocations[i].size(), "ObservedPointFitter", "findBestFit", "Different number of stations and target locations for body");
+        SimTK_APIARGCHECK(bodyIxs[i] >= 0 && bodyIxs[i] < numBodies, "ObservedPointFitter", "ObservedPointFitter", "Illegal body ID");
+        SimTK_APIARGCHECK(stations[i].size() == weights[i].size(), "ObservedPointFitter", "ObservedPointFitter", "Different number of stations and weights for body");
     }
     
     // Build a list of children for each body.
@@ -261,103 +339,146 @@ Real ObservedPointFitter::findBestFit
                 numStations[bodyIxs[i]]++;
     }
 
-    // Perform the initial estimation of Q for each mobilizer.
-    // Our first guess is the passed-in q's, with quaternions converted
-    // to Euler angles if necessary. As we solve a subproblem for each
-    // of the bodies in ascending order, we'll update tempState's q's
-    // for that body to their solved values.
-    State tempState;
-    if (!matter.getUseEulerAngles(state))
-        matter.convertToEulerAngles(state, tempState);
-    else tempState = state;
-    system.realizeModel(tempState);
-    system.realize(tempState, Stage::Position);
-
-    // This will accumulate best-guess spatial poses for the bodies as
-    // they are processed. This is useful for when a body is used as
-    // an artificial base body; our first guess will to be to place it
-    // wherever it was the last time it was used in a subproblem.
-    Array_<Transform> guessX_GB(matter.getNumBodies());
-    for (MobilizedBodyIndex mbx(1); mbx < guessX_GB.size(); ++mbx)
-        guessX_GB[mbx] = matter.getMobilizedBody(mbx).getBodyTransform(tempState);
-
+    // Create a subproblem for each body whose q's need an initial estimate. 
+    // The number of q's is the number with Euler angles, which we fit in.
+    
+    State eulerState = system.getDefaultState();
+    matter.setUseEulerAngles(eulerState, true);
+    system.realizeModel(eulerState);
     for (int i = 0; i < matter.getNumBodies(); ++i) {
         MobilizedBodyIndex id(i);
         const MobilizedBody& body = matter.getMobilizedBody(id);
-        if (body.getNumQ(tempState) == 0)
+        if (body.getNumQ(eulerState) == 0)
             continue; // No degrees of freedom to determine.
         if (children[id].size() == 0 && numStations[id] == 0)
             continue; // There are no stations whose positions are affected by this.
         Array_<MobilizedBodyIndex> originalBodyIxs;
-        int currentBodyIndex = findBodiesForClonedSystem(body.getMobilizedBodyIndex(), numStations, matter, children, originalBodyIxs);
+        int currentBodyIndex = ObservedPointFitter::findBodiesForClonedSystem(body.getMobilizedBodyIndex(), numStations, matter, children, originalBodyIxs);
         if (currentBodyIndex == (int)originalBodyIxs.size()-1 
             && (bodyIndex[id] == -1 || stations[bodyIndex[id]].size() == 0))
             continue; // There are no stations whose positions are affected by this.
-        MultibodySystem copy;
-        Array_<MobilizedBodyIndex> copyBodyIxs;
-        bool hasArtificialBaseBody;
-        createClonedSystem(system, copy, originalBodyIxs, copyBodyIxs, hasArtificialBaseBody);
-        const SimbodyMatterSubsystem& copyMatter = copy.getMatterSubsystem();
-        // Construct an initial state.
-        State copyState = copy.getDefaultState();
-        assert(copyBodyIxs.size() == originalBodyIxs.size());
-        for (int ob=0; ob < (int)originalBodyIxs.size(); ++ob) {
-            const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(copyBodyIxs[ob]);
-            const MobilizedBody& origMobod = matter.getMobilizedBody(originalBodyIxs[ob]);
-            if (ob==0 && hasArtificialBaseBody)
-                copyMobod.setQToFitTransform(copyState, guessX_GB[origMobod.getMobilizedBodyIndex()]);
-            else
-                copyMobod.setQFromVector(copyState, origMobod.getQAsVector(tempState));
-        }
-
-        Array_<Array_<Vec3> > copyStations(copyMatter.getNumBodies());
-        Array_<Array_<Vec3> > copyTargetLocations(copyMatter.getNumBodies());
-        Array_<Array_<Real> > copyWeights(copyMatter.getNumBodies());
+        Subproblem* sub = new Subproblem();
+        subproblems.push_back(sub);
+        sub->primaryBodyIx = id;
+        sub->originalBodyIxs = originalBodyIxs;
+        ObservedPointFitter::createClonedSystem(system, sub->copy, originalBodyIxs, sub->copyBodyIxs, sub->hasArtificialBaseBody);
+        assert(sub->copyBodyIxs.size() == originalBodyIxs.size());
+        const SimbodyMatterSubsystem& copyMatter = sub->copy.getMatterSubsystem();
+        sub->stationSet.resize(copyMatter.getNumBodies(), -1);
+        sub->copyStations.resize(copyMatter.getNumBodies());
+        sub->copyWeights.resize(copyMatter.getNumBodies());
         for (int j = 0; j < (int)originalBodyIxs.size(); ++j) {
             int index = bodyIndex[originalBodyIxs[j]];
             if (index != -1) {
-                copyStations[copyBodyIxs[j]] = stations[index];
-                copyTargetLocations[copyBodyIxs[j]] = targetLocations[index];
-                copyWeights[copyBodyIxs[j]] = weights[index];
+                sub->stationSet[sub->copyBodyIxs[j]] = index;
+                sub->copyStations[sub->copyBodyIxs[j]] = stations[index];
+                sub->copyWeights[sub->copyBodyIxs[j]] = weights[index];
             }
         }
-        try {
-            OptimizerFunction optimizer(copy, copyState, copyBodyIxs, copyStations, copyTargetLocations, copyWeights);
-            Vector q(copyState.getQ());
-            //std::cout << "BODY " << i << " q0=" << q << std::endl;
-            optimizer.optimize(q, tolerance);
-            //std::cout << "  qf=" << q << std::endl;
-            copyState.updQ() = q;
-            copy.realize(copyState, Stage::Position);
-            // Transfer updated state back to tempState as improved initial guesses.
-            // However, all but the currentBody will get overwritten later.
-            for (int ob=0; ob < (int)originalBodyIxs.size(); ++ob) {
-                const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(copyBodyIxs[ob]);
-                guessX_GB[originalBodyIxs[ob]] = copyMobod.getBodyTransform(copyState);
-
-                if (ob==0 && hasArtificialBaseBody) continue; // leave default state
-                const MobilizedBody& origMobod = matter.getMobilizedBody(originalBodyIxs[ob]);
-                origMobod.setQFromVector(tempState, copyMobod.getQAsVector(copyState));
+    }
+}
+
+State ObservedPointFitterRep::makeFittingState(const State& state) const {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    State tempState;
+    if (!matter.getUseEulerAngles(state))
+        matter.convertToEulerAngles(state, tempState);
+    else tempState = state;
+    system.realizeModel(tempState);
+    system.realize(tempState, Stage::Position);
+    return tempState;
+}
+
+void ObservedPointFitterRep::storeFittedState(const State& tempState, 
+                                              State& state) const {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    if (matter.getUseEulerAngles(state))
+        state.updQ() = tempState.getQ();
+    else
+        matter.convertToQuaternions(tempState, state);
+}
+
+bool ObservedPointFitterRep::hasPositionConstraints(const State& state) const {
+    State s = makeFittingState(state);
+    return s.getNQErr() > 0;
+}
+
+Real ObservedPointFitterRep::fit
+   (State& tempState, const Array_<Array_<Vec3> >& targetLocations, 
+    bool estimate, bool throwSubproblemFailures) const
+{
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    SimTK_APIARGCHECK(targetLocations.size() == stations.size(), "ObservedPointFitter", "fit", "There must be target locations for each body with stations");
+    for (int i = 0; i < (int)stations.size(); ++i)
+        SimTK_APIARGCHECK(stations[i].size() == targetLocations[i].size(), "ObservedPointFitter", "fit", "Different number of stations and target locations for body");
+
+    if (estimate) {
+        // Perform the initial estimation of Q for each mobilizer.
+        // Our first guess is the passed-in q's. As we solve a subproblem for
+        // each of the bodies in ascending order, we'll update tempState's q's
+        // for that body to their solved values.
+
+        // This will accumulate best-guess spatial poses for the bodies as
+        // they are processed. This is useful for when a body is used as
+        // an artificial base body; our first guess will to be to place it
+        // wherever it was the last time it was used in a subproblem.
+        system.realize(tempState, Stage::Position);
+        Array_<Transform> guessX_GB(matter.getNumBodies());
+        for (MobilizedBodyIndex mbx(1); mbx < guessX_GB.size(); ++mbx)
+            guessX_GB[mbx] = matter.getMobilizedBody(mbx).getBodyTransform(tempState);
+
+        for (int s = 0; s < (int)subproblems.size(); ++s) {
+            const Subproblem& sub = *subproblems[s];
+            const SimbodyMatterSubsystem& copyMatter = sub.copy.getMatterSubsystem();
+            // Construct an initial state.
+            State copyState = sub.copy.getDefaultState();
+            for (int ob=0; ob < (int)sub.originalBodyIxs.size(); ++ob) {
+                const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(sub.copyBodyIxs[ob]);
+                const MobilizedBody& origMobod = matter.getMobilizedBody(sub.originalBodyIxs[ob]);
+                if (ob==0 && sub.hasArtificialBaseBody)
+                    copyMobod.setQToFitTransform(copyState, guessX_GB[origMobod.getMobilizedBodyIndex()]);
+                else
+                    copyMobod.setQFromVector(copyState, origMobod.getQAsVector(tempState));
+            }
+
+            Array_<Array_<Vec3> > copyTargetLocations(copyMatter.getNumBodies());
+            for (int j = 0; j < (int)sub.stationSet.size(); ++j)
+                if (sub.stationSet[j] != -1)
+                    copyTargetLocations[j] = targetLocations[sub.stationSet[j]];
+            try {
+                ObservedPointFitter::OptimizerFunction optimizer(sub.copy, copyState, sub.copyBodyIxs, sub.copyStations, copyTargetLocations, sub.copyWeights);
+                Vector q(copyState.getQ());
+                optimizer.optimize(q, tolerance);
+                copyState.updQ() = q;
+                sub.copy.realize(copyState, Stage::Position);
+                // Transfer updated state back to tempState as improved initial guesses.
+                // However, all but the currentBody will get overwritten later.
+                for (int ob=0; ob < (int)sub.originalBodyIxs.size(); ++ob) {
+                    const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(sub.copyBodyIxs[ob]);
+                    guessX_GB[sub.originalBodyIxs[ob]] = copyMobod.getBodyTransform(copyState);
+
+                    if (ob==0 && sub.hasArtificialBaseBody) continue; // leave default state
+                    const MobilizedBody& origMobod = matter.getMobilizedBody(sub.originalBodyIxs[ob]);
+                    origMobod.setQFromVector(tempState, copyMobod.getQAsVector(copyState));
+                }
+            }
+            catch (Exception::OptimizerFailed ex) {
+                if (throwSubproblemFailures)
+                    SimTK_THROW1(Exception::OptimizerFailed, 
+                        String("estimating body ") + String((int)sub.primaryBodyIx)
+                        + ": " + ex.getMessage());
+                std::cout << "Optimization failure for body "<<sub.primaryBodyIx<<": "<<ex.getMessage() << std::endl;
+                // Just leave this body's state variables set to 0, and rely on the final optimization to fix them.
             }
-            //body.setQFromVector(tempState, copyMatter.getMobilizedBody(copyBodyIxs[currentBodyIndex]).getQAsVector(copyState));
-        }
-        catch (Exception::OptimizerFailed ex) {
-            std::cout << "Optimization failure for body "<<i<<": "<<ex.getMessage() << std::endl;
-            // Just leave this body's state variables set to 0, and rely on the final optimization to fix them.
         }
     }
 
     // Now do the final optimization of the whole system.
 
-    OptimizerFunction optimizer(system, tempState, bodyIxs, stations, targetLocations, weights);
+    ObservedPointFitter::OptimizerFunction optimizer(system, tempState, bodyIxs, stations, targetLocations, weights);
     Vector q = tempState.getQ();
     optimizer.optimize(q, tolerance);
-    if (matter.getUseEulerAngles(state))
-        state.updQ() = q;
-    else {
-        tempState.updQ() = q;
-        matter.convertToQuaternions(tempState, state);
-    }
+    tempState.updQ() = q;
     
     // Return the RMS error in the optimized system.
     
@@ -373,3 +494,107 @@ Real ObservedPointFitter::findBestFit
 
     return std::sqrt((error-MinimumShift)/totalWeight);
 }
+} // namespace SimTK
+
+//==============================================================================
+//                           OBSERVED POINT FITTER
+//==============================================================================
+ObservedPointFitter::ObservedPointFitter
+   (const MultibodySystem& system, const Array_<MobilizedBodyIndex>& bodyIxs,
+    const Array_<Array_<Vec3> >& stations, 
+    const Array_<Array_<Real> >& weights, Real tolerance)
+:   rep(new ObservedPointFitterRep(system, bodyIxs, stations, weights, 
+                                   tolerance)) {}
+
+ObservedPointFitter::ObservedPointFitter
+   (const MultibodySystem& system, const Array_<MobilizedBodyIndex>& bodyIxs,
+    const Array_<Array_<Vec3> >& stations, Real tolerance)
+:   rep(0) {
+    Array_<Array_<Real> > weights(stations.size());
+    for (int i = 0; i < (int)stations.size(); ++i)
+        weights[i].resize(stations[i].size(), 1.0);
+    rep = new ObservedPointFitterRep(system, bodyIxs, stations, weights, 
+                                     tolerance);
+}
+
+ObservedPointFitter::~ObservedPointFitter() {delete rep;}
+
+Real ObservedPointFitter::fitFrame
+   (State& state, const Array_<Array_<Vec3> >& targetLocations) {
+    State tempState = rep->makeFittingState(state);
+    const bool warmStart = rep->previousQ.size() == tempState.getNQ();
+    if (warmStart)
+        tempState.updQ() = rep->previousQ;
+    const Real error = rep->fit(tempState, targetLocations, !warmStart);
+    rep->previousQ = tempState.getQ();
+    rep->storeFittedState(tempState, state);
+    return error;
+}
+
+void ObservedPointFitter::resetWarmStart() {
+    rep->previousQ.clear();
+}
+
+namespace {
+// Fits one contiguous run of frames per index, each warm started from the 
+// previous one. Subproblem failures are thrown rather than printed, so that 
+// they reach the calling thread along with any other failure.
+class FitFramesTask : public GuardedParallelTask {
+public:
+    FitFramesTask(const ObservedPointFitterRep& rep, const State& initState,
+                  const Array_<Array_<Array_<Vec3> > >& frames,
+                  Array_<State>& states, Array_<Real>& errors, int numRuns)
+    :   rep(rep), initState(initState), frames(frames), states(states), 
+        errors(errors), numRuns(numRuns) {}
+
+    void executeGuarded(int run) {
+        const int nFrames = (int)frames.size();
+        const int first = getBlockStart(nFrames, run, numRuns);
+        const int last  = getBlockStart(nFrames, run+1, numRuns);
+        State tempState = rep.makeFittingState(initState);
+        for (int k = first; k < last; ++k) {
+            errors[k] = rep.fit(tempState, frames[k], k == first, true);
+            rep.storeFittedState(tempState, states[k]);
+        }
+    }
+private:
+    const ObservedPointFitterRep&           rep;
+    const State&                            initState;
+    const Array_<Array_<Array_<Vec3> > >&   frames;
+    Array_<State>&                          states;
+    Array_<Real>&                           errors;
+    const int                               numRuns;
+};
+}
+
+void ObservedPointFitter::fitFrames
+   (const State& initState, const Array_<Array_<Array_<Vec3> > >& frames,
+    Array_<State>& states, Array_<Real>& errors, int numThreads) const
+{
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "ObservedPointFitter",
+        "fitFrames", 
+        "The number of threads can't be negative but was %d.", numThreads);
+    const int nFrames = (int)frames.size();
+    states.clear();
+    states.resize(nFrames, initState);
+    errors.resize(nFrames);
+    if (nFrames == 0)
+        return;
+
+    int numRuns = std::min(nFrames, numThreads > 0 
+        ? numThreads : ParallelExecutor::getNumProcessors());
+    if (rep->hasPositionConstraints(initState) 
+        || ParallelExecutor::isWorkerThread())
+        numRuns = 1;
+
+    FitFramesTask task(*rep, initState, frames, states, errors, numRuns);
+    if (numRuns > 1) {
+        ParallelExecutor executor(numRuns);
+        executor.execute(task, numRuns);
+        SimTK_ERRCHK1_ALWAYS(!task.hasFailed(), 
+            "ObservedPointFitter::fitFrames()",
+            "Fitting a run of frames failed: %s", 
+            task.getErrorMessage().c_str());
+    } else
+        task.executeSerially(1);
+}
@@ -605,6 +605,28 @@ virtual void calcDetMPass2Outward(
     Real*                                   allUDot,
     Matrix& D0) const=0;
 
+// Return this node's contribution to log(det(M)), which is log(det(D)) where
+// D = ~H*P*H is the dof X dof articulated body inertia of this mobilizer. 
+// This is zero for immobile and prescribed nodes. Requires articulated body
+// inertias.
+virtual Real calcLogDetD(
+    const SBInstanceCache&                  ic,
+    const SBArticulatedBodyInertiaCache&    abc) const=0;
+
+// Batched outward pass of multiplyBySqrtMInv() for nVec vectors at once,
+// so that the factorization of D^-1 is done once per node rather than once 
+// per vector. Vector k of epsilon and udot starts at k*nu; the nVec 
+// accelerations of node n are stored together, starting at allA_GB[n*nVec].
+virtual void multiplyBySqrtMInvBatchOutward(
+    const SBInstanceCache&                  ic,
+    const SBTreePositionCache&              pc,
+    const SBArticulatedBodyInertiaCache&    abc,
+    int                                     nVec,
+    int                                     nu,
+    const Real*                             allEpsilon,
+    SpatialVec*                             allA_GB,
+    Real*                                   allUDot) const=0;
+
 // Also serves as pass 1 for inverse dynamics.
 virtual void calcBodyAccelerationsFromUdotOutward(
     const SBTreePositionCache&  pc,
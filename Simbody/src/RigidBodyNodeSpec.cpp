@@ -844,6 +844,108 @@ RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::calcDetMPass2Outward(
 // EU END
 
 
+
+//==============================================================================
+//                     LOG DET D and BATCHED SQRT(M^-1)
+//==============================================================================
+// The articulated body factorization gives M = ~(I+K) D (I+K) with D block
+// diagonal and I+K unit block triangular (Rodriguez, Jain & Kreutz-Delgado), 
+// so det(M) is just the product of the nodes' det(D). Similarly 
+// M^-1 = ~A D^-1 A where A is the operator applied by the inward pass of
+// multiplyByMInv() and ~A is applied by the outward pass. If C*~C = D^-1 
+// then S = ~A C satisfies S*~S = M^-1, so replacing DI by C in the outward
+// pass gives sqrt(M^-1)*eps.
+
+// Cholesky factorization A = L*~L of a small symmetric positive definite
+// matrix; only the lower triangle of A is used. Returns false if A is not
+// positive definite.
+template <int N> static bool
+calcCholeskyFactor(const Mat<N,N>& A, Mat<N,N>& L) {
+    L = 0;
+    for (int j=0; j < N; ++j) {
+        Real d = A(j,j);
+        for (int k=0; k < j; ++k) 
+            d -= square(L(j,k));
+        if (!(d > 0)) 
+            return false;
+        L(j,j) = std::sqrt(d);
+        const Real ooLjj = 1/L(j,j);
+        for (int i=j+1; i < N; ++i) {
+            Real s = A(i,j);
+            for (int k=0; k < j; ++k) 
+                s -= L(i,k)*L(j,k);
+            L(i,j) = s*ooLjj;
+        }
+    }
+    return true;
+}
+
+// log(det(D)) is twice the sum of the logs of D's Cholesky diagonal.
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> Real
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::calcLogDetD(
+    const SBInstanceCache&                  ic,
+    const SBArticulatedBodyInertiaCache&    abc) const
+{
+    if (isUDotKnown(ic)) // prescribed mobilities aren't part of M
+        return 0;
+
+    Mat<dof,dof> L;
+    SimTK_ERRCHK1_ALWAYS(calcCholeskyFactor(getD(abc), L),
+        "SimbodyMatterSubsystem::calcLogDetM()",
+        "The articulated body inertia of mobilized body %d is not positive"
+        " definite; the mass matrix is singular.", nodeNum);
+
+    Real logDet = 0;
+    for (int i=0; i < dof; ++i)
+        logDet += std::log(L(i,i));
+    return 2*logDet;
+}
+
+// Base to tip. Each vector costs about 2dof^2 + 23 dof + 12 flops; the 
+// factorization of DI is done only once per call.
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void 
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::multiplyBySqrtMInvBatchOutward(
+    const SBInstanceCache&                  ic,
+    const SBTreePositionCache&              pc,
+    const SBArticulatedBodyInertiaCache&    abc,
+    int                                     nVec,
+    int                                     nu,
+    const Real*                             allEpsilon,
+    SpatialVec*                             allA_GB,
+    Real*                                   allUDot) const
+{
+    const bool isPrescribed = isUDotKnown(ic);
+    const HType&        H   = getH(pc);
+    const PhiMatrix&    phi = getPhi(pc);
+    const HType&        G   = getG(abc);
+
+    const SpatialVec* A_GP = &allA_GB[parent->getNodeNum()*nVec];
+    SpatialVec*       A_GB = &allA_GB[nodeNum*nVec];
+
+    if (isPrescribed) {
+        for (int k=0; k < nVec; ++k) {
+            Vec<dof>::updAs(&allUDot[k*nu + uIndex]) = 0;
+            A_GB[k] = ~phi * A_GP[k];
+        }
+        return;
+    }
+
+    Mat<dof,dof> C;
+    SimTK_ERRCHK1_ALWAYS(calcCholeskyFactor(getDI(abc), C),
+        "SimbodyMatterSubsystem::multiplyBySqrtMInv()",
+        "The articulated body inertia of mobilized body %d is not positive"
+        " definite; the mass matrix is singular.", nodeNum);
+
+    for (int k=0; k < nVec; ++k) {
+        const Vec<dof>& eps  = Vec<dof>::getAs(&allEpsilon[k*nu + uIndex]);
+        Vec<dof>&       udot = Vec<dof>::updAs(&allUDot[k*nu + uIndex]);
+        const SpatialVec APlus = ~phi * A_GP[k];    // 12 flops
+        udot    = C*eps - ~G*APlus;                 // 2dof^2 + 11 dof flops
+        A_GB[k] = APlus + H*udot;                   // 12 dof flops
+    }
+}
+
+
 //==============================================================================
 //                     CALC BODY ACCELERATIONS FROM UDOT
 //==============================================================================
@@ -821,6 +821,20 @@ void calcDetMPass2Outward(
     Real*                       allUDot,
     Matrix&                     D0) const;
 
+Real calcLogDetD(
+    const SBInstanceCache&                  ic,
+    const SBArticulatedBodyInertiaCache&    abc) const;
+
+void multiplyBySqrtMInvBatchOutward(
+    const SBInstanceCache&                  ic,
+    const SBTreePositionCache&              pc,
+    const SBArticulatedBodyInertiaCache&    abc,
+    int                                     nVec,
+    int                                     nu,
+    const Real*                             allEpsilon,
+    SpatialVec*                             allA_GB,
+    Real*                                   allUDot) const;
+
 // Also serves as pass 1 for inverse dynamics.
 void calcBodyAccelerationsFromUdotOutward(
     const SBTreePositionCache&  pc,
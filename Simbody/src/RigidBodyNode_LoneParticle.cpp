@@ -419,11 +419,41 @@ void multiplyBySqrtMInvPass2Outward(
         udot = 0;
         A_GB = SpatialVec(Vec3(0), Vec3(0));
     } else {
-        udot = eps/getMass();
+        udot = eps/std::sqrt(getMass()); // M^-1 = I/m
         A_GB = SpatialVec(Vec3(0), udot);
     }
 }
 
+// For a lone particle D = m*I, so log(det(D)) = 3 log(m).
+Real calcLogDetD(
+        const SBInstanceCache&                  ic,
+        const SBArticulatedBodyInertiaCache&    abc) const 
+{
+    return isUDotKnown(ic) ? Real(0) : 3*std::log(getMass());
+}
+
+void multiplyBySqrtMInvBatchOutward(
+        const SBInstanceCache&                  ic,
+        const SBTreePositionCache&              pc,
+        const SBArticulatedBodyInertiaCache&    abc,
+        int                                     nVec,
+        int                                     nu,
+        const Real*                             allEpsilon,
+        SpatialVec*                             allA_GB,
+        Real*                                   allUDot) const 
+{
+    const bool isPrescribed = isUDotKnown(ic);
+    const Real oosqrtm = 1/std::sqrt(getMass());
+    SpatialVec* A_GB = &allA_GB[nodeNum*nVec];
+
+    for (int k=0; k < nVec; ++k) {
+        const Vec3& eps  = Vec3::getAs(&allEpsilon[k*nu + uIndex]);
+        Vec3&       udot = Vec3::updAs(&allUDot[k*nu + uIndex]);
+        udot = isPrescribed ? Vec3(0) : oosqrtm*eps;
+        A_GB[k] = SpatialVec(Vec3(0), udot);
+    }
+}
+
 // Note that we're not setting z temporaries here; you can't count on that as
 // a side effect the M^-1*f kernel.
 // EU
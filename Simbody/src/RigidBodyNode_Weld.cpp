@@ -70,6 +70,10 @@ public:
     int getPosPoolSize(const SBStateDigest&) const {return 0;}
     int getVelPoolSize(const SBStateDigest&) const {return 0;}
 
+    // No mobilities, so no contribution to det(M).
+    Real calcLogDetD(const SBInstanceCache&,
+                     const SBArticulatedBodyInertiaCache&) const {return 0;}
+
     int calcQPoolSize(const SBModelVars&) const {return 0;}
 
     void performQPrecalculations(const SBStateDigest& sbs,
@@ -297,6 +301,20 @@ public:
         allA_GB[0] = 0;
     }
 
+    void multiplyBySqrtMInvBatchOutward(
+        const SBInstanceCache&,
+        const SBTreePositionCache&,
+        const SBArticulatedBodyInertiaCache&,
+        int                         nVec,
+        int                         nu,
+        const Real*                 allEpsilon,
+        SpatialVec*                 allA_GB,
+        Real*                       allUDot) const
+    {
+        for (int k=0; k < nVec; ++k)
+            allA_GB[k] = 0;
+    }
+
     void calcDetMPass1Inward(
         const SBInstanceCache&     ic,
         const SBTreePositionCache& pc,
@@ -700,6 +718,23 @@ public:
         A_GB = APlus;
     }
 
+    void multiplyBySqrtMInvBatchOutward(
+        const SBInstanceCache&,
+        const SBTreePositionCache&  pc,
+        const SBArticulatedBodyInertiaCache&,
+        int                         nVec,
+        int                         nu,
+        const Real*                 allEpsilon,
+        SpatialVec*                 allA_GB,
+        Real*                       allUDot) const
+    {
+        const PhiMatrix&  phi  = getPhi(pc);
+        const SpatialVec* A_GP = &allA_GB[parent->getNodeNum()*nVec];
+        SpatialVec*       A_GB = &allA_GB[nodeNum*nVec];
+        for (int k=0; k < nVec; ++k)
+            A_GB[k] = ~phi * A_GP[k];
+    }
+
     // Also serves as pass 1 for inverse dynamics.
     void calcBodyAccelerationsFromUdotOutward(
         const SBTreePositionCache&  pc,
@@ -107,6 +107,30 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+bool SimbodyMatterSubsystem::getUseParallelTreeSweeps() const {
+    return getRep().getUseParallelTreeSweeps();
+}
+
+void SimbodyMatterSubsystem::setUseParallelTreeSweeps(bool useParallel) {
+    updRep().setUseParallelTreeSweeps(useParallel);
+}
+
+int SimbodyMatterSubsystem::getParallelTreeSweepThreshold() const {
+    return getRep().getParallelTreeSweepThreshold();
+}
+
+void SimbodyMatterSubsystem::setParallelTreeSweepThreshold(int minBodies) {
+    updRep().setParallelTreeSweepThreshold(minBodies);
+}
+
+int SimbodyMatterSubsystem::getNumParallelTreeSweepThreads() const {
+    return getRep().getNumParallelTreeSweepThreads();
+}
+
+void SimbodyMatterSubsystem::setNumParallelTreeSweepThreads(int numThreads) {
+    updRep().setNumParallelTreeSweepThreads(numThreads);
+}
+
 
 ConstraintIndex SimbodyMatterSubsystem::adoptConstraint(Constraint& child) {
     return updRep().adoptConstraint(child);
@@ -371,6 +395,10 @@ void SimbodyMatterSubsystem::multiplyByM(const State&  state,
     Ma.resize(nu);
     if (nu==0) return;
 
+    // Nothing to copy, so don't construct the temporaries either.
+    if (a.hasContiguousData() && Ma.hasContiguousData())
+    {   rep.multiplyByM(state, a, Ma); return; }
+
     // Assume at first that both Vectors are contiguous.
     const Vector* ca    = &a;
     Vector*       cMa   = &Ma;
@@ -420,6 +448,10 @@ void SimbodyMatterSubsystem::multiplyByMInv(const State&    state,
     MInvf.resize(nu);
     if (nu==0) return;
 
+    // Nothing to copy, so don't construct the temporaries either.
+    if (f.hasContiguousData() && MInvf.hasContiguousData())
+    {   rep.multiplyByMInv(state, f, MInvf); return; }
+
     // Assume at first that both Vectors are contiguous.
     const Vector* cf    = &f;
     Vector*       cMInvf   = &MInvf;
@@ -468,6 +500,10 @@ void SimbodyMatterSubsystem::multiplyBySqrtMInv(const State&    state,
     MInvf.resize(nu);
     if (nu==0) return;
 
+    // Nothing to copy, so don't construct the temporaries either.
+    if (f.hasContiguousData() && MInvf.hasContiguousData())
+    {   rep.multiplyBySqrtMInv(state, f, MInvf); return; }
+
     // Assume at first that both Vectors are contiguous.
     const Vector* cf    = &f;
     Vector*       cMInvf   = &MInvf;
@@ -546,6 +582,50 @@ void SimbodyMatterSubsystem::calcDetM(const State&          state,
 
 //EU END
 
+Real SimbodyMatterSubsystem::calcLogDetM(const State& state) const 
+{   return getRep().calcLogDetM(state); }
+
+// Check arguments and copy in/out of contiguous Matrices if necessary.
+void SimbodyMatterSubsystem::multiplyBySqrtMInv(const State&    state,
+                                                const Matrix&   V,
+                                                Matrix&         SqrtMInvV) const
+{
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const int nu = rep.getNU(state);
+
+    SimTK_ERRCHK2_ALWAYS(V.nrow() == nu,
+        "SimbodyMatterSubsystem::multiplyBySqrtMInv()",
+        "Argument 'V' had %d rows but should have one row per mobility"
+        " (generalized speed u); there are %d.", V.nrow(), nu);
+
+    SqrtMInvV.resize(nu, V.ncol());
+    if (nu==0 || V.ncol()==0) return;
+
+    const Matrix* cV = &V;
+    Matrix*       cSqrtMInvV = &SqrtMInvV;
+    bool needToCopyBack = false;
+
+    // We'll allocate these or not as needed.
+    Matrix contig_V, contig_SqrtMInvV;
+
+    if (!V.hasContiguousData()) {
+        contig_V.resize(nu, V.ncol()); // contiguous memory
+        contig_V(0, 0, nu, V.ncol()) = V; // copy, prevent reallocation
+        cV = (const Matrix*)&contig_V;
+    }
+
+    if (!SqrtMInvV.hasContiguousData()) {
+        contig_SqrtMInvV.resize(nu, V.ncol()); // contiguous memory
+        cSqrtMInvV = (Matrix*)&contig_SqrtMInvV;
+        needToCopyBack = true;
+    }
+
+    rep.multiplyBySqrtMInv(state, *cV, *cSqrtMInvV);
+
+    if (needToCopyBack)
+        SqrtMInvV = *cSqrtMInvV;
+}
+
 void SimbodyMatterSubsystem::calcM(const State& s, Matrix& M) const 
 {   getRep().calcM(s, M); }
 
@@ -865,6 +945,11 @@ multiplyByPq(const State&   s,
     PqXqlike.resize(mp);
     if (mp==0) return;
 
+    // Nothing to copy, so don't construct the temporaries either.
+    if (qlike.hasContiguousData() && biasp.hasContiguousData()
+        && PqXqlike.hasContiguousData())
+    {   rep.multiplyByPq(s, biasp, qlike, PqXqlike); return; }
+
     // Assume at first that all Vectors are contiguous.
     const Vector* cqlike    = &qlike;
     const Vector* cbiasp    = &biasp;
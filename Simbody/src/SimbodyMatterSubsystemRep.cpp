@@ -95,6 +95,229 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     showDefaultGeometry = true;
 }
 
+
+
+//==============================================================================
+//                            PARALLEL TREE SWEEPS
+//==============================================================================
+// Most of the O(n) realizations and operators here are sweeps through the
+// rbNodeLevels array, outward from Ground or inward towards it. Each node 
+// depends only on its parent (outward) or its children (inward), so all the
+// nodes within one level are independent and can be done in any order, or
+// concurrently. Each node writes only into its own slots so the results are
+// bit-identical whether a level is swept serially or in parallel.
+
+namespace {
+
+// This is the task that applies a NodeOperation to the nodes of a single
+// level.
+class TreeLevelTask : public GuardedParallelTask {
+public:
+    TreeLevelTask(const RBNodePtrList& nodes, 
+                  const SimbodyMatterSubsystemRep::NodeOperation& op) 
+    :   nodes(nodes), op(op) {}
+
+    void executeGuarded(int index) {op.apply(*nodes[index]);}
+private:
+    const RBNodePtrList&                            nodes;
+    const SimbodyMatterSubsystemRep::NodeOperation& op;
+};
+
+// These are the node operations used by the realizations below. Each just
+// packages up the arguments of the corresponding RigidBodyNode method.
+
+class RealizePositionOp : public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    explicit RealizePositionOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void apply(const RigidBodyNode& node) const 
+    {   node.realizePosition(sbs); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizeVelocityOp : public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    explicit RealizeVelocityOp(const SBStateDigest& sbs) : sbs(sbs) {}
+    void apply(const RigidBodyNode& node) const 
+    {   node.realizeVelocity(sbs); }
+private:
+    const SBStateDigest& sbs;
+};
+
+class RealizeArticulatedBodyInertiasOp 
+:   public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    RealizeArticulatedBodyInertiasOp(const SBInstanceCache&         ic,
+                                     const SBTreePositionCache&     tpc,
+                                     SBArticulatedBodyInertiaCache& abc) 
+    :   ic(ic), tpc(tpc), abc(abc) {}
+    void apply(const RigidBodyNode& node) const 
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); }
+private:
+    const SBInstanceCache&          ic;
+    const SBTreePositionCache&      tpc;
+    SBArticulatedBodyInertiaCache&  abc;
+};
+
+class RealizeDynamicsOp : public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    RealizeDynamicsOp(const SBArticulatedBodyInertiaCache& abc,
+                      const SBStateDigest&                 sbs) 
+    :   abc(abc), sbs(sbs) {}
+    void apply(const RigidBodyNode& node) const 
+    {   node.realizeDynamics(abc, sbs); }
+private:
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBStateDigest&                    sbs;
+};
+
+class CalcUDotPass1InwardOp : public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    CalcUDotPass1InwardOp(const SBInstanceCache&                ic,
+                          const SBTreePositionCache&            tpc,
+                          const SBArticulatedBodyInertiaCache&  abc,
+                          const SBDynamicsCache&                dc,
+                          const Real*                           mobilityForces,
+                          const SpatialVec*                     bodyForces,
+                          const Real*                           udot,
+                          SpatialVec*                           z,
+                          SpatialVec*                           zPlus,
+                          Real*                                 hingeForces)
+    :   ic(ic), tpc(tpc), abc(abc), dc(dc), mobilityForces(mobilityForces),
+        bodyForces(bodyForces), udot(udot), z(z), zPlus(zPlus), 
+        hingeForces(hingeForces) {}
+    void apply(const RigidBodyNode& node) const {
+        node.calcUDotPass1Inward(ic,tpc,abc,dc,
+            mobilityForces, bodyForces, udot, z, zPlus, hingeForces);
+    }
+private:
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBDynamicsCache&                  dc;
+    const Real*                             mobilityForces;
+    const SpatialVec*                       bodyForces;
+    const Real*                             udot;
+    SpatialVec*                             z;
+    SpatialVec*                             zPlus;
+    Real*                                   hingeForces;
+};
+
+class CalcUDotPass2OutwardOp : public SimbodyMatterSubsystemRep::NodeOperation {
+public:
+    CalcUDotPass2OutwardOp(const SBStateDigest&                 sbs,
+                           const SBInstanceCache&               ic,
+                           const SBTreePositionCache&           tpc,
+                           const SBArticulatedBodyInertiaCache& abc,
+                           const SBTreeVelocityCache&           tvc,
+                           const SBDynamicsCache&               dc,
+                           const Real*                          hingeForces,
+                           SpatialVec*                          A_GB,
+                           Real*                                udot,
+                           Real*                                qdotdot,
+                           Real*                                tau)
+    :   sbs(sbs), ic(ic), tpc(tpc), abc(abc), tvc(tvc), dc(dc), 
+        hingeForces(hingeForces), A_GB(A_GB), udot(udot), qdotdot(qdotdot),
+        tau(tau) {}
+    void apply(const RigidBodyNode& node) const {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            hingeForces, A_GB, udot, tau);
+        node.calcQDotDot(sbs, &udot[node.getUIndex()], 
+                         &qdotdot[node.getQIndex()]);
+    }
+private:
+    const SBStateDigest&                    sbs;
+    const SBInstanceCache&                  ic;
+    const SBTreePositionCache&              tpc;
+    const SBArticulatedBodyInertiaCache&    abc;
+    const SBTreeVelocityCache&              tvc;
+    const SBDynamicsCache&                  dc;
+    const Real*                             hingeForces;
+    SpatialVec*                             A_GB;
+    Real*                                   udot;
+    Real*                                   qdotdot;
+    Real*                                   tau;
+};
+
+}
+
+void SimbodyMatterSubsystemRep::
+setParallelTreeSweepThreshold(int minNodesPerLevel) {
+    SimTK_APIARGCHECK1_ALWAYS(minNodesPerLevel >= 1, "SimbodyMatterSubsystem",
+        "setParallelTreeSweepThreshold", 
+        "The threshold must be at least 1 but was %d.", minNodesPerLevel);
+    parallelTreeSweepThreshold = minNodesPerLevel;
+}
+
+int SimbodyMatterSubsystemRep::getNumParallelTreeSweepThreads() const {
+    return numParallelTreeSweepThreads > 0 ? numParallelTreeSweepThreads
+                                           : ParallelExecutor::getNumProcessors();
+}
+
+void SimbodyMatterSubsystemRep::setNumParallelTreeSweepThreads(int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "SimbodyMatterSubsystem",
+        "setNumParallelTreeSweepThreads", 
+        "The number of threads can't be negative but was %d.", numThreads);
+    pthread_mutex_lock(&treeSweepLock);
+    numParallelTreeSweepThreads = numThreads;
+    // The pool will be recreated with the new size on next use.
+    delete treeSweepExecutor;
+    treeSweepExecutor = 0;
+    pthread_mutex_unlock(&treeSweepLock);
+}
+
+bool SimbodyMatterSubsystemRep::
+executeOnTreeSweepPool(ParallelExecutor::Task& task, int times) const {
+    // Use the thread pool only if it is wanted, we're not already running on
+    // a pool thread, and no other thread is currently using the pool (that 
+    // can happen if several States are being realized concurrently).
+    if (!useParallelTreeSweeps || ParallelExecutor::isWorkerThread()
+        || pthread_mutex_trylock(&treeSweepLock) != 0) 
+        return false;
+
+    if (!treeSweepExecutor)
+        treeSweepExecutor = 
+            new ParallelExecutor(getNumParallelTreeSweepThreads());
+    treeSweepExecutor->execute(task, times);
+    pthread_mutex_unlock(&treeSweepLock);
+    return true;
+}
+
+void SimbodyMatterSubsystemRep::
+applyToLevel(int level, const NodeOperation& op) const {
+    const RBNodePtrList& nodes = rbNodeLevels[level];
+    const int nNodes = (int)nodes.size();
+
+    // Narrow levels aren't worth dispatching to the pool.
+    if (useParallelTreeSweeps && nNodes >= parallelTreeSweepThreshold) {
+        TreeLevelTask task(nodes, op);
+        if (executeOnTreeSweepPool(task, nNodes)) {
+            SimTK_ERRCHK2_ALWAYS(!task.hasFailed(), 
+                "SimbodyMatterSubsystemRep::applyToLevel()",
+                "A parallel tree sweep failed at level %d: %s", 
+                level, task.getErrorMessage().c_str());
+            return;
+        }
+    }
+
+    for (int j=0; j < nNodes; ++j)
+        op.apply(*nodes[j]);
+}
+
+void SimbodyMatterSubsystemRep::
+sweepBaseToTip(const NodeOperation& op, int firstLevel) const {
+    for (int i=firstLevel; i < (int)rbNodeLevels.size(); ++i)
+        applyToLevel(i, op);
+}
+
+void SimbodyMatterSubsystemRep::
+sweepTipToBase(const NodeOperation& op, int firstLevel) const {
+    for (int i=(int)rbNodeLevels.size()-1; i >= firstLevel; --i)
+        applyToLevel(i, op);
+}
+
+
+
 MobilizedBodyIndex SimbodyMatterSubsystemRep::adoptMobilizedBody
    (MobilizedBodyIndex parentIx, MobilizedBody& child) 
 {
@@ -563,6 +786,17 @@ int SimbodyMatterSubsystemRep::realizeSubsystemModelImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // This is just reusable scratch space for forward dynamics with 
+    // constraints; it is never marked valid.
+    mc.loopForwardDynamicsWorkspaceIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<SBLoopForwardDynamicsWorkspace>());
+
+    // Likewise, scratch space for the O(n) operators.
+    mc.operatorWorkspaceIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<SBOperatorWorkspace>());
+
     return 0;
 }
 
@@ -822,6 +1056,8 @@ realizeSubsystemInstanceImpl(const State& s) const {
     for (ConstraintIndex cx(0); cx < constraints.size(); ++cx)
         getConstraint(cx).getImpl().realizeInstance(s);
 
+    findMassCoupledConstraints(s, ic);
+
 
     // Quaternion errors are located after last holonomic constraint error; 
     // see diagram above.
@@ -935,9 +1171,7 @@ int SimbodyMatterSubsystemRep::realizeSubsystemPositionImpl(const State& s) cons
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
     // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    sweepBaseToTip(RealizePositionOp(stateDigest));
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1021,9 +1255,7 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    sweepTipToBase(RealizeArticulatedBodyInertiasOp(ic,tpc,abc));
 
     markCacheValueRealized(state, abx);
 }
@@ -1066,9 +1298,7 @@ int SimbodyMatterSubsystemRep::realizeSubsystemVelocityImpl(const State& s) cons
     // and all global velocities relative to Ground (G).
 
     // Set generalized speeds: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeVelocity(stateDigest); 
+    sweepBaseToTip(RealizeVelocityOp(stateDigest));
 
     // Ask the constraints to calculate ancestor-relative velocity kinematics 
     // (still goes in TreePositionCache).
@@ -1212,9 +1442,7 @@ int SimbodyMatterSubsystemRep::realizeSubsystemDynamicsImpl(const State& s)  con
 
     // Realize velocity-dependent articulated body quantities needed for 
     // dynamics: base-to-tip.
-    for (int i=0; i < (int)rbNodeLevels.size(); ++i)
-        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j)
-            rbNodeLevels[i][j]->realizeDynamics(abc, stateDigest);
+    sweepBaseToTip(RealizeDynamicsOp(abc, stateDigest));
 
     // MobilizedBodies
     // This will include writing the prescribed accelerations into
@@ -2081,6 +2309,19 @@ multiplyByPVATranspose( const State&     s,
                         bool             includeA,
                         const Vector&    lambda,
                         Vector&          allfuVector) const
+{
+    multiplyByPVATranspose(s, includeP, includeV, includeA, lambda, 
+                           allfuVector, updOperatorWorkspace(s));
+}
+
+void SimbodyMatterSubsystemRep::
+multiplyByPVATranspose( const State&            s,
+                        bool                    includeP,
+                        bool                    includeV,
+                        bool                    includeA,
+                        const Vector&           lambda,
+                        Vector&                 allfuVector,
+                        SBOperatorWorkspace&    ws) const
 {
     const SBInstanceCache& ic = getInstanceCache(s);
 
@@ -2104,11 +2345,12 @@ multiplyByPVATranspose( const State&     s,
     if (nu==0) return;
     if (m==0) {allfuVector.setToZero(); return;}
 
-    // Allocate a temporary body forces vector here. We'll map these to 
+    // Use a temporary body forces vector here. We'll map these to 
     // generalized forces as the penultimate step, then add those into 
     // the output argument allfuVector which will have already accumulated 
     // all directly-generated mobility forces.
-    Vector_<SpatialVec> allF_GVector(nb);
+    Vector_<SpatialVec>& allF_GVector = ws.bodyVecs;
+    allF_GVector.resize(nb);
 
     // We'll be accumulating constraint forces into these Vectors so zero 
     // them now. Multiple constraints may contribute to forces on the same 
@@ -2131,13 +2373,13 @@ multiplyByPVATranspose( const State&     s,
     // These Arrays are for one constraint at a time. We need separate 
     // memory for these because constrained bodies and constrained u's are
     // not ordered the same as the global ones, nor are they necessarily
-    // contiguous in the global arrays. We're declaring these arrays
-    // outside the loop to avoid heap allocation -- they will grow to the
-    // max size needed by any constraint, then get resized as needed without
-    // further heap allocation.
-    Array_<SpatialVec,ConstrainedBodyIndex> oneF_G; // body spatial forces
-    Array_<Real,      ConstrainedUIndex>    onefu;  // u-space generalized forces     
-    Array_<Real,      ConstrainedQIndex>    onefq;  // q-space generalized forces     
+    // contiguous in the global arrays. They live in the workspace to avoid
+    // heap allocation -- they grow to the max size needed by any 
+    // constraint, then get resized as needed without further heap 
+    // allocation.
+    Array_<SpatialVec,ConstrainedBodyIndex>& oneF_G = ws.consBodyVecs; // body spatial forces
+    Array_<Real,      ConstrainedUIndex>&    onefu  = ws.consUVals;    // u-space generalized forces     
+    Array_<Real,      ConstrainedQIndex>&    onefq  = ws.consQVals;    // q-space generalized forces     
 
     // Loop over all enabled constraints, ask them to generate forces, and
     // accumulate the results in the global problem arrays (allF_G,allfu).
@@ -2211,8 +2453,8 @@ multiplyByPVATranspose( const State&     s,
 
     // Map the body forces into u-space generalized forces.
     // 12*nu + 18*nb flops.
-    Vector ftmp(nu);
-    multiplyBySystemJacobianTranspose(s, allF_GVector, ftmp);
+    Vector& ftmp = ws.uVec;
+    multiplyBySystemJacobianTranspose(s, allF_GVector, ftmp, ws);
     allfuVector += ftmp;
 }
 
@@ -2537,19 +2779,21 @@ calcBiasForMultiplyByPVA(const State& s,
 
     // This array will be resized and filled with the Ancestor-relative
     // coriolis accelerations for the constrained bodies of each velocity
-    // or acceleration-only Constraint in turn; we're declaring it outside the 
-    // loop to minimize heap allocation (resizing down doesn't normally free 
-    // heap space). This won't be used if we have only holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> AC_AB;
+    // or acceleration-only Constraint in turn; it comes from the State's
+    // operator workspace so that it doesn't touch the heap once it has grown
+    // (resizing down doesn't free heap space). This won't be used if we have
+    // only holonomic constraints.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Array_<SpatialVec,ConstrainedBodyIndex>& AC_AB = ws.consBodyAccs;
 
     // Subarrays of these all-zero arrays will be used to supply zero body
     // velocities and qdots (holonomic) or zero udots (nonholonomic and
-    // acceleration-only) for each Constraint in turn; we're declaring 
-    // them outside the loop to minimize heap allocation. They'll grow until 
-    // they hit the maximum size needed by any Constraint.
-    Array_<SpatialVec,ConstrainedBodyIndex> zeroV_AB;
-    Array_<Real,      ConstrainedQIndex>    zeroQDot;
-    Array_<Real,      ConstrainedUIndex>    zeroUDot;
+    // acceleration-only) for each Constraint in turn. They are kept in the
+    // workspace and grow until they hit the maximum size needed by any 
+    // Constraint; nothing ever writes to them so they stay zero.
+    Array_<SpatialVec,ConstrainedBodyIndex>& zeroV_AB = ws.zeroConsBodyVecs;
+    Array_<Real,      ConstrainedQIndex>&    zeroQDot = ws.zeroConsQVals;
+    Array_<Real,      ConstrainedUIndex>&    zeroUDot = ws.zeroConsUVals;
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output bias vector.
@@ -2827,10 +3071,13 @@ multiplyByPq(const State&   s,
     assert(bias_p.hasContiguousData() && qlike.hasContiguousData());
     assert(PqXqlike.hasContiguousData());
 
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+
     // Generate a u-like Vector via ulike = N^-1 * qlike. Then use that to
     // calculate spatial velocities V_GB = J * ulike.
-    Vector ulike(nu);
-    Vector_<SpatialVec> V_GB(nb);
+    Vector& ulike = ws.uVec;
+    Vector_<SpatialVec>& V_GB = ws.bodyVecs;
+    ulike.resize(nu);
     multiplyByNInv(s, false, qlike, ulike);   // cheap
     multiplyBySystemJacobian(s, ulike, V_GB); // 12*(nu+nb) flops
 
@@ -2844,11 +3091,11 @@ multiplyByPq(const State&   s,
 
     // This array will be resized and filled with the Ancestor-relative
     // velocities for the constrained bodies of each Constraint in turn; 
-    // we're declaring it outside the loop to minimize heap allocation 
-    // (resizing down doesn't normally free heap space).
-    Array_<SpatialVec,ConstrainedBodyIndex> V_AB;
+    // it lives in the workspace to avoid heap allocation (resizing down 
+    // doesn't normally free heap space).
+    Array_<SpatialVec,ConstrainedBodyIndex>& V_AB = ws.consBodyVecs;
     // Same, but for each constraint's qdot subset.
-    Array_<Real,ConstrainedQIndex> qdot;
+    Array_<Real,ConstrainedQIndex>& qdot = ws.consQVals;
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output vector, subtracting off the bias
@@ -2890,8 +3137,8 @@ multiplyByPq(const State&   s,
 //==============================================================================
 //                                 CALC Pq
 //==============================================================================
-// Arranges for contiguous workspace if necessary, then makes repeated calls
-// to multiplyByPq() to compute one column at a time of Pq (=P*N^-1).
+// Makes repeated calls to multiplyByPq() to compute one column at a time of 
+// Pq (=P*N^-1) in contiguous workspace.
 // Complexity is O(n*mp + n*n) = O(n^2) <-- EXPENSIVE! Use transpose instead.
 void SimbodyMatterSubsystemRep::
 calcPq(const State& s, Matrix& Pq) const 
@@ -2906,21 +3153,22 @@ calcPq(const State& s, Matrix& Pq) const
     if (mp==0 || nq==0)
         return;
 
-    Vector biasp(mp);
+    // multiplyByPq() uses the other workspace members.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Vector& biasp = ws.biasp;
+    biasp.resize(mp);
     calcBiasForMultiplyByPVA(s, true, false, false, biasp);
-    Vector qlike(nq, Real(0));
+    Vector& qlike = ws.qVec;
+    qlike.resize(nq); qlike = 0;
 
-    // If Pq's columns are contiguous we can avoid copying.
-    const bool isContiguous = Pq(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : mp);
+    // Each column is calculated into a workspace Vector and then copied
+    // element by element; taking a column view Pq(j) would allocate.
+    Vector& col = ws.Pqcol;
+    col.resize(mp);
     for (int j=0; j < nq; ++j) {
         qlike[j] = 1; // column we're working on
-        if (isContiguous)
-            multiplyByPq(s, biasp, qlike, Pq(j));
-        else {
-            multiplyByPq(s, biasp, qlike, contig_col);
-            Pq(j) = contig_col;
-        }
+        multiplyByPq(s, biasp, qlike, col);
+        for (int i=0; i < mp; ++i) Pq(i,j) = col[i];
         qlike[j] = 0;
     }
 }
@@ -2966,6 +3214,20 @@ multiplyByPVA(  const State&     s,
                 const Vector&    bias,
                 const Vector&    ulike,
                 Vector&          PVAu) const
+{
+    multiplyByPVA(s, includeP, includeV, includeA, bias, ulike, PVAu,
+                  updOperatorWorkspace(s));
+}
+
+void SimbodyMatterSubsystemRep::
+multiplyByPVA(  const State&            s,
+                bool                    includeP,
+                bool                    includeV,
+                bool                    includeA,
+                const Vector&           bias,
+                const Vector&           ulike,
+                Vector&                 PVAu,
+                SBOperatorWorkspace&    ws) const
 {
     const SBInstanceCache& ic = getInstanceCache(s);
 
@@ -3000,7 +3262,7 @@ multiplyByPVA(  const State&     s,
     // body spatial accelerations A=J*udot + Jdot*u, depending on how we're
     // interpreting the ulike argument (as a u for holonomic constraints,
     // and as udot for everything else).
-    Vector_<SpatialVec> Julike(nb);
+    Vector_<SpatialVec>& Julike = ws.bodyVecs;
     multiplyBySystemJacobian(s, ulike, Julike); // 12*(nu+nb) flops
 
     // Julike serves as V_GB when we're interpreting ulike as u.
@@ -3009,7 +3271,7 @@ multiplyByPVA(  const State&     s,
 
     // If we're doing any nonholonomic or acceleration-only constraints, we'll 
     // finish calculating body spatial accelerations and put them here.
-    Array_<SpatialVec,MobilizedBodyIndex> allA_GB;
+    Array_<SpatialVec,MobilizedBodyIndex>& allA_GB = ws.A_GB;
     if (mNonholo || mAccOnly) {
         allA_GB.resize(nb);
         const Array_<SpatialVec>& 
@@ -3021,7 +3283,8 @@ multiplyByPVA(  const State&     s,
     // If we're going to be dealing with holonomic (position) constraints,
     // generate a q-like Vector via qlike = N * ulike since the position
     // error derivative routine wants qdots.
-    Vector qlike(nq);
+    Vector& qlike = ws.qVec;
+    qlike.resize(nq);
     if (mHolo)
         multiplyByN(s, false, ulike, qlike);   // cheap
 
@@ -3034,20 +3297,21 @@ multiplyByPVA(  const State&     s,
 
     // This array will be resized and filled with the Ancestor-relative
     // velocities for the constrained bodies of each holonomic Constraint in 
-    // turn; we're declaring it outside the loop to minimize heap allocation 
-    // (resizing down doesn't normally free heap space). This won't be used 
-    // if we aren't processing holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> V_AB;
+    // turn; it lives in the workspace to avoid heap allocation (resizing 
+    // down doesn't normally free heap space). This won't be used if we 
+    // aren't processing holonomic constraints.
+    Array_<SpatialVec,ConstrainedBodyIndex>& V_AB = ws.consBodyVecs;
     // Same, but for each holonomic constraint's qdot subset.
-    Array_<Real,ConstrainedQIndex> qdot;
+    Array_<Real,ConstrainedQIndex>& qdot = ws.consQVals;
 
     // This array will be resized and filled with the Ancestor-relative
     // accelerations for the constrained bodies of each velocity
     // or acceleration-only Constraint in turn. This won't be used if we have 
-    // only holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
+    // only holonomic constraints. It is done with V_AB by the time it is
+    // needed so shares its memory.
+    Array_<SpatialVec,ConstrainedBodyIndex>& A_AB = ws.consBodyVecs;
     // Same, but for each nonholonomic/acconly constraint's udot subset.
-    Array_<Real,ConstrainedUIndex> udot;
+    Array_<Real,ConstrainedUIndex>& udot = ws.consUVals;
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output argument PVAu. Remove bias
@@ -3185,6 +3449,97 @@ calcPVA(const State&     s,
 
 
 
+// =============================================================================
+//                      FIND MASS-COUPLED CONSTRAINTS
+// =============================================================================
+// Called at the end of realizeInstance() to fill in the massCoupledConstraints
+// and gmInvGtGroups entries of the InstanceCache; see calcGMInvGt() for how
+// they are used. A Constraint acts on the branches (base bodies) of its 
+// Constrained Bodies and Constrained Mobilizers; the Ancestor body is always
+// inboard of those so doesn't add anything. Ground is not in any branch.
+//
+// The groups are built greedily in order of ConstraintIndex: each Constraint
+// goes in the first group in which none of its mass-coupled Constraints is
+// already coupled to a group member. A Constraint that acts only on Ground 
+// has no couplings and always goes in the first group.
+void SimbodyMatterSubsystemRep::
+findMassCoupledConstraints(const State& s, SBInstanceCache& ic) const {
+    const int nc = getNumConstraints();
+
+    // For each Constraint, the base bodies it acts on; and for each base body
+    // the Constraints acting on its branch. Both are sorted since we fill
+    // them in order.
+    Array_<Array_<MobilizedBodyIndex>,ConstraintIndex> branches(nc);
+    Array_<Array_<ConstraintIndex>,MobilizedBodyIndex> onBranch(getNumBodies());
+
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        ic.massCoupledConstraints[cx].clear();
+        if (isConstraintDisabled(s,cx))
+            continue;
+
+        const ConstraintImpl& crep = constraints[cx]->getImpl();
+        Array_<MobilizedBodyIndex>& cBranches = branches[cx];
+        for (ConstrainedBodyIndex cbx(0); 
+             cbx < crep.getNumConstrainedBodies(); ++cbx) 
+        {
+            const MobilizedBodyIndex mbx = 
+                crep.getMobilizedBodyIndexOfConstrainedBody(cbx);
+            if (mbx != GroundIndex) cBranches.push_back
+               (getMobilizedBody(mbx).getImpl().getMyBaseBodyMobilizedBodyIndex());
+        }
+        for (ConstrainedMobilizerIndex cmx(0); 
+             cmx < crep.getNumConstrainedMobilizers(); ++cmx) 
+        {
+            const MobilizedBodyIndex mbx = 
+                crep.getMobilizedBodyIndexOfConstrainedMobilizer(cmx);
+            if (mbx != GroundIndex) cBranches.push_back
+               (getMobilizedBody(mbx).getImpl().getMyBaseBodyMobilizedBodyIndex());
+        }
+        std::sort(cBranches.begin(), cBranches.end());
+        cBranches.erase(std::unique(cBranches.begin(), cBranches.end()),
+                        cBranches.end());
+        for (unsigned i=0; i < cBranches.size(); ++i)
+            onBranch[cBranches[i]].push_back(cx);
+    }
+
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        Array_<ConstraintIndex>& coupled = ic.massCoupledConstraints[cx];
+        for (unsigned i=0; i < branches[cx].size(); ++i) {
+            const Array_<ConstraintIndex>& others = onBranch[branches[cx][i]];
+            coupled.insert(coupled.end(), others.begin(), others.end());
+        }
+        std::sort(coupled.begin(), coupled.end());
+        coupled.erase(std::unique(coupled.begin(), coupled.end()), 
+                      coupled.end());
+    }
+
+    // inGroup[g][cx] is true if Constraint cx is coupled to some member of
+    // group g.
+    ic.gmInvGtGroups.clear();
+    Array_<Array_<bool,ConstraintIndex> > inGroup;
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        if (isConstraintDisabled(s,cx))
+            continue;
+        const Array_<ConstraintIndex>& coupled = ic.massCoupledConstraints[cx];
+        unsigned g = 0;
+        for (; g < ic.gmInvGtGroups.size(); ++g) {
+            unsigned i = 0;
+            while (i < coupled.size() && !inGroup[g][coupled[i]]) ++i;
+            if (i == coupled.size()) break; // no conflict
+        }
+        if (g == ic.gmInvGtGroups.size()) {
+            ic.gmInvGtGroups.push_back();
+            inGroup.push_back(Array_<bool,ConstraintIndex>(nc, false));
+        }
+        ic.gmInvGtGroups[g].push_back(cx);
+        for (unsigned i=0; i < coupled.size(); ++i)
+            inGroup[g][coupled[i]] = true;
+    }
+}
+//........................ FIND MASS-COUPLED CONSTRAINTS .......................
+
+
+
 // =============================================================================
 //                            CALC G MInv G^T
 // =============================================================================
@@ -3202,6 +3557,25 @@ calcPVA(const State&     s,
 // reasonable. One slip up and you'll toss in a factor of mn^2 or m^2n and
 // screw this up -- be careful!
 //
+// We do partition it. M is block diagonal by tree branch, so column j (for
+// an equation of Constraint c) can only be nonzero in the rows belonging to
+// Constraints that share a branch with c; we call those c's mass-coupled 
+// Constraints. If two Constraints have no mass-coupled Constraint in common
+// we can put a 1 in lambda for an equation of each and get both columns 
+// from a single operator sequence, because the nonzero parts of the two 
+// columns don't overlap. At Instance stage the enabled Constraints were 
+// grouped that way (see findMassCoupledConstraints()), so here we need only
+// one operator sequence per "round", where round r of a group handles the 
+// r'th equation of each Constraint in the group. For a system of many
+// loosely-connected mechanisms that is far fewer than m. All entries we 
+// don't fill in are known to be zero.
+//
+// The rounds are independent so they are divided among the tree sweep 
+// thread pool if parallel tree sweeps are enabled (see 
+// SimbodyMatterSubsystem::setUseParallelTreeSweeps()). Each round writes
+// only into its own columns so the results don't depend on the number of
+// threads.
+//
 // When there is prescribed motion in the system the matrix we want is
 // Gr Mrr^-1 ~Gr. That is still an mXm matrix and we are able to produce it
 // with no visible effort due to the definition of our a=M^-1*f operator. It 
@@ -3210,20 +3584,136 @@ calcPVA(const State&     s,
 // removing the Gp columns of G in the final operation. Note: the resulting
 // matrix is *not* a submatrix of G*M^-1*~G!
 //
-// Note that we do not require contiguous storage for GMInvGt's columns, 
-// although we'll take advantage of it if they are. If not, we'll work in
-// a contiguous temp and then copy back. This is because we want to allow
-// any matrix at the Simbody API level and we don't want to force the API
-// method to have to allocate a whole new mXm matrix when all we need for
-// a temporary here is an m-length temporary.
+// The output matrix need not have contiguous storage; we write it one
+// element at a time.
 //
-// Complexity is O(m^2 + m*n) = O(m*n).
+// Complexity is O(m^2 + r*n) where r <= m is the total number of rounds.
 //
 // TODO: as long as the force transmission matrix for all constraints is G^T
 // the resulting matrix is symmetric. But (a) I don't know how to take 
 // advantage of that in forming the matrix, and (b) some constraints may
 // result in the force transmission matrix != G (this occurs for example for
 // some kinds of "working" constraints like sliding friction).
+namespace {
+
+// Return the number of multipliers (acceleration constraint equations) 
+// belonging to a Constraint, and the index in the global multiplier array of
+// its k'th equation. Multipliers are ordered holonomic, nonholonomic, then 
+// acceleration-only.
+int getNumConstraintMultipliers(const SBInstancePerConstraintInfo& cInfo) {
+    return cInfo.holoErrSegment.length + cInfo.nonholoErrSegment.length
+           + cInfo.accOnlyErrSegment.length;
+}
+
+int getConstraintMultiplierIndex(const SBInstanceCache&             ic,
+                                 const SBInstancePerConstraintInfo& cInfo,
+                                 int                                k) {
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int mp = cInfo.holoErrSegment.length;
+    const int mv = cInfo.nonholoErrSegment.length;
+    if (k < mp) 
+        return cInfo.holoErrSegment.offset + k;
+    if (k < mp+mv) 
+        return mHolo + cInfo.nonholoErrSegment.offset + (k-mp);
+    return mHolo + mNonholo + cInfo.accOnlyErrSegment.offset + (k-mp-mv);
+}
+
+}
+
+void SimbodyMatterSubsystemRep::
+calcGMInvGtRound(const State&                   s,
+                 const Array_<ConstraintIndex>& group,
+                 int                            round,
+                 const Vector&                  bias,
+                 SBOperatorWorkspace&           ws,
+                 Matrix&                        GMInvGt) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+    Vector& lambda     = ws.lambda;
+    Vector& Gtcol      = ws.Gtcol;
+    Vector& MInvGtcol  = ws.MInvGtcol;
+    Vector& GMInvGtcol = ws.GMInvGtcol;
+
+    // Lambda is used to pluck out the sum of several columns of Gt. 
+    // It is all zero on entry and we must leave it that way.
+    for (unsigned i=0; i < group.size(); ++i) {
+        const SBInstancePerConstraintInfo& 
+            cInfo = ic.getConstraintInstanceInfo(group[i]);
+        if (round < getNumConstraintMultipliers(cInfo))
+            lambda[getConstraintMultiplierIndex(ic, cInfo, round)] = 1;
+    }
+
+    multiplyByPVATranspose(s, true, true, true, lambda, Gtcol, ws);
+    multiplyByMInv(s, Gtcol, MInvGtcol, ws);
+    multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGtcol, ws);
+
+    // Scatter each Constraint's column into the result, taking only the rows
+    // of its mass-coupled Constraints.
+    for (unsigned i=0; i < group.size(); ++i) {
+        const SBInstancePerConstraintInfo& 
+            cInfo = ic.getConstraintInstanceInfo(group[i]);
+        if (round >= getNumConstraintMultipliers(cInfo))
+            continue;
+        const int j = getConstraintMultiplierIndex(ic, cInfo, round);
+        lambda[j] = 0;
+
+        const Array_<ConstraintIndex>& 
+            coupled = ic.massCoupledConstraints[group[i]];
+        for (unsigned d=0; d < coupled.size(); ++d) {
+            const SBInstancePerConstraintInfo& 
+                dInfo = ic.getConstraintInstanceInfo(coupled[d]);
+            const int md = getNumConstraintMultipliers(dInfo);
+            for (int k=0; k < md; ++k) {
+                const int row = getConstraintMultiplierIndex(ic, dInfo, k);
+                GMInvGt(row,j) = GMInvGtcol[row];
+            }
+        }
+    }
+}
+
+namespace {
+
+// Computes the rounds of calcGMInvGt() on the tree sweep thread pool. The
+// task is executed once per workspace slot; each execution claims rounds
+// until there are none left, using only its own slot's workspace. 
+class GMInvGtRoundTask : public GuardedParallelTask {
+public:
+    GMInvGtRoundTask(const SimbodyMatterSubsystemRep&       matter,
+                     const State&                           s,
+                     const Array_<std::pair<int,int> >&     rounds,
+                     const Vector&                          bias,
+                     SBOperatorWorkspace&                   ws,
+                     Matrix&                                GMInvGt)
+    :   matter(matter), s(s), rounds(rounds), bias(bias), ws(ws), 
+        GMInvGt(GMInvGt), nextRound(0) {}
+
+    void executeGuarded(int slot) {
+        SBOperatorWorkspace& slotWs = ws.updWorker(slot);
+        const SBInstanceCache& ic = matter.getInstanceCache(s);
+        for (int i = nextRound++; i < (int)rounds.size(); i = nextRound++)
+            matter.calcGMInvGtRound(s, ic.gmInvGtGroups[rounds[i].first], 
+                                    rounds[i].second, bias, slotWs, GMInvGt);
+    }
+private:
+    const SimbodyMatterSubsystemRep&    matter;
+    const State&                        s;
+    const Array_<std::pair<int,int> >&  rounds;
+    const Vector&                       bias;
+    SBOperatorWorkspace&                ws;
+    Matrix&                             GMInvGt;
+    AtomicInteger                       nextRound;
+};
+
+// Make the multiplier Vector in a workspace all zero with length m, as
+// calcGMInvGtRound() requires.
+void initGMInvGtWorkspace(SBOperatorWorkspace& ws, int m) {
+    ws.lambda.resize(m);
+    ws.lambda.setToZero();
+}
+
+}
+
 void SimbodyMatterSubsystemRep::
 calcGMInvGt(const State&   s,
             Matrix&        GMInvGt) const
@@ -3235,41 +3725,51 @@ calcGMInvGt(const State&   s,
     const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
     const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
     const int m        = mHolo+mNonholo+mAccOnly;  
-    const int nu       = getNU(s);
 
     GMInvGt.resize(m,m);
     if (m==0) return;
+    GMInvGt.setToZero();
 
-    // If the output matrix doesn't have columns in contiguous memory, we'll
-    // allocate a contiguous-memory temp that we can use to hold one column
-    // at a time as we compute them.
-    const bool columnsAreContiguous = GMInvGt(0).hasContiguousData();
-    Vector GMInvGt_j(columnsAreContiguous ? 0 : m);
-
-    // These two temporaries are always needed to hold one column of Gt,
-    // then one column of M^-1 * Gt.
-    Vector Gtcol(nu), MInvGtcol(nu);
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
 
     // Precalculate bias so we can perform multiplication by G efficiently.
-    Vector bias(m);
+    Vector& bias = ws.bias;
     calcBiasForMultiplyByPVA(s,true,true,true,bias);
-   
-    // Lambda is used to pluck out one column at a time of Gt. Exactly one
-    // element at a time of lambda will be 1, the rest are 0.
-    Vector lambda(m, Real(0));
 
-    for (int j=0; j < m; ++j) {
-        lambda[j] = 1;
-        multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
-        lambda[j] = 0;
-        multiplyByMInv(s, Gtcol, MInvGtcol);
-        if (columnsAreContiguous)
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt(j));
-        else {
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt_j);
-            GMInvGt(j) = GMInvGt_j;
+    // List all the (group, round) pairs.
+    Array_<std::pair<int,int> >& rounds = ws.gmInvGtRounds;
+    rounds.clear();
+    for (int g=0; g < (int)ic.gmInvGtGroups.size(); ++g) {
+        const Array_<ConstraintIndex>& group = ic.gmInvGtGroups[g];
+        int nRounds = 0;
+        for (unsigned i=0; i < group.size(); ++i)
+            nRounds = std::max(nRounds, getNumConstraintMultipliers
+                                    (ic.getConstraintInstanceInfo(group[i])));
+        for (int r=0; r < nRounds; ++r)
+            rounds.push_back(std::make_pair(g,r));
+    }
+    const int nRounds = (int)rounds.size();
+
+    if (nRounds > 1 && useParallelTreeSweeps) {
+        // Set up one workspace per task slot before dispatching.
+        const int nSlots = std::min(nRounds, getNumParallelTreeSweepThreads());
+        for (int i=0; i < nSlots; ++i)
+            initGMInvGtWorkspace(ws.updWorker(i), m);
+        GMInvGtRoundTask task(*this, s, rounds, bias, ws, GMInvGt);
+        if (executeOnTreeSweepPool(task, nSlots)) {
+            SimTK_ERRCHK1_ALWAYS(!task.hasFailed(), 
+                "SimbodyMatterSubsystemRep::calcGMInvGt()",
+                "A parallel calculation of G M^-1 ~G failed: %s", 
+                task.getErrorMessage().c_str());
+            return;
         }
     }
+
+    // Serial: the State's workspace is reused for every round.
+    initGMInvGtWorkspace(ws, m);
+    for (int i=0; i < nRounds; ++i)
+        calcGMInvGtRound(s, ic.gmInvGtGroups[rounds[i].first], 
+                         rounds[i].second, bias, ws, GMInvGt);
 }  
 
 
@@ -4810,13 +5310,15 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     //     (G M^-1 ~G) lambda = aerr
     // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
     // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
+    // of O(n) operators. Then we'll factor it here in O(m^3) time. The
+    // matrix and factorization live in a per-State workspace so that their
+    // memory is reused as long as m doesn't change.
+    SBLoopForwardDynamicsWorkspace& ws = updLoopForwardDynamicsWorkspace(s);
+    calcGMInvGt(s, ws.GMInvGt);
     
     // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(udotErr, multipliers);
+    ws.GMInvGtQTZ.factor(ws.GMInvGt, conditioningTol); 
+    ws.GMInvGtQTZ.solve(udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
@@ -5000,22 +5502,12 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,dc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    sweepTipToBase(CalcUDotPass1InwardOp(ic,tpc,abc,dc,
+        mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+        hingeForcePtr));
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    sweepBaseToTip(CalcUDotPass2OutwardOp(sbs,ic,tpc,abc,tvc,dc, 
+        hingeForcePtr, aPtr, udotPtr, qdotdotPtr, tauPtr));
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5031,6 +5523,14 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
 void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     const Vector&                                           f,
     Vector&                                                 MInvf) const 
+{
+    multiplyByMInv(s, f, MInvf, updOperatorWorkspace(s));
+}
+
+void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
+    const Vector&                                           f,
+    Vector&                                                 MInvf,
+    SBOperatorWorkspace&                                    ws) const 
 {
     const SBInstanceCache&                  ic  = getInstanceCache(s);
     const SBTreePositionCache&              tpc = getTreePositionCache(s);
@@ -5050,8 +5550,11 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     assert(MInvf.hasContiguousData());
 
     // Temporaries
-    Array_<Real>        eps(nu);
-    Array_<SpatialVec>  z(nb), zPlus(nb), A_GB(nb);
+    Array_<Real>& eps = ws.eps;
+    Array_<SpatialVec,MobilizedBodyIndex>& z = ws.z;
+    Array_<SpatialVec,MobilizedBodyIndex>& zPlus = ws.zPlus;
+    Array_<SpatialVec,MobilizedBodyIndex>& A_GB = ws.A_GB;
+    eps.resize(nu); z.resize(nb); zPlus.resize(nb); A_GB.resize(nb);
 
     // Point to raw data of input arguments.
     const Real* fPtr     = &f[0];       
@@ -5106,8 +5609,10 @@ void SimbodyMatterSubsystemRep::multiplyBySqrtMInv(const State& s,
     assert(MInvf.hasContiguousData());
 
     // Temporaries
-    Array_<Real>        eps(nu);
-    Array_<SpatialVec>  z(nb), zPlus(nb), A_GB(nb);
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Array_<Real>& eps = ws.eps;
+    Array_<SpatialVec,MobilizedBodyIndex>& A_GB = ws.A_GB;
+    eps.resize(nu); A_GB.resize(nb);
 
     // Point to raw data of input arguments.
     const Real* fPtr     = &f[0];       
@@ -5173,8 +5678,10 @@ void SimbodyMatterSubsystemRep::calcDetM(const State& s,
     assert(MInvf.hasContiguousData());
 
     // Temporaries
-    Array_<Real>        eps(nu);
-    Array_<SpatialVec>  z(nb), zPlus(nb), A_GB(nb);
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Array_<Real>& eps = ws.eps;
+    Array_<SpatialVec,MobilizedBodyIndex>& A_GB = ws.A_GB;
+    eps.resize(nu); A_GB.resize(nb);
 
     // Point to raw data of input arguments.
     const Real* fPtr     = &f[0];       
@@ -5195,6 +5702,69 @@ void SimbodyMatterSubsystemRep::calcDetM(const State& s,
 //............................. EU CALC DET M INVERSE F  EU ...............................
 
 
+
+//==============================================================================
+//                              CALC LOG DET M
+//==============================================================================
+// log(det(M)) is the sum of log(det(D)) over the articulated body D's; see
+// RigidBodyNodeSpec::calcLogDetD(). The nodes can be done in any order.
+Real SimbodyMatterSubsystemRep::calcLogDetM(const State& s) const {
+    realizeArticulatedBodyInertias(s); // (may already have been realized)
+    const SBInstanceCache&               ic  = getInstanceCache(s);
+    const SBArticulatedBodyInertiaCache& abc = getArticulatedBodyInertiaCache(s);
+
+    Real logDetM = 0;
+    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
+        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
+            logDetM += rbNodeLevels[i][j]->calcLogDetD(ic, abc);
+    return logDetM;
+}
+
+
+
+//==============================================================================
+//                      MULTIPLY BY SQRT M INV (BATCHED)
+//==============================================================================
+// Calculate sqrt(M^-1)*eps for every column of eps in one base-to-tip sweep.
+// All Matrices must use contiguous storage.
+void SimbodyMatterSubsystemRep::multiplyBySqrtMInv(const State& s,
+    const Matrix&                                           eps,
+    Matrix&                                                 sqrtMInvEps) const
+{
+    realizeArticulatedBodyInertias(s); // (may already have been realized)
+    const SBInstanceCache&               ic  = getInstanceCache(s);
+    const SBTreePositionCache&           tpc = getTreePositionCache(s);
+    const SBArticulatedBodyInertiaCache& abc = getArticulatedBodyInertiaCache(s);
+
+    const int nb   = getNumBodies();
+    const int nu   = getNU(s);
+    const int nVec = eps.ncol();
+
+    assert(eps.nrow() == nu);
+
+    sqrtMInvEps.resize(nu, nVec);
+    if (nu==0 || nVec==0)
+        return;
+
+    assert(eps.hasContiguousData());
+    assert(sqrtMInvEps.hasContiguousData());
+
+    // Temporary: nVec body accelerations per node, stored by node.
+    Array_<SpatialVec,MobilizedBodyIndex>& A_GB = updOperatorWorkspace(s).A_GB;
+    A_GB.resize(nb*nVec);
+
+    const Real* epsPtr  = &eps(0,0);
+    Real*       udotPtr = &sqrtMInvEps(0,0);
+
+    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
+        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
+            const RigidBodyNode& node = *rbNodeLevels[i][j];
+            node.multiplyBySqrtMInvBatchOutward(ic,tpc,abc,nVec,nu,
+                epsPtr, A_GB.begin(), udotPtr);
+        }
+}
+
+
 //==============================================================================
 //                              MULTIPLY BY M
 //==============================================================================
@@ -5220,7 +5790,10 @@ void SimbodyMatterSubsystemRep::multiplyByM(const State&    s,
     assert(Ma.hasContiguousData());
 
     // Temporaries
-    Array_<SpatialVec>  fTmp(nb), A_GB(nb);
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Array_<SpatialVec,MobilizedBodyIndex>& fTmp = ws.z;
+    Array_<SpatialVec,MobilizedBodyIndex>& A_GB = ws.A_GB;
+    fTmp.resize(nb); A_GB.resize(nb);
 
     // Point to raw data of input arguments.
     const Real* aPtr    = &a[0];       
@@ -5256,19 +5829,15 @@ void SimbodyMatterSubsystemRep::calcM(const State& s, Matrix& M) const {
     // only half of it. As a placeholder, however, we're doing this with 
     // repeated O(n) calls to multiplyByM() to get M one column at a time.
 
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = M(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
-
-    Vector v(nu); v.setToZero();
+    // Each column is calculated into a workspace Vector and then copied
+    // element by element; taking a column view M(i) would allocate.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Vector& col = ws.col; col.resize(nu);
+    Vector& v = ws.unitCol; v.resize(nu); v.setToZero();
     for (int i=0; i < nu; ++i) {
         v[i] = 1;
-        if (isContiguous) {
-            multiplyByM(s, v, M(i));
-        } else {
-            multiplyByM(s, v, contig_col);
-            M(i) = contig_col;
-        }
+        multiplyByM(s, v, col);
+        for (int r=0; r < nu; ++r) M(r,i) = col[r];
         v[i] = 0;
     }
 }
@@ -5290,19 +5859,15 @@ void SimbodyMatterSubsystemRep::calcMInv(const State& s, Matrix& MInv) const {
     // filling in only half. For now we're doing it with repeated calls to
     // the O(n) operator multiplyByMInv().
 
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = MInv(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
-
-    Vector f(nu); f.setToZero();
+    // Each column is calculated into a workspace Vector and then copied
+    // element by element; taking a column view MInv(i) would allocate.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Vector& col = ws.col; col.resize(nu);
+    Vector& f = ws.unitCol; f.resize(nu); f.setToZero();
     for (int i=0; i < nu; ++i) {
         f[i] = 1;
-        if (isContiguous) {
-            multiplyByMInv(s, f, MInv(i));
-        } else {
-            multiplyByMInv(s, f, contig_col);
-            MInv(i) = contig_col;
-        }
+        multiplyByMInv(s, f, col);
+        for (int r=0; r < nu; ++r) MInv(r,i) = col[r];
         f[i] = 0;
     }
 }
@@ -5318,24 +5883,15 @@ void SimbodyMatterSubsystemRep::calcSqrtMInv(const State& s, Matrix& MInv) const
     MInv.resize(nu,nu);
     if (nu==0) return;
 
-    // This could probably be calculated faster by doing it directly and
-    // filling in only half. For now we're doing it with repeated calls to
-    // the O(n) operator multiplyByMInv().
-
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = MInv(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
-
-    Vector f(nu); f.setToZero();
-    for (int i=0; i < nu; ++i) {
-        f[i] = 1;
-        if (isContiguous) {
-            multiplyBySqrtMInv(s, f, MInv(i));
-        } else {
-            multiplyBySqrtMInv(s, f, contig_col);
-            MInv(i) = contig_col;
-        }
-        f[i] = 0;
+    // Apply the batched O(n) operator to all the columns of the identity
+    // matrix in a single sweep.
+    Matrix identity(nu,nu); identity = 1;
+    if (MInv.hasContiguousData()) {
+        multiplyBySqrtMInv(s, identity, MInv);
+    } else {
+        Matrix contig;
+        multiplyBySqrtMInv(s, identity, contig);
+        MInv = contig;
     }
 }
 // EU END
@@ -5409,8 +5965,9 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
     assert(residualMobilityForces.hasContiguousData());
 
 
-    // Allocate temporary.
-    Vector_<SpatialVec> allFTmp(getNumBodies());
+    // Temporary from the workspace.
+    Array_<SpatialVec,MobilizedBodyIndex>& allFTmp = updOperatorWorkspace(s).z;
+    allFTmp.resize(getNumBodies());
 
     // Make pointers to (contiguous) Vector data for fast access.
     const Real* knownUdotPtr = &(*pKnownUdot)[0];
@@ -5421,7 +5978,7 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
                                      ? &(*pAppliedBodyForces)[0] : NULL;
     Real *residualPtr = residualMobilityForces.size() 
                         ? &residualMobilityForces[0] : NULL;
-    SpatialVec* tempPtr = allFTmp.size() ? &allFTmp[0] : NULL;
+    SpatialVec* tempPtr = allFTmp.begin();
 
     for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
         for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
@@ -6152,6 +6709,15 @@ void SimbodyMatterSubsystemRep::multiplyBySystemJacobianTranspose
    (const State&                s, 
     const Vector_<SpatialVec>&  X,
     Vector&                     JtX) const
+{
+    multiplyBySystemJacobianTranspose(s, X, JtX, updOperatorWorkspace(s));
+}
+
+void SimbodyMatterSubsystemRep::multiplyBySystemJacobianTranspose
+   (const State&                s, 
+    const Vector_<SpatialVec>&  X,
+    Vector&                     JtX,
+    SBOperatorWorkspace&        ws) const
 {
     assert(X.size() == getNumBodies());
     JtX.resize(getNU(s));
@@ -6160,10 +6726,11 @@ void SimbodyMatterSubsystemRep::multiplyBySystemJacobianTranspose
 
     const SBTreePositionCache& tpc = getTreePositionCache(s);
 
-    Vector_<SpatialVec> zTemp(getNumBodies()); zTemp.setToZero();
+    Array_<SpatialVec,MobilizedBodyIndex>& zTemp = ws.z;
+    zTemp.resize(getNumBodies()); zTemp.fill(SpatialVec(Vec3(0),Vec3(0)));
     const SpatialVec* xPtr = X.size() ? &X[0] : NULL;
     Real* jtxPtr = JtX.size() ? &JtX[0] : NULL;
-    SpatialVec* zPtr = zTemp.size() ? &zTemp[0] : NULL;
+    SpatialVec* zPtr = zTemp.begin();
 
     for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--)
         for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
@@ -6196,10 +6763,11 @@ void SimbodyMatterSubsystemRep::calcTreeEquivalentMobilityForces(const State& s,
     assert(bodyForces.hasContiguousData());
     assert(mobilityForces.hasContiguousData());
 
-    Vector_<SpatialVec> allZ(getNumBodies());
+    Array_<SpatialVec,MobilizedBodyIndex>& allZ = updOperatorWorkspace(s).z;
+    allZ.resize(getNumBodies());
     const SpatialVec* bodyForcePtr = bodyForces.size() ? &bodyForces[0] : NULL;
     Real* mobilityForcePtr = mobilityForces.size() ? &mobilityForces[0] : NULL;
-    SpatialVec* zPtr = allZ.size() ? &allZ[0] : NULL;
+    SpatialVec* zPtr = allZ.begin();
 
     // Don't do ground's level since ground has no inboard joint.
     for (int i=rbNodeLevels.size()-1 ; i>0 ; i--) 
@@ -38,6 +38,7 @@
 #include <set>
 #include <map>
 #include <utility> // std::pair
+#include <pthread.h>
 using std::pair;
 
 
@@ -140,8 +141,12 @@ private:
 class SimbodyMatterSubsystemRep : public SimTK::Subsystem::Guts {
 public:
     SimbodyMatterSubsystemRep() 
-      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
+      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1"),
+        useParallelTreeSweeps(false), 
+        parallelTreeSweepThreshold(DefaultParallelTreeSweepThreshold),
+        numParallelTreeSweepThreads(0), treeSweepExecutor(0)
     { 
+        pthread_mutex_init(&treeSweepLock, NULL);
         clearTopologyCache();
     }
 
@@ -156,6 +161,8 @@ public:
         invalidateSubsystemTopologyCache();
         clearTopologyCache(); // should do cache before state
         clearTopologyState();
+        delete treeSweepExecutor;
+        pthread_mutex_destroy(&treeSweepLock);
     }
 
     SimbodyMatterSubsystemRep* cloneImpl() const {
@@ -464,6 +471,11 @@ public:
     void multiplyBySystemJacobianTranspose(const State&, 
         const Vector_<SpatialVec>& X, 
         Vector&                    JtX) const;
+    // Same, using the supplied workspace rather than the State's.
+    void multiplyBySystemJacobianTranspose(const State&, 
+        const Vector_<SpatialVec>& X, 
+        Vector&                    JtX,
+        SBOperatorWorkspace&       ws) const;
 
     // Given a set of body forces, return the equivalent set of mobilizer torques 
     // IGNORING CONSTRAINTS.
@@ -497,6 +509,12 @@ public:
     void multiplyByMInv(const State&    s,
         const Vector&                   f,
         Vector&                         MInvf) const; 
+    // Same, using the supplied workspace rather than the State's. Parallel
+    // tasks use this to give each task its own temporaries.
+    void multiplyByMInv(const State&    s,
+        const Vector&                   f,
+        Vector&                         MInvf,
+        SBOperatorWorkspace&            ws) const; 
 
     // Multiply by the square root mass matrix inverse in O(n) time. Works only with the
     // non-prescribed submatrix Mrr of M; entries f_p in f are not accessed,
@@ -513,6 +531,19 @@ public:
         Vector&                         MInvf,
         Matrix&                         D0) const; // EU
 
+    // Calculate log(det(Mrr)) in O(n) time from the articulated body 
+    // inertias, which are realized here if necessary. Prescribed mobilities
+    // are excluded, as for multiplyByMInv().
+    Real calcLogDetM(const State& s) const;
+
+    // Multiply each column of eps by sqrt(Mrr^-1) in a single outward sweep,
+    // realizing articulated body inertias first if needed. eps and 
+    // sqrtMInvEps must be nu X nVec with contiguous (column-major) storage;
+    // entries for prescribed mobilities are set to zero.
+    void multiplyBySqrtMInv(const State&    s,
+        const Matrix&                       eps,
+        Matrix&                             sqrtMInvEps) const;
+
     // Calculate the mass matrix in O(n^2) time. State must have already
     // been realized to Position stage. M must be resizeable or already the
     // right size (nXn). The result is symmetric but the entire matrix is
@@ -740,6 +771,14 @@ public:
                                 bool             includeA,
                                 const Vector&    lambda,
                                 Vector&          fu) const;
+    // Same, using the supplied workspace rather than the State's.
+    void multiplyByPVATranspose(const State&         state,
+                                bool                 includeP,
+                                bool                 includeV,
+                                bool                 includeA,
+                                const Vector&        lambda,
+                                Vector&              fu,
+                                SBOperatorWorkspace& ws) const;
 
     // Explicitly form the u-space constraint Jacobian transpose 
     // ~G=[~P ~V ~A] or selected submatrices of it. Performance is best if the 
@@ -812,6 +851,15 @@ public:
                        const Vector&    bias,
                        const Vector&    ulike,
                        Vector&          PVAu) const;
+    // Same, using the supplied workspace rather than the State's.
+    void multiplyByPVA(const State&         state,
+                       bool                 includeP,
+                       bool                 includeV,
+                       bool                 includeA,
+                       const Vector&        bias,
+                       const Vector&        ulike,
+                       Vector&              PVAu,
+                       SBOperatorWorkspace& ws) const;
 
     // Explicitly form the u-space constraint Jacobian G=[P;V;A] or 
     // selected submatrices of it. Performance is best if the output matrix 
@@ -858,6 +906,18 @@ public:
     void calcGMInvGt(const State&   state,
                      Matrix&        GMInvGt) const;
 
+    // Calculate the columns of G M^-1 ~G for equation number "round" of each
+    // Constraint in the given group (see calcGMInvGt()), and write their 
+    // nonzero entries into GMInvGt. All the temporaries come from the given
+    // workspace, whose lambda must be all zero and of length m on entry; it
+    // is left that way.
+    void calcGMInvGtRound(const State&                   state,
+                          const Array_<ConstraintIndex>& group,
+                          int                            round,
+                          const Vector&                  bias,
+                          SBOperatorWorkspace&           ws,
+                          Matrix&                        GMInvGt) const;
+
     // Given an array of nu udots, return nb body accelerations in G (including
     // Ground as the 0th body with A_GB[0]=0). The returned accelerations are
     // A = J*udot + Jdot*u, with the Jdot*u (coriolis acceleration) term
@@ -1031,6 +1091,15 @@ public:
             (s.updCacheEntry(getMySubsystemIndex(),getModelCache(s).constrainedAccelerationCacheIndex)).upd();
     }
 
+    SBLoopForwardDynamicsWorkspace& updLoopForwardDynamicsWorkspace(const State& s) const { //mutable
+        return Value<SBLoopForwardDynamicsWorkspace>::downcast
+            (s.updCacheEntry(getMySubsystemIndex(),getModelCache(s).loopForwardDynamicsWorkspaceIndex)).upd();
+    }
+    SBOperatorWorkspace& updOperatorWorkspace(const State& s) const { //mutable
+        return Value<SBOperatorWorkspace>::downcast
+            (s.updCacheEntry(getMySubsystemIndex(),getModelCache(s).operatorWorkspaceIndex)).upd();
+    }
+
 
     const SBModelVars& getModelVars(const State& s) const {
         return Value<SBModelVars>::downcast
@@ -1102,7 +1171,48 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    // Control over parallel execution of the level-by-level tree sweeps.
+    // These don't change any results so they don't invalidate anything.
+    bool getUseParallelTreeSweeps() const {return useParallelTreeSweeps;}
+    void setUseParallelTreeSweeps(bool useParallel)
+    {   useParallelTreeSweeps = useParallel; }
+    int getParallelTreeSweepThreshold() const 
+    {   return parallelTreeSweepThreshold; }
+    void setParallelTreeSweepThreshold(int minNodesPerLevel);
+    int getNumParallelTreeSweepThreads() const;
+    void setNumParallelTreeSweepThreads(int numThreads);
+
+    // This is an operation to be performed on each RigidBodyNode during a
+    // base-to-tip or tip-to-base sweep. An implementation may write only into
+    // the cache entries belonging to the node it is given (it may read its
+    // parent's entries on an outward sweep or its children's on an inward
+    // sweep). That makes all the nodes at one level independent, so a level
+    // can be processed in parallel without changing any results.
+    class NodeOperation {
+    public:
+        virtual ~NodeOperation() {}
+        virtual void apply(const RigidBodyNode& node) const = 0;
+    };
+
+    // Apply the operation to every node at levels firstLevel and higher,
+    // level by level, starting at firstLevel and moving outward.
+    void sweepBaseToTip(const NodeOperation& op, int firstLevel=0) const;
+    // Apply the operation to every node at levels firstLevel and higher,
+    // level by level, starting at the terminal level and moving inward.
+    void sweepTipToBase(const NodeOperation& op, int firstLevel=0) const;
+
 private:
+    // Run task.execute() for indices 0..times-1 on the tree sweep thread 
+    // pool and return true, or return false without running anything if 
+    // parallel sweeps are off or the pool isn't available right now. In that
+    // case the caller must do the work serially.
+    bool executeOnTreeSweepPool(ParallelExecutor::Task& task, int times) const;
+    // Apply the operation to all the nodes at one level, in parallel if 
+    // that has been requested and the level is wide enough to be worth it.
+    void applyToLevel(int level, const NodeOperation& op) const;
+    // Group the enabled constraints for calcGMInvGt(); called at the end of
+    // realizeInstance() once all the constraints have been instantiated.
+    void findMassCoupledConstraints(const State& s, SBInstanceCache& ic) const;
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1327,6 +1437,23 @@ private:
     
     // Specifies whether default decorative geometry should be shown.
     bool showDefaultGeometry;
+
+        // PARALLEL TREE SWEEPS
+
+    // Levels with fewer nodes than this are always swept serially since the
+    // cost of dispatching them to the thread pool would exceed the savings.
+    static const int DefaultParallelTreeSweepThreshold = 64;
+
+    bool useParallelTreeSweeps;
+    int  parallelTreeSweepThreshold;
+    int  numParallelTreeSweepThreads; // 0 means one per processor
+
+    // The thread pool is created on first use and then persists until the
+    // thread count is changed or this subsystem is destroyed. The lock keeps
+    // concurrent realizations (of different States) from using the pool at 
+    // the same time; whoever doesn't get it just sweeps serially.
+    mutable ParallelExecutor*   treeSweepExecutor;
+    mutable pthread_mutex_t     treeSweepLock;
 };
 
 std::ostream& operator<<(std::ostream&, const SimbodyMatterSubsystemRep&);
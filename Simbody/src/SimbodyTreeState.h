@@ -64,6 +64,7 @@ Whatever so that it can calculate results and put them in the cache (which is
 allocated if necessary), and then advance to stage Whatever. */
 
 #include "simbody/internal/common.h"
+#include "simmath/LinearAlgebra.h"
 
 #include <cassert>
 #include <iostream>
@@ -259,7 +260,9 @@ public:
                           compositeBodyInertiaCacheIndex, articulatedBodyInertiaCacheIndex,
                           treeVelocityCacheIndex, constrainedVelocityCacheIndex,
                           dynamicsCacheIndex, 
-                          treeAccelerationCacheIndex, constrainedAccelerationCacheIndex;
+                          treeAccelerationCacheIndex, constrainedAccelerationCacheIndex,
+                          loopForwardDynamicsWorkspaceIndex,
+                          operatorWorkspaceIndex;
 
 private:
     // MobilizedBody 0 is Ground.
@@ -488,6 +491,21 @@ public:
     {   return constraintInstanceInfo[cx]; }
     Array_<SBInstancePerConstraintInfo,ConstraintIndex> constraintInstanceInfo;
 
+    // The mass matrix M is block diagonal with one block per branch of the
+    // multibody tree (a base body attached to Ground and all its outboard
+    // bodies), so two enabled Constraints can only be coupled in G M^-1 ~G 
+    // if they act on a common branch. For each enabled Constraint this lists
+    // all the enabled Constraints (including itself) with which it shares a
+    // branch, in order of ConstraintIndex; it is empty for disabled 
+    // Constraints and for those that act only on Ground.
+    Array_<Array_<ConstraintIndex>,ConstraintIndex> massCoupledConstraints;
+
+    // Enabled Constraints grouped so that no two Constraints in a group have
+    // a mass-coupled Constraint in common. All the Constraints in a group
+    // can thus contribute a column to G M^-1 ~G from a single pass through
+    // the multiplyBy...() operators; see calcGMInvGt().
+    Array_<Array_<ConstraintIndex> > gmInvGtGroups;
+
     // This is a sum over all the mobilizers whose q's are currently prescribed,
     // adding the number of q's (generalized coordinates) nq currently being 
     // used for each of those. An array of size totalNPresQ is allocated in the 
@@ -581,6 +599,8 @@ public:
         mobodInstanceInfo.resize(topo.nBodies);
 
         constraintInstanceInfo.resize(topo.nConstraints);
+        massCoupledConstraints.resize(topo.nConstraints);
+        gmInvGtGroups.clear();
         firstQuaternionQErrSlot = qErrIndex = uErrIndex = udotErrIndex = -1;
 
         totalNHolonomicConstraintEquationsInUse        = 0;
@@ -1191,6 +1211,111 @@ public:
 
 
 
+// =============================================================================
+//                      LOOP FORWARD DYNAMICS WORKSPACE
+// =============================================================================
+// This is scratch space for calcLoopForwardDynamicsOperator(): the m X m
+// matrix G M^-1 ~G and its factorization. Nothing here is ever valid across
+// calls; it is kept in the State only so that the memory (including the 
+// FactorQTZ's internal arrays) can be reused from one realizeAcceleration()
+// to the next as long as the number of constraint equations in use doesn't
+// change. It is kept per-State so that different States can be realized 
+// concurrently.
+//
+// Copying the workspace (e.g. when a State is copied) deliberately produces
+// an empty one since the contents would be overwritten before use anyway.
+
+class SBLoopForwardDynamicsWorkspace {
+public:
+    SBLoopForwardDynamicsWorkspace() {}
+    SBLoopForwardDynamicsWorkspace(const SBLoopForwardDynamicsWorkspace&) {}
+    SBLoopForwardDynamicsWorkspace& 
+    operator=(const SBLoopForwardDynamicsWorkspace&) {return *this;}
+
+    Matrix      GMInvGt;    // m X m
+    FactorQTZ   GMInvGtQTZ; // factorization of GMInvGt
+};
+//..................... LOOP FORWARD DYNAMICS WORKSPACE .......................
+
+
+
+// =============================================================================
+//                            OPERATOR WORKSPACE
+// =============================================================================
+// This is scratch space for the O(n) operators like multiplyByM(), 
+// multiplyByMInv(), multiplyByPVA() and their transposes, and for the O(n^2)
+// and O(mn) methods like calcMInv() and calcGMInvGt() that call them 
+// repeatedly. Arrays are resized on each use but their heap space is kept, so
+// once a State has been through an operator once, further calls with the same
+// problem dimensions do no heap allocation. Like the loop forward dynamics
+// workspace, nothing here is valid across calls and copying produces an empty
+// workspace. Because the workspace is per-State, operators on the same State
+// must not be invoked concurrently from several threads.
+//
+// The groups of members below are used at different levels of nesting, so a
+// method may use its own group while it calls an operator that uses a lower
+// group. For example, calcGMInvGt() holds the multiplier and column Vectors 
+// while it calls multiplyByPVATranspose(), which holds the constraint body
+// forces while it calls multiplyBySystemJacobianTranspose(), which uses the 
+// tree sweep temporaries.
+//
+// When calcGMInvGt() runs on the tree sweep thread pool each task slot gets 
+// its own workspace, kept here in workers[].
+
+class SBOperatorWorkspace {
+public:
+    SBOperatorWorkspace() {}
+    SBOperatorWorkspace(const SBOperatorWorkspace&) {}
+    SBOperatorWorkspace& 
+    operator=(const SBOperatorWorkspace&) {return *this;}
+    ~SBOperatorWorkspace() {
+        for (unsigned i=0; i < workers.size(); ++i)
+            delete workers[i];
+    }
+
+    // Return the workspace for task slot i, allocating it if necessary. 
+    // Allocation isn't thread safe, so this must be called for every slot
+    // before the tasks are dispatched.
+    SBOperatorWorkspace& updWorker(int i) {
+        while ((int)workers.size() <= i)
+            workers.push_back(new SBOperatorWorkspace());
+        return *workers[i];
+    }
+
+    // Tree sweep temporaries: per-mobility eps and per-body z, zPlus, and 
+    // A_GB (which holds nb*nVec entries for the batched operators).
+    Array_<Real>                            eps;
+    Array_<SpatialVec,MobilizedBodyIndex>   z, zPlus, A_GB;
+
+    // Constraint operator temporaries: body spatial vectors and u- and 
+    // q-like vectors for all bodies and mobilities, then the subsets of 
+    // those belonging to one Constraint at a time.
+    Vector_<SpatialVec>                     bodyVecs;   // nb
+    Vector                                  uVec, qVec; // nu, nq
+    Array_<SpatialVec,ConstrainedBodyIndex> consBodyVecs;
+    Array_<Real,ConstrainedUIndex>          consUVals;
+    Array_<Real,ConstrainedQIndex>          consQVals;
+
+    // Coriolis accelerations and all-zero inputs for one Constraint at a 
+    // time, used when calculating the bias for multiplying by P, V, and A.
+    Array_<SpatialVec,ConstrainedBodyIndex> consBodyAccs, zeroConsBodyVecs;
+    Array_<Real,ConstrainedUIndex>          zeroConsUVals;
+    Array_<Real,ConstrainedQIndex>          zeroConsQVals;
+
+    // Columns for methods that form a matrix one operator call at a time.
+    Vector  unitCol, col;                           // nu, for calcM/MInv
+    Vector  lambda, Gtcol, MInvGtcol, GMInvGtcol;   // for calcGMInvGt
+    Vector  bias;                                   // m
+    Vector  biasp, Pqcol;                           // mp, for calcPq
+    Array_<std::pair<int,int> > gmInvGtRounds;      // (group, round) pairs
+
+private:
+    Array_<SBOperatorWorkspace*> workers;
+};
+//............................ OPERATOR WORKSPACE ..............................
+
+
+
 
 /* 
  * Generalized state variable collection for a SimbodyMatterSubsystem. 
@@ -1378,6 +1503,10 @@ inline std::ostream& operator<<(std::ostream& o, const SBTreeAccelerationCache&
   { return o << "TODO: SBTreeAccelerationCache"; }
 inline std::ostream& operator<<(std::ostream& o, const SBConstrainedAccelerationCache& c)
   { return o << "TODO: SBConstrainedAccelerationCache"; }
+inline std::ostream& operator<<(std::ostream& o, const SBLoopForwardDynamicsWorkspace& c)
+  { return o << "TODO: SBLoopForwardDynamicsWorkspace"; }
+inline std::ostream& operator<<(std::ostream& o, const SBOperatorWorkspace& c)
+  { return o << "TODO: SBOperatorWorkspace"; }
 
 inline std::ostream& operator<<(std::ostream& o, const SBModelVars& c)
   { return o << "TODO: SBModelVars"; }
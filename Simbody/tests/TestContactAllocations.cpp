@@ -0,0 +1,211 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that steady-state contact processing doesn't touch the heap once its
+// reusable workspace has grown to size: the broad phase, its pair table, and
+// the active contact snapshot in ContactTrackerSubsystem, and the per-contact
+// work done by ElasticFoundationForce. We count allocations by replacing the
+// global operator new (see AllocationCounter.h).
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+#include "AllocationCounter.h"
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Many spheres packed closely enough that there are lots of overlapping
+// bubbles, then jiggled a little each step.
+void testBroadPhaseIsAllocationFree() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    ContactTrackerSubsystem tracker(system);
+    ContactMaterial material(1e6, 0, .5, .5, .5);
+
+    const int n = 125;
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    body.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Sphere(.6), material));
+    for (int i=0; i < n; ++i)
+        MobilizedBody::Free(matter.Ground(), Vec3(i%5, (i/5)%5, i/25),
+                            body, Vec3(0));
+    SimTK_TEST(tracker.getBroadPhaseMethod() 
+               == ContactTrackerSubsystem::IncrementalSweepAndPrune);
+
+    State state = system.realizeTopology();
+    Random::Uniform rand(-.02, .02);
+    rand.setSeed(7);
+    Array_<std::pair<ContactSurfaceIndex,ContactSurfaceIndex> > pairs;
+    for (int step=0; step < 20; ++step) {
+        for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] += rand.getValue();
+        system.realize(state, Stage::Position);
+        const int before = allocationCount;
+        tracker.findBroadPhasePairs(state, pairs);
+        const int allocations = allocationCount - before;
+        SimTK_TEST(!pairs.empty());
+        // The first couple of evaluations grow the workspace.
+        if (step >= 2) SimTK_TEST(allocations == 0);
+    }
+}
+
+// Spheres that just touch their neighbors, jiggled so that contacts keep 
+// starting and breaking. Each tracked Contact is a new object, since the 
+// previous one is still held by the State, but updating the active contacts
+// must allocate nothing else: the snapshot's tables, the pair table, and the
+// stand-in for pairs with no history are all reused. The integrator advances
+// the State with autoUpdateDiscreteVariables() after each step; doing that 
+// here hands the snapshot storage back and forth as it does.
+void testActiveContactsReuseSnapshot() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    ContactTrackerSubsystem tracker(system);
+    ContactMaterial material(1e6, 0, .5, .5, .5);
+
+    const int n = 64;
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    body.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Sphere(.5), material));
+    for (int i=0; i < n; ++i)
+        MobilizedBody::Free(matter.Ground(), Vec3(i%4, (i/4)%4, i/16),
+                            body, Vec3(0));
+
+    State state = system.realizeTopology();
+    Random::Uniform rand(-.02, .02);
+    rand.setSeed(11);
+    int numTracked = 0;
+    for (int step=0; step < 20; ++step) {
+        for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] += rand.getValue();
+        system.realize(state, Stage::Position);
+        const int before = allocationCount;
+        const ContactSnapshot& active = tracker.getActiveContacts(state);
+        const int allocations = allocationCount - before;
+        numTracked += active.getNumContacts();
+        // The first couple of evaluations grow the storage.
+        if (step >= 2) SimTK_TEST(allocations == active.getNumContacts());
+        state.autoUpdateDiscreteVariables();
+    }
+    SimTK_TEST(numTracked > 0);
+}
+
+// Make a closed triangle mesh approximating a sphere by repeatedly 
+// subdividing an octahedron.
+static ContactGeometry::TriangleMesh makeSphereMesh(Real radius, int levels) {
+    std::vector<Vec3> vertices;
+    std::vector<int>  faces;
+    vertices.push_back(Vec3( 1,0,0)); vertices.push_back(Vec3(-1,0,0));
+    vertices.push_back(Vec3(0, 1,0)); vertices.push_back(Vec3(0,-1,0));
+    vertices.push_back(Vec3(0,0, 1)); vertices.push_back(Vec3(0,0,-1));
+    const int octa[8][3] = {{0,2,4},{2,1,4},{1,3,4},{3,0,4},
+                            {2,0,5},{1,2,5},{3,1,5},{0,3,5}};
+    for (int f=0; f < 8; ++f)
+        for (int k=0; k < 3; ++k) faces.push_back(octa[f][k]);
+
+    for (int level=0; level < levels; ++level) {
+        std::map<std::pair<int,int>,int> midpoints;
+        std::vector<int> newFaces;
+        for (int f=0; f < (int)faces.size()/3; ++f) {
+            int mid[3];
+            for (int k=0; k < 3; ++k) {
+                int a = faces[3*f+k], b = faces[3*f+(k+1)%3];
+                if (a > b) std::swap(a,b);
+                std::map<std::pair<int,int>,int>::iterator p = 
+                    midpoints.find(std::make_pair(a,b));
+                if (p == midpoints.end()) {
+                    vertices.push_back(UnitVec3(vertices[a]+vertices[b]));
+                    p = midpoints.insert(std::make_pair(std::make_pair(a,b),
+                                         (int)vertices.size()-1)).first;
+                }
+                mid[k] = p->second;
+            }
+            const int v0=faces[3*f], v1=faces[3*f+1], v2=faces[3*f+2];
+            const int sub[4][3] = {{v0,mid[0],mid[2]}, {mid[0],v1,mid[1]},
+                                   {mid[2],mid[1],v2}, {mid[0],mid[1],mid[2]}};
+            for (int s=0; s < 4; ++s)
+                for (int k=0; k < 3; ++k) newFaces.push_back(sub[s][k]);
+        }
+        faces.swap(newFaces);
+    }
+    for (int i=0; i < (int)vertices.size(); ++i)
+        vertices[i] *= radius;
+    return ContactGeometry::TriangleMesh(vertices, faces);
+}
+
+// A finely meshed ball pressed into a half space so that there are many
+// contacting faces. Once contacts have been found at Position stage,
+// re-evaluating the forces for new velocities must not allocate.
+void testElasticFoundationIsAllocationFree() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem   forces(system);
+
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    MobilizedBody::Free ball(matter.updGround(), Transform(), 
+                             body, Transform());
+    contacts.addBody(setIndex, ball, makeSphereMesh(1, 4), Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(),
+                     Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    ef.setBodyParameters(ContactSurfaceIndex(0), 1e6, 0.01, 0.1, 0.05, 0.01);
+
+    State state = system.realizeTopology();
+    ball.setQToFitTranslation(state, Vec3(0, .9, 0));
+    system.realize(state, Stage::Dynamics);
+
+    const Array_<Contact>& found = contacts.getContacts(state, setIndex);
+    SimTK_TEST(found.size() == 1);
+    const TriangleMeshContact& contact = TriangleMeshContact::getAs(found[0]);
+    const Array_<int>& faces = contact.getSurface1() == 0 
+        ? contact.getSurface1FaceIndices() : contact.getSurface2FaceIndices();
+    SimTK_TEST(faces.size() > 10);
+    for (unsigned i=1; i < faces.size(); ++i)
+        SimTK_TEST(faces[i-1] < faces[i]);
+
+    // Set u directly; the setUToFit...() methods also touch q.
+    for (int step=0; step < 10; ++step) {
+        const Vec3 v(.1*step, -.2, .05*step);
+        for (int i=0; i < 3; ++i) ball.setOneU(state, 3+i, v[i]);
+        system.realize(state, Stage::Velocity);
+        const int before = allocationCount;
+        system.realize(state, Stage::Dynamics);
+        const int allocations = allocationCount - before;
+        if (step >= 2) SimTK_TEST(allocations == 0);
+        const Vec3 f = 
+            system.getRigidBodyForces(state, Stage::Dynamics)
+                [ball.getMobilizedBodyIndex()][1];
+        SimTK_TEST(f[1] > 0);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestContactAllocations");
+        SimTK_SUBTEST(testBroadPhaseIsAllocationFree);
+        SimTK_SUBTEST(testActiveContactsReuseSnapshot);
+        SimTK_SUBTEST(testElasticFoundationIsAllocationFree);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the ContactTrackerSubsystem broad phase methods all find exactly
+// the surface pairs whose bounding spheres overlap, including after the 
+// bodies have moved (which exercises the incremental updates).
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+typedef std::pair<ContactSurfaceIndex,ContactSurfaceIndex> SurfacePair;
+
+// Compare every pair of surfaces.
+static void findPairsBruteForce(const ContactTrackerSubsystem& tracker,
+                                const State& state, Array_<SurfacePair>& pairs)
+{
+    pairs.clear();
+    const int n = tracker.getNumSurfaces();
+    for (ContactSurfaceIndex i(0); i < n; ++i) {
+        Vec3 c1; Real r1;
+        tracker.getContactSurface(i).getShape().getBoundingSphere(c1, r1);
+        const Vec3 p1 = tracker.getMobilizedBody(i).getBodyTransform(state)
+                        * (tracker.getContactSurfaceTransform(i)*c1);
+        for (ContactSurfaceIndex j(i+1); j < n; ++j) {
+            if (&tracker.getMobilizedBody(i) == &tracker.getMobilizedBody(j))
+                continue;
+            if (tracker.getContactSurface(i).isInSameClique
+                                            (tracker.getContactSurface(j)))
+                continue;
+            Vec3 c2; Real r2;
+            tracker.getContactSurface(j).getShape().getBoundingSphere(c2, r2);
+            const Vec3 p2 = tracker.getMobilizedBody(j).getBodyTransform(state)
+                            * (tracker.getContactSurfaceTransform(j)*c2);
+            if ((p1-p2).normSqr() <= square(r1+r2))
+                pairs.push_back(SurfacePair(i,j));
+        }
+    }
+}
+
+static void checkPairs(ContactTrackerSubsystem& tracker, const State& state) {
+    Array_<SurfacePair> expected, single, incremental;
+    findPairsBruteForce(tracker, state, expected);
+
+    tracker.setBroadPhaseMethod(ContactTrackerSubsystem::SingleAxisSweep);
+    tracker.findBroadPhasePairs(state, single);
+    tracker.setBroadPhaseMethod
+       (ContactTrackerSubsystem::IncrementalSweepAndPrune);
+    tracker.findBroadPhasePairs(state, incremental);
+
+    SimTK_TEST(single == expected);
+    SimTK_TEST(incremental == expected);
+}
+
+void testBroadPhase() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    ContactTrackerSubsystem tracker(system);
+
+    SimTK_TEST(tracker.getBroadPhaseMethod() 
+               == ContactTrackerSubsystem::IncrementalSweepAndPrune);
+
+    // Bodies carrying one or two spheres of various sizes. Some spheres 
+    // share a clique so should never be paired.
+    const ContactMaterial material(1e6, 0, .5, .5, .5);
+    const ContactCliqueId clique = ContactSurface::createNewContactClique();
+    Random::Uniform rand(0, 1);
+    rand.setSeed(1234);
+    const int nBodies = 150;
+    Array_<MobilizedBody> bodies;
+    for (int i=0; i < nBodies; ++i) {
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        ContactSurface surf(ContactGeometry::Sphere(.1+.3*rand.getValue()),
+                            material);
+        if (i % 10 == 0) surf.joinClique(clique);
+        body.addContactSurface(Vec3(0), surf);
+        if (i % 7 == 0)
+            body.addContactSurface(Vec3(.2,0,0), 
+                ContactSurface(ContactGeometry::Sphere(.15), material));
+        bodies.push_back(MobilizedBody::Free(matter.Ground(), body));
+    }
+
+    State state = system.realizeTopology();
+
+    // Start with the bodies clustered in a thin slab, which is bad for a
+    // single axis sweep, then let them drift.
+    Array_<Vec3> pos(nBodies), vel(nBodies);
+    for (int i=0; i < nBodies; ++i) {
+        pos[i] = Vec3(8*rand.getValue(), .2*rand.getValue(), 8*rand.getValue());
+        vel[i] = Vec3(rand.getValue()-.5, rand.getValue()-.5, 
+                      rand.getValue()-.5);
+    }
+    for (int step=0; step < 20; ++step) {
+        for (int i=0; i < nBodies; ++i) {
+            bodies[i].setQToFitTranslation(state, pos[i]);
+            pos[i] += .2*vel[i];
+        }
+        system.realize(state, Stage::Position);
+        checkPairs(tracker, state);
+    }
+
+    // A big jump that scrambles the sort order must also work.
+    for (int i=0; i < nBodies; ++i)
+        bodies[i].setQToFitTranslation(state, 
+            Vec3(4*rand.getValue(), 4*rand.getValue(), 4*rand.getValue()));
+    system.realize(state, Stage::Position);
+    checkPairs(tracker, state);
+}
+
+int main() {
+    SimTK_START_TEST("TestContactBroadPhase");
+        SimTK_SUBTEST(testBroadPhase);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,309 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+// Check that the ContactTrackers predict the onset of contact from the current
+// velocities and accelerations, that the ContactTrackerSubsystem reports those
+// predictions, and that a TimeStepper uses them to avoid stepping right 
+// through a thin object.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static const Real PredictTol = 1e-3; // relative
+
+// A closed box mesh centered at the origin.
+static ContactGeometry::TriangleMesh makeBoxMesh(const Vec3& halfDims) {
+    Array_<Vec3> vertices;
+    for (int i=0; i < 8; ++i)
+        vertices.push_back(Vec3(i&1 ? halfDims[0] : -halfDims[0],
+                                i&2 ? halfDims[1] : -halfDims[1],
+                                i&4 ? halfDims[2] : -halfDims[2]));
+    const int faces[12][3] = {{0,4,6},{0,6,2}, {1,3,7},{1,7,5},
+                              {0,1,5},{0,5,4}, {2,6,7},{2,7,3},
+                              {0,2,3},{0,3,1}, {4,5,7},{4,7,6}};
+    Array_<int> faceIndices;
+    for (int i=0; i < 12; ++i)
+        for (int j=0; j < 3; ++j)
+            faceIndices.push_back(faces[i][j]);
+    return ContactGeometry::TriangleMesh(vertices, faceIndices);
+}
+
+// Call a tracker's predictContact() and return the predicted time to contact,
+// or Infinity if none was predicted.
+static Real predict(const ContactTracker& tracker,
+    const Transform& X_GS1, const SpatialVec& V_GS1, const SpatialVec& A_GS1,
+    const ContactGeometry& geom1,
+    const Transform& X_GS2, const SpatialVec& V_GS2, const SpatialVec& A_GS2,
+    const ContactGeometry& geom2, Real interval) {
+    const UntrackedContact untracked(ContactSurfaceIndex(0), 
+                                     ContactSurfaceIndex(1));
+    Contact predicted;
+    SimTK_TEST(tracker.predictContact(untracked, X_GS1, V_GS1, A_GS1, geom1,
+                                      X_GS2, V_GS2, A_GS2, geom2, 
+                                      0, interval, predicted));
+    if (predicted.isEmpty())
+        return Infinity;
+    SimTK_TEST(AnticipatedContact::isInstance(predicted));
+    SimTK_TEST(predicted.getCondition() == Contact::Anticipated);
+    SimTK_TEST(predicted.getSurface1() == 0 && predicted.getSurface2() == 1);
+    return static_cast<const AnticipatedContact&>(predicted)
+                .getTimeToContact();
+}
+
+// The prediction is conservative so it may be a little early but is never
+// late.
+static void checkOnset(Real predicted, Real exact) {
+    SimTK_TEST(predicted <= exact*(1+SignificantReal));
+    SimTK_TEST(predicted >= exact*(1-PredictTol));
+}
+
+void testTrackerPredictions() {
+    const SpatialVec Zero(Vec3(0), Vec3(0));
+    const ContactGeometry::HalfSpace halfSpace;
+    const ContactGeometry::Sphere    sphere(.1);
+    const ContactGeometry::Ellipsoid ellipsoid(Vec3(.1,.3,.2));
+    const ContactGeometry::TriangleMesh slab = makeBoxMesh(Vec3(1,.01,1));
+    // Half space occupies x>0 in its own frame; put it at y<0.
+    const Transform X_GH(Rotation(-Pi/2, ZAxis), Vec3(0));
+
+    // Sphere falling from rest under gravity: 2 - g t^2/2 = 0.
+    const SpatialVec gravity(Vec3(0), Vec3(0,-9.8,0));
+    checkOnset(predict(ContactTracker::HalfSpaceSphere(),
+                       X_GH, Zero, Zero, halfSpace,
+                       Vec3(0,2.1,0), Zero, gravity, sphere, 1),
+               std::sqrt(2*2/9.8));
+    // Same thing, but too far to fall within the interval.
+    SimTK_TEST(predict(ContactTracker::HalfSpaceSphere(),
+                       X_GH, Zero, Zero, halfSpace,
+                       Vec3(0,2.1,0), Zero, gravity, sphere, .5) == Infinity);
+    // Moving away.
+    SimTK_TEST(predict(ContactTracker::HalfSpaceSphere(),
+                       X_GH, Zero, Zero, halfSpace,
+                       Vec3(0,2.1,0), SpatialVec(Vec3(0),Vec3(0,1,0)), Zero, 
+                       sphere, 10) == Infinity);
+
+    // Ellipsoid with its long (y) axis vertical, moving down at 3.
+    checkOnset(predict(ContactTracker::HalfSpaceEllipsoid(),
+                       X_GH, Zero, Zero, halfSpace,
+                       Vec3(0,1.5,0), SpatialVec(Vec3(0),Vec3(0,-3,0)), Zero, 
+                       ellipsoid, 1),
+               1.2/3);
+
+    // Spheres approaching head on at relative speed 5.
+    checkOnset(predict(ContactTracker::SphereSphere(),
+                       Vec3(0), SpatialVec(Vec3(0),Vec3(2,0,0)), Zero, sphere,
+                       Vec3(1,0,0), SpatialVec(Vec3(0),Vec3(-3,0,0)), Zero, 
+                       sphere, 1),
+               .8/5);
+    // The spheres pass each other.
+    SimTK_TEST(predict(ContactTracker::SphereSphere(),
+                       Vec3(0), SpatialVec(Vec3(0),Vec3(2,0,0)), Zero, sphere,
+                       Vec3(1,.5,0), SpatialVec(Vec3(0),Vec3(-3,0,0)), Zero, 
+                       sphere, 1) == Infinity);
+
+    // Thin slab falling flat onto the half space.
+    checkOnset(predict(ContactTracker::HalfSpaceTriangleMesh(),
+                       X_GH, Zero, Zero, halfSpace,
+                       Vec3(0,1.01,0), SpatialVec(Vec3(0),Vec3(0,-2,0)), Zero,
+                       slab, 1),
+               .5);
+
+    // Sphere moving down toward the slab, and one that misses it.
+    checkOnset(predict(ContactTracker::SphereTriangleMesh(),
+                       Vec3(0,1,0), SpatialVec(Vec3(0),Vec3(0,-5,0)), Zero, 
+                       sphere, Vec3(0), Zero, Zero, slab, 1),
+               .89/5);
+    SimTK_TEST(predict(ContactTracker::SphereTriangleMesh(),
+                       Vec3(1.5,1,0), SpatialVec(Vec3(0),Vec3(0,-5,0)), Zero, 
+                       sphere, Vec3(0), Zero, Zero, slab, 1) == Infinity);
+
+    // One slab dropping onto another, and one offset so that an edge meets
+    // a face.
+    checkOnset(predict(ContactTracker::TriangleMeshTriangleMesh(),
+                       Vec3(0), Zero, Zero, slab,
+                       Vec3(0,1,0), SpatialVec(Vec3(0),Vec3(0,-2,0)), Zero, 
+                       slab, 1),
+               .98/2);
+    checkOnset(predict(ContactTracker::TriangleMeshTriangleMesh(),
+                       Vec3(0), Zero, Zero, slab,
+                       Transform(Rotation(Pi/4, XAxis), Vec3(.5,1,0)), 
+                       SpatialVec(Vec3(0),Vec3(0,-2,0)), Zero, 
+                       slab, 1),
+               (1-.01-std::sqrt(.5)*(1+.01))/2);
+
+    // A sphere beside the middle of a long, thin ellipsoid, moving down 
+    // toward it at 1. The gap is about .1769 but the direction between the
+    // centers gives a negative bound, so the separating direction has to be
+    // refined for the prediction to be useful.
+    const ContactGeometry::Ellipsoid needle(Vec3(1,.05,.05));
+    const Real needleGap = Real(.1769246);
+    const UntrackedContact untracked(ContactSurfaceIndex(0), 
+                                     ContactSurfaceIndex(1));
+    Contact predicted;
+    SimTK_TEST(ContactTracker::ConvexImplicitPair
+       (ContactGeometry::Sphere::classTypeId(), 
+        ContactGeometry::Ellipsoid::classTypeId()).predictContact
+       (untracked, Vec3(.9,.3,0), SpatialVec(Vec3(0),Vec3(0,-1,0)), Zero, 
+        sphere, Vec3(0), Zero, Zero, needle, 0, 1, predicted));
+    SimTK_TEST(AnticipatedContact::isInstance(predicted));
+    const AnticipatedContact& anticipated = 
+        static_cast<const AnticipatedContact&>(predicted);
+    SimTK_TEST(anticipated.getSeparation() > needleGap*(1-PredictTol));
+    SimTK_TEST(anticipated.getSeparation() <= needleGap*(1+1e-6));
+    SimTK_TEST(anticipated.getTimeToContact() > needleGap*(1-PredictTol));
+
+    // With no history, initializing a separated pair gives a prediction
+    // using the current velocities; an overlapping pair is tracked.
+    Contact status = UntrackedContact(ContactSurfaceIndex(3), 
+                                      ContactSurfaceIndex(4));
+    SimTK_TEST(ContactTracker::SphereSphere().initializeContact
+       (Vec3(0), SpatialVec(Vec3(0),Vec3(1,0,0)), sphere,
+        Vec3(1,0,0), Zero, sphere, 0, 1, status));
+    SimTK_TEST(AnticipatedContact::isInstance(status));
+    SimTK_TEST(status.getSurface1() == 3 && status.getSurface2() == 4);
+    checkOnset(static_cast<const AnticipatedContact&>(status)
+                    .getTimeToContact(), .8);
+    SimTK_TEST(ContactTracker::SphereSphere().initializeContact
+       (Vec3(0), Zero, sphere, Vec3(.15,0,0), Zero, sphere, 0, 1, status));
+    SimTK_TEST(CircularPointContact::isInstance(status));
+}
+
+// A small sphere fixed to Ground and a free sphere of the same size flying
+// toward it in the absence of gravity.
+static void buildSystem(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                        ContactTrackerSubsystem& tracker, 
+                        MobilizedBody::Free& ball) {
+    ContactMaterial material(1e7, 0.1, 0, 0, 0);
+    matter.Ground().updBody().addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Sphere(.05), material));
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    body.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Sphere(.05), material));
+    ball = MobilizedBody::Free(matter.Ground(), Transform(Vec3(-5,0,0)), 
+                               body, Transform());
+}
+
+void testSubsystemPredictions() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    MobilizedBody::Free         ball;
+    buildSystem(system, matter, tracker, ball);
+    SimTK_TEST(tracker.getContactPredictionInterval() == 0);
+    SimTK_TEST_MUST_THROW(tracker.setContactPredictionInterval(-1));
+
+    State state = system.realizeTopology();
+    ball.setUToFitLinearVelocity(state, Vec3(10,0,0));
+    state.updTime() = 2;
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(tracker.getPredictedContacts(state).getNumContacts() == 0);
+    Real tEvent; Array_<EventId> ids;
+    system.calcTimeOfNextScheduledEvent(state, tEvent, ids, true);
+    SimTK_TEST(tEvent == Infinity && ids.empty());
+
+    tracker.setContactPredictionInterval(1);
+    state = system.realizeTopology();
+    ball.setUToFitLinearVelocity(state, Vec3(10,0,0));
+    state.updTime() = 2;
+    system.realize(state, Stage::Acceleration);
+    const ContactSnapshot& predicted = tracker.getPredictedContacts(state);
+    SimTK_TEST(predicted.getNumContacts() == 1);
+    SimTK_TEST(predicted.getTimestamp() == 2);
+    const Contact& contact = predicted.getContact(0);
+    SimTK_TEST(contact.getCondition() == Contact::Anticipated);
+    SimTK_TEST(contact.getContactId().isValid());
+    SimTK_TEST_EQ(static_cast<const AnticipatedContact&>(contact)
+                    .getSeparation(), 4.9);
+    checkOnset(static_cast<const AnticipatedContact&>(contact)
+                    .getTimeToContact(), .49);
+
+    system.calcTimeOfNextScheduledEvent(state, tEvent, ids, true);
+    SimTK_TEST(ids.size() == 1);
+    checkOnset(tEvent-2, .49);
+
+    // The swept bounds go through whichever broad phase is selected, and
+    // both must find the same pair.
+    tracker.setBroadPhaseMethod(ContactTrackerSubsystem::SingleAxisSweep);
+    state.invalidateAll(Stage::Position);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(tracker.getPredictedContacts(state).getNumContacts() == 1);
+    tracker.setBroadPhaseMethod
+       (ContactTrackerSubsystem::IncrementalSweepAndPrune);
+
+    // Too fast for the interval; the ball will be past before it's checked 
+    // again, but it's the interval that says how far ahead to look.
+    tracker.setContactPredictionInterval(.4);
+    state = system.realizeTopology();
+    ball.setUToFitLinearVelocity(state, Vec3(10,0,0));
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(tracker.getPredictedContacts(state).getNumContacts() == 0);
+}
+
+// Run the ball at the fixed sphere with large reporting intervals and loose
+// accuracy. Return the ball's final x velocity.
+static Real runBall(Real predictionInterval) {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contactForces(system, tracker);
+    MobilizedBody::Free         ball;
+    buildSystem(system, matter, tracker, ball);
+    tracker.setContactPredictionInterval(predictionInterval);
+
+    State state = system.realizeTopology();
+    ball.setUToFitLinearVelocity(state, Vec3(10,0,0));
+    RungeKuttaMersonIntegrator integ(system);
+    integ.setAccuracy(1e-3);
+    TimeStepper ts(system, integ);
+    ts.initialize(state);
+    ts.stepTo(1);
+    cout << "prediction interval " << predictionInterval << ": "
+         << integ.getNumStepsTaken() << " steps, final x=" 
+         << ball.getBodyOriginLocation(integ.getState())[0] << " v=" 
+         << ball.getBodyOriginVelocity(integ.getState())[0] << endl;
+    return ball.getBodyOriginVelocity(integ.getState())[0];
+}
+
+void testNoTunneling() {
+    // Without prediction the integrator steps right through the sphere in
+    // its way since nothing happens at the beginning or end of the step.
+    SimTK_TEST(runBall(0) > 9);
+    // With prediction a step ends just before contact and the next one
+    // starts in contact, so the integrator sees the collision and the ball
+    // bounces back (slower, since the material is dissipative).
+    SimTK_TEST(runBall(1) < 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestContactPrediction");
+        SimTK_SUBTEST(testTrackerPredictions);
+        SimTK_SUBTEST(testSubsystemPredictions);
+        SimTK_SUBTEST(testNoTunneling);
+    SimTK_END_TEST();
+}
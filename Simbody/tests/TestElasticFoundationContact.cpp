@@ -0,0 +1,201 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the elastic foundation contact force generator of 
+// CompliantContactSubsystem against forces calculated one face at a time.
+
+#include "SimTKsimbody.h"
+
+using namespace SimTK;
+using namespace std;
+
+const Real TOL = 1e-5;
+
+#define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
+
+template <class T>
+void assertEqual(T val1, T val2) {
+    ASSERT(abs(val1-val2) < TOL || abs(val1-val2)/max(abs(val1), abs(val2)) < TOL);
+}
+
+template <int N>
+void assertEqual(Vec<N> val1, Vec<N> val2) {
+    for (int i = 0; i < N; ++i)
+        assertEqual(val1[i], val2[i]);
+}
+
+// The friction model used by CompliantContactSubsystem; v and uv are in 
+// multiples of the transition velocity.
+Real step5(Real x) {
+    return x*x*x*(10+x*(6*x-15));
+}
+
+Real stribeck(Real us, Real ud, Real uv, Real v) {
+    Real mu_dry;
+    if      (v >= 3) mu_dry = ud;
+    else if (v >= 1) mu_dry = us - (us-ud)*step5((v-1)/2);
+    else             mu_dry = us*step5(v);
+    return mu_dry + uv*v;
+}
+
+void testManySprings() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    ContactTrackerSubsystem tracker(system);
+    CompliantContactSubsystem contactForces(system, tracker);
+
+    // A 9x8 grid of squares in the y=0 plane, each split into two triangles
+    // facing -y, closed by a fan of triangles from its boundary to an apex.
+
+    const int nx = 9, nz = 8;
+    const Real cell = 0.1;
+    vector<Vec3> vertices;
+    for (int i = 0; i <= nx; i++)
+        for (int j = 0; j <= nz; j++)
+            vertices.push_back(Vec3(i*cell, 0, j*cell));
+    vector<int> faceIndices;
+    for (int i = 0; i < nx; i++)
+        for (int j = 0; j < nz; j++) {
+            const int v0 = i*(nz+1)+j, v1 = v0+nz+1, v2 = v1+1, v3 = v0+1;
+            const int faces[2][3] = {{v0, v1, v2}, {v0, v2, v3}};
+            for (int f = 0; f < 2; f++)
+                for (int k = 0; k < 3; k++)
+                    faceIndices.push_back(faces[f][k]);
+        }
+    const int apex = (int)vertices.size();
+    vertices.push_back(Vec3(0.5*nx*cell, 1, 0.5*nz*cell));
+    for (int i = 0; i < nx; i++) {
+        const int bottom = i*(nz+1), top = bottom+nz;
+        const int fan[2][3] = {{bottom+nz+1, bottom, apex}, {top, top+nz+1, apex}};
+        for (int f = 0; f < 2; f++)
+            for (int k = 0; k < 3; k++)
+                faceIndices.push_back(fan[f][k]);
+    }
+    for (int j = 0; j < nz; j++) {
+        const int left = j, right = nx*(nz+1)+j;
+        const int fan[2][3] = {{left, left+1, apex}, {right+1, right, apex}};
+        for (int f = 0; f < 2; f++)
+            for (int k = 0; k < 3; k++)
+                faceIndices.push_back(fan[f][k]);
+    }
+    ContactGeometry::TriangleMesh grid(vertices, faceIndices);
+
+    // Both surfaces have the same material and thickness, so each does half
+    // of the deforming and the composite material is the surfaces' own.
+    const Real stiffness = 1e7, thickness = 0.1, dissipation = 0.5;
+    const Real us = 0.8, ud = 0.5, uv = 0.1, vt = 0.05;
+    const ContactMaterial material(stiffness, dissipation, us, ud, uv);
+    contactForces.setTransitionVelocity(vt);
+    matter.updGround().updBody().addContactSurface(Rotation(-0.5*Pi, ZAxis), // y < 0
+        ContactSurface(ContactGeometry::HalfSpace(), material, thickness));
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    body.addContactSurface(Transform(), ContactSurface(grid, material, thickness));
+    MobilizedBody::Free mesh(matter.updGround(), Transform(), body, Transform());
+    State state = system.realizeTopology();
+
+    // Tip the grid so that only part of it is below the surface, and give it
+    // a general velocity so that each spring sees a different slip.
+
+    const Rotation R(BodyRotationSequence, 0.3, XAxis, 0.2, ZAxis);
+    const Vec3 origin(-0.2, 0.03, 0.1);
+    mesh.setQToFitTransform(state, Transform(R, origin));
+    mesh.setUToFitVelocity(state, SpatialVec(Vec3(0.3, -0.7, 1.1), Vec3(0.2, -0.4, 0.05)));
+    system.realize(state, Stage::Dynamics);
+
+    // Each face inside the half space is a spring from its centroid to the
+    // nearest point on the plane, with the contact point halfway between.
+
+    const Real kh = 0.5*stiffness/thickness;
+    const SpatialVec V = mesh.getBodyVelocity(state);
+    SpatialVec expected(Vec3(0), Vec3(0));
+    Real expectedPE = 0, expectedPowerLoss = 0;
+    int numInside = 0, numPushing = 0;
+    for (int face = 0; face < grid.getNumFaces(); face++) {
+        const Vec3 centroid = (grid.getVertexPosition(grid.getFaceVertex(face, 0))
+            + grid.getVertexPosition(grid.getFaceVertex(face, 1))
+            + grid.getVertexPosition(grid.getFaceVertex(face, 2)))/3;
+        const Vec3 spring = mesh.findStationLocationInGround(state, centroid);
+        if (spring[1] >= 0)
+            continue;
+        ++numInside;
+        const Real area = grid.getFaceArea(face);
+        const Real depth = -spring[1];
+        const Vec3 contactPt(spring[0], -0.5*depth, spring[2]);
+        const Vec3 r = contactPt - origin;
+        const Vec3 v = -(V[1] + V[0] % r); // ground relative to the mesh
+        const Real vnormal = v[1];
+        const Vec3 vtangent(v[0], 0, v[2]);
+        const Real fK = kh*area*depth, fC = fK*dissipation*vnormal;
+        const Real f = fK + fC;
+        if (f <= 0)
+            continue;
+        ++numPushing;
+        const Real vslip = vtangent.norm();
+        const Real fFriction = f*stribeck(us, ud, uv*vt, vslip/vt);
+        const Vec3 force = Vec3(0, f, 0) + (fFriction/vslip)*vtangent;
+        expected += SpatialVec(r % force, force);
+        expectedPE += 0.5*fK*depth;
+        expectedPowerLoss += fC*vnormal + fFriction*vslip;
+    }
+    ASSERT(numInside > 64 && numInside % 2 == 1); // more than a block, and an odd one out
+
+    const SpatialVec actual = system.getRigidBodyForces(state, Stage::Dynamics)[mesh.getMobilizedBodyIndex()];
+    assertEqual(actual[0], expected[0]);
+    assertEqual(actual[1], expected[1]);
+    assertEqual(system.calcPotentialEnergy(state), expectedPE);
+    ASSERT(contactForces.getNumContactForces(state) == 1);
+    const ContactForce& resultant = contactForces.getContactForce(state, 0);
+    assertEqual(resultant.getPowerDissipation(), expectedPowerLoss);
+
+    // The details are calculated one spring at a time, and should add up to
+    // the same resultant.
+
+    ContactPatch patch;
+    ASSERT(contactForces.calcContactPatchDetailsById(state, resultant.getContactId(), patch));
+    ASSERT(patch.getNumDetails() == numPushing);
+    Vec3 detailForce(0);
+    Real detailPE = 0, detailPowerLoss = 0;
+    for (int i = 0; i < patch.getNumDetails(); i++) {
+        const ContactDetail& detail = patch.getContactDetail(i);
+        detailForce += detail.getForceOnSurface2();
+        detailPE += detail.getPotentialEnergy();
+        detailPowerLoss += detail.getPowerDissipation();
+    }
+    assertEqual(detailForce, resultant.getForceOnSurface2()[1]);
+    assertEqual(detailForce.norm(), expected[1].norm());
+    assertEqual(detailPE, expectedPE);
+    assertEqual(detailPowerLoss, expectedPowerLoss);
+    assertEqual(patch.getContactForce().getForceOnSurface2()[1], resultant.getForceOnSurface2()[1]);
+}
+
+int main() {
+    try {
+        testManySprings();
+    }
+    catch(const std::exception& e) {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
+}
@@ -130,9 +130,117 @@ void testForces() {
     }
 }
 
+// A tilted, moving grid of many triangles pressed into a half space. The 
+// springs are evaluated in blocks (with vectorized arithmetic where it is 
+// available), so compare the total against a sum over the faces done here 
+// one spring at a time.
+
+void testManySprings() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem forces(system);
+
+    // A 9x8 grid of squares in the y=0 plane, each split into two triangles
+    // facing -y, closed by a fan of triangles from its boundary to an apex.
+
+    const int nx = 9, nz = 8;
+    const Real cell = 0.1;
+    vector<Vec3> vertices;
+    for (int i = 0; i <= nx; i++)
+        for (int j = 0; j <= nz; j++)
+            vertices.push_back(Vec3(i*cell, 0, j*cell));
+    vector<int> faceIndices;
+    for (int i = 0; i < nx; i++)
+        for (int j = 0; j < nz; j++) {
+            const int v0 = i*(nz+1)+j, v1 = v0+nz+1, v2 = v1+1, v3 = v0+1;
+            const int faces[2][3] = {{v0, v1, v2}, {v0, v2, v3}};
+            for (int f = 0; f < 2; f++)
+                for (int k = 0; k < 3; k++)
+                    faceIndices.push_back(faces[f][k]);
+        }
+    const int apex = (int)vertices.size();
+    vertices.push_back(Vec3(0.5*nx*cell, 1, 0.5*nz*cell));
+    for (int i = 0; i < nx; i++) {
+        const int bottom = i*(nz+1), top = bottom+nz;
+        const int fan[2][3] = {{bottom+nz+1, bottom, apex}, {top, top+nz+1, apex}};
+        for (int f = 0; f < 2; f++)
+            for (int k = 0; k < 3; k++)
+                faceIndices.push_back(fan[f][k]);
+    }
+    for (int j = 0; j < nz; j++) {
+        const int left = j, right = nx*(nz+1)+j;
+        const int fan[2][3] = {{left, left+1, apex}, {right+1, right, apex}};
+        for (int f = 0; f < 2; f++)
+            for (int k = 0; k < 3; k++)
+                faceIndices.push_back(fan[f][k]);
+    }
+    ContactGeometry::TriangleMesh grid(vertices, faceIndices);
+
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    MobilizedBody::Free mesh(matter.updGround(), Transform(), body, Transform());
+    contacts.addBody(setIndex, mesh, grid, Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::HalfSpace(), Transform(Rotation(-0.5*Pi, ZAxis), Vec3(0))); // y < 0
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    const Real stiffness = 1e6, dissipation = 0.5, us = 0.8, ud = 0.5, uv = 0.1, vt = 0.05;
+    ef.setBodyParameters(ContactSurfaceIndex(0), stiffness, dissipation, us, ud, uv);
+    ef.setTransitionVelocity(vt);
+    State state = system.realizeTopology();
+
+    // Tip the grid so that only part of it is below the surface, and give it
+    // a general velocity so that each spring sees a different slip.
+
+    const Rotation R(BodyRotationSequence, 0.3, XAxis, 0.2, ZAxis);
+    const Vec3 origin(-0.2, 0.03, 0.1);
+    mesh.setQToFitTransform(state, Transform(R, origin));
+    mesh.setUToFitVelocity(state, SpatialVec(Vec3(0.3, -0.7, 1.1), Vec3(0.2, -0.4, 0.05)));
+    system.realize(state, Stage::Dynamics);
+
+    const SpatialVec V = mesh.getBodyVelocity(state);
+    SpatialVec expected(Vec3(0), Vec3(0));
+    Real expectedPE = 0;
+    int numInside = 0;
+    for (int face = 0; face < grid.getNumFaces(); face++) {
+        const Vec3 centroid = (grid.getVertexPosition(grid.getFaceVertex(face, 0))
+            + grid.getVertexPosition(grid.getFaceVertex(face, 1))
+            + grid.getVertexPosition(grid.getFaceVertex(face, 2)))/3;
+        const Vec3 spring = mesh.findStationLocationInGround(state, centroid);
+        if (spring[1] >= 0)
+            continue;
+        ++numInside;
+        const Real area = grid.getFaceArea(face);
+        const Real depth = -spring[1];
+        const Vec3 nearest(spring[0], 0, spring[2]);
+        const Vec3 r = nearest - origin;
+        const Vec3 v = -(V[1] + V[0] % r); // ground relative to the mesh
+        const Real vnormal = v[1];
+        const Vec3 vtangent(v[0], 0, v[2]);
+        const Real f = stiffness*area*depth*(1+dissipation*vnormal);
+        Vec3 force(0);
+        if (f > 0) {
+            force = Vec3(0, f, 0);
+            const Real vslip = vtangent.norm();
+            const Real vrel = vslip/vt;
+            force += f*(std::min(vrel, Real(1))*(ud+2*(us-ud)/(1+vrel*vrel))+uv*vslip)*vtangent/vslip;
+        }
+        expected += SpatialVec(r % force, force);
+        expectedPE += 0.5*stiffness*area*depth*depth;
+    }
+    ASSERT(numInside > 64 && numInside % 2 == 1); // more than a block, and an odd one out
+
+    const SpatialVec actual = system.getRigidBodyForces(state, Stage::Dynamics)[mesh.getMobilizedBodyIndex()];
+    assertEqual(actual[0], expected[0]);
+    assertEqual(actual[1], expected[1]);
+    const SpatialVec reaction = system.getRigidBodyForces(state, Stage::Dynamics)[matter.getGround().getMobilizedBodyIndex()];
+    assertEqual(reaction[1], Vec3(-expected[1]));
+    assertEqual(system.calcPotentialEnergy(state), expectedPE);
+}
+
 int main() {
     try {
         testForces();
+        testManySprings();
     }
     catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
@@ -530,7 +530,11 @@ void testFunctionBasedGimbalUserAxes() {
     isdof[2] = true;  //rot 3
     int nm = defineMobilizerFunctions(isdof, coordIndices, functions1, functions2);
 
+    // Some choices of axes carry the skewed gimbal through a singular
+    // configuration during the simulation below, so use a seed known to
+    // avoid that.
     Random::Gaussian random;
+    random.setSeed(5);
 
     axes[0] = Vec3(random.getValue(),random.getValue(), 0); //Vec3(0,0,1);//
     axes[1] = Vec3(random.getValue(), 0,random.getValue());
@@ -0,0 +1,175 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that calcProjectedMInv(), which computes several columns at once by
+// exploiting the block structure of the mass matrix and may compute them in
+// parallel, agrees with the explicitly formed product G*M^-1*~G. Also check
+// that the constrained forward dynamics that uses it doesn't depend on
+// whether it ran in parallel.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Build many independent closed-loop mechanisms, a few of which are also
+// coupled to their neighbors, with a mix of holonomic, nonholonomic, and
+// acceleration-only constraints and some constraints that involve Ground.
+static void buildLoops(SimbodyMatterSubsystem& matter, int nLoops,
+                       Array_<ConstraintIndex>& optional) {
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,.3),
+                                    UnitInertia(1.1,1.2,1.3,.1,.2,.3)));
+    Array_<MobilizedBody> tips;
+    for (int i=0; i < nLoops; ++i) {
+        MobilizedBody::Pin left(matter.Ground(), Vec3(3*i,0,0),
+                                body, Vec3(0,1,0));
+        MobilizedBody::Ball leftTip(left, Vec3(0,-1,0), body, Vec3(0,1,0));
+        MobilizedBody::Pin right(matter.Ground(), Vec3(3*i+1,0,0),
+                                 body, Vec3(0,1,0));
+        MobilizedBody::Gimbal rightTip(right, Vec3(0,-1,0),
+                                       body, Vec3(0,1,0));
+        Constraint::Ball(leftTip, Vec3(0,-1,0), rightTip, Vec3(0,-1,0));
+        switch (i % 4) {
+        case 0: Constraint::Rod(matter.Ground(), Vec3(3*i+.5,-5,0),
+                                leftTip, Vec3(0,-1,0), 4); break;
+        case 1: Constraint::ConstantSpeed(right, .5); break;
+        case 2: Constraint::ConstantAcceleration(left, .25); break;
+        case 3: break;
+        }
+        tips.push_back(rightTip);
+    }
+    // Couple some neighboring loops; one of these will be disabled.
+    for (int i=0; i+1 < nLoops; i += 3) {
+        Constraint::Rod rod(tips[i], tips[i+1], 3);
+        optional.push_back(rod.getConstraintIndex());
+    }
+}
+
+static void setRandomState(State& state) {
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(123);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = rand.getValue();
+}
+
+// Vector and Matrix have no operator==; we want exact equality here.
+static bool isIdentical(const Matrix& a, const Matrix& b) {
+    if (a.nrow() != b.nrow() || a.ncol() != b.ncol()) return false;
+    for (int j=0; j < a.ncol(); ++j)
+        for (int i=0; i < a.nrow(); ++i)
+            if (a(i,j) != b(i,j)) return false;
+    return true;
+}
+
+static bool isIdentical(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+static Real maxAbs(const Matrix& a) {
+    Real mx = 0;
+    for (int j=0; j < a.ncol(); ++j)
+        for (int i=0; i < a.nrow(); ++i)
+            mx = std::max(mx, std::abs(a(i,j)));
+    return mx;
+}
+
+static void checkAgainstExplicitProduct(const SimbodyMatterSubsystem& matter,
+                                        const State& state) {
+    Matrix G, MInv, Gt, GMInvGt;
+    matter.calcG(state, G);
+    matter.calcMInv(state, MInv);
+    matter.calcGTranspose(state, Gt);
+    const Matrix expected = G*MInv*Gt;
+
+    matter.calcProjectedMInv(state, GMInvGt);
+    SimTK_TEST(GMInvGt.nrow() == expected.nrow());
+    SimTK_TEST(GMInvGt.ncol() == expected.ncol());
+    const Real scale = std::max(Real(1), maxAbs(expected));
+    SimTK_TEST_EQ_TOL(maxAbs(GMInvGt-expected)/scale, 0, 1e-10);
+}
+
+void testGMInvGt() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity gravity(forces, matter, Vec3(0, -9.8, 0));
+    Array_<ConstraintIndex> optional;
+    buildLoops(matter, 12, optional);
+
+    State state = system.realizeTopology();
+    setRandomState(state);
+    system.realize(state, Stage::Acceleration);
+
+    checkAgainstExplicitProduct(matter, state);
+    Matrix serial;
+    matter.calcProjectedMInv(state, serial);
+    const Vector udot0 = state.getUDot();
+    const Vector mult0 = state.getMultipliers();
+
+    // Force the columns to be computed on the thread pool, with more threads
+    // than we have processors so that this gets exercised even on one core.
+    matter.setUseParallelTreeSweeps(true);
+    matter.setNumParallelTreeSweepThreads(4);
+    for (int rep=0; rep < 3; ++rep) {
+        Matrix parallel;
+        matter.calcProjectedMInv(state, parallel);
+        SimTK_TEST(isIdentical(parallel, serial));
+
+        // Repeated realizations reuse the factorization workspace.
+        state.invalidateAll(Stage::Dynamics);
+        system.realize(state, Stage::Acceleration);
+        SimTK_TEST(isIdentical(state.getUDot(), udot0));
+        SimTK_TEST(isIdentical(state.getMultipliers(), mult0));
+    }
+
+    // A copy of the State gets its own workspace and the same answers.
+    State copy = state;
+    copy.invalidateAll(Stage::Dynamics);
+    system.realize(copy, Stage::Acceleration);
+    SimTK_TEST(isIdentical(copy.getUDot(), udot0));
+
+    // Changing the set of enabled constraints changes m and the grouping.
+    matter.updConstraint(optional[0]).disable(state);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(state.getNMultipliers() == mult0.size()-1);
+    checkAgainstExplicitProduct(matter, state);
+
+    matter.setUseParallelTreeSweeps(false);
+    checkAgainstExplicitProduct(matter, state);
+
+    matter.updConstraint(optional[0]).enable(state);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(isIdentical(state.getUDot(), udot0));
+}
+
+int main() {
+    SimTK_START_TEST("TestGMInvGt");
+        SimTK_SUBTEST(testGMInvGt);
+    SimTK_END_TEST();
+}
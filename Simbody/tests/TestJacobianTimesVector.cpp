@@ -0,0 +1,144 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the Jacobian-vector products that a MultibodySystem supplies to
+// implicit integrators through System::calcYDotJacobianTimesVector() against
+// central differences of the system derivatives, and check that the CPODES 
+// Krylov linear solver that uses them integrates to the same answer as the
+// dense solver.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A chain of alternating ball and pin joints, so that N(q) isn't the 
+// identity, with stiff damped pin joints and gravity.
+static void buildChain(SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces, int nLinks) {
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+
+    Body::Rigid link(MassProperties(1, Vec3(.1,0,0), UnitInertia(.1,.2,.3)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < nLinks; ++i) {
+        if (i % 2) {
+            MobilizedBody::Pin pin(parent, Vec3(0,-.5,0), link, Vec3(0,.5,0));
+            Force::MobilityLinearSpring(forces, pin, 0, 1e3, 0);
+            Force::MobilityLinearDamper(forces, pin, 0, 10);
+            parent = pin;
+        } else
+            parent = MobilizedBody::Ball(parent, Vec3(0,-.5,0), 
+                                         link, Vec3(0,.5,0));
+    }
+}
+
+static Vector calcYDot(const System& system, State& state, const Vector& y) {
+    state.updY() = y;
+    system.realize(state, Stage::Acceleration);
+    return state.getYDot();
+}
+
+void testAgainstDifferences() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    buildChain(matter, forces, 6);
+    Constraint::Rod rod(matter.Ground(), Vec3(1,0,0), 
+                        matter.updMobilizedBody(MobilizedBodyIndex(2)), Vec3(0),
+                        1);
+    rod.setDisabledByDefault(true);
+    State state = system.realizeTopology();
+
+    Random::Uniform rand(-1, 1);
+    for (MobilizedBodyIndex mbx(1); mbx < matter.getNumBodies(); ++mbx) {
+        MobilizedBody& mobod = matter.updMobilizedBody(mbx);
+        mobod.setQToFitRotation(state, Rotation(rand.getValue(), 
+            UnitVec3(rand.getValue(), rand.getValue(), rand.getValue()+2)));
+        for (int i=0; i < mobod.getNumU(state); ++i)
+            mobod.setOneU(state, i, rand.getValue());
+    }
+    system.realize(state, Stage::Acceleration);
+    const Vector y = state.getY(), ydot = state.getYDot();
+    const int ny = y.size();
+
+    Vector v(ny);
+    for (int i=0; i < ny; ++i)
+        v[i] = rand.getValue();
+
+    State scratch = state;
+    const Real h = 1e-5;
+    const Vector JvCentral = (calcYDot(system, scratch, y+h*v) 
+                              - calcYDot(system, scratch, y-h*v)) / (2*h);
+
+    Vector Jv;
+    SimTK_TEST(system.calcYDotJacobianTimesVector(state, ydot, v, 1e-7, Jv));
+    SimTK_TEST(Jv.size() == ny);
+    SimTK_TEST((Jv-JvCentral).normInf() < 1e-5*JvCentral.normInf());
+
+    // The state variables must be restored.
+    SimTK_TEST((state.getY()-y).normInf() == 0);
+
+    // With a constraint enabled, the system leaves the product to the caller.
+    rod.enable(state);
+    system.realize(state, Stage::Acceleration);
+    Vector untouched(3, Real(7));
+    SimTK_TEST(!system.calcYDotJacobianTimesVector(state, state.getYDot(), 
+                                                   v, 1e-7, untouched));
+    SimTK_TEST(untouched.size() == 3 && untouched[0] == 7);
+}
+
+void testKrylovIntegration() {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    buildChain(matter, forces, 6);
+    State state = system.realizeTopology();
+    for (MobilizedBodyIndex mbx(1); mbx < matter.getNumBodies(); ++mbx)
+        matter.updMobilizedBody(mbx).setQToFitRotation(state, 
+            Rotation(mbx % 2 ? .2 : -.2, ZAxis));
+
+    Vector finalY[2];
+    for (int krylov=0; krylov < 2; ++krylov) {
+        CPodesIntegrator integ(system, CPodes::BDF, CPodes::Newton);
+        integ.setAccuracy(1e-6);
+        if (krylov)
+            integ.setUseKrylovLinearSolver();
+        TimeStepper ts(system, integ);
+        ts.initialize(state);
+        ts.stepTo(0.5);
+        finalY[krylov] = integ.getState().getY();
+        if (krylov)
+            SimTK_TEST(integ.getNumLinearSolverIterations() > 0);
+    }
+    SimTK_TEST_EQ_TOL(finalY[1], finalY[0], 1e-3);
+}
+
+int main() {
+    SimTK_START_TEST("TestJacobianTimesVector");
+        SimTK_SUBTEST(testAgainstDifferences);
+        SimTK_SUBTEST(testKrylovIntegration);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,255 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that LocalEnergyMinimizer finds known minima, with and without 
+// position constraints, one State at a time and in batches, and that it
+// doesn't realize Dynamics stage when it doesn't have to.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static const Real MinimizeTol = 1e-8;
+static const Real CheckTol = 1e-5;
+
+static const Body::Rigid& getBody() {
+    static const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    return body;
+}
+
+// A chain of pins, each with a torsion spring whose rest angle is different.
+// The minimum has each pin at its spring's rest angle.
+static void buildSpringChain(MultibodySystem& system, 
+                             SimbodyMatterSubsystem& matter,
+                             GeneralForceSubsystem& forces, int nBodies) {
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < nBodies; ++i) {
+        MobilizedBody::Pin pin(parent, Vec3(0,-1,0), getBody(), Vec3(0));
+        Force::MobilityLinearSpring(forces, pin, MobilizerQIndex(0), 10, 
+                                    .1*(i+1));
+        parent = pin;
+    }
+}
+
+static void checkSpringChain(const State& state) {
+    for (int i=0; i < state.getNQ(); ++i)
+        SimTK_TEST_EQ_TOL(state.getQ()[i], .1*(i+1), CheckTol);
+}
+
+void testSpringChain() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSpringChain(system, matter, forces, 4);
+    system.updProfiler().setEnabled(true);
+
+    State state = system.realizeTopology();
+    LocalEnergyMinimizer::minimizeEnergy(system, state, MinimizeTol);
+    checkSpringChain(state);
+
+    // Only the final realization of the result reached Dynamics stage.
+    const Profiler& profiler = system.getProfiler();
+    const int dyn = profiler.findEntry("System", system.getName(), 
+                                       Stage::Dynamics);
+    SimTK_TEST(dyn >= 0);
+    SimTK_TEST(profiler.getEntry(dyn).numCalls == 1);
+}
+
+// A force subsystem that can only produce forces at Dynamics stage makes the
+// minimizer fall back to realizing it, with the same result.
+void testDynamicsFallback() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    GeneralContactSubsystem contacts(system);
+    buildSpringChain(system, matter, forces, 4);
+    system.updProfiler().setEnabled(true);
+
+    State state = system.realizeTopology();
+    LocalEnergyMinimizer::minimizeEnergy(system, state, MinimizeTol);
+    checkSpringChain(state);
+
+    const Profiler& profiler = system.getProfiler();
+    const int dyn = profiler.findEntry("System", system.getName(), 
+                                       Stage::Dynamics);
+    SimTK_TEST(profiler.getEntry(dyn).numCalls > 1);
+}
+
+// A torsion spring on a pin that computes its energy in realizeDynamics() and
+// caches it there, as a Force::Custom is free to do. 
+class CachingSpringImpl : public Force::Custom::Implementation {
+public:
+    CachingSpringImpl(const GeneralForceSubsystem& forces, 
+                      const MobilizedBody& pin, Real k, Real q0)
+    :   forces(forces), pin(pin), k(k), q0(q0) {}
+    void realizeTopology(State& state) const {
+        energyIx = forces.allocateCacheEntry(state, Stage::Dynamics, 
+                                             new Value<Real>(NaN));
+    }
+    void realizeDynamics(const State& state) const {
+        Value<Real>::updDowncast(forces.updCacheEntry(state, energyIx)) = 
+            k*square(pin.getOneQ(state, 0) - q0)/2;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces, 
+                   Vector& mobilityForces) const {
+        pin.applyOneMobilityForce(state, 0, -k*(pin.getOneQ(state, 0) - q0),
+                                  mobilityForces);
+    }
+    Real calcPotentialEnergy(const State& state) const {
+        return Value<Real>::downcast(forces.getCacheEntry(state, energyIx));
+    }
+private:
+    const GeneralForceSubsystem& forces;
+    MobilizedBody pin;
+    Real k, q0;
+    mutable CacheEntryIndex energyIx;
+};
+
+// The minimizer must realize Dynamics stage for a Force::Custom rather than
+// asking it for its energy without its realizeDynamics() having been called.
+void testCustomForce() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSpringChain(system, matter, forces, 2);
+    MobilizedBody::Pin pin(matter.Ground(), Vec3(1,0,0), getBody(), Vec3(0));
+    Force::Custom custom(forces, new CachingSpringImpl(forces, pin, 10, .5));
+
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Velocity);
+    Real pe = 0;
+    Vector_<SpatialVec> rigidBodyForces;
+    Vector_<Vec3> particleForces;
+    Vector mobilityForces;
+    SimTK_TEST(!system.calcPotentialEnergyAndForces
+                   (state, pe, rigidBodyForces, particleForces, mobilityForces));
+
+    LocalEnergyMinimizer::minimizeEnergy(system, state, MinimizeTol);
+    SimTK_TEST_EQ_TOL(state.getQ()[0], .1, CheckTol);
+    SimTK_TEST_EQ_TOL(state.getQ()[1], .2, CheckTol);
+    SimTK_TEST_EQ_TOL(pin.getOneQ(state, 0), .5, CheckTol);
+
+    // Disabling the custom force restores the cheap path.
+    custom.disable(state);
+    system.realize(state, Stage::Velocity);
+    SimTK_TEST(system.calcPotentialEnergyAndForces
+                   (state, pe, rigidBodyForces, particleForces, mobilityForces));
+}
+
+// A free body hanging from a spring under gravity; this one uses quaternions
+// so is minimized in Euler angles and converted back.
+void testHangingBody() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    MobilizedBody::Free body(matter.Ground(), getBody());
+    Force::TwoPointLinearSpring(forces, matter.Ground(), Vec3(0), 
+                                body, Vec3(0), 100, 1);
+    Force::UniformGravity(forces, matter, Vec3(0,-9.8,0));
+
+    State state = system.realizeTopology();
+    body.setQToFitTranslation(state, Vec3(.3,-.5,.1));
+    LocalEnergyMinimizer::minimizeEnergy(system, state, MinimizeTol);
+    SimTK_TEST(!matter.getUseEulerAngles(state));
+    SimTK_TEST_EQ_TOL(body.getBodyOriginLocation(state), 
+                      Vec3(0,-(1+9.8/100),0), CheckTol);
+}
+
+// Two sliders along the same line joined by a rod of length 1, with springs 
+// pulling them towards 0 and 3. The minimum is at 1 and 2.
+static void buildRodSliders(MultibodySystem& system, 
+                            SimbodyMatterSubsystem& matter,
+                            GeneralForceSubsystem& forces,
+                            MobilizedBody::Slider& s1, 
+                            MobilizedBody::Slider& s2) {
+    s1 = MobilizedBody::Slider(matter.Ground(), getBody());
+    s2 = MobilizedBody::Slider(matter.Ground(), getBody());
+    Force::MobilityLinearSpring(forces, s1, MobilizerQIndex(0), 10, 0);
+    Force::MobilityLinearSpring(forces, s2, MobilizerQIndex(0), 10, 3);
+    Constraint::Rod(s1, Vec3(0), s2, Vec3(0), 1);
+}
+
+void testConstrained() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    MobilizedBody::Slider s1, s2;
+    buildRodSliders(system, matter, forces, s1, s2);
+
+    State state = system.realizeTopology();
+    s2.setOneQ(state, 0, 1.5);
+    LocalEnergyMinimizer::minimizeEnergy(system, state, MinimizeTol);
+    SimTK_TEST_EQ_TOL(s1.getOneQ(state, 0), 1, CheckTol);
+    SimTK_TEST_EQ_TOL(s2.getOneQ(state, 0), 2, CheckTol);
+}
+
+void testBatch() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSpringChain(system, matter, forces, 4);
+
+    Random::Uniform random(-1, 1);
+    random.setSeed(42);
+    Array_<State> states(8, system.realizeTopology());
+    for (int i=0; i < (int)states.size(); ++i)
+        for (int j=0; j < states[i].getNQ(); ++j)
+            states[i].updQ()[j] = random.getValue();
+    LocalEnergyMinimizer::minimizeEnergy(system, states, MinimizeTol, 4);
+    for (int i=0; i < (int)states.size(); ++i)
+        checkSpringChain(states[i]);
+
+    SimTK_TEST_MUST_THROW(
+        LocalEnergyMinimizer::minimizeEnergy(system, states, MinimizeTol, -1));
+
+    // Constrained States are minimized one at a time.
+    MultibodySystem rodSystem;
+    SimbodyMatterSubsystem rodMatter(rodSystem);
+    GeneralForceSubsystem rodForces(rodSystem);
+    MobilizedBody::Slider s1, s2;
+    buildRodSliders(rodSystem, rodMatter, rodForces, s1, s2);
+    Array_<State> rodStates(2, rodSystem.realizeTopology());
+    s2.setOneQ(rodStates[0], 0, 1.5);
+    s1.setOneQ(rodStates[1], 0, 2); s2.setOneQ(rodStates[1], 0, 3);
+    LocalEnergyMinimizer::minimizeEnergy(rodSystem, rodStates, MinimizeTol);
+    for (int i=0; i < (int)rodStates.size(); ++i) {
+        SimTK_TEST_EQ_TOL(s1.getOneQ(rodStates[i], 0), 1, CheckTol);
+        SimTK_TEST_EQ_TOL(s2.getOneQ(rodStates[i], 0), 2, CheckTol);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestLocalEnergyMinimizer");
+        SimTK_SUBTEST(testSpringChain);
+        SimTK_SUBTEST(testDynamicsFallback);
+        SimTK_SUBTEST(testCustomForce);
+        SimTK_SUBTEST(testHangingBody);
+        SimTK_SUBTEST(testConstrained);
+        SimTK_SUBTEST(testBatch);
+    SimTK_END_TEST();
+}
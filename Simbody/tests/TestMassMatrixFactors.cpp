@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the O(n) mass matrix operators calcLogDetM() and the batched 
+// multiplyBySqrtMInv() against dense calculations using calcM().
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Dense Cholesky factorization M = L*~L; returns log(det(M)).
+static Real denseCholeskyLogDet(const Matrix& M, Matrix& L) {
+    const int n = M.nrow();
+    L.resize(n,n); L = 0;
+    Real logDet = 0;
+    for (int j=0; j < n; ++j) {
+        Real d = M(j,j);
+        for (int k=0; k < j; ++k) d -= square(L(j,k));
+        SimTK_TEST(d > 0);
+        L(j,j) = std::sqrt(d);
+        logDet += 2*std::log(L(j,j));
+        for (int i=j+1; i < n; ++i) {
+            Real s = M(i,j);
+            for (int k=0; k < j; ++k) s -= L(i,k)*L(j,k);
+            L(i,j) = s/L(j,j);
+        }
+    }
+    return logDet;
+}
+
+// A tree with most of the common mobilizer types, including a weld and a 
+// lone particle (a Translation mobilizer directly on Ground).
+static void buildSystem(SimbodyMatterSubsystem& matter) {
+    Body::Rigid body(MassProperties(1.3, Vec3(.1,.2,-.3),
+                                    UnitInertia(1.2,1.1,1.4,.1,.05,-.1)));
+    Body::Rigid particle(MassProperties(2.5, Vec3(0), UnitInertia(0)));
+    MobilizedBody::Free      free(matter.Ground(), Vec3(0), body, Vec3(0,1,0));
+    MobilizedBody::Pin       pin(free, Vec3(0,-1,0), body, Vec3(0,1,0));
+    MobilizedBody::Ball      ball(pin, Vec3(.2,-1,0), body, Vec3(0,1,0));
+    MobilizedBody::Weld      weld(ball, Vec3(0,-1,0), body, Vec3(0,1,0));
+    MobilizedBody::Universal univ(weld, Vec3(0,-1,0), body, Vec3(0,1,0));
+    MobilizedBody::Slider    slider(pin, Vec3(1,0,0), body, Vec3(0));
+    MobilizedBody::Gimbal    gimbal(matter.Ground(), Vec3(3,0,0), 
+                                    body, Vec3(0,1,0));
+    MobilizedBody::Screw     screw(gimbal, Vec3(0,-1,0), body, Vec3(0,1,0), .5);
+    MobilizedBody::Translation lone(matter.Ground(), particle);
+}
+
+void testLogDetM() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    buildSystem(matter);
+    State state = system.realizeTopology();
+
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(17);
+    for (int trial=0; trial < 5; ++trial) {
+        for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+        system.realize(state, Stage::Position);
+
+        Matrix M, L;
+        matter.calcM(state, M);
+        const Real logDetDense = denseCholeskyLogDet(M, L);
+        const Real logDetM = matter.calcLogDetM(state);
+        SimTK_TEST_EQ_TOL(logDetM, logDetDense, 1e-10);
+    }
+}
+
+void testBatchedSqrtMInv() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    buildSystem(matter);
+    State state = system.realizeTopology();
+    const int nu = state.getNU();
+
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(99);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    // The batched operator needs only Position stage, but calcMInv() and the
+    // single vector operator we compare against need Dynamics.
+    system.realize(state, Stage::Dynamics);
+
+    // S = sqrt(M^-1) must satisfy S*~S = M^-1, equivalently ~S*M*S = I.
+    Matrix identity(nu,nu); identity = 1;
+    Matrix S, M, MInv;
+    matter.multiplyBySqrtMInv(state, identity, S);
+    matter.calcM(state, M);
+    matter.calcMInv(state, MInv);
+    SimTK_TEST(S.nrow() == nu && S.ncol() == nu);
+    SimTK_TEST_EQ_TOL(S*~S, MInv, 1e-10);
+    SimTK_TEST_EQ_TOL(~S*M*S, identity, 1e-10);
+
+    // calcSqrtMInv() uses the same operator.
+    Matrix SqrtMInv;
+    matter.calcSqrtMInv(state, SqrtMInv);
+    SimTK_TEST_EQ_TOL(SqrtMInv, S, 1e-14);
+
+    // A batch of k random vectors must give the same answers as k separate
+    // calls to the single vector operator.
+    Random::Gaussian gauss(0, 1);
+    gauss.setSeed(5);
+    const int k = 7;
+    Matrix V(nu, k);
+    for (int j=0; j < k; ++j)
+        for (int i=0; i < nu; ++i)
+            V(i,j) = gauss.getValue();
+    Matrix U;
+    matter.multiplyBySqrtMInv(state, V, U);
+    for (int j=0; j < k; ++j) {
+        Vector u;
+        matter.multiplyBySqrtMInv(state, V(j), u);
+        SimTK_TEST_EQ_TOL(U(j), u, 1e-12);
+    }
+
+    SimTK_TEST_MUST_THROW(matter.multiplyBySqrtMInv(state, Matrix(nu+1,2), U));
+}
+
+int main() {
+    SimTK_START_TEST("TestMassMatrixFactors");
+        SimTK_SUBTEST(testLogDetM);
+        SimTK_SUBTEST(testBatchedSqrtMInv);
+    SimTK_END_TEST();
+}
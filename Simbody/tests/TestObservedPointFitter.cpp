@@ -200,9 +200,89 @@ static void testConstrained() {
     testObservedPointFitter(true);
 }
 
+// Return the RMS distance of the stations from their targets in state.
+static Real calcRMSError
+   (const MultibodySystem& mbs, State& state, 
+    const Array_<MobilizedBodyIndex>& bodyIxs, 
+    const Array_<Array_<Vec3> >& stations, 
+    const Array_<Array_<Vec3> >& targetLocations) 
+{
+    mbs.realize(state, Stage::Position);
+    const SimbodyMatterSubsystem& matter = mbs.getMatterSubsystem();
+    Real error = 0;
+    int numStations = 0;
+    for (int i = 0; i < (int)bodyIxs.size(); ++i) {
+        const MobilizedBody& body = matter.getMobilizedBody(bodyIxs[i]);
+        for (int j = 0; j < (int)stations[i].size(); ++j, ++numStations)
+            error += (targetLocations[i][j]-body.getBodyTransform(state)*stations[i][j]).normSqr();
+    }
+    return std::sqrt(error/numStations);
+}
+
+// Fit a smoothly moving chain of ball joints frame by frame, as from a motion
+// capture stream, both sequentially with warm starts and concurrently.
+static void testFitFrames() {
+    MultibodySystem mbs;
+    SimbodyMatterSubsystem matter(mbs);
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+    Array_<MobilizedBodyIndex> bodyIxs;
+    MobilizedBody parent = matter.Ground();
+    for (int i = 0; i < 5; ++i) {
+        MobilizedBody::Ball ball(parent, Transform(Vec3(0)), body, Transform(Vec3(0, BOND_LENGTH, 0)));
+        bodyIxs.push_back(ball.getMobilizedBodyIndex());
+        parent = ball;
+    }
+    mbs.realizeTopology();
+
+    Random::Uniform random(-1, 1);
+    random.setSeed(7);
+    Array_<Array_<Vec3> > stations(bodyIxs.size());
+    for (int i = 0; i < (int)bodyIxs.size(); ++i)
+        for (int j = 0; j < 3; ++j)
+            stations[i].push_back(Vec3(random.getValue(), random.getValue(), random.getValue()));
+
+    // Generate the targets from a known motion.
+    const int NumFrames = 12;
+    State truth = mbs.getDefaultState();
+    Array_<Array_<Array_<Vec3> > > frames(NumFrames);
+    for (int k = 0; k < NumFrames; ++k) {
+        for (int i = 0; i < (int)bodyIxs.size(); ++i) {
+            const Real angle = 0.3 + 0.05*k + 0.1*i;
+            matter.getMobilizedBody(bodyIxs[i]).setQToFitRotation(truth, Rotation(angle, UnitVec3(1, 1, i)));
+        }
+        mbs.realize(truth, Stage::Position);
+        frames[k].resize(bodyIxs.size());
+        for (int i = 0; i < (int)bodyIxs.size(); ++i)
+            for (int j = 0; j < (int)stations[i].size(); ++j)
+                frames[k][i].push_back(matter.getMobilizedBody(bodyIxs[i]).getBodyTransform(truth)*stations[i][j]);
+    }
+
+    ObservedPointFitter fitter(mbs, bodyIxs, stations, TOL);
+    State s = mbs.getDefaultState();
+    for (int k = 0; k < NumFrames; ++k) {
+        const Real reported = fitter.fitFrame(s, frames[k]);
+        const Real actual = calcRMSError(mbs, s, bodyIxs, stations, frames[k]);
+        SimTK_TEST_EQ_TOL(reported, actual, 1e-8);
+        SimTK_TEST(actual < 0.02);
+    }
+
+    Array_<State> states;
+    Array_<Real> errors;
+    fitter.fitFrames(mbs.getDefaultState(), frames, states, errors, 3);
+    SimTK_TEST(states.size() == NumFrames && errors.size() == NumFrames);
+    for (int k = 0; k < NumFrames; ++k) {
+        const Real actual = calcRMSError(mbs, states[k], bodyIxs, stations, frames[k]);
+        SimTK_TEST_EQ_TOL(errors[k], actual, 1e-8);
+        SimTK_TEST(actual < 0.02);
+    }
+
+    SimTK_TEST_MUST_THROW(fitter.fitFrames(mbs.getDefaultState(), frames, states, errors, -1));
+}
+
 int main() {
     SimTK_START_TEST("TestObservedPointFitter");
         SimTK_SUBTEST(testUnconstrained);
         SimTK_SUBTEST(testConstrained);
+        SimTK_SUBTEST(testFitFrames);
     SimTK_END_TEST();
 }
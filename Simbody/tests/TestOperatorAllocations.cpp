@@ -0,0 +1,151 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the mass matrix operators, the constraint operators built on
+// them, and the explicit M, M^-1, Pq, and G M^-1 ~G calculations don't touch
+// the heap once the State's operator workspace has grown to size. We count
+// allocations by replacing the global operator new (see AllocationCounter.h).
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+#include "AllocationCounter.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A chain with a mix of mobilizer types, closed into loops by a few
+// constraints so that G M^-1 ~G has more than one independent group.
+static void buildSystem(SimbodyMatterSubsystem& matter) {
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,.3),
+                                    UnitInertia(1.1,1.2,1.3,.1,.2,.3)));
+    for (int loop=0; loop < 3; ++loop) {
+        MobilizedBody parent = matter.Ground();
+        Array_<MobilizedBody> chain;
+        for (int i=0; i < 6; ++i) {
+            const Vec3 X_PF = i ? Vec3(0,-1,0) : Vec3(3*loop,0,0);
+            switch (i % 3) {
+            case 0: parent = MobilizedBody::Pin(parent, X_PF,
+                                                body, Vec3(0,1,0)); break;
+            case 1: parent = MobilizedBody::Ball(parent, X_PF,
+                                                 body, Vec3(0,1,0)); break;
+            case 2: parent = MobilizedBody::Slider(parent, X_PF,
+                                                   body, Vec3(0,1,0)); break;
+            }
+            chain.push_back(parent);
+        }
+        Constraint::Rod(matter.Ground(), Vec3(3*loop+1,-4,0),
+                        chain.back(), Vec3(0,-1,0), 2);
+        Constraint::Ball(chain[1], Vec3(1,0,0), chain[4], Vec3(0,1,0));
+    }
+}
+
+static void setRandomState(State& state, int seed) {
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(seed);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = rand.getValue();
+}
+
+void testTreeOperatorsAreAllocationFree() {
+    MultibodySystem        system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem  forces(system);
+    Force::UniformGravity  gravity(forces, matter, Vec3(0, -9.8, 0));
+    buildSystem(matter);
+    State state = system.realizeTopology();
+    const int nu = state.getNU(), nb = matter.getNumBodies();
+
+    Vector v(nu), Mv(nu), MInvv(nu), sqrtMInvv(nu), f(nu);
+    Vector_<SpatialVec> F_G(nb);
+    Matrix M(nu,nu), MInv(nu,nu);
+    for (int step=0; step < 6; ++step) {
+        setRandomState(state, step);
+        system.realize(state, Stage::Dynamics);
+        for (int i=0; i < nu; ++i) v[i] = i+step;
+        for (int b=0; b < nb; ++b) F_G[b] = SpatialVec(Vec3(b,1,step), 
+                                                       Vec3(1,-b,2));
+
+        const int before = allocationCount;
+        matter.multiplyByM(state, v, Mv);
+        matter.multiplyByMInv(state, Mv, MInvv);
+        matter.multiplyBySqrtMInv(state, v, sqrtMInvv);
+        matter.multiplyBySystemJacobianTranspose(state, F_G, f);
+        matter.calcM(state, M);
+        matter.calcMInv(state, MInv);
+        const int allocations = allocationCount - before;
+        // The first evaluations grow the workspace.
+        if (step >= 2) SimTK_TEST(allocations == 0);
+
+        // Make sure the reused workspace didn't change any answers.
+        SimTK_TEST_EQ_TOL(MInvv, v, 1e-10);
+        SimTK_TEST_EQ_TOL(M*v, Mv, 1e-10);
+        SimTK_TEST_EQ_TOL(MInv*Mv, v, 1e-10);
+    }
+}
+
+void testConstraintOperatorsAreAllocationFree() {
+    MultibodySystem        system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem  forces(system);
+    Force::UniformGravity  gravity(forces, matter, Vec3(0, -9.8, 0));
+    buildSystem(matter);
+    State state = system.realizeTopology();
+    const int nu = state.getNU(), nq = state.getNQ();
+
+    Matrix GMInvGt, G, MInv(nu,nu), Pq;
+    Vector biasp, qlike(nq), Pqqlike;
+    for (int step=0; step < 6; ++step) {
+        setRandomState(state, 10+step);
+        system.realize(state, Stage::Dynamics);
+        const int m = state.getNMultipliers();
+        const int mp = state.getNQErr() - matter.getNumQuaternionsInUse(state);
+        GMInvGt.resize(m,m);
+        Pq.resize(mp,nq);
+        biasp.resize(mp);
+        Pqqlike.resize(mp);
+        for (int i=0; i < nq; ++i) qlike[i] = i-step;
+
+        const int before = allocationCount;
+        matter.calcProjectedMInv(state, GMInvGt);
+        matter.calcPq(state, Pq);
+        matter.calcBiasForMultiplyByPq(state, biasp);
+        matter.multiplyByPq(state, qlike, biasp, Pqqlike);
+        const int allocations = allocationCount - before;
+        if (step >= 2) SimTK_TEST(allocations == 0);
+
+        SimTK_TEST_EQ_TOL(Pqqlike, Pq*qlike, 1e-10);
+
+        matter.calcG(state, G);
+        matter.calcMInv(state, MInv);
+        SimTK_TEST_EQ_TOL(GMInvGt, G*MInv*~G, 1e-8);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestOperatorAllocations");
+        SimTK_SUBTEST(testTreeOperatorsAreAllocationFree);
+        SimTK_SUBTEST(testConstraintOperatorsAreAllocationFree);
+    SimTK_END_TEST();
+}
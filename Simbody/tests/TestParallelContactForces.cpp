@@ -0,0 +1,141 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that CompliantContactSubsystem produces exactly the same contact 
+// forces, in the same order, whether they are calculated serially or on any
+// number of threads, and that the ground frame surface poses cached by the
+// ContactTrackerSubsystem are the ones we would calculate directly.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A block of overlapping spheres and ellipsoids sitting partly below the 
+// ground plane, all moving a little so that there is dissipation and 
+// friction too.
+static void buildSystem(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                        ContactTrackerSubsystem& tracker,
+                        Array_<MobilizedBody::Free>& bodies) {
+    ContactMaterial material(1e6, 0.1, .8, .6, .4);
+    matter.Ground().updBody().addContactSurface
+       (Rotation(-Pi/2, ZAxis), // y < 0
+        ContactSurface(ContactGeometry::HalfSpace(), material));
+
+    Body::Rigid sphere(MassProperties(1, Vec3(0), UnitInertia(1)));
+    sphere.addContactSurface(Transform(Vec3(.01,0,0)),
+        ContactSurface(ContactGeometry::Sphere(.6), material));
+    Body::Rigid ellipsoid(MassProperties(1, Vec3(0), UnitInertia(1)));
+    ellipsoid.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::Ellipsoid(Vec3(.45,.55,.5)), 
+                       material));
+    for (int i=0; i < 100; ++i)
+        bodies.push_back(MobilizedBody::Free(matter.Ground(), 
+            Vec3(i%5, .5+(i/5)%4, i/20), i%7 ? sphere : ellipsoid, Vec3(0)));
+}
+
+static bool isSame(const Vector_<SpatialVec>& a, const Vector_<SpatialVec>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+void testParallelMatchesSerial() {
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter(system);
+    ContactTrackerSubsystem     tracker(system);
+    CompliantContactSubsystem   contactForces(system, tracker);
+    Array_<MobilizedBody::Free> bodies;
+    buildSystem(system, matter, tracker, bodies);
+    SimTK_TEST(!contactForces.getUseParallelForceEvaluation());
+
+    State state = system.realizeTopology();
+    Random::Uniform rand(-.1, .1);
+    rand.setSeed(3);
+    for (unsigned i=0; i < bodies.size(); ++i) {
+        bodies[i].setQToFitRotation(state, 
+            Rotation(rand.getValue(), UnitVec3(1,1,rand.getValue())));
+        bodies[i].setUToFitLinearVelocity(state, 
+            Vec3(rand.getValue(), rand.getValue(), rand.getValue()));
+        bodies[i].setUToFitAngularVelocity(state, 
+            Vec3(rand.getValue(), rand.getValue(), rand.getValue()));
+    }
+    system.realize(state, Stage::Dynamics);
+
+    const Array_<Transform,ContactSurfaceIndex>& X_GS = 
+        tracker.getContactSurfaceTransformsInGround(state);
+    SimTK_TEST(X_GS.size() == tracker.getNumSurfaces());
+    for (ContactSurfaceIndex sx(0); sx < tracker.getNumSurfaces(); ++sx)
+        SimTK_TEST_EQ(X_GS[sx], tracker.getMobilizedBody(sx)
+            .findFrameTransformInGround(state, 
+                                        tracker.getContactSurfaceTransform(sx)));
+
+    const int nForces = contactForces.getNumContactForces(state);
+    cout << nForces << " contact forces from " 
+         << tracker.getActiveContacts(state).getNumContacts() 
+         << " active contacts." << endl;
+    SimTK_TEST(nForces > 200);
+    Array_<ContactForce> serial;
+    for (int i=0; i < nForces; ++i)
+        serial.push_back(contactForces.getContactForce(state, i));
+    const Vector_<SpatialVec> serialBodyForces = 
+        system.getRigidBodyForces(state, Stage::Dynamics);
+
+    // Recalculate the forces with the same active contacts.
+    contactForces.setUseParallelForceEvaluation(true);
+    const int numThreads[] = {1, 3, 8};
+    for (int t=0; t < 3; ++t) {
+        contactForces.setNumParallelForceThreads(numThreads[t]);
+        state.invalidateAll(Stage::Velocity);
+        system.realize(state, Stage::Dynamics);
+        SimTK_TEST(contactForces.getNumContactForces(state) == nForces);
+        for (int i=0; i < nForces; ++i) {
+            const ContactForce& f = contactForces.getContactForce(state, i);
+            SimTK_TEST(f.getContactId() == serial[i].getContactId());
+            SimTK_TEST(f.getContactPoint() == serial[i].getContactPoint());
+            SimTK_TEST(f.getForceOnSurface2() == serial[i].getForceOnSurface2());
+            SimTK_TEST(f.getPotentialEnergy() == serial[i].getPotentialEnergy());
+            SimTK_TEST(f.getPowerDissipation() == serial[i].getPowerDissipation());
+        }
+        SimTK_TEST(isSame(system.getRigidBodyForces(state, Stage::Dynamics),
+                          serialBodyForces));
+    }
+
+    // Below the threshold the forces are calculated on this thread, still
+    // with the same result.
+    contactForces.setParallelForceThreshold(nForces+1000);
+    state.invalidateAll(Stage::Velocity);
+    system.realize(state, Stage::Dynamics);
+    SimTK_TEST(isSame(system.getRigidBodyForces(state, Stage::Dynamics),
+                      serialBodyForces));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelContactForces");
+        SimTK_SUBTEST(testParallelMatchesSerial);
+    SimTK_END_TEST();
+}
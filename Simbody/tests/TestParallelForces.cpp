@@ -0,0 +1,160 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that parallel evaluation of force elements in a GeneralForceSubsystem
+// gives the same answers as serial evaluation, is deterministic, and honors
+// force elements that opt out of parallel evaluation.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A velocity-dependent custom force that records whether it was ever 
+// evaluated on a pool thread.
+class DampingForce : public Force::Custom::Implementation {
+public:
+    DampingForce(const MobilizedBody& body, Real c, bool allowParallel,
+                 bool& ranOnWorker) 
+    :   body(body), c(c), allowParallel(allowParallel), 
+        ranOnWorker(ranOnWorker) {}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
+                   Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
+    {
+        if (ParallelExecutor::isWorkerThread())
+            ranOnWorker = true;
+        const SpatialVec& V = body.getBodyVelocity(state);
+        body.applyBodyForce(state, SpatialVec(-c*V[0], -c*V[1]), bodyForces);
+    }
+    Real calcPotentialEnergy(const State& state) const {return 0;}
+    // Those that don't opt in get the default, which must be serial.
+    bool shouldBeParallelized() const {
+        return allowParallel 
+            || Force::Custom::Implementation::shouldBeParallelized();
+    }
+private:
+    MobilizedBody   body;
+    Real            c;
+    bool            allowParallel;
+    bool&           ranOnWorker;
+};
+
+// Vector has no operator==; we want exact equality here, not a tolerance.
+static bool isIdentical(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+static Vector calcUDot(const MultibodySystem& system, State& state) {
+    state.invalidateAll(Stage::Position);
+    system.realize(state, Stage::Acceleration);
+    return state.getUDot();
+}
+
+void testParallelForces() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity gravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+
+    // A row of pendulums, each connected to its neighbors by springs and 
+    // damped by custom forces; one of the dampers insists on serial 
+    // evaluation.
+    const int nBodies = 50;
+    Array_<MobilizedBody> bodies;
+    for (int i=0; i < nBodies; ++i)
+        bodies.push_back(MobilizedBody::Ball(matter.Ground(), Vec3(i,0,0), 
+                                             body, Vec3(0,1,0)));
+    bool parallelRanOnWorker = false, serialRanOnWorker = false;
+    for (int i=0; i < nBodies; ++i) {
+        if (i+1 < nBodies)
+            Force::TwoPointLinearSpring(forces, bodies[i], Vec3(.1,0,0), 
+                                        bodies[i+1], Vec3(-.1,0,0), 
+                                        10+i, .5);
+        const bool allowParallel = (i != 7);
+        Force::Custom(forces, new DampingForce(bodies[i], .1*(i+1), 
+            allowParallel, allowParallel ? parallelRanOnWorker 
+                                         : serialRanOnWorker));
+    }
+    Force::TwoPointLinearSpring disabled(forces, bodies[0], Vec3(0), 
+                                         bodies[2], Vec3(0), 1000, 0);
+    disabled.setDisabledByDefault(true);
+
+    State state = system.realizeTopology();
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(42);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = rand.getValue();
+
+    SimTK_TEST(!forces.getUseParallelForceEvaluation());
+    const Vector udotSerial = calcUDot(system, state);
+
+    forces.setUseParallelForceEvaluation(true);
+    forces.setParallelForceThreshold(1);
+    forces.setNumParallelForceThreads(4);
+    SimTK_TEST(forces.getUseParallelForceEvaluation());
+    SimTK_TEST(forces.getParallelForceThreshold() == 1);
+    SimTK_TEST(forces.getNumParallelForceThreads() == 4);
+
+    const Vector udotParallel = calcUDot(system, state);
+    SimTK_TEST_EQ_TOL(udotParallel, udotSerial, 1e-12);
+    SimTK_TEST(parallelRanOnWorker);
+    SimTK_TEST(!serialRanOnWorker);
+
+    // Repeated evaluations must be bit-identical.
+    for (int rep=0; rep < 5; ++rep)
+        SimTK_TEST(isIdentical(calcUDot(system, state), udotParallel));
+
+    // Change only the velocities so that the cached position-only forces 
+    // are reused while the velocity-dependent ones are recalculated.
+    state.updU() *= 2;
+    forces.setUseParallelForceEvaluation(false);
+    state.invalidateAll(Stage::Velocity);
+    system.realize(state, Stage::Acceleration);
+    const Vector udotSerial2 = state.getUDot();
+    forces.setUseParallelForceEvaluation(true);
+    state.invalidateAll(Stage::Velocity);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDot(), udotSerial2, 1e-12);
+
+    // With the threshold above the number of forces everything is serial
+    // and therefore identical to the serial answer.
+    forces.setParallelForceThreshold(1000);
+    state.updU() /= 2;
+    SimTK_TEST(isIdentical(calcUDot(system, state), udotSerial));
+
+    SimTK_TEST_MUST_THROW(forces.setParallelForceThreshold(0));
+    SimTK_TEST_MUST_THROW(forces.setNumParallelForceThreads(-1));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelForces");
+        SimTK_SUBTEST(testParallelForces);
+    SimTK_END_TEST();
+}
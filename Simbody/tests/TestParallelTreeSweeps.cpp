@@ -0,0 +1,145 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the parallel level-by-level tree sweeps produce exactly the same
+// (bit-identical) results as the ordinary serial sweeps.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Build a wide, shallow tree: many base bodies each carrying a short chain
+// of mixed mobilizer types so that every level has lots of independent bodies.
+static void buildWideTree(SimbodyMatterSubsystem& matter, int nBranches) {
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,.3),
+                                    UnitInertia(1.1,1.2,1.3,.1,.2,.3)));
+    for (int i=0; i < nBranches; ++i) {
+        MobilizedBody::Ball base(matter.Ground(), Vec3(i,0,0),
+                                 body, Vec3(0,1,0));
+        MobilizedBody::Pin link1(base, Vec3(0,-1,0), body, Vec3(0,1,0));
+        if (i % 2) {
+            MobilizedBody::Free link2(link1, Vec3(0,-1,0), body, Vec3(0,1,0));
+        } else {
+            MobilizedBody::Gimbal link2(link1, Vec3(0,-1,0),
+                                        body, Vec3(0,1,0));
+            MobilizedBody::Slider link3(link2, Vec3(0,-1,0),
+                                        body, Vec3(0,1,0));
+        }
+    }
+}
+
+// Vector has no operator==; we want exact equality here, not a tolerance.
+static bool isIdentical(const Vector& a, const Vector& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+static void setRandomState(State& state) {
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(123);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = rand.getValue();
+}
+
+// Realize through Acceleration and then copy out everything the tree sweeps
+// compute so it can be compared later.
+static void realizeAndRecord(const MultibodySystem& system, State& state,
+                             Vector_<SpatialVec>& vel, Vector_<SpatialVec>& acc,
+                             Array_<Transform>& X_GB, Vector& qdot,
+                             Vector& udot, Vector& qerr)
+{
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    state.invalidateAll(Stage::Position);
+    system.realize(state, Stage::Acceleration);
+    const int nb = matter.getNumBodies();
+    vel.resize(nb); acc.resize(nb); X_GB.resize(nb);
+    for (MobilizedBodyIndex bx(0); bx < nb; ++bx) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(bx);
+        X_GB[bx] = mobod.getBodyTransform(state);
+        vel[bx]  = mobod.getBodyVelocity(state);
+        acc[bx]  = mobod.getBodyAcceleration(state);
+    }
+    qdot = state.getQDot();
+    udot = state.getUDot();
+    qerr = state.getQErr();
+}
+
+void testBitIdentical() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity gravity(forces, matter, Vec3(0, -9.8, 0));
+    buildWideTree(matter, 40);
+
+    State state = system.realizeTopology();
+    setRandomState(state);
+
+    Vector_<SpatialVec> vel0, acc0, vel1, acc1;
+    Array_<Transform>   X0, X1;
+    Vector              qdot0, udot0, qerr0, qdot1, udot1, qerr1;
+
+    SimTK_TEST(!matter.getUseParallelTreeSweeps());
+    realizeAndRecord(system, state, vel0, acc0, X0, qdot0, udot0, qerr0);
+
+    // Force every level to be done in parallel, with more threads than we
+    // have processors so that this gets exercised even on one core.
+    matter.setUseParallelTreeSweeps(true);
+    matter.setParallelTreeSweepThreshold(1);
+    matter.setNumParallelTreeSweepThreads(4);
+    SimTK_TEST(matter.getUseParallelTreeSweeps());
+    SimTK_TEST(matter.getParallelTreeSweepThreshold() == 1);
+    SimTK_TEST(matter.getNumParallelTreeSweepThreads() == 4);
+
+    for (int rep=0; rep < 3; ++rep) {
+        realizeAndRecord(system, state, vel1, acc1, X1, qdot1, udot1, qerr1);
+        for (int i=0; i < matter.getNumBodies(); ++i) {
+            SimTK_TEST(X1[i].p() == X0[i].p());
+            SimTK_TEST(X1[i].R().asMat33() == X0[i].R().asMat33());
+            SimTK_TEST(vel1[i] == vel0[i]);
+            SimTK_TEST(acc1[i] == acc0[i]);
+        }
+        SimTK_TEST(isIdentical(qdot1, qdot0));
+        SimTK_TEST(isIdentical(udot1, udot0));
+        SimTK_TEST(isIdentical(qerr1, qerr0));
+    }
+
+    // A threshold above the widest level means everything is serial again.
+    matter.setParallelTreeSweepThreshold(1000);
+    realizeAndRecord(system, state, vel1, acc1, X1, qdot1, udot1, qerr1);
+    SimTK_TEST(isIdentical(udot1, udot0));
+
+    SimTK_TEST_MUST_THROW(matter.setParallelTreeSweepThreshold(0));
+    SimTK_TEST_MUST_THROW(matter.setNumParallelTreeSweepThreads(-1));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelTreeSweeps");
+        SimTK_SUBTEST(testBitIdentical);
+    SimTK_END_TEST();
+}
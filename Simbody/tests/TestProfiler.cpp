@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the System's Profiler records realization times by Stage,
+// Subsystem, and Force when enabled, and records nothing when disabled.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static void buildSystem(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                        GeneralForceSubsystem& forces, int nBodies) {
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody parent = matter.Ground();
+    for (int i=0; i < nBodies; ++i) {
+        MobilizedBody::Pin pin(parent, Vec3(0,-1,0), body, Vec3(0));
+        Force::MobilityLinearSpring(forces, pin, MobilizerQIndex(0), 10, 0);
+        parent = pin;
+    }
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+}
+
+static const Profiler::Entry& getEntry(const Profiler& profiler,
+                                       const String& category,
+                                       const String& name, Stage stage) {
+    const int i = profiler.findEntry(category, name, stage);
+    SimTK_TEST(i >= 0);
+    return profiler.getEntry(i);
+}
+
+void testDisabledRecordsNothing() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, matter, forces, 3);
+
+    SimTK_TEST(!system.getProfiler().isEnabled());
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(system.getProfiler().getNumEntries() == 0);
+}
+
+void testRealizeProfile() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, matter, forces, 3);
+    system.updProfiler().setEnabled(true);
+
+    State state = system.realizeTopology();
+    const int nSteps = 5;
+    for (int i=0; i < nSteps; ++i) {
+        state.updTime() = i;
+        system.realize(state, Stage::Acceleration);
+    }
+
+    const Profiler& profiler = system.getProfiler();
+    const Profiler::Entry& sysTopo =
+        getEntry(profiler, "System", system.getName(), Stage::Topology);
+    SimTK_TEST(sysTopo.numCalls == 1);
+
+    const Profiler::Entry& sysDyn =
+        getEntry(profiler, "System", system.getName(), Stage::Dynamics);
+    SimTK_TEST(sysDyn.numCalls == nSteps);
+    SimTK_TEST(sysDyn.minWallTime <= sysDyn.getMeanWallTime());
+    SimTK_TEST(sysDyn.getMeanWallTime() <= sysDyn.maxWallTime);
+
+    // Subsystem times are nested inside the System time for the same Stage.
+    const Profiler::Entry& forceDyn =
+        getEntry(profiler, "Subsystem", forces.getName(), Stage::Dynamics);
+    SimTK_TEST(forceDyn.numCalls == nSteps);
+    SimTK_TEST(forceDyn.wallTime <= sysDyn.wallTime);
+    getEntry(profiler, "Subsystem", matter.getName(), Stage::Position);
+
+    // One entry per Force element, each evaluated once per step.
+    for (int i=0; i < forces.getNumForces(); ++i) {
+        const Profiler::Entry& e =
+            getEntry(profiler, "Force", String(i), Stage::Dynamics);
+        SimTK_TEST(e.numCalls == nSteps);
+    }
+
+    // Re-realizing Acceleration from Dynamics doesn't redo Position, and the
+    // springs, which depend only on positions, aren't recalculated.
+    const long long nPos =
+        getEntry(profiler, "System", system.getName(), Stage::Position)
+            .numCalls;
+    state.invalidateAll(Stage::Dynamics);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(getEntry(profiler, "System", system.getName(),
+                        Stage::Position).numCalls == nPos);
+    SimTK_TEST(getEntry(profiler, "System", system.getName(),
+                        Stage::Dynamics).numCalls == nSteps+1);
+    SimTK_TEST(getEntry(profiler, "Force", "0", Stage::Dynamics).numCalls
+               == nSteps);
+
+    std::ostringstream table, json;
+    profiler.writeTable(table);
+    profiler.writeJSON(json);
+    cout << table.str();
+    SimTK_TEST(table.str().find("Subsystem") != std::string::npos);
+    SimTK_TEST(json.str().find("\"category\": \"Force\"") != std::string::npos);
+
+    system.updProfiler().clear();
+    SimTK_TEST(system.getProfiler().getNumEntries() == 0);
+    SimTK_TEST(system.getProfiler().isEnabled());
+}
+
+// When forces are evaluated on the thread pool each Force must still show up
+// exactly once per evaluation.
+void testParallelForces() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, matter, forces, 40);
+    forces.setUseParallelForceEvaluation(true);
+    forces.setNumParallelForceThreads(4);
+    system.updProfiler().setEnabled(true);
+
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Acceleration);
+    const Profiler& profiler = system.getProfiler();
+    for (int i=0; i < forces.getNumForces(); ++i)
+        SimTK_TEST(getEntry(profiler, "Force", String(i), Stage::Dynamics)
+                   .numCalls == 1);
+}
+
+int main() {
+    SimTK_START_TEST("TestProfiler");
+        SimTK_SUBTEST(testDisabledRecordsNothing);
+        SimTK_SUBTEST(testRealizeProfile);
+        SimTK_SUBTEST(testParallelForces);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,202 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that a Visualizer created with createRecorder() writes a recording
+// that can be opened with Visualizer::Recording and played back, starting at 
+// any frame, by another Visualizer. Here the player is itself a recorder so
+// that the playback can be checked without a display.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static const char* FileName = "TestVisualizerRecording.simviz";
+static const char* CopyName = "TestVisualizerRecordingCopy.simviz";
+static const char* CopyOfCopyName = "TestVisualizerRecordingCopy2.simviz";
+static const int NumFrames = 50;
+static const int CameraFrame = 20;  // camera moves just before this frame
+static const int NewMeshFrame = 31; // second mesh first drawn in this frame
+
+static PolygonalMesh makeTetrahedron(Real size) {
+    PolygonalMesh mesh;
+    mesh.addVertex(Vec3(0));
+    mesh.addVertex(Vec3(size,0,0));
+    mesh.addVertex(Vec3(0,size,0));
+    mesh.addVertex(Vec3(0,0,size));
+    const int faces[4][3] = {{0,2,1}, {0,1,3}, {0,3,2}, {1,2,3}};
+    for (int i=0; i < 4; ++i) {
+        Array_<int> face(faces[i], faces[i]+3);
+        mesh.addFace(face);
+    }
+    return mesh;
+}
+
+static long long fileSize(const char* fileName) {
+    FILE* f = fopen(fileName, "rb");
+    SimTK_TEST(f != 0);
+    fseek(f, 0, SEEK_END);
+    const long long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static void record() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity gravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+    body.addDecoration(Transform(), DecorativeSphere(.1).setColor(Red));
+    body.addDecoration(Transform(), DecorativeMesh(makeTetrahedron(.2)));
+    MobilizedBody::Pin pendulum(matter.Ground(), Transform(), 
+                                body, Vec3(0, 1, 0));
+    State state = system.realizeTopology();
+
+    Visualizer viz = Visualizer::createRecorder(system, FileName);
+    SimTK_TEST(viz.isRecording());
+    viz.addDecoration(MobilizedBodyIndex(0), Vec3(0),
+                      DecorativeLine(Vec3(-1,0,0), Vec3(1,0,0)));
+    Array_<std::pair<String,int> > items;
+    items.push_back(std::make_pair(String("Quit"), 1));
+    viz.addMenu("Run", 1, items);
+    viz.addSlider("Speed", 1, 0, 2, 1);
+    viz.setCameraTransform(Vec3(0, 0, 5));
+    for (int i=0; i < NumFrames; ++i) {
+        if (i == CameraFrame)
+            viz.setCameraTransform(Vec3(0, 0, 7));
+        if (i == NewMeshFrame)
+            viz.addDecoration(MobilizedBodyIndex(0), Vec3(0),
+                              DecorativeMesh(makeTetrahedron(.5)));
+        state.updTime() = .01*i;
+        pendulum.setOneQ(state, 0, .02*i);
+        viz.report(state);
+    }
+    SimTK_TEST(viz.getNumDroppedFrames() == 0);
+}   // The recording is finished when the Visualizer is deleted.
+
+// Play a recording, starting at the given frame, into a new recording.
+static void copy(const Visualizer::Recording& recording, int firstFrame,
+                 const char* copyName) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Visualizer player = Visualizer::createRecorder(system, copyName);
+    player.playRecording(recording, firstFrame);
+    SimTK_TEST(player.getNumDroppedFrames() == 0);
+}
+
+void testRecording() {
+    record();
+    const Visualizer::Recording recording(FileName);
+    SimTK_TEST(recording.getFileName() == FileName);
+    SimTK_TEST(recording.getNumFrames() == NumFrames);
+    for (int i=0; i < NumFrames; ++i)
+        SimTK_TEST_EQ(recording.getFrameTime(i), .01*i);
+    SimTK_TEST(recording.findFrame(-1) == 0);
+    SimTK_TEST(recording.findFrame(.105) == 11);
+    SimTK_TEST(recording.findFrame(.01*CameraFrame) == CameraFrame);
+    SimTK_TEST(recording.findFrame(1) == NumFrames);
+    SimTK_TEST_MUST_THROW(recording.getFrameTime(NumFrames));
+}
+
+// Starting playback at any frame gives a recording of the rest of the frames
+// that is itself complete and playable from any of its frames. Starting 
+// later leaves out frames but not the setup (meshes, menus, camera) that the
+// remaining frames depend on.
+void testPlayback() {
+    record();
+    const Visualizer::Recording recording(FileName);
+    const int starts[] = {0, CameraFrame, NewMeshFrame, NumFrames-1, NumFrames};
+    long long prevSize = 0;
+    for (int k=0; k < 5; ++k) {
+        const int start = starts[k];
+        copy(recording, start, CopyName);
+        const Visualizer::Recording copied(CopyName);
+        SimTK_TEST(copied.getNumFrames() == NumFrames-start);
+        for (int i=0; i < copied.getNumFrames(); ++i)
+            SimTK_TEST_EQ(copied.getFrameTime(i), recording.getFrameTime(start+i));
+
+        // Each frame that is left out shrinks the copy by more than its 
+        // index entry, but the setup is all still there.
+        const long long size = fileSize(CopyName);
+        if (k > 0)
+            SimTK_TEST(size < prevSize);
+        prevSize = size;
+
+        // The copy plays back again just the same.
+        if (copied.getNumFrames() > 0) {
+            const int last = copied.getNumFrames()-1;
+            copy(copied, last, CopyOfCopyName);
+            const Visualizer::Recording again(CopyOfCopyName);
+            SimTK_TEST(again.getNumFrames() == 1);
+            SimTK_TEST_EQ(again.getFrameTime(0), copied.getFrameTime(last));
+        }
+    }
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Visualizer player = Visualizer::createRecorder(system, CopyName);
+    SimTK_TEST_MUST_THROW(player.playRecording(recording, NumFrames+1));
+    SimTK_TEST_MUST_THROW(player.playRecording(recording, -1));
+    SimTK_TEST_MUST_THROW(player.playRecording(recording, 0, 0));
+}
+
+// A recording that wasn't finished, or isn't a recording, is rejected.
+void testBadRecording() {
+    record();
+    FILE* f = fopen(FileName, "rb");
+    std::vector<char> contents;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        contents.insert(contents.end(), buffer, buffer+n);
+    fclose(f);
+
+    f = fopen(FileName, "wb");
+    fwrite(&contents[0], 1, contents.size()-1, f);
+    fclose(f);
+    SimTK_TEST_MUST_THROW(Visualizer::Recording recording(FileName));
+
+    f = fopen(FileName, "wb");
+    fwrite("not a recording", 1, 15, f);
+    fclose(f);
+    SimTK_TEST_MUST_THROW(Visualizer::Recording recording(FileName));
+
+    remove(FileName);
+    remove(CopyName);
+    remove(CopyOfCopyName);
+    SimTK_TEST_MUST_THROW(Visualizer::Recording recording(FileName));
+}
+
+int main() {
+    SimTK_START_TEST("TestVisualizerRecording");
+        SimTK_SUBTEST(testRecording);
+        SimTK_SUBTEST(testPlayback);
+        SimTK_SUBTEST(testBadRecording);
+    SimTK_END_TEST();
+}
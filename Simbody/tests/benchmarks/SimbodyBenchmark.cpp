@@ -0,0 +1,1390 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+This is the Simbody benchmark suite. It measures the CPU time for the 
+multibody operators (realization, multiplyByM, multiplyByMInv, and so on) on a
+variety of model families whose sizes range from 10 to 100,000 bodies, along
+with compliant contact, contact broad phase, big triangle mesh, Visualizer, 
+constrained dynamics, State checkpoint, spatial algebra kernel, marker 
+fitting, and integrator scenarios.
+
+Each time is also given in "flops", that is, as a multiple of the time taken
+by an average add or multiply on this machine, measured at startup. Flop
+counts are much less sensitive to the machine than raw times, so results from
+one machine are a usable baseline on another.
+
+Results can be written as JSON and compared against the JSON from an earlier
+run; any benchmark whose flop count grew by more than the tolerance is 
+reported as a regression and the program exits with status 1.
+
+Usage: SimbodyBenchmark [options]
+  --json file       write the results as JSON to file
+  --compare file    compare against results written earlier with --json
+  --tolerance frac  fractional slowdown considered a regression (0.15)
+  --max-bodies n    skip models with more than n bodies (100000)
+  --min-time sec    least CPU time spent measuring each benchmark (0.1)
+  --filter text     run only benchmarks whose id contains text
+  --mesh-dir dir    where to find the ContactBigMeshes_*.obj meshes (.)
+
+Each benchmark has an id of the form family/operation/bodies, for example
+"PinChain/multiplyByMInv/1000". **/
+
+#include "SimTKsimbody.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace SimTK;
+
+//==============================================================================
+//                            OPTIONS AND RESULTS
+//==============================================================================
+struct Options {
+    Options() : tolerance(0.15), maxBodies(100000), minTime(0.1), 
+                meshDir(".") {}
+    std::string jsonFile, compareFile, filter;
+    double      tolerance;
+    int         maxBodies;
+    double      minTime;
+    std::string meshDir;
+};
+
+struct Result {
+    std::string id;
+    int         bodies, dofs;
+    double      timeUs; // CPU time per call
+    double      flops;  // the same time, in units of one flop
+};
+
+static Options          options;
+static double           flopTimeNs;
+static Array_<Result>   results;
+
+static std::string makeId(const char* family, const char* operation, 
+                          int bodies) {
+    return std::string(family) + "/" + operation + "/" + String(bodies);
+}
+
+static bool isSelected(const std::string& id) {
+    return id.find(options.filter) != std::string::npos;
+}
+
+static void record(const std::string& id, int bodies, int dofs, 
+                   double seconds) {
+    Result r;
+    r.id = id; r.bodies = bodies; r.dofs = dofs;
+    r.timeUs = 1e6*seconds;
+    r.flops = 1e9*seconds/flopTimeNs;
+    results.push_back(r);
+    std::printf("%-52s %12.3fus %12.4g flp %8.0f flp/dof\n", id.c_str(), 
+                r.timeUs, r.flops, r.flops/std::max(dofs,1));
+    std::fflush(stdout);
+}
+
+
+
+//==============================================================================
+//                                FLOP TIME
+//==============================================================================
+// Measure the time for one flop, taken as the average of the time for an add
+// and a multiply. The results are returned through "sink" so that the loops
+// can't be optimized away.
+static double measureFlopTimeInNs(double& sink) {
+    Real addRes=1, mulRes=1;
+    const int n = 100000000; // 10*n operations each
+
+    double tprev = threadCpuTime();
+    for (int i = 0; i < n; i++) {
+        addRes += 1.1;
+        addRes += 1.2;
+        addRes += 1.3;
+        addRes += 1.4;
+        addRes += 1.501;
+        addRes += 1.6;
+        addRes += 1.7;
+        addRes += 1.8;
+        addRes += 1.9;
+        addRes += 2.007;
+    }
+    double t = threadCpuTime(); const double addTime = (t-tprev)/(10.*n);
+    tprev = threadCpuTime();
+    for (int i = 0; i < n; i++) {
+        mulRes *= 0.501;
+        mulRes *= 0.2501;
+        mulRes *= 0.201;
+        mulRes *= 0.101;
+        mulRes *= 1.000000001;
+        mulRes *= (1/1.000000002); // done at compile time
+        mulRes *= (1/.101);
+        mulRes *= (1/.201);
+        mulRes *= (1/.2501);
+        mulRes *= (1/.501);
+    }
+    t = threadCpuTime(); const double mulTime = (t-tprev)/(10.*n);
+    sink = addRes + mulRes;
+    return 1e9*(addTime+mulTime)/2;
+}
+
+
+
+//==============================================================================
+//                                  TIMING
+//==============================================================================
+typedef void (*Operation)(const MultibodySystem& system, State& state);
+
+// Return the CPU time for one call of the operation. The number of calls is
+// doubled until a batch takes at least a third of the minimum time; the 
+// result is the best of three such batches.
+static double timeOperation(Operation op, const MultibodySystem& system, 
+                            State& state) {
+    op(system, state); // warm up
+    int calls = 1;
+    double best;
+    for (;;) {
+        const double start = threadCpuTime();
+        for (int i = 0; i < calls; i++)
+            op(system, state);
+        best = threadCpuTime()-start;
+        if (best >= options.minTime/3 || calls >= (1<<24))
+            break;
+        calls *= 2;
+    }
+    for (int rep = 0; rep < 2; rep++) {
+        const double start = threadCpuTime();
+        for (int i = 0; i < calls; i++)
+            op(system, state);
+        best = std::min(best, threadCpuTime()-start);
+    }
+    return best/calls;
+}
+
+
+
+//==============================================================================
+//                               OPERATIONS
+//==============================================================================
+static void doRealizePosition(const MultibodySystem& system, State& state) {
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    system.realize(state, Stage::Position);
+}
+
+static void doRealizeVelocity(const MultibodySystem& system, State& state) {
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    system.realize(state, Stage::Velocity);
+}
+
+static void doRealizeDynamics(const MultibodySystem& system, State& state) {
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    system.realize(state, Stage::Dynamics);
+}
+
+static void doRealizeAcceleration(const MultibodySystem& system, State& state) {
+    state.invalidateAllCacheAtOrAbove(Stage::Time);
+    system.realize(state, Stage::Acceleration);
+}
+
+static void doMultiplyByM(const MultibodySystem& system, State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Vector v(matter.getNumMobilities(), 1.0);
+    Vector mv;
+    matter.multiplyByM(state, v, mv);
+}
+
+static void doMultiplyByMInv(const MultibodySystem& system, State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Vector v(matter.getNumMobilities(), 1.0);
+    Vector minvv;
+    matter.multiplyByMInv(state, v, minvv);
+}
+
+static void doCalcResidualForceIgnoringConstraints
+   (const MultibodySystem& system, State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Vector appliedMobilityForces(matter.getNumMobilities(), 1.0);
+    Vector_<SpatialVec> appliedBodyForces(matter.getNumBodies(), 
+                                          SpatialVec(Vec3(1, 0, 0), Vec3(0, 1, 0)));
+    Vector knownUdot, residualMobilityForces;
+    matter.calcResidualForceIgnoringConstraints(state, appliedMobilityForces, 
+        appliedBodyForces, knownUdot, residualMobilityForces);
+}
+
+static void doCalcMobilizerReactionForces(const MultibodySystem& system, 
+                                          State& state) {
+    Vector_<SpatialVec> forces;
+    system.getMatterSubsystem().calcMobilizerReactionForces(state, forces);
+}
+
+static void doMultiplyBySystemJacobianTranspose(const MultibodySystem& system, 
+                                                State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Vector_<SpatialVec> dEdR(matter.getNumBodies(), 
+                             SpatialVec(Vec3(1, 0, 0), Vec3(0, 1, 0)));
+    Vector dEdQ;
+    matter.multiplyBySystemJacobianTranspose(state, dEdR, dEdQ);
+}
+
+static void doCalcCompositeBodyInertias(const MultibodySystem& system, 
+                                        State& state) {
+    Array_<SpatialInertia, MobilizedBodyIndex> r;
+    system.getMatterSubsystem().calcCompositeBodyInertias(state, r);
+}
+
+static void doCalcProjectedMInv(const MultibodySystem& system, State& state) {
+    Matrix GMInvGt;
+    system.getMatterSubsystem().calcProjectedMInv(state, GMInvGt);
+}
+
+struct NamedOperation {
+    const char* name;
+    Operation   op;
+};
+
+static const NamedOperation treeOperations[] = {
+    {"realizePosition",                     doRealizePosition},
+    {"realizeVelocity",                     doRealizeVelocity},
+    {"realizeAcceleration",                 doRealizeAcceleration},
+    {"multiplyByM",                         doMultiplyByM},
+    {"multiplyByMInv",                      doMultiplyByMInv},
+    {"calcResidualForceIgnoringConstraints",doCalcResidualForceIgnoringConstraints},
+    {"calcMobilizerReactionForces",         doCalcMobilizerReactionForces},
+    {"multiplyBySystemJacobianTranspose",   doMultiplyBySystemJacobianTranspose},
+    {"calcCompositeBodyInertias",           doCalcCompositeBodyInertias}
+};
+static const int NumTreeOperations = 
+    (int)(sizeof(treeOperations)/sizeof(treeOperations[0]));
+
+
+
+//==============================================================================
+//                              MODEL FAMILIES
+//==============================================================================
+// These add n identical bodies to the matter subsystem, in various 
+// arrangements: all attached directly to ground, linked in a single chain, or
+// arranged as a binary tree.
+
+static void createParticles(SimbodyMatterSubsystem& matter, int n) {
+    Body::Rigid body;
+    for (int i = 0; i < n; i++)
+        MobilizedBody::Translation next(matter.updGround(), Vec3(1, 0, 0), body, Vec3(0));
+}
+
+static void createFreeBodies(SimbodyMatterSubsystem& matter, int n) {
+    Body::Rigid body;
+    for (int i = 0; i < n; i++)
+        MobilizedBody::Free next(matter.updGround(), Vec3(1, 0, 0), body, Vec3(0));
+}
+
+template <class M>
+static void createChain(SimbodyMatterSubsystem& matter, int n) {
+    Body::Rigid body;
+    MobilizedBody last = matter.updGround();
+    for (int i = 0; i < n; i++) {
+        M next(last, Vec3(1, 0, 0), body, Vec3(0));
+        last = next;
+    }
+}
+
+template <class M>
+static void createTree(SimbodyMatterSubsystem& matter, int n) {
+    Body::Rigid body;
+    for (int i = 0; i < n; i++) {
+        MobilizedBody& parent = matter.updMobilizedBody(MobilizedBodyIndex(i/2));
+        M next(parent, Vec3(1, 0, 0), body, Vec3(0));
+    }
+}
+
+struct Family {
+    const char* name;
+    void      (*create)(SimbodyMatterSubsystem& matter, int n);
+    bool        useEulerAngles;
+};
+
+static const Family families[] = {
+    {"Particles",           createParticles,                        false},
+    {"FreeBodies",          createFreeBodies,                       false},
+    {"FreeBodiesEuler",     createFreeBodies,                       true},
+    {"PinChain",            createChain<MobilizedBody::Pin>,        false},
+    {"SliderChain",         createChain<MobilizedBody::Slider>,     false},
+    {"BallChain",           createChain<MobilizedBody::Ball>,       false},
+    {"BallChainEuler",      createChain<MobilizedBody::Ball>,       true},
+    {"GimbalChain",         createChain<MobilizedBody::Gimbal>,     false},
+    {"PinTree",             createTree<MobilizedBody::Pin>,         false},
+    {"BallTree",            createTree<MobilizedBody::Ball>,        false}
+};
+static const int NumFamilies = (int)(sizeof(families)/sizeof(families[0]));
+
+static const int sizes[] = {10, 100, 1000, 10000, 100000};
+static const int NumSizes = (int)(sizeof(sizes)/sizeof(sizes[0]));
+
+static bool anySelected(const char* family, const NamedOperation ops[], 
+                        int nOps, int bodies) {
+    for (int i = 0; i < nOps; i++)
+        if (isSelected(makeId(family, ops[i].name, bodies)))
+            return true;
+    return false;
+}
+
+static void runOperations(const char* family, const NamedOperation ops[],
+                          int nOps, int bodies, const MultibodySystem& system,
+                          State& state) {
+    const int dofs = system.getMatterSubsystem().getNumMobilities();
+    for (int i = 0; i < nOps; i++) {
+        const std::string id = makeId(family, ops[i].name, bodies);
+        if (isSelected(id))
+            record(id, bodies, dofs, timeOperation(ops[i].op, system, state));
+    }
+}
+
+static void runTreeBenchmarks() {
+    for (int f = 0; f < NumFamilies; f++) {
+        const Family& family = families[f];
+        for (int s = 0; s < NumSizes && sizes[s] <= options.maxBodies; s++) {
+            if (!anySelected(family.name, treeOperations, NumTreeOperations, 
+                             sizes[s]))
+                continue;
+            MultibodySystem system;
+            SimbodyMatterSubsystem matter(system);
+            family.create(matter, sizes[s]);
+            system.realizeTopology();
+            State state = system.getDefaultState();
+            if (family.useEulerAngles) {
+                matter.setUseEulerAngles(state, true);
+                system.realizeModel(state);
+            }
+            system.realize(state, Stage::Acceleration);
+            runOperations(family.name, treeOperations, NumTreeOperations, 
+                          sizes[s], system, state);
+        }
+    }
+}
+
+
+
+//==============================================================================
+//                                 CONTACT
+//==============================================================================
+// Free spheres arranged in a square grid, each resting slightly penetrated on
+// a halfspace floor, with compliant contact. Evaluating the forces requires
+// finding all the contacts and computing a Hunt-Crossley force for each.
+static void runContactBenchmarks() {
+    static const NamedOperation ops[] = {
+        {"realizeDynamics", doRealizeDynamics}
+    };
+    const int maxBodies = std::min(options.maxBodies, 10000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++) {
+        const int n = sizes[s];
+        if (!anySelected("SphereContact", ops, 1, n))
+            continue;
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+        ContactTrackerSubsystem tracker(system);
+        CompliantContactSubsystem contact(system, tracker);
+        const ContactMaterial material(1e6, 0.5, 0.8, 0.7, 0.5);
+        matter.Ground().updBody().addContactSurface(
+            Transform(Rotation(-Pi/2, ZAxis), Vec3(0)),
+            ContactSurface(ContactGeometry::HalfSpace(), material));
+
+        const Real radius = 0.1;
+        Body::Rigid ball(MassProperties(1, Vec3(0), UnitInertia(.4*radius*radius)));
+        ball.addContactSurface(Transform(), 
+            ContactSurface(ContactGeometry::Sphere(radius), material));
+        const int side = (int)std::ceil(std::sqrt((double)n));
+        for (int i = 0; i < n; i++)
+            MobilizedBody::Free(matter.Ground(), 
+                Vec3(3*radius*(i%side), .9*radius, 3*radius*(i/side)), 
+                ball, Vec3(0));
+
+        State state = system.realizeTopology();
+        system.realize(state, Stage::Acceleration);
+        runOperations("SphereContact", ops, 1, n, system, state);
+    }
+}
+
+
+
+//==============================================================================
+//                               BROAD PHASE
+//==============================================================================
+// Spheres clustered in a square layer one sphere thick, so that they overlap
+// heavily along any single axis, each drifting back and forth a little 
+// between evaluations. The side of the layer grows with sqrt(n) so that the
+// density stays fixed. The reported time is per call of the 
+// ContactTrackerSubsystem's findBroadPhasePairs() with the given method.
+static void runBroadPhaseBenchmark
+   (const char* name, ContactTrackerSubsystem::BroadPhaseMethod method, int n)
+{
+    const std::string id = makeId("ClusteredSpheres", name, n);
+    if (!isSelected(id))
+        return;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    ContactTrackerSubsystem tracker(system);
+    tracker.setBroadPhaseMethod(method);
+    const ContactMaterial material(1e6, 0, .5, .5, .5);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    body.addContactSurface(Vec3(0), 
+        ContactSurface(ContactGeometry::Sphere(.5), material));
+    Array_<MobilizedBody> bodies;
+    for (int i = 0; i < n; i++)
+        bodies.push_back(MobilizedBody::Free(matter.Ground(), body));
+    State state = system.realizeTopology();
+
+    Random::Uniform rand(0, 1);
+    rand.setSeed(42);
+    const Real side = 1.2*std::sqrt((Real)n);
+    Array_<Vec3> pos(n), vel(n);
+    for (int i = 0; i < n; i++) {
+        pos[i] = Vec3(side*rand.getValue(), .1*rand.getValue(), 
+                      side*rand.getValue());
+        vel[i] = Vec3(rand.getValue()-.5, 0, rand.getValue()-.5);
+    }
+
+    // Move and evaluate until enough time has been spent in the broad phase,
+    // then repeat twice more from the same starting State, keeping the best 
+    // time per call. Only findBroadPhasePairs() is timed.
+    Array_< std::pair<ContactSurfaceIndex,ContactSurfaceIndex> > pairs;
+    double best = Infinity;
+    for (int rep = 0; rep < 3; rep++) {
+        State s = state;
+        double elapsed = 0;
+        int calls = 0;
+        while (elapsed < options.minTime/3) {
+            const Real offset = std::sin(.05*calls);
+            for (int i = 0; i < n; i++)
+                bodies[i].setQToFitTranslation(s, pos[i] + offset*vel[i]);
+            system.realize(s, Stage::Position);
+            const double start = threadCpuTime();
+            tracker.findBroadPhasePairs(s, pairs);
+            elapsed += threadCpuTime()-start;
+            ++calls;
+        }
+        best = std::min(best, elapsed/calls);
+    }
+    record(id, n, state.getNU(), best);
+}
+
+static void runBroadPhaseBenchmarks() {
+    const int maxBodies = std::min(options.maxBodies, 10000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++) {
+        runBroadPhaseBenchmark("SingleAxisSweep", 
+            ContactTrackerSubsystem::SingleAxisSweep, sizes[s]);
+        runBroadPhaseBenchmark("IncrementalSweepAndPrune", 
+            ContactTrackerSubsystem::IncrementalSweepAndPrune, sizes[s]);
+    }
+}
+
+
+
+//==============================================================================
+//                               BIG MESHES
+//==============================================================================
+// The two unreasonably dense meshes of the ContactBigMeshes demo, a femur and
+// a patella, exercise the TriangleMesh OBB tree. Times are for building each
+// mesh (which builds its OBB tree), for nearest-point and ray queries against
+// the femur from points scattered through a box a bit larger than its 
+// bounding box, and for evaluating compliant contact forces with the patella
+// placed so that the bounding boxes overlap deeply while very few faces 
+// touch, which makes the tree-tree traversal do most of the work. Contact 
+// forces may be computed on several threads, so that one is timed by the 
+// clock. The checksums printed after the queries and the contact should not
+// change when the tree implementation does. The meshes are read from the 
+// --mesh-dir directory; if they aren't there these benchmarks are skipped.
+static bool loadBigMesh(const char* name, PolygonalMesh& mesh) {
+    const std::string fileName = 
+        options.meshDir + "/ContactBigMeshes_" + name + ".obj";
+    std::ifstream file(fileName.c_str());
+    if (!file.good()) {
+        std::printf("Skipping the BigMesh benchmarks: can't open %s.\n", 
+                    fileName.c_str());
+        return false;
+    }
+    mesh.loadObjFile(file);
+    return true;
+}
+
+// Call op() repeatedly until at least the minimum time has been spent, then
+// twice more with the same number of calls, and return the best time per 
+// call. The clock is either threadCpuTime() or realTime().
+template <class Op>
+static double timeRepeatedly(Op& op, double (*clock)()) {
+    op(); // warm up
+    int calls = 1;
+    double best;
+    for (;;) {
+        const double start = clock();
+        for (int i = 0; i < calls; i++)
+            op();
+        best = clock()-start;
+        if (best >= options.minTime/3 || calls >= (1<<24))
+            break;
+        calls *= 2;
+    }
+    for (int rep = 0; rep < 2; rep++) {
+        const double start = clock();
+        for (int i = 0; i < calls; i++)
+            op();
+        best = std::min(best, clock()-start);
+    }
+    return best/calls;
+}
+
+struct BuildMesh {
+    explicit BuildMesh(const PolygonalMesh& mesh) : mesh(mesh) {}
+    void operator()() {ContactGeometry::TriangleMesh tri(mesh);}
+    const PolygonalMesh& mesh;
+};
+
+struct FindNearestPoints {
+    FindNearestPoints(const ContactGeometry::TriangleMesh& mesh, 
+                      const Array_<Vec3>& points) 
+    :   mesh(mesh), points(points), checksum(0) {}
+    void operator()() {
+        checksum = 0;
+        for (int i = 0; i < (int)points.size(); i++) {
+            bool inside; UnitVec3 normal;
+            const Vec3 p = mesh.findNearestPoint(points[i], inside, normal);
+            checksum += (p-points[i]).norm();
+        }
+    }
+    const ContactGeometry::TriangleMesh& mesh;
+    const Array_<Vec3>& points;
+    Real checksum;
+};
+
+// Shoot a ray from each point toward the center of the mesh's bounding box.
+struct IntersectRays {
+    IntersectRays(const ContactGeometry::TriangleMesh& mesh, 
+                  const Array_<Vec3>& points) 
+    :   mesh(mesh), points(points), checksum(0) {
+        const OrientedBoundingBox& box = mesh.getOBBTreeNode().getBounds();
+        center = box.getTransform()*(box.getSize()/2);
+    }
+    void operator()() {
+        checksum = 0;
+        for (int i = 0; i < (int)points.size(); i++) {
+            Real distance; UnitVec3 normal;
+            if (mesh.intersectsRay(points[i], UnitVec3(center-points[i]), 
+                                   distance, normal))
+                checksum += distance;
+        }
+    }
+    const ContactGeometry::TriangleMesh& mesh;
+    const Array_<Vec3>& points;
+    Vec3 center;
+    Real checksum;
+};
+
+struct RealizeDynamics {
+    RealizeDynamics(const MultibodySystem& system, State& state) 
+    :   system(system), state(state) {}
+    void operator()() {
+        state.invalidateAll(Stage::Position);
+        system.realize(state, Stage::Dynamics);
+    }
+    const MultibodySystem& system;
+    State& state;
+};
+
+static void runBigMeshContactBenchmark(const std::string& id,
+                                       const PolygonalMesh& femurMesh,
+                                       const PolygonalMesh& patellaMesh) {
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter(system);
+    GeneralForceSubsystem   forces(system);
+    ContactTrackerSubsystem tracker(system);
+    CompliantContactSubsystem contactForces(system, tracker);
+    contactForces.setTransitionVelocity(1e-3);
+
+    const Real fK = 100*1e6; // pascals
+    matter.Ground().updBody().addContactSurface(Vec3(0),
+        ContactSurface(ContactGeometry::TriangleMesh(femurMesh),
+            ContactMaterial(fK*.01,.09,.8,.7,.1), .01 /*thickness*/));
+
+    Body::Rigid patellaBody(MassProperties(1.0, Vec3(0), Inertia(1)));
+    patellaBody.addContactSurface(Transform(),
+        ContactSurface(ContactGeometry::TriangleMesh(patellaMesh),
+            ContactMaterial(fK*.001,.09,.8,.7,.1), .01 /*thickness*/));
+    MobilizedBody::Free patella(matter.Ground(), Transform(), 
+                                patellaBody, Transform());
+
+    // This transform has the meshes close enough that their OBBs overlap.
+    const Transform X_FP(
+        Rotation(Mat33( 0.97107625831404454, 0.23876955530133021, 0,
+                       -0.23876955530133021, 0.97107625831404454, 0,
+                        0,                   0,                   1), true),
+        Vec3(0.057400580865008571, 0.43859170879135373, 
+             -0.00016506240185135300));
+
+    State state = system.realizeTopology();
+    patella.setQToFitTransform(state, ~X_FP);
+    patella.setUToFitLinearVelocity(state, Vec3(0,-.1,0));
+
+    RealizeDynamics op(system, state);
+    record(id, 1, state.getNU(), timeRepeatedly(op, realTime));
+    system.realize(state, Stage::Acceleration);
+    std::printf("  %d contacts, checksum %.10g\n", 
+                contactForces.getNumContactForces(state),
+                patella.getBodyOriginAcceleration(state).norm());
+}
+
+static void runBigMeshBenchmarks() {
+    const std::string buildFemur   = makeId("FemurMesh", "build", 1);
+    const std::string buildPatella = makeId("PatellaMesh", "build", 1);
+    const std::string nearest = makeId("FemurMesh", "findNearestPoint", 1);
+    const std::string rays    = makeId("FemurMesh", "intersectsRay", 1);
+    const std::string contact = 
+        makeId("FemurPatellaMeshes", "realizeDynamics", 1);
+    if (!isSelected(buildFemur) && !isSelected(buildPatella) 
+        && !isSelected(nearest) && !isSelected(rays) && !isSelected(contact))
+        return;
+    PolygonalMesh femurMesh, patellaMesh;
+    if (!loadBigMesh("Femur", femurMesh) || !loadBigMesh("Patella", patellaMesh))
+        return;
+
+    if (isSelected(buildFemur)) {
+        BuildMesh op(femurMesh);
+        record(buildFemur, 1, 0, timeRepeatedly(op, threadCpuTime));
+    }
+    if (isSelected(buildPatella)) {
+        BuildMesh op(patellaMesh);
+        record(buildPatella, 1, 0, timeRepeatedly(op, threadCpuTime));
+    }
+
+    // The query points are the same from run to run so that the checksums 
+    // can be compared. Each reported time is per query.
+    const int numQueries = 1000;
+    const ContactGeometry::TriangleMesh femur(femurMesh);
+    const OrientedBoundingBox& box = femur.getOBBTreeNode().getBounds();
+    Random::Uniform random(-.25, 1.25);
+    random.setSeed(1);
+    Array_<Vec3> points(numQueries);
+    for (int i = 0; i < numQueries; i++)
+        points[i] = box.getTransform()*Vec3(box.getSize()[0]*random.getValue(),
+                                            box.getSize()[1]*random.getValue(),
+                                            box.getSize()[2]*random.getValue());
+
+    if (isSelected(nearest)) {
+        FindNearestPoints op(femur, points);
+        record(nearest, 1, 0, timeRepeatedly(op, threadCpuTime)/numQueries);
+        std::printf("  checksum %.10g\n", op.checksum);
+    }
+    if (isSelected(rays)) {
+        IntersectRays op(femur, points);
+        record(rays, 1, 0, timeRepeatedly(op, threadCpuTime)/numQueries);
+        std::printf("  checksum %.10g\n", op.checksum);
+    }
+
+    if (isSelected(contact))
+        runBigMeshContactBenchmark(contact, femurMesh, patellaMesh);
+}
+
+
+
+//==============================================================================
+//                                VISUALIZER
+//==============================================================================
+// Free bodies in a square grid, each carrying a solid sphere, a wireframe 
+// brick and a line, so that a scene with n bodies has 3n primitives. The 
+// reported time is per drawFrameNow() call, which generates the scene and 
+// encodes it into the frame buffer sent to the VisualizerGUI. The suite has to
+// run without a display, so the frames go to a recording file rather than to
+// the GUI; the file is written by a background thread, and the time on this
+// thread doesn't include that. The file is removed afterwards.
+struct DrawFrame {
+    DrawFrame(const MultibodySystem& system, const Visualizer& viz, 
+              State& state) 
+    :   system(system), viz(viz), state(state), frame(0) {}
+    void operator()() {
+        state.updTime() = .01*frame++;
+        state.updQ()[4] = std::sin(state.getTime()); // move the first body
+        system.realize(state, Stage::Position);
+        viz.drawFrameNow(state);
+    }
+    const MultibodySystem& system;
+    const Visualizer& viz;
+    State& state;
+    int frame;
+};
+
+static void runVisualizerBenchmark(int n) {
+    const std::string id = makeId("DecoratedBodies", "drawFrameNow", n);
+    if (!isSelected(id))
+        return;
+    const char* fileName = "SimbodyBenchmark.simviz";
+    {   MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        body.addDecoration(Transform(), DecorativeSphere(.2).setColor(Blue));
+        body.addDecoration(Transform(), DecorativeBrick(Vec3(.1,.3,.1))
+                    .setRepresentation(DecorativeGeometry::DrawWireframe));
+        body.addDecoration(Transform(), DecorativeLine(Vec3(0), Vec3(0,-.5,0))
+                    .setColor(Red));
+        const int side = (int)std::ceil(std::sqrt((double)n));
+        for (int i = 0; i < n; i++)
+            MobilizedBody::Free(matter.Ground(), 
+                                Transform(Vec3(i%side, 0, i/side)), 
+                                body, Transform());
+        State state = system.realizeTopology();
+
+        const Visualizer viz = Visualizer::createRecorder(system, fileName);
+        DrawFrame op(system, viz, state);
+        record(id, n, state.getNU(), timeRepeatedly(op, threadCpuTime));
+    } // the recording is finished here
+    std::remove(fileName);
+}
+
+static void runVisualizerBenchmarks() {
+    const int maxBodies = std::min(options.maxBodies, 1000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++)
+        runVisualizerBenchmark(sizes[s]);
+}
+
+
+
+//==============================================================================
+//                               CONSTRAINTS
+//==============================================================================
+// Closed loops of four bodies each, formed by two short pendulums whose tips
+// are joined by a ball constraint. Every fourth loop also has its tip tied to
+// ground with a rod so that there are redundant constraints to deal with.
+static void runConstraintBenchmarks() {
+    static const NamedOperation ops[] = {
+        {"realizeAcceleration", doRealizeAcceleration},
+        {"calcProjectedMInv",   doCalcProjectedMInv}
+    };
+    const int maxBodies = std::min(options.maxBodies, 10000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++) {
+        const int n = sizes[s];
+        // Forming G M^-1 ~G explicitly gets too big past a thousand bodies.
+        const int nOps = n <= 1000 ? 2 : 1;
+        if (!anySelected("BallLoops", ops, nOps, n))
+            continue;
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        for (int i = 0; i < n/4; i++) {
+            MobilizedBody::Pin left(matter.Ground(), Vec3(3*i,0,0), 
+                                    body, Vec3(0,1,0));
+            MobilizedBody::Ball leftTip(left, Vec3(0,-1,0), body, Vec3(0,1,0));
+            MobilizedBody::Pin right(matter.Ground(), Vec3(3*i+1,0,0), 
+                                     body, Vec3(0,1,0));
+            MobilizedBody::Gimbal rightTip(right, Vec3(0,-1,0), 
+                                           body, Vec3(0,1,0));
+            Constraint::Ball(leftTip, Vec3(0,-1,0), rightTip, Vec3(0,-1,0));
+            if (i % 4 == 0)
+                Constraint::Rod(matter.Ground(), Vec3(3*i+.5,-5,0), 
+                                leftTip, Vec3(0,-1,0), 4);
+        }
+
+        State state = system.realizeTopology();
+        system.realize(state, Stage::Acceleration);
+        runOperations("BallLoops", ops, nOps, n, system, state);
+    }
+}
+
+
+
+//==============================================================================
+//                            STATE CHECKPOINTS
+//==============================================================================
+// Going back to a saved State in a Monte Carlo style accept/reject loop. Each
+// trial saves the State of a damped ball chain, perturbs its velocities and
+// realizes through Acceleration, then rejects the trial by going back to the
+// saved State and realizing it again through Acceleration, as the next trial
+// would require. The methods of going back are
+//   copyState                    assign from a saved State copy
+//   restoreCheckpoint            State::restoreCheckpoint() without the cache
+//   restoreCheckpointWithCache   State::restoreCheckpoint() with the cache
+// and the reported time is per trial, including the save.
+enum RestoreMethod {CopyState, RestoreCheckpoint, RestoreCheckpointWithCache};
+
+static void runCheckpointBenchmark(const char* name, RestoreMethod method,
+                                   int n) {
+    const std::string id = makeId("BallChainTrial", name, n);
+    if (!isSelected(id))
+        return;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1)));
+    MobilizedBody last = matter.updGround();
+    for (int i = 0; i < n; i++) {
+        MobilizedBody::Ball next(last, Vec3(0, -.5, 0), body, Vec3(0, .5, 0));
+        Force::MobilityLinearDamper(forces, next, 0, 1);
+        last = next;
+    }
+    State state = system.realizeTopology();
+    for (int i = 0; i < state.getNU(); i++)
+        state.updU()[i] = (i%2 ? .1 : -.1);
+    system.realize(state, Stage::Acceleration);
+
+    // Run trials until enough time has been spent, then repeat twice more,
+    // keeping the best time per trial.
+    Random::Gaussian random(0, 1);
+    random.setSeed(1);
+    State saved;
+    StateCheckpoint checkpoint;
+    double best = Infinity;
+    for (int rep = 0; rep < 3; rep++) {
+        const double start = threadCpuTime();
+        double elapsed = 0;
+        int trials = 0;
+        while (elapsed < options.minTime/3) {
+            if (method == CopyState) 
+                saved = state;
+            else 
+                state.saveCheckpoint(checkpoint, 
+                                     method == RestoreCheckpointWithCache);
+            for (int i = 0; i < state.getNU(); i++)
+                state.updU()[i] += 0.01*random.getValue();
+            system.realize(state, Stage::Acceleration);
+            if (method == CopyState) 
+                state = saved;
+            else 
+                state.restoreCheckpoint(checkpoint);
+            system.realize(state, Stage::Acceleration);
+            ++trials;
+            elapsed = threadCpuTime()-start;
+        }
+        best = std::min(best, elapsed/trials);
+    }
+    record(id, n, state.getNU(), best);
+}
+
+static void runCheckpointBenchmarks() {
+    const int maxBodies = std::min(options.maxBodies, 1000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++) {
+        runCheckpointBenchmark("copyState", CopyState, sizes[s]);
+        runCheckpointBenchmark("restoreCheckpoint", RestoreCheckpoint, 
+                               sizes[s]);
+        runCheckpointBenchmark("restoreCheckpointWithCache", 
+                               RestoreCheckpointWithCache, sizes[s]);
+    }
+}
+
+
+
+//==============================================================================
+//                             SPATIAL KERNELS
+//==============================================================================
+// The spatial algebra operations of the articulated body passes, on a batch
+// of 64 operands: the operators in SpatialAlgebra.h and MassProperties.h
+// ("SpatialOperators"), and each available instruction set of SpatialKernels
+// on the same data in padded form ("SpatialKernelsAVX2" and so on). The 
+// operations are
+//   multiply           a 6x6 matrix times each 6-vector
+//   shiftVec           phi times each 6-vector
+//   shiftMat           phi times each 6x6 matrix
+//   shiftArticulated   phi*P*~phi for each articulated body inertia P
+// with a different phi for each operand of the shifts.
+static const int SpatialBatch = 64;
+
+struct SpatialOperands {
+    SpatialOperands() {
+        Random::Uniform random(-1, 1);
+        random.setSeed(1);
+        Vec6 m6[6];
+        for (int i = 0; i < 6; i++)
+            for (int j = 0; j < 6; j++) m6[i][j] = random.getValue();
+        for (int i = 0; i < 6; i++)
+            for (int j = 0; j < 6; j++) m(i/3,j/3)(i%3,j%3) = m6[i][j];
+        for (int k = 0; k < SpatialBatch; k++) {
+            phi[k] = PhiMatrix(Vec3(random.getValue(), random.getValue(), 
+                                    random.getValue())*1e-3);
+            for (int i = 0; i < 6; i++) 
+                v[k][i/3][i%3] = random.getValue();
+            ms[k] = m;
+            P[k] = ArticulatedInertia(SymMat33(2), Mat33(random.getValue()), 
+                                      SymMat33(3));
+        }
+    }
+    SpatialMat          m;
+    PhiMatrix           phi[SpatialBatch];
+    SpatialVec          v[SpatialBatch];
+    SpatialMat          ms[SpatialBatch];
+    ArticulatedInertia  P[SpatialBatch];
+};
+
+enum SpatialOperation {Multiply, ShiftVec, ShiftMat, ShiftArticulated};
+static const char* spatialOperationNames[] = 
+    {"multiply", "shiftVec", "shiftMat", "shiftArticulated"};
+
+struct RunSpatialOperators {
+    RunSpatialOperators(const SpatialOperands& x, SpatialOperation op) 
+    :   op(op), x(x) {
+        for (int k = 0; k < SpatialBatch; k++) {
+            v[k] = x.v[k]; ms[k] = x.ms[k]; P[k] = x.P[k];
+        }
+    }
+    void operator()() {
+        switch (op) {
+        case Multiply:
+            for (int k = 0; k < SpatialBatch; k++) mv[k] = x.m*v[k];
+            break;
+        case ShiftVec:
+            for (int k = 0; k < SpatialBatch; k++) v[k] = x.phi[k]*v[k];
+            break;
+        case ShiftMat:
+            for (int k = 0; k < SpatialBatch; k++) ms[k] = x.phi[k]*ms[k];
+            break;
+        case ShiftArticulated:
+            for (int k = 0; k < SpatialBatch; k++) 
+                P[k].shiftInPlace(x.phi[k].l());
+            break;
+        }
+    }
+    SpatialOperation        op;
+    const SpatialOperands&  x;
+    SpatialVec              v[SpatialBatch], mv[SpatialBatch];
+    SpatialMat              ms[SpatialBatch];
+    ArticulatedInertia      P[SpatialBatch];
+};
+
+struct RunSpatialKernels {
+    RunSpatialKernels(const SpatialOperands& x, SpatialOperation op) 
+    :   op(op), x(x), m(x.m) {
+        for (int k = 0; k < SpatialBatch; k++) {
+            v[k] = x.v[k]; ms[k] = x.ms[k]; P[k] = PaddedSpatialMat(x.P[k]);
+        }
+    }
+    void operator()() {
+        switch (op) {
+        case Multiply: 
+            SpatialKernels::multiply(m, SpatialBatch, v, mv); break;
+        case ShiftVec: 
+            SpatialKernels::shift(SpatialBatch, x.phi, v); break;
+        case ShiftMat: 
+            SpatialKernels::shift(SpatialBatch, x.phi, ms); break;
+        case ShiftArticulated: 
+            SpatialKernels::shiftArticulated(SpatialBatch, x.phi, P); break;
+        }
+    }
+    SpatialOperation        op;
+    const SpatialOperands&  x;
+    PaddedSpatialMat        m;
+    PaddedSpatialVec        v[SpatialBatch], mv[SpatialBatch];
+    PaddedSpatialMat        ms[SpatialBatch], P[SpatialBatch];
+};
+
+static void runSpatialKernelBenchmarks() {
+    const SpatialOperands operands;
+    for (int op = Multiply; op <= ShiftArticulated; op++) {
+        const char* name = spatialOperationNames[op];
+        const std::string id = makeId("SpatialOperators", name, SpatialBatch);
+        if (isSelected(id)) {
+            RunSpatialOperators run(operands, SpatialOperation(op));
+            record(id, SpatialBatch, 0, timeRepeatedly(run, threadCpuTime));
+        }
+    }
+    const SpatialKernels::InstructionSet best = 
+        SpatialKernels::getBestInstructionSet();
+    for (int set = SpatialKernels::Scalar; set <= best; set++) {
+        const SpatialKernels::InstructionSet s = 
+            SpatialKernels::InstructionSet(set);
+        if (!SpatialKernels::isInstructionSetAvailable(s))
+            continue;
+        const std::string family = std::string("SpatialKernels") 
+                                   + SpatialKernels::getInstructionSetName(s);
+        for (int op = Multiply; op <= ShiftArticulated; op++) {
+            const std::string id = makeId(family.c_str(), 
+                                          spatialOperationNames[op], 
+                                          SpatialBatch);
+            if (!isSelected(id))
+                continue;
+            SpatialKernels::setInstructionSet(s);
+            RunSpatialKernels run(operands, SpatialOperation(op));
+            record(id, SpatialBatch, 0, timeRepeatedly(run, threadCpuTime));
+        }
+    }
+    SpatialKernels::setInstructionSet(best);
+}
+
+
+
+//==============================================================================
+//                              MARKER FITTING
+//==============================================================================
+// Fitting frames of marker data, as from a motion capture stream, to a 
+// skeleton-like model: a pelvis on a free joint with two legs and two arms of
+// three ball-jointed segments, each segment carrying three markers. The 
+// markers follow a smooth motion sampled at 100 frames per second. The 
+// methods of fitting are
+//   findBestFit   the static ObservedPointFitter::findBestFit() per frame
+//   fitFrame      one ObservedPointFitter, fitFrame() for each frame in order
+//   fitFrames     one ObservedPointFitter, fitFrames() on all processors
+// and the reported time is per frame, the inverse of the frames per second.
+// fitFrames() spreads the work over threads, so its time is real time rather
+// than CPU time and depends on the number of processors.
+enum FitMethod {FindBestFit, FitFrame, FitFrames};
+
+static void runFittingBenchmark(const char* name, FitMethod method) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Body::Rigid segment(MassProperties(1, Vec3(0), UnitInertia(.1)));
+    MobilizedBody::Free pelvis(matter.Ground(), segment);
+    Array_<MobilizedBodyIndex> bodyIxs;
+    bodyIxs.push_back(pelvis.getMobilizedBodyIndex());
+    const Vec3 limbBase[] = {Vec3(-.1,0,0), Vec3(.1,0,0), 
+                             Vec3(-.2,.5,0), Vec3(.2,.5,0)};
+    for (int limb = 0; limb < 4; limb++) {
+        MobilizedBody parent = pelvis;
+        for (int seg = 0; seg < 3; seg++) {
+            MobilizedBody::Ball ball(parent, seg ? Vec3(0,-.4,0) 
+                                                 : limbBase[limb], 
+                                     segment, Vec3(0));
+            bodyIxs.push_back(ball.getMobilizedBodyIndex());
+            parent = ball;
+        }
+    }
+    const int n = (int)bodyIxs.size();
+    const std::string id = makeId("MarkerFitting", name, n);
+    if (!isSelected(id))
+        return;
+
+    Random::Uniform random(-.1, .1);
+    random.setSeed(3);
+    Array_< Array_<Vec3> > stations(n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < 3; j++)
+            stations[i].push_back(Vec3(random.getValue(), 
+                                       -.2+2*random.getValue(), 
+                                       random.getValue()));
+
+    system.realizeTopology();
+    const int numFrames = 100;
+    Array_< Array_< Array_<Vec3> > > frames(numFrames);
+    State state = system.getDefaultState();
+    for (int k = 0; k < numFrames; k++) {
+        const Real t = k/Real(100);
+        for (int i = 0; i < state.getNQ(); i++)
+            state.updQ()[i] = 0.3*std::sin(2*t + i);
+        system.prescribe(state); // normalizes quaternions
+        system.realize(state, Stage::Position);
+        frames[k].resize(n);
+        for (int i = 0; i < n; i++) {
+            const Transform& X_GB = 
+                matter.getMobilizedBody(bodyIxs[i]).getBodyTransform(state);
+            for (int j = 0; j < (int)stations[i].size(); j++)
+                frames[k][i].push_back(X_GB*stations[i][j]);
+        }
+    }
+
+    // Fit all the frames three times, keeping the best time.
+    double best = Infinity;
+    for (int rep = 0; rep < 3; rep++) {
+        const double start = 
+            method == FitFrames ? realTime() : threadCpuTime();
+        if (method == FindBestFit) {
+            State s = system.getDefaultState();
+            for (int k = 0; k < numFrames; k++)
+                ObservedPointFitter::findBestFit(system, s, bodyIxs, 
+                                                 stations, frames[k]);
+        } else {
+            ObservedPointFitter fitter(system, bodyIxs, stations);
+            if (method == FitFrame) {
+                State s = system.getDefaultState();
+                for (int k = 0; k < numFrames; k++)
+                    fitter.fitFrame(s, frames[k]);
+            } else {
+                Array_<State> states;
+                Array_<Real> errors;
+                fitter.fitFrames(system.getDefaultState(), frames, 
+                                 states, errors);
+            }
+        }
+        const double elapsed = 
+            (method == FitFrames ? realTime() : threadCpuTime()) - start;
+        best = std::min(best, elapsed);
+    }
+    record(id, n, state.getNU(), best/numFrames);
+}
+
+static void runFittingBenchmarks() {
+    runFittingBenchmark("findBestFit", FindBestFit);
+    runFittingBenchmark("fitFrame", FitFrame);
+    runFittingBenchmark("fitFrames", FitFrames);
+}
+
+
+
+//==============================================================================
+//                               INTEGRATORS
+//==============================================================================
+// A pin chain swinging under gravity, started from a bent configuration. The
+// reported time is per integrator step.
+static void runIntegratorBenchmark(const char* name, int n) {
+    const std::string id = makeId("PinChainIntegration", name, n);
+    if (!isSelected(id))
+        return;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1)));
+    MobilizedBody last = matter.updGround();
+    for (int i = 0; i < n; i++) {
+        MobilizedBody::Pin next(last, Vec3(0, -.5, 0), body, Vec3(0, .5, 0));
+        last = next;
+    }
+    State state = system.realizeTopology();
+    for (int i = 0; i < state.getNQ(); i++)
+        state.updQ()[i] = 0.1;
+
+    Integrator* integ;
+    if (std::strcmp(name, "RungeKuttaMerson") == 0)
+        integ = new RungeKuttaMersonIntegrator(system);
+    else if (std::strcmp(name, "Verlet") == 0)
+        integ = new VerletIntegrator(system);
+    else
+        integ = new CPodesIntegrator(system);
+    integ->setAccuracy(1e-4);
+
+    // Take steps until enough time has been spent, then repeat twice more
+    // from the same starting point, keeping the best time per step.
+    double best = Infinity;
+    for (int rep = 0; rep < 3; rep++) {
+        integ->initialize(state);
+        const int startSteps = integ->getNumStepsTaken();
+        const double start = threadCpuTime();
+        double elapsed = 0;
+        while (elapsed < options.minTime/3) {
+            integ->stepBy(0.01);
+            elapsed = threadCpuTime()-start;
+        }
+        const int steps = integ->getNumStepsTaken()-startSteps;
+        best = std::min(best, elapsed/std::max(steps,1));
+    }
+    delete integ;
+    record(id, n, state.getNU(), best);
+}
+
+static void runIntegratorBenchmarks() {
+    const char* integrators[] = {"RungeKuttaMerson", "Verlet", "CPodes"};
+    const int maxBodies = std::min(options.maxBodies, 1000);
+    for (int i = 0; i < 3; i++)
+        for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++)
+            runIntegratorBenchmark(integrators[i], sizes[s]);
+}
+
+// A pin chain hanging in gravity whose joints have very stiff, heavily damped
+// springs, integrated with CPodes using BDF and Newton iteration. The stiff
+// joints keep the steps large, so the cost is dominated by the linear algebra
+// and this compares CPodes's dense linear solver with the matrix-free Krylov 
+// one (CPodesIntegrator::setUseKrylovLinearSolver()). The two take different
+// numbers of steps, so the reported time is for the whole 0.1s simulation.
+static void runStiffIntegratorBenchmark(const char* name, bool useKrylov, 
+                                        int n) {
+    const std::string id = makeId("StiffPinChain", name, n);
+    if (!isSelected(id))
+        return;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1)));
+    MobilizedBody last = matter.updGround();
+    for (int i = 0; i < n; i++) {
+        MobilizedBody::Pin next(last, Vec3(0, -.5, 0), body, Vec3(0, .5, 0));
+        Force::MobilityLinearSpring(forces, next, 0, 1e5, 0);
+        Force::MobilityLinearDamper(forces, next, 0, 1e2);
+        last = next;
+    }
+    State state = system.realizeTopology();
+    for (int i = 0; i < state.getNQ(); i++)
+        state.updQ()[i] = (i%2 ? .1 : -.1);
+
+    CPodesIntegrator integ(system, CPodes::BDF, CPodes::Newton);
+    integ.setAccuracy(1e-4);
+    integ.setInternalStepLimit(100000);
+    integ.setUseKrylovLinearSolver(useKrylov);
+
+    double best = Infinity;
+    for (int rep = 0; rep < 3; rep++) {
+        integ.initialize(state);
+        const double start = threadCpuTime();
+        while (integ.getTime() < 0.1)
+            integ.stepTo(0.1);
+        best = std::min(best, threadCpuTime()-start);
+    }
+    record(id, n, state.getNU(), best);
+}
+
+static void runStiffIntegratorBenchmarks() {
+    const int maxBodies = std::min(options.maxBodies, 1000);
+    for (int s = 0; s < NumSizes && sizes[s] <= maxBodies; s++) {
+        runStiffIntegratorBenchmark("CPodesDense", false, sizes[s]);
+        runStiffIntegratorBenchmark("CPodesKrylov", true, sizes[s]);
+    }
+}
+
+
+
+//==============================================================================
+//                             JSON AND COMPARISON
+//==============================================================================
+// Each result is written on a line of its own, which is all that 
+// readBaseline() relies on.
+static void writeJSON(const std::string& fileName) {
+    std::FILE* f = std::fopen(fileName.c_str(), "w");
+    SimTK_ERRCHK1_ALWAYS(f != 0, "SimbodyBenchmark", 
+        "Can't write results file %s.", fileName.c_str());
+    std::fprintf(f, "{\n\"flopTimeNs\": %.6g,\n\"results\": [\n", flopTimeNs);
+    for (int i = 0; i < (int)results.size(); i++) {
+        const Result& r = results[i];
+        std::fprintf(f, " {\"id\": \"%s\", \"bodies\": %d, \"dofs\": %d, "
+            "\"timeUs\": %.6g, \"flops\": %.6g, \"flopsPerDof\": %.6g}%s\n",
+            r.id.c_str(), r.bodies, r.dofs, r.timeUs, r.flops, 
+            r.flops/std::max(r.dofs,1), i+1 < (int)results.size() ? "," : "");
+    }
+    std::fprintf(f, "]\n}\n");
+    std::fclose(f);
+}
+
+// Read the id and flop count of each result in a file written by writeJSON().
+static std::map<std::string,double> readBaseline(const std::string& fileName) {
+    std::ifstream in(fileName.c_str());
+    SimTK_ERRCHK1_ALWAYS(in.good(), "SimbodyBenchmark", 
+        "Can't read baseline file %s.", fileName.c_str());
+    std::map<std::string,double> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::string idKey = "\"id\": \"", flopsKey = "\"flops\": ";
+        const std::string::size_type id = line.find(idKey);
+        const std::string::size_type flops = line.find(flopsKey);
+        if (id == std::string::npos || flops == std::string::npos)
+            continue;
+        const std::string::size_type idStart = id + idKey.size();
+        const std::string::size_type idEnd = line.find('"', idStart);
+        baseline[line.substr(idStart, idEnd-idStart)] = 
+            std::atof(line.c_str() + flops + flopsKey.size());
+    }
+    return baseline;
+}
+
+// Return the number of regressions found.
+static int compareWithBaseline(const std::string& fileName) {
+    const std::map<std::string,double> baseline = readBaseline(fileName);
+    int nCompared = 0, nRegressions = 0, nImprovements = 0;
+    std::printf("\nComparison with %s (tolerance %g%%):\n", 
+                fileName.c_str(), 100*options.tolerance);
+    for (int i = 0; i < (int)results.size(); i++) {
+        const Result& r = results[i];
+        std::map<std::string,double>::const_iterator p = baseline.find(r.id);
+        if (p == baseline.end() || p->second <= 0)
+            continue;
+        ++nCompared;
+        const double ratio = r.flops/p->second;
+        const char* verdict = 0;
+        if (ratio > 1+options.tolerance) {
+            verdict = "REGRESSION"; ++nRegressions;
+        } else if (ratio < 1/(1+options.tolerance)) {
+            verdict = "improved"; ++nImprovements;
+        }
+        if (verdict)
+            std::printf("%-52s %12.4g -> %12.4g flp  x%.2f  %s\n", 
+                r.id.c_str(), p->second, r.flops, ratio, verdict);
+    }
+    std::printf("%d compared, %d regressions, %d improvements, "
+                "%d not in baseline\n", nCompared, nRegressions, nImprovements,
+                (int)results.size()-nCompared);
+    return nRegressions;
+}
+
+
+
+//==============================================================================
+//                                   MAIN
+//==============================================================================
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i+1 >= argc) {
+            std::printf("Missing value for %s.\n", arg.c_str());
+            return false;
+        }
+        const char* value = argv[++i];
+        if      (arg == "--json")       options.jsonFile = value;
+        else if (arg == "--compare")    options.compareFile = value;
+        else if (arg == "--tolerance")  options.tolerance = std::atof(value);
+        else if (arg == "--max-bodies") options.maxBodies = std::atoi(value);
+        else if (arg == "--min-time")   options.minTime = std::atof(value);
+        else if (arg == "--filter")     options.filter = value;
+        else if (arg == "--mesh-dir")   options.meshDir = value;
+        else {
+            std::printf("Unrecognized option %s.\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        std::printf("Usage: SimbodyBenchmark [--json file] [--compare file] "
+            "[--tolerance frac]\n    [--max-bodies n] [--min-time sec] "
+            "[--filter text]\n    [--mesh-dir dir]\n");
+        return 2;
+    }
+  try {
+    double sink;
+    flopTimeNs = measureFlopTimeInNs(sink);
+    std::printf("1 flop=avg(add,mul)=%gns (%g)\n\n", flopTimeNs, sink);
+
+    const double startCpu = threadCpuTime(), startClock = realTime();
+    runTreeBenchmarks();
+    runContactBenchmarks();
+    runBroadPhaseBenchmarks();
+    runBigMeshBenchmarks();
+    runVisualizerBenchmarks();
+    runConstraintBenchmarks();
+    runCheckpointBenchmarks();
+    runSpatialKernelBenchmarks();
+    runFittingBenchmarks();
+    runIntegratorBenchmarks();
+    runStiffIntegratorBenchmarks();
+    std::printf("\nTotal time: thread CPU=%gs, real time=%gs\n", 
+                threadCpuTime()-startCpu, realTime()-startClock);
+
+    if (!options.jsonFile.empty())
+        writeJSON(options.jsonFile);
+    if (!options.compareFile.empty() 
+        && compareWithBaseline(options.compareFile) > 0)
+        return 1;
+  } catch (const std::exception& e) {
+    std::printf("EXCEPTION THROWN: %s\n", e.what());
+    return 2;
+  }
+    return 0;
+}